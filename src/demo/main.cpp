@@ -1,7 +1,10 @@
 #include <Models/Sequential.h>
+#include <Models/FixedSequential.h>
 #include <Layers/Flatten.h>
 #include <Layers/Dense.h>
 
+#include <stdio.h>
+
 using namespace mia;
 
 int main()
@@ -11,12 +14,12 @@ int main()
 
     models::Sequential model({
         new layers::Flatten({ 2 }, type),
-        new layers::Dense(2, type),
+        new layers::Dense(8, type),
         new layers::Dense(1, type)
     });
 
-    // Compile the model
-    model.Compile(c_SeedValue);
+    // Compile the model for batches of all four inputs, training it with Adam
+    model.Compile(c_SeedValue, 4, optimizers::Optimizer::Adam(0.05f));
 
     // Create the input data & the models expected output
     f32 inputData[] = {
@@ -33,17 +36,35 @@ int main()
         0.0f
     };
 
-    // Train the model
+    // View the data as (numSamples x inputShape) & (numSamples x numOutputs) tensors, nothing is copied
+    DimensionLength const numSamples = static_cast<DimensionLength>(LENGTHOF(expectedOutput));
+    Tensor const batch = Tensor::Borrow(inputData, { numSamples, 2 });
+    Tensor const batchExpectedOutput = Tensor::Borrow(expectedOutput, { numSamples, 1 });
+
+    // Train the model, one step of gradient descent per batch of all four inputs
     u32 const numIterations = 1000;
     for (u32 iIdx = 0; iIdx < numIterations; ++iIdx)
     {
-        u32 const numInputData = LENGTHOF(inputData) / 2;
-        for (u32 i = 0; i < numInputData; ++i)
+        model.Train(batch, batchExpectedOutput);
+    }
+    printf("loss: %f\n", model.GetLoss());
+
+    // Run the model on all four inputs at once (one column of the output per input)
+    Matrix const & output = model.Predict(batch);
+    output.Print();
+
+    // Copy the trained model into one whose layers are fixed at compile time, which predicts a single
+    // input in a fraction of the time
+    models::FixedSequential<
+        models::FixedDense<2, 8, type>,
+        models::FixedDense<8, 1, type>> fixedModel;
+    if (fixedModel.Load(model))
+    {
+        for (u32 sIdx = 0; sIdx < numSamples; ++sIdx)
         {
-            model.Train(
-                {{ static_cast<DimensionLength>(2), &inputData[i * 2] }}, 
-                { expectedOutput[i] }
-            );
+            f32 fixedOutput = 0.0f;
+            fixedModel.Predict(&inputData[sIdx * 2], &fixedOutput);
+            printf("%.0f XOR %.0f = %f\n", inputData[sIdx * 2], inputData[(sIdx * 2) + 1], fixedOutput);
         }
     }
 
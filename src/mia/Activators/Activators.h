@@ -4,6 +4,13 @@
 
 #include "Activators/ReLU.h"
 #include "Activators/Sigmoid.h"
+#include "Activators/Tanh.h"
+#include "Activators/GELU.h"
+#include "Activators/LeakyReLU.h"
+#include "Activators/SiLU.h"
+#include "Kernels/Kernels.h"
+
+#include <string.h>
 
 namespace mia
 {
@@ -13,7 +20,14 @@ namespace mia
         {
             None,
             ReLU,
-            Sigmoid
+            Sigmoid,
+            Tanh,
+            GELU,
+            LeakyReLU,
+            SiLU,
+
+            // The number of activator types (not a valid type itself)
+            Count
         };
 
         typedef f32 (*Activator)(f32 x);
@@ -24,6 +38,10 @@ namespace mia
                 case ActivatorType::None:       return nullptr;
                 case ActivatorType::ReLU:       return ReLU;
                 case ActivatorType::Sigmoid:    return Sigmoid;
+                case ActivatorType::Tanh:       return Tanh;
+                case ActivatorType::GELU:       return GELU;
+                case ActivatorType::LeakyReLU:  return LeakyReLU;
+                case ActivatorType::SiLU:       return SiLU;
 
                 default:
                     ASSERTMSG(false, "Unknown ActivatorType.");
@@ -32,5 +50,222 @@ namespace mia
 
             return nullptr;
         }
+
+        // The activator of the supplied type resolved at compile time, so code templated on the type (see
+        // models::FixedSequential) calls it directly & the compiler can inline it into its loops.
+        template <ActivatorType Type>
+        struct StaticActivator;
+
+        template <>
+        struct StaticActivator<ActivatorType::None>
+        {
+            static f32 Apply(f32 x) { return x; }
+        };
+
+        template <>
+        struct StaticActivator<ActivatorType::ReLU>
+        {
+            static f32 Apply(f32 x) { return ReLU(x); }
+        };
+
+        template <>
+        struct StaticActivator<ActivatorType::Sigmoid>
+        {
+            static f32 Apply(f32 x) { return Sigmoid(x); }
+        };
+
+        template <>
+        struct StaticActivator<ActivatorType::Tanh>
+        {
+            static f32 Apply(f32 x) { return Tanh(x); }
+        };
+
+        template <>
+        struct StaticActivator<ActivatorType::GELU>
+        {
+            static f32 Apply(f32 x) { return GELU(x); }
+        };
+
+        template <>
+        struct StaticActivator<ActivatorType::LeakyReLU>
+        {
+            static f32 Apply(f32 x) { return LeakyReLU(x); }
+        };
+
+        template <>
+        struct StaticActivator<ActivatorType::SiLU>
+        {
+            static f32 Apply(f32 x) { return SiLU(x); }
+        };
+
+        // Returns the derivative of the activator of the supplied type (nullptr for None, whose
+        // derivative is always one).
+        static Activator GetActivatorDerivative(ActivatorType type)
+        {
+            switch (type)
+            {
+                case ActivatorType::None:       return nullptr;
+                case ActivatorType::ReLU:       return ReLUDerivative;
+                case ActivatorType::Sigmoid:    return SigmoidDerivative;
+                case ActivatorType::Tanh:       return TanhDerivative;
+                case ActivatorType::GELU:       return GELUDerivative;
+                case ActivatorType::LeakyReLU:  return LeakyReLUDerivative;
+                case ActivatorType::SiLU:       return SiLUDerivative;
+
+                default:
+                    ASSERTMSG(false, "Unknown ActivatorType.");
+                    break;
+            }
+
+            return nullptr;
+        }
+
+        // Multiplies every element of gradient by the derivative of SiLU or GELU, both of which are
+        // x * Sigmoid(u(x)). The sigmoids are computed by the vectorised kernel a block at a time.
+        static void MultiplyBySigmoidWeightedDerivative(ActivatorType type, f32 const * preActivation, f32 * gradient, u64 length)
+        {
+            u64 constexpr c_BlockLength = 256;
+            f32 sigmoids[c_BlockLength];
+
+            for (u64 blockBegin = 0; blockBegin < length; blockBegin += c_BlockLength)
+            {
+                u64 const blockLength = std::min(c_BlockLength, length - blockBegin);
+                f32 const * x = preActivation + blockBegin;
+                f32 * blockGradient = gradient + blockBegin;
+
+                if (ActivatorType::SiLU == type)
+                {
+                    // SiLU'(x) = Sigmoid(x) * (1 + (x * (1 - Sigmoid(x))))
+                    kernels::Sigmoid(x, sigmoids, blockLength);
+                    for (u64 eIdx = 0; eIdx < blockLength; ++eIdx)
+                    {
+                        blockGradient[eIdx] *= sigmoids[eIdx] * (1.0f + (x[eIdx] * (1.0f - sigmoids[eIdx])));
+                    }
+                    continue;
+                }
+
+                // GELU'(x) = Sigmoid(u) * (1 + (x * (1 - Sigmoid(u)) * u'(x)))
+                for (u64 eIdx = 0; eIdx < blockLength; ++eIdx)
+                {
+                    sigmoids[eIdx] = x[eIdx] * (c_GELUScale + (c_GELUCubicScale * x[eIdx] * x[eIdx]));
+                }
+                kernels::Sigmoid(sigmoids, sigmoids, blockLength);
+                for (u64 eIdx = 0; eIdx < blockLength; ++eIdx)
+                {
+                    f32 const derivativeOfU = c_GELUScale + (3.0f * c_GELUCubicScale * x[eIdx] * x[eIdx]);
+                    blockGradient[eIdx] *= sigmoids[eIdx] * (1.0f + (x[eIdx] * (1.0f - sigmoids[eIdx]) * derivativeOfU));
+                }
+            }
+        }
+
+        // Multiplies every element of gradient by the derivative of the activator of the supplied type.
+        // preActivation holds the values the activator was applied to & values the results, whichever is
+        // cheaper to compute the derivative from is used.
+        inline void MultiplyByDerivative(ActivatorType type, f32 const * preActivation, f32 const * values, f32 * gradient, u64 length)
+        {
+            switch (type)
+            {
+                case ActivatorType::None:
+                    return;
+
+                case ActivatorType::ReLU:
+                    for (u64 eIdx = 0; eIdx < length; ++eIdx)
+                    {
+                        gradient[eIdx] = (preActivation[eIdx] > 0.0f) ? gradient[eIdx] : 0.0f;
+                    }
+                    return;
+
+                case ActivatorType::Sigmoid:
+                    // Sigmoid'(x) = Sigmoid(x) * (1 - Sigmoid(x)), which we already have
+                    for (u64 eIdx = 0; eIdx < length; ++eIdx)
+                    {
+                        gradient[eIdx] *= values[eIdx] * (1.0f - values[eIdx]);
+                    }
+                    return;
+
+                case ActivatorType::Tanh:
+                    // Tanh'(x) = 1 - Tanh(x)^2, which we also already have
+                    for (u64 eIdx = 0; eIdx < length; ++eIdx)
+                    {
+                        gradient[eIdx] *= 1.0f - (values[eIdx] * values[eIdx]);
+                    }
+                    return;
+
+                case ActivatorType::LeakyReLU:
+                    for (u64 eIdx = 0; eIdx < length; ++eIdx)
+                    {
+                        gradient[eIdx] = (preActivation[eIdx] > 0.0f) ? gradient[eIdx] : (gradient[eIdx] * c_LeakyReLUSlope);
+                    }
+                    return;
+
+                case ActivatorType::GELU:
+                case ActivatorType::SiLU:
+                    MultiplyBySigmoidWeightedDerivative(type, preActivation, gradient, length);
+                    return;
+
+                default:
+                    break;
+            }
+
+            Activator derivative = GetActivatorDerivative(type);
+            ASSERTMSG(nullptr != derivative, "Unknown ActivatorType.");
+
+            for (u64 eIdx = 0; eIdx < length; ++eIdx)
+            {
+                gradient[eIdx] *= derivative(preActivation[eIdx]);
+            }
+        }
+
+        // Applies the activator of the supplied type to every element of src, writing the results
+        // into dst (which may alias src). Activators with a vectorised kernel are dispatched to it,
+        // otherwise the scalar activator is applied per element. precision selects the tier of the
+        // transcendental kernels (see kernels::MathPrecision).
+        inline void Activate(ActivatorType type, f32 const * src, f32 * dst, u64 length, kernels::MathPrecision precision = kernels::MathPrecision::Accurate)
+        {
+            switch (type)
+            {
+                case ActivatorType::None:
+                    if (src != dst)
+                    {
+                        memcpy(dst, src, length * sizeof(f32));
+                    }
+                    return;
+
+                case ActivatorType::ReLU:
+                    kernels::ReLU(src, dst, length);
+                    return;
+
+                case ActivatorType::Sigmoid:
+                    kernels::Sigmoid(src, dst, length, precision);
+                    return;
+
+                case ActivatorType::Tanh:
+                    kernels::Tanh(src, dst, length, precision);
+                    return;
+
+                case ActivatorType::GELU:
+                    kernels::GELU(src, dst, length, precision);
+                    return;
+
+                case ActivatorType::LeakyReLU:
+                    kernels::LeakyReLU(src, c_LeakyReLUSlope, dst, length);
+                    return;
+
+                case ActivatorType::SiLU:
+                    kernels::SiLU(src, dst, length, precision);
+                    return;
+
+                default:
+                    break;
+            }
+
+            Activator activator = GetActivator(type);
+            ASSERTMSG(nullptr != activator, "Unknown ActivatorType.");
+
+            for (u64 eIdx = 0; eIdx < length; ++eIdx)
+            {
+                dst[eIdx] = activator(src[eIdx]);
+            }
+        }
     }
 }
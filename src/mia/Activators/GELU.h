@@ -0,0 +1,32 @@
+#pragma once
+
+#include "Common.h"
+#include "Activators/Sigmoid.h"
+
+namespace mia
+{
+    namespace activators
+    {
+        // Scales of the argument of GELU's tanh approximation, written as a Sigmoid:
+        // 0.5 * (1 + tanh(u)) = Sigmoid(2 * u) where u = sqrt(2 / pi) * (x + (0.044715 * x^3)).
+        f32 constexpr c_GELUScale = 1.59576912160573071f;
+        f32 constexpr c_GELUCubicScale = 0.0713548162726002527f;
+
+        // GELU
+        //
+        // The Gaussian error linear unit weights the input by the probability a
+        // standard normal variable is below it. Uses the common tanh approximation,
+        // 0.5 * x * (1 + tanh(sqrt(2 / pi) * (x + (0.044715 * x^3)))).
+        static f32 GELU(f32 x)
+        {
+            return x * Sigmoid(x * (c_GELUScale + (c_GELUCubicScale * x * x)));
+        }
+
+        // Returns the derivative of GELU at x.
+        static f32 GELUDerivative(f32 x)
+        {
+            f32 const sigmoid = Sigmoid(x * (c_GELUScale + (c_GELUCubicScale * x * x)));
+            return sigmoid * (1 + (x * (1 - sigmoid) * (c_GELUScale + (3 * c_GELUCubicScale * x * x))));
+        }
+    }
+}
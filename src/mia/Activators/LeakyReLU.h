@@ -0,0 +1,28 @@
+#pragma once
+
+#include "Common.h"
+
+namespace mia
+{
+    namespace activators
+    {
+        // The slope LeakyReLU applies to negative values.
+        f32 constexpr c_LeakyReLUSlope = 0.01f;
+
+        // LeakyReLU
+        //
+        // A ReLU that scales negative values by a small slope instead of clamping
+        // them to zero, so neurons whose values are negative still receive a
+        // gradient & can't "die".
+        static f32 LeakyReLU(f32 x)
+        {
+            return (x > 0.0f) ? x : (x * c_LeakyReLUSlope);
+        }
+
+        // Returns the derivative of LeakyReLU at x. The derivative at zero is taken to be the slope.
+        static f32 LeakyReLUDerivative(f32 x)
+        {
+            return (x > 0.0f) ? 1.0f : c_LeakyReLUSlope;
+        }
+    }
+}
@@ -2,6 +2,8 @@
 
 #include "Common.h"
 
+#include <algorithm>
+
 namespace mia
 {
     namespace activators
@@ -18,5 +20,11 @@ namespace mia
         {
             return std::max(0.0f, x);
         }
+
+        // Returns the derivative of ReLU at x. The derivative at zero is taken to be zero.
+        static f32 ReLUDerivative(f32 x)
+        {
+            return (x > 0.0f) ? 1.0f : 0.0f;
+        }
     }
 }
@@ -0,0 +1,26 @@
+#pragma once
+
+#include "Common.h"
+#include "Activators/Sigmoid.h"
+
+namespace mia
+{
+    namespace activators
+    {
+        // SiLU (or Swish)
+        //
+        // The input weighted by its Sigmoid, x * Sigmoid(x). A smooth alternative
+        // to ReLU which lets small negative values through.
+        static f32 SiLU(f32 x)
+        {
+            return x * Sigmoid(x);
+        }
+
+        // Returns the derivative of SiLU at x, i.e. Sigmoid(x) * (1 + (x * (1 - Sigmoid(x)))).
+        static f32 SiLUDerivative(f32 x)
+        {
+            f32 const sigmoid = Sigmoid(x);
+            return sigmoid * (1 + (x * (1 - sigmoid)));
+        }
+    }
+}
@@ -2,6 +2,8 @@
 
 #include "Common.h"
 
+#include <math.h>
+
 namespace mia
 {
     namespace activators
@@ -20,5 +22,12 @@ namespace mia
         {
             return 1 / (1 + exp(-x));
         }
+
+        // Returns the derivative of Sigmoid at x, i.e. Sigmoid(x) * (1 - Sigmoid(x)).
+        static f32 SigmoidDerivative(f32 x)
+        {
+            f32 const sigmoid = Sigmoid(x);
+            return sigmoid * (1 - sigmoid);
+        }
     }
 }
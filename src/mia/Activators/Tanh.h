@@ -0,0 +1,28 @@
+#pragma once
+
+#include "Common.h"
+
+#include <math.h>
+
+namespace mia
+{
+    namespace activators
+    {
+        // Tanh
+        //
+        // The hyperbolic tangent, an "S" shaped curve like Sigmoid but between -1 & 1
+        // & centred on zero, which tends to make the next layer's inputs better
+        // conditioned than Sigmoid's.
+        static f32 Tanh(f32 x)
+        {
+            return tanhf(x);
+        }
+
+        // Returns the derivative of Tanh at x, i.e. 1 - Tanh(x)^2.
+        static f32 TanhDerivative(f32 x)
+        {
+            f32 const tanh = Tanh(x);
+            return 1 - (tanh * tanh);
+        }
+    }
+}
@@ -0,0 +1,278 @@
+#include "Allocator.h"
+
+#include <algorithm>
+#include <atomic>
+#include <stdlib.h>
+
+#if defined(_WIN32)
+#include <malloc.h>
+#endif
+
+namespace mia
+{
+    namespace
+    {
+        u64 constexpr c_MinSizeClassShift = 6;
+
+        static_assert((static_cast<u64>(1) << c_MinSizeClassShift) == c_AllocationAlignment, "The smallest size class must match the allocation alignment.");
+
+        // See Allocator::GetNumHeapAllocations. Relaxed increments are enough as the counts are only ever
+        // compared, never used to order other memory accesses.
+        std::atomic<u64> s_NumHeapAllocations(0);
+        std::atomic<u64> s_NumHeapBytesAllocated(0);
+
+        inline u64 AlignUp(u64 value, u64 alignment)
+        {
+            return (value + alignment - 1) & ~(alignment - 1);
+        }
+
+        void * AllocateAligned(u64 numBytes)
+        {
+            void * ptr = nullptr;
+
+#if defined(_WIN32)
+            ptr = _aligned_malloc(static_cast<size_t>(numBytes), static_cast<size_t>(c_AllocationAlignment));
+#else
+            if (0 != posix_memalign(&ptr, static_cast<size_t>(c_AllocationAlignment), static_cast<size_t>(numBytes)))
+            {
+                ptr = nullptr;
+            }
+#endif
+
+            ASSERTMSG(nullptr != ptr, "Failed to allocate memory.");
+
+            s_NumHeapAllocations.fetch_add(1, std::memory_order_relaxed);
+            s_NumHeapBytesAllocated.fetch_add(numBytes, std::memory_order_relaxed);
+            return ptr;
+        }
+
+        void FreeAligned(void * ptr)
+        {
+#if defined(_WIN32)
+            _aligned_free(ptr);
+#else
+            free(ptr);
+#endif
+        }
+    }
+
+    Allocator & Allocator::GetDefault()
+    {
+        static HeapAllocator s_HeapAllocator;
+        return s_HeapAllocator;
+    }
+
+    u64 Allocator::GetNumHeapAllocations()
+    {
+        return s_NumHeapAllocations.load(std::memory_order_relaxed);
+    }
+
+    u64 Allocator::GetNumHeapBytesAllocated()
+    {
+        return s_NumHeapBytesAllocated.load(std::memory_order_relaxed);
+    }
+
+    void * HeapAllocator::Allocate(u64 numBytes)
+    {
+        if (0 == numBytes)
+        {
+            return nullptr;
+        }
+
+        return AllocateAligned(numBytes);
+    }
+
+    void HeapAllocator::Free(void * ptr, u64 numBytes)
+    {
+        if (nullptr != ptr)
+        {
+            FreeAligned(ptr);
+        }
+    }
+
+    ArenaAllocator::ArenaAllocator(u64 numBytes)
+        : m_Blocks()
+        , m_Offset(0)
+        , m_NumBytesUsedInFullBlocks(0)
+    {
+        AddBlock(AlignUp(std::max(numBytes, c_AllocationAlignment), c_AllocationAlignment));
+    }
+
+    ArenaAllocator::~ArenaAllocator()
+    {
+        ReleaseBlocks();
+    }
+
+    void * ArenaAllocator::Allocate(u64 numBytes)
+    {
+        if (0 == numBytes)
+        {
+            return nullptr;
+        }
+
+        u64 const alignedNumBytes = AlignUp(numBytes, c_AllocationAlignment);
+
+        if (m_Offset + alignedNumBytes > m_Blocks.back().numBytes)
+        {
+            // Out of room, continue in a new block at least as large as the current one
+            m_NumBytesUsedInFullBlocks += m_Offset;
+            AddBlock(std::max(alignedNumBytes, m_Blocks.back().numBytes));
+        }
+
+        void * ptr = m_Blocks.back().data + m_Offset;
+        m_Offset += alignedNumBytes;
+        return ptr;
+    }
+
+    void ArenaAllocator::Free(void * ptr, u64 numBytes)
+    {
+        // Memory is only released by Reset
+    }
+
+    void ArenaAllocator::Reset()
+    {
+        if (m_Blocks.size() > 1)
+        {
+            // The last request overflowed the arena, merge everything into a single block large
+            // enough to serve it on its own.
+            u64 const numBytes = GetNumBytesReserved();
+            ReleaseBlocks();
+            AddBlock(numBytes);
+        }
+
+        m_Offset = 0;
+        m_NumBytesUsedInFullBlocks = 0;
+    }
+
+    u64 ArenaAllocator::GetNumBytesUsed() const
+    {
+        return m_NumBytesUsedInFullBlocks + m_Offset;
+    }
+
+    u64 ArenaAllocator::GetNumBytesReserved() const
+    {
+        u64 numBytes = 0;
+        for (u64 bIdx = 0; bIdx < m_Blocks.size(); ++bIdx)
+        {
+            numBytes += m_Blocks[bIdx].numBytes;
+        }
+        return numBytes;
+    }
+
+    void ArenaAllocator::AddBlock(u64 numBytes)
+    {
+        Block block;
+        block.data = static_cast<u8 *>(AllocateAligned(numBytes));
+        block.numBytes = numBytes;
+
+        m_Blocks.push_back(block);
+        m_Offset = 0;
+    }
+
+    void ArenaAllocator::ReleaseBlocks()
+    {
+        for (u64 bIdx = 0; bIdx < m_Blocks.size(); ++bIdx)
+        {
+            FreeAligned(m_Blocks[bIdx].data);
+        }
+        m_Blocks.clear();
+    }
+
+    PoolAllocator::PoolAllocator()
+        : m_Mutex()
+    {
+        for (u32 sIdx = 0; sIdx < c_NumSizeClasses; ++sIdx)
+        {
+            m_FreeLists[sIdx] = nullptr;
+        }
+    }
+
+    PoolAllocator::~PoolAllocator()
+    {
+        Trim();
+    }
+
+    void * PoolAllocator::Allocate(u64 numBytes)
+    {
+        if (0 == numBytes)
+        {
+            return nullptr;
+        }
+
+        if (numBytes > c_MaxPooledBytes)
+        {
+            return AllocateAligned(numBytes);
+        }
+
+        u32 const sizeClass = GetSizeClass(numBytes);
+        {
+            std::lock_guard<std::mutex> lock(m_Mutex);
+
+            FreeBlock * block = m_FreeLists[sizeClass];
+            if (nullptr != block)
+            {
+                m_FreeLists[sizeClass] = block->next;
+                return block;
+            }
+        }
+
+        return AllocateAligned(static_cast<u64>(1) << (sizeClass + c_MinSizeClassShift));
+    }
+
+    void PoolAllocator::Free(void * ptr, u64 numBytes)
+    {
+        if (nullptr == ptr)
+        {
+            return;
+        }
+
+        if (numBytes > c_MaxPooledBytes)
+        {
+            FreeAligned(ptr);
+            return;
+        }
+
+        u32 const sizeClass = GetSizeClass(numBytes);
+        FreeBlock * block = static_cast<FreeBlock *>(ptr);
+
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        block->next = m_FreeLists[sizeClass];
+        m_FreeLists[sizeClass] = block;
+    }
+
+    void PoolAllocator::Trim()
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+
+        for (u32 sIdx = 0; sIdx < c_NumSizeClasses; ++sIdx)
+        {
+            FreeBlock * block = m_FreeLists[sIdx];
+            while (nullptr != block)
+            {
+                FreeBlock * next = block->next;
+                FreeAligned(block);
+                block = next;
+            }
+
+            m_FreeLists[sIdx] = nullptr;
+        }
+    }
+
+    PoolAllocator & PoolAllocator::GetParameterPool()
+    {
+        static PoolAllocator s_ParameterPool;
+        return s_ParameterPool;
+    }
+
+    u32 PoolAllocator::GetSizeClass(u64 numBytes)
+    {
+        u32 sizeClass = 0;
+        while ((static_cast<u64>(1) << (sizeClass + c_MinSizeClassShift)) < numBytes)
+        {
+            ++sizeClass;
+        }
+
+        ASSERTMSG(sizeClass < c_NumSizeClasses, "Allocation is too large to be pooled.");
+        return sizeClass;
+    }
+}
@@ -0,0 +1,135 @@
+#pragma once
+
+#include "Common.h"
+
+#include <mutex>
+#include <vector>
+
+namespace mia
+{
+    // Every allocation made through an Allocator is aligned to this many bytes so that it
+    // can be accessed with aligned SIMD loads & stores (a full AVX-512 register / cache line).
+    u64 constexpr c_AllocationAlignment = 64;
+
+    // Interface for objects that provide the storage of matrices (and other large buffers).
+    class Allocator
+    {
+    public:
+        virtual ~Allocator() = default;
+
+        // Returns a block of at least numBytes bytes aligned to c_AllocationAlignment, or nullptr if
+        // numBytes is zero.
+        virtual void * Allocate(u64 numBytes) = 0;
+        // Releases a block previously returned by Allocate. numBytes must match the size the block
+        // was allocated with.
+        virtual void Free(void * ptr, u64 numBytes) = 0;
+
+        // Returns the process-wide allocator used when no allocator is supplied. It allocates from
+        // the global heap.
+        static Allocator & GetDefault();
+
+        // Returns the number of blocks (& bytes) every allocator has taken from the global heap since the
+        // process started, e.g. to attribute allocations to a layer (see models::Profiler). Blocks handed
+        // out by an arena or from a pool's free lists don't touch the heap so aren't counted. Thread-safe.
+        static u64 GetNumHeapAllocations();
+        static u64 GetNumHeapBytesAllocated();
+    };
+
+    // Allocates every block directly from the global heap. Thread-safe.
+    class HeapAllocator final : public Allocator
+    {
+    public:
+        virtual void * Allocate(u64 numBytes) override;
+        virtual void Free(void * ptr, u64 numBytes) override;
+    };
+
+    // A bump allocator for short-lived scratch memory (e.g. the intermediates of a single inference
+    // request). Allocating is a pointer increment & Free does nothing, all of the memory is instead
+    // released at once by Reset. Blocks handed out before a Reset must not be used after it.
+    //
+    // If a request needs more memory than the arena holds, further blocks are taken from the heap.
+    // On the next Reset these are merged into a single block so that, once warmed up, an arena serves
+    // every request without touching the heap.
+    //
+    // Not thread-safe, each worker thread is expected to own its own arena.
+    class ArenaAllocator final : public Allocator
+    {
+    public:
+        ArenaAllocator() = delete;
+        ArenaAllocator(ArenaAllocator const & other) = delete;
+        virtual ~ArenaAllocator();
+
+        // Constructs an arena with room for numBytes bytes.
+        explicit ArenaAllocator(u64 numBytes);
+
+        virtual void * Allocate(u64 numBytes) override;
+        virtual void Free(void * ptr, u64 numBytes) override;
+
+        // Releases every block allocated from the arena.
+        void Reset();
+
+        // Returns the number of bytes handed out since the last Reset (including alignment padding).
+        u64 GetNumBytesUsed() const;
+        // Returns the number of bytes the arena can hand out before it needs more memory from the heap.
+        u64 GetNumBytesReserved() const;
+
+    private:
+        struct Block
+        {
+            u8 * data;
+            u64 numBytes;
+        };
+
+        void AddBlock(u64 numBytes);
+        void ReleaseBlocks();
+
+    private:
+        std::vector<Block> m_Blocks;
+
+        // Offset of the next free byte within the last block.
+        u64 m_Offset;
+        // Number of bytes handed out from every block but the last.
+        u64 m_NumBytesUsedInFullBlocks;
+    };
+
+    // A pool of power-of-two size classes (from c_AllocationAlignment bytes up to c_MaxPooledBytes)
+    // for long-lived buffers such as layer weights. Freed blocks are kept on a free list per size
+    // class & handed out again by later allocations of the same class, so buffers that are repeatedly
+    // reallocated (e.g. when a model is recompiled) don't churn the heap. Larger blocks are allocated
+    // from the heap directly. Thread-safe.
+    class PoolAllocator final : public Allocator
+    {
+    public:
+        // Blocks larger than this are not pooled.
+        static u64 constexpr c_MaxPooledBytes = 64 * 1024 * 1024;
+
+        PoolAllocator();
+        PoolAllocator(PoolAllocator const & other) = delete;
+        virtual ~PoolAllocator();
+
+        virtual void * Allocate(u64 numBytes) override;
+        virtual void Free(void * ptr, u64 numBytes) override;
+
+        // Returns every cached block to the heap.
+        void Trim();
+
+        // Returns the process-wide pool used for layer parameters.
+        static PoolAllocator & GetParameterPool();
+
+    private:
+        // Returns the index of the smallest size class that fits numBytes.
+        static u32 GetSizeClass(u64 numBytes);
+
+    private:
+        static u32 constexpr c_NumSizeClasses = 21;
+
+        // Freed blocks are linked together through their first bytes.
+        struct FreeBlock
+        {
+            FreeBlock * next;
+        };
+
+        std::mutex m_Mutex;
+        FreeBlock * m_FreeLists[c_NumSizeClasses];
+    };
+}
@@ -0,0 +1,155 @@
+#include "CpuFeatures.h"
+
+#include <algorithm>
+#include <atomic>
+
+#if defined(MIA_ARCH_X86)
+    #if defined(_MSC_VER)
+        #include <intrin.h>
+    #else
+        #include <cpuid.h>
+    #endif
+#endif
+
+namespace mia
+{
+    namespace cpu
+    {
+        namespace
+        {
+#if defined(MIA_ARCH_X86)
+            struct CpuidRegisters
+            {
+                u32 eax = 0;
+                u32 ebx = 0;
+                u32 ecx = 0;
+                u32 edx = 0;
+            };
+
+            CpuidRegisters Cpuid(u32 leaf, u32 subLeaf)
+            {
+                CpuidRegisters registers;
+#if defined(_MSC_VER)
+                int info[4];
+                __cpuidex(info, static_cast<int>(leaf), static_cast<int>(subLeaf));
+                registers.eax = static_cast<u32>(info[0]);
+                registers.ebx = static_cast<u32>(info[1]);
+                registers.ecx = static_cast<u32>(info[2]);
+                registers.edx = static_cast<u32>(info[3]);
+#else
+                unsigned int eax = 0, ebx = 0, ecx = 0, edx = 0;
+                __cpuid_count(leaf, subLeaf, eax, ebx, ecx, edx);
+                registers.eax = eax;
+                registers.ebx = ebx;
+                registers.ecx = ecx;
+                registers.edx = edx;
+#endif
+                return registers;
+            }
+
+            // Returns the XCR0 register which describes which register states the OS saves on a
+            // context switch. Only valid to call when OSXSAVE is supported.
+            u64 ReadXCR0()
+            {
+#if defined(_MSC_VER)
+                return static_cast<u64>(_xgetbv(0));
+#else
+                unsigned int eax = 0, edx = 0;
+                __asm__ __volatile__("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+                return (static_cast<u64>(edx) << 32) | eax;
+#endif
+            }
+
+            inline bool IsBitSet(u32 value, u32 bit)
+            {
+                return 0 != (value & (static_cast<u32>(1) << bit));
+            }
+#endif
+
+            SimdLevel DetectSimdLevel()
+            {
+#if defined(MIA_ARCH_X86)
+                u32 const maxLeaf = Cpuid(0, 0).eax;
+                if (maxLeaf < 7)
+                {
+                    return SimdLevel::Scalar;
+                }
+
+                CpuidRegisters const leaf1 = Cpuid(1, 0);
+                CpuidRegisters const leaf7 = Cpuid(7, 0);
+
+                bool const hasOSXSave = IsBitSet(leaf1.ecx, 27);
+                bool const hasAVX = IsBitSet(leaf1.ecx, 28);
+                bool const hasFMA = IsBitSet(leaf1.ecx, 12);
+                bool const hasAVX2 = IsBitSet(leaf7.ebx, 5);
+                bool const hasAVX512F = IsBitSet(leaf7.ebx, 16);
+
+                if (!hasOSXSave || !hasAVX)
+                {
+                    return SimdLevel::Scalar;
+                }
+
+                // The OS must save the YMM (bits 1-2) & for AVX-512, the opmask & ZMM (bits 5-7) state.
+                u64 const xcr0 = ReadXCR0();
+                bool const osSupportsYmm = (xcr0 & 0x06) == 0x06;
+                bool const osSupportsZmm = (xcr0 & 0xE6) == 0xE6;
+
+                if (hasAVX2 && hasFMA && hasAVX512F && osSupportsZmm)
+                {
+                    return SimdLevel::AVX512;
+                }
+
+                if (hasAVX2 && hasFMA && osSupportsYmm)
+                {
+                    return SimdLevel::AVX2;
+                }
+
+                return SimdLevel::Scalar;
+#elif defined(MIA_ARCH_ARM64)
+                // Advanced SIMD is mandatory on AArch64.
+                return SimdLevel::NEON;
+#else
+                return SimdLevel::Scalar;
+#endif
+            }
+
+            std::atomic<u8> s_MaxSimdLevel(static_cast<u8>(SimdLevel::AVX512));
+        }
+
+        SimdLevel GetDetectedSimdLevel()
+        {
+            static SimdLevel const s_DetectedLevel = DetectSimdLevel();
+            return s_DetectedLevel;
+        }
+
+        SimdLevel GetSimdLevel()
+        {
+            u8 const detectedLevel = static_cast<u8>(GetDetectedSimdLevel());
+            u8 const maxLevel = s_MaxSimdLevel.load(std::memory_order_relaxed);
+
+            return static_cast<SimdLevel>(std::min(detectedLevel, maxLevel));
+        }
+
+        void SetMaxSimdLevel(SimdLevel level)
+        {
+            s_MaxSimdLevel.store(static_cast<u8>(level), std::memory_order_relaxed);
+        }
+
+        char const * GetSimdLevelName(SimdLevel level)
+        {
+            switch (level)
+            {
+                case SimdLevel::Scalar:     return "Scalar";
+                case SimdLevel::NEON:       return "NEON";
+                case SimdLevel::AVX2:       return "AVX2";
+                case SimdLevel::AVX512:     return "AVX512";
+
+                default:
+                    ASSERTMSG(false, "Unknown SimdLevel.");
+                    break;
+            }
+
+            return "Unknown";
+        }
+    }
+}
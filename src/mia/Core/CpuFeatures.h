@@ -0,0 +1,40 @@
+#pragma once
+
+#include "Common.h"
+
+#if defined(_M_X64) || defined(__x86_64__) || defined(_M_IX86) || defined(__i386__)
+    #define MIA_ARCH_X86
+#elif defined(_M_ARM64) || defined(__aarch64__)
+    #define MIA_ARCH_ARM64
+#endif
+
+namespace mia
+{
+    namespace cpu
+    {
+        // The SIMD instruction sets that mia provides dedicated kernels for, ordered from
+        // least to most capable.
+        enum class SimdLevel : u8
+        {
+            Scalar,
+            NEON,
+            AVX2,
+            AVX512
+        };
+
+        // Returns the most capable SIMD instruction set supported by both the CPU & the OS
+        // this process is running on. This is detected once (via CPUID on x86) and cached.
+        SimdLevel GetDetectedSimdLevel();
+
+        // Returns the SIMD instruction set that kernels should currently dispatch to. This is the
+        // detected level unless it has been lowered with SetMaxSimdLevel.
+        SimdLevel GetSimdLevel();
+
+        // Caps the SIMD instruction set used by kernel dispatch. Useful for testing & benchmarking
+        // the lower tiers on a more capable machine. Levels above the detected level are ignored.
+        void SetMaxSimdLevel(SimdLevel level);
+
+        // Returns a human readable name for the supplied SIMD level.
+        char const * GetSimdLevelName(SimdLevel level);
+    }
+}
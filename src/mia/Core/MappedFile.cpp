@@ -0,0 +1,169 @@
+#include "MappedFile.h"
+
+#include <algorithm>
+#include <utility>
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace mia
+{
+    MappedFile::MappedFile()
+        : m_Data(nullptr)
+        , m_Size(0)
+    {
+    }
+
+    MappedFile::MappedFile(MappedFile && other) noexcept
+        : MappedFile()
+    {
+        *this = std::move(other);
+    }
+
+    MappedFile::~MappedFile()
+    {
+        Close();
+    }
+
+    MappedFile & MappedFile::operator = (MappedFile && other) noexcept
+    {
+        if (this == &other)
+        {
+            return *this;
+        }
+
+        Close();
+
+        m_Data = other.m_Data;
+        m_Size = other.m_Size;
+
+        other.m_Data = nullptr;
+        other.m_Size = 0;
+
+        return *this;
+    }
+
+    bool MappedFile::Open(char const * path)
+    {
+        Close();
+
+#if defined(_WIN32)
+        HANDLE const file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (INVALID_HANDLE_VALUE == file)
+        {
+            return false;
+        }
+
+        LARGE_INTEGER size;
+        if (!GetFileSizeEx(file, &size) || (0 == size.QuadPart))
+        {
+            CloseHandle(file);
+            return false;
+        }
+
+        // The view keeps the mapping (& the file) alive once mapped, so both handles can be closed straight away
+        HANDLE const mapping = CreateFileMappingA(file, nullptr, PAGE_WRITECOPY, 0, 0, nullptr);
+        CloseHandle(file);
+        if (nullptr == mapping)
+        {
+            return false;
+        }
+
+        void * const data = MapViewOfFile(mapping, FILE_MAP_COPY, 0, 0, 0);
+        CloseHandle(mapping);
+        if (nullptr == data)
+        {
+            return false;
+        }
+
+        m_Data = static_cast<u8 *>(data);
+        m_Size = static_cast<u64>(size.QuadPart);
+#else
+        int const fd = open(path, O_RDONLY);
+        if (fd < 0)
+        {
+            return false;
+        }
+
+        struct stat status;
+        if ((0 != fstat(fd, &status)) || (0 == status.st_size))
+        {
+            close(fd);
+            return false;
+        }
+
+        // The mapping keeps the file alive once mapped, so the descriptor can be closed straight away
+        u64 const size = static_cast<u64>(status.st_size);
+        void * const data = mmap(nullptr, static_cast<size_t>(size), PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+        close(fd);
+        if (MAP_FAILED == data)
+        {
+            return false;
+        }
+
+        m_Data = static_cast<u8 *>(data);
+        m_Size = size;
+#endif
+
+        return true;
+    }
+
+    void MappedFile::Advise(AccessPattern pattern) const
+    {
+        if (nullptr == m_Data)
+        {
+            return;
+        }
+
+#if defined(_WIN32)
+        // Windows has no equivalent hint for a mapped view
+        (void)pattern;
+#else
+        int const advice = (AccessPattern::Sequential == pattern) ? MADV_SEQUENTIAL : ((AccessPattern::Random == pattern) ? MADV_RANDOM : MADV_NORMAL);
+        madvise(m_Data, static_cast<size_t>(m_Size), advice);
+#endif
+    }
+
+    void MappedFile::Prefetch(u64 offset, u64 numBytes) const
+    {
+        if ((nullptr == m_Data) || (offset >= m_Size))
+        {
+            return;
+        }
+
+#if defined(_WIN32)
+        (void)numBytes;
+#else
+        // madvise expects the range to start on a page boundary
+        u64 const pageSize = static_cast<u64>(sysconf(_SC_PAGESIZE));
+        u64 const begin = offset - (offset % pageSize);
+        u64 const end = std::min(offset + numBytes, m_Size);
+        madvise(m_Data + begin, static_cast<size_t>(end - begin), MADV_WILLNEED);
+#endif
+    }
+
+    void MappedFile::Close()
+    {
+        if (nullptr == m_Data)
+        {
+            return;
+        }
+
+#if defined(_WIN32)
+        UnmapViewOfFile(m_Data);
+#else
+        munmap(m_Data, static_cast<size_t>(m_Size));
+#endif
+
+        m_Data = nullptr;
+        m_Size = 0;
+    }
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+#include "Common.h"
+
+namespace mia
+{
+    // Describes the order in which the pages of a mapping are about to be read, see MappedFile::Advise.
+    enum class AccessPattern
+    {
+        // Pages are read ahead a little around each page that is touched
+        Normal,
+        // Pages are read ahead aggressively & can be dropped soon after they've been read
+        Sequential,
+        // Pages are read one at a time, only once they're touched
+        Random
+    };
+
+    // Maps the whole of a file into the address space of the process, so its contents can be read
+    // (& referenced, e.g. through Matrix::View) without being copied into memory first. Pages are only
+    // read from disk as they're touched & are shared between every process that maps the same file.
+    //
+    // The mapping is copy-on-write: writes to the mapped memory are private to the process & are never
+    // written back to the file.
+    class MappedFile final
+    {
+    public:
+        MappedFile();
+        MappedFile(MappedFile const & other) = delete;
+        MappedFile(MappedFile && other) noexcept;
+        ~MappedFile();
+
+        MappedFile & operator = (MappedFile const & other) = delete;
+        MappedFile & operator = (MappedFile && other) noexcept;
+
+        // Maps the file at the supplied path, replacing any previous mapping. Returns false (leaving the
+        // file unmapped) if the file couldn't be opened or mapped. Empty files can't be mapped.
+        bool Open(char const * path);
+        // Unmaps the file. Any memory referencing the mapping is invalidated.
+        void Close();
+
+        // Returns true if a file is currently mapped
+        bool IsOpen() const;
+
+        // Tells the OS how the mapping is about to be read, so it reads ahead (or doesn't) accordingly.
+        // Only a hint: it never changes the contents of the mapping & does nothing where it isn't supported.
+        void Advise(AccessPattern pattern) const;
+        // Asks the OS to start reading the supplied range of bytes of the mapping from disk in the background,
+        // ahead of it being touched. Only a hint, like Advise.
+        void Prefetch(u64 offset, u64 numBytes) const;
+
+        // Returns the start of the mapping, which is aligned to (at least) the page size
+        u8 * GetData() const;
+        // Returns the size of the mapped file in bytes
+        u64 GetSize() const;
+
+    private:
+        u8 * m_Data;
+        u64 m_Size;
+    };
+
+    inline bool MappedFile::IsOpen() const
+    {
+        return nullptr != m_Data;
+    }
+
+    inline u8 * MappedFile::GetData() const
+    {
+        return m_Data;
+    }
+
+    inline u64 MappedFile::GetSize() const
+    {
+        return m_Size;
+    }
+}
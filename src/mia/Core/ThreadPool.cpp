@@ -0,0 +1,185 @@
+#include "ThreadPool.h"
+
+namespace mia
+{
+    namespace
+    {
+        // Set on worker threads & on a submitting thread for the duration of a parallel region so
+        // that nested calls to ParallelFor run inline rather than deadlocking on the pool.
+        thread_local bool t_InsideParallelRegion = false;
+
+        u32 GetDefaultNumThreads()
+        {
+            u32 const numHardwareThreads = static_cast<u32>(std::thread::hardware_concurrency());
+            return (numHardwareThreads > 0) ? numHardwareThreads : 1;
+        }
+    }
+
+    ThreadPool::ThreadPool()
+        : m_Workers()
+        , m_Generation(0)
+        , m_JobOpen(false)
+        , m_Shutdown(false)
+        , m_NumActiveWorkers(0)
+        , m_Function(nullptr)
+        , m_Context(nullptr)
+        , m_Count(0)
+        , m_NumChunks(0)
+        , m_NextChunk(0)
+    {
+        StartWorkers(GetDefaultNumThreads() - 1);
+    }
+
+    ThreadPool::~ThreadPool()
+    {
+        StopWorkers();
+    }
+
+    ThreadPool & ThreadPool::Get()
+    {
+        static ThreadPool s_ThreadPool;
+        return s_ThreadPool;
+    }
+
+    void ThreadPool::SetNumThreads(u32 numThreads)
+    {
+        if (0 == numThreads)
+        {
+            numThreads = GetDefaultNumThreads();
+        }
+
+        if (numThreads == GetNumThreads())
+        {
+            return;
+        }
+
+        std::lock_guard<std::mutex> submitLock(m_SubmitMutex);
+        StopWorkers();
+        StartWorkers(numThreads - 1);
+    }
+
+    u32 ThreadPool::GetNumThreads() const
+    {
+        return static_cast<u32>(m_Workers.size()) + 1;
+    }
+
+    bool ThreadPool::MustRunInline(u64 numChunks) const
+    {
+        return (numChunks <= 1) || m_Workers.empty() || t_InsideParallelRegion;
+    }
+
+    void ThreadPool::Run(u64 count, u64 numChunks, ChunkFunction function, void const * context)
+    {
+        // Another thread is using the pool, rather than queueing behind it just do the work here.
+        std::unique_lock<std::mutex> submitLock(m_SubmitMutex, std::try_to_lock);
+        if (!submitLock.owns_lock())
+        {
+            function(context, 0, count);
+            return;
+        }
+
+        // Publish the job & wake the workers
+        {
+            std::lock_guard<std::mutex> lock(m_Mutex);
+            m_Function = function;
+            m_Context = context;
+            m_Count = count;
+            m_NumChunks = numChunks;
+            m_NextChunk.store(0, std::memory_order_relaxed);
+            m_JobOpen = true;
+            ++m_Generation;
+        }
+        m_WakeCondition.notify_all();
+
+        // The submitting thread works on the job too
+        t_InsideParallelRegion = true;
+        ExecuteChunks();
+        t_InsideParallelRegion = false;
+
+        // Every chunk has now been claimed. Close the job so no late waking worker can join it &
+        // wait for the workers still running a chunk to finish.
+        std::unique_lock<std::mutex> lock(m_Mutex);
+        m_JobOpen = false;
+        m_DoneCondition.wait(lock, [this]() { return 0 == m_NumActiveWorkers; });
+
+        m_Function = nullptr;
+        m_Context = nullptr;
+    }
+
+    void ThreadPool::ExecuteChunks()
+    {
+        for (;;)
+        {
+            u64 const chunkIndex = m_NextChunk.fetch_add(1, std::memory_order_relaxed);
+            if (chunkIndex >= m_NumChunks)
+            {
+                return;
+            }
+
+            u64 const begin = (m_Count * chunkIndex) / m_NumChunks;
+            u64 const end = (m_Count * (chunkIndex + 1)) / m_NumChunks;
+            m_Function(m_Context, begin, end);
+        }
+    }
+
+    void ThreadPool::WorkerLoop()
+    {
+        t_InsideParallelRegion = true;
+
+        u64 seenGeneration = 0;
+        for (;;)
+        {
+            {
+                std::unique_lock<std::mutex> lock(m_Mutex);
+                m_WakeCondition.wait(lock, [this, seenGeneration]() { return m_Shutdown || (m_Generation != seenGeneration); });
+
+                if (m_Shutdown)
+                {
+                    return;
+                }
+
+                seenGeneration = m_Generation;
+                if (!m_JobOpen)
+                {
+                    // Woke up after the job had already been completed by the other threads
+                    continue;
+                }
+
+                ++m_NumActiveWorkers;
+            }
+
+            ExecuteChunks();
+
+            {
+                std::lock_guard<std::mutex> lock(m_Mutex);
+                --m_NumActiveWorkers;
+            }
+            m_DoneCondition.notify_one();
+        }
+    }
+
+    void ThreadPool::StartWorkers(u32 numWorkers)
+    {
+        m_Shutdown = false;
+        m_Workers.reserve(numWorkers);
+        for (u32 wIdx = 0; wIdx < numWorkers; ++wIdx)
+        {
+            m_Workers.push_back(std::thread(&ThreadPool::WorkerLoop, this));
+        }
+    }
+
+    void ThreadPool::StopWorkers()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_Mutex);
+            m_Shutdown = true;
+        }
+        m_WakeCondition.notify_all();
+
+        for (u32 wIdx = 0; wIdx < m_Workers.size(); ++wIdx)
+        {
+            m_Workers[wIdx].join();
+        }
+        m_Workers.clear();
+    }
+}
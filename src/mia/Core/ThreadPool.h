@@ -0,0 +1,117 @@
+#pragma once
+
+#include "Common.h"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace mia
+{
+    // A process-wide pool of persistent worker threads used to split data-parallel work
+    // (e.g. the tiles of a matrix multiplication) across cores.
+    //
+    // Work is submitted with ParallelFor, which blocks until every chunk has completed. The
+    // calling thread always participates so a pool of n threads owns n - 1 workers. Submitting
+    // work never allocates.
+    //
+    // Calls to ParallelFor that are made from inside a parallel region, or while another thread
+    // is already using the pool, run inline on the calling thread instead of waiting.
+    class ThreadPool final
+    {
+    public:
+        ThreadPool(ThreadPool const & other) = delete;
+        ThreadPool(ThreadPool && other) = delete;
+        ~ThreadPool();
+
+        // Returns the process-wide pool. It is created on first use with one thread per
+        // hardware thread.
+        static ThreadPool & Get();
+
+        // Sets the total number of threads (including the calling thread) that work is split across.
+        // Supplying zero uses one thread per hardware thread. Must not be called while work is in
+        // flight.
+        void SetNumThreads(u32 numThreads);
+
+        // Returns the total number of threads (including the calling thread) work is split across.
+        u32 GetNumThreads() const;
+
+        // Splits the range [0, count) into chunks of at least minChunkSize elements and calls
+        // func(begin, end) for each chunk across the pool. Returns once every chunk has completed.
+        // If the range is too small to be split, func is called once on the calling thread.
+        template <class Func>
+        void ParallelFor(u64 count, u64 minChunkSize, Func const & func);
+
+    private:
+        typedef void (*ChunkFunction)(void const * context, u64 begin, u64 end);
+
+        ThreadPool();
+
+        template <class Func>
+        static void InvokeChunk(void const * context, u64 begin, u64 end);
+
+        // Returns true if the work has to run inline on the calling thread.
+        bool MustRunInline(u64 numChunks) const;
+
+        void Run(u64 count, u64 numChunks, ChunkFunction function, void const * context);
+        void ExecuteChunks();
+        void WorkerLoop();
+
+        void StartWorkers(u32 numWorkers);
+        void StopWorkers();
+
+    private:
+        std::vector<std::thread> m_Workers;
+
+        // Guards the job description below & the worker wake up/shutdown signalling.
+        std::mutex m_Mutex;
+        std::condition_variable m_WakeCondition;
+        std::condition_variable m_DoneCondition;
+
+        // Serialises submissions from different threads.
+        std::mutex m_SubmitMutex;
+
+        u64 m_Generation;
+        bool m_JobOpen;
+        bool m_Shutdown;
+        u32 m_NumActiveWorkers;
+
+        // The current job.
+        ChunkFunction m_Function;
+        void const * m_Context;
+        u64 m_Count;
+        u64 m_NumChunks;
+        std::atomic<u64> m_NextChunk;
+    };
+
+    template <class Func>
+    void ThreadPool::InvokeChunk(void const * context, u64 begin, u64 end)
+    {
+        (*static_cast<Func const *>(context))(begin, end);
+    }
+
+    template <class Func>
+    void ThreadPool::ParallelFor(u64 count, u64 minChunkSize, Func const & func)
+    {
+        if (0 == count)
+        {
+            return;
+        }
+
+        // Over-split relative to the number of threads so that uneven chunks balance out.
+        u64 const maxChunks = static_cast<u64>(GetNumThreads()) * 4;
+        u64 const chunkSize = std::max(minChunkSize, static_cast<u64>(1));
+        u64 const numChunks = std::min(maxChunks, std::max(count / chunkSize, static_cast<u64>(1)));
+
+        if (MustRunInline(numChunks))
+        {
+            func(static_cast<u64>(0), count);
+            return;
+        }
+
+        Run(count, numChunks, &ThreadPool::InvokeChunk<Func>, &func);
+    }
+}
@@ -0,0 +1,222 @@
+#include "DatasetReader.h"
+
+#include "Maths/Random.h"
+
+#include <string.h>
+
+namespace mia
+{
+    namespace data
+    {
+        DatasetReader::DatasetReader(std::unique_ptr<SampleReader> && reader, DatasetOptions const & options)
+            : m_Reader(std::move(reader))
+            , m_Options(options)
+            , m_Window()
+            , m_NumWindowSamples(0)
+            , m_IsEndOfFile(false)
+            , m_ShuffleSeed(0)
+            , m_NumDraws(0)
+            , m_Batches()
+            , m_Mutex()
+            , m_IsBatchFilled()
+            , m_IsBatchConsumed()
+            , m_NumFilledBatches(0)
+            , m_IsStopping(false)
+            , m_HasFailed(false)
+            , m_ReadIndex(0)
+            , m_IsHoldingBatch(false)
+            , m_NumEpochs(0)
+            , m_NumStalls(0)
+            , m_Thread()
+        {
+            ASSERTMSG(nullptr != m_Reader, "reader is not a valid ptr.");
+            ASSERTMSG(m_Options.batchSize > 0, "batchSize must be greater than zero.");
+
+            // Each batch is a single allocation, laid out as Sequential::Train expects
+            DimensionLength inputShape[c_MaxTensorDimensions];
+            inputShape[0] = m_Options.batchSize;
+            for (u32 dIdx = 0; dIdx < m_Reader->GetInputNumDimensions(); ++dIdx)
+            {
+                inputShape[dIdx + 1] = m_Reader->GetInputDimensionLengths()[dIdx];
+            }
+
+            for (u32 bIdx = 0; bIdx < c_NumBatches; ++bIdx)
+            {
+                m_Batches[bIdx].input = Tensor(m_Reader->GetInputNumDimensions() + 1, inputShape);
+                if (m_Reader->GetNumOutputs() > 0)
+                {
+                    m_Batches[bIdx].expectedOutput = Tensor({ m_Options.batchSize, m_Reader->GetNumOutputs() });
+                }
+                m_Batches[bIdx].numSamples = 0;
+            }
+
+            u64 const windowCapacity = (m_Options.shuffleWindow > 1) ? m_Options.shuffleWindow : 1;
+            m_Window.resize(static_cast<size_t>(windowCapacity * (m_Reader->GetNumInputs() + m_Reader->GetNumOutputs())));
+
+            m_Thread = std::thread(&DatasetReader::Produce, this);
+        }
+
+        DatasetReader::~DatasetReader()
+        {
+            {
+                std::lock_guard<std::mutex> lock(m_Mutex);
+                m_IsStopping = true;
+            }
+
+            m_IsBatchConsumed.notify_one();
+            m_Thread.join();
+        }
+
+        bool DatasetReader::Next(Tensor & input, Tensor & expectedOutput)
+        {
+            // The batch returned by the previous call can be filled again
+            if (m_IsHoldingBatch)
+            {
+                {
+                    std::lock_guard<std::mutex> lock(m_Mutex);
+                    --m_NumFilledBatches;
+                }
+
+                m_IsBatchConsumed.notify_one();
+                m_ReadIndex = (m_ReadIndex + 1) % c_NumBatches;
+                m_IsHoldingBatch = false;
+            }
+
+            {
+                std::unique_lock<std::mutex> lock(m_Mutex);
+                if ((0 == m_NumFilledBatches) && !m_HasFailed)
+                {
+                    ++m_NumStalls;
+                    m_IsBatchFilled.wait(lock, [this]() { return (m_NumFilledBatches > 0) || m_HasFailed; });
+                }
+
+                if (0 == m_NumFilledBatches)
+                {
+                    return false;
+                }
+            }
+
+            Batch const & batch = m_Batches[m_ReadIndex];
+            m_IsHoldingBatch = true;
+
+            if (0 == batch.numSamples)
+            {
+                ++m_NumEpochs;
+                return false;
+            }
+
+            bool const isFull = batch.numSamples == m_Options.batchSize;
+            input = isFull ? batch.input : batch.input.Slice(0, 0, batch.numSamples);
+            expectedOutput = (isFull || (0 == batch.expectedOutput.GetNumDimensions())) ? batch.expectedOutput : batch.expectedOutput.Slice(0, 0, batch.numSamples);
+            return true;
+        }
+
+        void DatasetReader::Produce()
+        {
+            u64 epochIndex = 0;
+            bool isEpochStarted = false;
+            u32 writeIndex = 0;
+
+            for (;;)
+            {
+                {
+                    std::unique_lock<std::mutex> lock(m_Mutex);
+                    m_IsBatchConsumed.wait(lock, [this]() { return m_IsStopping || (m_NumFilledBatches < c_NumBatches); });
+                    if (m_IsStopping)
+                    {
+                        return;
+                    }
+                }
+
+                if (!isEpochStarted && !BeginEpoch(epochIndex))
+                {
+                    {
+                        std::lock_guard<std::mutex> lock(m_Mutex);
+                        m_HasFailed = true;
+                    }
+
+                    m_IsBatchFilled.notify_one();
+                    return;
+                }
+
+                // An empty batch ends the epoch, the next one starts straight away
+                isEpochStarted = Fill(m_Batches[writeIndex]);
+                epochIndex += isEpochStarted ? 0 : 1;
+
+                {
+                    std::lock_guard<std::mutex> lock(m_Mutex);
+                    ++m_NumFilledBatches;
+                }
+
+                m_IsBatchFilled.notify_one();
+                writeIndex = (writeIndex + 1) % c_NumBatches;
+            }
+        }
+
+        bool DatasetReader::Fill(Batch & batch)
+        {
+            u64 const numInputs = m_Reader->GetNumInputs();
+            u64 const numOutputs = m_Reader->GetNumOutputs();
+            u64 const sampleSize = numInputs + numOutputs;
+            bool const isShuffled = m_Options.shuffleWindow > 1;
+
+            u32 numSamples = 0;
+            for (; (numSamples < m_Options.batchSize) && (m_NumWindowSamples > 0); ++numSamples)
+            {
+                u64 const sampleIndex = isShuffled ? (rng::DeriveSeed(m_ShuffleSeed, m_NumDraws++) % m_NumWindowSamples) : 0;
+                f32 * sample = m_Window.data() + (sampleIndex * sampleSize);
+
+                memcpy(batch.input.GetData() + (numSamples * numInputs), sample, static_cast<size_t>(numInputs * sizeof(f32)));
+                if (numOutputs > 0)
+                {
+                    memcpy(batch.expectedOutput.GetData() + (numSamples * numOutputs), sample + numInputs, static_cast<size_t>(numOutputs * sizeof(f32)));
+                }
+
+                // Replace the sample by the next one of the file or, once the file has been read, by the last
+                // sample of the window
+                m_IsEndOfFile = m_IsEndOfFile || !m_Reader->Read(sample, sample + numInputs);
+                if (m_IsEndOfFile)
+                {
+                    --m_NumWindowSamples;
+                    if (sampleIndex != m_NumWindowSamples)
+                    {
+                        memcpy(sample, m_Window.data() + (m_NumWindowSamples * sampleSize), static_cast<size_t>(sampleSize * sizeof(f32)));
+                    }
+                }
+            }
+
+            batch.numSamples = numSamples;
+            return numSamples > 0;
+        }
+
+        bool DatasetReader::BeginEpoch(u64 epochIndex)
+        {
+            if ((epochIndex > 0) && !m_Reader->Rewind())
+            {
+                return false;
+            }
+
+            m_ShuffleSeed = rng::DeriveSeed(m_Options.seed, epochIndex);
+            m_NumDraws = 0;
+
+            u64 const numInputs = m_Reader->GetNumInputs();
+            u64 const sampleSize = numInputs + m_Reader->GetNumOutputs();
+            u64 const windowCapacity = (sampleSize > 0) ? (m_Window.size() / sampleSize) : 0;
+
+            m_NumWindowSamples = 0;
+            m_IsEndOfFile = false;
+            while (m_NumWindowSamples < windowCapacity)
+            {
+                f32 * sample = m_Window.data() + (m_NumWindowSamples * sampleSize);
+                if (!m_Reader->Read(sample, sample + numInputs))
+                {
+                    m_IsEndOfFile = true;
+                    break;
+                }
+                ++m_NumWindowSamples;
+            }
+
+            return true;
+        }
+    }
+}
@@ -0,0 +1,154 @@
+#pragma once
+
+#include "Data/SampleReader.h"
+
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace mia
+{
+    namespace data
+    {
+        // Describes how a DatasetReader batches & shuffles the samples of a dataset.
+        struct DatasetOptions
+        {
+            // The number of samples of each batch. The last batch of an epoch holds whatever samples are left.
+            u32 batchSize = 32;
+
+            // The number of samples the shuffle picks from. 0 (or 1) keeps the samples in the order they're
+            // stored. Each sample of a batch is drawn at random from a window of the next shuffleWindow samples
+            // of the file (replaced by the sample that follows them), so the memory taken by the shuffle is
+            // bounded by the window rather than the dataset. Samples move at most about shuffleWindow positions
+            // earlier, so the window should be large compared to any ordering of the file (e.g. by class).
+            u32 shuffleWindow = 0;
+
+            // The seed of the shuffle, each epoch is shuffled differently.
+            u64 seed = c_SeedValue;
+        };
+
+        // Streams batches of samples from a dataset file (see SampleReader), ready to be passed to
+        // models::Sequential::Train, e.g.
+        //
+        //     Tensor input, expectedOutput;
+        //     while (reader.Next(input, expectedOutput))
+        //     {
+        //         model.Train(input, expectedOutput);
+        //     }
+        //
+        // The samples are read, decoded, shuffled & assembled into batches on a background thread, which fills
+        // one batch while the caller trains on the other (double buffering). Training only waits for the file
+        // if decoding a batch takes longer than training on one. The reader never holds more than the shuffle
+        // window & two batches of samples, whatever the size of the dataset.
+        //
+        // The background thread carries straight on with the next epoch (rewinding the file) when it reaches
+        // the end of the current one, so there is no pause between epochs either.
+        class DatasetReader final
+        {
+        public:
+            DatasetReader() = delete;
+            DatasetReader(DatasetReader const & other) = delete;
+            ~DatasetReader();
+
+            // Starts reading batches from the supplied reader on a background thread.
+            DatasetReader(std::unique_ptr<SampleReader> && reader, DatasetOptions const & options = DatasetOptions());
+
+            // Returns the next batch of the current epoch as a (numSamples x inputShape) input tensor & a
+            // (numSamples x numOutputs) expected output tensor, numSamples being at most the batch size. The
+            // tensors view the reader's buffers, they're valid until the next call. Returns false once at the end
+            // of each epoch (or, for good, if the file can't be rewound), the following call returns the first
+            // batch of the next epoch.
+            bool Next(Tensor & input, Tensor & expectedOutput);
+
+            // Returns the number of epochs Next has finished.
+            u64 GetNumEpochs() const;
+            // Returns the number of calls of Next that had to wait for the background thread to finish a batch,
+            // i.e. that were held up by reading or decoding the file.
+            u64 GetNumStalls() const;
+
+            // Returns the shape of a single sample, see SampleReader.
+            u32 GetInputNumDimensions() const;
+            DimensionLength const * GetInputDimensionLengths() const;
+            u32 GetNumOutputs() const;
+
+        private:
+            // A batch assembled by the background thread. An empty batch marks the end of an epoch.
+            struct Batch
+            {
+                Tensor input;
+                Tensor expectedOutput;
+                u32 numSamples;
+            };
+
+            // Number of batches being filled or consumed at once (double buffering)
+            static u32 constexpr c_NumBatches = 2;
+
+            // Fills batches until the reader is destroyed, runs on m_Thread.
+            void Produce();
+            // Fills the supplied batch with the next samples of the epoch, through the shuffle window. Returns
+            // false at the end of the epoch.
+            bool Fill(Batch & batch);
+            // Refills the shuffle window from the start of the file, for the supplied epoch.
+            bool BeginEpoch(u64 epochIndex);
+
+        private:
+            std::unique_ptr<SampleReader> m_Reader;
+            DatasetOptions m_Options;
+
+            // The shuffle window, holding m_NumWindowSamples samples of (numInputs + numOutputs) values.
+            // Only accessed by the background thread.
+            std::vector<f32> m_Window;
+            u64 m_NumWindowSamples;
+            bool m_IsEndOfFile;
+            u64 m_ShuffleSeed;
+            u64 m_NumDraws;
+
+            // The batches, filled in turn by the background thread & consumed in the same order by Next.
+            Batch m_Batches[c_NumBatches];
+
+            std::mutex m_Mutex;
+            std::condition_variable m_IsBatchFilled;
+            std::condition_variable m_IsBatchConsumed;
+            // Guarded by m_Mutex: the number of batches filled but not yet released by Next (including the one
+            // Next last returned) & whether the background thread has stopped (or has been asked to stop).
+            u32 m_NumFilledBatches;
+            bool m_IsStopping;
+            bool m_HasFailed;
+
+            // Only accessed by Next: the index of the batch it reads next & whether it holds the previous one.
+            u32 m_ReadIndex;
+            bool m_IsHoldingBatch;
+            u64 m_NumEpochs;
+            u64 m_NumStalls;
+
+            std::thread m_Thread;
+        };
+
+        inline u64 DatasetReader::GetNumEpochs() const
+        {
+            return m_NumEpochs;
+        }
+
+        inline u64 DatasetReader::GetNumStalls() const
+        {
+            return m_NumStalls;
+        }
+
+        inline u32 DatasetReader::GetInputNumDimensions() const
+        {
+            return m_Reader->GetInputNumDimensions();
+        }
+
+        inline DimensionLength const * DatasetReader::GetInputDimensionLengths() const
+        {
+            return m_Reader->GetInputDimensionLengths();
+        }
+
+        inline u32 DatasetReader::GetNumOutputs() const
+        {
+            return m_Reader->GetNumOutputs();
+        }
+    }
+}
@@ -0,0 +1,575 @@
+#include "SampleReader.h"
+
+#include <algorithm>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+#endif
+
+namespace mia
+{
+    namespace data
+    {
+        namespace
+        {
+            // Files are read in chunks of this many bytes.
+            u64 constexpr c_BufferSize = 1024 * 1024;
+            // The pages that have been read are dropped from the page cache once this many bytes have been read
+            // since they were last dropped.
+            u64 constexpr c_DropBehindSize = 32 * 1024 * 1024;
+
+            // Reads a file from start to end through a fixed size buffer.
+            class FileStream final
+            {
+            public:
+                FileStream()
+                    : m_File(nullptr)
+                    , m_Buffer(new u8[c_BufferSize])
+                    , m_Begin(0)
+                    , m_End(0)
+                    , m_FileOffset(0)
+                    , m_DroppedOffset(0)
+                {
+                }
+
+                FileStream(FileStream const & other) = delete;
+
+                ~FileStream()
+                {
+                    if (nullptr != m_File)
+                    {
+                        fclose(m_File);
+                    }
+                }
+
+                // Opens the file at the supplied path, returns false if it couldn't be opened.
+                bool Open(char const * path)
+                {
+                    m_File = fopen(path, "rb");
+                    if (nullptr == m_File)
+                    {
+                        return false;
+                    }
+
+                    // The stream does its own buffering
+                    setvbuf(m_File, nullptr, _IONBF, 0);
+
+#if !defined(_WIN32) && defined(POSIX_FADV_SEQUENTIAL)
+                    // Ask for a larger read-ahead window
+                    posix_fadvise(fileno(m_File), 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+                    return true;
+                }
+
+                // Reads numBytes bytes into dst, returns false if the file ends first.
+                bool Read(void * dst, u64 numBytes)
+                {
+                    u8 * bytes = static_cast<u8 *>(dst);
+                    while (numBytes > 0)
+                    {
+                        if ((m_Begin == m_End) && !Refill())
+                        {
+                            return false;
+                        }
+
+                        u64 const numCopied = std::min(numBytes, m_End - m_Begin);
+                        memcpy(bytes, m_Buffer.get() + m_Begin, static_cast<size_t>(numCopied));
+                        m_Begin += numCopied;
+                        bytes += numCopied;
+                        numBytes -= numCopied;
+                    }
+
+                    return true;
+                }
+
+                // Reads the next line (without its line ending) into line, returns false at the end of the file.
+                bool ReadLine(std::string & line)
+                {
+                    line.clear();
+                    for (;;)
+                    {
+                        if ((m_Begin == m_End) && !Refill())
+                        {
+                            return !line.empty();
+                        }
+
+                        char const * begin = reinterpret_cast<char const *>(m_Buffer.get() + m_Begin);
+                        u64 const numBytes = m_End - m_Begin;
+                        char const * lineEnd = static_cast<char const *>(memchr(begin, '\n', static_cast<size_t>(numBytes)));
+                        if (nullptr == lineEnd)
+                        {
+                            line.append(begin, static_cast<size_t>(numBytes));
+                            m_Begin = m_End;
+                            continue;
+                        }
+
+                        line.append(begin, static_cast<size_t>(lineEnd - begin));
+                        m_Begin += static_cast<u64>(lineEnd - begin) + 1;
+                        if (!line.empty() && ('\r' == line.back()))
+                        {
+                            line.pop_back();
+                        }
+                        return true;
+                    }
+                }
+
+                // Moves to the supplied offset (in bytes) from the start of the file.
+                bool Seek(u64 offset)
+                {
+#if defined(_WIN32)
+                    bool const isMoved = 0 == _fseeki64(m_File, static_cast<__int64>(offset), SEEK_SET);
+#else
+                    bool const isMoved = 0 == fseeko(m_File, static_cast<off_t>(offset), SEEK_SET);
+#endif
+                    m_Begin = 0;
+                    m_End = 0;
+                    m_FileOffset = offset;
+                    m_DroppedOffset = offset;
+                    return isMoved;
+                }
+
+            private:
+                // Reads the next chunk of the file into the (consumed) buffer, returns false at the end of the file.
+                bool Refill()
+                {
+                    m_Begin = 0;
+                    m_End = static_cast<u64>(fread(m_Buffer.get(), 1, static_cast<size_t>(c_BufferSize), m_File));
+                    m_FileOffset += m_End;
+
+#if !defined(_WIN32) && defined(POSIX_FADV_DONTNEED)
+                    // The pages read so far won't be read again until the next pass over the file
+                    if (m_FileOffset - m_DroppedOffset >= c_DropBehindSize)
+                    {
+                        posix_fadvise(fileno(m_File), static_cast<off_t>(m_DroppedOffset), static_cast<off_t>(m_FileOffset - m_DroppedOffset), POSIX_FADV_DONTNEED);
+                        m_DroppedOffset = m_FileOffset;
+                    }
+#endif
+
+                    return m_End > 0;
+                }
+
+            private:
+                FILE * m_File;
+                std::unique_ptr<u8[]> m_Buffer;
+                // The unread bytes of the buffer are [m_Begin, m_End)
+                u64 m_Begin;
+                u64 m_End;
+                // The offset in the file of the end of the buffer & of the pages that haven't been dropped
+                u64 m_FileOffset;
+                u64 m_DroppedOffset;
+            };
+
+            class BinaryReader final : public SampleReader
+            {
+            public:
+                BinaryReader(std::initializer_list<DimensionLength> const & inputShape, u32 numOutputs)
+                    : SampleReader(static_cast<u32>(inputShape.size()), inputShape.begin(), numOutputs)
+                    , m_Stream()
+                {
+                }
+
+                bool Open(char const * path)
+                {
+                    return m_Stream.Open(path);
+                }
+
+                virtual bool Read(f32 * input, f32 * expectedOutput) override
+                {
+                    return m_Stream.Read(input, GetNumInputs() * sizeof(f32)) && m_Stream.Read(expectedOutput, GetNumOutputs() * sizeof(f32));
+                }
+
+                virtual bool Rewind() override
+                {
+                    return m_Stream.Seek(0);
+                }
+
+            private:
+                FileStream m_Stream;
+            };
+
+            class CSVReader final : public SampleReader
+            {
+            public:
+                CSVReader(std::initializer_list<DimensionLength> const & inputShape, u32 numOutputs)
+                    : SampleReader(static_cast<u32>(inputShape.size()), inputShape.begin(), numOutputs)
+                    , m_Stream()
+                    , m_Line()
+                    , m_Values(GetNumInputs() + numOutputs)
+                    , m_IsFirstLine(true)
+                {
+                }
+
+                bool Open(char const * path)
+                {
+                    return m_Stream.Open(path);
+                }
+
+                virtual bool Read(f32 * input, f32 * expectedOutput) override
+                {
+                    // Skip blank lines
+                    do
+                    {
+                        if (!m_Stream.ReadLine(m_Line))
+                        {
+                            return false;
+                        }
+                    } while (m_Line.find_first_not_of(" \t") == std::string::npos);
+
+                    bool isValid = Parse();
+                    if (!isValid && m_IsFirstLine)
+                    {
+                        // The first line might be the header
+                        char const first = m_Line[m_Line.find_first_not_of(" \t")];
+                        bool const isHeader = !(((first >= '0') && (first <= '9')) || ('-' == first) || ('+' == first) || ('.' == first));
+                        isValid = isHeader && m_Stream.ReadLine(m_Line) && Parse();
+                    }
+                    m_IsFirstLine = false;
+
+                    if (!isValid)
+                    {
+                        return false;
+                    }
+
+                    memcpy(input, m_Values.data(), static_cast<size_t>(GetNumInputs() * sizeof(f32)));
+                    memcpy(expectedOutput, m_Values.data() + GetNumInputs(), static_cast<size_t>(GetNumOutputs() * sizeof(f32)));
+                    return true;
+                }
+
+                virtual bool Rewind() override
+                {
+                    m_IsFirstLine = true;
+                    return m_Stream.Seek(0);
+                }
+
+            private:
+                // Parses m_Line into m_Values, returns false if it doesn't hold exactly one value per element.
+                bool Parse()
+                {
+                    char const * position = m_Line.c_str();
+                    for (u64 vIdx = 0; vIdx < m_Values.size(); ++vIdx)
+                    {
+                        if ((vIdx > 0) && (',' != *position++))
+                        {
+                            return false;
+                        }
+
+                        char * valueEnd = nullptr;
+                        m_Values[vIdx] = strtof(position, &valueEnd);
+                        if (valueEnd == position)
+                        {
+                            return false;
+                        }
+
+                        position = valueEnd;
+                        while ((' ' == *position) || ('\t' == *position))
+                        {
+                            ++position;
+                        }
+                    }
+
+                    return '\0' == *position;
+                }
+
+            private:
+                FileStream m_Stream;
+                std::string m_Line;
+                std::vector<f32> m_Values;
+                bool m_IsFirstLine;
+            };
+
+            // The element types of the IDX format.
+            namespace idx
+            {
+                u8 constexpr c_UnsignedByte = 0x08;
+                u8 constexpr c_SignedByte = 0x09;
+                u8 constexpr c_Short = 0x0B;
+                u8 constexpr c_Int = 0x0C;
+                u8 constexpr c_Float = 0x0D;
+                u8 constexpr c_Double = 0x0E;
+            }
+
+            // Returns the size in bytes of an IDX element type, zero if it isn't one.
+            u32 GetIDXElementSize(u8 type)
+            {
+                switch (type)
+                {
+                    case idx::c_UnsignedByte:   return 1;
+                    case idx::c_SignedByte:     return 1;
+                    case idx::c_Short:          return 2;
+                    case idx::c_Int:            return 4;
+                    case idx::c_Float:          return 4;
+                    case idx::c_Double:         return 8;
+
+                    default:
+                        break;
+                }
+
+                return 0;
+            }
+
+            // IDX files are big-endian
+            inline u64 ReadBigEndian(u8 const * bytes, u32 numBytes)
+            {
+                u64 value = 0;
+                for (u32 bIdx = 0; bIdx < numBytes; ++bIdx)
+                {
+                    value = (value << 8) | bytes[bIdx];
+                }
+                return value;
+            }
+
+            // Converts numElements big-endian elements of the supplied type to f32, multiplied by scale.
+            void DecodeIDXElements(u8 const * bytes, u8 type, u64 numElements, f32 scale, f32 * dst)
+            {
+                switch (type)
+                {
+                    case idx::c_UnsignedByte:
+                        for (u64 eIdx = 0; eIdx < numElements; ++eIdx)
+                        {
+                            dst[eIdx] = static_cast<f32>(bytes[eIdx]) * scale;
+                        }
+                        break;
+
+                    case idx::c_SignedByte:
+                        for (u64 eIdx = 0; eIdx < numElements; ++eIdx)
+                        {
+                            dst[eIdx] = static_cast<f32>(static_cast<s8>(bytes[eIdx])) * scale;
+                        }
+                        break;
+
+                    case idx::c_Short:
+                        for (u64 eIdx = 0; eIdx < numElements; ++eIdx)
+                        {
+                            dst[eIdx] = static_cast<f32>(static_cast<s16>(ReadBigEndian(bytes + (eIdx * 2), 2))) * scale;
+                        }
+                        break;
+
+                    case idx::c_Int:
+                        for (u64 eIdx = 0; eIdx < numElements; ++eIdx)
+                        {
+                            dst[eIdx] = static_cast<f32>(static_cast<signed int>(ReadBigEndian(bytes + (eIdx * 4), 4))) * scale;
+                        }
+                        break;
+
+                    case idx::c_Float:
+                        for (u64 eIdx = 0; eIdx < numElements; ++eIdx)
+                        {
+                            unsigned int const word = static_cast<unsigned int>(ReadBigEndian(bytes + (eIdx * 4), 4));
+                            f32 value;
+                            memcpy(&value, &word, sizeof(value));
+                            dst[eIdx] = value * scale;
+                        }
+                        break;
+
+                    case idx::c_Double:
+                        for (u64 eIdx = 0; eIdx < numElements; ++eIdx)
+                        {
+                            u64 const word = ReadBigEndian(bytes + (eIdx * 8), 8);
+                            f64 value;
+                            memcpy(&value, &word, sizeof(value));
+                            dst[eIdx] = static_cast<f32>(value * scale);
+                        }
+                        break;
+
+                    default:
+                        ASSERTMSG(false, "Unknown IDX element type.");
+                        break;
+                }
+            }
+
+            // An IDX file: its header followed by the elements, the first dimension indexing the samples.
+            struct IDXFile
+            {
+                FileStream stream;
+                u8 type = 0;
+                u32 numDimensions = 0;
+                DimensionLength dimensionLengths[c_MaxTensorDimensions];
+                u64 numElementsPerSample = 0;
+                u64 headerSize = 0;
+                std::vector<u8> sampleBytes;
+
+                // Opens the file & reads its header, returns false if it isn't an IDX file of at most
+                // c_MaxTensorDimensions dimensions.
+                bool Open(char const * path)
+                {
+                    u8 magic[4];
+                    if (!stream.Open(path) || !stream.Read(magic, sizeof(magic)))
+                    {
+                        return false;
+                    }
+
+                    type = magic[2];
+                    numDimensions = magic[3];
+                    if ((0 != magic[0]) || (0 != magic[1]) || (0 == GetIDXElementSize(type)) || (0 == numDimensions) || (numDimensions > c_MaxTensorDimensions))
+                    {
+                        return false;
+                    }
+
+                    numElementsPerSample = 1;
+                    for (u32 dIdx = 0; dIdx < numDimensions; ++dIdx)
+                    {
+                        u8 length[4];
+                        if (!stream.Read(length, sizeof(length)))
+                        {
+                            return false;
+                        }
+
+                        dimensionLengths[dIdx] = static_cast<DimensionLength>(ReadBigEndian(length, 4));
+                        numElementsPerSample *= (dIdx > 0) ? dimensionLengths[dIdx] : 1;
+                    }
+
+                    headerSize = sizeof(magic) + (4 * numDimensions);
+                    sampleBytes.resize(static_cast<size_t>(numElementsPerSample * GetIDXElementSize(type)));
+                    return true;
+                }
+
+                // Reads the elements of the next sample into sampleBytes.
+                bool ReadSample()
+                {
+                    return stream.Read(sampleBytes.data(), sampleBytes.size());
+                }
+            };
+
+            class IDXReader final : public SampleReader
+            {
+            public:
+                IDXReader(u32 inputNumDimensions, DimensionLength const * inputDimensionLengths, u32 numOutputs)
+                    : SampleReader(inputNumDimensions, inputDimensionLengths, numOutputs)
+                    , m_Inputs()
+                    , m_Labels()
+                    , m_HasLabels(false)
+                    , m_NumClasses(0)
+                    , m_InputScale(1.0f)
+                    , m_SampleIndex(0)
+                {
+                }
+
+                // Opens the files, see OpenIDX.
+                static std::unique_ptr<SampleReader> Open(char const * inputsPath, char const * labelsPath, u32 numClasses, f32 inputScale)
+                {
+                    std::unique_ptr<IDXFile> inputs(new IDXFile());
+                    std::unique_ptr<IDXFile> labels(new IDXFile());
+                    bool const hasLabels = nullptr != labelsPath;
+                    if (!inputs->Open(inputsPath) || (hasLabels && (!labels->Open(labelsPath) || (labels->dimensionLengths[0] != inputs->dimensionLengths[0]))))
+                    {
+                        return nullptr;
+                    }
+
+                    // Samples without any other dimension hold a single element
+                    DimensionLength const scalarShape[] = { 1 };
+                    bool const isScalarInput = 1 == inputs->numDimensions;
+                    u32 const inputNumDimensions = isScalarInput ? 1 : (inputs->numDimensions - 1);
+                    DimensionLength const * inputShape = isScalarInput ? scalarShape : (inputs->dimensionLengths + 1);
+
+                    bool const isOneHot = hasLabels && (1 == labels->numDimensions) && (numClasses > 0);
+                    u32 const numOutputs = !hasLabels ? 0 : (isOneHot ? numClasses : static_cast<u32>(labels->numElementsPerSample));
+
+                    std::unique_ptr<IDXReader> reader(new IDXReader(inputNumDimensions, inputShape, numOutputs));
+                    reader->m_Inputs = std::move(inputs);
+                    reader->m_Labels = std::move(labels);
+                    reader->m_HasLabels = hasLabels;
+                    reader->m_NumClasses = isOneHot ? numClasses : 0;
+                    reader->m_InputScale = inputScale;
+                    return reader;
+                }
+
+                virtual bool Read(f32 * input, f32 * expectedOutput) override
+                {
+                    if ((m_SampleIndex >= m_Inputs->dimensionLengths[0]) || !m_Inputs->ReadSample() || (m_HasLabels && !m_Labels->ReadSample()))
+                    {
+                        return false;
+                    }
+
+                    DecodeIDXElements(m_Inputs->sampleBytes.data(), m_Inputs->type, m_Inputs->numElementsPerSample, m_InputScale, input);
+
+                    if (m_NumClasses > 0)
+                    {
+                        // One-hot encode the class index
+                        f32 classIndex = -1.0f;
+                        DecodeIDXElements(m_Labels->sampleBytes.data(), m_Labels->type, 1, 1.0f, &classIndex);
+                        if ((classIndex < 0.0f) || (classIndex >= static_cast<f32>(m_NumClasses)))
+                        {
+                            return false;
+                        }
+
+                        for (u32 cIdx = 0; cIdx < m_NumClasses; ++cIdx)
+                        {
+                            expectedOutput[cIdx] = (cIdx == static_cast<u32>(classIndex)) ? 1.0f : 0.0f;
+                        }
+                    }
+                    else if (m_HasLabels)
+                    {
+                        DecodeIDXElements(m_Labels->sampleBytes.data(), m_Labels->type, m_Labels->numElementsPerSample, 1.0f, expectedOutput);
+                    }
+
+                    ++m_SampleIndex;
+                    return true;
+                }
+
+                virtual bool Rewind() override
+                {
+                    m_SampleIndex = 0;
+                    return m_Inputs->stream.Seek(m_Inputs->headerSize) && (!m_HasLabels || m_Labels->stream.Seek(m_Labels->headerSize));
+                }
+
+            private:
+                std::unique_ptr<IDXFile> m_Inputs;
+                std::unique_ptr<IDXFile> m_Labels;
+                bool m_HasLabels;
+                // The number of classes the labels are one-hot encoded over, zero if they aren't
+                u32 m_NumClasses;
+                f32 m_InputScale;
+                // The index of the next sample
+                u64 m_SampleIndex;
+            };
+        }
+
+        SampleReader::SampleReader(u32 inputNumDimensions, DimensionLength const * inputDimensionLengths, u32 numOutputs)
+            : m_InputNumDimensions(inputNumDimensions)
+            , m_InputDimensionLengths()
+            , m_NumInputs(1)
+            , m_NumOutputs(numOutputs)
+        {
+            // The samples are batched along an extra leading dimension
+            ASSERTMSG((inputNumDimensions > 0) && (inputNumDimensions < c_MaxTensorDimensions), "The input shape must have between 1 & c_MaxTensorDimensions - 1 dimensions.");
+
+            for (u32 dIdx = 0; dIdx < inputNumDimensions; ++dIdx)
+            {
+                m_InputDimensionLengths[dIdx] = inputDimensionLengths[dIdx];
+                m_NumInputs *= inputDimensionLengths[dIdx];
+            }
+        }
+
+        std::unique_ptr<SampleReader> OpenBinary(char const * path, std::initializer_list<DimensionLength> const & inputShape, u32 numOutputs)
+        {
+            std::unique_ptr<BinaryReader> reader(new BinaryReader(inputShape, numOutputs));
+            if (!reader->Open(path))
+            {
+                return nullptr;
+            }
+
+            return reader;
+        }
+
+        std::unique_ptr<SampleReader> OpenCSV(char const * path, std::initializer_list<DimensionLength> const & inputShape, u32 numOutputs)
+        {
+            std::unique_ptr<CSVReader> reader(new CSVReader(inputShape, numOutputs));
+            if (!reader->Open(path))
+            {
+                return nullptr;
+            }
+
+            return reader;
+        }
+
+        std::unique_ptr<SampleReader> OpenIDX(char const * inputsPath, char const * labelsPath, u32 numClasses, f32 inputScale)
+        {
+            return IDXReader::Open(inputsPath, labelsPath, numClasses, inputScale);
+        }
+    }
+}
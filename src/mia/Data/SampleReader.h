@@ -0,0 +1,88 @@
+#pragma once
+
+#include "Maths/Tensor.h"
+
+#include <memory>
+
+namespace mia
+{
+    namespace data
+    {
+        // Decodes the samples of a dataset file one after another, in the order they're stored. Files are
+        // streamed through a fixed size buffer rather than read into memory, so a reader only ever holds a
+        // small part of the file however large it is. The pages of the file that have been read are dropped
+        // from the page cache as the reader moves on (where the platform supports it), so streaming a dataset
+        // larger than memory doesn't evict everything else.
+        //
+        // Each sample is made of the inputs (of the shape the reader was opened with, which is the input
+        // shape of the model's Flatten layer) & the expected outputs. Not thread-safe.
+        class SampleReader
+        {
+        public:
+            SampleReader(SampleReader const & other) = delete;
+            virtual ~SampleReader() = default;
+
+            // Decodes the next sample: GetNumInputs inputs into input & GetNumOutputs expected outputs into
+            // expectedOutput. Returns false once every sample has been read or at the first sample that isn't
+            // valid (e.g. a truncated record), in which case input & expectedOutput may have been overwritten.
+            virtual bool Read(f32 * input, f32 * expectedOutput) = 0;
+            // Goes back to the first sample. Returns false if the file can't be read again.
+            virtual bool Rewind() = 0;
+
+            // Returns the shape of the inputs of a single sample.
+            u32 GetInputNumDimensions() const;
+            DimensionLength const * GetInputDimensionLengths() const;
+            // Returns the number of inputs (the product of the input shape) & expected outputs of a sample.
+            u64 GetNumInputs() const;
+            u32 GetNumOutputs() const;
+
+        protected:
+            SampleReader(u32 inputNumDimensions, DimensionLength const * inputDimensionLengths, u32 numOutputs);
+
+        private:
+            u32 m_InputNumDimensions;
+            DimensionLength m_InputDimensionLengths[c_MaxTensorDimensions];
+            u64 m_NumInputs;
+            u32 m_NumOutputs;
+        };
+
+        // Opens a file of raw f32 records (in the byte order of the machine), one per sample: the inputs in
+        // row-major order followed by the expected outputs. A trailing partial record is ignored. Returns
+        // nullptr if the file couldn't be opened.
+        std::unique_ptr<SampleReader> OpenBinary(char const * path, std::initializer_list<DimensionLength> const & inputShape, u32 numOutputs);
+
+        // Opens a CSV file holding a sample per line: the inputs in row-major order followed by the expected
+        // outputs, separated by commas. A first line that doesn't start with a number is skipped as the header.
+        // Reading stops at the first line that doesn't hold exactly as many numbers as a sample. Returns nullptr
+        // if the file couldn't be opened.
+        std::unique_ptr<SampleReader> OpenCSV(char const * path, std::initializer_list<DimensionLength> const & inputShape, u32 numOutputs);
+
+        // Opens a dataset in the IDX format (that of MNIST): inputsPath holds the inputs, its first dimension
+        // indexing the samples & the others giving the input shape. Every element type of the format is read &
+        // converted to f32, then multiplied by inputScale (e.g. 1 / 255 to normalise bytes). labelsPath, if not
+        // nullptr, holds the same number of samples of expected outputs. Labels with no other dimension (i.e.
+        // class indices) are one-hot encoded over numClasses outputs if numClasses isn't zero. Returns nullptr if
+        // either file couldn't be opened, isn't an IDX file or the two don't hold the same number of samples.
+        std::unique_ptr<SampleReader> OpenIDX(char const * inputsPath, char const * labelsPath = nullptr, u32 numClasses = 0, f32 inputScale = 1.0f);
+
+        inline u32 SampleReader::GetInputNumDimensions() const
+        {
+            return m_InputNumDimensions;
+        }
+
+        inline DimensionLength const * SampleReader::GetInputDimensionLengths() const
+        {
+            return m_InputDimensionLengths;
+        }
+
+        inline u64 SampleReader::GetNumInputs() const
+        {
+            return m_NumInputs;
+        }
+
+        inline u32 SampleReader::GetNumOutputs() const
+        {
+            return m_NumOutputs;
+        }
+    }
+}
@@ -0,0 +1,224 @@
+#include "SampleStore.h"
+
+#include <algorithm>
+#include <stdio.h>
+#include <string.h>
+#include <utility>
+#include <vector>
+
+namespace mia
+{
+    namespace data
+    {
+        namespace
+        {
+            // Records are written through a buffer of this many bytes.
+            u64 constexpr c_WriteBufferSize = 1024 * 1024;
+
+            inline u64 AlignUp(u64 value, u64 alignment)
+            {
+                return (value + alignment - 1) & ~(alignment - 1);
+            }
+
+            bool WriteHeader(FILE * file, format::StoreHeader const & header, u64 numSamples)
+            {
+                format::StoreHeader writtenHeader = header;
+                writtenHeader.numSamples = numSamples;
+                return (0 == fseek(file, 0, SEEK_SET)) && (1 == fwrite(&writtenHeader, sizeof(writtenHeader), 1, file)) && (0 == fflush(file));
+            }
+        }
+
+        bool WriteSampleStore(char const * path, SampleReader & reader)
+        {
+            ASSERTMSG(reader.GetNumInputs() > 0, "A sample store must hold at least one input per sample.");
+
+            format::StoreHeader header;
+            memset(&header, 0, sizeof(header));
+            header.magic = format::c_StoreMagic;
+            header.version = format::c_StoreVersion;
+            header.recordSize = AlignUp((reader.GetNumInputs() + reader.GetNumOutputs()) * sizeof(f32), format::c_RecordAlignment);
+            header.recordsOffset = AlignUp(sizeof(header), format::c_RecordAlignment);
+            header.inputNumDimensions = reader.GetInputNumDimensions();
+            for (u32 dIdx = 0; dIdx < reader.GetInputNumDimensions(); ++dIdx)
+            {
+                header.inputDimensionLengths[dIdx] = reader.GetInputDimensionLengths()[dIdx];
+            }
+            header.numOutputs = reader.GetNumOutputs();
+
+            FILE * file = fopen(path, "wb");
+            if (nullptr == file)
+            {
+                return false;
+            }
+            setvbuf(file, nullptr, _IOFBF, static_cast<size_t>(c_WriteBufferSize));
+
+            // The header is marked as incomplete until every record has been written, so a file that was never
+            // finished is rejected rather than read with missing samples
+            std::vector<u8> padding(static_cast<size_t>(header.recordsOffset - sizeof(header)), 0);
+            bool isWritten = WriteHeader(file, header, format::c_IncompleteNumSamples);
+            isWritten = isWritten && (padding.size() == fwrite(padding.data(), 1, padding.size(), file));
+
+            // The padding at the end of each record stays zeroed
+            std::vector<u8> record(static_cast<size_t>(header.recordSize), 0);
+            f32 * input = reinterpret_cast<f32 *>(record.data());
+            f32 * expectedOutput = input + reader.GetNumInputs();
+            u64 numSamples = 0;
+            while (isWritten && reader.Read(input, expectedOutput))
+            {
+                isWritten = 1 == fwrite(record.data(), record.size(), 1, file);
+                ++numSamples;
+            }
+
+            isWritten = isWritten && WriteHeader(file, header, numSamples);
+            isWritten = (0 == fclose(file)) && isWritten;
+            return isWritten;
+        }
+
+        SampleStore::SampleStore()
+            : m_File()
+            , m_NumSamples(0)
+            , m_RecordSize(0)
+            , m_RecordsOffset(0)
+            , m_InputNumDimensions(0)
+            , m_InputDimensionLengths()
+            , m_NumInputs(0)
+            , m_NumOutputs(0)
+        {
+        }
+
+        bool SampleStore::Open(char const * path, AccessPattern pattern)
+        {
+            Close();
+
+            MappedFile file;
+            if (!file.Open(path) || (file.GetSize() < sizeof(format::StoreHeader)))
+            {
+                return false;
+            }
+
+            format::StoreHeader const & header = *reinterpret_cast<format::StoreHeader const *>(file.GetData());
+            if ((format::c_StoreMagic != header.magic) || (format::c_StoreVersion != header.version) || (format::c_IncompleteNumSamples == header.numSamples))
+            {
+                return false;
+            }
+
+            if ((0 == header.inputNumDimensions) || (header.inputNumDimensions >= c_MaxTensorDimensions))
+            {
+                return false;
+            }
+
+            u64 numInputs = 1;
+            for (u64 dIdx = 0; dIdx < header.inputNumDimensions; ++dIdx)
+            {
+                numInputs *= header.inputDimensionLengths[dIdx];
+            }
+
+            // Catches corrupt headers & truncated files
+            u64 const minRecordSize = (numInputs + header.numOutputs) * sizeof(f32);
+            bool const isRecordValid = (numInputs > 0) && (header.recordSize >= minRecordSize) && (0 == (header.recordSize % format::c_RecordAlignment));
+            bool const isOffsetValid = (header.recordsOffset >= sizeof(header)) && (0 == (header.recordsOffset % format::c_RecordAlignment));
+            if (!isRecordValid || !isOffsetValid || (header.numSamples > ((file.GetSize() - std::min(header.recordsOffset, file.GetSize())) / header.recordSize)))
+            {
+                return false;
+            }
+
+            m_NumSamples = header.numSamples;
+            m_RecordSize = header.recordSize;
+            m_RecordsOffset = header.recordsOffset;
+            m_InputNumDimensions = static_cast<u32>(header.inputNumDimensions);
+            for (u32 dIdx = 0; dIdx < m_InputNumDimensions; ++dIdx)
+            {
+                m_InputDimensionLengths[dIdx] = static_cast<DimensionLength>(header.inputDimensionLengths[dIdx]);
+            }
+            m_NumInputs = numInputs;
+            m_NumOutputs = static_cast<u32>(header.numOutputs);
+
+            m_File = std::move(file);
+            SetAccessPattern(pattern);
+            return true;
+        }
+
+        void SampleStore::Close()
+        {
+            m_File.Close();
+            m_NumSamples = 0;
+            m_RecordSize = 0;
+            m_RecordsOffset = 0;
+            m_InputNumDimensions = 0;
+            m_NumInputs = 0;
+            m_NumOutputs = 0;
+        }
+
+        void SampleStore::SetAccessPattern(AccessPattern pattern) const
+        {
+            m_File.Advise(pattern);
+        }
+
+        void SampleStore::GetBatch(u64 begin, u64 end, Tensor & input, Tensor & expectedOutput) const
+        {
+            ASSERTMSG(IsOpen(), "SampleStore hasn't been opened.");
+            ASSERTMSG((begin < end) && (end <= m_NumSamples), "The batch must hold at least one of the store's samples.");
+
+            // Each sample is a row-major block of its record, the records follow one another
+            u64 const recordStride = m_RecordSize / sizeof(f32);
+            DimensionLength shape[c_MaxTensorDimensions];
+            u64 strides[c_MaxTensorDimensions];
+            shape[0] = static_cast<DimensionLength>(end - begin);
+            strides[0] = recordStride;
+
+            u64 sampleStride = 1;
+            for (u32 dIdx = m_InputNumDimensions; dIdx > 0; --dIdx)
+            {
+                shape[dIdx] = m_InputDimensionLengths[dIdx - 1];
+                strides[dIdx] = sampleStride;
+                sampleStride *= m_InputDimensionLengths[dIdx - 1];
+            }
+
+            f32 * record = GetRecord(begin);
+            input = Tensor::Borrow(record, m_InputNumDimensions + 1, shape, strides);
+
+            if (m_NumOutputs > 0)
+            {
+                DimensionLength const outputShape[] = { shape[0], m_NumOutputs };
+                u64 const outputStrides[] = { recordStride, 1 };
+                expectedOutput = Tensor::Borrow(record + m_NumInputs, LENGTHOF(outputShape), outputShape, outputStrides);
+            }
+            else
+            {
+                expectedOutput = Tensor();
+            }
+        }
+
+        void SampleStore::Gather(u64 const * indices, u32 numIndices, Tensor const & input, Tensor const & expectedOutput) const
+        {
+            ASSERTMSG(IsOpen(), "SampleStore hasn't been opened.");
+            ASSERTMSG(input.IsContiguous() && (input.GetNumElements() == (numIndices * m_NumInputs)), "Gather expects a contiguous input tensor holding numIndices samples.");
+
+            bool const hasExpectedOutput = !expectedOutput.IsEmpty();
+            ASSERTMSG(!hasExpectedOutput || (expectedOutput.IsContiguous() && (expectedOutput.GetNumElements() == (static_cast<u64>(numIndices) * m_NumOutputs))), "Gather expects a contiguous expectedOutput tensor holding numIndices samples.");
+
+            f32 * inputData = input.GetData();
+            f32 * expectedOutputData = hasExpectedOutput ? expectedOutput.GetData() : nullptr;
+            for (u32 iIdx = 0; iIdx < numIndices; ++iIdx)
+            {
+                ASSERTMSG(indices[iIdx] < m_NumSamples, "Sample index is out of range.");
+
+                f32 const * record = GetRecord(indices[iIdx]);
+                memcpy(inputData + (iIdx * m_NumInputs), record, static_cast<size_t>(m_NumInputs * sizeof(f32)));
+                if (hasExpectedOutput)
+                {
+                    memcpy(expectedOutputData + (static_cast<u64>(iIdx) * m_NumOutputs), record + m_NumInputs, m_NumOutputs * sizeof(f32));
+                }
+            }
+        }
+
+        void SampleStore::Prefetch(u64 const * indices, u32 numIndices) const
+        {
+            for (u32 iIdx = 0; iIdx < numIndices; ++iIdx)
+            {
+                ASSERTMSG(indices[iIdx] < m_NumSamples, "Sample index is out of range.");
+                m_File.Prefetch(m_RecordsOffset + (indices[iIdx] * m_RecordSize), m_RecordSize);
+            }
+        }
+    }
+}
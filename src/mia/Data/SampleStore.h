@@ -0,0 +1,167 @@
+#pragma once
+
+#include "Core/Allocator.h"
+#include "Core/MappedFile.h"
+#include "Data/SampleReader.h"
+
+namespace mia
+{
+    namespace data
+    {
+        // Describes the binary sample store format written by WriteSampleStore & read by SampleStore.
+        //
+        // The format is designed to be memory-mapped & used in place:
+        //
+        //  -------------------------
+        //  | StoreHeader           |
+        //  -------------------------   <- aligned to c_RecordAlignment
+        //  | SampleRecord 0        |
+        //  -------------------------   <- aligned to c_RecordAlignment
+        //  | SampleRecord 1        |
+        //  | ...                   |
+        //  -------------------------
+        //
+        // Every sample record holds the sample's inputs (row-major, in the input shape of the model's Flatten
+        // layer) followed by its expected outputs, as f32s, & is padded to the record size. As records are
+        // aligned, the inputs of every sample can be read with aligned SIMD loads exactly like an allocated
+        // matrix. Every header field is a u64 so the layout is the same whichever compiler wrote the file.
+        // Values are stored in the byte order of the machine that wrote the file, a file written by a machine
+        // of the other byte order fails the magic check.
+        namespace format
+        {
+            // "MIASTORE" read as a little-endian u64.
+            u64 constexpr c_StoreMagic = 0x45524F545341494Dull;
+
+            // Incremented whenever the layout changes. Files of any other version are rejected.
+            u64 constexpr c_StoreVersion = 1;
+
+            // The alignment of every record relative to the start of the file.
+            u64 constexpr c_RecordAlignment = c_AllocationAlignment;
+
+            // The number of samples of a file that is being written. A file that still holds it was never
+            // completed (e.g. the process crashed while writing it) & is rejected.
+            u64 constexpr c_IncompleteNumSamples = ~0ull;
+
+            struct StoreHeader
+            {
+                u64 magic;
+                u64 version;
+                u64 numSamples;
+                // The size in bytes of a record & the offset of the first one from the start of the file
+                u64 recordSize;
+                u64 recordsOffset;
+                // The shape of a single sample
+                u64 inputNumDimensions;
+                u64 inputDimensionLengths[c_MaxTensorDimensions];
+                u64 numOutputs;
+            };
+        }
+
+        // Converts a dataset to the sample store format, writing every sample the supplied reader has left to
+        // the file at path. Returns false if the file couldn't be written. The conversion streams the samples
+        // through, so datasets of any size can be converted.
+        bool WriteSampleStore(char const * path, SampleReader & reader);
+
+        // Gives random access to the samples of a sample store (see WriteSampleStore), in O(1) & without
+        // reading the file into memory. The file is memory-mapped: pages are only read from disk as they're
+        // touched & the OS can evict them again under memory pressure, so stores larger than memory can be
+        // trained on.
+        //
+        // Any contiguous range of samples is returned as zero-copy views straight into the mapping (GetBatch),
+        // which Sequential::Train consumes without copying the inputs. Shuffled epochs gather their samples
+        // from the mapping into a caller-owned batch (Gather), a single copy out of the page cache with nothing
+        // to decode. Tell the store which of the two an epoch is about to do (SetAccessPattern) so the OS
+        // reads ahead for sequential epochs & doesn't waste reads on pages a random epoch won't touch yet.
+        class SampleStore final
+        {
+        public:
+            SampleStore();
+            SampleStore(SampleStore const & other) = delete;
+
+            // Maps the sample store at the supplied path, replacing any store that was open. Returns false
+            // (leaving the store closed) if the file couldn't be mapped or isn't a complete sample store.
+            bool Open(char const * path, AccessPattern pattern = AccessPattern::Sequential);
+            // Unmaps the file. Any views returned by GetBatch are invalidated.
+            void Close();
+
+            // Returns true if a store is currently open
+            bool IsOpen() const;
+
+            // Returns the number of samples held by the store.
+            u64 GetNumSamples() const;
+            // Returns the shape of a single sample, see SampleReader.
+            u32 GetInputNumDimensions() const;
+            DimensionLength const * GetInputDimensionLengths() const;
+            u64 GetNumInputs() const;
+            u32 GetNumOutputs() const;
+
+            // Tells the OS the order in which the coming epoch reads the samples, see MappedFile::Advise.
+            void SetAccessPattern(AccessPattern pattern) const;
+
+            // Returns views of samples [begin, end): a (numSamples x inputShape) input tensor & a
+            // (numSamples x numOutputs) expected output tensor. Nothing is copied, the views are strided by the
+            // record size & stay valid until the store is closed. Writes through the views are private to the
+            // process & never reach the file.
+            void GetBatch(u64 begin, u64 end, Tensor & input, Tensor & expectedOutput) const;
+
+            // Copies the samples at the supplied indices (in order) into the supplied contiguous tensors of
+            // shape (numIndices x inputShape) & (numIndices x numOutputs). expectedOutput may be empty if the
+            // expected outputs aren't needed.
+            void Gather(u64 const * indices, u32 numIndices, Tensor const & input, Tensor const & expectedOutput) const;
+            // Asks the OS to start reading the samples at the supplied indices from disk in the background, e.g.
+            // those of the next batch of a shuffled epoch while the current one is trained on.
+            void Prefetch(u64 const * indices, u32 numIndices) const;
+
+        private:
+            // Returns the first element of the record of the supplied sample.
+            f32 * GetRecord(u64 sampleIndex) const;
+
+        private:
+            MappedFile m_File;
+
+            u64 m_NumSamples;
+            u64 m_RecordSize;
+            u64 m_RecordsOffset;
+
+            u32 m_InputNumDimensions;
+            DimensionLength m_InputDimensionLengths[c_MaxTensorDimensions];
+            u64 m_NumInputs;
+            u32 m_NumOutputs;
+        };
+
+        inline bool SampleStore::IsOpen() const
+        {
+            return m_File.IsOpen();
+        }
+
+        inline u64 SampleStore::GetNumSamples() const
+        {
+            return m_NumSamples;
+        }
+
+        inline u32 SampleStore::GetInputNumDimensions() const
+        {
+            return m_InputNumDimensions;
+        }
+
+        inline DimensionLength const * SampleStore::GetInputDimensionLengths() const
+        {
+            return m_InputDimensionLengths;
+        }
+
+        inline u64 SampleStore::GetNumInputs() const
+        {
+            return m_NumInputs;
+        }
+
+        inline u32 SampleStore::GetNumOutputs() const
+        {
+            return m_NumOutputs;
+        }
+
+        inline f32 * SampleStore::GetRecord(u64 sampleIndex) const
+        {
+            return reinterpret_cast<f32 *>(m_File.GetData() + m_RecordsOffset + (sampleIndex * m_RecordSize));
+        }
+    }
+}
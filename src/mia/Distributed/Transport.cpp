@@ -0,0 +1,568 @@
+#include "Transport.h"
+#include "Kernels/Kernels.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <new>
+#include <stdio.h>
+#include <string.h>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if !defined(_WIN32)
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+namespace mia
+{
+    namespace distributed
+    {
+        Transport::Transport(u32 rank, u32 numRanks)
+            : m_Rank(rank)
+            , m_NumRanks(numRanks)
+        {
+            ASSERTMSG(numRanks > 0, "There must be at least one rank.");
+            ASSERTMSG(rank < numRanks, "rank is out of bounds.");
+        }
+
+#if !defined(_WIN32)
+        namespace
+        {
+            // The number of times a rank checks for the other ranks before yielding its core to them.
+            u32 constexpr c_NumSpinsBeforeYielding = 1024;
+
+            // Measures whether the time a rank is allowed to wait for the others has run out.
+            class Deadline final
+            {
+            public:
+                Deadline(u32 timeoutSeconds)
+                    : m_End(std::chrono::steady_clock::now() + std::chrono::seconds(timeoutSeconds))
+                {
+                }
+
+                bool HasPassed() const
+                {
+                    return std::chrono::steady_clock::now() >= m_End;
+                }
+
+                // Returns the number of milliseconds left, e.g. to wait for in poll.
+                int GetMillisecondsLeft() const
+                {
+                    auto const left = std::chrono::duration_cast<std::chrono::milliseconds>(m_End - std::chrono::steady_clock::now()).count();
+                    return static_cast<int>(std::max<decltype(left)>(0, left));
+                }
+
+            private:
+                std::chrono::steady_clock::time_point m_End;
+            };
+
+            // The start of the block of shared memory. Each counter lives on its own cache line, the ranks
+            // spin on them.
+            struct SharedHeader
+            {
+                // Set to c_ReadyValue once rank 0 has set up the block for the session
+                alignas(64) std::atomic<unsigned int> isReady;
+                std::atomic<u64> session;
+                // The number of ranks that have arrived at the current barrier & the number of barriers every
+                // rank has passed
+                alignas(64) std::atomic<unsigned int> numArrived;
+                alignas(64) std::atomic<unsigned int> generation;
+            };
+
+            unsigned int constexpr c_ReadyValue = 0x4D494131; // "MIA1"
+
+            static_assert(sizeof(std::atomic<unsigned int>) == sizeof(unsigned int), "Shared atomics must not hold any state outside the shared memory.");
+            static_assert(sizeof(std::atomic<u64>) == sizeof(u64), "Shared atomics must not hold any state outside the shared memory.");
+
+            // See ConnectSharedMemory. The block holds the header followed by two sets (used by every other
+            // chunk, so a rank can start on the next chunk before the others have read the results of the last)
+            // of a slot per rank & a slot for the results, each of m_ChunkSize values.
+            class SharedMemoryTransport final : public Transport
+            {
+            public:
+                SharedMemoryTransport(u32 rank, u32 numRanks, u64 chunkSize, u32 timeoutSeconds)
+                    : Transport(rank, numRanks)
+                    , m_Name()
+                    , m_Header(nullptr)
+                    , m_Values(nullptr)
+                    , m_Size(0)
+                    , m_ChunkSize(chunkSize)
+                    , m_NumChunks(0)
+                    , m_TimeoutSeconds(timeoutSeconds)
+                    , m_IsBroken(false)
+                {
+                }
+
+                virtual ~SharedMemoryTransport()
+                {
+                    if (nullptr != m_Header)
+                    {
+                        munmap(m_Header, m_Size);
+                    }
+
+                    // The name is only still linked if the other ranks never connected
+                    if ((0 == GetRank()) && !m_Name.empty())
+                    {
+                        shm_unlink(m_Name.c_str());
+                    }
+                }
+
+                bool Connect(char const * name, u64 session)
+                {
+                    // POSIX shared memory names start with a single slash
+                    m_Name = std::string("/") + name;
+                    u64 const numSlots = 2 * (static_cast<u64>(GetNumRanks()) + 1);
+                    m_Size = sizeof(SharedHeader) + (numSlots * m_ChunkSize * sizeof(f32));
+
+                    Deadline const deadline(m_TimeoutSeconds);
+                    if (0 == GetRank())
+                    {
+                        // Any block left behind by ranks that didn't finish connecting is replaced
+                        shm_unlink(m_Name.c_str());
+                        int const fd = shm_open(m_Name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+                        if (fd < 0)
+                        {
+                            return false;
+                        }
+
+                        if (0 != ftruncate(fd, static_cast<off_t>(m_Size)))
+                        {
+                            close(fd);
+                            return false;
+                        }
+
+                        if (!Map(fd))
+                        {
+                            return false;
+                        }
+
+                        // The block is zeroed when created, which is also the initial state of the counters
+                        new (m_Header) SharedHeader();
+                        m_Header->session.store(session, std::memory_order_relaxed);
+                        m_Header->isReady.store(c_ReadyValue, std::memory_order_release);
+                    }
+                    else
+                    {
+                        // Wait for rank 0 to create the block & set it up for this session. A block of an earlier
+                        // session may still be linked until rank 0 replaces it, so the block is opened again
+                        // until it is the right one.
+                        for (;;)
+                        {
+                            int const fd = shm_open(m_Name.c_str(), O_RDWR, 0600);
+                            if (fd >= 0)
+                            {
+                                struct stat status;
+                                if ((0 != fstat(fd, &status)) || (static_cast<u64>(status.st_size) != m_Size))
+                                {
+                                    close(fd);
+                                }
+                                else if (Map(fd))
+                                {
+                                    if ((c_ReadyValue == m_Header->isReady.load(std::memory_order_acquire)) && (session == m_Header->session.load(std::memory_order_relaxed)))
+                                    {
+                                        break;
+                                    }
+
+                                    munmap(m_Header, m_Size);
+                                    m_Header = nullptr;
+                                }
+                            }
+
+                            if (deadline.HasPassed())
+                            {
+                                return false;
+                            }
+                            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                        }
+                    }
+
+                    // Once every rank has mapped the block its name is no longer needed
+                    if (!Wait())
+                    {
+                        return false;
+                    }
+
+                    if (0 == GetRank())
+                    {
+                        shm_unlink(m_Name.c_str());
+                        m_Name.clear();
+                    }
+
+                    return true;
+                }
+
+                virtual bool AllReduce(f32 * data, u64 count) override
+                {
+                    u32 const numRanks = GetNumRanks();
+                    u32 const rank = GetRank();
+
+                    for (u64 first = 0; (first < count) && !m_IsBroken; first += m_ChunkSize)
+                    {
+                        u64 const numValues = std::min(m_ChunkSize, count - first);
+                        u32 const setIndex = static_cast<u32>(m_NumChunks++ & 1);
+
+                        memcpy(GetSlot(setIndex, rank), data + first, numValues * sizeof(f32));
+                        if (!Wait())
+                        {
+                            break;
+                        }
+
+                        // Sum this rank's share of the values over every rank, in the order of the ranks
+                        u64 const begin = (numValues * rank) / numRanks;
+                        u64 const end = (numValues * (rank + 1)) / numRanks;
+                        f32 * results = GetSlot(setIndex, numRanks);
+                        memcpy(results + begin, GetSlot(setIndex, 0) + begin, (end - begin) * sizeof(f32));
+                        for (u32 rIdx = 1; rIdx < numRanks; ++rIdx)
+                        {
+                            kernels::Add(results + begin, GetSlot(setIndex, rIdx) + begin, results + begin, end - begin);
+                        }
+
+                        if (!Wait())
+                        {
+                            break;
+                        }
+
+                        memcpy(data + first, results, numValues * sizeof(f32));
+                    }
+
+                    return !m_IsBroken;
+                }
+
+            private:
+                // Maps the whole block & closes fd, the mapping stays valid once the descriptor is closed. Returns
+                // false if it couldn't be mapped.
+                bool Map(int fd)
+                {
+                    void * const data = mmap(nullptr, m_Size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+                    close(fd);
+                    if (MAP_FAILED == data)
+                    {
+                        return false;
+                    }
+
+                    m_Header = static_cast<SharedHeader *>(data);
+                    m_Values = reinterpret_cast<f32 *>(static_cast<u8 *>(data) + sizeof(SharedHeader));
+                    return true;
+                }
+
+                // Returns the slot of the supplied rank in the supplied set, the slot after the last rank's holds
+                // the results.
+                f32 * GetSlot(u32 setIndex, u32 rank) const
+                {
+                    return m_Values + ((((static_cast<u64>(setIndex) * (GetNumRanks() + 1)) + rank)) * m_ChunkSize);
+                }
+
+                // Waits for every rank to arrive at the same barrier. Returns false if they didn't within the
+                // timeout, in which case the transport is broken.
+                bool Wait()
+                {
+                    unsigned int const generation = m_Header->generation.load(std::memory_order_acquire);
+                    if ((m_Header->numArrived.fetch_add(1, std::memory_order_acq_rel) + 1) == GetNumRanks())
+                    {
+                        // The last rank to arrive releases the others
+                        m_Header->numArrived.store(0, std::memory_order_relaxed);
+                        m_Header->generation.store(generation + 1, std::memory_order_release);
+                        return true;
+                    }
+
+                    Deadline const deadline(m_TimeoutSeconds);
+                    for (u32 sIdx = 0; generation == m_Header->generation.load(std::memory_order_acquire); ++sIdx)
+                    {
+                        // The other ranks may share the core
+                        if (sIdx >= c_NumSpinsBeforeYielding)
+                        {
+                            if (deadline.HasPassed())
+                            {
+                                m_IsBroken = true;
+                                return false;
+                            }
+                            std::this_thread::yield();
+                        }
+                    }
+
+                    return true;
+                }
+
+            private:
+                std::string m_Name;
+                SharedHeader * m_Header;
+                f32 * m_Values;
+                u64 m_Size;
+                u64 m_ChunkSize;
+                // The number of chunks all-reduced so far, which picks the set of slots of the next.
+                u64 m_NumChunks;
+                u32 m_TimeoutSeconds;
+                bool m_IsBroken;
+            };
+
+            // See ConnectSocket.
+            class SocketTransport final : public Transport
+            {
+            public:
+                SocketTransport(u32 rank, u32 numRanks, u32 timeoutSeconds)
+                    : Transport(rank, numRanks)
+                    , m_NextSocket(-1)
+                    , m_PrevSocket(-1)
+                    , m_Buffer()
+                    , m_TimeoutSeconds(timeoutSeconds)
+                    , m_IsBroken(false)
+                {
+                }
+
+                virtual ~SocketTransport()
+                {
+                    if (m_NextSocket >= 0)
+                    {
+                        close(m_NextSocket);
+                    }
+
+                    if (m_PrevSocket >= 0)
+                    {
+                        close(m_PrevSocket);
+                    }
+                }
+
+                bool Connect(char const * path)
+                {
+                    // A single rank has no one to talk to
+                    u32 const numRanks = GetNumRanks();
+                    if (1 == numRanks)
+                    {
+                        return true;
+                    }
+
+                    sockaddr_un address;
+                    sockaddr_un nextAddress;
+                    if (!GetAddress(path, GetRank(), address) || !GetAddress(path, (GetRank() + 1) % numRanks, nextAddress))
+                    {
+                        return false;
+                    }
+
+                    // Listen for the previous rank before connecting to the next, so every rank can connect
+                    int const listener = socket(AF_UNIX, SOCK_STREAM, 0);
+                    if (listener < 0)
+                    {
+                        return false;
+                    }
+
+                    unlink(address.sun_path);
+                    bool isConnected = (0 == bind(listener, reinterpret_cast<sockaddr const *>(&address), sizeof(address))) && (0 == listen(listener, 1));
+
+                    Deadline const deadline(m_TimeoutSeconds);
+                    while (isConnected)
+                    {
+                        m_NextSocket = socket(AF_UNIX, SOCK_STREAM, 0);
+                        if ((m_NextSocket >= 0) && (0 == connect(m_NextSocket, reinterpret_cast<sockaddr const *>(&nextAddress), sizeof(nextAddress))))
+                        {
+                            break;
+                        }
+
+                        // The next rank isn't listening yet
+                        if (m_NextSocket >= 0)
+                        {
+                            close(m_NextSocket);
+                            m_NextSocket = -1;
+                        }
+
+                        isConnected = !deadline.HasPassed();
+                        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                    }
+
+                    if (isConnected)
+                    {
+                        pollfd listening = { listener, POLLIN, 0 };
+                        isConnected = (1 == poll(&listening, 1, deadline.GetMillisecondsLeft()));
+                        m_PrevSocket = isConnected ? accept(listener, nullptr, nullptr) : -1;
+                        isConnected = (m_PrevSocket >= 0);
+                    }
+
+                    // The socket file is only needed to connect
+                    close(listener);
+                    unlink(address.sun_path);
+                    return isConnected;
+                }
+
+                virtual bool AllReduce(f32 * data, u64 count) override
+                {
+                    u32 const numRanks = GetNumRanks();
+                    u32 const rank = GetRank();
+                    if ((1 == numRanks) || m_IsBroken)
+                    {
+                        return !m_IsBroken;
+                    }
+
+                    // The values are split into a chunk per rank, chunk c being [count * c / n, count * (c + 1) / n)
+                    auto getChunkBegin = [count, numRanks](u32 chunkIndex) -> u64
+                    {
+                        return (count * chunkIndex) / numRanks;
+                    };
+                    auto getChunkSize = [&getChunkBegin](u32 chunkIndex) -> u64
+                    {
+                        return getChunkBegin(chunkIndex + 1) - getChunkBegin(chunkIndex);
+                    };
+
+                    m_Buffer.resize(static_cast<size_t>((count + numRanks - 1) / numRanks));
+
+                    // Reduce-scatter: each chunk travels around the ring accumulating every rank's values, until
+                    // rank r holds the sum of chunk r + 1
+                    for (u32 sIdx = 0; sIdx < (numRanks - 1); ++sIdx)
+                    {
+                        u32 const sendChunk = (rank + numRanks - sIdx) % numRanks;
+                        u32 const receiveChunk = (rank + numRanks - sIdx - 1) % numRanks;
+                        if (!Exchange(data + getChunkBegin(sendChunk), getChunkSize(sendChunk), m_Buffer.data(), getChunkSize(receiveChunk)))
+                        {
+                            return false;
+                        }
+
+                        f32 * const values = data + getChunkBegin(receiveChunk);
+                        kernels::Add(m_Buffer.data(), values, values, getChunkSize(receiveChunk));
+                    }
+
+                    // All-gather: the sums travel around the ring once more, so every rank receives the same values
+                    for (u32 sIdx = 0; sIdx < (numRanks - 1); ++sIdx)
+                    {
+                        u32 const sendChunk = (rank + 1 + numRanks - sIdx) % numRanks;
+                        u32 const receiveChunk = (rank + numRanks - sIdx) % numRanks;
+                        if (!Exchange(data + getChunkBegin(sendChunk), getChunkSize(sendChunk), data + getChunkBegin(receiveChunk), getChunkSize(receiveChunk)))
+                        {
+                            return false;
+                        }
+                    }
+
+                    return true;
+                }
+
+            private:
+                // Fills address with that of the socket file of the supplied rank. Returns false if the path is
+                // too long for a socket address.
+                static bool GetAddress(char const * path, u32 rank, sockaddr_un & address)
+                {
+                    memset(&address, 0, sizeof(address));
+                    address.sun_family = AF_UNIX;
+                    int const length = snprintf(address.sun_path, sizeof(address.sun_path), "%s.%u", path, static_cast<unsigned int>(rank));
+                    return (length > 0) && (static_cast<size_t>(length) < sizeof(address.sun_path));
+                }
+
+                // Sends numSendValues values to the next rank while receiving numReceiveValues values from the
+                // previous one. Both happen at once: every rank sends before it receives, so sending everything
+                // first could leave every rank waiting for the others to make room in their sockets.
+                bool Exchange(f32 const * sendValues, u64 numSendValues, f32 * receiveValues, u64 numReceiveValues)
+                {
+                    u8 const * sendBytes = reinterpret_cast<u8 const *>(sendValues);
+                    u8 * receiveBytes = reinterpret_cast<u8 *>(receiveValues);
+                    u64 numBytesToSend = numSendValues * sizeof(f32);
+                    u64 numBytesToReceive = numReceiveValues * sizeof(f32);
+
+                    Deadline const deadline(m_TimeoutSeconds);
+                    while ((numBytesToSend > 0) || (numBytesToReceive > 0))
+                    {
+                        pollfd sockets[2];
+                        nfds_t numSockets = 0;
+                        if (numBytesToSend > 0)
+                        {
+                            sockets[numSockets++] = { m_NextSocket, POLLOUT, 0 };
+                        }
+                        if (numBytesToReceive > 0)
+                        {
+                            sockets[numSockets++] = { m_PrevSocket, POLLIN, 0 };
+                        }
+
+                        int const numReady = poll(sockets, numSockets, deadline.GetMillisecondsLeft());
+                        if ((numReady < 0) && (EINTR == errno))
+                        {
+                            continue;
+                        }
+
+                        m_IsBroken = (numReady <= 0);
+                        for (nfds_t pIdx = 0; (pIdx < numSockets) && !m_IsBroken; ++pIdx)
+                        {
+                            if (0 == sockets[pIdx].revents)
+                            {
+                                continue;
+                            }
+
+                            // A peer that went away shows up as an error or as the end of the stream
+                            ssize_t numBytes = 0;
+                            if (m_NextSocket == sockets[pIdx].fd)
+                            {
+                                numBytes = send(m_NextSocket, sendBytes, numBytesToSend, MSG_DONTWAIT | MSG_NOSIGNAL);
+                                sendBytes += (numBytes > 0) ? numBytes : 0;
+                                numBytesToSend -= (numBytes > 0) ? numBytes : 0;
+                            }
+                            else
+                            {
+                                numBytes = recv(m_PrevSocket, receiveBytes, numBytesToReceive, MSG_DONTWAIT);
+                                receiveBytes += (numBytes > 0) ? numBytes : 0;
+                                numBytesToReceive -= (numBytes > 0) ? numBytes : 0;
+                                m_IsBroken = (0 == numBytes);
+                            }
+
+                            m_IsBroken = m_IsBroken || ((numBytes < 0) && (EAGAIN != errno) && (EWOULDBLOCK != errno) && (EINTR != errno));
+                        }
+
+                        if (m_IsBroken)
+                        {
+                            return false;
+                        }
+                    }
+
+                    return true;
+                }
+
+            private:
+                // The connections to the next & previous ranks of the ring.
+                int m_NextSocket;
+                int m_PrevSocket;
+                // Receives the values added to this rank's.
+                std::vector<f32> m_Buffer;
+                u32 m_TimeoutSeconds;
+                bool m_IsBroken;
+            };
+        }
+#endif
+
+        std::unique_ptr<Transport> ConnectSharedMemory(char const * name, u64 session, u32 rank, u32 numRanks, u64 chunkSize, u32 timeoutSeconds)
+        {
+            ASSERTMSG(nullptr != name, "name is not a valid ptr.");
+            ASSERTMSG(chunkSize > 0, "chunkSize must be greater than zero.");
+
+#if defined(_WIN32)
+            // Not supported yet
+            return nullptr;
+#else
+            std::unique_ptr<SharedMemoryTransport> transport(new SharedMemoryTransport(rank, numRanks, chunkSize, timeoutSeconds));
+            if (!transport->Connect(name, session))
+            {
+                return nullptr;
+            }
+            return transport;
+#endif
+        }
+
+        std::unique_ptr<Transport> ConnectSocket(char const * path, u32 rank, u32 numRanks, u32 timeoutSeconds)
+        {
+            ASSERTMSG(nullptr != path, "path is not a valid ptr.");
+
+#if defined(_WIN32)
+            // Not supported yet
+            return nullptr;
+#else
+            std::unique_ptr<SocketTransport> transport(new SocketTransport(rank, numRanks, timeoutSeconds));
+            if (!transport->Connect(path))
+            {
+                return nullptr;
+            }
+            return transport;
+#endif
+        }
+    }
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include "Common.h"
+
+#include <memory>
+
+namespace mia
+{
+    namespace distributed
+    {
+        // Connects the processes (ranks) training a model together, e.g. on the cores of a single host, so they
+        // can combine their gradients (see models::DistributedTrainer). Every rank opens a transport of the same
+        // kind & name with its own rank in the range [0, numRanks), then makes the same sequence of collective
+        // calls. Not thread-safe, a single thread of each rank makes the calls.
+        class Transport
+        {
+        public:
+            Transport(Transport const & other) = delete;
+            virtual ~Transport() = default;
+
+            // Replaces the count values of data by their sum over every rank, once every rank has called it
+            // with the same count. The sum is made in the same order for every rank, so every rank receives
+            // exactly the same values. Returns false (leaving data undefined) if another rank couldn't be
+            // reached, after which the transport can't be used any more.
+            virtual bool AllReduce(f32 * data, u64 count) = 0;
+
+            // Returns the rank of the calling process & the number of ranks connected.
+            u32 GetRank() const;
+            u32 GetNumRanks() const;
+
+        protected:
+            Transport(u32 rank, u32 numRanks);
+
+        private:
+            u32 m_Rank;
+            u32 m_NumRanks;
+        };
+
+        // Connects numRanks ranks through a block of shared memory of the supplied name, which every rank maps.
+        // Each rank copies its values into the block, then sums its own share of the values of every rank, so
+        // each value is only summed once. Values are exchanged in chunks of up to chunkSize values, the block
+        // holds two chunks per rank. Every rank must pass the same session, which must differ from that of any
+        // earlier run of the ranks (e.g. the launcher's process id & start time), so a block left behind by ranks
+        // that crashed is never mistaken for the current one. Returns nullptr if the shared memory couldn't be
+        // created or mapped, or the other ranks didn't connect within timeoutSeconds.
+        std::unique_ptr<Transport> ConnectSharedMemory(char const * name, u64 session, u32 rank, u32 numRanks, u64 chunkSize = 256 * 1024, u32 timeoutSeconds = 30);
+
+        // Connects numRanks ranks in a ring of Unix domain sockets: each rank listens on the socket file
+        // path.<rank> & connects to that of the next rank. The values are all-reduced around the ring, each
+        // rank sending & receiving (2 * (numRanks - 1) / numRanks) times the values whatever the number of
+        // ranks. Returns nullptr if the sockets couldn't be created or the other ranks didn't connect within
+        // timeoutSeconds.
+        std::unique_ptr<Transport> ConnectSocket(char const * path, u32 rank, u32 numRanks, u32 timeoutSeconds = 30);
+
+        inline u32 Transport::GetRank() const
+        {
+            return m_Rank;
+        }
+
+        inline u32 Transport::GetNumRanks() const
+        {
+            return m_NumRanks;
+        }
+    }
+}
@@ -0,0 +1,126 @@
+#include "Initializer.h"
+
+#include "Maths/Random.h"
+
+#include <algorithm>
+#include <math.h>
+
+namespace mia
+{
+    namespace initializers
+    {
+        Initializer Initializer::Default()
+        {
+            return Initializer();
+        }
+
+        Initializer Initializer::Constant(f32 value)
+        {
+            Initializer initializer;
+            initializer.type = InitializerType::Constant;
+            initializer.value = value;
+            return initializer;
+        }
+
+        Initializer Initializer::Uniform(f32 low, f32 high)
+        {
+            Initializer initializer;
+            initializer.type = InitializerType::Uniform;
+            initializer.low = low;
+            initializer.high = high;
+            return initializer;
+        }
+
+        Initializer Initializer::Normal(f32 mean, f32 standardDeviation)
+        {
+            Initializer initializer;
+            initializer.type = InitializerType::Normal;
+            initializer.mean = mean;
+            initializer.standardDeviation = standardDeviation;
+            return initializer;
+        }
+
+        Initializer Initializer::XavierUniform()
+        {
+            Initializer initializer;
+            initializer.type = InitializerType::XavierUniform;
+            return initializer;
+        }
+
+        Initializer Initializer::XavierNormal()
+        {
+            Initializer initializer;
+            initializer.type = InitializerType::XavierNormal;
+            return initializer;
+        }
+
+        Initializer Initializer::HeUniform()
+        {
+            Initializer initializer;
+            initializer.type = InitializerType::HeUniform;
+            return initializer;
+        }
+
+        Initializer Initializer::HeNormal()
+        {
+            Initializer initializer;
+            initializer.type = InitializerType::HeNormal;
+            return initializer;
+        }
+
+        void Initialize(Initializer const & initializer, activators::ActivatorType activatorType, u32 fanIn, u32 fanOut, u64 seed, u64 stream, Matrix & parameters)
+        {
+            InitializerType type = initializer.type;
+            if (InitializerType::Default == type)
+            {
+                type = (activators::ActivatorType::ReLU == activatorType) ? InitializerType::HeNormal : InitializerType::XavierUniform;
+            }
+
+            f32 * const data = parameters.GetData();
+            u64 const numParameters = parameters.GetCapacity();
+            f64 const numInputs = static_cast<f64>(std::max(fanIn, static_cast<u32>(1)));
+            f64 const numInputsAndOutputs = static_cast<f64>(std::max(fanIn + fanOut, static_cast<u32>(1)));
+
+            switch (type)
+            {
+                case InitializerType::Constant:
+                    std::fill(data, data + numParameters, initializer.value);
+                    break;
+
+                case InitializerType::Uniform:
+                    rng::FillUniform(seed, stream, initializer.low, initializer.high, data, numParameters);
+                    break;
+
+                case InitializerType::Normal:
+                    rng::FillNormal(seed, stream, initializer.mean, initializer.standardDeviation, data, numParameters);
+                    break;
+
+                case InitializerType::XavierUniform:
+                {
+                    f32 const limit = static_cast<f32>(sqrt(6.0 / numInputsAndOutputs));
+                    rng::FillUniform(seed, stream, -limit, limit, data, numParameters);
+                    break;
+                }
+
+                case InitializerType::XavierNormal:
+                    rng::FillNormal(seed, stream, 0.0f, static_cast<f32>(sqrt(2.0 / numInputsAndOutputs)), data, numParameters);
+                    break;
+
+                case InitializerType::HeUniform:
+                {
+                    f32 const limit = static_cast<f32>(sqrt(6.0 / numInputs));
+                    rng::FillUniform(seed, stream, -limit, limit, data, numParameters);
+                    break;
+                }
+
+                case InitializerType::HeNormal:
+                    rng::FillNormal(seed, stream, 0.0f, static_cast<f32>(sqrt(2.0 / numInputs)), data, numParameters);
+                    break;
+
+                default:
+                    ASSERTMSG(false, "Unknown InitializerType.");
+                    break;
+            }
+        }
+    }
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+#include "Common.h"
+#include "Activators/Activators.h"
+#include "Maths/Matrix.h"
+
+namespace mia
+{
+    namespace initializers
+    {
+        enum class InitializerType : u8
+        {
+            // HeNormal for layers with ReLU activators, XavierUniform otherwise
+            Default,
+            Constant,
+            Uniform,
+            Normal,
+            // Scaled by the number of inputs & outputs of each neuron (Glorot & Bengio, 2010)
+            XavierUniform,
+            XavierNormal,
+            // Scaled by the number of inputs of each neuron (He et al., 2015)
+            HeUniform,
+            HeNormal
+        };
+
+        // Describes how a matrix of parameters is filled when a layer is compiled. Only the values used by the
+        // selected type are read.
+        struct Initializer
+        {
+            InitializerType type = InitializerType::Default;
+
+            // Constant
+            f32 value = 0.0f;
+
+            // Uniform
+            f32 low = 0.0f;
+            f32 high = 1.0f;
+
+            // Normal
+            f32 mean = 0.0f;
+            f32 standardDeviation = 1.0f;
+
+            // Returns the initializer suited to the layer's activator.
+            static Initializer Default();
+            // Returns an initializer filling every parameter with value.
+            static Initializer Constant(f32 value);
+            // Returns an initializer drawing parameters uniformly between low & high.
+            static Initializer Uniform(f32 low, f32 high);
+            // Returns an initializer drawing parameters from a normal distribution.
+            static Initializer Normal(f32 mean, f32 standardDeviation);
+            // Returns an initializer drawing parameters uniformly between +/- sqrt(6 / (fanIn + fanOut)).
+            static Initializer XavierUniform();
+            // Returns an initializer drawing parameters from N(0, 2 / (fanIn + fanOut)).
+            static Initializer XavierNormal();
+            // Returns an initializer drawing parameters uniformly between +/- sqrt(6 / fanIn).
+            static Initializer HeUniform();
+            // Returns an initializer drawing parameters from N(0, 2 / fanIn).
+            static Initializer HeNormal();
+        };
+
+        // Fills parameters as described by initializer, drawing from the supplied stream of seed (see
+        // Maths/Random.h). fanIn & fanOut are the number of inputs & outputs of each neuron the parameters
+        // belong to & activatorType is the activator of the layer they belong to.
+        void Initialize(Initializer const & initializer, activators::ActivatorType activatorType, u32 fanIn, u32 fanOut, u64 seed, u64 stream, Matrix & parameters);
+    }
+}
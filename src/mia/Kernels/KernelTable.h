@@ -0,0 +1,79 @@
+#pragma once
+
+#include "Common.h"
+#include "Kernels.h"
+
+namespace mia
+{
+    namespace kernels
+    {
+        // Operations a GEMM micro-kernel applies to its tile of c, while the tile is still in registers,
+        // before writing it back. Only supplied for the final kc step of each tile.
+        struct GemmEpilogue
+        {
+            // One value per row of the tile that is added to every element of the row (or nullptr).
+            f32 const * rowBias;
+            // If not nullptr, the tile is also written here after the bias add but before the ReLU.
+            // Uses the same row stride as c.
+            f32 * preActivation;
+            // Clamps negative values of the tile to zero.
+            bool relu;
+        };
+
+        // Computes an mr x nr tile of c from a packed panel of a (mr rows, interleaved per column) &
+        // a packed panel of b (nr columns, interleaved per row) over kc steps. Only the top-left
+        // numRows x numCols of the tile are written back to c, which handles the edges of c. When
+        // accumulate is set the tile is added to the existing contents of c. The epilogue (if not
+        // nullptr) is applied after accumulating.
+        typedef void (*GemmMicroKernel)(u32 kc, f32 const * a, f32 const * b, f32 * c, u64 rowStrideC, u32 numRows, u32 numCols, bool accumulate, GemmEpilogue const * epilogue);
+
+        // Describes a GEMM micro-kernel along with the register tile & cache blocking it was tuned for.
+        struct GemmKernelInfo
+        {
+            u32 mr;
+            u32 nr;
+            u32 kc;
+            u32 mc;
+            u32 nc;
+            GemmMicroKernel kernel;
+        };
+
+        // A table of every kernel implemented for a particular instruction set.
+        struct KernelTable
+        {
+            char const * name;
+
+            void (*add)(f32 const * a, f32 const * b, f32 * dst, u64 length);
+            void (*scale)(f32 const * a, f32 scale, f32 * dst, u64 length);
+            void (*multiplyAdd)(f32 const * a, f32 scale, f32 const * b, f32 * dst, u64 length);
+            void (*relu)(f32 const * a, f32 * dst, u64 length);
+            void (*leakyReLU)(f32 const * a, f32 slope, f32 * dst, u64 length);
+            void (*sigmoid)(f32 const * a, f32 * dst, u64 length, MathPrecision precision);
+            void (*tanh)(f32 const * a, f32 * dst, u64 length, MathPrecision precision);
+            void (*gelu)(f32 const * a, f32 * dst, u64 length, MathPrecision precision);
+            void (*silu)(f32 const * a, f32 * dst, u64 length, MathPrecision precision);
+            bool (*allClose)(f32 const * a, f32 const * b, u64 length, f32 tolerance);
+            f32 (*sum)(f32 const * a, u64 length);
+            f32 (*dot)(f32 const * a, f32 const * b, u64 length);
+            f32 (*max)(f32 const * a, u64 length);
+            void (*sgdUpdate)(f32 * params, f32 * velocity, f32 const * gradients, u64 length, SGDStep const & step);
+            void (*adamUpdate)(f32 * params, f32 * moment1, f32 * moment2, f32 const * gradients, u64 length, AdamStep const & step);
+            void (*transpose)(f32 const * a, u64 rowStride, u32 numRows, u32 numCols, f32 * dst, u64 dstRowStride);
+            void (*randomUniform)(u64 key, u64 stream, u64 firstIndex, f32 low, f32 high, f32 * dst, u64 length);
+            void (*randomNormal)(u64 key, u64 stream, u64 firstIndex, f32 mean, f32 standardDeviation, f32 * dst, u64 length);
+
+            GemmKernelInfo gemm;
+        };
+
+        // Each instruction set's table is implemented in its own translation unit which is compiled
+        // with the matching code generation flags. These return nullptr if the instruction set wasn't
+        // compiled into this build (e.g. NEON on x86).
+        KernelTable const * GetScalarKernelTable();
+        KernelTable const * GetAVX2KernelTable();
+        KernelTable const * GetAVX512KernelTable();
+        KernelTable const * GetNEONKernelTable();
+
+        // Returns the table for the most capable instruction set supported by the running CPU.
+        KernelTable const & GetKernelTable();
+    }
+}
@@ -0,0 +1,853 @@
+#include "KernelTable.h"
+
+// This translation unit is compiled with AVX2 & FMA code generation enabled (see CMakeLists.txt) and
+// must only be entered once the CPU has been confirmed to support them. Avoid calling any inline
+// functions from shared headers in here as the linker could otherwise pick these AVX2 copies for
+// callers in other translation units (ScalarElements.inl is safe, its functions have internal linkage).
+#if defined(__AVX2__)
+
+#include <immintrin.h>
+#include <math.h>
+#include <string.h>
+
+#include "ScalarElements.inl"
+
+namespace mia
+{
+    namespace kernels
+    {
+        namespace
+        {
+            u64 constexpr c_Width = 8;
+
+            inline __m256 Abs(__m256 x)
+            {
+                return _mm256_andnot_ps(_mm256_set1_ps(-0.0f), x);
+            }
+
+            inline f32 HorizontalSum(__m256 x)
+            {
+                __m128 const sum4 = _mm_add_ps(_mm256_castps256_ps128(x), _mm256_extractf128_ps(x, 1));
+                __m128 const sum2 = _mm_add_ps(sum4, _mm_movehl_ps(sum4, sum4));
+                __m128 const sum1 = _mm_add_ss(sum2, _mm_shuffle_ps(sum2, sum2, 0x55));
+                return _mm_cvtss_f32(sum1);
+            }
+
+            inline f32 HorizontalMax(__m256 x)
+            {
+                __m128 const max4 = _mm_max_ps(_mm256_castps256_ps128(x), _mm256_extractf128_ps(x, 1));
+                __m128 const max2 = _mm_max_ps(max4, _mm_movehl_ps(max4, max4));
+                __m128 const max1 = _mm_max_ss(max2, _mm_shuffle_ps(max2, max2, 0x55));
+                return _mm_cvtss_f32(max1);
+            }
+
+            void Add(f32 const * a, f32 const * b, f32 * dst, u64 length)
+            {
+                u64 eIdx = 0;
+                for (; eIdx + c_Width <= length; eIdx += c_Width)
+                {
+                    _mm256_storeu_ps(dst + eIdx, _mm256_add_ps(_mm256_loadu_ps(a + eIdx), _mm256_loadu_ps(b + eIdx)));
+                }
+                for (; eIdx < length; ++eIdx)
+                {
+                    dst[eIdx] = a[eIdx] + b[eIdx];
+                }
+            }
+
+            void Scale(f32 const * a, f32 scale, f32 * dst, u64 length)
+            {
+                __m256 const scaleVec = _mm256_set1_ps(scale);
+
+                u64 eIdx = 0;
+                for (; eIdx + c_Width <= length; eIdx += c_Width)
+                {
+                    _mm256_storeu_ps(dst + eIdx, _mm256_mul_ps(_mm256_loadu_ps(a + eIdx), scaleVec));
+                }
+                for (; eIdx < length; ++eIdx)
+                {
+                    dst[eIdx] = a[eIdx] * scale;
+                }
+            }
+
+            void MultiplyAdd(f32 const * a, f32 scale, f32 const * b, f32 * dst, u64 length)
+            {
+                __m256 const scaleVec = _mm256_set1_ps(scale);
+
+                u64 eIdx = 0;
+                for (; eIdx + c_Width <= length; eIdx += c_Width)
+                {
+                    _mm256_storeu_ps(dst + eIdx, _mm256_fmadd_ps(_mm256_loadu_ps(a + eIdx), scaleVec, _mm256_loadu_ps(b + eIdx)));
+                }
+                for (; eIdx < length; ++eIdx)
+                {
+                    dst[eIdx] = (a[eIdx] * scale) + b[eIdx];
+                }
+            }
+
+            void ReLU(f32 const * a, f32 * dst, u64 length)
+            {
+                __m256 const zero = _mm256_setzero_ps();
+
+                u64 eIdx = 0;
+                for (; eIdx + c_Width <= length; eIdx += c_Width)
+                {
+                    _mm256_storeu_ps(dst + eIdx, _mm256_max_ps(_mm256_loadu_ps(a + eIdx), zero));
+                }
+                for (; eIdx < length; ++eIdx)
+                {
+                    dst[eIdx] = (a[eIdx] > 0.0f) ? a[eIdx] : 0.0f;
+                }
+            }
+
+            void LeakyReLU(f32 const * a, f32 slope, f32 * dst, u64 length)
+            {
+                __m256 const slopeVec = _mm256_set1_ps(slope);
+
+                u64 eIdx = 0;
+                for (; eIdx + c_Width <= length; eIdx += c_Width)
+                {
+                    __m256 const x = _mm256_loadu_ps(a + eIdx);
+                    __m256 const isPositive = _mm256_cmp_ps(x, _mm256_setzero_ps(), _CMP_GT_OQ);
+                    _mm256_storeu_ps(dst + eIdx, _mm256_blendv_ps(_mm256_mul_ps(x, slopeVec), x, isPositive));
+                }
+                for (; eIdx < length; ++eIdx)
+                {
+                    dst[eIdx] = (a[eIdx] > 0.0f) ? a[eIdx] : (a[eIdx] * slope);
+                }
+            }
+
+            bool AllClose(f32 const * a, f32 const * b, u64 length, f32 tolerance)
+            {
+                __m256 const toleranceVec = _mm256_set1_ps(tolerance);
+
+                u64 eIdx = 0;
+                for (; eIdx + c_Width <= length; eIdx += c_Width)
+                {
+                    __m256 const difference = Abs(_mm256_sub_ps(_mm256_loadu_ps(a + eIdx), _mm256_loadu_ps(b + eIdx)));
+
+                    // Ordered comparison, NaNs produce false
+                    __m256 const isClose = _mm256_cmp_ps(difference, toleranceVec, _CMP_LE_OQ);
+                    if (0xFF != _mm256_movemask_ps(isClose))
+                    {
+                        return false;
+                    }
+                }
+                for (; eIdx < length; ++eIdx)
+                {
+                    f32 const difference = a[eIdx] - b[eIdx];
+                    f32 const absDifference = (difference < 0.0f) ? -difference : difference;
+                    if (!(absDifference <= tolerance))
+                    {
+                        return false;
+                    }
+                }
+
+                return true;
+            }
+
+            f32 Sum(f32 const * a, u64 length)
+            {
+                __m256 sum0 = _mm256_setzero_ps();
+                __m256 sum1 = _mm256_setzero_ps();
+
+                u64 eIdx = 0;
+                for (; eIdx + (2 * c_Width) <= length; eIdx += 2 * c_Width)
+                {
+                    sum0 = _mm256_add_ps(sum0, _mm256_loadu_ps(a + eIdx));
+                    sum1 = _mm256_add_ps(sum1, _mm256_loadu_ps(a + eIdx + c_Width));
+                }
+
+                f32 result = HorizontalSum(_mm256_add_ps(sum0, sum1));
+                for (; eIdx < length; ++eIdx)
+                {
+                    result += a[eIdx];
+                }
+
+                return result;
+            }
+
+            f32 Dot(f32 const * a, f32 const * b, u64 length)
+            {
+                __m256 sum0 = _mm256_setzero_ps();
+                __m256 sum1 = _mm256_setzero_ps();
+
+                u64 eIdx = 0;
+                for (; eIdx + (2 * c_Width) <= length; eIdx += 2 * c_Width)
+                {
+                    sum0 = _mm256_fmadd_ps(_mm256_loadu_ps(a + eIdx), _mm256_loadu_ps(b + eIdx), sum0);
+                    sum1 = _mm256_fmadd_ps(_mm256_loadu_ps(a + eIdx + c_Width), _mm256_loadu_ps(b + eIdx + c_Width), sum1);
+                }
+
+                f32 result = HorizontalSum(_mm256_add_ps(sum0, sum1));
+                for (; eIdx < length; ++eIdx)
+                {
+                    result += a[eIdx] * b[eIdx];
+                }
+
+                return result;
+            }
+
+            f32 Max(f32 const * a, u64 length)
+            {
+                f32 result = a[0];
+
+                u64 eIdx = 0;
+                if (length >= c_Width)
+                {
+                    __m256 maxVec = _mm256_loadu_ps(a);
+                    for (eIdx = c_Width; eIdx + c_Width <= length; eIdx += c_Width)
+                    {
+                        maxVec = _mm256_max_ps(maxVec, _mm256_loadu_ps(a + eIdx));
+                    }
+                    result = HorizontalMax(maxVec);
+                }
+                for (; eIdx < length; ++eIdx)
+                {
+                    result = (a[eIdx] > result) ? a[eIdx] : result;
+                }
+
+                return result;
+            }
+
+            void SGDUpdate(f32 * params, f32 * velocity, f32 const * gradients, u64 length, SGDStep const & step)
+            {
+                __m256 const learningRate = _mm256_set1_ps(step.learningRate);
+                __m256 const momentum = _mm256_set1_ps(step.momentum);
+                __m256 const weightDecay = _mm256_set1_ps(step.weightDecay);
+
+                u64 eIdx = 0;
+                for (; eIdx + c_Width <= length; eIdx += c_Width)
+                {
+                    __m256 const param = _mm256_loadu_ps(params + eIdx);
+                    __m256 update = _mm256_fmadd_ps(weightDecay, param, _mm256_loadu_ps(gradients + eIdx));
+                    if (nullptr != velocity)
+                    {
+                        update = _mm256_fmadd_ps(momentum, _mm256_loadu_ps(velocity + eIdx), update);
+                        _mm256_storeu_ps(velocity + eIdx, update);
+                    }
+                    _mm256_storeu_ps(params + eIdx, _mm256_fnmadd_ps(learningRate, update, param));
+                }
+                for (; eIdx < length; ++eIdx)
+                {
+                    SGDUpdateElement(params[eIdx], (nullptr != velocity) ? velocity + eIdx : nullptr, gradients[eIdx], step);
+                }
+            }
+
+            void AdamUpdate(f32 * params, f32 * moment1, f32 * moment2, f32 const * gradients, u64 length, AdamStep const & step)
+            {
+                __m256 const beta1 = _mm256_set1_ps(step.beta1);
+                __m256 const oneMinusBeta1 = _mm256_set1_ps(1.0f - step.beta1);
+                __m256 const beta2 = _mm256_set1_ps(step.beta2);
+                __m256 const oneMinusBeta2 = _mm256_set1_ps(1.0f - step.beta2);
+                __m256 const epsilon = _mm256_set1_ps(step.epsilon);
+                __m256 const stepSize = _mm256_set1_ps(step.stepSize);
+                __m256 const rsqrtSecondMomentCorrection = _mm256_set1_ps(step.rsqrtSecondMomentCorrection);
+                __m256 const gradientDecay = _mm256_set1_ps(step.gradientDecay);
+                __m256 const paramRetention = _mm256_set1_ps(1.0f - step.parameterDecay);
+
+                u64 eIdx = 0;
+                for (; eIdx + c_Width <= length; eIdx += c_Width)
+                {
+                    __m256 const param = _mm256_loadu_ps(params + eIdx);
+                    __m256 const gradient = _mm256_fmadd_ps(gradientDecay, param, _mm256_loadu_ps(gradients + eIdx));
+
+                    __m256 const m1 = _mm256_fmadd_ps(beta1, _mm256_loadu_ps(moment1 + eIdx), _mm256_mul_ps(oneMinusBeta1, gradient));
+                    __m256 const m2 = _mm256_fmadd_ps(beta2, _mm256_loadu_ps(moment2 + eIdx), _mm256_mul_ps(oneMinusBeta2, _mm256_mul_ps(gradient, gradient)));
+                    _mm256_storeu_ps(moment1 + eIdx, m1);
+                    _mm256_storeu_ps(moment2 + eIdx, m2);
+
+                    __m256 const denominator = _mm256_fmadd_ps(_mm256_sqrt_ps(m2), rsqrtSecondMomentCorrection, epsilon);
+                    __m256 const update = _mm256_div_ps(_mm256_mul_ps(stepSize, m1), denominator);
+                    _mm256_storeu_ps(params + eIdx, _mm256_fmsub_ps(param, paramRetention, update));
+                }
+                for (; eIdx < length; ++eIdx)
+                {
+                    AdamUpdateElement(params[eIdx], moment1[eIdx], moment2[eIdx], gradients[eIdx], step);
+                }
+            }
+
+            // Transposes the 8 x 8 block of a starting at a into the 8 x 8 block of dst starting at dst,
+            // entirely in registers (unpack pairs of rows, shuffle pairs of pairs, swap 128 bit halves).
+            inline void Transpose8x8(f32 const * a, u64 rowStride, f32 * dst, u64 dstRowStride)
+            {
+                __m256 const r0 = _mm256_loadu_ps(a + (0 * rowStride));
+                __m256 const r1 = _mm256_loadu_ps(a + (1 * rowStride));
+                __m256 const r2 = _mm256_loadu_ps(a + (2 * rowStride));
+                __m256 const r3 = _mm256_loadu_ps(a + (3 * rowStride));
+                __m256 const r4 = _mm256_loadu_ps(a + (4 * rowStride));
+                __m256 const r5 = _mm256_loadu_ps(a + (5 * rowStride));
+                __m256 const r6 = _mm256_loadu_ps(a + (6 * rowStride));
+                __m256 const r7 = _mm256_loadu_ps(a + (7 * rowStride));
+
+                __m256 const t0 = _mm256_unpacklo_ps(r0, r1);
+                __m256 const t1 = _mm256_unpackhi_ps(r0, r1);
+                __m256 const t2 = _mm256_unpacklo_ps(r2, r3);
+                __m256 const t3 = _mm256_unpackhi_ps(r2, r3);
+                __m256 const t4 = _mm256_unpacklo_ps(r4, r5);
+                __m256 const t5 = _mm256_unpackhi_ps(r4, r5);
+                __m256 const t6 = _mm256_unpacklo_ps(r6, r7);
+                __m256 const t7 = _mm256_unpackhi_ps(r6, r7);
+
+                __m256 const s0 = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(1, 0, 1, 0));
+                __m256 const s1 = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(3, 2, 3, 2));
+                __m256 const s2 = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(1, 0, 1, 0));
+                __m256 const s3 = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(3, 2, 3, 2));
+                __m256 const s4 = _mm256_shuffle_ps(t4, t6, _MM_SHUFFLE(1, 0, 1, 0));
+                __m256 const s5 = _mm256_shuffle_ps(t4, t6, _MM_SHUFFLE(3, 2, 3, 2));
+                __m256 const s6 = _mm256_shuffle_ps(t5, t7, _MM_SHUFFLE(1, 0, 1, 0));
+                __m256 const s7 = _mm256_shuffle_ps(t5, t7, _MM_SHUFFLE(3, 2, 3, 2));
+
+                _mm256_storeu_ps(dst + (0 * dstRowStride), _mm256_permute2f128_ps(s0, s4, 0x20));
+                _mm256_storeu_ps(dst + (1 * dstRowStride), _mm256_permute2f128_ps(s1, s5, 0x20));
+                _mm256_storeu_ps(dst + (2 * dstRowStride), _mm256_permute2f128_ps(s2, s6, 0x20));
+                _mm256_storeu_ps(dst + (3 * dstRowStride), _mm256_permute2f128_ps(s3, s7, 0x20));
+                _mm256_storeu_ps(dst + (4 * dstRowStride), _mm256_permute2f128_ps(s0, s4, 0x31));
+                _mm256_storeu_ps(dst + (5 * dstRowStride), _mm256_permute2f128_ps(s1, s5, 0x31));
+                _mm256_storeu_ps(dst + (6 * dstRowStride), _mm256_permute2f128_ps(s2, s6, 0x31));
+                _mm256_storeu_ps(dst + (7 * dstRowStride), _mm256_permute2f128_ps(s3, s7, 0x31));
+            }
+
+            void Transpose(f32 const * a, u64 rowStride, u32 numRows, u32 numCols, f32 * dst, u64 dstRowStride)
+            {
+                // Walk down each strip of 8 columns of a, so every row of dst is written contiguously
+                u32 cIdx = 0;
+                for (; cIdx + 8 <= numCols; cIdx += 8)
+                {
+                    u32 rIdx = 0;
+                    for (; rIdx + 8 <= numRows; rIdx += 8)
+                    {
+                        Transpose8x8(a + (rIdx * rowStride) + cIdx, rowStride, dst + (cIdx * dstRowStride) + rIdx, dstRowStride);
+                    }
+                    for (; rIdx < numRows; ++rIdx)
+                    {
+                        for (u32 iIdx = cIdx; iIdx < cIdx + 8; ++iIdx)
+                        {
+                            dst[(iIdx * dstRowStride) + rIdx] = a[(rIdx * rowStride) + iIdx];
+                        }
+                    }
+                }
+                for (; cIdx < numCols; ++cIdx)
+                {
+                    for (u32 rIdx = 0; rIdx < numRows; ++rIdx)
+                    {
+                        dst[(cIdx * dstRowStride) + rIdx] = a[(rIdx * rowStride) + cIdx];
+                    }
+                }
+            }
+
+            // The number of blocks generated at once, one per 32-bit lane
+            u64 constexpr c_NumPhiloxBlocks = 8;
+
+            // Returns the high & low 32 bits of the products of every lane of a with m.
+            inline void MulHiLo(__m256i a, __m256i m, __m256i & hi, __m256i & lo)
+            {
+                // _mm256_mul_epu32 multiplies the even lanes into 64-bit products
+                __m256i const even = _mm256_mul_epu32(a, m);
+                __m256i const odd = _mm256_mul_epu32(_mm256_srli_epi64(a, 32), m);
+                lo = _mm256_blend_epi32(even, _mm256_slli_epi64(odd, 32), 0xAA);
+                hi = _mm256_blend_epi32(_mm256_srli_epi64(even, 32), odd, 0xAA);
+            }
+
+            // Computes blocks [blockIndex, blockIndex + c_NumPhiloxBlocks) of a stream, one block per lane, with
+            // word k of every block in words[k]. The low 32 bits of the block indices must not wrap.
+            inline void PhiloxBlocks(u64 key, u64 stream, u64 blockIndex, __m256i * words)
+            {
+                __m256i const m0 = _mm256_set1_epi32(static_cast<int>(c_PhiloxM0));
+                __m256i const m1 = _mm256_set1_epi32(static_cast<int>(c_PhiloxM1));
+
+                unsigned int k0 = static_cast<unsigned int>(key);
+                unsigned int k1 = static_cast<unsigned int>(key >> 32);
+                __m256i c0 = _mm256_add_epi32(_mm256_set1_epi32(static_cast<int>(blockIndex)), _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7));
+                __m256i c1 = _mm256_set1_epi32(static_cast<int>(blockIndex >> 32));
+                __m256i c2 = _mm256_set1_epi32(static_cast<int>(stream));
+                __m256i c3 = _mm256_set1_epi32(static_cast<int>(stream >> 32));
+
+                for (u32 rIdx = 0; rIdx < c_PhiloxNumRounds; ++rIdx)
+                {
+                    __m256i hi0, lo0, hi1, lo1;
+                    MulHiLo(c0, m0, hi0, lo0);
+                    MulHiLo(c2, m1, hi1, lo1);
+                    c0 = _mm256_xor_si256(_mm256_xor_si256(hi1, c1), _mm256_set1_epi32(static_cast<int>(k0)));
+                    c1 = lo1;
+                    c2 = _mm256_xor_si256(_mm256_xor_si256(hi0, c3), _mm256_set1_epi32(static_cast<int>(k1)));
+                    c3 = lo0;
+                    k0 += c_PhiloxW0;
+                    k1 += c_PhiloxW1;
+                }
+
+                words[0] = c0;
+                words[1] = c1;
+                words[2] = c2;
+                words[3] = c3;
+            }
+
+            // Transposes the values of c_NumPhiloxBlocks blocks (value k of every block in values[k]) so the four
+            // values of each block are consecutive & stores them to dst.
+            inline void StoreBlocks(__m256 const * values, f32 * dst)
+            {
+                __m256 const a = _mm256_unpacklo_ps(values[0], values[1]);
+                __m256 const b = _mm256_unpackhi_ps(values[0], values[1]);
+                __m256 const c = _mm256_unpacklo_ps(values[2], values[3]);
+                __m256 const d = _mm256_unpackhi_ps(values[2], values[3]);
+
+                // e, f, g & h hold blocks 4n, 4n + 1, 4n + 2 & 4n + 3 in their nth 128-bit lane
+                __m256 const e = _mm256_castpd_ps(_mm256_unpacklo_pd(_mm256_castps_pd(a), _mm256_castps_pd(c)));
+                __m256 const f = _mm256_castpd_ps(_mm256_unpackhi_pd(_mm256_castps_pd(a), _mm256_castps_pd(c)));
+                __m256 const g = _mm256_castpd_ps(_mm256_unpacklo_pd(_mm256_castps_pd(b), _mm256_castps_pd(d)));
+                __m256 const h = _mm256_castpd_ps(_mm256_unpackhi_pd(_mm256_castps_pd(b), _mm256_castps_pd(d)));
+
+                _mm256_storeu_ps(dst, _mm256_permute2f128_ps(e, f, 0x20));
+                _mm256_storeu_ps(dst + c_Width, _mm256_permute2f128_ps(g, h, 0x20));
+                _mm256_storeu_ps(dst + (2 * c_Width), _mm256_permute2f128_ps(e, f, 0x31));
+                _mm256_storeu_ps(dst + (3 * c_Width), _mm256_permute2f128_ps(g, h, 0x31));
+            }
+
+            // Converts the top 24 bits of every lane of words into [0, 1).
+            inline __m256 ToUniform(__m256i words)
+            {
+                return _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_srli_epi32(words, 8)), _mm256_set1_ps(c_RandomScale));
+            }
+
+            // Vectorised LogOfUniform, performing the same operations.
+            inline __m256 LogOfUniform(__m256 x)
+            {
+                __m256 const one = _mm256_set1_ps(1.0f);
+                __m256i const bits = _mm256_castps_si256(x);
+                __m256 e = _mm256_cvtepi32_ps(_mm256_sub_epi32(_mm256_srli_epi32(bits, 23), _mm256_set1_epi32(126)));
+                __m256 m = _mm256_castsi256_ps(_mm256_or_si256(_mm256_and_si256(bits, _mm256_set1_epi32(0x007FFFFF)), _mm256_set1_epi32(0x3F000000)));
+
+                __m256 const isSmall = _mm256_cmp_ps(m, _mm256_set1_ps(c_SqrtHalf), _CMP_LT_OQ);
+                e = _mm256_sub_ps(e, _mm256_and_ps(isSmall, one));
+                m = _mm256_sub_ps(_mm256_add_ps(m, _mm256_and_ps(isSmall, m)), one);
+
+                __m256 const z = _mm256_mul_ps(m, m);
+                __m256 p = _mm256_fmadd_ps(_mm256_set1_ps(c_LogP0), m, _mm256_set1_ps(c_LogP1));
+                p = _mm256_fmadd_ps(p, m, _mm256_set1_ps(c_LogP2));
+                p = _mm256_fmadd_ps(p, m, _mm256_set1_ps(c_LogP3));
+                p = _mm256_fmadd_ps(p, m, _mm256_set1_ps(c_LogP4));
+                p = _mm256_fmadd_ps(p, m, _mm256_set1_ps(c_LogP5));
+                p = _mm256_fmadd_ps(p, m, _mm256_set1_ps(c_LogP6));
+                p = _mm256_fmadd_ps(p, m, _mm256_set1_ps(c_LogP7));
+                p = _mm256_fmadd_ps(p, m, _mm256_set1_ps(c_LogP8));
+
+                __m256 y = _mm256_mul_ps(_mm256_mul_ps(p, m), z);
+                y = _mm256_fmadd_ps(e, _mm256_set1_ps(c_LogQ1), y);
+                y = _mm256_fmadd_ps(_mm256_set1_ps(-0.5f), z, y);
+                return _mm256_fmadd_ps(e, _mm256_set1_ps(c_LogQ2), _mm256_add_ps(m, y));
+            }
+
+            // Vectorised SinCosOfUniform, performing the same operations.
+            inline void SinCosOfUniform(__m256 t, __m256 & sine, __m256 & cosine)
+            {
+                __m256 const y = _mm256_mul_ps(t, _mm256_set1_ps(8.0f));
+                __m256i const j = _mm256_and_si256(_mm256_add_epi32(_mm256_cvttps_epi32(y), _mm256_set1_epi32(1)), _mm256_set1_epi32(~1));
+                __m256 const x = _mm256_mul_ps(_mm256_sub_ps(y, _mm256_cvtepi32_ps(j)), _mm256_set1_ps(c_PiOver4));
+                __m256i const k = _mm256_srli_epi32(j, 1);
+
+                __m256 const z = _mm256_mul_ps(x, x);
+                __m256 const s = _mm256_fmadd_ps(_mm256_fmadd_ps(_mm256_fmadd_ps(_mm256_set1_ps(c_SinP0), z, _mm256_set1_ps(c_SinP1)), z, _mm256_set1_ps(c_SinP2)), _mm256_mul_ps(z, x), x);
+                __m256 const c = _mm256_fmadd_ps(_mm256_fmadd_ps(_mm256_fmadd_ps(_mm256_set1_ps(c_CosP0), z, _mm256_set1_ps(c_CosP1)), z, _mm256_set1_ps(c_CosP2)), _mm256_mul_ps(z, z), _mm256_fmadd_ps(_mm256_set1_ps(-0.5f), z, _mm256_set1_ps(1.0f)));
+
+                __m256i const one = _mm256_set1_epi32(1);
+                __m256i const two = _mm256_set1_epi32(2);
+                __m256 const isSwapped = _mm256_castsi256_ps(_mm256_cmpeq_epi32(_mm256_and_si256(k, one), one));
+                __m256 const sineSign = _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_and_si256(k, two), 30));
+                __m256 const cosineSign = _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_and_si256(_mm256_add_epi32(k, one), two), 30));
+
+                sine = _mm256_xor_ps(_mm256_blendv_ps(s, c, isSwapped), sineSign);
+                cosine = _mm256_xor_ps(_mm256_blendv_ps(c, s, isSwapped), cosineSign);
+            }
+
+            // Generates elements of a stream with generateElements until firstIndex is at the start of a block,
+            // then c_NumPhiloxBlocks blocks at a time with generateBlocks & finally the remaining elements with
+            // generateElements.
+            template <class GenerateElements, class GenerateBlocks>
+            inline void GenerateRandom(u64 firstIndex, f32 * dst, u64 length, GenerateElements const & generateElements, GenerateBlocks const & generateBlocks)
+            {
+                u64 eIdx = (4 - (firstIndex % 4)) % 4;
+                eIdx = (eIdx < length) ? eIdx : length;
+                generateElements(firstIndex, dst, eIdx);
+
+                for (; eIdx + (4 * c_NumPhiloxBlocks) <= length; eIdx += 4 * c_NumPhiloxBlocks)
+                {
+                    u64 const blockIndex = (firstIndex + eIdx) / 4;
+                    if (((blockIndex & 0xFFFFFFFFull) + c_NumPhiloxBlocks) > 0x100000000ull)
+                    {
+                        generateElements(firstIndex + eIdx, dst + eIdx, 4 * c_NumPhiloxBlocks);
+                        continue;
+                    }
+
+                    generateBlocks(blockIndex, dst + eIdx);
+                }
+
+                generateElements(firstIndex + eIdx, dst + eIdx, length - eIdx);
+            }
+
+            void RandomUniform(u64 key, u64 stream, u64 firstIndex, f32 low, f32 high, f32 * dst, u64 length)
+            {
+                f32 const scale = (high - low) * c_RandomScale;
+                __m256 const scaleVec = _mm256_set1_ps(scale);
+                __m256 const lowVec = _mm256_set1_ps(low);
+
+                GenerateRandom(firstIndex, dst, length,
+                    [&](u64 index, f32 * elements, u64 numElements)
+                    {
+                        RandomUniformElements(key, stream, index, low, scale, elements, numElements);
+                    },
+                    [&](u64 blockIndex, f32 * blocks)
+                    {
+                        __m256i words[4];
+                        PhiloxBlocks(key, stream, blockIndex, words);
+
+                        __m256 values[4];
+                        for (u32 wIdx = 0; wIdx < 4; ++wIdx)
+                        {
+                            values[wIdx] = _mm256_fmadd_ps(_mm256_cvtepi32_ps(_mm256_srli_epi32(words[wIdx], 8)), scaleVec, lowVec);
+                        }
+                        StoreBlocks(values, blocks);
+                    });
+            }
+
+            void RandomNormal(u64 key, u64 stream, u64 firstIndex, f32 mean, f32 standardDeviation, f32 * dst, u64 length)
+            {
+                __m256 const meanVec = _mm256_set1_ps(mean);
+                __m256 const standardDeviationVec = _mm256_set1_ps(standardDeviation);
+
+                GenerateRandom(firstIndex, dst, length,
+                    [&](u64 index, f32 * elements, u64 numElements)
+                    {
+                        RandomNormalElements(key, stream, index, mean, standardDeviation, elements, numElements);
+                    },
+                    [&](u64 blockIndex, f32 * blocks)
+                    {
+                        __m256i words[4];
+                        PhiloxBlocks(key, stream, blockIndex, words);
+
+                        // Values 2n & 2n + 1 of each block are made from its words 2n & 2n + 1
+                        __m256 values[4];
+                        for (u32 pIdx = 0; pIdx < 2; ++pIdx)
+                        {
+                            __m256 const u1 = _mm256_sub_ps(_mm256_set1_ps(1.0f), ToUniform(words[2 * pIdx]));
+                            __m256 const u2 = ToUniform(words[(2 * pIdx) + 1]);
+                            __m256 const radius = _mm256_sqrt_ps(_mm256_mul_ps(_mm256_set1_ps(-2.0f), LogOfUniform(u1)));
+
+                            __m256 sine, cosine;
+                            SinCosOfUniform(u2, sine, cosine);
+                            values[2 * pIdx] = _mm256_fmadd_ps(_mm256_mul_ps(radius, cosine), standardDeviationVec, meanVec);
+                            values[(2 * pIdx) + 1] = _mm256_fmadd_ps(_mm256_mul_ps(radius, sine), standardDeviationVec, meanVec);
+                        }
+                        StoreBlocks(values, blocks);
+                    });
+            }
+
+            // Vectorised ExpOfNonPositive, performing the same operations.
+            template <bool IsFast>
+            inline __m256 ExpOfNonPositive(__m256 x)
+            {
+                x = _mm256_max_ps(x, _mm256_set1_ps(c_ExpMin));
+                __m256 const n = _mm256_floor_ps(_mm256_fmadd_ps(x, _mm256_set1_ps(c_Log2E), _mm256_set1_ps(0.5f)));
+                __m256 r = _mm256_fnmadd_ps(n, _mm256_set1_ps(c_Ln2High), x);
+                r = _mm256_fnmadd_ps(n, _mm256_set1_ps(c_Ln2Low), r);
+
+                __m256 p;
+                if (IsFast)
+                {
+                    p = _mm256_fmadd_ps(_mm256_fmadd_ps(_mm256_set1_ps(c_FastExpP0), r, _mm256_set1_ps(c_FastExpP1)), r, _mm256_set1_ps(c_FastExpP2));
+                }
+                else
+                {
+                    p = _mm256_fmadd_ps(_mm256_set1_ps(c_ExpP0), r, _mm256_set1_ps(c_ExpP1));
+                    p = _mm256_fmadd_ps(p, r, _mm256_set1_ps(c_ExpP2));
+                    p = _mm256_fmadd_ps(p, r, _mm256_set1_ps(c_ExpP3));
+                    p = _mm256_fmadd_ps(p, r, _mm256_set1_ps(c_ExpP4));
+                    p = _mm256_fmadd_ps(p, r, _mm256_set1_ps(c_ExpP5));
+                }
+                __m256 const y = _mm256_add_ps(_mm256_fmadd_ps(p, _mm256_mul_ps(r, r), r), _mm256_set1_ps(1.0f));
+
+                __m256i const bits = _mm256_slli_epi32(_mm256_add_epi32(_mm256_cvtps_epi32(n), _mm256_set1_epi32(127)), 23);
+                return _mm256_mul_ps(y, _mm256_castsi256_ps(bits));
+            }
+
+            // Returns numerator / denominator, through the 12-bit reciprocal estimate for the fast tier.
+            template <bool IsFast>
+            inline __m256 Divide(__m256 numerator, __m256 denominator)
+            {
+                return IsFast ? _mm256_mul_ps(numerator, _mm256_rcp_ps(denominator)) : _mm256_div_ps(numerator, denominator);
+            }
+
+            template <bool IsFast>
+            inline __m256 SigmoidVector(__m256 x)
+            {
+                __m256 const one = _mm256_set1_ps(1.0f);
+                __m256 const e = ExpOfNonPositive<IsFast>(_mm256_or_ps(x, _mm256_set1_ps(-0.0f)));
+                __m256 const isPositive = _mm256_cmp_ps(x, _mm256_setzero_ps(), _CMP_GE_OQ);
+                return Divide<IsFast>(_mm256_blendv_ps(e, one, isPositive), _mm256_add_ps(one, e));
+            }
+
+            template <bool IsFast>
+            inline __m256 TanhVector(__m256 x)
+            {
+                __m256 const one = _mm256_set1_ps(1.0f);
+                __m256 const absX = Abs(x);
+
+                __m256 const z = _mm256_mul_ps(x, x);
+                __m256 p = _mm256_fmadd_ps(_mm256_set1_ps(c_TanhP0), z, _mm256_set1_ps(c_TanhP1));
+                p = _mm256_fmadd_ps(p, z, _mm256_set1_ps(c_TanhP2));
+                p = _mm256_fmadd_ps(p, z, _mm256_set1_ps(c_TanhP3));
+                p = _mm256_fmadd_ps(p, z, _mm256_set1_ps(c_TanhP4));
+                __m256 const small = _mm256_fmadd_ps(p, _mm256_mul_ps(z, x), x);
+
+                __m256 const e = ExpOfNonPositive<IsFast>(_mm256_mul_ps(_mm256_set1_ps(-2.0f), absX));
+                __m256 const sign = _mm256_and_ps(x, _mm256_set1_ps(-0.0f));
+                __m256 const large = _mm256_or_ps(Divide<IsFast>(_mm256_sub_ps(one, e), _mm256_add_ps(one, e)), sign);
+
+                return _mm256_blendv_ps(large, small, _mm256_cmp_ps(absX, _mm256_set1_ps(c_TanhSmall), _CMP_LT_OQ));
+            }
+
+            template <bool IsFast>
+            inline __m256 GELUVector(__m256 x)
+            {
+                __m256 const scale = _mm256_fmadd_ps(_mm256_set1_ps(c_GeluCubicScale), _mm256_mul_ps(x, x), _mm256_set1_ps(c_GeluScale));
+                return _mm256_mul_ps(x, SigmoidVector<IsFast>(_mm256_mul_ps(x, scale)));
+            }
+
+            template <bool IsFast>
+            inline __m256 SiLUVector(__m256 x)
+            {
+                return _mm256_mul_ps(x, SigmoidVector<IsFast>(x));
+            }
+
+            // Applies vectorOp to c_Width elements of a at a time & elementOp to the remainder.
+            template <class VectorOp, class ElementOp>
+            inline void Map(f32 const * a, f32 * dst, u64 length, VectorOp const & vectorOp, ElementOp const & elementOp)
+            {
+                u64 eIdx = 0;
+                for (; eIdx + c_Width <= length; eIdx += c_Width)
+                {
+                    _mm256_storeu_ps(dst + eIdx, vectorOp(_mm256_loadu_ps(a + eIdx)));
+                }
+                for (; eIdx < length; ++eIdx)
+                {
+                    dst[eIdx] = elementOp(a[eIdx]);
+                }
+            }
+
+            void Sigmoid(f32 const * a, f32 * dst, u64 length, MathPrecision precision)
+            {
+                if (MathPrecision::Fast == precision)
+                {
+                    Map(a, dst, length, SigmoidVector<true>, [](f32 x) { return SigmoidElement(x, true); });
+                    return;
+                }
+                Map(a, dst, length, SigmoidVector<false>, [](f32 x) { return SigmoidElement(x, false); });
+            }
+
+            void Tanh(f32 const * a, f32 * dst, u64 length, MathPrecision precision)
+            {
+                if (MathPrecision::Fast == precision)
+                {
+                    Map(a, dst, length, TanhVector<true>, [](f32 x) { return TanhElement(x, true); });
+                    return;
+                }
+                Map(a, dst, length, TanhVector<false>, [](f32 x) { return TanhElement(x, false); });
+            }
+
+            void GELU(f32 const * a, f32 * dst, u64 length, MathPrecision precision)
+            {
+                if (MathPrecision::Fast == precision)
+                {
+                    Map(a, dst, length, GELUVector<true>, [](f32 x) { return GELUElement(x, true); });
+                    return;
+                }
+                Map(a, dst, length, GELUVector<false>, [](f32 x) { return GELUElement(x, false); });
+            }
+
+            void SiLU(f32 const * a, f32 * dst, u64 length, MathPrecision precision)
+            {
+                if (MathPrecision::Fast == precision)
+                {
+                    Map(a, dst, length, SiLUVector<true>, [](f32 x) { return SiLUElement(x, true); });
+                    return;
+                }
+                Map(a, dst, length, SiLUVector<false>, [](f32 x) { return SiLUElement(x, false); });
+            }
+
+            // 6 x 16 register tile: 12 ymm accumulators, 2 ymm for the row of b & 1 for the broadcast of a.
+            u32 constexpr c_MR = 6;
+            u32 constexpr c_NR = 16;
+
+            void GemmMicroKernel(u32 kc, f32 const * a, f32 const * b, f32 * c, u64 rowStrideC, u32 numRows, u32 numCols, bool accumulate, GemmEpilogue const * epilogue)
+            {
+                __m256 c00 = _mm256_setzero_ps(), c01 = _mm256_setzero_ps();
+                __m256 c10 = _mm256_setzero_ps(), c11 = _mm256_setzero_ps();
+                __m256 c20 = _mm256_setzero_ps(), c21 = _mm256_setzero_ps();
+                __m256 c30 = _mm256_setzero_ps(), c31 = _mm256_setzero_ps();
+                __m256 c40 = _mm256_setzero_ps(), c41 = _mm256_setzero_ps();
+                __m256 c50 = _mm256_setzero_ps(), c51 = _mm256_setzero_ps();
+
+                for (u32 pIdx = 0; pIdx < kc; ++pIdx)
+                {
+                    __m256 const b0 = _mm256_loadu_ps(b);
+                    __m256 const b1 = _mm256_loadu_ps(b + 8);
+                    __m256 aVal;
+
+                    aVal = _mm256_broadcast_ss(a + 0);
+                    c00 = _mm256_fmadd_ps(aVal, b0, c00);
+                    c01 = _mm256_fmadd_ps(aVal, b1, c01);
+
+                    aVal = _mm256_broadcast_ss(a + 1);
+                    c10 = _mm256_fmadd_ps(aVal, b0, c10);
+                    c11 = _mm256_fmadd_ps(aVal, b1, c11);
+
+                    aVal = _mm256_broadcast_ss(a + 2);
+                    c20 = _mm256_fmadd_ps(aVal, b0, c20);
+                    c21 = _mm256_fmadd_ps(aVal, b1, c21);
+
+                    aVal = _mm256_broadcast_ss(a + 3);
+                    c30 = _mm256_fmadd_ps(aVal, b0, c30);
+                    c31 = _mm256_fmadd_ps(aVal, b1, c31);
+
+                    aVal = _mm256_broadcast_ss(a + 4);
+                    c40 = _mm256_fmadd_ps(aVal, b0, c40);
+                    c41 = _mm256_fmadd_ps(aVal, b1, c41);
+
+                    aVal = _mm256_broadcast_ss(a + 5);
+                    c50 = _mm256_fmadd_ps(aVal, b0, c50);
+                    c51 = _mm256_fmadd_ps(aVal, b1, c51);
+
+                    a += c_MR;
+                    b += c_NR;
+                }
+
+                __m256 const rows[c_MR][2] = {
+                    { c00, c01 }, { c10, c11 }, { c20, c21 },
+                    { c30, c31 }, { c40, c41 }, { c50, c51 }
+                };
+
+                if ((c_MR == numRows) && (c_NR == numCols))
+                {
+                    __m256 const zero = _mm256_setzero_ps();
+                    for (u32 rIdx = 0; rIdx < c_MR; ++rIdx)
+                    {
+                        f32 * dst = c + (rIdx * rowStrideC);
+                        __m256 r0 = rows[rIdx][0];
+                        __m256 r1 = rows[rIdx][1];
+
+                        if (accumulate)
+                        {
+                            r0 = _mm256_add_ps(r0, _mm256_loadu_ps(dst));
+                            r1 = _mm256_add_ps(r1, _mm256_loadu_ps(dst + 8));
+                        }
+
+                        if (nullptr != epilogue)
+                        {
+                            if (nullptr != epilogue->rowBias)
+                            {
+                                __m256 const bias = _mm256_broadcast_ss(epilogue->rowBias + rIdx);
+                                r0 = _mm256_add_ps(r0, bias);
+                                r1 = _mm256_add_ps(r1, bias);
+                            }
+
+                            if (nullptr != epilogue->preActivation)
+                            {
+                                f32 * preActivation = epilogue->preActivation + (rIdx * rowStrideC);
+                                _mm256_storeu_ps(preActivation, r0);
+                                _mm256_storeu_ps(preActivation + 8, r1);
+                            }
+
+                            if (epilogue->relu)
+                            {
+                                r0 = _mm256_max_ps(r0, zero);
+                                r1 = _mm256_max_ps(r1, zero);
+                            }
+                        }
+
+                        _mm256_storeu_ps(dst, r0);
+                        _mm256_storeu_ps(dst + 8, r1);
+                    }
+                    return;
+                }
+
+                // Edge tile, spill the registers & copy out the valid region
+                f32 tile[c_MR][c_NR];
+                for (u32 rIdx = 0; rIdx < c_MR; ++rIdx)
+                {
+                    _mm256_storeu_ps(&tile[rIdx][0], rows[rIdx][0]);
+                    _mm256_storeu_ps(&tile[rIdx][8], rows[rIdx][1]);
+                }
+
+                for (u32 rIdx = 0; rIdx < numRows; ++rIdx)
+                {
+                    f32 * dst = c + (rIdx * rowStrideC);
+                    for (u32 cIdx = 0; cIdx < numCols; ++cIdx)
+                    {
+                        f32 value = accumulate ? (dst[cIdx] + tile[rIdx][cIdx]) : tile[rIdx][cIdx];
+
+                        if (nullptr != epilogue)
+                        {
+                            if (nullptr != epilogue->rowBias)
+                            {
+                                value += epilogue->rowBias[rIdx];
+                            }
+
+                            if (nullptr != epilogue->preActivation)
+                            {
+                                epilogue->preActivation[(rIdx * rowStrideC) + cIdx] = value;
+                            }
+
+                            if (epilogue->relu && (value < 0.0f))
+                            {
+                                value = 0.0f;
+                            }
+                        }
+
+                        dst[cIdx] = value;
+                    }
+                }
+            }
+
+            KernelTable const s_AVX2KernelTable = {
+                "AVX2",
+                Add,
+                Scale,
+                MultiplyAdd,
+                ReLU,
+                LeakyReLU,
+                Sigmoid,
+                Tanh,
+                GELU,
+                SiLU,
+                AllClose,
+                Sum,
+                Dot,
+                Max,
+                SGDUpdate,
+                AdamUpdate,
+                Transpose,
+                RandomUniform,
+                RandomNormal,
+                { c_MR, c_NR, 256, 144, 4096, GemmMicroKernel }
+            };
+        }
+
+        KernelTable const * GetAVX2KernelTable()
+        {
+            return &s_AVX2KernelTable;
+        }
+    }
+}
+
+#else
+
+namespace mia
+{
+    namespace kernels
+    {
+        KernelTable const * GetAVX2KernelTable()
+        {
+            return nullptr;
+        }
+    }
+}
+
+#endif
@@ -0,0 +1,820 @@
+#include "KernelTable.h"
+
+// This translation unit is compiled with AVX-512 code generation enabled (see CMakeLists.txt) and
+// must only be entered once the CPU has been confirmed to support it. Avoid calling any inline
+// functions from shared headers in here as the linker could otherwise pick these AVX-512 copies for
+// callers in other translation units (ScalarElements.inl is safe, its functions have internal linkage).
+#if defined(__AVX512F__)
+
+#include <immintrin.h>
+#include <math.h>
+#include <string.h>
+
+#include "ScalarElements.inl"
+
+namespace mia
+{
+    namespace kernels
+    {
+        namespace
+        {
+            u64 constexpr c_Width = 16;
+
+            // Returns a mask enabling the first length lanes (length < c_Width).
+            inline __mmask16 TailMask(u64 length)
+            {
+                return static_cast<__mmask16>((1u << length) - 1u);
+            }
+
+            void Add(f32 const * a, f32 const * b, f32 * dst, u64 length)
+            {
+                u64 eIdx = 0;
+                for (; eIdx + c_Width <= length; eIdx += c_Width)
+                {
+                    _mm512_storeu_ps(dst + eIdx, _mm512_add_ps(_mm512_loadu_ps(a + eIdx), _mm512_loadu_ps(b + eIdx)));
+                }
+                if (eIdx < length)
+                {
+                    __mmask16 const mask = TailMask(length - eIdx);
+                    _mm512_mask_storeu_ps(dst + eIdx, mask, _mm512_add_ps(_mm512_maskz_loadu_ps(mask, a + eIdx), _mm512_maskz_loadu_ps(mask, b + eIdx)));
+                }
+            }
+
+            void Scale(f32 const * a, f32 scale, f32 * dst, u64 length)
+            {
+                __m512 const scaleVec = _mm512_set1_ps(scale);
+
+                u64 eIdx = 0;
+                for (; eIdx + c_Width <= length; eIdx += c_Width)
+                {
+                    _mm512_storeu_ps(dst + eIdx, _mm512_mul_ps(_mm512_loadu_ps(a + eIdx), scaleVec));
+                }
+                if (eIdx < length)
+                {
+                    __mmask16 const mask = TailMask(length - eIdx);
+                    _mm512_mask_storeu_ps(dst + eIdx, mask, _mm512_mul_ps(_mm512_maskz_loadu_ps(mask, a + eIdx), scaleVec));
+                }
+            }
+
+            void MultiplyAdd(f32 const * a, f32 scale, f32 const * b, f32 * dst, u64 length)
+            {
+                __m512 const scaleVec = _mm512_set1_ps(scale);
+
+                u64 eIdx = 0;
+                for (; eIdx + c_Width <= length; eIdx += c_Width)
+                {
+                    _mm512_storeu_ps(dst + eIdx, _mm512_fmadd_ps(_mm512_loadu_ps(a + eIdx), scaleVec, _mm512_loadu_ps(b + eIdx)));
+                }
+                if (eIdx < length)
+                {
+                    __mmask16 const mask = TailMask(length - eIdx);
+                    __m512 const result = _mm512_fmadd_ps(_mm512_maskz_loadu_ps(mask, a + eIdx), scaleVec, _mm512_maskz_loadu_ps(mask, b + eIdx));
+                    _mm512_mask_storeu_ps(dst + eIdx, mask, result);
+                }
+            }
+
+            void ReLU(f32 const * a, f32 * dst, u64 length)
+            {
+                __m512 const zero = _mm512_setzero_ps();
+
+                u64 eIdx = 0;
+                for (; eIdx + c_Width <= length; eIdx += c_Width)
+                {
+                    _mm512_storeu_ps(dst + eIdx, _mm512_max_ps(_mm512_loadu_ps(a + eIdx), zero));
+                }
+                if (eIdx < length)
+                {
+                    __mmask16 const mask = TailMask(length - eIdx);
+                    _mm512_mask_storeu_ps(dst + eIdx, mask, _mm512_max_ps(_mm512_maskz_loadu_ps(mask, a + eIdx), zero));
+                }
+            }
+
+            void LeakyReLU(f32 const * a, f32 slope, f32 * dst, u64 length)
+            {
+                __m512 const slopeVec = _mm512_set1_ps(slope);
+                auto leakyReLU = [&](__m512 x)
+                {
+                    __mmask16 const isPositive = _mm512_cmp_ps_mask(x, _mm512_setzero_ps(), _CMP_GT_OQ);
+                    return _mm512_mask_blend_ps(isPositive, _mm512_mul_ps(x, slopeVec), x);
+                };
+
+                u64 eIdx = 0;
+                for (; eIdx + c_Width <= length; eIdx += c_Width)
+                {
+                    _mm512_storeu_ps(dst + eIdx, leakyReLU(_mm512_loadu_ps(a + eIdx)));
+                }
+                if (eIdx < length)
+                {
+                    __mmask16 const mask = TailMask(length - eIdx);
+                    _mm512_mask_storeu_ps(dst + eIdx, mask, leakyReLU(_mm512_maskz_loadu_ps(mask, a + eIdx)));
+                }
+            }
+
+            bool AllClose(f32 const * a, f32 const * b, u64 length, f32 tolerance)
+            {
+                __m512 const toleranceVec = _mm512_set1_ps(tolerance);
+
+                u64 eIdx = 0;
+                for (; eIdx + c_Width <= length; eIdx += c_Width)
+                {
+                    __m512 const difference = _mm512_abs_ps(_mm512_sub_ps(_mm512_loadu_ps(a + eIdx), _mm512_loadu_ps(b + eIdx)));
+
+                    // Ordered comparison, NaNs produce false
+                    if (0xFFFF != _mm512_cmp_ps_mask(difference, toleranceVec, _CMP_LE_OQ))
+                    {
+                        return false;
+                    }
+                }
+                if (eIdx < length)
+                {
+                    __mmask16 const mask = TailMask(length - eIdx);
+                    __m512 const difference = _mm512_abs_ps(_mm512_sub_ps(_mm512_maskz_loadu_ps(mask, a + eIdx), _mm512_maskz_loadu_ps(mask, b + eIdx)));
+                    if (mask != _mm512_mask_cmp_ps_mask(mask, difference, toleranceVec, _CMP_LE_OQ))
+                    {
+                        return false;
+                    }
+                }
+
+                return true;
+            }
+
+            f32 Sum(f32 const * a, u64 length)
+            {
+                __m512 sum0 = _mm512_setzero_ps();
+                __m512 sum1 = _mm512_setzero_ps();
+
+                u64 eIdx = 0;
+                for (; eIdx + (2 * c_Width) <= length; eIdx += 2 * c_Width)
+                {
+                    sum0 = _mm512_add_ps(sum0, _mm512_loadu_ps(a + eIdx));
+                    sum1 = _mm512_add_ps(sum1, _mm512_loadu_ps(a + eIdx + c_Width));
+                }
+                for (; eIdx + c_Width <= length; eIdx += c_Width)
+                {
+                    sum0 = _mm512_add_ps(sum0, _mm512_loadu_ps(a + eIdx));
+                }
+                if (eIdx < length)
+                {
+                    sum1 = _mm512_add_ps(sum1, _mm512_maskz_loadu_ps(TailMask(length - eIdx), a + eIdx));
+                }
+
+                return _mm512_reduce_add_ps(_mm512_add_ps(sum0, sum1));
+            }
+
+            f32 Dot(f32 const * a, f32 const * b, u64 length)
+            {
+                __m512 sum0 = _mm512_setzero_ps();
+                __m512 sum1 = _mm512_setzero_ps();
+
+                u64 eIdx = 0;
+                for (; eIdx + (2 * c_Width) <= length; eIdx += 2 * c_Width)
+                {
+                    sum0 = _mm512_fmadd_ps(_mm512_loadu_ps(a + eIdx), _mm512_loadu_ps(b + eIdx), sum0);
+                    sum1 = _mm512_fmadd_ps(_mm512_loadu_ps(a + eIdx + c_Width), _mm512_loadu_ps(b + eIdx + c_Width), sum1);
+                }
+                for (; eIdx + c_Width <= length; eIdx += c_Width)
+                {
+                    sum0 = _mm512_fmadd_ps(_mm512_loadu_ps(a + eIdx), _mm512_loadu_ps(b + eIdx), sum0);
+                }
+                if (eIdx < length)
+                {
+                    __mmask16 const mask = TailMask(length - eIdx);
+                    sum1 = _mm512_fmadd_ps(_mm512_maskz_loadu_ps(mask, a + eIdx), _mm512_maskz_loadu_ps(mask, b + eIdx), sum1);
+                }
+
+                return _mm512_reduce_add_ps(_mm512_add_ps(sum0, sum1));
+            }
+
+            f32 Max(f32 const * a, u64 length)
+            {
+                // Inactive tail lanes are filled with the first element so they never win.
+                __m512 maxVec = _mm512_set1_ps(a[0]);
+
+                u64 eIdx = 0;
+                for (; eIdx + c_Width <= length; eIdx += c_Width)
+                {
+                    maxVec = _mm512_max_ps(maxVec, _mm512_loadu_ps(a + eIdx));
+                }
+                if (eIdx < length)
+                {
+                    maxVec = _mm512_max_ps(maxVec, _mm512_mask_loadu_ps(maxVec, TailMask(length - eIdx), a + eIdx));
+                }
+
+                return _mm512_reduce_max_ps(maxVec);
+            }
+
+            void SGDUpdate(f32 * params, f32 * velocity, f32 const * gradients, u64 length, SGDStep const & step)
+            {
+                __m512 const learningRate = _mm512_set1_ps(step.learningRate);
+                __m512 const momentum = _mm512_set1_ps(step.momentum);
+                __m512 const weightDecay = _mm512_set1_ps(step.weightDecay);
+
+                for (u64 eIdx = 0; eIdx < length; eIdx += c_Width)
+                {
+                    __mmask16 const mask = (eIdx + c_Width <= length) ? static_cast<__mmask16>(0xFFFF) : TailMask(length - eIdx);
+
+                    __m512 const param = _mm512_maskz_loadu_ps(mask, params + eIdx);
+                    __m512 update = _mm512_fmadd_ps(weightDecay, param, _mm512_maskz_loadu_ps(mask, gradients + eIdx));
+                    if (nullptr != velocity)
+                    {
+                        update = _mm512_fmadd_ps(momentum, _mm512_maskz_loadu_ps(mask, velocity + eIdx), update);
+                        _mm512_mask_storeu_ps(velocity + eIdx, mask, update);
+                    }
+                    _mm512_mask_storeu_ps(params + eIdx, mask, _mm512_fnmadd_ps(learningRate, update, param));
+                }
+            }
+
+            void AdamUpdate(f32 * params, f32 * moment1, f32 * moment2, f32 const * gradients, u64 length, AdamStep const & step)
+            {
+                __m512 const beta1 = _mm512_set1_ps(step.beta1);
+                __m512 const oneMinusBeta1 = _mm512_set1_ps(1.0f - step.beta1);
+                __m512 const beta2 = _mm512_set1_ps(step.beta2);
+                __m512 const oneMinusBeta2 = _mm512_set1_ps(1.0f - step.beta2);
+                __m512 const epsilon = _mm512_set1_ps(step.epsilon);
+                __m512 const stepSize = _mm512_set1_ps(step.stepSize);
+                __m512 const rsqrtSecondMomentCorrection = _mm512_set1_ps(step.rsqrtSecondMomentCorrection);
+                __m512 const gradientDecay = _mm512_set1_ps(step.gradientDecay);
+                __m512 const paramRetention = _mm512_set1_ps(1.0f - step.parameterDecay);
+
+                for (u64 eIdx = 0; eIdx < length; eIdx += c_Width)
+                {
+                    __mmask16 const mask = (eIdx + c_Width <= length) ? static_cast<__mmask16>(0xFFFF) : TailMask(length - eIdx);
+
+                    __m512 const param = _mm512_maskz_loadu_ps(mask, params + eIdx);
+                    __m512 const gradient = _mm512_fmadd_ps(gradientDecay, param, _mm512_maskz_loadu_ps(mask, gradients + eIdx));
+
+                    __m512 const m1 = _mm512_fmadd_ps(beta1, _mm512_maskz_loadu_ps(mask, moment1 + eIdx), _mm512_mul_ps(oneMinusBeta1, gradient));
+                    __m512 const m2 = _mm512_fmadd_ps(beta2, _mm512_maskz_loadu_ps(mask, moment2 + eIdx), _mm512_mul_ps(oneMinusBeta2, _mm512_mul_ps(gradient, gradient)));
+                    _mm512_mask_storeu_ps(moment1 + eIdx, mask, m1);
+                    _mm512_mask_storeu_ps(moment2 + eIdx, mask, m2);
+
+                    __m512 const denominator = _mm512_fmadd_ps(_mm512_sqrt_ps(m2), rsqrtSecondMomentCorrection, epsilon);
+                    __m512 const update = _mm512_div_ps(_mm512_mul_ps(stepSize, m1), denominator);
+                    _mm512_mask_storeu_ps(params + eIdx, mask, _mm512_fmsub_ps(param, paramRetention, update));
+                }
+            }
+
+            // Transposes the 8 x 8 block of a starting at a into the 8 x 8 block of dst starting at dst,
+            // entirely in registers (unpack pairs of rows, shuffle pairs of pairs, swap 128 bit halves).
+            inline void Transpose8x8(f32 const * a, u64 rowStride, f32 * dst, u64 dstRowStride)
+            {
+                __m256 const r0 = _mm256_loadu_ps(a + (0 * rowStride));
+                __m256 const r1 = _mm256_loadu_ps(a + (1 * rowStride));
+                __m256 const r2 = _mm256_loadu_ps(a + (2 * rowStride));
+                __m256 const r3 = _mm256_loadu_ps(a + (3 * rowStride));
+                __m256 const r4 = _mm256_loadu_ps(a + (4 * rowStride));
+                __m256 const r5 = _mm256_loadu_ps(a + (5 * rowStride));
+                __m256 const r6 = _mm256_loadu_ps(a + (6 * rowStride));
+                __m256 const r7 = _mm256_loadu_ps(a + (7 * rowStride));
+
+                __m256 const t0 = _mm256_unpacklo_ps(r0, r1);
+                __m256 const t1 = _mm256_unpackhi_ps(r0, r1);
+                __m256 const t2 = _mm256_unpacklo_ps(r2, r3);
+                __m256 const t3 = _mm256_unpackhi_ps(r2, r3);
+                __m256 const t4 = _mm256_unpacklo_ps(r4, r5);
+                __m256 const t5 = _mm256_unpackhi_ps(r4, r5);
+                __m256 const t6 = _mm256_unpacklo_ps(r6, r7);
+                __m256 const t7 = _mm256_unpackhi_ps(r6, r7);
+
+                __m256 const s0 = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(1, 0, 1, 0));
+                __m256 const s1 = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(3, 2, 3, 2));
+                __m256 const s2 = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(1, 0, 1, 0));
+                __m256 const s3 = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(3, 2, 3, 2));
+                __m256 const s4 = _mm256_shuffle_ps(t4, t6, _MM_SHUFFLE(1, 0, 1, 0));
+                __m256 const s5 = _mm256_shuffle_ps(t4, t6, _MM_SHUFFLE(3, 2, 3, 2));
+                __m256 const s6 = _mm256_shuffle_ps(t5, t7, _MM_SHUFFLE(1, 0, 1, 0));
+                __m256 const s7 = _mm256_shuffle_ps(t5, t7, _MM_SHUFFLE(3, 2, 3, 2));
+
+                _mm256_storeu_ps(dst + (0 * dstRowStride), _mm256_permute2f128_ps(s0, s4, 0x20));
+                _mm256_storeu_ps(dst + (1 * dstRowStride), _mm256_permute2f128_ps(s1, s5, 0x20));
+                _mm256_storeu_ps(dst + (2 * dstRowStride), _mm256_permute2f128_ps(s2, s6, 0x20));
+                _mm256_storeu_ps(dst + (3 * dstRowStride), _mm256_permute2f128_ps(s3, s7, 0x20));
+                _mm256_storeu_ps(dst + (4 * dstRowStride), _mm256_permute2f128_ps(s0, s4, 0x31));
+                _mm256_storeu_ps(dst + (5 * dstRowStride), _mm256_permute2f128_ps(s1, s5, 0x31));
+                _mm256_storeu_ps(dst + (6 * dstRowStride), _mm256_permute2f128_ps(s2, s6, 0x31));
+                _mm256_storeu_ps(dst + (7 * dstRowStride), _mm256_permute2f128_ps(s3, s7, 0x31));
+            }
+
+            void Transpose(f32 const * a, u64 rowStride, u32 numRows, u32 numCols, f32 * dst, u64 dstRowStride)
+            {
+                // Walk down each strip of 8 columns of a, so every row of dst is written contiguously
+                u32 cIdx = 0;
+                for (; cIdx + 8 <= numCols; cIdx += 8)
+                {
+                    u32 rIdx = 0;
+                    for (; rIdx + 8 <= numRows; rIdx += 8)
+                    {
+                        Transpose8x8(a + (rIdx * rowStride) + cIdx, rowStride, dst + (cIdx * dstRowStride) + rIdx, dstRowStride);
+                    }
+                    for (; rIdx < numRows; ++rIdx)
+                    {
+                        for (u32 iIdx = cIdx; iIdx < cIdx + 8; ++iIdx)
+                        {
+                            dst[(iIdx * dstRowStride) + rIdx] = a[(rIdx * rowStride) + iIdx];
+                        }
+                    }
+                }
+                for (; cIdx < numCols; ++cIdx)
+                {
+                    for (u32 rIdx = 0; rIdx < numRows; ++rIdx)
+                    {
+                        dst[(cIdx * dstRowStride) + rIdx] = a[(rIdx * rowStride) + cIdx];
+                    }
+                }
+            }
+
+            // The number of blocks generated at once, one per 32-bit lane
+            u64 constexpr c_NumPhiloxBlocks = 16;
+
+            // Returns the high & low 32 bits of the products of every lane of a with m.
+            inline void MulHiLo(__m512i a, __m512i m, __m512i & hi, __m512i & lo)
+            {
+                // _mm512_mul_epu32 multiplies the even lanes into 64-bit products
+                __m512i const even = _mm512_mul_epu32(a, m);
+                __m512i const odd = _mm512_mul_epu32(_mm512_srli_epi64(a, 32), m);
+                lo = _mm512_mask_blend_epi32(0xAAAA, even, _mm512_slli_epi64(odd, 32));
+                hi = _mm512_mask_blend_epi32(0xAAAA, _mm512_srli_epi64(even, 32), odd);
+            }
+
+            // Computes blocks [blockIndex, blockIndex + c_NumPhiloxBlocks) of a stream, one block per lane, with
+            // word k of every block in words[k]. The low 32 bits of the block indices must not wrap.
+            inline void PhiloxBlocks(u64 key, u64 stream, u64 blockIndex, __m512i * words)
+            {
+                __m512i const m0 = _mm512_set1_epi32(static_cast<int>(c_PhiloxM0));
+                __m512i const m1 = _mm512_set1_epi32(static_cast<int>(c_PhiloxM1));
+
+                unsigned int k0 = static_cast<unsigned int>(key);
+                unsigned int k1 = static_cast<unsigned int>(key >> 32);
+                __m512i c0 = _mm512_add_epi32(_mm512_set1_epi32(static_cast<int>(blockIndex)), _mm512_set_epi32(15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0));
+                __m512i c1 = _mm512_set1_epi32(static_cast<int>(blockIndex >> 32));
+                __m512i c2 = _mm512_set1_epi32(static_cast<int>(stream));
+                __m512i c3 = _mm512_set1_epi32(static_cast<int>(stream >> 32));
+
+                for (u32 rIdx = 0; rIdx < c_PhiloxNumRounds; ++rIdx)
+                {
+                    __m512i hi0, lo0, hi1, lo1;
+                    MulHiLo(c0, m0, hi0, lo0);
+                    MulHiLo(c2, m1, hi1, lo1);
+                    c0 = _mm512_xor_si512(_mm512_xor_si512(hi1, c1), _mm512_set1_epi32(static_cast<int>(k0)));
+                    c1 = lo1;
+                    c2 = _mm512_xor_si512(_mm512_xor_si512(hi0, c3), _mm512_set1_epi32(static_cast<int>(k1)));
+                    c3 = lo0;
+                    k0 += c_PhiloxW0;
+                    k1 += c_PhiloxW1;
+                }
+
+                words[0] = c0;
+                words[1] = c1;
+                words[2] = c2;
+                words[3] = c3;
+            }
+
+            // Transposes the values of c_NumPhiloxBlocks blocks (value k of every block in values[k]) so the four
+            // values of each block are consecutive & stores them to dst.
+            inline void StoreBlocks(__m512 const * values, f32 * dst)
+            {
+                __m512i const a = _mm512_unpacklo_epi32(_mm512_castps_si512(values[0]), _mm512_castps_si512(values[1]));
+                __m512i const b = _mm512_unpackhi_epi32(_mm512_castps_si512(values[0]), _mm512_castps_si512(values[1]));
+                __m512i const c = _mm512_unpacklo_epi32(_mm512_castps_si512(values[2]), _mm512_castps_si512(values[3]));
+                __m512i const d = _mm512_unpackhi_epi32(_mm512_castps_si512(values[2]), _mm512_castps_si512(values[3]));
+
+                // e, f, g & h hold blocks 4n, 4n + 1, 4n + 2 & 4n + 3 in their nth 128-bit lane
+                __m512i const e = _mm512_unpacklo_epi64(a, c);
+                __m512i const f = _mm512_unpackhi_epi64(a, c);
+                __m512i const g = _mm512_unpacklo_epi64(b, d);
+                __m512i const h = _mm512_unpackhi_epi64(b, d);
+
+                __m512i const t0 = _mm512_shuffle_i32x4(e, f, _MM_SHUFFLE(1, 0, 1, 0));
+                __m512i const t1 = _mm512_shuffle_i32x4(g, h, _MM_SHUFFLE(1, 0, 1, 0));
+                __m512i const t2 = _mm512_shuffle_i32x4(e, f, _MM_SHUFFLE(3, 2, 3, 2));
+                __m512i const t3 = _mm512_shuffle_i32x4(g, h, _MM_SHUFFLE(3, 2, 3, 2));
+
+                _mm512_storeu_si512(dst, _mm512_shuffle_i32x4(t0, t1, _MM_SHUFFLE(2, 0, 2, 0)));
+                _mm512_storeu_si512(dst + c_Width, _mm512_shuffle_i32x4(t0, t1, _MM_SHUFFLE(3, 1, 3, 1)));
+                _mm512_storeu_si512(dst + (2 * c_Width), _mm512_shuffle_i32x4(t2, t3, _MM_SHUFFLE(2, 0, 2, 0)));
+                _mm512_storeu_si512(dst + (3 * c_Width), _mm512_shuffle_i32x4(t2, t3, _MM_SHUFFLE(3, 1, 3, 1)));
+            }
+
+            // Converts the top 24 bits of every lane of words into [0, 1).
+            inline __m512 ToUniform(__m512i words)
+            {
+                return _mm512_mul_ps(_mm512_cvtepi32_ps(_mm512_srli_epi32(words, 8)), _mm512_set1_ps(c_RandomScale));
+            }
+
+            // Vectorised LogOfUniform, performing the same operations.
+            inline __m512 LogOfUniform(__m512 x)
+            {
+                __m512 const one = _mm512_set1_ps(1.0f);
+                __m512i const bits = _mm512_castps_si512(x);
+                __m512 e = _mm512_cvtepi32_ps(_mm512_sub_epi32(_mm512_srli_epi32(bits, 23), _mm512_set1_epi32(126)));
+                __m512 m = _mm512_castsi512_ps(_mm512_or_si512(_mm512_and_si512(bits, _mm512_set1_epi32(0x007FFFFF)), _mm512_set1_epi32(0x3F000000)));
+
+                __mmask16 const isSmall = _mm512_cmp_ps_mask(m, _mm512_set1_ps(c_SqrtHalf), _CMP_LT_OQ);
+                e = _mm512_mask_sub_ps(e, isSmall, e, one);
+                m = _mm512_sub_ps(_mm512_mask_add_ps(m, isSmall, m, m), one);
+
+                __m512 const z = _mm512_mul_ps(m, m);
+                __m512 p = _mm512_fmadd_ps(_mm512_set1_ps(c_LogP0), m, _mm512_set1_ps(c_LogP1));
+                p = _mm512_fmadd_ps(p, m, _mm512_set1_ps(c_LogP2));
+                p = _mm512_fmadd_ps(p, m, _mm512_set1_ps(c_LogP3));
+                p = _mm512_fmadd_ps(p, m, _mm512_set1_ps(c_LogP4));
+                p = _mm512_fmadd_ps(p, m, _mm512_set1_ps(c_LogP5));
+                p = _mm512_fmadd_ps(p, m, _mm512_set1_ps(c_LogP6));
+                p = _mm512_fmadd_ps(p, m, _mm512_set1_ps(c_LogP7));
+                p = _mm512_fmadd_ps(p, m, _mm512_set1_ps(c_LogP8));
+
+                __m512 y = _mm512_mul_ps(_mm512_mul_ps(p, m), z);
+                y = _mm512_fmadd_ps(e, _mm512_set1_ps(c_LogQ1), y);
+                y = _mm512_fmadd_ps(_mm512_set1_ps(-0.5f), z, y);
+                return _mm512_fmadd_ps(e, _mm512_set1_ps(c_LogQ2), _mm512_add_ps(m, y));
+            }
+
+            // Vectorised SinCosOfUniform, performing the same operations.
+            inline void SinCosOfUniform(__m512 t, __m512 & sine, __m512 & cosine)
+            {
+                __m512 const y = _mm512_mul_ps(t, _mm512_set1_ps(8.0f));
+                __m512i const j = _mm512_and_si512(_mm512_add_epi32(_mm512_cvttps_epi32(y), _mm512_set1_epi32(1)), _mm512_set1_epi32(~1));
+                __m512 const x = _mm512_mul_ps(_mm512_sub_ps(y, _mm512_cvtepi32_ps(j)), _mm512_set1_ps(c_PiOver4));
+                __m512i const k = _mm512_srli_epi32(j, 1);
+
+                __m512 const z = _mm512_mul_ps(x, x);
+                __m512 const s = _mm512_fmadd_ps(_mm512_fmadd_ps(_mm512_fmadd_ps(_mm512_set1_ps(c_SinP0), z, _mm512_set1_ps(c_SinP1)), z, _mm512_set1_ps(c_SinP2)), _mm512_mul_ps(z, x), x);
+                __m512 const c = _mm512_fmadd_ps(_mm512_fmadd_ps(_mm512_fmadd_ps(_mm512_set1_ps(c_CosP0), z, _mm512_set1_ps(c_CosP1)), z, _mm512_set1_ps(c_CosP2)), _mm512_mul_ps(z, z), _mm512_fmadd_ps(_mm512_set1_ps(-0.5f), z, _mm512_set1_ps(1.0f)));
+
+                __m512i const one = _mm512_set1_epi32(1);
+                __m512i const two = _mm512_set1_epi32(2);
+                __mmask16 const isSwapped = _mm512_test_epi32_mask(k, one);
+                __m512i const sineSign = _mm512_slli_epi32(_mm512_and_si512(k, two), 30);
+                __m512i const cosineSign = _mm512_slli_epi32(_mm512_and_si512(_mm512_add_epi32(k, one), two), 30);
+
+                sine = _mm512_castsi512_ps(_mm512_xor_si512(_mm512_castps_si512(_mm512_mask_blend_ps(isSwapped, s, c)), sineSign));
+                cosine = _mm512_castsi512_ps(_mm512_xor_si512(_mm512_castps_si512(_mm512_mask_blend_ps(isSwapped, c, s)), cosineSign));
+            }
+
+            // Generates elements of a stream with generateElements until firstIndex is at the start of a block,
+            // then c_NumPhiloxBlocks blocks at a time with generateBlocks & finally the remaining elements with
+            // generateElements.
+            template <class GenerateElements, class GenerateBlocks>
+            inline void GenerateRandom(u64 firstIndex, f32 * dst, u64 length, GenerateElements const & generateElements, GenerateBlocks const & generateBlocks)
+            {
+                u64 eIdx = (4 - (firstIndex % 4)) % 4;
+                eIdx = (eIdx < length) ? eIdx : length;
+                generateElements(firstIndex, dst, eIdx);
+
+                for (; eIdx + (4 * c_NumPhiloxBlocks) <= length; eIdx += 4 * c_NumPhiloxBlocks)
+                {
+                    u64 const blockIndex = (firstIndex + eIdx) / 4;
+                    if (((blockIndex & 0xFFFFFFFFull) + c_NumPhiloxBlocks) > 0x100000000ull)
+                    {
+                        generateElements(firstIndex + eIdx, dst + eIdx, 4 * c_NumPhiloxBlocks);
+                        continue;
+                    }
+
+                    generateBlocks(blockIndex, dst + eIdx);
+                }
+
+                generateElements(firstIndex + eIdx, dst + eIdx, length - eIdx);
+            }
+
+            void RandomUniform(u64 key, u64 stream, u64 firstIndex, f32 low, f32 high, f32 * dst, u64 length)
+            {
+                f32 const scale = (high - low) * c_RandomScale;
+                __m512 const scaleVec = _mm512_set1_ps(scale);
+                __m512 const lowVec = _mm512_set1_ps(low);
+
+                GenerateRandom(firstIndex, dst, length,
+                    [&](u64 index, f32 * elements, u64 numElements)
+                    {
+                        RandomUniformElements(key, stream, index, low, scale, elements, numElements);
+                    },
+                    [&](u64 blockIndex, f32 * blocks)
+                    {
+                        __m512i words[4];
+                        PhiloxBlocks(key, stream, blockIndex, words);
+
+                        __m512 values[4];
+                        for (u32 wIdx = 0; wIdx < 4; ++wIdx)
+                        {
+                            values[wIdx] = _mm512_fmadd_ps(_mm512_cvtepi32_ps(_mm512_srli_epi32(words[wIdx], 8)), scaleVec, lowVec);
+                        }
+                        StoreBlocks(values, blocks);
+                    });
+            }
+
+            void RandomNormal(u64 key, u64 stream, u64 firstIndex, f32 mean, f32 standardDeviation, f32 * dst, u64 length)
+            {
+                __m512 const meanVec = _mm512_set1_ps(mean);
+                __m512 const standardDeviationVec = _mm512_set1_ps(standardDeviation);
+
+                GenerateRandom(firstIndex, dst, length,
+                    [&](u64 index, f32 * elements, u64 numElements)
+                    {
+                        RandomNormalElements(key, stream, index, mean, standardDeviation, elements, numElements);
+                    },
+                    [&](u64 blockIndex, f32 * blocks)
+                    {
+                        __m512i words[4];
+                        PhiloxBlocks(key, stream, blockIndex, words);
+
+                        // Values 2n & 2n + 1 of each block are made from its words 2n & 2n + 1
+                        __m512 values[4];
+                        for (u32 pIdx = 0; pIdx < 2; ++pIdx)
+                        {
+                            __m512 const u1 = _mm512_sub_ps(_mm512_set1_ps(1.0f), ToUniform(words[2 * pIdx]));
+                            __m512 const u2 = ToUniform(words[(2 * pIdx) + 1]);
+                            __m512 const radius = _mm512_sqrt_ps(_mm512_mul_ps(_mm512_set1_ps(-2.0f), LogOfUniform(u1)));
+
+                            __m512 sine, cosine;
+                            SinCosOfUniform(u2, sine, cosine);
+                            values[2 * pIdx] = _mm512_fmadd_ps(_mm512_mul_ps(radius, cosine), standardDeviationVec, meanVec);
+                            values[(2 * pIdx) + 1] = _mm512_fmadd_ps(_mm512_mul_ps(radius, sine), standardDeviationVec, meanVec);
+                        }
+                        StoreBlocks(values, blocks);
+                    });
+            }
+
+            // Vectorised ExpOfNonPositive, performing the same operations.
+            template <bool IsFast>
+            inline __m512 ExpOfNonPositive(__m512 x)
+            {
+                x = _mm512_max_ps(x, _mm512_set1_ps(c_ExpMin));
+                __m512 const n = _mm512_roundscale_ps(_mm512_fmadd_ps(x, _mm512_set1_ps(c_Log2E), _mm512_set1_ps(0.5f)), _MM_FROUND_TO_NEG_INF | _MM_FROUND_NO_EXC);
+                __m512 r = _mm512_fnmadd_ps(n, _mm512_set1_ps(c_Ln2High), x);
+                r = _mm512_fnmadd_ps(n, _mm512_set1_ps(c_Ln2Low), r);
+
+                __m512 p;
+                if (IsFast)
+                {
+                    p = _mm512_fmadd_ps(_mm512_fmadd_ps(_mm512_set1_ps(c_FastExpP0), r, _mm512_set1_ps(c_FastExpP1)), r, _mm512_set1_ps(c_FastExpP2));
+                }
+                else
+                {
+                    p = _mm512_fmadd_ps(_mm512_set1_ps(c_ExpP0), r, _mm512_set1_ps(c_ExpP1));
+                    p = _mm512_fmadd_ps(p, r, _mm512_set1_ps(c_ExpP2));
+                    p = _mm512_fmadd_ps(p, r, _mm512_set1_ps(c_ExpP3));
+                    p = _mm512_fmadd_ps(p, r, _mm512_set1_ps(c_ExpP4));
+                    p = _mm512_fmadd_ps(p, r, _mm512_set1_ps(c_ExpP5));
+                }
+                __m512 const y = _mm512_add_ps(_mm512_fmadd_ps(p, _mm512_mul_ps(r, r), r), _mm512_set1_ps(1.0f));
+
+                __m512i const bits = _mm512_slli_epi32(_mm512_add_epi32(_mm512_cvtps_epi32(n), _mm512_set1_epi32(127)), 23);
+                return _mm512_mul_ps(y, _mm512_castsi512_ps(bits));
+            }
+
+            // Returns numerator / denominator, through the 14-bit reciprocal estimate for the fast tier.
+            template <bool IsFast>
+            inline __m512 Divide(__m512 numerator, __m512 denominator)
+            {
+                return IsFast ? _mm512_mul_ps(numerator, _mm512_rcp14_ps(denominator)) : _mm512_div_ps(numerator, denominator);
+            }
+
+            template <bool IsFast>
+            inline __m512 SigmoidVector(__m512 x)
+            {
+                __m512 const one = _mm512_set1_ps(1.0f);
+                __m512i const signBit = _mm512_set1_epi32(static_cast<int>(0x80000000u));
+                __m512 const e = ExpOfNonPositive<IsFast>(_mm512_castsi512_ps(_mm512_or_si512(_mm512_castps_si512(x), signBit)));
+                __mmask16 const isPositive = _mm512_cmp_ps_mask(x, _mm512_setzero_ps(), _CMP_GE_OQ);
+                return Divide<IsFast>(_mm512_mask_blend_ps(isPositive, e, one), _mm512_add_ps(one, e));
+            }
+
+            template <bool IsFast>
+            inline __m512 TanhVector(__m512 x)
+            {
+                __m512 const one = _mm512_set1_ps(1.0f);
+                __m512i const signBit = _mm512_set1_epi32(static_cast<int>(0x80000000u));
+                __m512 const absX = _mm512_abs_ps(x);
+
+                __m512 const z = _mm512_mul_ps(x, x);
+                __m512 p = _mm512_fmadd_ps(_mm512_set1_ps(c_TanhP0), z, _mm512_set1_ps(c_TanhP1));
+                p = _mm512_fmadd_ps(p, z, _mm512_set1_ps(c_TanhP2));
+                p = _mm512_fmadd_ps(p, z, _mm512_set1_ps(c_TanhP3));
+                p = _mm512_fmadd_ps(p, z, _mm512_set1_ps(c_TanhP4));
+                __m512 const small = _mm512_fmadd_ps(p, _mm512_mul_ps(z, x), x);
+
+                __m512 const e = ExpOfNonPositive<IsFast>(_mm512_mul_ps(_mm512_set1_ps(-2.0f), absX));
+                __m512i const sign = _mm512_and_si512(_mm512_castps_si512(x), signBit);
+                __m512 const large = _mm512_castsi512_ps(_mm512_or_si512(_mm512_castps_si512(Divide<IsFast>(_mm512_sub_ps(one, e), _mm512_add_ps(one, e))), sign));
+
+                return _mm512_mask_blend_ps(_mm512_cmp_ps_mask(absX, _mm512_set1_ps(c_TanhSmall), _CMP_LT_OQ), large, small);
+            }
+
+            template <bool IsFast>
+            inline __m512 GELUVector(__m512 x)
+            {
+                __m512 const scale = _mm512_fmadd_ps(_mm512_set1_ps(c_GeluCubicScale), _mm512_mul_ps(x, x), _mm512_set1_ps(c_GeluScale));
+                return _mm512_mul_ps(x, SigmoidVector<IsFast>(_mm512_mul_ps(x, scale)));
+            }
+
+            template <bool IsFast>
+            inline __m512 SiLUVector(__m512 x)
+            {
+                return _mm512_mul_ps(x, SigmoidVector<IsFast>(x));
+            }
+
+            // Applies vectorOp to c_Width elements of a at a time, the remainder through a masked load & store.
+            template <class VectorOp>
+            inline void Map(f32 const * a, f32 * dst, u64 length, VectorOp const & vectorOp)
+            {
+                u64 eIdx = 0;
+                for (; eIdx + c_Width <= length; eIdx += c_Width)
+                {
+                    _mm512_storeu_ps(dst + eIdx, vectorOp(_mm512_loadu_ps(a + eIdx)));
+                }
+                if (eIdx < length)
+                {
+                    __mmask16 const mask = TailMask(length - eIdx);
+                    _mm512_mask_storeu_ps(dst + eIdx, mask, vectorOp(_mm512_maskz_loadu_ps(mask, a + eIdx)));
+                }
+            }
+
+            void Sigmoid(f32 const * a, f32 * dst, u64 length, MathPrecision precision)
+            {
+                if (MathPrecision::Fast == precision)
+                {
+                    Map(a, dst, length, SigmoidVector<true>);
+                    return;
+                }
+                Map(a, dst, length, SigmoidVector<false>);
+            }
+
+            void Tanh(f32 const * a, f32 * dst, u64 length, MathPrecision precision)
+            {
+                if (MathPrecision::Fast == precision)
+                {
+                    Map(a, dst, length, TanhVector<true>);
+                    return;
+                }
+                Map(a, dst, length, TanhVector<false>);
+            }
+
+            void GELU(f32 const * a, f32 * dst, u64 length, MathPrecision precision)
+            {
+                if (MathPrecision::Fast == precision)
+                {
+                    Map(a, dst, length, GELUVector<true>);
+                    return;
+                }
+                Map(a, dst, length, GELUVector<false>);
+            }
+
+            void SiLU(f32 const * a, f32 * dst, u64 length, MathPrecision precision)
+            {
+                if (MathPrecision::Fast == precision)
+                {
+                    Map(a, dst, length, SiLUVector<true>);
+                    return;
+                }
+                Map(a, dst, length, SiLUVector<false>);
+            }
+
+            // 12 x 32 register tile: 24 zmm accumulators, 2 zmm for the row of b & 1 for the broadcast of a.
+            u32 constexpr c_MR = 12;
+            u32 constexpr c_NR = 32;
+
+            #define MIA_AVX512_GEMM_ROW(row)                                    \
+                aVal = _mm512_set1_ps(a[row]);                                  \
+                c##row##0 = _mm512_fmadd_ps(aVal, b0, c##row##0);               \
+                c##row##1 = _mm512_fmadd_ps(aVal, b1, c##row##1);
+
+            void GemmMicroKernel(u32 kc, f32 const * a, f32 const * b, f32 * c, u64 rowStrideC, u32 numRows, u32 numCols, bool accumulate, GemmEpilogue const * epilogue)
+            {
+                __m512 c00 = _mm512_setzero_ps(), c01 = _mm512_setzero_ps();
+                __m512 c10 = _mm512_setzero_ps(), c11 = _mm512_setzero_ps();
+                __m512 c20 = _mm512_setzero_ps(), c21 = _mm512_setzero_ps();
+                __m512 c30 = _mm512_setzero_ps(), c31 = _mm512_setzero_ps();
+                __m512 c40 = _mm512_setzero_ps(), c41 = _mm512_setzero_ps();
+                __m512 c50 = _mm512_setzero_ps(), c51 = _mm512_setzero_ps();
+                __m512 c60 = _mm512_setzero_ps(), c61 = _mm512_setzero_ps();
+                __m512 c70 = _mm512_setzero_ps(), c71 = _mm512_setzero_ps();
+                __m512 c80 = _mm512_setzero_ps(), c81 = _mm512_setzero_ps();
+                __m512 c90 = _mm512_setzero_ps(), c91 = _mm512_setzero_ps();
+                __m512 cA0 = _mm512_setzero_ps(), cA1 = _mm512_setzero_ps();
+                __m512 cB0 = _mm512_setzero_ps(), cB1 = _mm512_setzero_ps();
+
+                for (u32 pIdx = 0; pIdx < kc; ++pIdx)
+                {
+                    __m512 const b0 = _mm512_loadu_ps(b);
+                    __m512 const b1 = _mm512_loadu_ps(b + 16);
+                    __m512 aVal;
+
+                    MIA_AVX512_GEMM_ROW(0)
+                    MIA_AVX512_GEMM_ROW(1)
+                    MIA_AVX512_GEMM_ROW(2)
+                    MIA_AVX512_GEMM_ROW(3)
+                    MIA_AVX512_GEMM_ROW(4)
+                    MIA_AVX512_GEMM_ROW(5)
+                    MIA_AVX512_GEMM_ROW(6)
+                    MIA_AVX512_GEMM_ROW(7)
+                    MIA_AVX512_GEMM_ROW(8)
+                    MIA_AVX512_GEMM_ROW(9)
+
+                    aVal = _mm512_set1_ps(a[10]);
+                    cA0 = _mm512_fmadd_ps(aVal, b0, cA0);
+                    cA1 = _mm512_fmadd_ps(aVal, b1, cA1);
+
+                    aVal = _mm512_set1_ps(a[11]);
+                    cB0 = _mm512_fmadd_ps(aVal, b0, cB0);
+                    cB1 = _mm512_fmadd_ps(aVal, b1, cB1);
+
+                    a += c_MR;
+                    b += c_NR;
+                }
+
+                __m512 const rows[c_MR][2] = {
+                    { c00, c01 }, { c10, c11 }, { c20, c21 }, { c30, c31 },
+                    { c40, c41 }, { c50, c51 }, { c60, c61 }, { c70, c71 },
+                    { c80, c81 }, { c90, c91 }, { cA0, cA1 }, { cB0, cB1 }
+                };
+
+                // Partial columns are handled with write masks, partial rows by skipping the row.
+                __mmask16 const mask0 = (numCols >= 16) ? static_cast<__mmask16>(0xFFFF) : TailMask(numCols);
+                __mmask16 const mask1 = (numCols >= 32) ? static_cast<__mmask16>(0xFFFF) : ((numCols > 16) ? TailMask(numCols - 16) : static_cast<__mmask16>(0));
+
+                for (u32 rIdx = 0; rIdx < numRows; ++rIdx)
+                {
+                    f32 * dst = c + (rIdx * rowStrideC);
+                    __m512 r0 = rows[rIdx][0];
+                    __m512 r1 = rows[rIdx][1];
+
+                    if (accumulate)
+                    {
+                        r0 = _mm512_add_ps(r0, _mm512_maskz_loadu_ps(mask0, dst));
+                        r1 = _mm512_add_ps(r1, _mm512_maskz_loadu_ps(mask1, dst + 16));
+                    }
+
+                    if (nullptr != epilogue)
+                    {
+                        if (nullptr != epilogue->rowBias)
+                        {
+                            __m512 const bias = _mm512_set1_ps(epilogue->rowBias[rIdx]);
+                            r0 = _mm512_add_ps(r0, bias);
+                            r1 = _mm512_add_ps(r1, bias);
+                        }
+
+                        if (nullptr != epilogue->preActivation)
+                        {
+                            f32 * preActivation = epilogue->preActivation + (rIdx * rowStrideC);
+                            _mm512_mask_storeu_ps(preActivation, mask0, r0);
+                            _mm512_mask_storeu_ps(preActivation + 16, mask1, r1);
+                        }
+
+                        if (epilogue->relu)
+                        {
+                            r0 = _mm512_max_ps(r0, _mm512_setzero_ps());
+                            r1 = _mm512_max_ps(r1, _mm512_setzero_ps());
+                        }
+                    }
+
+                    _mm512_mask_storeu_ps(dst, mask0, r0);
+                    _mm512_mask_storeu_ps(dst + 16, mask1, r1);
+                }
+            }
+
+            #undef MIA_AVX512_GEMM_ROW
+
+            KernelTable const s_AVX512KernelTable = {
+                "AVX512",
+                Add,
+                Scale,
+                MultiplyAdd,
+                ReLU,
+                LeakyReLU,
+                Sigmoid,
+                Tanh,
+                GELU,
+                SiLU,
+                AllClose,
+                Sum,
+                Dot,
+                Max,
+                SGDUpdate,
+                AdamUpdate,
+                Transpose,
+                RandomUniform,
+                RandomNormal,
+                { c_MR, c_NR, 256, 144, 4096, GemmMicroKernel }
+            };
+        }
+
+        KernelTable const * GetAVX512KernelTable()
+        {
+            return &s_AVX512KernelTable;
+        }
+    }
+}
+
+#else
+
+namespace mia
+{
+    namespace kernels
+    {
+        KernelTable const * GetAVX512KernelTable()
+        {
+            return nullptr;
+        }
+    }
+}
+
+#endif
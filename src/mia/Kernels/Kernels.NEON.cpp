@@ -0,0 +1,718 @@
+#include "KernelTable.h"
+#include "Core/CpuFeatures.h"
+
+// Advanced SIMD (NEON) is part of the AArch64 baseline so no additional code generation flags
+// are required for this translation unit.
+#if defined(MIA_ARCH_ARM64)
+
+#include <arm_neon.h>
+#include <math.h>
+#include <string.h>
+
+#include "ScalarElements.inl"
+
+namespace mia
+{
+    namespace kernels
+    {
+        namespace
+        {
+            u64 constexpr c_Width = 4;
+
+            void Add(f32 const * a, f32 const * b, f32 * dst, u64 length)
+            {
+                u64 eIdx = 0;
+                for (; eIdx + c_Width <= length; eIdx += c_Width)
+                {
+                    vst1q_f32(dst + eIdx, vaddq_f32(vld1q_f32(a + eIdx), vld1q_f32(b + eIdx)));
+                }
+                for (; eIdx < length; ++eIdx)
+                {
+                    dst[eIdx] = a[eIdx] + b[eIdx];
+                }
+            }
+
+            void Scale(f32 const * a, f32 scale, f32 * dst, u64 length)
+            {
+                u64 eIdx = 0;
+                for (; eIdx + c_Width <= length; eIdx += c_Width)
+                {
+                    vst1q_f32(dst + eIdx, vmulq_n_f32(vld1q_f32(a + eIdx), scale));
+                }
+                for (; eIdx < length; ++eIdx)
+                {
+                    dst[eIdx] = a[eIdx] * scale;
+                }
+            }
+
+            void MultiplyAdd(f32 const * a, f32 scale, f32 const * b, f32 * dst, u64 length)
+            {
+                u64 eIdx = 0;
+                for (; eIdx + c_Width <= length; eIdx += c_Width)
+                {
+                    vst1q_f32(dst + eIdx, vfmaq_n_f32(vld1q_f32(b + eIdx), vld1q_f32(a + eIdx), scale));
+                }
+                for (; eIdx < length; ++eIdx)
+                {
+                    dst[eIdx] = (a[eIdx] * scale) + b[eIdx];
+                }
+            }
+
+            void ReLU(f32 const * a, f32 * dst, u64 length)
+            {
+                float32x4_t const zero = vdupq_n_f32(0.0f);
+
+                u64 eIdx = 0;
+                for (; eIdx + c_Width <= length; eIdx += c_Width)
+                {
+                    vst1q_f32(dst + eIdx, vmaxq_f32(vld1q_f32(a + eIdx), zero));
+                }
+                for (; eIdx < length; ++eIdx)
+                {
+                    dst[eIdx] = (a[eIdx] > 0.0f) ? a[eIdx] : 0.0f;
+                }
+            }
+
+            void LeakyReLU(f32 const * a, f32 slope, f32 * dst, u64 length)
+            {
+                u64 eIdx = 0;
+                for (; eIdx + c_Width <= length; eIdx += c_Width)
+                {
+                    float32x4_t const x = vld1q_f32(a + eIdx);
+                    uint32x4_t const isPositive = vcgtq_f32(x, vdupq_n_f32(0.0f));
+                    vst1q_f32(dst + eIdx, vbslq_f32(isPositive, x, vmulq_n_f32(x, slope)));
+                }
+                for (; eIdx < length; ++eIdx)
+                {
+                    dst[eIdx] = (a[eIdx] > 0.0f) ? a[eIdx] : (a[eIdx] * slope);
+                }
+            }
+
+            bool AllClose(f32 const * a, f32 const * b, u64 length, f32 tolerance)
+            {
+                float32x4_t const toleranceVec = vdupq_n_f32(tolerance);
+
+                u64 eIdx = 0;
+                for (; eIdx + c_Width <= length; eIdx += c_Width)
+                {
+                    // Ordered comparison, NaNs produce false
+                    uint32x4_t const isClose = vcleq_f32(vabdq_f32(vld1q_f32(a + eIdx), vld1q_f32(b + eIdx)), toleranceVec);
+                    if (0xFFFFFFFFu != vminvq_u32(isClose))
+                    {
+                        return false;
+                    }
+                }
+                for (; eIdx < length; ++eIdx)
+                {
+                    f32 const difference = a[eIdx] - b[eIdx];
+                    f32 const absDifference = (difference < 0.0f) ? -difference : difference;
+                    if (!(absDifference <= tolerance))
+                    {
+                        return false;
+                    }
+                }
+
+                return true;
+            }
+
+            f32 Sum(f32 const * a, u64 length)
+            {
+                float32x4_t sum0 = vdupq_n_f32(0.0f);
+                float32x4_t sum1 = vdupq_n_f32(0.0f);
+
+                u64 eIdx = 0;
+                for (; eIdx + (2 * c_Width) <= length; eIdx += 2 * c_Width)
+                {
+                    sum0 = vaddq_f32(sum0, vld1q_f32(a + eIdx));
+                    sum1 = vaddq_f32(sum1, vld1q_f32(a + eIdx + c_Width));
+                }
+
+                f32 result = vaddvq_f32(vaddq_f32(sum0, sum1));
+                for (; eIdx < length; ++eIdx)
+                {
+                    result += a[eIdx];
+                }
+
+                return result;
+            }
+
+            f32 Dot(f32 const * a, f32 const * b, u64 length)
+            {
+                float32x4_t sum0 = vdupq_n_f32(0.0f);
+                float32x4_t sum1 = vdupq_n_f32(0.0f);
+
+                u64 eIdx = 0;
+                for (; eIdx + (2 * c_Width) <= length; eIdx += 2 * c_Width)
+                {
+                    sum0 = vfmaq_f32(sum0, vld1q_f32(a + eIdx), vld1q_f32(b + eIdx));
+                    sum1 = vfmaq_f32(sum1, vld1q_f32(a + eIdx + c_Width), vld1q_f32(b + eIdx + c_Width));
+                }
+
+                f32 result = vaddvq_f32(vaddq_f32(sum0, sum1));
+                for (; eIdx < length; ++eIdx)
+                {
+                    result += a[eIdx] * b[eIdx];
+                }
+
+                return result;
+            }
+
+            f32 Max(f32 const * a, u64 length)
+            {
+                f32 result = a[0];
+
+                u64 eIdx = 0;
+                if (length >= c_Width)
+                {
+                    float32x4_t maxVec = vld1q_f32(a);
+                    for (eIdx = c_Width; eIdx + c_Width <= length; eIdx += c_Width)
+                    {
+                        maxVec = vmaxq_f32(maxVec, vld1q_f32(a + eIdx));
+                    }
+                    result = vmaxvq_f32(maxVec);
+                }
+                for (; eIdx < length; ++eIdx)
+                {
+                    result = (a[eIdx] > result) ? a[eIdx] : result;
+                }
+
+                return result;
+            }
+
+            void SGDUpdate(f32 * params, f32 * velocity, f32 const * gradients, u64 length, SGDStep const & step)
+            {
+                u64 eIdx = 0;
+                for (; eIdx + c_Width <= length; eIdx += c_Width)
+                {
+                    float32x4_t const param = vld1q_f32(params + eIdx);
+                    float32x4_t update = vfmaq_n_f32(vld1q_f32(gradients + eIdx), param, step.weightDecay);
+                    if (nullptr != velocity)
+                    {
+                        update = vfmaq_n_f32(update, vld1q_f32(velocity + eIdx), step.momentum);
+                        vst1q_f32(velocity + eIdx, update);
+                    }
+                    vst1q_f32(params + eIdx, vfmsq_n_f32(param, update, step.learningRate));
+                }
+                for (; eIdx < length; ++eIdx)
+                {
+                    SGDUpdateElement(params[eIdx], (nullptr != velocity) ? velocity + eIdx : nullptr, gradients[eIdx], step);
+                }
+            }
+
+            void AdamUpdate(f32 * params, f32 * moment1, f32 * moment2, f32 const * gradients, u64 length, AdamStep const & step)
+            {
+                float32x4_t const epsilon = vdupq_n_f32(step.epsilon);
+                f32 const oneMinusBeta1 = 1.0f - step.beta1;
+                f32 const oneMinusBeta2 = 1.0f - step.beta2;
+                f32 const paramRetention = 1.0f - step.parameterDecay;
+
+                u64 eIdx = 0;
+                for (; eIdx + c_Width <= length; eIdx += c_Width)
+                {
+                    float32x4_t const param = vld1q_f32(params + eIdx);
+                    float32x4_t const gradient = vfmaq_n_f32(vld1q_f32(gradients + eIdx), param, step.gradientDecay);
+
+                    float32x4_t const m1 = vfmaq_n_f32(vmulq_n_f32(gradient, oneMinusBeta1), vld1q_f32(moment1 + eIdx), step.beta1);
+                    float32x4_t const m2 = vfmaq_n_f32(vmulq_n_f32(vmulq_f32(gradient, gradient), oneMinusBeta2), vld1q_f32(moment2 + eIdx), step.beta2);
+                    vst1q_f32(moment1 + eIdx, m1);
+                    vst1q_f32(moment2 + eIdx, m2);
+
+                    float32x4_t const denominator = vfmaq_n_f32(epsilon, vsqrtq_f32(m2), step.rsqrtSecondMomentCorrection);
+                    float32x4_t const update = vdivq_f32(vmulq_n_f32(m1, step.stepSize), denominator);
+                    vst1q_f32(params + eIdx, vsubq_f32(vmulq_n_f32(param, paramRetention), update));
+                }
+                for (; eIdx < length; ++eIdx)
+                {
+                    AdamUpdateElement(params[eIdx], moment1[eIdx], moment2[eIdx], gradients[eIdx], step);
+                }
+            }
+
+            // Transposes the 4 x 4 block of a starting at a into the 4 x 4 block of dst starting at dst,
+            // entirely in registers (transpose pairs of rows, then recombine their halves).
+            inline void Transpose4x4(f32 const * a, u64 rowStride, f32 * dst, u64 dstRowStride)
+            {
+                float32x4x2_t const t01 = vtrnq_f32(vld1q_f32(a + (0 * rowStride)), vld1q_f32(a + (1 * rowStride)));
+                float32x4x2_t const t23 = vtrnq_f32(vld1q_f32(a + (2 * rowStride)), vld1q_f32(a + (3 * rowStride)));
+
+                vst1q_f32(dst + (0 * dstRowStride), vcombine_f32(vget_low_f32(t01.val[0]), vget_low_f32(t23.val[0])));
+                vst1q_f32(dst + (1 * dstRowStride), vcombine_f32(vget_low_f32(t01.val[1]), vget_low_f32(t23.val[1])));
+                vst1q_f32(dst + (2 * dstRowStride), vcombine_f32(vget_high_f32(t01.val[0]), vget_high_f32(t23.val[0])));
+                vst1q_f32(dst + (3 * dstRowStride), vcombine_f32(vget_high_f32(t01.val[1]), vget_high_f32(t23.val[1])));
+            }
+
+            void Transpose(f32 const * a, u64 rowStride, u32 numRows, u32 numCols, f32 * dst, u64 dstRowStride)
+            {
+                // Walk down each strip of 4 columns of a, so every row of dst is written contiguously
+                u32 cIdx = 0;
+                for (; cIdx + 4 <= numCols; cIdx += 4)
+                {
+                    u32 rIdx = 0;
+                    for (; rIdx + 4 <= numRows; rIdx += 4)
+                    {
+                        Transpose4x4(a + (rIdx * rowStride) + cIdx, rowStride, dst + (cIdx * dstRowStride) + rIdx, dstRowStride);
+                    }
+                    for (; rIdx < numRows; ++rIdx)
+                    {
+                        for (u32 iIdx = cIdx; iIdx < cIdx + 4; ++iIdx)
+                        {
+                            dst[(iIdx * dstRowStride) + rIdx] = a[(rIdx * rowStride) + iIdx];
+                        }
+                    }
+                }
+                for (; cIdx < numCols; ++cIdx)
+                {
+                    for (u32 rIdx = 0; rIdx < numRows; ++rIdx)
+                    {
+                        dst[(cIdx * dstRowStride) + rIdx] = a[(rIdx * rowStride) + cIdx];
+                    }
+                }
+            }
+
+            // The number of blocks generated at once, one per 32-bit lane
+            u64 constexpr c_NumPhiloxBlocks = 4;
+
+            // Returns the high & low 32 bits of the products of every lane of a with m.
+            inline void MulHiLo(uint32x4_t a, unsigned int m, uint32x4_t & hi, uint32x4_t & lo)
+            {
+                uint64x2_t const low = vmull_n_u32(vget_low_u32(a), m);
+                uint64x2_t const high = vmull_n_u32(vget_high_u32(a), m);
+                lo = vcombine_u32(vmovn_u64(low), vmovn_u64(high));
+                hi = vcombine_u32(vshrn_n_u64(low, 32), vshrn_n_u64(high, 32));
+            }
+
+            // Computes blocks [blockIndex, blockIndex + c_NumPhiloxBlocks) of a stream, one block per lane, with
+            // word k of every block in words[k]. The low 32 bits of the block indices must not wrap.
+            inline void PhiloxBlocks(u64 key, u64 stream, u64 blockIndex, uint32x4_t * words)
+            {
+                unsigned int const laneIndices[4] = { 0, 1, 2, 3 };
+
+                unsigned int k0 = static_cast<unsigned int>(key);
+                unsigned int k1 = static_cast<unsigned int>(key >> 32);
+                uint32x4_t c0 = vaddq_u32(vdupq_n_u32(static_cast<unsigned int>(blockIndex)), vld1q_u32(laneIndices));
+                uint32x4_t c1 = vdupq_n_u32(static_cast<unsigned int>(blockIndex >> 32));
+                uint32x4_t c2 = vdupq_n_u32(static_cast<unsigned int>(stream));
+                uint32x4_t c3 = vdupq_n_u32(static_cast<unsigned int>(stream >> 32));
+
+                for (u32 rIdx = 0; rIdx < c_PhiloxNumRounds; ++rIdx)
+                {
+                    uint32x4_t hi0, lo0, hi1, lo1;
+                    MulHiLo(c0, c_PhiloxM0, hi0, lo0);
+                    MulHiLo(c2, c_PhiloxM1, hi1, lo1);
+                    c0 = veorq_u32(veorq_u32(hi1, c1), vdupq_n_u32(k0));
+                    c1 = lo1;
+                    c2 = veorq_u32(veorq_u32(hi0, c3), vdupq_n_u32(k1));
+                    c3 = lo0;
+                    k0 += c_PhiloxW0;
+                    k1 += c_PhiloxW1;
+                }
+
+                words[0] = c0;
+                words[1] = c1;
+                words[2] = c2;
+                words[3] = c3;
+            }
+
+            // Converts the top 24 bits of every lane of words into [0, 1).
+            inline float32x4_t ToUniform(uint32x4_t words)
+            {
+                return vmulq_n_f32(vcvtq_f32_u32(vshrq_n_u32(words, 8)), c_RandomScale);
+            }
+
+            // Vectorised LogOfUniform, performing the same operations.
+            inline float32x4_t LogOfUniform(float32x4_t x)
+            {
+                float32x4_t const one = vdupq_n_f32(1.0f);
+                uint32x4_t const bits = vreinterpretq_u32_f32(x);
+                float32x4_t e = vcvtq_f32_s32(vsubq_s32(vreinterpretq_s32_u32(vshrq_n_u32(bits, 23)), vdupq_n_s32(126)));
+                float32x4_t m = vreinterpretq_f32_u32(vorrq_u32(vandq_u32(bits, vdupq_n_u32(0x007FFFFFu)), vdupq_n_u32(0x3F000000u)));
+
+                uint32x4_t const isSmall = vcltq_f32(m, vdupq_n_f32(c_SqrtHalf));
+                e = vsubq_f32(e, vreinterpretq_f32_u32(vandq_u32(isSmall, vreinterpretq_u32_f32(one))));
+                m = vsubq_f32(vaddq_f32(m, vreinterpretq_f32_u32(vandq_u32(isSmall, vreinterpretq_u32_f32(m)))), one);
+
+                // vfmaq_f32(a, b, c) is a + (b * c)
+                float32x4_t const z = vmulq_f32(m, m);
+                float32x4_t p = vfmaq_f32(vdupq_n_f32(c_LogP1), vdupq_n_f32(c_LogP0), m);
+                p = vfmaq_f32(vdupq_n_f32(c_LogP2), p, m);
+                p = vfmaq_f32(vdupq_n_f32(c_LogP3), p, m);
+                p = vfmaq_f32(vdupq_n_f32(c_LogP4), p, m);
+                p = vfmaq_f32(vdupq_n_f32(c_LogP5), p, m);
+                p = vfmaq_f32(vdupq_n_f32(c_LogP6), p, m);
+                p = vfmaq_f32(vdupq_n_f32(c_LogP7), p, m);
+                p = vfmaq_f32(vdupq_n_f32(c_LogP8), p, m);
+
+                float32x4_t y = vmulq_f32(vmulq_f32(p, m), z);
+                y = vfmaq_f32(y, e, vdupq_n_f32(c_LogQ1));
+                y = vfmaq_f32(y, vdupq_n_f32(-0.5f), z);
+                return vfmaq_f32(vaddq_f32(m, y), e, vdupq_n_f32(c_LogQ2));
+            }
+
+            // Vectorised SinCosOfUniform, performing the same operations.
+            inline void SinCosOfUniform(float32x4_t t, float32x4_t & sine, float32x4_t & cosine)
+            {
+                float32x4_t const y = vmulq_n_f32(t, 8.0f);
+                int32x4_t const j = vandq_s32(vaddq_s32(vcvtq_s32_f32(y), vdupq_n_s32(1)), vdupq_n_s32(~1));
+                float32x4_t const x = vmulq_n_f32(vsubq_f32(y, vcvtq_f32_s32(j)), c_PiOver4);
+                uint32x4_t const k = vreinterpretq_u32_s32(vshrq_n_s32(j, 1));
+
+                float32x4_t const z = vmulq_f32(x, x);
+                float32x4_t const s = vfmaq_f32(x, vfmaq_f32(vdupq_n_f32(c_SinP2), vfmaq_f32(vdupq_n_f32(c_SinP1), vdupq_n_f32(c_SinP0), z), z), vmulq_f32(z, x));
+                float32x4_t const c = vfmaq_f32(vfmaq_f32(vdupq_n_f32(1.0f), vdupq_n_f32(-0.5f), z), vfmaq_f32(vdupq_n_f32(c_CosP2), vfmaq_f32(vdupq_n_f32(c_CosP1), vdupq_n_f32(c_CosP0), z), z), vmulq_f32(z, z));
+
+                uint32x4_t const one = vdupq_n_u32(1);
+                uint32x4_t const two = vdupq_n_u32(2);
+                uint32x4_t const isSwapped = vtstq_u32(k, one);
+                uint32x4_t const sineSign = vshlq_n_u32(vandq_u32(k, two), 30);
+                uint32x4_t const cosineSign = vshlq_n_u32(vandq_u32(vaddq_u32(k, one), two), 30);
+
+                sine = vreinterpretq_f32_u32(veorq_u32(vreinterpretq_u32_f32(vbslq_f32(isSwapped, c, s)), sineSign));
+                cosine = vreinterpretq_f32_u32(veorq_u32(vreinterpretq_u32_f32(vbslq_f32(isSwapped, s, c)), cosineSign));
+            }
+
+            // Generates elements of a stream with generateElements until firstIndex is at the start of a block,
+            // then c_NumPhiloxBlocks blocks at a time with generateBlocks & finally the remaining elements with
+            // generateElements.
+            template <class GenerateElements, class GenerateBlocks>
+            inline void GenerateRandom(u64 firstIndex, f32 * dst, u64 length, GenerateElements const & generateElements, GenerateBlocks const & generateBlocks)
+            {
+                u64 eIdx = (4 - (firstIndex % 4)) % 4;
+                eIdx = (eIdx < length) ? eIdx : length;
+                generateElements(firstIndex, dst, eIdx);
+
+                for (; eIdx + (4 * c_NumPhiloxBlocks) <= length; eIdx += 4 * c_NumPhiloxBlocks)
+                {
+                    u64 const blockIndex = (firstIndex + eIdx) / 4;
+                    if (((blockIndex & 0xFFFFFFFFull) + c_NumPhiloxBlocks) > 0x100000000ull)
+                    {
+                        generateElements(firstIndex + eIdx, dst + eIdx, 4 * c_NumPhiloxBlocks);
+                        continue;
+                    }
+
+                    generateBlocks(blockIndex, dst + eIdx);
+                }
+
+                generateElements(firstIndex + eIdx, dst + eIdx, length - eIdx);
+            }
+
+            void RandomUniform(u64 key, u64 stream, u64 firstIndex, f32 low, f32 high, f32 * dst, u64 length)
+            {
+                f32 const scale = (high - low) * c_RandomScale;
+                float32x4_t const scaleVec = vdupq_n_f32(scale);
+                float32x4_t const lowVec = vdupq_n_f32(low);
+
+                GenerateRandom(firstIndex, dst, length,
+                    [&](u64 index, f32 * elements, u64 numElements)
+                    {
+                        RandomUniformElements(key, stream, index, low, scale, elements, numElements);
+                    },
+                    [&](u64 blockIndex, f32 * blocks)
+                    {
+                        uint32x4_t words[4];
+                        PhiloxBlocks(key, stream, blockIndex, words);
+
+                        // The interleaving store writes the four values of each block consecutively
+                        float32x4x4_t values;
+                        for (u32 wIdx = 0; wIdx < 4; ++wIdx)
+                        {
+                            values.val[wIdx] = vfmaq_f32(lowVec, vcvtq_f32_u32(vshrq_n_u32(words[wIdx], 8)), scaleVec);
+                        }
+                        vst4q_f32(blocks, values);
+                    });
+            }
+
+            void RandomNormal(u64 key, u64 stream, u64 firstIndex, f32 mean, f32 standardDeviation, f32 * dst, u64 length)
+            {
+                float32x4_t const meanVec = vdupq_n_f32(mean);
+                float32x4_t const standardDeviationVec = vdupq_n_f32(standardDeviation);
+
+                GenerateRandom(firstIndex, dst, length,
+                    [&](u64 index, f32 * elements, u64 numElements)
+                    {
+                        RandomNormalElements(key, stream, index, mean, standardDeviation, elements, numElements);
+                    },
+                    [&](u64 blockIndex, f32 * blocks)
+                    {
+                        uint32x4_t words[4];
+                        PhiloxBlocks(key, stream, blockIndex, words);
+
+                        // Values 2n & 2n + 1 of each block are made from its words 2n & 2n + 1
+                        float32x4x4_t values;
+                        for (u32 pIdx = 0; pIdx < 2; ++pIdx)
+                        {
+                            float32x4_t const u1 = vsubq_f32(vdupq_n_f32(1.0f), ToUniform(words[2 * pIdx]));
+                            float32x4_t const u2 = ToUniform(words[(2 * pIdx) + 1]);
+                            float32x4_t const radius = vsqrtq_f32(vmulq_n_f32(LogOfUniform(u1), -2.0f));
+
+                            float32x4_t sine, cosine;
+                            SinCosOfUniform(u2, sine, cosine);
+                            values.val[2 * pIdx] = vfmaq_f32(meanVec, vmulq_f32(radius, cosine), standardDeviationVec);
+                            values.val[(2 * pIdx) + 1] = vfmaq_f32(meanVec, vmulq_f32(radius, sine), standardDeviationVec);
+                        }
+                        vst4q_f32(blocks, values);
+                    });
+            }
+
+            // Vectorised ExpOfNonPositive, performing the same operations. vfmaq_f32(a, b, c) is a + (b * c) &
+            // vfmsq_f32(a, b, c) is a - (b * c).
+            template <bool IsFast>
+            inline float32x4_t ExpOfNonPositive(float32x4_t x)
+            {
+                x = vmaxq_f32(x, vdupq_n_f32(c_ExpMin));
+                float32x4_t const n = vrndmq_f32(vfmaq_f32(vdupq_n_f32(0.5f), x, vdupq_n_f32(c_Log2E)));
+                float32x4_t r = vfmsq_f32(x, n, vdupq_n_f32(c_Ln2High));
+                r = vfmsq_f32(r, n, vdupq_n_f32(c_Ln2Low));
+
+                float32x4_t p;
+                if (IsFast)
+                {
+                    p = vfmaq_f32(vdupq_n_f32(c_FastExpP2), vfmaq_f32(vdupq_n_f32(c_FastExpP1), vdupq_n_f32(c_FastExpP0), r), r);
+                }
+                else
+                {
+                    p = vfmaq_f32(vdupq_n_f32(c_ExpP1), vdupq_n_f32(c_ExpP0), r);
+                    p = vfmaq_f32(vdupq_n_f32(c_ExpP2), p, r);
+                    p = vfmaq_f32(vdupq_n_f32(c_ExpP3), p, r);
+                    p = vfmaq_f32(vdupq_n_f32(c_ExpP4), p, r);
+                    p = vfmaq_f32(vdupq_n_f32(c_ExpP5), p, r);
+                }
+                float32x4_t const y = vaddq_f32(vfmaq_f32(r, p, vmulq_f32(r, r)), vdupq_n_f32(1.0f));
+
+                int32x4_t const bits = vshlq_n_s32(vaddq_s32(vcvtq_s32_f32(n), vdupq_n_s32(127)), 23);
+                return vmulq_f32(y, vreinterpretq_f32_s32(bits));
+            }
+
+            // Returns numerator / denominator, through the reciprocal estimate refined by a single
+            // Newton-Raphson step for the fast tier.
+            template <bool IsFast>
+            inline float32x4_t Divide(float32x4_t numerator, float32x4_t denominator)
+            {
+                if (IsFast)
+                {
+                    float32x4_t reciprocal = vrecpeq_f32(denominator);
+                    reciprocal = vmulq_f32(reciprocal, vrecpsq_f32(denominator, reciprocal));
+                    return vmulq_f32(numerator, reciprocal);
+                }
+
+                return vdivq_f32(numerator, denominator);
+            }
+
+            template <bool IsFast>
+            inline float32x4_t SigmoidVector(float32x4_t x)
+            {
+                float32x4_t const one = vdupq_n_f32(1.0f);
+                float32x4_t const e = ExpOfNonPositive<IsFast>(vnegq_f32(vabsq_f32(x)));
+                uint32x4_t const isPositive = vcgeq_f32(x, vdupq_n_f32(0.0f));
+                return Divide<IsFast>(vbslq_f32(isPositive, one, e), vaddq_f32(one, e));
+            }
+
+            template <bool IsFast>
+            inline float32x4_t TanhVector(float32x4_t x)
+            {
+                float32x4_t const one = vdupq_n_f32(1.0f);
+                float32x4_t const absX = vabsq_f32(x);
+
+                float32x4_t const z = vmulq_f32(x, x);
+                float32x4_t p = vfmaq_f32(vdupq_n_f32(c_TanhP1), vdupq_n_f32(c_TanhP0), z);
+                p = vfmaq_f32(vdupq_n_f32(c_TanhP2), p, z);
+                p = vfmaq_f32(vdupq_n_f32(c_TanhP3), p, z);
+                p = vfmaq_f32(vdupq_n_f32(c_TanhP4), p, z);
+                float32x4_t const small = vfmaq_f32(x, p, vmulq_f32(z, x));
+
+                float32x4_t const e = ExpOfNonPositive<IsFast>(vmulq_n_f32(absX, -2.0f));
+                uint32x4_t const sign = vandq_u32(vreinterpretq_u32_f32(x), vdupq_n_u32(0x80000000u));
+                float32x4_t const large = vreinterpretq_f32_u32(vorrq_u32(vreinterpretq_u32_f32(Divide<IsFast>(vsubq_f32(one, e), vaddq_f32(one, e))), sign));
+
+                return vbslq_f32(vcltq_f32(absX, vdupq_n_f32(c_TanhSmall)), small, large);
+            }
+
+            template <bool IsFast>
+            inline float32x4_t GELUVector(float32x4_t x)
+            {
+                float32x4_t const scale = vfmaq_f32(vdupq_n_f32(c_GeluScale), vdupq_n_f32(c_GeluCubicScale), vmulq_f32(x, x));
+                return vmulq_f32(x, SigmoidVector<IsFast>(vmulq_f32(x, scale)));
+            }
+
+            template <bool IsFast>
+            inline float32x4_t SiLUVector(float32x4_t x)
+            {
+                return vmulq_f32(x, SigmoidVector<IsFast>(x));
+            }
+
+            // Applies vectorOp to c_Width elements of a at a time & elementOp to the remainder.
+            template <class VectorOp, class ElementOp>
+            inline void Map(f32 const * a, f32 * dst, u64 length, VectorOp const & vectorOp, ElementOp const & elementOp)
+            {
+                u64 eIdx = 0;
+                for (; eIdx + c_Width <= length; eIdx += c_Width)
+                {
+                    vst1q_f32(dst + eIdx, vectorOp(vld1q_f32(a + eIdx)));
+                }
+                for (; eIdx < length; ++eIdx)
+                {
+                    dst[eIdx] = elementOp(a[eIdx]);
+                }
+            }
+
+            void Sigmoid(f32 const * a, f32 * dst, u64 length, MathPrecision precision)
+            {
+                if (MathPrecision::Fast == precision)
+                {
+                    Map(a, dst, length, SigmoidVector<true>, [](f32 x) { return SigmoidElement(x, true); });
+                    return;
+                }
+                Map(a, dst, length, SigmoidVector<false>, [](f32 x) { return SigmoidElement(x, false); });
+            }
+
+            void Tanh(f32 const * a, f32 * dst, u64 length, MathPrecision precision)
+            {
+                if (MathPrecision::Fast == precision)
+                {
+                    Map(a, dst, length, TanhVector<true>, [](f32 x) { return TanhElement(x, true); });
+                    return;
+                }
+                Map(a, dst, length, TanhVector<false>, [](f32 x) { return TanhElement(x, false); });
+            }
+
+            void GELU(f32 const * a, f32 * dst, u64 length, MathPrecision precision)
+            {
+                if (MathPrecision::Fast == precision)
+                {
+                    Map(a, dst, length, GELUVector<true>, [](f32 x) { return GELUElement(x, true); });
+                    return;
+                }
+                Map(a, dst, length, GELUVector<false>, [](f32 x) { return GELUElement(x, false); });
+            }
+
+            void SiLU(f32 const * a, f32 * dst, u64 length, MathPrecision precision)
+            {
+                if (MathPrecision::Fast == precision)
+                {
+                    Map(a, dst, length, SiLUVector<true>, [](f32 x) { return SiLUElement(x, true); });
+                    return;
+                }
+                Map(a, dst, length, SiLUVector<false>, [](f32 x) { return SiLUElement(x, false); });
+            }
+
+            // 8 x 8 register tile: 16 q accumulators, 2 q for the row of b & 2 q for the column of a.
+            u32 constexpr c_MR = 8;
+            u32 constexpr c_NR = 8;
+
+            void GemmMicroKernel(u32 kc, f32 const * a, f32 const * b, f32 * c, u64 rowStrideC, u32 numRows, u32 numCols, bool accumulate, GemmEpilogue const * epilogue)
+            {
+                float32x4_t acc[c_MR][2];
+                for (u32 rIdx = 0; rIdx < c_MR; ++rIdx)
+                {
+                    acc[rIdx][0] = vdupq_n_f32(0.0f);
+                    acc[rIdx][1] = vdupq_n_f32(0.0f);
+                }
+
+                for (u32 pIdx = 0; pIdx < kc; ++pIdx)
+                {
+                    float32x4_t const b0 = vld1q_f32(b);
+                    float32x4_t const b1 = vld1q_f32(b + 4);
+                    float32x4_t const a0 = vld1q_f32(a);
+                    float32x4_t const a1 = vld1q_f32(a + 4);
+
+                    acc[0][0] = vfmaq_laneq_f32(acc[0][0], b0, a0, 0);
+                    acc[0][1] = vfmaq_laneq_f32(acc[0][1], b1, a0, 0);
+                    acc[1][0] = vfmaq_laneq_f32(acc[1][0], b0, a0, 1);
+                    acc[1][1] = vfmaq_laneq_f32(acc[1][1], b1, a0, 1);
+                    acc[2][0] = vfmaq_laneq_f32(acc[2][0], b0, a0, 2);
+                    acc[2][1] = vfmaq_laneq_f32(acc[2][1], b1, a0, 2);
+                    acc[3][0] = vfmaq_laneq_f32(acc[3][0], b0, a0, 3);
+                    acc[3][1] = vfmaq_laneq_f32(acc[3][1], b1, a0, 3);
+                    acc[4][0] = vfmaq_laneq_f32(acc[4][0], b0, a1, 0);
+                    acc[4][1] = vfmaq_laneq_f32(acc[4][1], b1, a1, 0);
+                    acc[5][0] = vfmaq_laneq_f32(acc[5][0], b0, a1, 1);
+                    acc[5][1] = vfmaq_laneq_f32(acc[5][1], b1, a1, 1);
+                    acc[6][0] = vfmaq_laneq_f32(acc[6][0], b0, a1, 2);
+                    acc[6][1] = vfmaq_laneq_f32(acc[6][1], b1, a1, 2);
+                    acc[7][0] = vfmaq_laneq_f32(acc[7][0], b0, a1, 3);
+                    acc[7][1] = vfmaq_laneq_f32(acc[7][1], b1, a1, 3);
+
+                    a += c_MR;
+                    b += c_NR;
+                }
+
+                f32 tile[c_MR][c_NR];
+                for (u32 rIdx = 0; rIdx < c_MR; ++rIdx)
+                {
+                    vst1q_f32(&tile[rIdx][0], acc[rIdx][0]);
+                    vst1q_f32(&tile[rIdx][4], acc[rIdx][1]);
+                }
+
+                for (u32 rIdx = 0; rIdx < numRows; ++rIdx)
+                {
+                    f32 * dst = c + (rIdx * rowStrideC);
+                    for (u32 cIdx = 0; cIdx < numCols; ++cIdx)
+                    {
+                        f32 value = accumulate ? (dst[cIdx] + tile[rIdx][cIdx]) : tile[rIdx][cIdx];
+
+                        if (nullptr != epilogue)
+                        {
+                            if (nullptr != epilogue->rowBias)
+                            {
+                                value += epilogue->rowBias[rIdx];
+                            }
+
+                            if (nullptr != epilogue->preActivation)
+                            {
+                                epilogue->preActivation[(rIdx * rowStrideC) + cIdx] = value;
+                            }
+
+                            if (epilogue->relu && (value < 0.0f))
+                            {
+                                value = 0.0f;
+                            }
+                        }
+
+                        dst[cIdx] = value;
+                    }
+                }
+            }
+
+            KernelTable const s_NEONKernelTable = {
+                "NEON",
+                Add,
+                Scale,
+                MultiplyAdd,
+                ReLU,
+                LeakyReLU,
+                Sigmoid,
+                Tanh,
+                GELU,
+                SiLU,
+                AllClose,
+                Sum,
+                Dot,
+                Max,
+                SGDUpdate,
+                AdamUpdate,
+                Transpose,
+                RandomUniform,
+                RandomNormal,
+                { c_MR, c_NR, 256, 128, 4096, GemmMicroKernel }
+            };
+        }
+
+        KernelTable const * GetNEONKernelTable()
+        {
+            return &s_NEONKernelTable;
+        }
+    }
+}
+
+#else
+
+namespace mia
+{
+    namespace kernels
+    {
+        KernelTable const * GetNEONKernelTable()
+        {
+            return nullptr;
+        }
+    }
+}
+
+#endif
@@ -0,0 +1,284 @@
+#include "KernelTable.h"
+
+#include <math.h>
+#include <string.h>
+
+#include "ScalarElements.inl"
+
+namespace mia
+{
+    namespace kernels
+    {
+        namespace
+        {
+            // Portable implementations. These are written so the compiler can auto-vectorise them for
+            // the baseline instruction set of the build (e.g. SSE2 on x86-64).
+
+            void Add(f32 const * a, f32 const * b, f32 * dst, u64 length)
+            {
+                for (u64 eIdx = 0; eIdx < length; ++eIdx)
+                {
+                    dst[eIdx] = a[eIdx] + b[eIdx];
+                }
+            }
+
+            void Scale(f32 const * a, f32 scale, f32 * dst, u64 length)
+            {
+                for (u64 eIdx = 0; eIdx < length; ++eIdx)
+                {
+                    dst[eIdx] = a[eIdx] * scale;
+                }
+            }
+
+            void MultiplyAdd(f32 const * a, f32 scale, f32 const * b, f32 * dst, u64 length)
+            {
+                for (u64 eIdx = 0; eIdx < length; ++eIdx)
+                {
+                    dst[eIdx] = (a[eIdx] * scale) + b[eIdx];
+                }
+            }
+
+            void ReLU(f32 const * a, f32 * dst, u64 length)
+            {
+                for (u64 eIdx = 0; eIdx < length; ++eIdx)
+                {
+                    dst[eIdx] = (a[eIdx] > 0.0f) ? a[eIdx] : 0.0f;
+                }
+            }
+
+            void LeakyReLU(f32 const * a, f32 slope, f32 * dst, u64 length)
+            {
+                for (u64 eIdx = 0; eIdx < length; ++eIdx)
+                {
+                    dst[eIdx] = (a[eIdx] > 0.0f) ? a[eIdx] : (a[eIdx] * slope);
+                }
+            }
+
+            bool AllClose(f32 const * a, f32 const * b, u64 length, f32 tolerance)
+            {
+                for (u64 eIdx = 0; eIdx < length; ++eIdx)
+                {
+                    f32 const difference = a[eIdx] - b[eIdx];
+                    f32 const absDifference = (difference < 0.0f) ? -difference : difference;
+
+                    // Written so that NaN differences fail the comparison.
+                    if (!(absDifference <= tolerance))
+                    {
+                        return false;
+                    }
+                }
+
+                return true;
+            }
+
+            f32 Sum(f32 const * a, u64 length)
+            {
+                // Four independent accumulators break the dependency chain on the add.
+                f32 sums[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+
+                u64 eIdx = 0;
+                for (; eIdx + 4 <= length; eIdx += 4)
+                {
+                    sums[0] += a[eIdx + 0];
+                    sums[1] += a[eIdx + 1];
+                    sums[2] += a[eIdx + 2];
+                    sums[3] += a[eIdx + 3];
+                }
+                for (; eIdx < length; ++eIdx)
+                {
+                    sums[0] += a[eIdx];
+                }
+
+                return (sums[0] + sums[1]) + (sums[2] + sums[3]);
+            }
+
+            f32 Dot(f32 const * a, f32 const * b, u64 length)
+            {
+                f32 sums[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+
+                u64 eIdx = 0;
+                for (; eIdx + 4 <= length; eIdx += 4)
+                {
+                    sums[0] += a[eIdx + 0] * b[eIdx + 0];
+                    sums[1] += a[eIdx + 1] * b[eIdx + 1];
+                    sums[2] += a[eIdx + 2] * b[eIdx + 2];
+                    sums[3] += a[eIdx + 3] * b[eIdx + 3];
+                }
+                for (; eIdx < length; ++eIdx)
+                {
+                    sums[0] += a[eIdx] * b[eIdx];
+                }
+
+                return (sums[0] + sums[1]) + (sums[2] + sums[3]);
+            }
+
+            f32 Max(f32 const * a, u64 length)
+            {
+                f32 result = a[0];
+                for (u64 eIdx = 1; eIdx < length; ++eIdx)
+                {
+                    result = (a[eIdx] > result) ? a[eIdx] : result;
+                }
+
+                return result;
+            }
+
+            void SGDUpdate(f32 * params, f32 * velocity, f32 const * gradients, u64 length, SGDStep const & step)
+            {
+                for (u64 eIdx = 0; eIdx < length; ++eIdx)
+                {
+                    SGDUpdateElement(params[eIdx], (nullptr != velocity) ? velocity + eIdx : nullptr, gradients[eIdx], step);
+                }
+            }
+
+            void AdamUpdate(f32 * params, f32 * moment1, f32 * moment2, f32 const * gradients, u64 length, AdamStep const & step)
+            {
+                for (u64 eIdx = 0; eIdx < length; ++eIdx)
+                {
+                    AdamUpdateElement(params[eIdx], moment1[eIdx], moment2[eIdx], gradients[eIdx], step);
+                }
+            }
+
+            void Transpose(f32 const * a, u64 rowStride, u32 numRows, u32 numCols, f32 * dst, u64 dstRowStride)
+            {
+                for (u32 cIdx = 0; cIdx < numCols; ++cIdx)
+                {
+                    for (u32 rIdx = 0; rIdx < numRows; ++rIdx)
+                    {
+                        dst[(cIdx * dstRowStride) + rIdx] = a[(rIdx * rowStride) + cIdx];
+                    }
+                }
+            }
+
+            void RandomUniform(u64 key, u64 stream, u64 firstIndex, f32 low, f32 high, f32 * dst, u64 length)
+            {
+                RandomUniformElements(key, stream, firstIndex, low, (high - low) * c_RandomScale, dst, length);
+            }
+
+            void RandomNormal(u64 key, u64 stream, u64 firstIndex, f32 mean, f32 standardDeviation, f32 * dst, u64 length)
+            {
+                RandomNormalElements(key, stream, firstIndex, mean, standardDeviation, dst, length);
+            }
+
+            void Sigmoid(f32 const * a, f32 * dst, u64 length, MathPrecision precision)
+            {
+                bool const isFast = (MathPrecision::Fast == precision);
+                for (u64 eIdx = 0; eIdx < length; ++eIdx)
+                {
+                    dst[eIdx] = SigmoidElement(a[eIdx], isFast);
+                }
+            }
+
+            void Tanh(f32 const * a, f32 * dst, u64 length, MathPrecision precision)
+            {
+                bool const isFast = (MathPrecision::Fast == precision);
+                for (u64 eIdx = 0; eIdx < length; ++eIdx)
+                {
+                    dst[eIdx] = TanhElement(a[eIdx], isFast);
+                }
+            }
+
+            void GELU(f32 const * a, f32 * dst, u64 length, MathPrecision precision)
+            {
+                bool const isFast = (MathPrecision::Fast == precision);
+                for (u64 eIdx = 0; eIdx < length; ++eIdx)
+                {
+                    dst[eIdx] = GELUElement(a[eIdx], isFast);
+                }
+            }
+
+            void SiLU(f32 const * a, f32 * dst, u64 length, MathPrecision precision)
+            {
+                bool const isFast = (MathPrecision::Fast == precision);
+                for (u64 eIdx = 0; eIdx < length; ++eIdx)
+                {
+                    dst[eIdx] = SiLUElement(a[eIdx], isFast);
+                }
+            }
+
+            u32 constexpr c_MR = 4;
+            u32 constexpr c_NR = 8;
+
+            void GemmMicroKernel(u32 kc, f32 const * a, f32 const * b, f32 * c, u64 rowStrideC, u32 numRows, u32 numCols, bool accumulate, GemmEpilogue const * epilogue)
+            {
+                f32 tile[c_MR][c_NR] = {};
+
+                for (u32 pIdx = 0; pIdx < kc; ++pIdx)
+                {
+                    for (u32 rIdx = 0; rIdx < c_MR; ++rIdx)
+                    {
+                        f32 const aVal = a[rIdx];
+                        for (u32 cIdx = 0; cIdx < c_NR; ++cIdx)
+                        {
+                            tile[rIdx][cIdx] += aVal * b[cIdx];
+                        }
+                    }
+
+                    a += c_MR;
+                    b += c_NR;
+                }
+
+                for (u32 rIdx = 0; rIdx < numRows; ++rIdx)
+                {
+                    f32 * dst = c + (rIdx * rowStrideC);
+                    if (accumulate)
+                    {
+                        for (u32 cIdx = 0; cIdx < numCols; ++cIdx)
+                        {
+                            tile[rIdx][cIdx] += dst[cIdx];
+                        }
+                    }
+
+                    if (nullptr != epilogue)
+                    {
+                        f32 const bias = (nullptr != epilogue->rowBias) ? epilogue->rowBias[rIdx] : 0.0f;
+                        f32 * preActivation = (nullptr != epilogue->preActivation) ? (epilogue->preActivation + (rIdx * rowStrideC)) : nullptr;
+
+                        for (u32 cIdx = 0; cIdx < numCols; ++cIdx)
+                        {
+                            f32 value = tile[rIdx][cIdx] + bias;
+                            if (nullptr != preActivation)
+                            {
+                                preActivation[cIdx] = value;
+                            }
+                            tile[rIdx][cIdx] = (epilogue->relu && (value < 0.0f)) ? 0.0f : value;
+                        }
+                    }
+
+                    for (u32 cIdx = 0; cIdx < numCols; ++cIdx)
+                    {
+                        dst[cIdx] = tile[rIdx][cIdx];
+                    }
+                }
+            }
+
+            KernelTable const s_ScalarKernelTable = {
+                "Scalar",
+                Add,
+                Scale,
+                MultiplyAdd,
+                ReLU,
+                LeakyReLU,
+                Sigmoid,
+                Tanh,
+                GELU,
+                SiLU,
+                AllClose,
+                Sum,
+                Dot,
+                Max,
+                SGDUpdate,
+                AdamUpdate,
+                Transpose,
+                RandomUniform,
+                RandomNormal,
+                { c_MR, c_NR, 256, 128, 4096, GemmMicroKernel }
+            };
+        }
+
+        KernelTable const * GetScalarKernelTable()
+        {
+            return &s_ScalarKernelTable;
+        }
+    }
+}
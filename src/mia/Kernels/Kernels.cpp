@@ -0,0 +1,138 @@
+#include "Kernels.h"
+#include "KernelTable.h"
+
+#include "Core/CpuFeatures.h"
+
+namespace mia
+{
+    namespace kernels
+    {
+        namespace
+        {
+            KernelTable const * GetKernelTableForLevel(cpu::SimdLevel level)
+            {
+                switch (level)
+                {
+                    case cpu::SimdLevel::Scalar:    return GetScalarKernelTable();
+                    case cpu::SimdLevel::NEON:      return GetNEONKernelTable();
+                    case cpu::SimdLevel::AVX2:      return GetAVX2KernelTable();
+                    case cpu::SimdLevel::AVX512:    return GetAVX512KernelTable();
+
+                    default:
+                        ASSERTMSG(false, "Unknown SimdLevel.");
+                        break;
+                }
+
+                return nullptr;
+            }
+        }
+
+        KernelTable const & GetKernelTable()
+        {
+            // Walk down from the requested level until we find an instruction set that was compiled into
+            // this build. The scalar table always exists.
+            s32 level = static_cast<s32>(cpu::GetSimdLevel());
+            for (; level > 0; --level)
+            {
+                KernelTable const * table = GetKernelTableForLevel(static_cast<cpu::SimdLevel>(level));
+                if (nullptr != table)
+                {
+                    return *table;
+                }
+            }
+
+            return *GetScalarKernelTable();
+        }
+
+        void Add(f32 const * a, f32 const * b, f32 * dst, u64 length)
+        {
+            GetKernelTable().add(a, b, dst, length);
+        }
+
+        void Scale(f32 const * a, f32 scale, f32 * dst, u64 length)
+        {
+            GetKernelTable().scale(a, scale, dst, length);
+        }
+
+        void MultiplyAdd(f32 const * a, f32 scale, f32 const * b, f32 * dst, u64 length)
+        {
+            GetKernelTable().multiplyAdd(a, scale, b, dst, length);
+        }
+
+        void ReLU(f32 const * a, f32 * dst, u64 length)
+        {
+            GetKernelTable().relu(a, dst, length);
+        }
+
+        void LeakyReLU(f32 const * a, f32 slope, f32 * dst, u64 length)
+        {
+            GetKernelTable().leakyReLU(a, slope, dst, length);
+        }
+
+        void Sigmoid(f32 const * a, f32 * dst, u64 length, MathPrecision precision)
+        {
+            GetKernelTable().sigmoid(a, dst, length, precision);
+        }
+
+        void Tanh(f32 const * a, f32 * dst, u64 length, MathPrecision precision)
+        {
+            GetKernelTable().tanh(a, dst, length, precision);
+        }
+
+        void GELU(f32 const * a, f32 * dst, u64 length, MathPrecision precision)
+        {
+            GetKernelTable().gelu(a, dst, length, precision);
+        }
+
+        void SiLU(f32 const * a, f32 * dst, u64 length, MathPrecision precision)
+        {
+            GetKernelTable().silu(a, dst, length, precision);
+        }
+
+        bool AllClose(f32 const * a, f32 const * b, u64 length, f32 tolerance)
+        {
+            return GetKernelTable().allClose(a, b, length, tolerance);
+        }
+
+        f32 Sum(f32 const * a, u64 length)
+        {
+            return GetKernelTable().sum(a, length);
+        }
+
+        f32 Dot(f32 const * a, f32 const * b, u64 length)
+        {
+            return GetKernelTable().dot(a, b, length);
+        }
+
+        f32 Max(f32 const * a, u64 length)
+        {
+            ASSERTMSG(length > 0, "Cannot find the maximum element of an empty array.");
+            return GetKernelTable().max(a, length);
+        }
+
+        void SGDUpdate(f32 * params, f32 * velocity, f32 const * gradients, u64 length, SGDStep const & step)
+        {
+            GetKernelTable().sgdUpdate(params, velocity, gradients, length, step);
+        }
+
+        void AdamUpdate(f32 * params, f32 * moment1, f32 * moment2, f32 const * gradients, u64 length, AdamStep const & step)
+        {
+            GetKernelTable().adamUpdate(params, moment1, moment2, gradients, length, step);
+        }
+
+        void Transpose(f32 const * a, u64 rowStride, u32 numRows, u32 numCols, f32 * dst, u64 dstRowStride)
+        {
+            GetKernelTable().transpose(a, rowStride, numRows, numCols, dst, dstRowStride);
+        }
+
+        void RandomUniform(u64 key, u64 stream, u64 firstIndex, f32 low, f32 high, f32 * dst, u64 length)
+        {
+            GetKernelTable().randomUniform(key, stream, firstIndex, low, high, dst, length);
+        }
+
+        void RandomNormal(u64 key, u64 stream, u64 firstIndex, f32 mean, f32 standardDeviation, f32 * dst, u64 length)
+        {
+            GetKernelTable().randomNormal(key, stream, firstIndex, mean, standardDeviation, dst, length);
+        }
+    }
+}
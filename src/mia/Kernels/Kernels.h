@@ -0,0 +1,140 @@
+#pragma once
+
+#include "Common.h"
+
+namespace mia
+{
+    namespace kernels
+    {
+        // Array-level kernels operating on contiguous f32 data.
+        //
+        // Each kernel is implemented once per supported instruction set (Scalar, AVX2, AVX-512 & NEON)
+        // and every call dispatches to the most capable implementation the running CPU supports
+        // (see Core/CpuFeatures.h). A single build therefore runs at full speed on every machine.
+        //
+        // Unless stated otherwise, dst may alias any of the source arrays.
+
+        // How closely the transcendental activation kernels (Sigmoid, Tanh, GELU & SiLU) approximate their
+        // functions:
+        // - Accurate: the results of every instruction set are bit-identical & within the error documented
+        //   by each kernel of the exact function.
+        // - Fast: cheaper approximations of exp & of the division (the reciprocal estimate of the instruction
+        //   set), intended for inference. Results differ between instruction sets but are always within
+        //   the documented error.
+        enum class MathPrecision : u8
+        {
+            Accurate,
+            Fast
+        };
+
+        // The hyperparameters of a single step of SGDUpdate.
+        struct SGDStep
+        {
+            f32 learningRate;
+            f32 momentum;
+            f32 weightDecay;
+        };
+
+        // The hyperparameters of a single step of AdamUpdate. The bias corrections of the moments
+        // are folded into stepSize & rsqrtSecondMomentCorrection by the caller.
+        struct AdamStep
+        {
+            f32 beta1;
+            f32 beta2;
+            f32 epsilon;
+            // learningRate / (1 - beta1^t)
+            f32 stepSize;
+            // 1 / sqrt(1 - beta2^t)
+            f32 rsqrtSecondMomentCorrection;
+            // Coefficient of the L2 penalty added to the gradients (Adam's weight decay).
+            f32 gradientDecay;
+            // Fraction of each parameter removed before the update (AdamW's decoupled weight decay,
+            // i.e. learningRate * weightDecay).
+            f32 parameterDecay;
+        };
+
+        // dst[i] = a[i] + b[i]
+        void Add(f32 const * a, f32 const * b, f32 * dst, u64 length);
+
+        // dst[i] = a[i] * scale
+        void Scale(f32 const * a, f32 scale, f32 * dst, u64 length);
+
+        // dst[i] = (a[i] * scale) + b[i]
+        void MultiplyAdd(f32 const * a, f32 scale, f32 const * b, f32 * dst, u64 length);
+
+        // dst[i] = max(a[i], 0)
+        void ReLU(f32 const * a, f32 * dst, u64 length);
+
+        // dst[i] = (a[i] > 0) ? a[i] : (a[i] * slope)
+        void LeakyReLU(f32 const * a, f32 slope, f32 * dst, u64 length);
+
+        // dst[i] = 1 / (1 + exp(-a[i]))
+        // Accurate: within 3 ulp. Fast: within a relative error of 4e-4. Results below FLT_MIN (i.e. for
+        // a[i] < -87.3) are flushed to zero.
+        void Sigmoid(f32 const * a, f32 * dst, u64 length, MathPrecision precision = MathPrecision::Accurate);
+
+        // dst[i] = tanh(a[i])
+        // Accurate: within 2 ulp. Fast: within a relative error of 4e-4.
+        void Tanh(f32 const * a, f32 * dst, u64 length, MathPrecision precision = MathPrecision::Accurate);
+
+        // dst[i] = 0.5 * a[i] * (1 + tanh(sqrt(2 / pi) * (a[i] + (0.044715 * a[i]^3)))), the tanh approximation
+        // of GELU, computed as a[i] * Sigmoid(2 * sqrt(2 / pi) * (a[i] + (0.044715 * a[i]^3))).
+        // Accurate: within 32 ulp for a[i] >= -5, the error of the rounded argument grows along the negative
+        // tail (to a relative error of 1.5e-5 at a[i] = -10). Fast: within a relative error of 4e-4.
+        void GELU(f32 const * a, f32 * dst, u64 length, MathPrecision precision = MathPrecision::Accurate);
+
+        // dst[i] = a[i] / (1 + exp(-a[i])), i.e. a[i] * Sigmoid(a[i])
+        // Accurate: within 4 ulp. Fast: within a relative error of 4e-4.
+        void SiLU(f32 const * a, f32 * dst, u64 length, MathPrecision precision = MathPrecision::Accurate);
+
+        // Returns true if |a[i] - b[i]| <= tolerance for every element. NaNs never compare as close.
+        bool AllClose(f32 const * a, f32 const * b, u64 length, f32 tolerance);
+
+        // Returns the sum of all elements.
+        f32 Sum(f32 const * a, u64 length);
+
+        // Returns the sum of a[i] * b[i] over all elements.
+        f32 Dot(f32 const * a, f32 const * b, u64 length);
+
+        // Returns the largest element. Length is expected to be greater than zero.
+        f32 Max(f32 const * a, u64 length);
+
+        // Stochastic gradient descent with (optional) momentum & L2 weight decay, in a single pass:
+        // g = gradients[i] + (weightDecay * params[i])
+        // velocity[i] = (momentum * velocity[i]) + g
+        // params[i] = params[i] - (learningRate * velocity[i])
+        // If velocity is nullptr the momentum is ignored & params[i] = params[i] - (learningRate * g).
+        void SGDUpdate(f32 * params, f32 * velocity, f32 const * gradients, u64 length, SGDStep const & step);
+
+        // Adam (or AdamW through AdamStep::parameterDecay), in a single pass:
+        // g = gradients[i] + (gradientDecay * params[i])
+        // moment1[i] = (beta1 * moment1[i]) + ((1 - beta1) * g)
+        // moment2[i] = (beta2 * moment2[i]) + ((1 - beta2) * g * g)
+        // params[i] = (params[i] * (1 - parameterDecay)) - (stepSize * moment1[i] / ((sqrt(moment2[i]) * rsqrtSecondMomentCorrection) + epsilon))
+        void AdamUpdate(f32 * params, f32 * moment1, f32 * moment2, f32 const * gradients, u64 length, AdamStep const & step);
+
+        // Transposes the numRows x numCols block a into the numCols x numRows block dst:
+        // dst[(cIdx * dstRowStride) + rIdx] = a[(rIdx * rowStride) + cIdx]
+        // Full 8 x 8 (4 x 4 on NEON) sub-blocks are transposed in registers. The block is expected to be
+        // small enough for a & dst to fit in the L1 cache together (see Matrix::TransposeInto).
+        // dst must not overlap a.
+        void Transpose(f32 const * a, u64 rowStride, u32 numRows, u32 numCols, f32 * dst, u64 dstRowStride);
+
+        // Fills dst with uniformly distributed values between low & high drawn from the Philox4x32-10
+        // counter-based generator (Salmon et al., 2011), keyed by key:
+        // dst[i] = low + ((high - low) * (word(firstIndex + i) >> 8) / 2^24)
+        // where word(n) is the (n % 4)th 32-bit word of block n / 4 of the stream, i.e. of Philox4x32-10
+        // applied to the counter { n / 4, stream }. Each value only depends on key, stream & its index, so any
+        // range of a stream can be generated independently (e.g. split across threads) & every implementation
+        // produces bit-identical values (the scaling is a single fused multiply-add).
+        void RandomUniform(u64 key, u64 stream, u64 firstIndex, f32 low, f32 high, f32 * dst, u64 length);
+
+        // Fills dst with normally distributed values of the supplied mean & standard deviation drawn from the same
+        // streams as RandomUniform. Each block of four words gives four values, 4n + k for k in [0, 4): values
+        // 2m & 2m + 1 of the block are made from its words 2m & 2m + 1 by the Box-Muller transform. The logarithm,
+        // sine & cosine are polynomial approximations (those of Cephes) accurate to a few ulp, performed in the
+        // same order (with the same fused multiply-adds) by every implementation so they produce bit-identical
+        // values.
+        void RandomNormal(u64 key, u64 stream, u64 firstIndex, f32 mean, f32 standardDeviation, f32 * dst, u64 length);
+    }
+}
@@ -0,0 +1,314 @@
+#pragma once
+
+#include "KernelTable.h"
+
+#include <math.h>
+#include <string.h>
+
+// The scalar, single element versions of kernels that every implementation in Kernels.*.cpp shares, e.g. to
+// handle the elements left over after their vectors. Keeping a single definition guarantees the tails (& the
+// portable kernels) compute exactly the same values on every instruction set.
+//
+// Each kernel translation unit includes this file & compiles its own copy with its own code generation flags.
+// Everything in here must therefore stay inside the anonymous namespace: with internal linkage the linker can
+// never pick a copy compiled for an instruction set the CPU lacks.
+
+namespace mia
+{
+    namespace kernels
+    {
+        namespace
+        {
+            // Updates a single element, see SGDUpdate in Kernels.h.
+            inline void SGDUpdateElement(f32 & param, f32 * velocity, f32 gradient, SGDStep const & step)
+            {
+                f32 update = gradient + (step.weightDecay * param);
+                if (nullptr != velocity)
+                {
+                    update += step.momentum * *velocity;
+                    *velocity = update;
+                }
+                param -= step.learningRate * update;
+            }
+
+            // Updates a single element, see AdamUpdate in Kernels.h.
+            inline void AdamUpdateElement(f32 & param, f32 & moment1, f32 & moment2, f32 gradient, AdamStep const & step)
+            {
+                f32 const g = gradient + (step.gradientDecay * param);
+                moment1 = (step.beta1 * moment1) + ((1.0f - step.beta1) * g);
+                moment2 = (step.beta2 * moment2) + ((1.0f - step.beta2) * g * g);
+                param = (param * (1.0f - step.parameterDecay)) - ((step.stepSize * moment1) / ((sqrtf(moment2) * step.rsqrtSecondMomentCorrection) + step.epsilon));
+            }
+
+            // The multipliers & key increments of Philox4x32-10 (Salmon et al., 2011).
+            unsigned int constexpr c_PhiloxM0 = 0xD2511F53u;
+            unsigned int constexpr c_PhiloxM1 = 0xCD9E8D57u;
+            unsigned int constexpr c_PhiloxW0 = 0x9E3779B9u;
+            unsigned int constexpr c_PhiloxW1 = 0xBB67AE85u;
+            u32 constexpr c_PhiloxNumRounds = 10;
+
+            // Converts the top 24 bits of a 32-bit word into [0, 1).
+            f32 constexpr c_RandomScale = 1.0f / 16777216.0f;
+
+            // Computes the four 32-bit words of block blockIndex of a stream, see RandomUniform in Kernels.h.
+            inline void PhiloxBlock(u64 key, u64 stream, u64 blockIndex, unsigned int * words)
+            {
+                unsigned int k0 = static_cast<unsigned int>(key);
+                unsigned int k1 = static_cast<unsigned int>(key >> 32);
+                unsigned int c0 = static_cast<unsigned int>(blockIndex);
+                unsigned int c1 = static_cast<unsigned int>(blockIndex >> 32);
+                unsigned int c2 = static_cast<unsigned int>(stream);
+                unsigned int c3 = static_cast<unsigned int>(stream >> 32);
+
+                for (u32 rIdx = 0; rIdx < c_PhiloxNumRounds; ++rIdx)
+                {
+                    u64 const product0 = static_cast<u64>(c_PhiloxM0) * c0;
+                    u64 const product1 = static_cast<u64>(c_PhiloxM1) * c2;
+                    c0 = static_cast<unsigned int>(product1 >> 32) ^ c1 ^ k0;
+                    c1 = static_cast<unsigned int>(product1);
+                    c2 = static_cast<unsigned int>(product0 >> 32) ^ c3 ^ k1;
+                    c3 = static_cast<unsigned int>(product0);
+                    k0 += c_PhiloxW0;
+                    k1 += c_PhiloxW1;
+                }
+
+                words[0] = c0;
+                words[1] = c1;
+                words[2] = c2;
+                words[3] = c3;
+            }
+
+            // Generates elements of a stream one block at a time, see RandomUniform in Kernels.h.
+            // scale is (high - low) * c_RandomScale.
+            inline void RandomUniformElements(u64 key, u64 stream, u64 firstIndex, f32 low, f32 scale, f32 * dst, u64 length)
+            {
+                u64 eIdx = 0;
+                while (eIdx < length)
+                {
+                    u64 const index = firstIndex + eIdx;
+                    unsigned int words[4];
+                    PhiloxBlock(key, stream, index / 4, words);
+
+                    for (u64 wIdx = index % 4; (wIdx < 4) && (eIdx < length); ++wIdx, ++eIdx)
+                    {
+                        dst[eIdx] = fmaf(static_cast<f32>(words[wIdx] >> 8), scale, low);
+                    }
+                }
+            }
+
+            // The constants of the logarithm & sine/cosine approximations of RandomNormal (those of Cephes' logf,
+            // sinf & cosf).
+            f32 constexpr c_SqrtHalf = 0.707106781186547524f;
+            f32 constexpr c_LogP0 = 7.0376836292e-2f;
+            f32 constexpr c_LogP1 = -1.1514610310e-1f;
+            f32 constexpr c_LogP2 = 1.1676998740e-1f;
+            f32 constexpr c_LogP3 = -1.2420140846e-1f;
+            f32 constexpr c_LogP4 = 1.4249322787e-1f;
+            f32 constexpr c_LogP5 = -1.6668057665e-1f;
+            f32 constexpr c_LogP6 = 2.0000714765e-1f;
+            f32 constexpr c_LogP7 = -2.4999993993e-1f;
+            f32 constexpr c_LogP8 = 3.3333331174e-1f;
+            f32 constexpr c_LogQ1 = -2.12194440e-4f;
+            f32 constexpr c_LogQ2 = 0.693359375f;
+            f32 constexpr c_PiOver4 = 0.785398163397448309616f;
+            f32 constexpr c_SinP0 = -1.9515295891e-4f;
+            f32 constexpr c_SinP1 = 8.3321608736e-3f;
+            f32 constexpr c_SinP2 = -1.6666654611e-1f;
+            f32 constexpr c_CosP0 = 2.443315711809948e-5f;
+            f32 constexpr c_CosP1 = -1.388731625493765e-3f;
+            f32 constexpr c_CosP2 = 4.166664568298827e-2f;
+
+            // Returns ln(x) for x in (0, 1]. Every implementation of RandomNormal performs exactly the same
+            // operations (fusing the same multiply-adds) so they produce bit-identical values.
+            inline f32 LogOfUniform(f32 x)
+            {
+                // x = m * 2^e with m in [0.5, 1)
+                unsigned int bits;
+                memcpy(&bits, &x, sizeof(bits));
+                f32 e = static_cast<f32>(static_cast<s32>(bits >> 23) - 126);
+                bits = (bits & 0x007FFFFFu) | 0x3F000000u;
+                f32 m;
+                memcpy(&m, &bits, sizeof(m));
+
+                // Bring m - 1 into [sqrt(0.5) - 1, sqrt(2) - 1)
+                if (m < c_SqrtHalf)
+                {
+                    e = e - 1.0f;
+                    m = (m + m) - 1.0f;
+                }
+                else
+                {
+                    m = m - 1.0f;
+                }
+
+                f32 const z = m * m;
+                f32 p = fmaf(c_LogP0, m, c_LogP1);
+                p = fmaf(p, m, c_LogP2);
+                p = fmaf(p, m, c_LogP3);
+                p = fmaf(p, m, c_LogP4);
+                p = fmaf(p, m, c_LogP5);
+                p = fmaf(p, m, c_LogP6);
+                p = fmaf(p, m, c_LogP7);
+                p = fmaf(p, m, c_LogP8);
+
+                f32 y = (p * m) * z;
+                y = fmaf(e, c_LogQ1, y);
+                y = fmaf(-0.5f, z, y);
+                return fmaf(e, c_LogQ2, m + y);
+            }
+
+            // Returns the sine & cosine of 2 * pi * t for t in [0, 1), see LogOfUniform.
+            inline void SinCosOfUniform(f32 t, f32 & sine, f32 & cosine)
+            {
+                // Reduce the angle to x in [-pi / 4, pi / 4] plus k quarter turns
+                f32 const y = t * 8.0f;
+                s32 const j = (static_cast<s32>(y) + 1) & ~1;
+                f32 const x = (y - static_cast<f32>(j)) * c_PiOver4;
+                s32 const k = j >> 1;
+
+                f32 const z = x * x;
+                f32 const s = fmaf(fmaf(fmaf(c_SinP0, z, c_SinP1), z, c_SinP2), z * x, x);
+                f32 const c = fmaf(fmaf(fmaf(c_CosP0, z, c_CosP1), z, c_CosP2), z * z, fmaf(-0.5f, z, 1.0f));
+
+                sine = (0 != (k & 1)) ? c : s;
+                cosine = (0 != (k & 1)) ? s : c;
+                sine = (0 != (k & 2)) ? -sine : sine;
+                cosine = (0 != ((k + 1) & 2)) ? -cosine : cosine;
+            }
+
+            // Computes the four normally distributed values of a block from its words, see RandomNormal in
+            // Kernels.h.
+            inline void NormalBlock(unsigned int const * words, f32 mean, f32 standardDeviation, f32 * values)
+            {
+                for (u32 pIdx = 0; pIdx < 2; ++pIdx)
+                {
+                    // u1 is in (0, 1] so its log is finite
+                    f32 const u1 = 1.0f - (static_cast<f32>(words[2 * pIdx] >> 8) * c_RandomScale);
+                    f32 const u2 = static_cast<f32>(words[(2 * pIdx) + 1] >> 8) * c_RandomScale;
+                    f32 const radius = sqrtf(-2.0f * LogOfUniform(u1));
+
+                    f32 sine, cosine;
+                    SinCosOfUniform(u2, sine, cosine);
+                    values[2 * pIdx] = fmaf(radius * cosine, standardDeviation, mean);
+                    values[(2 * pIdx) + 1] = fmaf(radius * sine, standardDeviation, mean);
+                }
+            }
+
+            // Generates normally distributed elements of a stream one block at a time, see RandomNormal in
+            // Kernels.h.
+            inline void RandomNormalElements(u64 key, u64 stream, u64 firstIndex, f32 mean, f32 standardDeviation, f32 * dst, u64 length)
+            {
+                u64 eIdx = 0;
+                while (eIdx < length)
+                {
+                    u64 const index = firstIndex + eIdx;
+                    unsigned int words[4];
+                    f32 values[4];
+                    PhiloxBlock(key, stream, index / 4, words);
+                    NormalBlock(words, mean, standardDeviation, values);
+
+                    for (u64 wIdx = index % 4; (wIdx < 4) && (eIdx < length); ++wIdx, ++eIdx)
+                    {
+                        dst[eIdx] = values[wIdx];
+                    }
+                }
+            }
+
+            // exp(x) = 2^n * exp(r), where n = round(x / ln(2)) & r = x - (n * ln(2)) is computed exactly by
+            // splitting ln(2) into c_Ln2High + c_Ln2Low. exp(r) is approximated by a polynomial, those of
+            // Cephes' expf for MathPrecision::Accurate & the Taylor series truncated after r^4 for
+            // MathPrecision::Fast.
+            f32 constexpr c_ExpMin = -88.0f;
+            f32 constexpr c_Log2E = 1.44269504088896341f;
+            f32 constexpr c_Ln2High = 0.693359375f;
+            f32 constexpr c_Ln2Low = -2.12194440e-4f;
+            f32 constexpr c_ExpP0 = 1.9875691500e-4f;
+            f32 constexpr c_ExpP1 = 1.3981999507e-3f;
+            f32 constexpr c_ExpP2 = 8.3334519073e-3f;
+            f32 constexpr c_ExpP3 = 4.1665795894e-2f;
+            f32 constexpr c_ExpP4 = 1.6666665459e-1f;
+            f32 constexpr c_ExpP5 = 5.0000001201e-1f;
+            f32 constexpr c_FastExpP0 = 1.0f / 24.0f;
+            f32 constexpr c_FastExpP1 = 1.0f / 6.0f;
+            f32 constexpr c_FastExpP2 = 0.5f;
+
+            // tanh(x) = x + (x^3 * P(x^2)) for |x| < c_TanhSmall (the polynomial of Cephes' tanhf), otherwise
+            // (1 - exp(-2|x|)) / (1 + exp(-2|x|)) with the sign of x.
+            f32 constexpr c_TanhSmall = 0.625f;
+            f32 constexpr c_TanhP0 = -5.70498872745e-3f;
+            f32 constexpr c_TanhP1 = 2.06390887954e-2f;
+            f32 constexpr c_TanhP2 = -5.37397155531e-2f;
+            f32 constexpr c_TanhP3 = 1.33314422036e-1f;
+            f32 constexpr c_TanhP4 = -3.33332819422e-1f;
+
+            // GELU(x) = 0.5 * x * (1 + tanh(sqrt(2 / pi) * (x + (0.044715 * x^3)))), which is
+            // x * sigmoid(x * (c_GeluScale + (c_GeluCubicScale * x^2))).
+            f32 constexpr c_GeluScale = 1.59576912160573071f;
+            f32 constexpr c_GeluCubicScale = 0.0713548162726002527f;
+
+            // Returns exp(x) for x <= 0, flushing results below FLT_MIN to zero.
+            inline f32 ExpOfNonPositive(f32 x, bool isFast)
+            {
+                x = fmaxf(x, c_ExpMin);
+                f32 const n = floorf(fmaf(x, c_Log2E, 0.5f));
+                f32 r = fmaf(n, -c_Ln2High, x);
+                r = fmaf(n, -c_Ln2Low, r);
+
+                f32 p;
+                if (isFast)
+                {
+                    p = fmaf(fmaf(c_FastExpP0, r, c_FastExpP1), r, c_FastExpP2);
+                }
+                else
+                {
+                    p = fmaf(c_ExpP0, r, c_ExpP1);
+                    p = fmaf(p, r, c_ExpP2);
+                    p = fmaf(p, r, c_ExpP3);
+                    p = fmaf(p, r, c_ExpP4);
+                    p = fmaf(p, r, c_ExpP5);
+                }
+                f32 const y = fmaf(p, r * r, r) + 1.0f;
+
+                // 2^n is built directly from its exponent bits, n = -127 gives zero
+                unsigned int const bits = static_cast<unsigned int>(static_cast<int>(n) + 127) << 23;
+                f32 scale;
+                memcpy(&scale, &bits, sizeof(f32));
+                return y * scale;
+            }
+
+            inline f32 SigmoidElement(f32 x, bool isFast)
+            {
+                // exp(-|x|) can't overflow: sigmoid(|x|) = 1 / (1 + e) & sigmoid(-|x|) = e / (1 + e)
+                f32 const e = ExpOfNonPositive(-fabsf(x), isFast);
+                return ((x >= 0.0f) ? 1.0f : e) / (1.0f + e);
+            }
+
+            inline f32 TanhElement(f32 x, bool isFast)
+            {
+                f32 const absX = fabsf(x);
+                if (absX < c_TanhSmall)
+                {
+                    f32 const z = x * x;
+                    f32 p = fmaf(c_TanhP0, z, c_TanhP1);
+                    p = fmaf(p, z, c_TanhP2);
+                    p = fmaf(p, z, c_TanhP3);
+                    p = fmaf(p, z, c_TanhP4);
+                    return fmaf(p, z * x, x);
+                }
+
+                f32 const e = ExpOfNonPositive(-2.0f * absX, isFast);
+                return copysignf((1.0f - e) / (1.0f + e), x);
+            }
+
+            inline f32 GELUElement(f32 x, bool isFast)
+            {
+                return x * SigmoidElement(x * fmaf(c_GeluCubicScale, x * x, c_GeluScale), isFast);
+            }
+
+            inline f32 SiLUElement(f32 x, bool isFast)
+            {
+                return x * SigmoidElement(x, isFast);
+            }
+        }
+    }
+}
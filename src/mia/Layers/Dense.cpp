@@ -4,9 +4,18 @@ namespace mia
 {
     namespace layers
     {
-        Dense::Dense(u32 numNeurons, activators::ActivatorType activatorType)
+        namespace
+        {
+            // The weights & biases are drawn from different streams so they never share values
+            u64 constexpr c_WeightsStream = 0;
+            u64 constexpr c_BiasesStream = 1;
+        }
+
+        Dense::Dense(u32 numNeurons, activators::ActivatorType activatorType, initializers::Initializer const & weightsInitializer, initializers::Initializer const & biasesInitializer)
             : Layer(activatorType)
             , m_NumNeurons(numNeurons)
+            , m_WeightsInitializer(weightsInitializer)
+            , m_BiasesInitializer(biasesInitializer)
         {
         }
 
@@ -18,13 +27,16 @@ namespace mia
             // Reserve space in the m_Values matrix for our neurons
             m_Values = Matrix(1, m_NumNeurons);
 
-            // Reserve space in the m_Weights matrix & seed it
-            m_Weights = Matrix(prevLayer->GetNumNeurons(), m_NumNeurons);
-            m_Weights.Seed(seedValue);
+            // Reserve space in the m_Weights matrix & seed it. Parameters live for as long as the
+            // model so come from the pool rather than the general heap.
+            u32 const numInputs = prevLayer->GetNumNeurons();
+            m_Weights = Matrix(numInputs, m_NumNeurons, PoolAllocator::GetParameterPool());
+            initializers::Initialize(m_WeightsInitializer, GetActivatorType(), numInputs, m_NumNeurons, seedValue, c_WeightsStream, m_Weights);
+            PackWeights();
 
             // Reserve space in the m_Biases matrix & seed it
-            m_Biases = Matrix(1, m_NumNeurons);
-            m_Biases.Seed(seedValue);
+            m_Biases = Matrix(1, m_NumNeurons, PoolAllocator::GetParameterPool());
+            initializers::Initialize(m_BiasesInitializer, GetActivatorType(), numInputs, m_NumNeurons, seedValue, c_BiasesStream, m_Biases);
         }
     }
 }
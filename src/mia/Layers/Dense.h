@@ -1,6 +1,7 @@
 #pragma once
 
 #include "Layers/Layer.h"
+#include "Initializers/Initializer.h"
 
 namespace mia
 {
@@ -14,13 +15,19 @@ namespace mia
             Dense() = delete;
             virtual ~Dense() = default;
 
-            // Constructs a Dense layer with n number of neurons contained within.
-            Dense(u32 numNeurons, activators::ActivatorType activatorType = activators::ActivatorType::ReLU);
-        
+            // Constructs a Dense layer with n number of neurons contained within. The weights & biases are
+            // filled by the supplied initializers when the layer is compiled.
+            Dense(u32 numNeurons, activators::ActivatorType activatorType = activators::ActivatorType::ReLU,
+                initializers::Initializer const & weightsInitializer = initializers::Initializer::Default(),
+                initializers::Initializer const & biasesInitializer = initializers::Initializer::Default());
+
             virtual void Compile(u32 seedValue, Layer const * prevLayer) override;
+            virtual LayerClass GetClass() const override { return LayerClass::Dense; }
 
         private:
             u32 m_NumNeurons;
+            initializers::Initializer m_WeightsInitializer;
+            initializers::Initializer m_BiasesInitializer;
         };
     }
 }
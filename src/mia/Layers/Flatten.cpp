@@ -1,17 +1,25 @@
 #include "Flatten.h"
 
+#include <string.h>
+
 namespace mia
 {
     namespace layers
     {
         Flatten::Flatten(std::initializer_list<DimensionLength> const & inputDimensionLengths, activators::ActivatorType activatorType)
+            : Flatten(static_cast<u32>(inputDimensionLengths.size()), inputDimensionLengths.begin(), activatorType)
+        {
+        }
+
+        Flatten::Flatten(u32 inputNumDimensions, DimensionLength const * inputDimensionLengths, activators::ActivatorType activatorType)
             : InputLayer(activatorType)
-            , m_InputNumDimensions(static_cast<u32>(inputDimensionLengths.size()))
+            , m_InputNumDimensions(inputNumDimensions)
             , m_InputDimensionLengths(nullptr)
         {
             ASSERTMSG(m_InputNumDimensions != 0, "Cannot create a Flatten layer with expected data containing 0 dimensions.");
+            ASSERTMSG(m_InputNumDimensions < c_MaxTensorDimensions, "Flatten layer's input shape has too many dimensions to be batched.");
             m_InputDimensionLengths = new u32[m_InputNumDimensions];
-            memcpy(m_InputDimensionLengths, inputDimensionLengths.begin(), m_InputNumDimensions * sizeof(u32));
+            memcpy(m_InputDimensionLengths, inputDimensionLengths, m_InputNumDimensions * sizeof(u32));
         }
 
         Flatten::~Flatten()
@@ -42,28 +50,35 @@ namespace mia
             m_Weights = Matrix();
         }
 
-        void Flatten::SetInputData(NDArrayView<f32> const & inputData)
+        void Flatten::SetInputData(Tensor const & inputData)
         {
             // Check the supplied inputData matches the expected shape
             ASSERTMSG(GetNumNeurons() > 0, "Flatten layer's compile hasn't been called.");
-            ASSERTMSG(m_InputNumDimensions == inputData.GetNumDimensions(), "Supplied input data to the flatten layer doesn't match the expected input shape.");
 
+            bool const hasSampleDimension = (m_InputNumDimensions + 1) == inputData.GetNumDimensions();
+            ASSERTMSG(hasSampleDimension || (m_InputNumDimensions == inputData.GetNumDimensions()), "Supplied input data to the flatten layer doesn't match the expected input shape.");
+
+            u32 const sampleDimensionOffset = hasSampleDimension ? 1 : 0;
             for (u32 dIdx = 0; dIdx < m_InputNumDimensions; ++dIdx)
             {
                 u32 const expectedDimensionLength = m_InputDimensionLengths[dIdx];
-                u32 const suppliedDimensionLength = inputData.GetDimension(dIdx).length;
+                u32 const suppliedDimensionLength = inputData.GetLength(sampleDimensionOffset + dIdx);
 
                 ASSERTMSG(expectedDimensionLength == suppliedDimensionLength, "Supplied input data to the flatten layer doesn't match the expected input shape.");
             }
 
-            // Copy data into the m_Values matrix
-            u32 columnOffset = 0;
-            for (u32 dIdx = 0; dIdx < inputData.GetNumDimensions(); ++dIdx)
+            u32 const numSamples = hasSampleDimension ? inputData.GetLength(0) : 1;
+            ASSERTMSG(numSamples > 0, "Supplied input data to the flatten layer doesn't contain any samples.");
+
+            // Give a single sample its sample dimension, which never requires a copy
+            DimensionLength samplesShape[c_MaxTensorDimensions];
+            samplesShape[0] = numSamples;
+            for (u32 dIdx = 0; dIdx < m_InputNumDimensions; ++dIdx)
             {
-                NDArrayViewElement<f32> const & elementView = inputData.GetDimension(dIdx);
-                m_Values.Copy(0, columnOffset, elementView.data, elementView.length);
-                columnOffset += elementView.length;
+                samplesShape[dIdx + 1] = m_InputDimensionLengths[dIdx];
             }
+
+            SetSamples(hasSampleDimension ? inputData : inputData.Reshape(m_InputNumDimensions + 1, samplesShape));
         }
     }
 }
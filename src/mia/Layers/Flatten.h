@@ -17,16 +17,37 @@ namespace mia
             // Constructs a Flatten layer using the supplied input shape.
             // e.g. { 2, 2, 2 } describes a 2x2x2 dataset.
             Flatten(std::initializer_list<DimensionLength> const & inputDimensionLengths, activators::ActivatorType activatorType = activators::ActivatorType::ReLU);
+            Flatten(u32 inputNumDimensions, DimensionLength const * inputDimensionLengths, activators::ActivatorType activatorType = activators::ActivatorType::ReLU);
 
             virtual void Compile(u32 seedValue, Layer const * prevLayer) override;
+            virtual LayerClass GetClass() const override { return LayerClass::Flatten; }
             virtual void Execute(Layer const * prevLayer) override { /* Flattening does not have weights associated with it. */ }
 
-            // Converts & flattens the supplied inputData into the local m_Values matrix for use by another layer.
-            virtual void SetInputData(NDArrayView<f32> const & inputData) override;
+            // Flattens each sample of the supplied inputData, in row-major order, into its own column of the
+            // layer's values. inputData's shape is the number of samples followed by the input shape, the
+            // leading dimension may be omitted for a single sample.
+            //
+            // The input data is viewed in place whenever its layout allows (see InputLayer::SetSamples), so
+            // flattening it costs nothing regardless of its size. Only non-contiguous samples are copied.
+            virtual void SetInputData(Tensor const & inputData) override;
+
+            // Returns the shape of a single sample of input data
+            u32 GetInputNumDimensions() const;
+            DimensionLength const * GetInputDimensionLengths() const;
 
         private:
             u32 m_InputNumDimensions;
             DimensionLength * m_InputDimensionLengths;
         };
+
+        inline u32 Flatten::GetInputNumDimensions() const
+        {
+            return m_InputNumDimensions;
+        }
+
+        inline DimensionLength const * Flatten::GetInputDimensionLengths() const
+        {
+            return m_InputDimensionLengths;
+        }
     }
 }
@@ -0,0 +1,66 @@
+#include "Gradients.h"
+#include "Kernels/Kernels.h"
+
+#include <algorithm>
+#include <string.h>
+
+namespace mia
+{
+    namespace layers
+    {
+        void ReduceGradients(Layer & layer, u32 numLayers, Layer const * const * layers, f32 const * scales, u64 begin, u64 end)
+        {
+            ASSERTMSG(numLayers > 0, "There must be at least one set of gradients to reduce.");
+            ASSERTMSG((begin <= end) && (end <= layer.GetNumParameters()), "The range doesn't lie within the layer's parameters.");
+
+            // The weight gradients then the bias gradients, each reduced over the part of the range they hold
+            auto getGradients = [](Layer const * srcLayer, u32 gIdx) -> Matrix const &
+            {
+                return (0 == gIdx) ? srcLayer->GetWeightGradients() : srcLayer->GetBiasGradients();
+            };
+
+            u64 offset = 0;
+            for (u32 gIdx = 0; gIdx < 2; ++gIdx)
+            {
+                Matrix & dstGradients = (0 == gIdx) ? layer.GetWeightGradients() : layer.GetBiasGradients();
+                f32 * dst = dstGradients.GetData();
+                u64 const numElements = dstGradients.GetCapacity();
+                u64 const rangeBegin = std::max(begin, offset);
+                u64 const rangeEnd = std::min(end, offset + numElements);
+                if (rangeBegin < rangeEnd)
+                {
+                    u64 const elementOffset = rangeBegin - offset;
+                    u64 const length = rangeEnd - rangeBegin;
+                    for (u32 lIdx = 0; lIdx < numLayers; ++lIdx)
+                    {
+                        Matrix const & src = getGradients(layers[lIdx], gIdx);
+                        ASSERTMSG(src.GetCapacity() == numElements, "The layers' gradients don't match.");
+
+                        // The first set of gradients overwrites the previous ones
+                        if (0 == lIdx)
+                        {
+                            kernels::Scale(src.GetData() + elementOffset, scales[lIdx], dst + elementOffset, length);
+                        }
+                        else
+                        {
+                            kernels::MultiplyAdd(src.GetData() + elementOffset, scales[lIdx], dst + elementOffset, dst + elementOffset, length);
+                        }
+                    }
+                }
+
+                offset += numElements;
+            }
+        }
+
+        void SetGradients(Layer & layer, f32 const * weightGradients, f32 const * biasGradients)
+        {
+            Matrix & layerWeightGradients = layer.GetWeightGradients();
+            Matrix & layerBiasGradients = layer.GetBiasGradients();
+            ASSERTMSG(layerWeightGradients.GetCapacity() == layer.GetWeights().GetCapacity(), "The weight gradients don't match the weights, has the layer been reserved for training?");
+            ASSERTMSG(layerBiasGradients.GetCapacity() == layer.GetBiases().GetCapacity(), "The bias gradients don't match the biases, has the layer been reserved for training?");
+
+            memcpy(layerWeightGradients.GetData(), weightGradients, layerWeightGradients.GetCapacity() * sizeof(f32));
+            memcpy(layerBiasGradients.GetData(), biasGradients, layerBiasGradients.GetCapacity() * sizeof(f32));
+        }
+    }
+}
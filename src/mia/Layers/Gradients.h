@@ -0,0 +1,24 @@
+#pragma once
+
+#include "Layers/Layer.h"
+
+namespace mia
+{
+    namespace layers
+    {
+        // Combines the gradients that several copies of a layer computed, for the trainers that split the
+        // gradients of a batch across threads or processes (see models::DataParallelTrainer &
+        // models::DistributedTrainer). The combined gradients replace the layer's own, ready for ApplyGradients.
+
+        // Replaces the layer's weight & bias gradients by the weighted sum, with the supplied scales, of the
+        // gradients of the supplied layers, e.g. of replicas of the layer that computed them over shards of a
+        // batch. The layers must have the same shape as layer, which may be the first of them. Only elements
+        // [begin, end) of the weight gradients followed by the bias gradients (see Layer::GetNumParameters) are
+        // combined, so that disjoint ranges can be combined on different threads at once.
+        void ReduceGradients(Layer & layer, u32 numLayers, Layer const * const * layers, f32 const * scales, u64 begin, u64 end);
+
+        // Copies the supplied gradients over the layer's weight & bias gradients, e.g. gradients combined across
+        // processes. Each must hold as many elements as the layer's weights & biases respectively.
+        void SetGradients(Layer & layer, f32 const * weightGradients, f32 const * biasGradients);
+    }
+}
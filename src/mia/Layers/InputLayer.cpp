@@ -0,0 +1,56 @@
+#include "InputLayer.h"
+
+namespace mia
+{
+    namespace layers
+    {
+        u32 InputLayer::GetBatchSize() const
+        {
+            return IsViewingInputData() ? m_InputValues.GetLength(1) : Layer::GetBatchSize();
+        }
+
+        Tensor InputLayer::GetValuesView() const
+        {
+            return IsViewingInputData() ? m_InputValues : Layer::GetValuesView();
+        }
+
+        void InputLayer::SetSamples(Tensor const & samples)
+        {
+            u32 const numDimensions = samples.GetNumDimensions();
+            ASSERTMSG(numDimensions >= 2, "Expected the samples to have a sample dimension followed by at least one other.");
+
+            u32 const numSamples = samples.GetLength(0);
+            u32 const numNeurons = GetNumNeurons();
+            ASSERTMSG(samples.GetNumElements() == static_cast<u64>(numSamples) * numNeurons, "The samples don't match the number of neurons in the layer.");
+
+            // Each sample is a row of a (numSamples x numNeurons) view of the data, its transpose holds one
+            // column per sample without a single element being touched.
+            DimensionLength const flatShape[] = { numSamples, numNeurons };
+            Tensor flatSamples;
+            if (samples.TryReshape(LENGTHOF(flatShape), flatShape, flatSamples))
+            {
+                m_InputValues = flatSamples.Transpose(0, 1);
+                return;
+            }
+
+            m_InputValues = Tensor();
+
+            // Resize the m_Values matrix so that it holds one column per sample
+            m_Values.Resize(numSamples, numNeurons);
+
+            // Copy every sample into its column of m_Values in a single pass, by writing through a view of
+            // m_Values that has been shaped like the samples, i.e. (numSamples x sampleShape).
+            DimensionLength valuesShape[c_MaxTensorDimensions];
+            u32 order[c_MaxTensorDimensions];
+            for (u32 dIdx = 1; dIdx < numDimensions; ++dIdx)
+            {
+                valuesShape[dIdx - 1] = samples.GetLength(dIdx);
+                order[dIdx] = dIdx - 1;
+            }
+            valuesShape[numDimensions - 1] = numSamples;
+            order[0] = numDimensions - 1;
+
+            Tensor::Copy(samples, Tensor::Borrow(m_Values).Reshape(numDimensions, valuesShape).Permute(order));
+        }
+    }
+}
@@ -1,7 +1,7 @@
 #pragma once
 
-#include "Core/NDArrayView.h"
 #include "Layers/Layer.h"
+#include "Maths/Tensor.h"
 
 namespace mia
 {
@@ -18,8 +18,35 @@ namespace mia
 
             virtual LayerType GetType() const override { return LayerType::Input; }
 
-            // Converts the supplied inputData into the local m_Values matrix for use by another layer.
-            virtual void SetInputData(NDArrayView<f32> const & inputData) = 0;
+            // Supplies the layer with a batch of input data for use by the next layer. The first dimension
+            // of inputData indexes the samples of the batch, every other dimension describes a single sample.
+            // The layer's values (see GetValuesView) hold one column per sample of inputData.
+            virtual void SetInputData(Tensor const & inputData) = 0;
+
+            virtual u32 GetBatchSize() const override;
+            virtual Tensor GetValuesView() const override;
+
+            // Returns true if the layer's values are a view of the input data last supplied to SetInputData,
+            // rather than a copy of it held in m_Values.
+            bool IsViewingInputData() const;
+
+        protected:
+            // Makes the layer's values hold the supplied (numSamples x sampleShape) tensor, one flattened sample
+            // per column. Whenever every sample can be flattened without a copy (i.e. the elements of a sample
+            // are evenly spaced, as they are in contiguous data, in slices of a larger batch or in data stored
+            // feature by feature) the samples are viewed in place & the caller must keep them alive until the
+            // layer's values have been consumed. Only genuinely non-contiguous samples are copied into m_Values.
+            void SetSamples(Tensor const & samples);
+
+        private:
+            // A (numNeurons x numSamples) view of the samples last supplied to SetSamples, if they could be
+            // viewed in place. Empty if they were copied into m_Values instead.
+            Tensor m_InputValues;
         };
+
+        inline bool InputLayer::IsViewingInputData() const
+        {
+            return 0 != m_InputValues.GetNumDimensions();
+        }
     }
 }
@@ -1,4 +1,11 @@
 #include "Layer.h"
+#include "Maths/Gemm.h"
+#include "Kernels/Kernels.h"
+#include "Core/Allocator.h"
+
+#include <algorithm>
+#include <string.h>
+#include <utility>
 
 namespace mia
 {
@@ -6,9 +13,83 @@ namespace mia
     {
         Layer::Layer(activators::ActivatorType activatorType)
             : m_ActivatorType(activatorType)
+            , m_IsTraining(false)
+            , m_InferencePrecision(kernels::MathPrecision::Accurate)
         {
         }
 
+        void Layer::Restore(Matrix && weights, Matrix && biases, Matrix && packedWeights, gemm::PackedOperand const & packedWeightsOperand)
+        {
+            ASSERTMSG((1 == biases.GetWidth()) && (biases.GetHeight() > 0), "biases must hold a single column with a value per neuron.");
+            ASSERTMSG((0 == weights.GetCapacity()) || (weights.GetHeight() == biases.GetHeight()), "weights don't match the number of neurons.");
+
+            m_Values = Matrix(1, biases.GetHeight());
+            m_Weights = std::move(weights);
+            m_Biases = std::move(biases);
+            m_PackedWeights = std::move(packedWeights);
+            m_PackedWeightsOperand = packedWeightsOperand;
+
+            // Weights packed for another micro-kernel are of no use, they have to be packed again
+            if ((nullptr == m_PackedWeightsOperand.data) || !gemm::IsPackedForCurrentKernel(m_PackedWeightsOperand))
+            {
+                ASSERTMSG(m_Weights.GetCapacity() > 0, "The packed weights don't match the micro-kernel in use & there are no weights to pack them again from.");
+                PackWeights();
+            }
+        }
+
+        void Layer::LoadTrainingState(f32 const * weights, f32 const * biases, f32 const * const * weightsOptimizerState, f32 const * const * biasesOptimizerState)
+        {
+            // Copies every element of data into matrix (if it has any)
+            auto copy = [](f32 const * data, Matrix & matrix)
+            {
+                if (matrix.GetCapacity() > 0)
+                {
+                    memcpy(matrix.GetData(), data, matrix.GetCapacity() * sizeof(f32));
+                }
+            };
+
+            copy(weights, m_Weights);
+            copy(biases, m_Biases);
+            for (u32 sIdx = 0; sIdx < optimizers::c_MaxNumStateBuffers; ++sIdx)
+            {
+                if (m_WeightsOptimizerState[sIdx].GetCapacity() > 0)
+                {
+                    copy(weightsOptimizerState[sIdx], m_WeightsOptimizerState[sIdx]);
+                    copy(biasesOptimizerState[sIdx], m_BiasesOptimizerState[sIdx]);
+                }
+            }
+
+            PackWeights();
+        }
+
+        void Layer::SwapTrainingState(Matrix * matrices)
+        {
+            u32 mIdx = 0;
+            std::swap(m_Weights, matrices[mIdx++]);
+            std::swap(m_Biases, matrices[mIdx++]);
+            for (u32 sIdx = 0; sIdx < optimizers::c_MaxNumStateBuffers; ++sIdx)
+            {
+                std::swap(m_WeightsOptimizerState[sIdx], matrices[mIdx++]);
+                std::swap(m_BiasesOptimizerState[sIdx], matrices[mIdx++]);
+            }
+        }
+
+        void Layer::Reserve(u32 maxBatchSize, bool isTraining)
+        {
+            u64 const numElements = static_cast<u64>(GetNumNeurons()) * maxBatchSize;
+            m_Values.Reserve(numElements);
+            if (!isTraining)
+            {
+                return;
+            }
+
+            m_ValuesPriorActivator.Reserve(numElements);
+            m_Gradients.Reserve(numElements);
+
+            m_WeightGradients.Resize(m_Weights.GetWidth(), m_Weights.GetHeight());
+            m_BiasGradients.Resize(m_Biases.GetWidth(), m_Biases.GetHeight());
+        }
+
         void Layer::Execute(Layer const * prevLayer)
         {
             ASSERTMSG(nullptr != prevLayer, "prevLayer is not a valid ptr.");
@@ -16,8 +97,8 @@ namespace mia
 
             // Base implemention:
             // - Multiply the pre-filled m_Weights structure by the prevLayer's
-            // already calculated m_Values structure.
-            // - Add the m_Biases matrix to the m_Values structure
+            // already calculated m_Values structure (one column per sample).
+            // - Add the m_Biases matrix to every column of the m_Values structure
             // - Apply the activation function onto each computed neuron computed value
             //
             // The first two steps essentially summates the dot product of each neuron,
@@ -25,23 +106,273 @@ namespace mia
             // then adds the neuron's particular bias value to the final value for the neuron.
             // The final step helps determine whether the neuron should "activate" or not.
 
-            m_ValuesPriorActivator = std::move(Matrix::Multiply(m_Weights, prevLayer->GetValues()));
-            m_ValuesPriorActivator = std::move(Matrix::Add(m_ValuesPriorActivator, m_Biases));
+            // All three steps run as a single pass, the bias add & activation are fused into the
+            // final write of each tile of the matrix multiplication.
+            // Prefer the packed copy of the weights, which skips packing them on every call
+            bool const usePackedWeights = (nullptr != m_PackedWeightsOperand.data) && gemm::IsPackedForCurrentKernel(m_PackedWeightsOperand);
+            ASSERTMSG(usePackedWeights || (m_Weights.GetCapacity() > 0), "m_Weights has been released & its packed copy doesn't match the micro-kernel in use.");
+
+            u32 const numNeurons = usePackedWeights ? m_PackedWeightsOperand.numRows : m_Weights.GetHeight();
 
-            activators::Activator activator = activators::GetActivator(m_ActivatorType);
-            if (nullptr != activator)
+            // The previous layer's values are read through a view, which might have any strides
+            Tensor const prevValues = prevLayer->GetValuesView();
+            ASSERTMSG((usePackedWeights ? m_PackedWeightsOperand.numCols : m_Weights.GetWidth()) == prevValues.GetLength(0), "m_Weights doesn't match the number of neurons in the previous layer.");
+            ASSERTMSG((1 == m_Biases.GetWidth()) && (numNeurons == m_Biases.GetHeight()), "m_Biases doesn't match the number of neurons in the layer.");
+
+            // Resize the m_Values structure to match the batch size (this only allocates if the batch is
+            // larger than any previously reserved for)
+            m_Values.Resize(prevValues.GetLength(1), numNeurons);
+
+            gemm::Epilogue epilogue;
+            epilogue.rowBias = m_Biases.GetData();
+            epilogue.activator = m_ActivatorType;
+            epilogue.precision = m_IsTraining ? kernels::MathPrecision::Accurate : m_InferencePrecision;
+
+            if (m_IsTraining)
             {
-                for (u32 rIdx = 0; rIdx < m_Values.GetHeight(); ++rIdx)
+                m_ValuesPriorActivator.Resize(m_Values.GetWidth(), m_Values.GetHeight());
+                epilogue.preActivation = m_ValuesPriorActivator.GetData();
+            }
+
+            gemm::Operand const prevValuesOperand = gemm::MakeOperand(prevValues);
+            gemm::Output const valuesOutput = gemm::MakeOutput(m_Values.GetData(), m_Values.GetHeight(), m_Values.GetWidth());
+
+            if (usePackedWeights)
+            {
+                gemm::Multiply(m_PackedWeightsOperand, prevValuesOperand, valuesOutput, epilogue);
+            }
+            else
+            {
+                gemm::Multiply(gemm::MakeOperand(m_Weights.GetData(), m_Weights.GetHeight(), m_Weights.GetWidth()), prevValuesOperand, valuesOutput, epilogue);
+            }
+        }
+
+        f32 Layer::ComputeLossGradient(f32 const * expectedOutput)
+        {
+            u32 const numNeurons = GetNumNeurons();
+            u32 const batchSize = GetBatchSize();
+            u64 const numElements = static_cast<u64>(numNeurons) * batchSize;
+
+            m_Gradients.Resize(batchSize, numNeurons);
+            if (0 == numElements)
+            {
+                return 0.0f;
+            }
+
+            ASSERTMSG(nullptr != expectedOutput, "expectedOutput is not a valid ptr.");
+
+            // loss = sum((values - expected)^2) / numElements
+            // dLoss/dValues = 2 * (values - expected) / numElements
+            f32 const * values = m_Values.GetData();
+            f32 * gradients = m_Gradients.GetData();
+            f32 const gradientScale = 2.0f / static_cast<f32>(numElements);
+
+            f32 loss = 0.0f;
+            for (u32 rIdx = 0; rIdx < numNeurons; ++rIdx)
+            {
+                for (u32 sIdx = 0; sIdx < batchSize; ++sIdx)
                 {
-                    f32 const & neuronValue = m_ValuesPriorActivator.GetElement(rIdx, 0);
-                    f32 & finalNeuronValue = m_Values.GetElement(rIdx, 0);
+                    // m_Values holds one sample per column whereas expectedOutput holds one sample after another
+                    u64 const eIdx = (static_cast<u64>(rIdx) * batchSize) + sIdx;
+                    f32 const error = values[eIdx] - expectedOutput[(static_cast<u64>(sIdx) * numNeurons) + rIdx];
 
-                    finalNeuronValue = activator(neuronValue);
+                    gradients[eIdx] = error * gradientScale;
+                    loss += error * error;
                 }
             }
-            else
+
+            return loss / static_cast<f32>(numElements);
+        }
+
+        void Layer::Backpropagate(Layer * prevLayer)
+        {
+            ASSERTMSG(nullptr != prevLayer, "prevLayer is not a valid ptr.");
+            ASSERTMSG(m_Weights.GetWidth() == prevLayer->GetNumNeurons(), "m_Weights doesn't match the previous layer, has it been released?");
+
+            Tensor const prevValues = prevLayer->GetValuesView();
+            u32 const numPrevNeurons = prevValues.GetLength(0);
+            u32 const numNeurons = m_Values.GetHeight();
+            u32 const batchSize = m_Values.GetWidth();
+
+            ASSERTMSG((m_Gradients.GetWidth() == batchSize) && (m_Gradients.GetHeight() == numNeurons), "m_Gradients doesn't match m_Values, was the layer's gradient computed?");
+            ASSERTMSG((m_ValuesPriorActivator.GetWidth() == batchSize) && (m_ValuesPriorActivator.GetHeight() == numNeurons), "m_ValuesPriorActivator doesn't match m_Values, was the layer executed while training?");
+            ASSERTMSG(prevValues.GetLength(1) == batchSize, "prevLayer's values don't match the layer's batch size.");
+
+            // dLoss/dValuesPriorActivator = dLoss/dValues * activator'(m_ValuesPriorActivator)
+            activators::MultiplyByDerivative(m_ActivatorType, m_ValuesPriorActivator.GetData(), m_Values.GetData(), m_Gradients.GetData(), static_cast<u64>(numNeurons) * batchSize);
+
+            gemm::Operand const gradients = gemm::MakeOperand(m_Gradients.GetData(), numNeurons, batchSize);
+
+            // dLoss/dWeights = dLoss/dValuesPriorActivator * prevValues^T, the multiplication sums the
+            // contribution of every sample. The transpose is read in place through the view's strides.
+            m_WeightGradients.Resize(numPrevNeurons, numNeurons);
+            gemm::Multiply(gradients, gemm::MakeOperand(prevValues.Transpose(0, 1)), gemm::MakeOutput(m_WeightGradients.GetData(), numNeurons, numPrevNeurons));
+
+            // dLoss/dBiases = sum of dLoss/dValuesPriorActivator over every sample
+            m_BiasGradients.Resize(1, numNeurons);
+            for (u32 rIdx = 0; rIdx < numNeurons; ++rIdx)
+            {
+                m_BiasGradients.GetData()[rIdx] = kernels::Sum(m_Gradients.GetData() + (static_cast<u64>(rIdx) * batchSize), batchSize);
+            }
+
+            // dLoss/dPrevValues = m_Weights^T * dLoss/dValuesPriorActivator. Input layers have nothing to train
+            // so there's no need to compute their gradient.
+            if (LayerType::Input != prevLayer->GetType())
+            {
+                gemm::Operand weightsTransposed;
+                weightsTransposed.data = m_Weights.GetData();
+                weightsTransposed.numRows = m_Weights.GetWidth();
+                weightsTransposed.numCols = m_Weights.GetHeight();
+                weightsTransposed.rowStride = 1;
+                weightsTransposed.colStride = m_Weights.GetWidth();
+
+                prevLayer->m_Gradients.Resize(batchSize, numPrevNeurons);
+                gemm::Multiply(weightsTransposed, gradients, gemm::MakeOutput(prevLayer->m_Gradients.GetData(), numPrevNeurons, batchSize));
+            }
+        }
+
+        void Layer::ResetOptimizerState(optimizers::OptimizerType type)
+        {
+            u32 const numStateBuffers = optimizers::GetNumStateBuffers(type);
+            ASSERTMSG(numStateBuffers <= optimizers::c_MaxNumStateBuffers, "Optimizer keeps more state than a layer can store.");
+
+            // The state lives for as long as the parameters so comes from the same pool
+            for (u32 sIdx = 0; sIdx < optimizers::c_MaxNumStateBuffers; ++sIdx)
+            {
+                if (sIdx < numStateBuffers)
+                {
+                    m_WeightsOptimizerState[sIdx] = Matrix(m_Weights.GetWidth(), m_Weights.GetHeight(), PoolAllocator::GetParameterPool());
+                    m_BiasesOptimizerState[sIdx] = Matrix(m_Biases.GetWidth(), m_Biases.GetHeight(), PoolAllocator::GetParameterPool());
+                }
+                else
+                {
+                    m_WeightsOptimizerState[sIdx] = Matrix();
+                    m_BiasesOptimizerState[sIdx] = Matrix();
+                }
+            }
+        }
+
+        void Layer::ApplyGradients(optimizers::Optimizer const & optimizer, u64 stepIndex)
+        {
+            ASSERTMSG(m_WeightGradients.GetCapacity() == m_Weights.GetCapacity(), "m_WeightGradients doesn't match m_Weights.");
+            ASSERTMSG(m_BiasGradients.GetCapacity() == m_Biases.GetCapacity(), "m_BiasGradients doesn't match m_Biases.");
+
+            f32 * weightsState[optimizers::c_MaxNumStateBuffers];
+            f32 * biasesState[optimizers::c_MaxNumStateBuffers];
+
+            u32 const numStateBuffers = optimizers::GetNumStateBuffers(optimizer.type);
+            for (u32 sIdx = 0; sIdx < numStateBuffers; ++sIdx)
+            {
+                ASSERTMSG(m_WeightsOptimizerState[sIdx].GetCapacity() == m_Weights.GetCapacity(), "Optimizer state hasn't been reset for this type of optimizer.");
+                ASSERTMSG(m_BiasesOptimizerState[sIdx].GetCapacity() == m_Biases.GetCapacity(), "Optimizer state hasn't been reset for this type of optimizer.");
+
+                weightsState[sIdx] = m_WeightsOptimizerState[sIdx].GetData();
+                biasesState[sIdx] = m_BiasesOptimizerState[sIdx].GetData();
+            }
+
+            optimizers::Update(optimizer, stepIndex, m_Weights.GetData(), m_WeightGradients.GetData(), weightsState, m_Weights.GetCapacity());
+            optimizers::Update(optimizer, stepIndex, m_Biases.GetData(), m_BiasGradients.GetData(), biasesState, m_Biases.GetCapacity());
+
+            PackWeights();
+        }
+
+        LayerCost Layer::GetExecuteCost() const
+        {
+            LayerCost cost;
+            if (LayerType::Input == GetType())
+            {
+                return cost;
+            }
+
+            f64 const numNeurons = GetNumNeurons();
+            f64 const numInputs = (m_Weights.GetCapacity() > 0) ? m_Weights.GetWidth() : m_PackedWeightsOperand.numCols;
+            f64 const batchSize = GetBatchSize();
+
+            // The multiplication, then the bias & activator applied to each value (& the values prior to the
+            // activator stored while training)
+            cost.numFlops = (2.0 * numNeurons * numInputs * batchSize) + (2.0 * numNeurons * batchSize);
+            cost.numBytes = sizeof(f32) * ((numNeurons * numInputs) + (numInputs * batchSize) + numNeurons + ((m_IsTraining ? 2.0 : 1.0) * numNeurons * batchSize));
+            return cost;
+        }
+
+        LayerCost Layer::GetBackpropagateCost(Layer const * prevLayer) const
+        {
+            ASSERTMSG(nullptr != prevLayer, "prevLayer is not a valid ptr.");
+
+            LayerCost cost;
+            if (LayerType::Input == GetType())
+            {
+                return cost;
+            }
+
+            f64 const numNeurons = GetNumNeurons();
+            f64 const numInputs = m_Weights.GetWidth();
+            f64 const batchSize = GetBatchSize();
+            f64 const numValues = numNeurons * batchSize;
+
+            // The activator's derivative (reading the values, the values prior to the activator & the gradients,
+            // then writing the gradients), the weight gradients & the bias gradients
+            cost.numFlops = (2.0 * numValues) + (2.0 * numNeurons * numInputs * batchSize) + numValues;
+            cost.numBytes = sizeof(f32) * ((4.0 * numValues) + (numValues + (numInputs * batchSize) + (numNeurons * numInputs)) + (numValues + numNeurons));
+
+            // The gradients of the previous layer's values
+            if (LayerType::Input != prevLayer->GetType())
+            {
+                cost.numFlops += 2.0 * numNeurons * numInputs * batchSize;
+                cost.numBytes += sizeof(f32) * ((numNeurons * numInputs) + numValues + (numInputs * batchSize));
+            }
+
+            return cost;
+        }
+
+        LayerCost Layer::GetApplyGradientsCost(optimizers::OptimizerType type) const
+        {
+            LayerCost cost;
+            if (LayerType::Input == GetType())
+            {
+                return cost;
+            }
+
+            // Every parameter & its state is read & written once, its gradient is only read. Repacking the
+            // weights reads & writes them once more.
+            f64 const numParameters = static_cast<f64>(m_Weights.GetCapacity() + m_Biases.GetCapacity());
+            f64 const numStateBuffers = optimizers::GetNumStateBuffers(type);
+            cost.numFlops = numParameters * optimizers::GetNumFlopsPerParameter(type);
+            cost.numBytes = sizeof(f32) * ((numParameters * (3.0 + (2.0 * numStateBuffers))) + (2.0 * m_Weights.GetCapacity()));
+            return cost;
+        }
+
+        void Layer::PackWeights()
+        {
+            if (0 == m_Weights.GetCapacity())
+            {
+                m_PackedWeights = Matrix();
+                m_PackedWeightsOperand = gemm::PackedOperand();
+                return;
+            }
+
+            // Only reallocates if the packed size has changed, i.e. a micro-kernel with another layout is in use
+            u64 const packedSize = gemm::GetPackedSize(m_Weights.GetHeight(), m_Weights.GetWidth());
+            if (m_PackedWeights.GetCapacity() != packedSize)
+            {
+                m_PackedWeights = Matrix(1, static_cast<u32>(packedSize), PoolAllocator::GetParameterPool());
+            }
+
+            m_PackedWeightsOperand = gemm::Pack(gemm::MakeOperand(m_Weights.GetData(), m_Weights.GetHeight(), m_Weights.GetWidth()), m_PackedWeights.GetData());
+        }
+
+        void Layer::ReleaseUnpackedWeights()
+        {
+            ASSERTMSG((0 == m_Weights.GetCapacity()) || (nullptr != m_PackedWeightsOperand.data), "The weights haven't been packed.");
+
+            // The gradients & optimizer state are only needed for training, which is no longer possible
+            m_Weights = Matrix();
+            m_WeightGradients = Matrix();
+            m_BiasGradients = Matrix();
+            for (u32 sIdx = 0; sIdx < optimizers::c_MaxNumStateBuffers; ++sIdx)
             {
-                m_Values = m_ValuesPriorActivator;
+                m_WeightsOptimizerState[sIdx] = Matrix();
+                m_BiasesOptimizerState[sIdx] = Matrix();
             }
         }
     }
@@ -1,7 +1,10 @@
 #pragma once
 
 #include "Maths/Matrix.h"
+#include "Maths/Tensor.h"
+#include "Maths/Gemm.h"
 #include "Activators/Activators.h"
+#include "Optimizers/Optimizer.h"
 
 namespace mia
 {
@@ -18,9 +21,30 @@ namespace mia
             Input
         };
 
+        // Identifies the concrete class of a layer, e.g. to save it (see Models/ModelFormat.h). These values
+        // are stored in saved models so must never change.
+        enum class LayerClass : u8
+        {
+            Unknown = 0,
+            Flatten = 1,
+            Dense = 2
+        };
+
+        // The work done by a single pass of a layer over a batch: the floating point operations it performs &
+        // the bytes of memory it reads & writes. Only the arithmetic that dominates the pass is counted, i.e.
+        // the matrix multiplications & the element-wise passes over the values, gradients & parameters.
+        struct LayerCost
+        {
+            f64 numFlops = 0.0;
+            f64 numBytes = 0.0;
+        };
+
         class Layer
         {
         public:
+            // The number of matrices of a layer's training state (see SwapTrainingState).
+            static u32 constexpr c_NumTrainingStateMatrices = 2 + (2 * optimizers::c_MaxNumStateBuffers);
+
             Layer() = delete;
             Layer(Layer const & other) = delete;
             Layer(Layer && other) = delete;
@@ -29,27 +53,126 @@ namespace mia
             // Constructs a layer.
             Layer(activators::ActivatorType activatorType);
 
-            // Sets up the layer.
+            // Sets up the layer. Any random initialisation of its parameters is drawn from seedValue (see
+            // Maths/Random.h).
             virtual void Compile(u32 seedValue, Layer const * prevLayer) = 0;
 
+            // Sets up the layer with the supplied parameters instead of compiling it, e.g. with those of a saved
+            // model. Any of the matrices may be views (see Matrix::View), which the layer then reads & trains in
+            // place. packedWeights holds weights packed by gemm::Pack as described by packedWeightsOperand, it is
+            // only used if it was packed for the micro-kernel in use, otherwise weights are packed again.
+            void Restore(Matrix && weights, Matrix && biases, Matrix && packedWeights, gemm::PackedOperand const & packedWeightsOperand);
+
+            // Preallocates the layer's buffers for batches of up to maxBatchSize samples so that executing
+            // the layer doesn't need to allocate. The buffers only needed for training (which are as large
+            // as the weights) are skipped if isTraining is false. Must be called after Compile.
+            void Reserve(u32 maxBatchSize, bool isTraining = true);
+
             // Executes the current layers operation on the supplied previous layer and stores
-            // the computed values within the m_Values matrix.
+            // the computed values within the m_Values matrix. Every sample (column) of the previous
+            // layer's values is processed at once.
             virtual void Execute(Layer const * prevLayer);
 
+            // Computes the mean squared error between the layer's values & expectedOutput and stores the
+            // gradient of that error with respect to the layer's values for Backpropagate. expectedOutput
+            // holds the expected values of each sample of the batch one after another. Returns the error.
+            f32 ComputeLossGradient(f32 const * expectedOutput);
+
+            // Propagates the gradient of the loss, with respect to this layer's values, backwards through the
+            // layer. This computes the gradients of the layer's weights & biases (summed over the batch) and,
+            // unless prevLayer is an input layer, the gradient of the loss with respect to prevLayer's values.
+            // Must follow an Execute made while training.
+            virtual void Backpropagate(Layer * prevLayer);
+
+            // Allocates & zeroes the state the supplied type of optimizer keeps alongside the layer's weights &
+            // biases (e.g. Adam's moments). Must be called after Compile.
+            void ResetOptimizerState(optimizers::OptimizerType type);
+
+            // Updates the layer's weights & biases with the supplied optimizer using the gradients computed by
+            // the last call to Backpropagate. stepIndex is the number of updates made since the optimizer's
+            // state was reset, including this one (starting from 1).
+            virtual void ApplyGradients(optimizers::Optimizer const & optimizer, u64 stepIndex);
+
+            // Returns the work done by the last call of Execute, of Backpropagate (with the same prevLayer) & of
+            // ApplyGradients (with an optimizer of the supplied type) respectively, e.g. to profile the layer (see
+            // models::Profiler). Input layers do no work.
+            LayerCost GetExecuteCost() const;
+            LayerCost GetBackpropagateCost(Layer const * prevLayer) const;
+            LayerCost GetApplyGradientsCost(optimizers::OptimizerType type) const;
+
+            // Copies the supplied weights, biases & optimizer state (one buffer per state buffer of the optimizer
+            // the state was last reset for) into the layer, e.g. to resume training from a checkpoint. Each must
+            // hold as many elements as the matrix it is copied into.
+            void LoadTrainingState(f32 const * weights, f32 const * biases, f32 const * const * weightsOptimizerState, f32 const * const * biasesOptimizerState);
+
+            // Swaps the layer's weights, biases & optimizer state with the supplied c_NumTrainingStateMatrices
+            // matrices, in the order weights, biases, then the weights' & the biases' buffer of each optimizer
+            // state buffer. E.g. to carry the layer on with copies of them while the originals are being read
+            // elsewhere (see models::Checkpointer). The weights must be packed again if they change.
+            void SwapTrainingState(Matrix * matrices);
+
+            // Packs m_Weights into the layout the matrix multiplication's micro-kernel consumes (see
+            // gemm::Pack) so that Execute doesn't have to on every call. Must be called whenever m_Weights
+            // changes, which Compile & ApplyGradients take care of.
+            void PackWeights();
+
+            // Releases the row-major m_Weights, keeping only the packed copy Execute consumes. This halves
+            // the memory taken up by the weights of an inference-only model. The layer can no longer be
+            // trained (or have its weights read through GetWeights) afterwards, so the weight gradients &
+            // optimizer state are released too.
+            void ReleaseUnpackedWeights();
+
+            // Sets whether the layer is being executed as part of training. The values prior to the activator
+            // being applied are only stored while training as they're only needed for backpropagation.
+            void SetIsTraining(bool isTraining);
+            // Sets the precision of the activator when the layer isn't being executed as part of training
+            // (see kernels::MathPrecision). Training always uses MathPrecision::Accurate.
+            void SetInferencePrecision(kernels::MathPrecision precision);
+
             // Returns the type of this layer.
             virtual LayerType GetType() const { return LayerType::Generic; }
+            // Returns the concrete class of this layer.
+            virtual LayerClass GetClass() const { return LayerClass::Unknown; }
+            // Returns the activator applied to the layer's values.
+            activators::ActivatorType GetActivatorType() const;
+
+            // Returns the number of weights & biases of the layer.
+            u64 GetNumParameters() const;
 
             // Returns the number of neurons in the layer.
             // This is computed at construction time of the layer.
             u32 GetNumNeurons() const;
+            // Returns the number of samples the layer's values were last computed for.
+            virtual u32 GetBatchSize() const;
 
             // Returns the matrix representing the connections between this layer and the previous
-            // layer. These connections are denoted by a weight value.
+            // layer. These connections are denoted by a weight value. Empty once ReleaseUnpackedWeights
+            // has been called.
             Matrix const & GetWeights() const;
+            // Returns the description of the packed copy of m_Weights that Execute multiplies by (see PackWeights).
+            // Its data is nullptr if the layer has no weights.
+            gemm::PackedOperand const & GetPackedWeights() const;
             // Returns the 1D matrix representing the bias value for each neuron in this layer.
             Matrix const & GetBiases() const;
-            // Returns the 1D matrix representing the computed neuron values for this layer.
+            // Returns the matrix representing the computed neuron values for this layer. Each column
+            // holds the neuron values of a single sample. Input layers that view their input data in place
+            // leave this matrix untouched, see GetValuesView.
             Matrix const & GetValues() const;
+            // Returns a (numNeurons x batchSize) view of the layer's values, which is what the next layer
+            // reads them through. By default this views m_Values, input layers may instead view the input
+            // data they were given without copying it.
+            virtual Tensor GetValuesView() const;
+            // Returns the gradients of the loss with respect to m_Weights & m_Biases computed by the last
+            // call to Backpropagate. They may be replaced before ApplyGradients, e.g. by gradients combined across
+            // replicas of the layer (see Layers/Gradients.h).
+            Matrix const & GetWeightGradients() const;
+            Matrix const & GetBiasGradients() const;
+            Matrix & GetWeightGradients();
+            Matrix & GetBiasGradients();
+            // Returns the optimizer's state buffers of m_Weights & m_Biases (see ResetOptimizerState), empty for
+            // any buffer the optimizer doesn't keep.
+            Matrix const & GetWeightsOptimizerState(u32 stateIndex) const;
+            Matrix const & GetBiasesOptimizerState(u32 stateIndex) const;
 
         protected:
             friend class tests::LayerManipulator;
@@ -76,6 +199,13 @@ namespace mia
             // as all three neurons in the previous layer are connected to the second neuron in this layer.
             Matrix m_Weights;
 
+            // A copy of m_Weights packed into the panel layout of the matrix multiplication's micro-kernel,
+            // along with its description (see gemm::PackedOperand). Execute multiplies by this copy when it
+            // is up to date. The packed data is stored as a 1D matrix so it comes from the same allocator as
+            // the rest of the parameters.
+            Matrix m_PackedWeights;
+            gemm::PackedOperand m_PackedWeightsOperand;
+
             // A matrix storing the bias value for each neuron in this particular layer.
             // This matrix is always expected to be one-dimensional in the height axis... i.e. Matrix(width: 1, height: n).
             // This allows for easily adding each neuron's bias value the computed value for the neuron...
@@ -83,27 +213,65 @@ namespace mia
             Matrix m_Biases;
 
             // A matrix storing the previous layer's neuron values multiplied by m_Weights structure (+bias & activation).
-            // This matrix is always expected to be one-dimensional in the height axis... i.e. Matrix(width: 1, height: n).
-            // This allows for applying the summation, for a particular neuron, of the dot product of a previous neuron
-            // and its weight easily... i.e. Matrix::Multiply(m_Weights, prevLayer.m_Values) 
+            // Each column of this matrix holds the neuron values of one sample of the batch being processed...
+            // i.e. Matrix(width: batchSize, height: n). This allows for applying the summation, for a particular neuron,
+            // of the dot product of a previous neuron and its weight for every sample with a single matrix multiplication...
+            // i.e. Matrix::Multiply(m_Weights, prevLayer.m_Values)
             Matrix m_Values;
 
         private:
             // A matrix storing the previous layer's neuron values multiplied by m_Weights structure (+bias). This stores
             // the same values as m_Values does but minus the activation function running on each neuron.
             // We cache the neuron values prior to the activator being applied so that this value can be used within backpropagation
+            // (it is therefore only written to while training).
             Matrix m_ValuesPriorActivator;
 
+            // A matrix, with the same dimensions as m_Values, storing the gradient of the loss with respect to
+            // each of the layer's neuron values. It is written by the next layer's Backpropagate (or by
+            // ComputeLossGradient for the output layer) and then converted, in place, into the gradient with
+            // respect to m_ValuesPriorActivator by this layer's Backpropagate.
+            Matrix m_Gradients;
+
+            // Matrices, with the same dimensions as m_Weights & m_Biases, storing the gradient of the loss with
+            // respect to each weight & bias.
+            Matrix m_WeightGradients;
+            Matrix m_BiasGradients;
+
+            // Matrices, with the same dimensions as m_Weights & m_Biases, storing the optimizer's per parameter
+            // state (see optimizers::GetNumStateBuffers). Only the first GetNumStateBuffers of each are used.
+            Matrix m_WeightsOptimizerState[optimizers::c_MaxNumStateBuffers];
+            Matrix m_BiasesOptimizerState[optimizers::c_MaxNumStateBuffers];
+
             // An enum specifying which support activation function should be applied to every neuron's computed value
             // during the execution of the layer.
             activators::ActivatorType m_ActivatorType;
+
+            // Whether the layer is currently being executed as part of training.
+            bool m_IsTraining;
+            // See SetInferencePrecision.
+            kernels::MathPrecision m_InferencePrecision;
         };
 
+        inline void Layer::SetIsTraining(bool isTraining)
+        {
+            m_IsTraining = isTraining;
+        }
+
+        inline void Layer::SetInferencePrecision(kernels::MathPrecision precision)
+        {
+            m_InferencePrecision = precision;
+        }
+
         inline Matrix const & Layer::GetWeights() const
         {
             return m_Weights;
         }
 
+        inline gemm::PackedOperand const & Layer::GetPackedWeights() const
+        {
+            return m_PackedWeightsOperand;
+        }
+
         inline Matrix const & Layer::GetBiases() const
         {
             return m_Biases;
@@ -114,9 +282,62 @@ namespace mia
             return m_Values;
         }
 
+        inline Tensor Layer::GetValuesView() const
+        {
+            // The view is only ever read from
+            return Tensor::Borrow(const_cast<Matrix &>(m_Values));
+        }
+
+        inline Matrix const & Layer::GetWeightGradients() const
+        {
+            return m_WeightGradients;
+        }
+
+        inline Matrix const & Layer::GetBiasGradients() const
+        {
+            return m_BiasGradients;
+        }
+
+        inline Matrix & Layer::GetWeightGradients()
+        {
+            return m_WeightGradients;
+        }
+
+        inline Matrix & Layer::GetBiasGradients()
+        {
+            return m_BiasGradients;
+        }
+
+        inline Matrix const & Layer::GetWeightsOptimizerState(u32 stateIndex) const
+        {
+            ASSERTMSG(stateIndex < optimizers::c_MaxNumStateBuffers, "stateIndex is out of bounds.");
+            return m_WeightsOptimizerState[stateIndex];
+        }
+
+        inline Matrix const & Layer::GetBiasesOptimizerState(u32 stateIndex) const
+        {
+            ASSERTMSG(stateIndex < optimizers::c_MaxNumStateBuffers, "stateIndex is out of bounds.");
+            return m_BiasesOptimizerState[stateIndex];
+        }
+
+        inline activators::ActivatorType Layer::GetActivatorType() const
+        {
+            return m_ActivatorType;
+        }
+
+        inline u64 Layer::GetNumParameters() const
+        {
+            return m_Weights.GetCapacity() + m_Biases.GetCapacity();
+        }
+
         inline u32 Layer::GetNumNeurons() const
         {
-            return static_cast<u32>(m_Values.GetCapacity());
+            return m_Values.GetHeight();
+        }
+
+        inline u32 Layer::GetBatchSize() const
+        {
+            return m_Values.GetWidth();
         }
     }
 }
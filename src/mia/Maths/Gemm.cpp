@@ -0,0 +1,707 @@
+#include "Gemm.h"
+
+#include "Core/ThreadPool.h"
+#include "Kernels/KernelTable.h"
+
+#include <algorithm>
+#include <string.h>
+
+namespace mia
+{
+    namespace gemm
+    {
+        namespace
+        {
+            // Problems with fewer multiply-adds than this are computed directly without packing.
+            u64 constexpr c_SmallProblemThreshold = 32 * 32 * 32;
+
+            // Problems with fewer multiply-adds than this run on the calling thread only, as the cost
+            // of waking the thread pool would outweigh the gain.
+            u64 constexpr c_ParallelThreshold = 96 * 96 * 96;
+
+            // Minimum number of multiply-adds given to each thread of a parallel matrix-vector product.
+            u64 constexpr c_MinMultiplyAddsPerThread = 64 * 1024;
+
+            // Alignment (in bytes) of the packed panels.
+            u64 constexpr c_PackAlignment = 64;
+
+            // A grow-only scratch buffer used to hold packed panels. One buffer of each kind exists per
+            // thread so that steady-state multiplications don't touch the heap.
+            class PackBuffer
+            {
+            public:
+                PackBuffer()
+                    : m_Allocation(nullptr)
+                    , m_Data(nullptr)
+                    , m_Capacity(0)
+                {
+                }
+
+                ~PackBuffer()
+                {
+                    if (nullptr != m_Allocation)
+                    {
+                        delete[] m_Allocation;
+                    }
+                }
+
+                // Returns a c_PackAlignment aligned buffer of at least capacity elements.
+                f32 * Reserve(u64 capacity)
+                {
+                    if (capacity > m_Capacity)
+                    {
+                        if (nullptr != m_Allocation)
+                        {
+                            delete[] m_Allocation;
+                        }
+
+                        u64 const padding = c_PackAlignment / sizeof(f32);
+                        m_Allocation = new f32[capacity + padding];
+                        m_Capacity = capacity;
+
+                        size_t const address = reinterpret_cast<size_t>(m_Allocation);
+                        size_t const alignedAddress = (address + c_PackAlignment - 1) & ~static_cast<size_t>(c_PackAlignment - 1);
+                        m_Data = reinterpret_cast<f32 *>(alignedAddress);
+                    }
+
+                    return m_Data;
+                }
+
+            private:
+                f32 * m_Allocation;
+                f32 * m_Data;
+                u64 m_Capacity;
+            };
+
+            thread_local PackBuffer t_PackedA;
+            thread_local PackBuffer t_PackedB;
+
+            inline f32 GetElement(Operand const & operand, u64 rowIndex, u64 colIndex)
+            {
+                return operand.data[(rowIndex * operand.rowStride) + (colIndex * operand.colStride)];
+            }
+
+            inline u32 DivideRoundUp(u32 value, u32 divisor)
+            {
+                return (value + divisor - 1) / divisor;
+            }
+
+            // Returns a view of rows [rowBegin, rowEnd) & columns [colBegin, colEnd) of the operand.
+            Operand Slice(Operand const & operand, u32 rowBegin, u32 rowEnd, u32 colBegin, u32 colEnd)
+            {
+                Operand slice = operand;
+                slice.data = operand.data + (rowBegin * operand.rowStride) + (colBegin * operand.colStride);
+                slice.numRows = rowEnd - rowBegin;
+                slice.numCols = colEnd - colBegin;
+                return slice;
+            }
+
+            // Returns a view of rows [rowBegin, rowEnd) & columns [colBegin, colEnd) of the output.
+            Output Slice(Output const & output, u32 rowBegin, u32 rowEnd, u32 colBegin, u32 colEnd)
+            {
+                Output slice = output;
+                slice.data = output.data + (rowBegin * output.rowStride) + colBegin;
+                slice.numRows = rowEnd - rowBegin;
+                slice.numCols = colEnd - colBegin;
+                return slice;
+            }
+
+            // Packs the numRows x numCols block of a starting at (rowOffset, colOffset) into panels of
+            // mr rows. Within a panel, the mr elements of each column are stored contiguously so the
+            // micro-kernel can stream through them. Rows beyond the edge of a are zero padded.
+            void PackA(Operand const & a, u32 rowOffset, u32 colOffset, u32 numRows, u32 numCols, u32 mr, f32 * packed)
+            {
+                for (u32 pIdx = 0; pIdx < numRows; pIdx += mr)
+                {
+                    u32 const panelRows = std::min(mr, numRows - pIdx);
+                    f32 const * src = a.data + ((rowOffset + pIdx) * a.rowStride) + (colOffset * a.colStride);
+
+                    for (u32 cIdx = 0; cIdx < numCols; ++cIdx)
+                    {
+                        u32 rIdx = 0;
+                        for (; rIdx < panelRows; ++rIdx)
+                        {
+                            packed[rIdx] = src[rIdx * a.rowStride];
+                        }
+                        for (; rIdx < mr; ++rIdx)
+                        {
+                            packed[rIdx] = 0.0f;
+                        }
+
+                        src += a.colStride;
+                        packed += mr;
+                    }
+                }
+            }
+
+            // Packs the numRows x numCols block of b starting at (rowOffset, colOffset) into panels of
+            // nr columns. Within a panel, the nr elements of each row are stored contiguously.
+            // Columns beyond the edge of b are zero padded.
+            void PackB(Operand const & b, u32 rowOffset, u32 colOffset, u32 numRows, u32 numCols, u32 nr, f32 * packed)
+            {
+                for (u32 pIdx = 0; pIdx < numCols; pIdx += nr)
+                {
+                    u32 const panelCols = std::min(nr, numCols - pIdx);
+                    f32 const * src = b.data + (rowOffset * b.rowStride) + ((colOffset + pIdx) * b.colStride);
+
+                    for (u32 rIdx = 0; rIdx < numRows; ++rIdx)
+                    {
+                        if ((1 == b.colStride) && (nr == panelCols))
+                        {
+                            memcpy(packed, src, nr * sizeof(f32));
+                        }
+                        else
+                        {
+                            u32 cIdx = 0;
+                            for (; cIdx < panelCols; ++cIdx)
+                            {
+                                packed[cIdx] = src[cIdx * b.colStride];
+                            }
+                            for (; cIdx < nr; ++cIdx)
+                            {
+                                packed[cIdx] = 0.0f;
+                            }
+                        }
+
+                        src += b.rowStride;
+                        packed += nr;
+                    }
+                }
+            }
+
+            // Returns the epilogue for the block of c starting at [rowBegin, colBegin].
+            Epilogue Slice(Epilogue const & epilogue, u64 rowStride, u32 rowBegin, u32 colBegin)
+            {
+                Epilogue slice = epilogue;
+                slice.rowBias = (nullptr != epilogue.rowBias) ? (epilogue.rowBias + rowBegin) : nullptr;
+                slice.preActivation = (nullptr != epilogue.preActivation) ? (epilogue.preActivation + (rowBegin * rowStride) + colBegin) : nullptr;
+                return slice;
+            }
+
+            inline bool HasWork(Epilogue const & epilogue)
+            {
+                return (nullptr != epilogue.rowBias) || (nullptr != epilogue.preActivation) || (activators::ActivatorType::None != epilogue.activator);
+            }
+
+            // Applies the epilogue to the supplied row of c.
+            void ApplyEpilogue(Epilogue const & epilogue, u64 rowStride, u32 rowIndex, f32 * row, u32 numCols)
+            {
+                if (nullptr != epilogue.rowBias)
+                {
+                    f32 const bias = epilogue.rowBias[rowIndex];
+                    for (u32 cIdx = 0; cIdx < numCols; ++cIdx)
+                    {
+                        row[cIdx] += bias;
+                    }
+                }
+
+                if (nullptr != epilogue.preActivation)
+                {
+                    memcpy(epilogue.preActivation + (rowIndex * rowStride), row, numCols * sizeof(f32));
+                }
+
+                activators::Activate(epilogue.activator, row, row, numCols, epilogue.precision);
+            }
+
+            // Computes c = a * b without any packing. Used for problems that are too small to amortise
+            // the cost of packing.
+            void MultiplySmall(Operand const & a, Operand const & b, Output const & c, Epilogue const & epilogue)
+            {
+                bool const hasEpilogue = HasWork(epilogue);
+
+                for (u32 rIdx = 0; rIdx < c.numRows; ++rIdx)
+                {
+                    f32 * dst = c.data + (rIdx * c.rowStride);
+
+                    if (1 == c.numCols)
+                    {
+                        // Matrix-vector product, accumulate the dot product of the row in a register
+                        f32 sum = 0.0f;
+                        for (u32 pIdx = 0; pIdx < a.numCols; ++pIdx)
+                        {
+                            sum += GetElement(a, rIdx, pIdx) * GetElement(b, pIdx, 0);
+                        }
+                        dst[0] = sum;
+
+                        if (hasEpilogue)
+                        {
+                            ApplyEpilogue(epilogue, c.rowStride, rIdx, dst, c.numCols);
+                        }
+                        continue;
+                    }
+
+                    for (u32 cIdx = 0; cIdx < c.numCols; ++cIdx)
+                    {
+                        dst[cIdx] = 0.0f;
+                    }
+
+                    // Accumulate whole rows of b into the row of c so the inner loop is contiguous
+                    // for row-major b.
+                    for (u32 pIdx = 0; pIdx < a.numCols; ++pIdx)
+                    {
+                        f32 const aVal = GetElement(a, rIdx, pIdx);
+                        f32 const * src = b.data + (pIdx * b.rowStride);
+
+                        if (1 == b.colStride)
+                        {
+                            for (u32 cIdx = 0; cIdx < c.numCols; ++cIdx)
+                            {
+                                dst[cIdx] += aVal * src[cIdx];
+                            }
+                        }
+                        else
+                        {
+                            for (u32 cIdx = 0; cIdx < c.numCols; ++cIdx)
+                            {
+                                dst[cIdx] += aVal * src[cIdx * b.colStride];
+                            }
+                        }
+                    }
+
+                    if (hasEpilogue)
+                    {
+                        ApplyEpilogue(epilogue, c.rowStride, rIdx, dst, c.numCols);
+                    }
+                }
+            }
+
+            // Returns the number of rows of a packed operand, including the zero padding of its last panel.
+            inline u32 GetPaddedRows(u32 numRows, u32 mr)
+            {
+                return DivideRoundUp(numRows, mr) * mr;
+            }
+
+            // Computes c = a * b through the packed, cache-blocked engine using the micro-kernel (and
+            // blocking parameters) of the most capable instruction set available. Bias, pre-activation
+            // stores & ReLU are applied by the micro-kernel on the final kc block of each tile, any other
+            // activator is applied to the tile straight after it has been written.
+            //
+            // If packedA is not nullptr, the panels of a are read from it (starting at row packedRowOffset,
+            // a multiple of mr) instead of being packed, and a only supplies the dimensions.
+            void MultiplyBlocked(Operand const & a, Operand const & b, Output const & c, Epilogue const & epilogue, PackedOperand const * packedA = nullptr, u32 packedRowOffset = 0)
+            {
+                kernels::GemmKernelInfo const & info = kernels::GetKernelTable().gemm;
+
+                u32 const m = c.numRows;
+                u32 const n = c.numCols;
+                u32 const k = a.numCols;
+
+                f32 * packedBlockA = (nullptr == packedA) ? t_PackedA.Reserve(static_cast<u64>(info.mc) * info.kc) : nullptr;
+                f32 * packedB = t_PackedB.Reserve(static_cast<u64>(info.nc) * info.kc);
+                u64 const paddedRowsA = (nullptr != packedA) ? GetPaddedRows(packedA->numRows, info.mr) : 0;
+
+                bool const hasEpilogue = HasWork(epilogue);
+                bool const activateTiles = (activators::ActivatorType::None != epilogue.activator) && (activators::ActivatorType::ReLU != epilogue.activator);
+
+                for (u32 jc = 0; jc < n; jc += info.nc)
+                {
+                    u32 const nc = std::min(info.nc, n - jc);
+
+                    for (u32 pc = 0; pc < k; pc += info.kc)
+                    {
+                        u32 const kc = std::min(info.kc, k - pc);
+                        bool const accumulate = (pc != 0);
+                        bool const isFinalBlock = (pc + kc) == k;
+
+                        PackB(b, pc, jc, kc, nc, info.nr, packedB);
+
+                        for (u32 ic = 0; ic < m; ic += info.mc)
+                        {
+                            u32 const mc = std::min(info.mc, m - ic);
+
+                            // Pre-packed panels are stored one kc block after another, each holding every
+                            // row of a
+                            f32 const * blockA = packedBlockA;
+                            if (nullptr != packedA)
+                            {
+                                blockA = packedA->data + (pc * paddedRowsA) + (static_cast<u64>(packedRowOffset + ic) * kc);
+                            }
+                            else
+                            {
+                                PackA(a, ic, pc, mc, kc, info.mr, packedBlockA);
+                            }
+
+                            for (u32 jr = 0; jr < nc; jr += info.nr)
+                            {
+                                f32 const * panelB = packedB + (static_cast<u64>(jr) * kc);
+
+                                for (u32 ir = 0; ir < mc; ir += info.mr)
+                                {
+                                    f32 const * panelA = blockA + (static_cast<u64>(ir) * kc);
+                                    f32 * tileC = c.data + ((ic + ir) * c.rowStride) + (jc + jr);
+                                    u32 const tileRows = std::min(info.mr, mc - ir);
+                                    u32 const tileCols = std::min(info.nr, nc - jr);
+
+                                    if (!(isFinalBlock && hasEpilogue))
+                                    {
+                                        info.kernel(kc, panelA, panelB, tileC, c.rowStride, tileRows, tileCols, accumulate, nullptr);
+                                        continue;
+                                    }
+
+                                    Epilogue const tileEpilogue = Slice(epilogue, c.rowStride, ic + ir, jc + jr);
+
+                                    kernels::GemmEpilogue kernelEpilogue;
+                                    kernelEpilogue.rowBias = tileEpilogue.rowBias;
+                                    kernelEpilogue.preActivation = tileEpilogue.preActivation;
+                                    kernelEpilogue.relu = (activators::ActivatorType::ReLU == epilogue.activator);
+
+                                    info.kernel(kc, panelA, panelB, tileC, c.rowStride, tileRows, tileCols, accumulate, &kernelEpilogue);
+
+                                    if (activateTiles)
+                                    {
+                                        for (u32 rIdx = 0; rIdx < tileRows; ++rIdx)
+                                        {
+                                            f32 * row = tileC + (rIdx * c.rowStride);
+                                            activators::Activate(epilogue.activator, row, row, tileCols, epilogue.precision);
+                                        }
+                                    }
+                                }
+                            }
+                        }
+                    }
+                }
+            }
+
+            // Computes rows [panelBegin * mr, panelEnd * mr) of c = a * b with a pre-packed a, without packing b.
+            // Used for matrix-vector products & problems too small to amortise the cost of packing b.
+            template <u32 MR>
+            void MultiplySmallPacked(PackedOperand const & a, Operand const & b, Output const & c, Epilogue const & epilogue, u32 panelBegin, u32 panelEnd)
+            {
+                bool const hasEpilogue = HasWork(epilogue);
+                u64 const paddedRows = GetPaddedRows(a.numRows, MR);
+
+                for (u32 pIdx = panelBegin; pIdx < panelEnd; ++pIdx)
+                {
+                    u32 const rowBegin = pIdx * MR;
+                    u32 const numRows = std::min(MR, a.numRows - rowBegin);
+                    f32 * dst = c.data + (static_cast<u64>(rowBegin) * c.rowStride);
+
+                    if (1 == c.numCols)
+                    {
+                        // Matrix-vector product, accumulate the mr dot products of the panel side by side
+                        // while streaming through its packed columns once.
+                        f32 sums[MR] = {};
+
+                        for (u32 pc = 0; pc < a.numCols; pc += a.kc)
+                        {
+                            u32 const kc = std::min(a.kc, a.numCols - pc);
+                            f32 const * panel = a.data + (pc * paddedRows) + (static_cast<u64>(pIdx) * MR * kc);
+                            f32 const * x = b.data + (pc * b.rowStride);
+
+                            for (u32 kIdx = 0; kIdx < kc; ++kIdx)
+                            {
+                                f32 const xVal = x[kIdx * b.rowStride];
+                                for (u32 rIdx = 0; rIdx < MR; ++rIdx)
+                                {
+                                    sums[rIdx] += panel[rIdx] * xVal;
+                                }
+                                panel += MR;
+                            }
+                        }
+
+                        for (u32 rIdx = 0; rIdx < numRows; ++rIdx)
+                        {
+                            dst[rIdx * c.rowStride] = sums[rIdx];
+                        }
+                    }
+                    else
+                    {
+                        for (u32 rIdx = 0; rIdx < numRows; ++rIdx)
+                        {
+                            f32 * row = dst + (rIdx * c.rowStride);
+                            for (u32 cIdx = 0; cIdx < c.numCols; ++cIdx)
+                            {
+                                row[cIdx] = 0.0f;
+                            }
+                        }
+
+                        // Accumulate whole rows of b into the rows of c so the inner loop is contiguous
+                        // for row-major b.
+                        for (u32 pc = 0; pc < a.numCols; pc += a.kc)
+                        {
+                            u32 const kc = std::min(a.kc, a.numCols - pc);
+                            f32 const * panel = a.data + (pc * paddedRows) + (static_cast<u64>(pIdx) * MR * kc);
+
+                            for (u32 kIdx = 0; kIdx < kc; ++kIdx)
+                            {
+                                f32 const * src = b.data + ((pc + kIdx) * b.rowStride);
+
+                                for (u32 rIdx = 0; rIdx < numRows; ++rIdx)
+                                {
+                                    f32 const aVal = panel[rIdx];
+                                    f32 * row = dst + (rIdx * c.rowStride);
+
+                                    if (1 == b.colStride)
+                                    {
+                                        for (u32 cIdx = 0; cIdx < c.numCols; ++cIdx)
+                                        {
+                                            row[cIdx] += aVal * src[cIdx];
+                                        }
+                                    }
+                                    else
+                                    {
+                                        for (u32 cIdx = 0; cIdx < c.numCols; ++cIdx)
+                                        {
+                                            row[cIdx] += aVal * src[cIdx * b.colStride];
+                                        }
+                                    }
+                                }
+                                panel += MR;
+                            }
+                        }
+                    }
+
+                    if (hasEpilogue)
+                    {
+                        for (u32 rIdx = 0; rIdx < numRows; ++rIdx)
+                        {
+                            ApplyEpilogue(epilogue, c.rowStride, rowBegin + rIdx, dst + (rIdx * c.rowStride), c.numCols);
+                        }
+                    }
+                }
+            }
+
+            // Dispatches to the MultiplySmallPacked of the micro-kernel's register tile height.
+            void MultiplySmallPacked(PackedOperand const & a, Operand const & b, Output const & c, Epilogue const & epilogue, u32 panelBegin, u32 panelEnd)
+            {
+                switch (a.mr)
+                {
+                    case 4:     MultiplySmallPacked<4>(a, b, c, epilogue, panelBegin, panelEnd); break;
+                    case 6:     MultiplySmallPacked<6>(a, b, c, epilogue, panelBegin, panelEnd); break;
+                    case 8:     MultiplySmallPacked<8>(a, b, c, epilogue, panelBegin, panelEnd); break;
+                    case 12:    MultiplySmallPacked<12>(a, b, c, epilogue, panelBegin, panelEnd); break;
+
+                    default:
+                        ASSERTMSG(false, "No small packed multiplication for the micro-kernel's register tile.");
+                        break;
+                }
+            }
+
+            // Computes c = a * b by splitting c into a grid of blocks (aligned to the register tile of the
+            // micro-kernel), one per thread, with each block computed by the blocked engine. The grid is the
+            // factorisation of the thread count whose blocks have the smallest perimeter, which minimises
+            // the amount of a & b each thread has to pack.
+            void MultiplyParallel(Operand const & a, Operand const & b, Output const & c, Epilogue const & epilogue, u32 numThreads, PackedOperand const * packedA = nullptr)
+            {
+                kernels::GemmKernelInfo const & info = kernels::GetKernelTable().gemm;
+
+                u32 const rowTiles = DivideRoundUp(c.numRows, info.mr);
+                u32 const colTiles = DivideRoundUp(c.numCols, info.nr);
+
+                u32 gridRows = std::min(numThreads, rowTiles);
+                u32 gridCols = 1;
+                f64 bestPerimeter = (static_cast<f64>(c.numRows) / gridRows) + c.numCols;
+
+                for (u32 candidateRows = 1; candidateRows <= numThreads; ++candidateRows)
+                {
+                    if (0 != (numThreads % candidateRows))
+                    {
+                        continue;
+                    }
+
+                    u32 const candidateCols = numThreads / candidateRows;
+                    if ((candidateRows > rowTiles) || (candidateCols > colTiles))
+                    {
+                        continue;
+                    }
+
+                    f64 const perimeter = (static_cast<f64>(c.numRows) / candidateRows) + (static_cast<f64>(c.numCols) / candidateCols);
+                    if (perimeter < bestPerimeter)
+                    {
+                        bestPerimeter = perimeter;
+                        gridRows = candidateRows;
+                        gridCols = candidateCols;
+                    }
+                }
+
+                ThreadPool::Get().ParallelFor(static_cast<u64>(gridRows) * gridCols, 1, [&](u64 begin, u64 end)
+                {
+                    for (u64 bIdx = begin; bIdx < end; ++bIdx)
+                    {
+                        u32 const blockRow = static_cast<u32>(bIdx / gridCols);
+                        u32 const blockCol = static_cast<u32>(bIdx % gridCols);
+
+                        u32 const rowBegin = std::min(c.numRows, ((rowTiles * blockRow) / gridRows) * info.mr);
+                        u32 const rowEnd = std::min(c.numRows, ((rowTiles * (blockRow + 1)) / gridRows) * info.mr);
+                        u32 const colBegin = std::min(c.numCols, ((colTiles * blockCol) / gridCols) * info.nr);
+                        u32 const colEnd = std::min(c.numCols, ((colTiles * (blockCol + 1)) / gridCols) * info.nr);
+
+                        if ((rowBegin == rowEnd) || (colBegin == colEnd))
+                        {
+                            continue;
+                        }
+
+                        MultiplyBlocked(
+                            Slice(a, rowBegin, rowEnd, 0, a.numCols),
+                            Slice(b, 0, b.numRows, colBegin, colEnd),
+                            Slice(c, rowBegin, rowEnd, colBegin, colEnd),
+                            Slice(epilogue, c.rowStride, rowBegin, colBegin),
+                            packedA,
+                            rowBegin
+                        );
+                    }
+                });
+            }
+        }
+
+        Operand MakeOperand(f32 const * data, u32 numRows, u32 numCols)
+        {
+            Operand operand;
+            operand.data = data;
+            operand.numRows = numRows;
+            operand.numCols = numCols;
+            operand.rowStride = numCols;
+            operand.colStride = 1;
+            return operand;
+        }
+
+        Operand MakeOperand(Tensor const & tensor)
+        {
+            ASSERTMSG(2 == tensor.GetNumDimensions(), "Only 2D tensors can be multiplied.");
+
+            Operand operand;
+            operand.data = tensor.GetData();
+            operand.numRows = tensor.GetLength(0);
+            operand.numCols = tensor.GetLength(1);
+            operand.rowStride = tensor.GetStride(0);
+            operand.colStride = tensor.GetStride(1);
+            return operand;
+        }
+
+        Output MakeOutput(f32 * data, u32 numRows, u32 numCols)
+        {
+            Output output;
+            output.data = data;
+            output.numRows = numRows;
+            output.numCols = numCols;
+            output.rowStride = numCols;
+            return output;
+        }
+
+        u64 GetPackedSize(u32 numRows, u32 numCols)
+        {
+            kernels::GemmKernelInfo const & info = kernels::GetKernelTable().gemm;
+            return static_cast<u64>(GetPaddedRows(numRows, info.mr)) * numCols;
+        }
+
+        PackedOperand Pack(Operand const & a, f32 * packed)
+        {
+            kernels::GemmKernelInfo const & info = kernels::GetKernelTable().gemm;
+            u64 const paddedRows = GetPaddedRows(a.numRows, info.mr);
+
+            // One block of panels per kc columns, matching the order the blocked engine consumes them in
+            for (u32 pc = 0; pc < a.numCols; pc += info.kc)
+            {
+                u32 const kc = std::min(info.kc, a.numCols - pc);
+                PackA(a, 0, pc, a.numRows, kc, info.mr, packed + (pc * paddedRows));
+            }
+
+            PackedOperand result;
+            result.data = packed;
+            result.numRows = a.numRows;
+            result.numCols = a.numCols;
+            result.mr = info.mr;
+            result.kc = info.kc;
+            return result;
+        }
+
+        bool IsPackedForCurrentKernel(PackedOperand const & a)
+        {
+            kernels::GemmKernelInfo const & info = kernels::GetKernelTable().gemm;
+            return (a.mr == info.mr) && (a.kc == info.kc);
+        }
+
+        void Multiply(Operand const & a, Operand const & b, Output const & c)
+        {
+            Multiply(a, b, c, Epilogue());
+        }
+
+        void Multiply(Operand const & a, Operand const & b, Output const & c, Epilogue const & epilogue)
+        {
+            ASSERTMSG(a.numCols == b.numRows, "Impossible matrix multiplication. Incompatible dimensions.");
+            ASSERTMSG((c.numRows == a.numRows) && (c.numCols == b.numCols), "Output of the matrix multiplication has incorrect dimensions.");
+
+            if ((0 == c.numRows) || (0 == c.numCols))
+            {
+                return;
+            }
+
+            if (0 == a.numCols)
+            {
+                for (u32 rIdx = 0; rIdx < c.numRows; ++rIdx)
+                {
+                    f32 * row = c.data + (rIdx * c.rowStride);
+                    memset(row, 0, c.numCols * sizeof(f32));
+                    ApplyEpilogue(epilogue, c.rowStride, rIdx, row, c.numCols);
+                }
+                return;
+            }
+
+            u64 const numMultiplyAdds = static_cast<u64>(c.numRows) * c.numCols * a.numCols;
+            u32 const numThreads = (numMultiplyAdds >= c_ParallelThreshold) ? ThreadPool::Get().GetNumThreads() : 1;
+
+            if ((1 == c.numCols) || (numMultiplyAdds <= c_SmallProblemThreshold))
+            {
+                // Split matrix-vector products across rows of c
+                u64 const minRowsPerThread = std::max(c_MinMultiplyAddsPerThread / a.numCols, static_cast<u64>(1));
+                ThreadPool::Get().ParallelFor(c.numRows, minRowsPerThread, [&](u64 begin, u64 end)
+                {
+                    u32 const rowBegin = static_cast<u32>(begin);
+                    u32 const rowEnd = static_cast<u32>(end);
+                    MultiplySmall(Slice(a, rowBegin, rowEnd, 0, a.numCols), b, Slice(c, rowBegin, rowEnd, 0, c.numCols), Slice(epilogue, c.rowStride, rowBegin, 0));
+                });
+            }
+            else if (numThreads > 1)
+            {
+                MultiplyParallel(a, b, c, epilogue, numThreads);
+            }
+            else
+            {
+                MultiplyBlocked(a, b, c, epilogue);
+            }
+        }
+
+        void Multiply(PackedOperand const & a, Operand const & b, Output const & c, Epilogue const & epilogue)
+        {
+            ASSERTMSG(a.numCols == b.numRows, "Impossible matrix multiplication. Incompatible dimensions.");
+            ASSERTMSG((c.numRows == a.numRows) && (c.numCols == b.numCols), "Output of the matrix multiplication has incorrect dimensions.");
+            ASSERTMSG(IsPackedForCurrentKernel(a), "Operand was packed for a different micro-kernel.");
+
+            if ((0 == c.numRows) || (0 == c.numCols) || (0 == a.numCols))
+            {
+                Operand unpacked;
+                unpacked.numRows = a.numRows;
+                unpacked.numCols = a.numCols;
+                Multiply(unpacked, b, c, epilogue);
+                return;
+            }
+
+            // The a operand only supplies the dimensions, its panels come from the packed operand
+            Operand dimensions;
+            dimensions.numRows = a.numRows;
+            dimensions.numCols = a.numCols;
+
+            u64 const numMultiplyAdds = static_cast<u64>(c.numRows) * c.numCols * a.numCols;
+            u32 const numThreads = (numMultiplyAdds >= c_ParallelThreshold) ? ThreadPool::Get().GetNumThreads() : 1;
+
+            if ((1 == c.numCols) || (numMultiplyAdds <= c_SmallProblemThreshold))
+            {
+                // Split matrix-vector products (& small problems) across panels of a
+                u32 const numPanels = DivideRoundUp(a.numRows, a.mr);
+                u64 const minPanelsPerThread = std::max(c_MinMultiplyAddsPerThread / (static_cast<u64>(a.numCols) * a.mr * c.numCols), static_cast<u64>(1));
+                ThreadPool::Get().ParallelFor(numPanels, minPanelsPerThread, [&](u64 begin, u64 end)
+                {
+                    MultiplySmallPacked(a, b, c, epilogue, static_cast<u32>(begin), static_cast<u32>(end));
+                });
+            }
+            else if (numThreads > 1)
+            {
+                MultiplyParallel(dimensions, b, c, epilogue, numThreads, &a);
+            }
+            else
+            {
+                MultiplyBlocked(dimensions, b, c, epilogue, &a, 0);
+            }
+        }
+    }
+}
@@ -0,0 +1,100 @@
+#pragma once
+
+#include "Common.h"
+#include "Activators/Activators.h"
+#include "Maths/Tensor.h"
+
+namespace mia
+{
+    namespace gemm
+    {
+        // Describes a read-only 2D operand of a matrix multiplication. Elements are addressed
+        // as data[(rowIndex * rowStride) + (colIndex * colStride)] which allows row-major,
+        // column-major (i.e. transposed) & sub-matrix views to be supplied without any copies.
+        struct Operand
+        {
+            f32 const * data = nullptr;
+            u32 numRows = 0;
+            u32 numCols = 0;
+            u64 rowStride = 0;
+            u64 colStride = 0;
+        };
+
+        // Describes a read-only 2D operand that was packed ahead of time by Pack, in the layout the blocked
+        // engine's micro-kernel streams a through. The layout depends on the micro-kernel it was packed for
+        // (mr & kc), see IsPackedForCurrentKernel.
+        struct PackedOperand
+        {
+            f32 const * data = nullptr;
+            u32 numRows = 0;
+            u32 numCols = 0;
+            u32 mr = 0;
+            u32 kc = 0;
+        };
+
+        // Describes a writable, row-major 2D output of a matrix multiplication.
+        struct Output
+        {
+            f32 * data = nullptr;
+            u32 numRows = 0;
+            u32 numCols = 0;
+            u64 rowStride = 0;
+        };
+
+        // Describes operations fused into the final write of each tile of c, applied in order while
+        // the tile is still in registers (or at worst in the L1 cache):
+        // - rowBias[rowIndex] is added to every element of each row of c (skipped if nullptr)
+        // - the biased values are stored into preActivation (skipped if nullptr), which has the same
+        //   dimensions & row stride as c
+        // - the activator is applied to every element of c, with the supplied precision
+        struct Epilogue
+        {
+            f32 const * rowBias = nullptr;
+            f32 * preActivation = nullptr;
+            activators::ActivatorType activator = activators::ActivatorType::None;
+            kernels::MathPrecision precision = kernels::MathPrecision::Accurate;
+        };
+
+        // Returns an operand describing a contiguous row-major matrix.
+        Operand MakeOperand(f32 const * data, u32 numRows, u32 numCols);
+        // Returns an operand describing a 2D tensor, its strides are carried over as-is so transposed &
+        // sliced views are read in place.
+        Operand MakeOperand(Tensor const & tensor);
+        // Returns an output describing a contiguous row-major matrix.
+        Output MakeOutput(f32 * data, u32 numRows, u32 numCols);
+
+        // Returns the number of elements Pack needs to hold a numRows x numCols operand.
+        u64 GetPackedSize(u32 numRows, u32 numCols);
+        // Packs a into packed (which must hold GetPackedSize(a.numRows, a.numCols) elements) for the
+        // micro-kernel of the running CPU & returns a description of the packed operand. Operands that are
+        // the a of many multiplications (e.g. the weights of a layer) can be packed once up front instead of
+        // on every multiplication.
+        PackedOperand Pack(Operand const & a, f32 * packed);
+        // Returns true if the operand was packed for the micro-kernel of the running CPU. This only changes
+        // if the instruction set in use is changed (see cpu::SetMaxSimdLevel), after which the operand must
+        // be packed again.
+        bool IsPackedForCurrentKernel(PackedOperand const & a);
+
+        // Computes c = a * b.
+        //
+        // Large problems run through a blocked GEMM engine:
+        // - b is packed into kc x nc panels (sized for the L3 cache) that are NR columns wide
+        // - a is packed into mc x kc panels (sized for the L2 cache) that are MR rows tall
+        // - a register-tiled micro-kernel computes an MR x NR tile of c, keeping the whole
+        //   tile in registers for the duration of the kc loop. The micro-kernel & blocking sizes
+        //   are those of the most capable instruction set the running CPU supports.
+        //
+        // Small problems (and matrix-vector products) skip the packing entirely as the cost of
+        // packing would dominate the cost of the multiplication.
+        //
+        // Problems large enough to amortise the cost of waking the thread pool are split across
+        // its threads: c is divided into one block per thread & each block is computed independently.
+        void Multiply(Operand const & a, Operand const & b, Output const & c);
+        // Computes c = activator((a * b) + rowBias), see Epilogue.
+        void Multiply(Operand const & a, Operand const & b, Output const & c, Epilogue const & epilogue);
+        // Computes c = activator((a * b) + rowBias) with a pre-packed a, which skips packing a altogether.
+        // Matrix-vector products stream through the packed panels of a as well. a must have been packed
+        // for the micro-kernel of the running CPU (see IsPackedForCurrentKernel).
+        void Multiply(PackedOperand const & a, Operand const & b, Output const & c, Epilogue const & epilogue);
+    }
+}
@@ -1,74 +1,121 @@
 #include "Matrix.h"
+#include "Maths/Gemm.h"
+#include "Maths/Random.h"
+#include "Core/ThreadPool.h"
+#include "Kernels/Kernels.h"
+
+#include <algorithm>
+#include <stdio.h>
+#include <string.h>
 
 namespace mia
 {
+    namespace
+    {
+        // Minimum number of elements each thread is given by element-wise operations & transposes.
+        // Below this the cost of waking the thread pool outweighs the gain.
+        u64 constexpr c_MinElementsPerThread = 64 * 1024;
+
+        // Transposes work on square blocks of this many rows & columns. A block of the source plus a
+        // block of the destination (2 x 16KB) fit in the L1 cache.
+        u32 constexpr c_TransposeBlockSize = 64;
+    }
+
     Matrix::Matrix()
+        : Matrix(Allocator::GetDefault())
+    {
+    }
+
+    Matrix::Matrix(Allocator & allocator)
         : m_Width(0)
         , m_Height(0)
         , m_Data(nullptr)
+        , m_NumReservedElements(0)
+        , m_Allocator(&allocator)
+        , m_IsView(false)
     {
     }
 
-    Matrix::Matrix(u32 width, u32 height, f32 * data)
+    Matrix::Matrix(u32 width, u32 height, f32 * data, Allocator & allocator)
         : m_Width(width)
         , m_Height(height)
         , m_Data(nullptr)
+        , m_NumReservedElements(0)
+        , m_Allocator(&allocator)
+        , m_IsView(false)
     {
         u64 const capacity = GetCapacity();
         if (capacity > 0)
         {
-            m_Data = new f32[capacity];
+            Reallocate(capacity);
             memcpy(m_Data, data, capacity * sizeof(f32));
         }
     }
 
-    Matrix::Matrix(u32 width, u32 height)
+    Matrix::Matrix(u32 width, u32 height, Allocator & allocator)
         : m_Width(width)
         , m_Height(height)
         , m_Data(nullptr)
+        , m_NumReservedElements(0)
+        , m_Allocator(&allocator)
+        , m_IsView(false)
     {
         u64 const capacity = GetCapacity();
-        m_Data = new f32[capacity];
-        for (u64 eIdx = 0; eIdx < capacity; ++eIdx)
+        if (capacity > 0)
         {
-            m_Data[eIdx] = 0.0f;
+            Reallocate(capacity);
+            memset(m_Data, 0, capacity * sizeof(f32));
         }
     }
 
+    Matrix Matrix::View(u32 width, u32 height, f32 * data, Allocator & allocator)
+    {
+        Matrix matrix(allocator);
+        matrix.m_Width = width;
+        matrix.m_Height = height;
+        matrix.m_Data = data;
+        matrix.m_NumReservedElements = matrix.GetCapacity();
+        matrix.m_IsView = true;
+        return matrix;
+    }
+
     Matrix::Matrix(Matrix const & other)
-        : m_Width(0)
-        , m_Height(0)
-        , m_Data(nullptr)
+        : Matrix(*other.m_Allocator)
     {
         *this = other;
     }
 
     Matrix::Matrix(Matrix && other) noexcept
-        : m_Width(0)
-        , m_Height(0)
-        , m_Data(nullptr)
+        : Matrix(*other.m_Allocator)
     {
         *this = std::move(other);
     }
 
     Matrix::~Matrix()
     {
-        if (nullptr != m_Data)
-        {
-            delete[] m_Data;
-        }
+        Release();
     }
 
     Matrix & Matrix::operator = (Matrix const & other)
     {
+        if (this == &other)
+        {
+            return *this;
+        }
+
+        // Reuse the existing storage if it is large enough
+        u64 const capacity = other.GetCapacity();
+        if (capacity > m_NumReservedElements)
+        {
+            Release();
+            Reallocate(capacity);
+        }
+
         m_Width = other.m_Width;
         m_Height = other.m_Height;
-        m_Data = nullptr;
 
-        u64 const capacity = GetCapacity();
         if (capacity > 0)
         {
-            m_Data = new f32[capacity];
             memcpy(m_Data, other.m_Data, capacity * sizeof(f32));
         }
 
@@ -77,27 +124,92 @@ namespace mia
 
     Matrix & Matrix::operator = (Matrix && other) noexcept
     {
+        if (this == &other)
+        {
+            return *this;
+        }
+
+        Release();
+
         m_Width = other.m_Width;
         m_Height = other.m_Height;
         m_Data = other.m_Data;
+        m_NumReservedElements = other.m_NumReservedElements;
+        m_Allocator = other.m_Allocator;
+        m_IsView = other.m_IsView;
 
         other.m_Width = 0;
         other.m_Height = 0;
         other.m_Data = nullptr;
+        other.m_NumReservedElements = 0;
+        other.m_IsView = false;
 
         return *this;
     }
 
-    void Matrix::Seed(u32 seed)
+    void Matrix::Resize(u32 width, u32 height)
     {
-        ASSERTMSG(nullptr != m_Data, "Failed to seed matrix.");
+        u64 const capacity = static_cast<u64>(width) * static_cast<u64>(height);
+        if (capacity > m_NumReservedElements)
+        {
+            Release();
+            Reallocate(capacity);
+            memset(m_Data, 0, capacity * sizeof(f32));
+        }
 
-        srand(seed);
-        u64 const capacity = GetCapacity();
-        for (u64 eIdx = 0; eIdx < capacity; ++eIdx)
+        m_Width = width;
+        m_Height = height;
+    }
+
+    void Matrix::Reserve(u64 numElements)
+    {
+        if (numElements <= m_NumReservedElements)
+        {
+            return;
+        }
+
+        f32 * const prevData = m_Data;
+        u64 const prevNumReservedElements = m_NumReservedElements;
+        bool const prevIsView = m_IsView;
+
+        Reallocate(numElements);
+        memset(m_Data, 0, numElements * sizeof(f32));
+
+        if (nullptr != prevData)
+        {
+            memcpy(m_Data, prevData, GetCapacity() * sizeof(f32));
+            if (!prevIsView)
+            {
+                m_Allocator->Free(prevData, prevNumReservedElements * sizeof(f32));
+            }
+        }
+    }
+
+    void Matrix::Reallocate(u64 numElements)
+    {
+        m_Data = static_cast<f32 *>(m_Allocator->Allocate(numElements * sizeof(f32)));
+        m_NumReservedElements = numElements;
+        m_IsView = false;
+    }
+
+    void Matrix::Release()
+    {
+        // Views never free the memory they reference
+        if ((nullptr != m_Data) && !m_IsView)
         {
-            m_Data[eIdx] = static_cast<f32>(rand()) / static_cast<f32>(RAND_MAX);
+            m_Allocator->Free(m_Data, m_NumReservedElements * sizeof(f32));
         }
+
+        m_Data = nullptr;
+        m_NumReservedElements = 0;
+        m_IsView = false;
+    }
+
+    void Matrix::Seed(u64 seed, u64 stream)
+    {
+        ASSERTMSG(nullptr != m_Data, "Failed to seed matrix.");
+
+        rng::FillUniform(seed, stream, 0.0f, 1.0f, m_Data, GetCapacity());
     }
 
     void Matrix::Copy(u32 rowIndex, u32 colIndex, f32 const * data, u32 length)
@@ -129,12 +241,48 @@ namespace mia
         ASSERTMSG(a.GetHeight() == b.GetHeight(), "Cannot add matrix a & b. Invalid dimensions.");
 
         Matrix result(a.GetWidth(), b.GetHeight());
+        ThreadPool::Get().ParallelFor(a.GetCapacity(), c_MinElementsPerThread, [&](u64 begin, u64 end)
+        {
+            kernels::Add(a.m_Data + begin, b.m_Data + begin, result.m_Data + begin, end - begin);
+        });
 
-        u64 const capacity = a.GetCapacity();
-        for (u64 eIdx = 0; eIdx < capacity; ++eIdx)
+        return result;
+    }
+
+    void Matrix::AddInPlace(Matrix & a, Matrix const & b)
+    {
+        ASSERTMSG(a.GetWidth() == b.GetWidth(), "Cannot add matrix a & b. Invalid dimensions.");
+        ASSERTMSG(a.GetHeight() == b.GetHeight(), "Cannot add matrix a & b. Invalid dimensions.");
+
+        ThreadPool::Get().ParallelFor(a.GetCapacity(), c_MinElementsPerThread, [&](u64 begin, u64 end)
         {
-            result.m_Data[eIdx] = a.m_Data[eIdx] + b.m_Data[eIdx];
-        }
+            kernels::Add(a.m_Data + begin, b.m_Data + begin, a.m_Data + begin, end - begin);
+        });
+    }
+
+    Matrix Matrix::AddBroadcast(Matrix const & a, Matrix const & column)
+    {
+        ASSERTMSG(1 == column.GetWidth(), "Cannot broadcast matrix column. It must have a width of 1.");
+        ASSERTMSG(a.GetHeight() == column.GetHeight(), "Cannot add matrix a & column. Invalid dimensions.");
+
+        Matrix result(a.GetWidth(), a.GetHeight());
+
+        // Each row of a is contiguous & shares a single value of column
+        u64 const minRowsPerThread = std::max(c_MinElementsPerThread / std::max(a.GetWidth(), static_cast<u32>(1)), static_cast<u64>(1));
+        ThreadPool::Get().ParallelFor(a.GetHeight(), minRowsPerThread, [&](u64 begin, u64 end)
+        {
+            for (u64 rIdx = begin; rIdx < end; ++rIdx)
+            {
+                f32 const value = column.m_Data[rIdx];
+                f32 const * src = a.m_Data + (rIdx * a.GetWidth());
+                f32 * dst = result.m_Data + (rIdx * a.GetWidth());
+
+                for (u32 cIdx = 0; cIdx < a.GetWidth(); ++cIdx)
+                {
+                    dst[cIdx] = src[cIdx] + value;
+                }
+            }
+        });
 
         return result;
     }
@@ -145,7 +293,7 @@ namespace mia
         for (u64 eIdx = 0; eIdx < capacity; ++eIdx)
         {
             char tmp[32];
-            sprintf_s(tmp, "%.4f", m_Data[eIdx]);
+            snprintf(tmp, sizeof(tmp), "%.4f", m_Data[eIdx]);
 
             std::cout << tmp;
 
@@ -163,90 +311,170 @@ namespace mia
     }
 
     Matrix Matrix::Multiply(Matrix const & a, Matrix const & b)
+    {
+        Matrix result;
+        MultiplyInto(a, b, result);
+        return result;
+    }
+
+    void Matrix::MultiplyInto(Matrix const & a, Matrix const & b, Matrix & result)
     {
         ASSERTMSG((nullptr != a.m_Data) && (nullptr != b.m_Data), "Failed to multipy matrix by another. Matrices aren't valid.");
         ASSERTMSG(a.GetWidth() == b.GetHeight(), "Impossible matrix multiplication. Incompatible dimensions.");
+        ASSERTMSG((&result != &a) && (&result != &b), "The result of a matrix multiplication cannot be stored in one of its operands.");
 
-        /*
-            Performance Note:
-            To improve performance with large matrices, things to implement:
-                - Multithreading (either on CPU or GPU)
-                - SIMD operations
-        */
-
-        Matrix result(b.GetWidth(), a.GetHeight());
-
-        // Transpose b to reduce cache misses on large matrices
-        Matrix bTransposed = Matrix::Transpose(b);
-
-        for (u32 cIdx = 0; cIdx < result.GetWidth(); ++cIdx)
-        {
-            for (u32 rIdx = 0; rIdx < result.GetHeight(); ++rIdx)
-            {
-                u32 const aOffset = a.GetWidth() * rIdx;
-                u32 const bOffset = bTransposed.GetWidth() * cIdx;
-                u32 const resultOffset = result.GetWidth() * rIdx;
-
-                for (u32 i = 0; i < a.GetWidth(); ++i)
-                {
-                    f32 const & aVal = a.m_Data[aOffset + i];
-                    f32 const & bVal = bTransposed.m_Data[bOffset + i];
+        result.Resize(b.GetWidth(), a.GetHeight());
 
-                    result.m_Data[resultOffset + cIdx] += aVal * bVal;
-                }
-            }
-        }
-
-        return result;
+        // The GEMM engine packs both a & b into cache friendly panels itself, so b
+        // no longer needs to be transposed up front.
+        gemm::Multiply(
+            gemm::MakeOperand(a.m_Data, a.GetHeight(), a.GetWidth()),
+            gemm::MakeOperand(b.m_Data, b.GetHeight(), b.GetWidth()),
+            gemm::MakeOutput(result.m_Data, result.GetHeight(), result.GetWidth())
+        );
     }
 
     Matrix Matrix::Transpose(Matrix const & m)
     {
         Matrix result;
+        TransposeInto(m, result);
+        return result;
+    }
+
+    void Matrix::TransposeInto(Matrix const & m, Matrix & result)
+    {
+        ASSERTMSG(&result != &m, "A matrix cannot be transposed into itself.");
+
+        result.Resize(m.GetHeight(), m.GetWidth());
 
         if (m.GetHeight() == 1 || m.GetWidth() == 1)
         {
             // If m is a 1D matrix we will just make a simple copy of the matrix with
             // the height & width values swapped.
-            result = Matrix(m.GetHeight(), m.GetWidth(), m.m_Data);
+            if (m.GetCapacity() > 0)
+            {
+                memcpy(result.m_Data, m.m_Data, m.GetCapacity() * sizeof(f32));
+            }
         }
         else
         {
-            // If m is a 2D matrix, we will need to perform the transpose operation 
-            // on the matrix's data.
-            result = Matrix(m.GetHeight(), m.GetWidth());
-
-            for (u32 rIdx = 0; rIdx < m.GetHeight(); ++rIdx)
+            // If m is a 2D matrix, we will need to perform the transpose operation on the matrix's data.
+            // Walking m row by row would write result a column at a time, touching a different cache
+            // line (& for large matrices a different page) with every element. Instead m is transposed
+            // one cache sized block at a time, so the strided writes stay within a block of result that
+            // is already in the L1 cache. Each thread transposes a range of rows of blocks of m.
+            u32 const width = m.GetWidth();
+            u32 const height = m.GetHeight();
+            u64 const numBlockRows = (height + c_TransposeBlockSize - 1) / c_TransposeBlockSize;
+            u64 const minBlockRowsPerThread = std::max(c_MinElementsPerThread / (static_cast<u64>(width) * c_TransposeBlockSize), static_cast<u64>(1));
+
+            ThreadPool::Get().ParallelFor(numBlockRows, minBlockRowsPerThread, [&](u64 begin, u64 end)
             {
-                for (u32 cIdx = 0; cIdx < m.GetWidth(); ++cIdx)
+                for (u64 bIdx = begin; bIdx < end; ++bIdx)
                 {
-                    result.m_Data[(result.GetWidth() * cIdx) + rIdx] = m.m_Data[(m.GetWidth() * rIdx) + cIdx];
+                    u32 const rIdx = static_cast<u32>(bIdx * c_TransposeBlockSize);
+                    u32 const numRows = std::min(c_TransposeBlockSize, height - rIdx);
+
+                    for (u32 cIdx = 0; cIdx < width; cIdx += c_TransposeBlockSize)
+                    {
+                        u32 const numCols = std::min(c_TransposeBlockSize, width - cIdx);
+                        kernels::Transpose(
+                            m.m_Data + (static_cast<u64>(rIdx) * width) + cIdx, width, numRows, numCols,
+                            result.m_Data + (static_cast<u64>(cIdx) * height) + rIdx, height
+                        );
+                    }
                 }
-            }
+            });
         }
-
-        return result;
     }
 
-    bool Matrix::operator == (Matrix const & other) const
+    void Matrix::TransposeInPlace(Matrix & m)
     {
-        if ((GetWidth() != other.GetWidth()) || (GetHeight() != other.GetHeight()))
+        if (m.GetHeight() == 1 || m.GetWidth() == 1)
         {
-            return false;
+            // The data of a 1D matrix is identical to that of its transpose
+            std::swap(m.m_Width, m.m_Height);
+            return;
+        }
+
+        if (m.GetWidth() != m.GetHeight())
+        {
+            // Transposing a rectangular matrix in place means following the cycles of the permutation,
+            // which scatters accesses all over the matrix. Going through a temporary is far faster.
+            Matrix transposed(*m.m_Allocator);
+            TransposeInto(m, transposed);
+            m = std::move(transposed);
+            return;
         }
 
-        for (u32 rIdx = 0; rIdx < GetHeight(); ++rIdx)
+        // Square matrices are transposed by swapping each block above the diagonal with its mirror below
+        // it (transposing both on the way) & transposing the blocks on the diagonal in place. A block is
+        // staged in a scratch tile on the stack so that the kernel's inputs & outputs never overlap.
+        // Each thread handles a range of the blocks on or above the diagonal, which are numbered row
+        // by row.
+        u32 const size = m.GetWidth();
+        u32 const numBlocks = (size + c_TransposeBlockSize - 1) / c_TransposeBlockSize;
+        u64 const numBlockPairs = (static_cast<u64>(numBlocks) * (numBlocks + 1)) / 2;
+        u64 const minBlockPairsPerThread = std::max(c_MinElementsPerThread / (static_cast<u64>(c_TransposeBlockSize) * c_TransposeBlockSize), static_cast<u64>(1));
+
+        ThreadPool::Get().ParallelFor(numBlockPairs, minBlockPairsPerThread, [&](u64 begin, u64 end)
         {
-            for (u32 cIdx = 0; cIdx < GetWidth(); ++cIdx)
+            f32 tile[c_TransposeBlockSize * c_TransposeBlockSize];
+
+            // Find the block (iIdx, jIdx) that begin refers to
+            u32 iIdx = 0;
+            u64 pIdx = begin;
+            while (pIdx >= numBlocks - iIdx)
+            {
+                pIdx -= numBlocks - iIdx;
+                ++iIdx;
+            }
+            u32 jIdx = iIdx + static_cast<u32>(pIdx);
+
+            for (u64 bIdx = begin; bIdx < end; ++bIdx)
             {
-                if (GetElement(rIdx, cIdx) != other.GetElement(rIdx, cIdx))
+                u32 const rIdx = iIdx * c_TransposeBlockSize;
+                u32 const cIdx = jIdx * c_TransposeBlockSize;
+                u32 const numRows = std::min(c_TransposeBlockSize, size - rIdx);
+                u32 const numCols = std::min(c_TransposeBlockSize, size - cIdx);
+
+                f32 * upper = m.m_Data + (static_cast<u64>(rIdx) * size) + cIdx;
+                f32 * lower = m.m_Data + (static_cast<u64>(cIdx) * size) + rIdx;
+
+                // tile = transpose(upper), upper = transpose(lower), lower = tile. On the diagonal upper
+                // & lower are the same block so the middle step is skipped.
+                kernels::Transpose(upper, size, numRows, numCols, tile, numRows);
+                if (iIdx != jIdx)
                 {
-                    return false;
+                    kernels::Transpose(lower, size, numCols, numRows, upper, size);
+                }
+                for (u32 tIdx = 0; tIdx < numCols; ++tIdx)
+                {
+                    memcpy(lower + (static_cast<u64>(tIdx) * size), tile + (tIdx * numRows), numRows * sizeof(f32));
+                }
+
+                if (++jIdx == numBlocks)
+                {
+                    ++iIdx;
+                    jIdx = iIdx;
                 }
             }
+        });
+    }
+
+    bool Matrix::Equals(Matrix const & other, f32 tolerance) const
+    {
+        if ((GetWidth() != other.GetWidth()) || (GetHeight() != other.GetHeight()))
+        {
+            return false;
         }
 
-        return true;
+        return kernels::AllClose(m_Data, other.m_Data, GetCapacity(), tolerance);
+    }
+
+    bool Matrix::operator == (Matrix const & other) const
+    {
+        return Equals(other, 0.0f);
     }
 
     bool Matrix::operator != (Matrix const & other) const
@@ -1,28 +1,54 @@
 #pragma once
 
 #include "Common.h"
+#include "Core/Allocator.h"
 
 namespace mia
 {
     // Represents a 2D array of f32 data of arbitary size (row-major).
+    //
+    // The storage of a matrix is provided by an Allocator (see Core/Allocator.h) & is aligned to
+    // c_AllocationAlignment bytes. Unless otherwise specified, matrices allocate from the global heap.
     class Matrix final
     {
     public:
         Matrix();
+        // Copies take the allocator of the matrix they are copied from.
         Matrix(Matrix const & other);
         Matrix(Matrix && other) noexcept;
         ~Matrix();
 
+        // Constructs an empty matrix that allocates from the supplied allocator.
+        explicit Matrix(Allocator & allocator);
         // Constructs a matrix of size width x height using the supplied data (this data is copied)
-        Matrix(u32 width, u32 height, f32 * data);
+        Matrix(u32 width, u32 height, f32 * data, Allocator & allocator = Allocator::GetDefault());
         // Constructs a matrix of size width x height (allocates memory with each element being 0.0f)
-        Matrix(u32 width, u32 height);
+        Matrix(u32 width, u32 height, Allocator & allocator = Allocator::GetDefault());
 
+        // Returns a matrix of size width x height whose elements are the supplied data, without copying it
+        // (e.g. to reference a memory-mapped file). The matrix never frees data, which the caller must keep
+        // alive for as long as the matrix references it. Writes to the matrix go straight to data. If the
+        // matrix later needs more elements than data holds it stops referencing data & allocates from the
+        // supplied allocator instead. Copies of the matrix own their elements.
+        static Matrix View(u32 width, u32 height, f32 * data, Allocator & allocator = Allocator::GetDefault());
+
+        // Copies the dimensions & contents of other. The matrix keeps its own allocator & only
+        // reallocates if other needs more elements than have been reserved.
         Matrix & operator = (Matrix const & other);
+        // Takes the storage (& allocator) of other.
         Matrix & operator = (Matrix && other) noexcept;
 
-        // Fills the matrix with random values between 0 & 1 based on the supplied seed 
-        void Seed(u32 seed);
+        // Changes the dimensions of the matrix. Memory is only reallocated if the new dimensions need
+        // more elements than have been reserved, so shrinking (or growing back) never touches the heap.
+        // The contents of the matrix are unspecified after resizing.
+        void Resize(u32 width, u32 height);
+        // Ensures the matrix can hold up to numElements elements without reallocating. The current
+        // dimensions & contents are kept.
+        void Reserve(u64 numElements);
+
+        // Fills the matrix with random values between 0 & 1 drawn from the supplied stream of seed (see
+        // Maths/Random.h).
+        void Seed(u64 seed, u64 stream = 0);
 
         // Copies the supplied data within the matrix in a row-majored fashion.
         void Copy(u32 rowIndex, u32 colIndex, f32 const * data, u32 length);
@@ -34,6 +60,15 @@ namespace mia
         // Returns the maximum capacity of the matrix (width * height)
         u64 GetCapacity() const;
 
+        // Returns the allocator the matrix's storage comes from
+        Allocator & GetAllocator() const;
+        // Returns true if the matrix references memory it doesn't own (see View).
+        bool IsView() const;
+
+        // Returns the underlying row-major element storage
+        f32 * GetData();
+        f32 const * GetData() const;
+
         // Returns the element associated with the supplied row index & height index
         f32 & GetElement(u64 rowIndex, u64 colIndex);
         f32 const & GetElement(u64 rowIndex, u64 colIndex) const;
@@ -42,22 +77,54 @@ namespace mia
         void Print() const;
 
         // Multiplies matrix a by matrix b and returns the result. Both a & b are expected to be
-        // row-majored as the supplied matrix b will be transposed during the multiply for better
-        // cache-miss performance.
+        // row-majored. The multiplication is performed by the blocked GEMM engine (see Maths/Gemm.h).
         static Matrix Multiply(Matrix const & a, Matrix const & b);
+        // Multiplies matrix a by matrix b and stores the result in the supplied result matrix, which
+        // is resized to fit (see Resize). result must not be a or b.
+        static void MultiplyInto(Matrix const & a, Matrix const & b, Matrix & result);
         // Transposes the supplied matrix and returns the result
         static Matrix Transpose(Matrix const & m);
+        // Transposes the supplied matrix and stores the result in the supplied result matrix, which
+        // is resized to fit (see Resize). result must not be m.
+        static void TransposeInto(Matrix const & m, Matrix & result);
+        // Transposes the supplied matrix in place. Square (& 1D) matrices are transposed without any
+        // additional memory, other matrices go through a temporary allocated from m's allocator.
+        static void TransposeInPlace(Matrix & m);
         // Adds matrix a & b together and returns the result. Both a & b are expected to be the
         // exact same dimensions.
         static Matrix Add(Matrix const & a, Matrix const & b);
+        // Adds matrix b to matrix a, storing the result in a. Both a & b are expected to be the
+        // exact same dimensions.
+        static void AddInPlace(Matrix & a, Matrix const & b);
+        // Adds the single column matrix column to every column of matrix a and returns the result.
+        // column is expected to have the same height as a.
+        static Matrix AddBroadcast(Matrix const & a, Matrix const & column);
+
+        // Returns true if both matrices have the same dimensions & every pair of elements differs by
+        // no more than the supplied tolerance.
+        bool Equals(Matrix const & other, f32 tolerance) const;
 
         bool operator == (Matrix const & other) const;
         bool operator != (Matrix const & other) const;
 
+    private:
+        // Allocates room for numElements elements (the previous storage must already have been released).
+        void Reallocate(u64 numElements);
+        // Returns the storage to the allocator.
+        void Release();
+
     private:
         u32 m_Width;
         u32 m_Height;
         f32 * m_Data;
+
+        // The number of elements m_Data has room for (at least width * height).
+        u64 m_NumReservedElements;
+
+        Allocator * m_Allocator;
+
+        // Whether m_Data is owned by the caller rather than allocated from m_Allocator (see View).
+        bool m_IsView;
     };
 
     inline u32 Matrix::GetWidth() const
@@ -75,6 +142,26 @@ namespace mia
         return static_cast<u64>(m_Width) * static_cast<u64>(m_Height);
     }
 
+    inline Allocator & Matrix::GetAllocator() const
+    {
+        return *m_Allocator;
+    }
+
+    inline bool Matrix::IsView() const
+    {
+        return m_IsView;
+    }
+
+    inline f32 * Matrix::GetData()
+    {
+        return m_Data;
+    }
+
+    inline f32 const * Matrix::GetData() const
+    {
+        return m_Data;
+    }
+
     inline f32 & Matrix::GetElement(u64 rowIndex, u64 colIndex)
     {
         ASSERTMSG(rowIndex < m_Height, "rowIndex out of bounds!");
@@ -0,0 +1,44 @@
+#include "Random.h"
+
+#include "Core/ThreadPool.h"
+#include "Kernels/Kernels.h"
+
+namespace mia
+{
+    namespace rng
+    {
+        namespace
+        {
+            // Generating numbers is cheap, only split fills across threads when each thread gets enough of
+            // them to amortise waking it.
+            u64 constexpr c_MinUniformsPerThread = 64 * 1024;
+            // The Box-Muller transform is several times more expensive per number
+            u64 constexpr c_MinNormalsPerThread = 16 * 1024;
+        }
+
+        u64 DeriveSeed(u64 seed, u64 index)
+        {
+            // SplitMix64 (Steele et al., 2014) of the index'th value of the seed's sequence
+            u64 value = seed + ((index + 1) * 0x9E3779B97F4A7C15ull);
+            value = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9ull;
+            value = (value ^ (value >> 27)) * 0x94D049BB133111EBull;
+            return value ^ (value >> 31);
+        }
+
+        void FillUniform(u64 seed, u64 stream, f32 low, f32 high, f32 * dst, u64 length)
+        {
+            ThreadPool::Get().ParallelFor(length, c_MinUniformsPerThread, [&](u64 begin, u64 end)
+            {
+                kernels::RandomUniform(seed, stream, begin, low, high, dst + begin, end - begin);
+            });
+        }
+
+        void FillNormal(u64 seed, u64 stream, f32 mean, f32 standardDeviation, f32 * dst, u64 length)
+        {
+            ThreadPool::Get().ParallelFor(length, c_MinNormalsPerThread, [&](u64 begin, u64 end)
+            {
+                kernels::RandomNormal(seed, stream, begin, mean, standardDeviation, dst + begin, end - begin);
+            });
+        }
+    }
+}
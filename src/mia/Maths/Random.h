@@ -0,0 +1,26 @@
+#pragma once
+
+#include "Common.h"
+
+namespace mia
+{
+    namespace rng
+    {
+        // Random numbers are drawn from counter-based generators (see kernels::RandomUniform): the nth number
+        // of a stream is computed directly from the seed, the stream & n rather than from the previous number.
+        // There is no global state, so filling is thread-safe, large fills are split across the threads of the
+        // thread pool & the numbers only depend on the seed & stream, never on the number of threads or the
+        // SIMD level in use. Different streams of the same seed are independent of each other.
+
+        // Returns the seed of an independent generator derived from seed & index (e.g. one per layer of a
+        // model), such that consecutive seeds or indices give unrelated seeds.
+        u64 DeriveSeed(u64 seed, u64 index);
+
+        // Fills dst with length numbers uniformly distributed between low & high.
+        void FillUniform(u64 seed, u64 stream, f32 low, f32 high, f32 * dst, u64 length);
+
+        // Fills dst with length normally distributed numbers of the supplied mean & standard deviation. Numbers
+        // are generated in pairs from pairs of uniform numbers (see kernels::RandomNormal).
+        void FillNormal(u64 seed, u64 stream, f32 mean, f32 standardDeviation, f32 * dst, u64 length);
+    }
+}
@@ -0,0 +1,453 @@
+#include "Tensor.h"
+#include "Kernels/Kernels.h"
+
+#include <algorithm>
+#include <string.h>
+
+namespace mia
+{
+    namespace
+    {
+        // Copies between layouts that differ in their unit stride dimension are done as 2D transposes of
+        // blocks of this many rows & columns, so a block of the source plus a block of the destination
+        // (2 x 16KB) fit in the L1 cache.
+        u32 constexpr c_CopyBlockSize = 64;
+
+        // Returns the innermost dimension of length > 1 with a stride of 1, or numDimensions if there isn't one.
+        u32 FindUnitStrideDimension(u32 numDimensions, DimensionLength const * shape, u64 const * strides)
+        {
+            for (u32 dIdx = numDimensions; dIdx-- > 0;)
+            {
+                if ((1 == strides[dIdx]) && (shape[dIdx] > 1))
+                {
+                    return dIdx;
+                }
+            }
+            return numDimensions;
+        }
+    }
+
+    Tensor::Tensor()
+        : m_Storage()
+        , m_Base(nullptr)
+        , m_Offset(0)
+        , m_NumDimensions(0)
+    {
+    }
+
+    Tensor::Tensor(std::initializer_list<DimensionLength> const & shape, Allocator & allocator)
+        : Tensor(static_cast<u32>(shape.size()), shape.begin(), allocator)
+    {
+    }
+
+    Tensor::Tensor(u32 numDimensions, DimensionLength const * shape, Allocator & allocator)
+        : Tensor()
+    {
+        ASSERTMSG(numDimensions <= c_MaxTensorDimensions, "Tensor has too many dimensions.");
+
+        m_NumDimensions = numDimensions;
+        memcpy(m_Shape, shape, numDimensions * sizeof(DimensionLength));
+        SetContiguousStrides();
+
+        u64 const numElements = GetNumElements();
+        if (numElements > 0)
+        {
+            u64 const numBytes = numElements * sizeof(f32);
+            Allocator * const storageAllocator = &allocator;
+
+            m_Base = static_cast<f32 *>(allocator.Allocate(numBytes));
+            m_Storage = std::shared_ptr<f32>(m_Base, [storageAllocator, numBytes](f32 * data)
+            {
+                storageAllocator->Free(data, numBytes);
+            });
+
+            memset(m_Base, 0, numBytes);
+        }
+    }
+
+    Tensor Tensor::Borrow(f32 * data, std::initializer_list<DimensionLength> const & shape)
+    {
+        return Borrow(data, static_cast<u32>(shape.size()), shape.begin());
+    }
+
+    Tensor Tensor::Borrow(f32 * data, u32 numDimensions, DimensionLength const * shape)
+    {
+        ASSERTMSG(numDimensions <= c_MaxTensorDimensions, "Tensor has too many dimensions.");
+
+        Tensor tensor;
+        tensor.m_Base = data;
+        tensor.m_NumDimensions = numDimensions;
+        memcpy(tensor.m_Shape, shape, numDimensions * sizeof(DimensionLength));
+        tensor.SetContiguousStrides();
+        return tensor;
+    }
+
+    Tensor Tensor::Borrow(f32 * data, u32 numDimensions, DimensionLength const * shape, u64 const * strides)
+    {
+        Tensor tensor = Borrow(data, numDimensions, shape);
+        memcpy(tensor.m_Strides, strides, numDimensions * sizeof(u64));
+        return tensor;
+    }
+
+    Tensor Tensor::Borrow(Matrix & matrix)
+    {
+        return Borrow(matrix.GetData(), { matrix.GetHeight(), matrix.GetWidth() });
+    }
+
+    u64 Tensor::GetNumElements() const
+    {
+        if (0 == m_NumDimensions)
+        {
+            return 0;
+        }
+
+        u64 numElements = 1;
+        for (u32 dIdx = 0; dIdx < m_NumDimensions; ++dIdx)
+        {
+            numElements *= m_Shape[dIdx];
+        }
+        return numElements;
+    }
+
+    bool Tensor::IsEmpty() const
+    {
+        return 0 == GetNumElements();
+    }
+
+    bool Tensor::IsContiguous() const
+    {
+        // The strides of dimensions of length 1 are never used so don't affect the layout
+        u64 expectedStride = 1;
+        for (u32 dIdx = m_NumDimensions; dIdx-- > 0;)
+        {
+            if (0 == m_Shape[dIdx])
+            {
+                return true;
+            }
+
+            if ((1 != m_Shape[dIdx]) && (expectedStride != m_Strides[dIdx]))
+            {
+                return false;
+            }
+            expectedStride *= m_Shape[dIdx];
+        }
+
+        return true;
+    }
+
+    bool Tensor::SharesStorageWith(Tensor const & other) const
+    {
+        if (nullptr != m_Storage)
+        {
+            return m_Storage == other.m_Storage;
+        }
+
+        return (nullptr != m_Base) && (m_Base == other.m_Base);
+    }
+
+    bool Tensor::TryReshape(u32 numDimensions, DimensionLength const * shape, Tensor & result) const
+    {
+        ASSERTMSG(numDimensions <= c_MaxTensorDimensions, "Tensor has too many dimensions.");
+
+        u64 numElements = (numDimensions > 0) ? 1 : 0;
+        for (u32 dIdx = 0; dIdx < numDimensions; ++dIdx)
+        {
+            numElements *= shape[dIdx];
+        }
+        ASSERTMSG(numElements == GetNumElements(), "Reshaped tensor must hold the same number of elements.");
+
+        Tensor reshaped = *this;
+        reshaped.m_NumDimensions = numDimensions;
+        memcpy(reshaped.m_Shape, shape, numDimensions * sizeof(DimensionLength));
+
+        if (IsContiguous())
+        {
+            reshaped.SetContiguousStrides();
+            result = reshaped;
+            return true;
+        }
+
+        // Dimensions of length 1 can be dropped from the source as they don't contribute to the layout
+        u32 numSrcDimensions = 0;
+        DimensionLength srcShape[c_MaxTensorDimensions];
+        u64 srcStrides[c_MaxTensorDimensions];
+        for (u32 dIdx = 0; dIdx < m_NumDimensions; ++dIdx)
+        {
+            if (1 != m_Shape[dIdx])
+            {
+                srcShape[numSrcDimensions] = m_Shape[dIdx];
+                srcStrides[numSrcDimensions] = m_Strides[dIdx];
+                ++numSrcDimensions;
+            }
+        }
+
+        // Walk both shapes, matching each run of new dimensions with a run of source dimensions that holds
+        // the same number of elements. A run of source dimensions can only be regrouped if it is contiguous
+        // within itself, the new strides are then derived from the stride of its innermost dimension.
+        u32 srcBegin = 0;
+        u32 dstBegin = 0;
+        while ((srcBegin < numSrcDimensions) && (dstBegin < numDimensions))
+        {
+            u32 srcEnd = srcBegin + 1;
+            u32 dstEnd = dstBegin + 1;
+            u64 srcLength = srcShape[srcBegin];
+            u64 dstLength = shape[dstBegin];
+
+            while (srcLength != dstLength)
+            {
+                if (dstLength < srcLength)
+                {
+                    dstLength *= shape[dstEnd++];
+                }
+                else
+                {
+                    srcLength *= srcShape[srcEnd++];
+                }
+            }
+
+            for (u32 dIdx = srcBegin; dIdx + 1 < srcEnd; ++dIdx)
+            {
+                if (srcStrides[dIdx] != (static_cast<u64>(srcShape[dIdx + 1]) * srcStrides[dIdx + 1]))
+                {
+                    return false;
+                }
+            }
+
+            reshaped.m_Strides[dstEnd - 1] = srcStrides[srcEnd - 1];
+            for (u32 dIdx = dstEnd - 1; dIdx > dstBegin; --dIdx)
+            {
+                reshaped.m_Strides[dIdx - 1] = reshaped.m_Strides[dIdx] * shape[dIdx];
+            }
+
+            srcBegin = srcEnd;
+            dstBegin = dstEnd;
+        }
+
+        // Any remaining new dimensions are of length 1
+        for (; dstBegin < numDimensions; ++dstBegin)
+        {
+            reshaped.m_Strides[dstBegin] = 1;
+        }
+
+        result = reshaped;
+        return true;
+    }
+
+    Tensor Tensor::Reshape(std::initializer_list<DimensionLength> const & shape) const
+    {
+        return Reshape(static_cast<u32>(shape.size()), shape.begin());
+    }
+
+    Tensor Tensor::Reshape(u32 numDimensions, DimensionLength const * shape) const
+    {
+        Tensor result;
+        bool const reshaped = TryReshape(numDimensions, shape, result);
+        ASSERTMSG(reshaped, "Tensor cannot be reshaped without copying, see Contiguous.");
+        (void)reshaped;
+        return result;
+    }
+
+    Tensor Tensor::Slice(u32 dimensionIndex, DimensionLength begin, DimensionLength end) const
+    {
+        ASSERTMSG(dimensionIndex < m_NumDimensions, "dimensionIndex is out of bounds.");
+        ASSERTMSG((begin <= end) && (end <= m_Shape[dimensionIndex]), "Slice is out of bounds.");
+
+        Tensor slice = *this;
+        slice.m_Offset += begin * m_Strides[dimensionIndex];
+        slice.m_Shape[dimensionIndex] = end - begin;
+        return slice;
+    }
+
+    Tensor Tensor::Transpose(u32 dimensionIndexA, u32 dimensionIndexB) const
+    {
+        ASSERTMSG((dimensionIndexA < m_NumDimensions) && (dimensionIndexB < m_NumDimensions), "dimensionIndex is out of bounds.");
+
+        Tensor transposed = *this;
+        transposed.m_Shape[dimensionIndexA] = m_Shape[dimensionIndexB];
+        transposed.m_Shape[dimensionIndexB] = m_Shape[dimensionIndexA];
+        transposed.m_Strides[dimensionIndexA] = m_Strides[dimensionIndexB];
+        transposed.m_Strides[dimensionIndexB] = m_Strides[dimensionIndexA];
+        return transposed;
+    }
+
+    Tensor Tensor::Permute(u32 const * order) const
+    {
+        Tensor permuted = *this;
+        u32 usedDimensions = 0;
+        for (u32 dIdx = 0; dIdx < m_NumDimensions; ++dIdx)
+        {
+            ASSERTMSG(order[dIdx] < m_NumDimensions, "order holds an out of bounds dimension index.");
+            ASSERTMSG(0 == (usedDimensions & (1u << order[dIdx])), "order holds a dimension index more than once.");
+            usedDimensions |= 1u << order[dIdx];
+
+            permuted.m_Shape[dIdx] = m_Shape[order[dIdx]];
+            permuted.m_Strides[dIdx] = m_Strides[order[dIdx]];
+        }
+        return permuted;
+    }
+
+    Tensor Tensor::Broadcast(std::initializer_list<DimensionLength> const & shape) const
+    {
+        return Broadcast(static_cast<u32>(shape.size()), shape.begin());
+    }
+
+    Tensor Tensor::Broadcast(u32 numDimensions, DimensionLength const * shape) const
+    {
+        ASSERTMSG(numDimensions <= c_MaxTensorDimensions, "Tensor has too many dimensions.");
+        ASSERTMSG(numDimensions >= m_NumDimensions, "Cannot broadcast a tensor to fewer dimensions.");
+
+        Tensor broadcast = *this;
+        broadcast.m_NumDimensions = numDimensions;
+
+        u32 const numNewDimensions = numDimensions - m_NumDimensions;
+        for (u32 dIdx = 0; dIdx < numDimensions; ++dIdx)
+        {
+            broadcast.m_Shape[dIdx] = shape[dIdx];
+
+            if (dIdx < numNewDimensions)
+            {
+                broadcast.m_Strides[dIdx] = 0;
+                continue;
+            }
+
+            u32 const srcIndex = dIdx - numNewDimensions;
+            if (m_Shape[srcIndex] == shape[dIdx])
+            {
+                broadcast.m_Strides[dIdx] = m_Strides[srcIndex];
+            }
+            else
+            {
+                ASSERTMSG(1 == m_Shape[srcIndex], "Only dimensions of length 1 can be broadcast.");
+                broadcast.m_Strides[dIdx] = 0;
+            }
+        }
+
+        return broadcast;
+    }
+
+    Tensor Tensor::Contiguous(Allocator & allocator) const
+    {
+        if (IsContiguous())
+        {
+            return *this;
+        }
+
+        Tensor copy(m_NumDimensions, m_Shape, allocator);
+        Copy(*this, copy);
+        return copy;
+    }
+
+    void Tensor::Copy(Tensor const & src, Tensor const & dst)
+    {
+        ASSERTMSG(src.m_NumDimensions == dst.m_NumDimensions, "Copy expects src & dst to have the same shape.");
+        for (u32 dIdx = 0; dIdx < src.m_NumDimensions; ++dIdx)
+        {
+            ASSERTMSG(src.m_Shape[dIdx] == dst.m_Shape[dIdx], "Copy expects src & dst to have the same shape.");
+        }
+
+        u64 const numElements = src.GetNumElements();
+        if (0 == numElements)
+        {
+            return;
+        }
+
+        if (src.IsContiguous() && dst.IsContiguous())
+        {
+            memcpy(dst.GetData(), src.GetData(), numElements * sizeof(f32));
+            return;
+        }
+
+        // The elements are copied along an inner dimension, for which the destination's unit stride
+        // dimension is preferred so the writes are sequential. If the source's unit stride dimension is a
+        // different one, the two inner dimensions are copied together as a blocked 2D transpose instead so
+        // both the reads & the writes are sequential.
+        u32 const numDimensions = src.m_NumDimensions;
+        u32 const srcInner = FindUnitStrideDimension(numDimensions, src.m_Shape, src.m_Strides);
+        u32 const dstInner = FindUnitStrideDimension(numDimensions, dst.m_Shape, dst.m_Strides);
+        bool const isTranspose = (srcInner < numDimensions) && (dstInner < numDimensions) && (srcInner != dstInner);
+        u32 const inner = (dstInner < numDimensions) ? dstInner : (numDimensions - 1);
+
+        // Every other dimension is walked like an odometer
+        u32 numOuterDimensions = 0;
+        DimensionLength outerShape[c_MaxTensorDimensions];
+        u64 outerSrcStrides[c_MaxTensorDimensions];
+        u64 outerDstStrides[c_MaxTensorDimensions];
+        u64 numOuterElements = 1;
+        for (u32 dIdx = 0; dIdx < numDimensions; ++dIdx)
+        {
+            if ((dIdx != inner) && (!isTranspose || (dIdx != srcInner)))
+            {
+                outerShape[numOuterDimensions] = src.m_Shape[dIdx];
+                outerSrcStrides[numOuterDimensions] = src.m_Strides[dIdx];
+                outerDstStrides[numOuterDimensions] = dst.m_Strides[dIdx];
+                numOuterElements *= src.m_Shape[dIdx];
+                ++numOuterDimensions;
+            }
+        }
+
+        DimensionLength const innerLength = src.m_Shape[inner];
+        u64 const innerSrcStride = src.m_Strides[inner];
+        u64 const innerDstStride = dst.m_Strides[inner];
+
+        u64 indices[c_MaxTensorDimensions] = {};
+        f32 const * srcBlock = src.GetData();
+        f32 * dstBlock = dst.GetData();
+
+        for (u64 oIdx = 0; oIdx < numOuterElements; ++oIdx)
+        {
+            if (isTranspose)
+            {
+                // A (innerLength x srcInnerLength) block of the source, with rows along the destination's unit
+                // stride dimension, becomes a (srcInnerLength x innerLength) block of the destination
+                DimensionLength const srcInnerLength = src.m_Shape[srcInner];
+                u64 const srcRowStride = innerSrcStride;
+                u64 const dstRowStride = dst.m_Strides[srcInner];
+
+                for (u32 rIdx = 0; rIdx < innerLength; rIdx += c_CopyBlockSize)
+                {
+                    u32 const numRows = std::min(c_CopyBlockSize, innerLength - rIdx);
+                    for (u32 cIdx = 0; cIdx < srcInnerLength; cIdx += c_CopyBlockSize)
+                    {
+                        u32 const numCols = std::min(c_CopyBlockSize, srcInnerLength - cIdx);
+                        kernels::Transpose(
+                            srcBlock + (rIdx * srcRowStride) + cIdx, srcRowStride, numRows, numCols,
+                            dstBlock + (cIdx * dstRowStride) + rIdx, dstRowStride
+                        );
+                    }
+                }
+            }
+            else
+            {
+                for (u32 eIdx = 0; eIdx < innerLength; ++eIdx)
+                {
+                    dstBlock[eIdx * innerDstStride] = srcBlock[eIdx * innerSrcStride];
+                }
+            }
+
+            for (u32 dIdx = numOuterDimensions; dIdx-- > 0;)
+            {
+                srcBlock += outerSrcStrides[dIdx];
+                dstBlock += outerDstStrides[dIdx];
+
+                if (++indices[dIdx] < outerShape[dIdx])
+                {
+                    break;
+                }
+
+                srcBlock -= indices[dIdx] * outerSrcStrides[dIdx];
+                dstBlock -= indices[dIdx] * outerDstStrides[dIdx];
+                indices[dIdx] = 0;
+            }
+        }
+    }
+
+    void Tensor::SetContiguousStrides()
+    {
+        u64 stride = 1;
+        for (u32 dIdx = m_NumDimensions; dIdx-- > 0;)
+        {
+            m_Strides[dIdx] = stride;
+            stride *= m_Shape[dIdx];
+        }
+    }
+}
@@ -0,0 +1,167 @@
+#pragma once
+
+#include "Common.h"
+#include "Core/Allocator.h"
+#include "Maths/Matrix.h"
+
+#include <initializer_list>
+#include <memory>
+
+namespace mia
+{
+    typedef u32 DimensionLength;
+
+    // The maximum number of dimensions a tensor can have.
+    u32 constexpr c_MaxTensorDimensions = 8;
+
+    // Represents an N-dimensional array of f32 data.
+    //
+    // A tensor is a view: a shape, a stride (in elements) per dimension & an offset into some storage.
+    // Element (i0, i1, ..., iN) lives at storage[offset + (i0 * stride0) + (i1 * stride1) + ... + (iN * strideN)].
+    // This lets reshapes, slices, transposes & broadcasts be expressed by changing the view alone, in O(1)
+    // & without touching the elements.
+    //
+    // The storage is either:
+    // - shared: allocated by the tensor from an Allocator & reference counted between every tensor viewing
+    //   it. It is released once the last of those tensors is destroyed.
+    // - borrowed: owned by the caller (see Borrow), who must keep it alive for as long as any tensor views it.
+    //
+    // Copying a tensor copies the view, never the elements (see Copy & Contiguous for that).
+    class Tensor final
+    {
+    public:
+        // Constructs an empty tensor with no dimensions.
+        Tensor();
+
+        // Constructs a contiguous, row-major tensor of the supplied shape with every element being 0.0f.
+        // e.g. { 4, 3, 2 } describes 4 slices of 3 rows of 2 elements.
+        explicit Tensor(std::initializer_list<DimensionLength> const & shape, Allocator & allocator = Allocator::GetDefault());
+        Tensor(u32 numDimensions, DimensionLength const * shape, Allocator & allocator = Allocator::GetDefault());
+
+        // Returns a contiguous, row-major view of the supplied caller-owned data. Nothing is copied.
+        static Tensor Borrow(f32 * data, std::initializer_list<DimensionLength> const & shape);
+        static Tensor Borrow(f32 * data, u32 numDimensions, DimensionLength const * shape);
+        // Returns a view of the supplied caller-owned data with the supplied strides (in elements).
+        static Tensor Borrow(f32 * data, u32 numDimensions, DimensionLength const * shape, u64 const * strides);
+        // Returns a (height x width) view of the elements of the supplied matrix. The view is invalidated
+        // if the matrix reallocates.
+        static Tensor Borrow(Matrix & matrix);
+
+        // Returns the number of dimensions of the tensor
+        u32 GetNumDimensions() const;
+        // Returns the length of the supplied dimension
+        DimensionLength GetLength(u32 dimensionIndex) const;
+        // Returns the distance, in elements, between consecutive indices of the supplied dimension
+        u64 GetStride(u32 dimensionIndex) const;
+        // Returns the total number of elements viewed by the tensor (the product of its lengths)
+        u64 GetNumElements() const;
+        // Returns true if the tensor doesn't view any elements
+        bool IsEmpty() const;
+
+        // Returns true if the elements are laid out row-major without any gaps, i.e. the tensor can be
+        // read as a flat array of GetNumElements elements starting at GetData.
+        bool IsContiguous() const;
+        // Returns true if the tensor views caller-owned storage (see Borrow).
+        bool IsBorrowed() const;
+        // Returns true if both tensors view the same storage.
+        bool SharesStorageWith(Tensor const & other) const;
+
+        // Returns a pointer to the first element of the view (i.e. the element at index 0 of every dimension)
+        f32 * GetData() const;
+
+        // Returns the element at the supplied indices, one per dimension
+        f32 & GetElement(std::initializer_list<u64> const & indices) const;
+        f32 & GetElement(u64 const * indices) const;
+
+        // Returns a view of the same elements with the supplied shape, which must hold the same number
+        // of elements. Always O(1) for contiguous tensors. Other tensors can only be reshaped without
+        // copying if each new dimension maps onto dimensions that can be collapsed together, returns
+        // false (leaving result untouched) if that isn't the case.
+        bool TryReshape(u32 numDimensions, DimensionLength const * shape, Tensor & result) const;
+        // Same as TryReshape but expects the reshape to be possible without copying.
+        Tensor Reshape(std::initializer_list<DimensionLength> const & shape) const;
+        Tensor Reshape(u32 numDimensions, DimensionLength const * shape) const;
+
+        // Returns a view of indices [begin, end) of the supplied dimension.
+        Tensor Slice(u32 dimensionIndex, DimensionLength begin, DimensionLength end) const;
+        // Returns a view with the supplied dimensions swapped.
+        Tensor Transpose(u32 dimensionIndexA, u32 dimensionIndexB) const;
+        // Returns a view with the dimensions reordered, dimension dIdx of the result is dimension
+        // order[dIdx] of the tensor. order must hold every dimension index exactly once.
+        Tensor Permute(u32 const * order) const;
+        // Returns a view of the tensor broadcast to the supplied shape, following the usual rules: the
+        // shapes are aligned on their last dimension & every dimension of the tensor must either match
+        // the new shape or be of length 1, in which case it is repeated (with a stride of 0). Missing
+        // leading dimensions are repeated too.
+        Tensor Broadcast(std::initializer_list<DimensionLength> const & shape) const;
+        Tensor Broadcast(u32 numDimensions, DimensionLength const * shape) const;
+
+        // Returns the tensor itself if it is contiguous, otherwise a contiguous copy of its elements
+        // allocated from the supplied allocator.
+        Tensor Contiguous(Allocator & allocator = Allocator::GetDefault()) const;
+
+        // Copies every element of src into the elements viewed by dst. Both must have the same shape,
+        // though their strides may differ (e.g. to copy into a transposed view). dst must not overlap src.
+        static void Copy(Tensor const & src, Tensor const & dst);
+
+    private:
+        // Computes the row-major strides of m_Shape.
+        void SetContiguousStrides();
+
+    private:
+        // The storage the view points into. nullptr for borrowed (or empty) tensors.
+        std::shared_ptr<f32> m_Storage;
+        // The start of the storage, from which m_Offset is applied.
+        f32 * m_Base;
+        u64 m_Offset;
+
+        u32 m_NumDimensions;
+        DimensionLength m_Shape[c_MaxTensorDimensions];
+        u64 m_Strides[c_MaxTensorDimensions];
+    };
+
+    inline u32 Tensor::GetNumDimensions() const
+    {
+        return m_NumDimensions;
+    }
+
+    inline DimensionLength Tensor::GetLength(u32 dimensionIndex) const
+    {
+        ASSERTMSG(dimensionIndex < m_NumDimensions, "dimensionIndex is out of bounds.");
+        return m_Shape[dimensionIndex];
+    }
+
+    inline u64 Tensor::GetStride(u32 dimensionIndex) const
+    {
+        ASSERTMSG(dimensionIndex < m_NumDimensions, "dimensionIndex is out of bounds.");
+        return m_Strides[dimensionIndex];
+    }
+
+    inline bool Tensor::IsBorrowed() const
+    {
+        return (nullptr == m_Storage) && (nullptr != m_Base);
+    }
+
+    inline f32 * Tensor::GetData() const
+    {
+        return (nullptr != m_Base) ? (m_Base + m_Offset) : nullptr;
+    }
+
+    inline f32 & Tensor::GetElement(std::initializer_list<u64> const & indices) const
+    {
+        ASSERTMSG(indices.size() == m_NumDimensions, "Expected one index per dimension.");
+        return GetElement(indices.begin());
+    }
+
+    inline f32 & Tensor::GetElement(u64 const * indices) const
+    {
+        u64 offset = m_Offset;
+        for (u32 dIdx = 0; dIdx < m_NumDimensions; ++dIdx)
+        {
+            ASSERTMSG(indices[dIdx] < m_Shape[dIdx], "index out of bounds!");
+            offset += indices[dIdx] * m_Strides[dIdx];
+        }
+
+        return m_Base[offset];
+    }
+}
@@ -0,0 +1,193 @@
+#include "Checkpointer.h"
+
+#include "Layers/Layer.h"
+
+#include <string.h>
+
+namespace mia
+{
+    namespace models
+    {
+        namespace
+        {
+            // Returns true if both layouts describe files of the same shape, i.e. every blob is at the same
+            // offset & has the same dimensions. The step counts may differ.
+            bool HaveSameShape(format::Layout const & a, format::Layout const & b)
+            {
+                format::FileHeader headerA = a.header;
+                format::FileHeader headerB = b.header;
+                headerA.numSteps = 0;
+                headerB.numSteps = 0;
+
+                return (0 == memcmp(&headerA, &headerB, sizeof(format::FileHeader))) &&
+                    (a.records.size() == b.records.size()) &&
+                    (0 == memcmp(a.records.data(), b.records.data(), a.records.size() * sizeof(format::LayerRecord)));
+            }
+        }
+
+        // The copy-on-write state of a layer of the checkpoint being written (see Checkpointer::BeginUpdate).
+        struct Checkpointer::LayerState
+        {
+            // The buffers the snapshot was left reading when the layer was updated, in the order of
+            // layers::Layer::SwapTrainingState. Reused as the storage of the copies by the next snapshot, so only
+            // the first copy allocates.
+            Matrix detachedMatrices[layers::Layer::c_NumTrainingStateMatrices];
+            // Whether the layer has already been detached from the snapshot by an update.
+            bool isDetached = false;
+            // Whether the layer has been updated since the last checkpoint began.
+            bool isChanged = false;
+        };
+
+        Checkpointer::Checkpointer()
+            : m_Layers(nullptr)
+            , m_NumLayers(0)
+            , m_IsIncremental(false)
+            , m_IsWritten(true)
+            , m_NumBytesWritten(0)
+            , m_IsSnapshotPending(false)
+            , m_HasWrittenFile(false)
+        {
+        }
+
+        Checkpointer::~Checkpointer()
+        {
+            Wait(nullptr);
+        }
+
+        void Checkpointer::Begin(char const * path, u32 numLayers, layers::Layer * const * layers, optimizers::OptimizerType optimizerType, u64 numSteps)
+        {
+            Wait(nullptr);
+
+            if (numLayers != m_NumLayers)
+            {
+                m_LayerStates.reset(new LayerState[numLayers]);
+                m_IsLayerChanged.reset(new bool[numLayers]);
+                m_HasWrittenFile = false;
+            }
+
+            m_Layers = layers;
+            m_NumLayers = numLayers;
+            m_Path = path;
+            m_NumBytesWritten = 0;
+
+            // The layout points at the layers' current buffers, which the snapshot reads
+            layers::Layer const * const * constLayers = layers;
+            if (!format::DescribeModel(numLayers, constLayers, optimizerType, numSteps, true, m_Layout))
+            {
+                m_IsWritten = false;
+                return;
+            }
+
+            // Only the layers that changed since the file was last written need writing again
+            m_IsIncremental = m_HasWrittenFile && (m_Path == m_WrittenPath) && HaveSameShape(m_Layout, m_WrittenLayout);
+            for (u32 layerIndex = 0; layerIndex < numLayers; ++layerIndex)
+            {
+                LayerState & state = m_LayerStates[layerIndex];
+                m_IsLayerChanged[layerIndex] = !m_IsIncremental || state.isChanged;
+                state.isChanged = false;
+                state.isDetached = false;
+            }
+
+            m_IsSnapshotPending.store(true, std::memory_order_release);
+            m_Thread = std::thread(&Checkpointer::Write, this);
+        }
+
+        bool Checkpointer::Wait(u64 * numBytesWritten)
+        {
+            if (m_Thread.joinable())
+            {
+                m_Thread.join();
+            }
+
+            if (nullptr != numBytesWritten)
+            {
+                *numBytesWritten = m_NumBytesWritten;
+            }
+
+            return m_IsWritten;
+        }
+
+        void Checkpointer::BeginUpdate(u32 layerIndex)
+        {
+            // Nothing has been checkpointed yet, the first checkpoint writes every layer
+            if (layerIndex >= m_NumLayers)
+            {
+                return;
+            }
+
+            LayerState & state = m_LayerStates[layerIndex];
+            state.isChanged = true;
+
+            // Never update the buffers the snapshot is still reading
+            if (state.isDetached || !m_IsSnapshotPending.load(std::memory_order_acquire))
+            {
+                return;
+            }
+
+            // The snapshot keeps the layer's current buffers, the layer carries on with copies of them held in the
+            // buffers detached by the previous snapshot (which ended before this one began)
+            layers::Layer & layer = *m_Layers[layerIndex];
+            Matrix const * current[layers::Layer::c_NumTrainingStateMatrices];
+            u32 mIdx = 0;
+            current[mIdx++] = &layer.GetWeights();
+            current[mIdx++] = &layer.GetBiases();
+            for (u32 sIdx = 0; sIdx < optimizers::c_MaxNumStateBuffers; ++sIdx)
+            {
+                current[mIdx++] = &layer.GetWeightsOptimizerState(sIdx);
+                current[mIdx++] = &layer.GetBiasesOptimizerState(sIdx);
+            }
+
+            for (mIdx = 0; mIdx < layers::Layer::c_NumTrainingStateMatrices; ++mIdx)
+            {
+                // The first copy comes from the same allocator as the parameters
+                Matrix & copy = state.detachedMatrices[mIdx];
+                if (0 == copy.GetCapacity())
+                {
+                    copy = Matrix(current[mIdx]->GetAllocator());
+                }
+                copy = *current[mIdx];
+            }
+
+            layer.SwapTrainingState(state.detachedMatrices);
+            state.isDetached = true;
+        }
+
+        void Checkpointer::Reset()
+        {
+            Wait(nullptr);
+            m_HasWrittenFile = false;
+        }
+
+        void Checkpointer::Write()
+        {
+            if (m_IsIncremental)
+            {
+                m_IsWritten = format::UpdateFile(m_Path.c_str(), m_Layout, m_IsLayerChanged.get());
+            }
+            else
+            {
+                m_IsWritten = format::WriteFile(m_Path.c_str(), m_Layout);
+            }
+
+            // Orders the snapshot's reads before any update that observes it has ended
+            m_IsSnapshotPending.store(false, std::memory_order_release);
+
+            for (u64 bIdx = 0; bIdx < m_Layout.blobs.size(); ++bIdx)
+            {
+                format::Blob const & blob = m_Layout.blobs[bIdx];
+                if (m_IsLayerChanged[blob.layerIndex])
+                {
+                    m_NumBytesWritten += blob.numElements * sizeof(f32);
+                }
+            }
+
+            // A file that failed to be written (even partially) is written whole by the next checkpoint
+            m_HasWrittenFile = m_IsWritten;
+            if (m_IsWritten)
+            {
+                m_WrittenPath = m_Path;
+                std::swap(m_WrittenLayout, m_Layout);
+            }
+        }
+    }
+}
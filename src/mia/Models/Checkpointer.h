@@ -0,0 +1,91 @@
+#pragma once
+
+#include "Common.h"
+#include "Models/ModelFormat.h"
+#include "Optimizers/Optimizer.h"
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+
+namespace mia
+{
+    namespace layers
+    {
+        class Layer;
+    }
+
+    namespace models
+    {
+        // Writes checkpoints of the training state of a model (its parameters, optimizer state & step count) in
+        // the model file format (see Models/ModelFormat.h) on a background thread, so training carries on while
+        // a checkpoint is written.
+        //
+        // Nothing is copied when a checkpoint begins: each layer's parameters are snapshotted copy-on-write (see
+        // BeginUpdate), so a layer is only copied if training updates it before it has been written.
+        //
+        // Checkpoints are incremental: when a checkpoint is written to the same file as the previous one & the
+        // model's shape hasn't changed, only the layers that were updated since then are rewritten, the others
+        // are copied over from the previous file.
+        // The previous file is only replaced once the new one has been completely written (see
+        // format::UpdateFile), so a checkpoint interrupted by a crash leaves the previous one to resume from.
+        class Checkpointer final
+        {
+        public:
+            Checkpointer();
+            Checkpointer(Checkpointer const & other) = delete;
+            Checkpointer(Checkpointer && other) = delete;
+            ~Checkpointer();
+
+            // Waits for the previous checkpoint (if any) to be written, snapshots the supplied layers & starts
+            // writing them to path. The layers must stay alive & must only be modified after BeginUpdate until
+            // the checkpoint has been written (see Wait).
+            void Begin(char const * path, u32 numLayers, layers::Layer * const * layers, optimizers::OptimizerType optimizerType, u64 numSteps);
+
+            // Must be called before the parameters or optimizer state of the supplied layer (of those passed to
+            // Begin) are updated, e.g. by layers::Layer::ApplyGradients. If the checkpoint being written still
+            // reads them, it is left with them & the layer carries on with copies (copy-on-write). Either way the
+            // layer is rewritten by the next checkpoint.
+            void BeginUpdate(u32 layerIndex);
+
+            // Waits for the checkpoint being written (if any) & returns true if the last checkpoint was written
+            // successfully. numBytesWritten, if not nullptr, receives the number of bytes of parameters it wrote.
+            bool Wait(u64 * numBytesWritten);
+
+            // Forgets what has been written, so the next checkpoint writes the whole file. Must be called when
+            // the layers are modified other than by training (e.g. recompiled).
+            void Reset();
+
+        private:
+            struct LayerState;
+
+            // Writes the pending checkpoint, runs on m_Thread.
+            void Write();
+
+        private:
+            std::thread m_Thread;
+
+            // The checkpoint being written (or last written)
+            layers::Layer * const * m_Layers;
+            u32 m_NumLayers;
+            std::string m_Path;
+            format::Layout m_Layout;
+            std::unique_ptr<bool[]> m_IsLayerChanged;
+            bool m_IsIncremental;
+            bool m_IsWritten;
+            u64 m_NumBytesWritten;
+            // Whether m_Thread is still reading the layers' buffers, cleared once the checkpoint has been written.
+            std::atomic<bool> m_IsSnapshotPending;
+
+            // The copy-on-write state of each layer & whether it changed since the last checkpoint began.
+            std::unique_ptr<LayerState[]> m_LayerStates;
+
+            // What the file at m_WrittenPath holds, if m_HasWrittenFile. Only the layers updated since it began
+            // are written by the next checkpoint to the same file.
+            bool m_HasWrittenFile;
+            std::string m_WrittenPath;
+            format::Layout m_WrittenLayout;
+        };
+    }
+}
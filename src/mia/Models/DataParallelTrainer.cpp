@@ -0,0 +1,281 @@
+#include "DataParallelTrainer.h"
+
+#include "Core/ThreadPool.h"
+#include "Layers/Layer.h"
+#include "Layers/Gradients.h"
+#include "Layers/Flatten.h"
+#include "Layers/Dense.h"
+
+#include <algorithm>
+#include <atomic>
+#include <utility>
+
+namespace mia
+{
+    namespace models
+    {
+        namespace
+        {
+            // The fewest gradients a thread reduces at once, enough to amortise handing the range to the thread.
+            u64 constexpr c_MinReduceChunkSize = 16 * 1024;
+
+            // Restores replica with views of the supplied layer's parameters, & of their packed copy if
+            // isViewingPackedWeights (otherwise the replica packs its own copy).
+            void ViewParameters(layers::Layer const & layer, layers::Layer & replica, bool isViewingPackedWeights)
+            {
+                Matrix const & weights = layer.GetWeights();
+                Matrix const & biases = layer.GetBiases();
+                gemm::PackedOperand const & packedWeightsOperand = layer.GetPackedWeights();
+                ASSERTMSG(weights.GetCapacity() > 0, "A layer whose weights have been released can't be trained.");
+
+                // Synchronous replicas only ever read the parameters, Hogwild! replicas also update them in place
+                Matrix packedWeights;
+                if (isViewingPackedWeights && (nullptr != packedWeightsOperand.data))
+                {
+                    u64 const packedSize = gemm::GetPackedSize(weights.GetHeight(), weights.GetWidth());
+                    packedWeights = Matrix::View(1, static_cast<u32>(packedSize), const_cast<f32 *>(packedWeightsOperand.data));
+                }
+
+                replica.Restore(Matrix::View(weights.GetWidth(), weights.GetHeight(), const_cast<f32 *>(weights.GetData())),
+                    Matrix::View(biases.GetWidth(), biases.GetHeight(), const_cast<f32 *>(biases.GetData())),
+                    std::move(packedWeights), isViewingPackedWeights ? packedWeightsOperand : gemm::PackedOperand());
+            }
+
+            // Creates a layer of the same class & shape as the supplied one, whose parameters view the layer's
+            // (see ViewParameters).
+            layers::Layer * CreateReplicaLayer(layers::Layer const & layer, bool isViewingPackedWeights)
+            {
+                switch (layer.GetClass())
+                {
+                    case layers::LayerClass::Flatten:
+                    {
+                        layers::Flatten const & flatten = static_cast<layers::Flatten const &>(layer);
+                        layers::Flatten * const replica = new layers::Flatten(flatten.GetInputNumDimensions(), flatten.GetInputDimensionLengths(), layer.GetActivatorType());
+                        replica->Compile(0, nullptr);
+                        return replica;
+                    }
+
+                    case layers::LayerClass::Dense:
+                    {
+                        layers::Dense * const replica = new layers::Dense(layer.GetNumNeurons(), layer.GetActivatorType());
+                        ViewParameters(layer, *replica, isViewingPackedWeights);
+                        return replica;
+                    }
+
+                    default:
+                        ASSERTMSG(false, "DataParallelTrainer doesn't support this class of layer.");
+                        return nullptr;
+                }
+            }
+        }
+
+        DataParallelTrainer::DataParallelTrainer(Sequential & model, u32 maxBatchSize, u32 numWorkers, TrainingMode mode)
+            : m_Model(model)
+            , m_Mode(mode)
+            , m_NumWorkers((0 == numWorkers) ? ThreadPool::Get().GetNumThreads() : numWorkers)
+            , m_MaxShardSize(0)
+            , m_NumParameters(0)
+            , m_Replicas()
+            , m_WorkerLayers()
+            , m_Scales()
+            , m_Losses()
+        {
+            ASSERTMSG(m_Model.GetNumLayers() > 0, "Sequential Model cannot have zero layers.");
+            ASSERTMSG(maxBatchSize > 0, "maxBatchSize must be greater than zero.");
+
+            // Synchronous shards differ in size by at most a sample, Hogwild! workers train on whole mini-batches
+            m_MaxShardSize = (TrainingMode::Hogwild == m_Mode) ? maxBatchSize : ((maxBatchSize + m_NumWorkers - 1) / m_NumWorkers);
+
+            // Hogwild! workers each pack the weights they read after every update they make, rather than
+            // repacking the model's copy while the other workers read it
+            bool const isViewingPackedWeights = (TrainingMode::Synchronous == m_Mode);
+
+            for (u32 wIdx = 1; wIdx < m_NumWorkers; ++wIdx)
+            {
+                layers::Layer * replicaLayers[c_MaxNumLayers];
+                for (u32 layerIndex = 0; layerIndex < m_Model.GetNumLayers(); ++layerIndex)
+                {
+                    replicaLayers[layerIndex] = CreateReplicaLayer(*GetLayer(m_Model, layerIndex), isViewingPackedWeights);
+                    replicaLayers[layerIndex]->Reserve(m_MaxShardSize);
+                }
+
+                m_Replicas.emplace_back(new Sequential(m_Model.GetNumLayers(), replicaLayers));
+            }
+
+            m_WorkerLayers.resize(m_Model.GetNumLayers());
+            for (u32 layerIndex = 0; layerIndex < m_Model.GetNumLayers(); ++layerIndex)
+            {
+                m_WorkerLayers[layerIndex].push_back(GetLayer(m_Model, layerIndex));
+                for (u32 rIdx = 0; rIdx < m_Replicas.size(); ++rIdx)
+                {
+                    m_WorkerLayers[layerIndex].push_back(GetLayer(*m_Replicas[rIdx], layerIndex));
+                }
+
+                m_NumParameters += (layerIndex > 0) ? GetLayer(m_Model, layerIndex)->GetNumParameters() : 0;
+            }
+
+            m_Scales.resize(m_NumWorkers);
+            m_Losses.resize(m_NumWorkers);
+        }
+
+        void DataParallelTrainer::Train(Tensor const & inputData, Tensor const & expectedOutput)
+        {
+            ASSERTMSG((1 == expectedOutput.GetNumDimensions()) || (2 == expectedOutput.GetNumDimensions()), "Sequential Model expects the expectedOutput to hold a single dimension per sample.");
+
+            u32 const numSamples = inputData.GetLength(0);
+            ASSERTMSG(numSamples > 0, "Supplied input data doesn't contain any samples.");
+
+            Tensor const expectedValues = expectedOutput.Contiguous();
+            u64 const numOutputs = expectedValues.GetNumElements() / numSamples;
+            ASSERTMSG((numOutputs * numSamples) == expectedValues.GetNumElements(), "expectedOutput doesn't hold the same number of values for every sample.");
+
+            if (TrainingMode::Hogwild == m_Mode)
+            {
+                TrainHogwild(inputData, expectedValues.GetData(), numOutputs);
+            }
+            else
+            {
+                TrainSynchronously(inputData, expectedValues.GetData(), numOutputs);
+            }
+        }
+
+        void DataParallelTrainer::TrainSynchronously(Tensor const & inputData, f32 const * expectedValues, u64 numOutputs)
+        {
+            // The shards are slices of the batch's sample dimension
+            u32 const batchSize = inputData.GetLength(0);
+            u32 const numShards = std::min(m_NumWorkers, batchSize);
+
+            SyncReplicas();
+
+            // Each worker computes the gradients of the mean loss over its own shard
+            ThreadPool::Get().ParallelFor(numShards, 1, [&](u64 begin, u64 end)
+            {
+                for (u64 sIdx = begin; sIdx < end; ++sIdx)
+                {
+                    u32 const firstSample = static_cast<u32>((static_cast<u64>(batchSize) * sIdx) / numShards);
+                    u32 const lastSample = static_cast<u32>((static_cast<u64>(batchSize) * (sIdx + 1)) / numShards);
+                    Sequential & worker = (0 == sIdx) ? m_Model : *m_Replicas[sIdx - 1];
+                    ComputeGradients(worker, inputData.Slice(0, firstSample, lastSample), expectedValues + (firstSample * numOutputs), (lastSample - firstSample) * numOutputs);
+                }
+            });
+
+            // The mean over the batch weighs each shard's mean by the shard's share of the samples
+            f32 loss = 0.0f;
+            for (u32 sIdx = 0; sIdx < numShards; ++sIdx)
+            {
+                u32 const firstSample = static_cast<u32>((static_cast<u64>(batchSize) * sIdx) / numShards);
+                u32 const lastSample = static_cast<u32>((static_cast<u64>(batchSize) * (sIdx + 1)) / numShards);
+                m_Scales[sIdx] = static_cast<f32>(lastSample - firstSample) / static_cast<f32>(batchSize);
+
+                Sequential const & worker = (0 == sIdx) ? m_Model : *m_Replicas[sIdx - 1];
+                loss += m_Scales[sIdx] * worker.GetLoss();
+            }
+
+            // All-reduce the gradients into the model's layers, each thread summing its own ranges of every layer's
+            // parameters across the workers. A single shard's gradients are already those of the whole batch.
+            if (numShards > 1)
+            {
+                ThreadPool::Get().ParallelFor(m_NumParameters, c_MinReduceChunkSize, [&](u64 begin, u64 end)
+                {
+                    u64 offset = 0;
+                    for (u32 layerIndex = 1; (layerIndex < m_Model.GetNumLayers()) && (offset < end); ++layerIndex)
+                    {
+                        layers::Layer * layer = GetLayer(m_Model, layerIndex);
+                        u64 const numParameters = layer->GetNumParameters();
+                        u64 const rangeBegin = std::max(begin, offset);
+                        u64 const rangeEnd = std::min(end, offset + numParameters);
+                        if (rangeBegin < rangeEnd)
+                        {
+                            layers::ReduceGradients(*layer, numShards, m_WorkerLayers[layerIndex].data(), m_Scales.data(), rangeBegin - offset, rangeEnd - offset);
+                        }
+
+                        offset += numParameters;
+                    }
+                });
+            }
+
+            ApplyGradients(m_Model, loss);
+        }
+
+        void DataParallelTrainer::TrainHogwild(Tensor const & inputData, f32 const * expectedValues, u64 numOutputs)
+        {
+            ASSERTMSG(optimizers::OptimizerType::SGD == GetOptimizer(m_Model).type, "Hogwild! training only supports SGD.");
+
+            u32 const numSamples = inputData.GetLength(0);
+            u32 const numBatches = (numSamples + m_MaxShardSize - 1) / m_MaxShardSize;
+            u64 const firstStepIndex = GetNumSteps(m_Model) + 1;
+
+            // The workers update the model's parameters in place, so any checkpoint still reading them has to be
+            // left with them before the replicas view them
+            for (u32 layerIndex = 1; layerIndex < m_Model.GetNumLayers(); ++layerIndex)
+            {
+                BeginUpdate(m_Model, layerIndex);
+            }
+
+            SyncReplicas();
+
+            // Each worker claims the next mini-batch as soon as it has stepped the parameters with the last one's
+            // gradients, the counter is the only state the workers share besides the parameters
+            std::atomic<u32> nextBatchIndex(0);
+            ThreadPool::Get().ParallelFor(m_NumWorkers, 1, [&](u64 begin, u64 end)
+            {
+                for (u64 wIdx = begin; wIdx < end; ++wIdx)
+                {
+                    Sequential & worker = (0 == wIdx) ? m_Model : *m_Replicas[wIdx - 1];
+                    f32 loss = 0.0f;
+
+                    for (u32 bIdx = nextBatchIndex.fetch_add(1, std::memory_order_relaxed); bIdx < numBatches; bIdx = nextBatchIndex.fetch_add(1, std::memory_order_relaxed))
+                    {
+                        u32 const firstSample = bIdx * m_MaxShardSize;
+                        u32 const lastSample = std::min(numSamples, firstSample + m_MaxShardSize);
+                        ComputeGradients(worker, inputData.Slice(0, firstSample, lastSample), expectedValues + (firstSample * numOutputs), (lastSample - firstSample) * numOutputs);
+                        loss += worker.GetLoss() * static_cast<f32>(lastSample - firstSample);
+
+                        for (u32 layerIndex = 1; layerIndex < worker.GetNumLayers(); ++layerIndex)
+                        {
+                            GetLayer(worker, layerIndex)->ApplyGradients(GetOptimizer(m_Model), firstStepIndex + bIdx);
+                        }
+                    }
+
+                    m_Losses[wIdx] = loss;
+                }
+            });
+
+            f32 loss = 0.0f;
+            for (u32 wIdx = 0; wIdx < m_NumWorkers; ++wIdx)
+            {
+                loss += m_Losses[wIdx];
+            }
+
+            // The model's packed weights only include its own worker's updates
+            for (u32 layerIndex = 1; layerIndex < m_Model.GetNumLayers(); ++layerIndex)
+            {
+                GetLayer(m_Model, layerIndex)->PackWeights();
+            }
+
+            EndUpdates(m_Model, numBatches, loss / static_cast<f32>(numSamples));
+        }
+
+        void DataParallelTrainer::SyncReplicas()
+        {
+            for (u32 layerIndex = 1; layerIndex < m_Model.GetNumLayers(); ++layerIndex)
+            {
+                layers::Layer const & layer = *GetLayer(m_Model, layerIndex);
+                for (u32 rIdx = 0; rIdx < m_Replicas.size(); ++rIdx)
+                {
+                    layers::Layer & replica = *GetLayer(*m_Replicas[rIdx], layerIndex);
+                    bool const isViewingPackedWeights = (TrainingMode::Synchronous == m_Mode);
+                    bool const isViewingLayer = (replica.GetWeights().GetData() == layer.GetWeights().GetData()) &&
+                        (replica.GetBiases().GetData() == layer.GetBiases().GetData()) &&
+                        (!isViewingPackedWeights || (replica.GetPackedWeights().data == layer.GetPackedWeights().data));
+
+                    if (!isViewingLayer)
+                    {
+                        ViewParameters(layer, replica, isViewingPackedWeights);
+                        replica.Reserve(m_MaxShardSize);
+                    }
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,108 @@
+#pragma once
+
+#include "Models/Trainer.h"
+
+#include <memory>
+#include <vector>
+
+namespace mia
+{
+    namespace models
+    {
+        // How the workers of a DataParallelTrainer combine their updates of the parameters.
+        enum class TrainingMode : u8
+        {
+            // The workers' gradients are all-reduced & the parameters are updated once per batch.
+            Synchronous,
+            // Hogwild!: every worker updates the parameters with its own gradients as soon as it has computed
+            // them, without locks & without waiting for the other workers.
+            Hogwild
+        };
+
+        // Trains a Sequential model across several threads (see ThreadPool) by data parallelism. Each training
+        // step splits the batch into one shard per worker: every worker runs the forward & backward passes over
+        // its shard with its own replica of the model, then the gradients of the replicas are all-reduced & the
+        // optimizer steps the parameters once. The result is the same step as Sequential::Train over the whole
+        // batch (up to the order in which the gradients are summed).
+        //
+        // The replicas' layers view the parameters of the model rather than copying them, so a replica only
+        // costs the activations & gradients of its shard & the parameters never have to be broadcast after an
+        // update. The all-reduce is a reduce-scatter over shared memory: the parameters are split into disjoint
+        // ranges & each thread sums every replica's gradients over its own ranges, so no locks or atomics are
+        // needed & every gradient is read exactly once.
+        //
+        // Each worker runs its shard's matrix multiplications on its own thread, so there should be as many
+        // workers as threads in the pool (the default) & each shard should hold enough samples to keep a thread
+        // busy. The optimizer step itself isn't split across threads.
+        //
+        // In TrainingMode::Hogwild the workers instead take turns claiming mini-batches of the supplied data &
+        // each steps the parameters with its own mini-batch's gradients, so no worker ever waits for another
+        // until the data runs out. The workers read & write the parameters without synchronisation, which
+        // Hogwild! tolerates: each f32 is naturally aligned so is read & written whole, a worker may only see
+        // a mix of old & new parameters or lose an update to a concurrent one. The result depends on how the
+        // threads interleave, so isn't reproducible. Only SGD is supported, as the state of other optimizers
+        // (e.g. Adam's moments) would be shared between workers the same way.
+        class DataParallelTrainer final : private Trainer
+        {
+        public:
+            DataParallelTrainer() = delete;
+            DataParallelTrainer(DataParallelTrainer const & other) = delete;
+            ~DataParallelTrainer() = default;
+
+            // Replicates the supplied model, which must have been compiled (or resumed) & must outlive the
+            // trainer, across numWorkers workers. Zero uses one worker per thread of the ThreadPool. The replicas
+            // are reserved for batches of up to maxBatchSize samples, which in TrainingMode::Hogwild is the size
+            // of every worker's mini-batches.
+            DataParallelTrainer(Sequential & model, u32 maxBatchSize, u32 numWorkers = 0, TrainingMode mode = TrainingMode::Synchronous);
+
+            // Runs a single step of mini-batch gradient descent over the supplied batch, like Sequential::Train.
+            // In TrainingMode::Hogwild, runs a step per mini-batch of maxBatchSize consecutive samples of the
+            // supplied data instead (e.g. of a whole epoch), spread across the workers. Either way, the model's
+            // loss (see Sequential::GetLoss) is the mean over every sample supplied.
+            void Train(Tensor const & inputData, Tensor const & expectedOutput);
+
+            // Returns the number of workers each batch is split across.
+            u32 GetNumWorkers() const;
+            // Returns how the workers combine their updates.
+            TrainingMode GetMode() const;
+
+        private:
+            // Train in each mode. expectedValues holds numOutputs values per sample of inputData.
+            void TrainSynchronously(Tensor const & inputData, f32 const * expectedValues, u64 numOutputs);
+            void TrainHogwild(Tensor const & inputData, f32 const * expectedValues, u64 numOutputs);
+
+            // Points the replicas' layers at the model's current parameters, which the model may have moved
+            // since the last step (e.g. to leave a checkpoint reading the previous ones, see Checkpointer::BeginUpdate).
+            void SyncReplicas();
+
+        private:
+            Sequential & m_Model;
+            TrainingMode m_Mode;
+            u32 m_NumWorkers;
+            // The most samples a worker trains on at once.
+            u32 m_MaxShardSize;
+            // The number of parameters of every layer of the model, which the all-reduce is split over.
+            u64 m_NumParameters;
+
+            // The models run by workers 1 onwards, worker 0 runs the model itself.
+            std::vector<std::unique_ptr<Sequential>> m_Replicas;
+
+            // Per layer, the layer of every worker's model, in the order of the workers.
+            std::vector<std::vector<layers::Layer const *>> m_WorkerLayers;
+            // The weight of each shard's gradients in those of the whole batch.
+            std::vector<f32> m_Scales;
+            // The sum of each worker's losses over the samples it trained on, in TrainingMode::Hogwild.
+            std::vector<f32> m_Losses;
+        };
+
+        inline u32 DataParallelTrainer::GetNumWorkers() const
+        {
+            return m_NumWorkers;
+        }
+
+        inline TrainingMode DataParallelTrainer::GetMode() const
+        {
+            return m_Mode;
+        }
+    }
+}
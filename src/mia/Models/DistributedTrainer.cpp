@@ -0,0 +1,170 @@
+#include "DistributedTrainer.h"
+
+#include "Layers/Layer.h"
+#include "Layers/Gradients.h"
+#include "Kernels/Kernels.h"
+
+namespace mia
+{
+    namespace models
+    {
+        DistributedTrainer::DistributedTrainer(Sequential & model, distributed::Transport & transport)
+            : m_Model(model)
+            , m_Transport(transport)
+            , m_BucketOffsets()
+            , m_BucketSizes()
+            , m_Buckets()
+            , m_Scale(1.0f)
+            , m_Mutex()
+            , m_ReadyCondition()
+            , m_ReducedCondition()
+            , m_NumReadyBuckets(0)
+            , m_NumReducedBuckets(0)
+            , m_IsStopping(false)
+            , m_IsBroken(false)
+            , m_Thread()
+        {
+            ASSERTMSG(m_Model.GetNumLayers() > 1, "Sequential Model must have a layer to train after the input layer.");
+
+            u64 numValues = 0;
+            m_BucketOffsets.resize(m_Model.GetNumLayers());
+            m_BucketSizes.resize(m_Model.GetNumLayers());
+            for (u32 layerIndex = 1; layerIndex < m_Model.GetNumLayers(); ++layerIndex)
+            {
+                bool const isOutputLayer = ((m_Model.GetNumLayers() - 1) == layerIndex);
+                m_BucketOffsets[layerIndex] = numValues;
+                m_BucketSizes[layerIndex] = GetLayer(m_Model, layerIndex)->GetNumParameters() + (isOutputLayer ? 1 : 0);
+                numValues += m_BucketSizes[layerIndex];
+            }
+            m_Buckets.resize(numValues);
+
+            m_Thread = std::thread(&DistributedTrainer::ReduceBuckets, this);
+        }
+
+        DistributedTrainer::~DistributedTrainer()
+        {
+            {
+                std::lock_guard<std::mutex> lock(m_Mutex);
+                m_IsStopping = true;
+            }
+            m_ReadyCondition.notify_one();
+            m_Thread.join();
+        }
+
+        bool DistributedTrainer::Train(Tensor const & inputData, Tensor const & expectedOutput)
+        {
+            ASSERTMSG((1 == expectedOutput.GetNumDimensions()) || (2 == expectedOutput.GetNumDimensions()), "Sequential Model expects the expectedOutput to hold a single dimension per sample.");
+
+            u32 const numRanks = m_Transport.GetNumRanks();
+            u32 const rank = m_Transport.GetRank();
+            u32 const batchSize = inputData.GetLength(0);
+            ASSERTMSG(batchSize >= numRanks, "The batch must hold at least a sample per rank.");
+
+            Tensor const expectedValues = expectedOutput.Contiguous();
+            u64 const numOutputs = expectedValues.GetNumElements() / batchSize;
+            ASSERTMSG((numOutputs * batchSize) == expectedValues.GetNumElements(), "expectedOutput doesn't hold the same number of values for every sample.");
+
+            // The shards are slices of the batch's sample dimension, like those of DataParallelTrainer
+            u32 const firstSample = static_cast<u32>((static_cast<u64>(batchSize) * rank) / numRanks);
+            u32 const lastSample = static_cast<u32>((static_cast<u64>(batchSize) * (rank + 1)) / numRanks);
+            m_Scale = static_cast<f32>(lastSample - firstSample) / static_cast<f32>(batchSize);
+
+            // The background thread is idle between steps
+            {
+                std::lock_guard<std::mutex> lock(m_Mutex);
+                if (m_IsBroken)
+                {
+                    return false;
+                }
+
+                m_NumReadyBuckets = 0;
+                m_NumReducedBuckets = 0;
+            }
+
+            ComputeGradients(m_Model, inputData.Slice(0, firstSample, lastSample), expectedValues.GetData() + (firstSample * numOutputs), (lastSample - firstSample) * numOutputs, &DistributedTrainer::OnGradientsReady, this);
+
+            {
+                std::unique_lock<std::mutex> lock(m_Mutex);
+                m_ReducedCondition.wait(lock, [this]() { return (m_Model.GetNumLayers() - 1) == m_NumReducedBuckets; });
+                if (m_IsBroken)
+                {
+                    return false;
+                }
+            }
+
+            // The loss was all-reduced along with the output layer's gradients
+            u32 const outputLayerIndex = m_Model.GetNumLayers() - 1;
+            ApplyGradients(m_Model, m_Buckets[m_BucketOffsets[outputLayerIndex] + m_BucketSizes[outputLayerIndex] - 1]);
+            return true;
+        }
+
+        void DistributedTrainer::OnGradientsReady(void * context, u32 layerIndex)
+        {
+            DistributedTrainer & trainer = *static_cast<DistributedTrainer *>(context);
+            {
+                std::lock_guard<std::mutex> lock(trainer.m_Mutex);
+                // The buckets of every layer from the output layer down to this one are ready
+                u32 const numReadyBuckets = trainer.m_Model.GetNumLayers() - layerIndex;
+                ASSERTMSG(numReadyBuckets == (trainer.m_NumReadyBuckets + 1), "Gradients must become ready from the output layer backwards.");
+                trainer.m_NumReadyBuckets = numReadyBuckets;
+            }
+            trainer.m_ReadyCondition.notify_one();
+        }
+
+        void DistributedTrainer::ReduceBuckets()
+        {
+            for (;;)
+            {
+                u32 layerIndex = 0;
+                bool isBroken = false;
+                {
+                    std::unique_lock<std::mutex> lock(m_Mutex);
+                    m_ReadyCondition.wait(lock, [this]() { return m_IsStopping || (m_NumReducedBuckets < m_NumReadyBuckets); });
+                    if (m_IsStopping)
+                    {
+                        return;
+                    }
+
+                    layerIndex = m_Model.GetNumLayers() - 1 - m_NumReducedBuckets;
+                    isBroken = m_IsBroken;
+                }
+
+                // Every rank all-reduces the same buckets in the same order, once one fails the rest are skipped
+                bool const isReduced = !isBroken && ReduceBucket(layerIndex);
+
+                {
+                    std::lock_guard<std::mutex> lock(m_Mutex);
+                    m_IsBroken = !isReduced;
+                    ++m_NumReducedBuckets;
+                }
+                m_ReducedCondition.notify_one();
+            }
+        }
+
+        bool DistributedTrainer::ReduceBucket(u32 layerIndex)
+        {
+            // Backpropagation no longer touches this layer's gradients, only the earlier layers'
+            layers::Layer * layer = GetLayer(m_Model, layerIndex);
+            Matrix const & weightGradients = layer->GetWeightGradients();
+            Matrix const & biasGradients = layer->GetBiasGradients();
+
+            // Scaling each shard's mean by its share of the samples makes the sum the mean over the whole batch
+            f32 * bucket = m_Buckets.data() + m_BucketOffsets[layerIndex];
+            f32 * biasesBucket = bucket + weightGradients.GetCapacity();
+            kernels::Scale(weightGradients.GetData(), m_Scale, bucket, weightGradients.GetCapacity());
+            kernels::Scale(biasGradients.GetData(), m_Scale, biasesBucket, biasGradients.GetCapacity());
+            if ((m_Model.GetNumLayers() - 1) == layerIndex)
+            {
+                biasesBucket[biasGradients.GetCapacity()] = m_Scale * m_Model.GetLoss();
+            }
+
+            if (!m_Transport.AllReduce(bucket, m_BucketSizes[layerIndex]))
+            {
+                return false;
+            }
+
+            layers::SetGradients(*layer, bucket, biasesBucket);
+            return true;
+        }
+    }
+}
@@ -0,0 +1,81 @@
+#pragma once
+
+#include "Models/Trainer.h"
+#include "Distributed/Transport.h"
+
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace mia
+{
+    namespace models
+    {
+        // Trains a Sequential model across several processes (ranks) by data parallelism, e.g. to use more cores
+        // than a single process' ThreadPool scales to. Every rank holds a replica of the model, compiled with
+        // the same seed so the replicas start out identical, & is given the same batches. Each rank runs the
+        // forward & backward passes over its own shard of the batch, the shards' gradients are all-reduced
+        // through a distributed::Transport & then every rank makes the same update. The replicas therefore stay
+        // identical & each step is the same as Sequential::Train over the whole batch (up to the order in which
+        // the gradients are summed).
+        //
+        // The all-reduce overlaps the backward pass: each layer's gradients form a bucket that is all-reduced on a
+        // background thread as soon as backpropagation has computed them, while backpropagation carries on with
+        // the earlier layers. The buckets are all-reduced in the reverse order of the layers, which is the same on
+        // every rank, so only the first layer's bucket is left to all-reduce once the backward pass has finished.
+        class DistributedTrainer final : private Trainer
+        {
+        public:
+            DistributedTrainer() = delete;
+            DistributedTrainer(DistributedTrainer const & other) = delete;
+            ~DistributedTrainer();
+
+            // Trains the supplied model, which must have been compiled (or resumed), through the supplied
+            // transport. Both must outlive the trainer.
+            DistributedTrainer(Sequential & model, distributed::Transport & transport);
+
+            // Runs a single step of mini-batch gradient descent over this rank's shard of the supplied batch, which
+            // every rank must be given & which must hold at least a sample per rank. The model's loss (see
+            // Sequential::GetLoss) is that of the whole batch. Returns false, leaving the model's parameters
+            // untouched, if the gradients couldn't be all-reduced (e.g. another rank went away), after which the
+            // trainer can't be used any more.
+            bool Train(Tensor const & inputData, Tensor const & expectedOutput);
+
+        private:
+            // Called by backpropagation once the supplied layer's gradients are ready to be all-reduced.
+            static void OnGradientsReady(void * context, u32 layerIndex);
+            // The background thread's loop: all-reduces each bucket once it is ready, until the trainer is
+            // destroyed.
+            void ReduceBuckets();
+            // Copies the gradients of the supplied layer (& the loss, for the output layer) into its bucket,
+            // all-reduces it & copies the result back into the layer.
+            bool ReduceBucket(u32 layerIndex);
+
+        private:
+            Sequential & m_Model;
+            distributed::Transport & m_Transport;
+
+            // Per layer, the offset of its bucket in m_Buckets & its number of values: the layer's weight gradients
+            // followed by its bias gradients, & by the loss for the output layer.
+            std::vector<u64> m_BucketOffsets;
+            std::vector<u64> m_BucketSizes;
+            std::vector<f32> m_Buckets;
+            // This rank's shard's share of the samples of the batch, which its gradients & loss are scaled by.
+            f32 m_Scale;
+
+            // Guards the counts below, which are signalled through the conditions. Buckets become ready from the
+            // output layer backwards, so the counts tell which layer is next.
+            std::mutex m_Mutex;
+            std::condition_variable m_ReadyCondition;
+            std::condition_variable m_ReducedCondition;
+            u32 m_NumReadyBuckets;
+            u32 m_NumReducedBuckets;
+            bool m_IsStopping;
+            // Set by the background thread once an all-reduce has failed.
+            bool m_IsBroken;
+
+            std::thread m_Thread;
+        };
+    }
+}
@@ -0,0 +1,153 @@
+#pragma once
+
+#include "Common.h"
+#include "Activators/Activators.h"
+#include "Models/Sequential.h"
+#include "Layers/Layer.h"
+
+#include <string.h>
+
+namespace mia
+{
+    namespace models
+    {
+        // A dense layer whose dimensions & activator are compile-time parameters (see FixedSequential).
+        template <u32 NumInputs, u32 NumNeurons, activators::ActivatorType Type>
+        struct FixedDense
+        {
+            static_assert((NumInputs > 0) && (NumNeurons > 0), "FixedDense layers need at least one input & one neuron.");
+
+            static u32 constexpr c_NumInputs = NumInputs;
+            static u32 constexpr c_NumNeurons = NumNeurons;
+            static activators::ActivatorType constexpr c_ActivatorType = Type;
+
+            // One row of weights per input (the transpose of layers::Layer::GetWeights), so the inner loop of
+            // Execute runs over contiguous neurons & vectorises.
+            f32 weights[NumInputs * NumNeurons];
+            f32 biases[NumNeurons];
+
+            // Computes the values of the layer's neurons for a single sample. Each neuron sums in the same order
+            // as layers::Layer::Execute, the bias is added to the weighted sum of the inputs.
+            void Execute(f32 const * input, f32 * values) const
+            {
+                f32 sums[NumNeurons] = {};
+                for (u32 iIdx = 0; iIdx < NumInputs; ++iIdx)
+                {
+                    f32 const * inputWeights = weights + (iIdx * NumNeurons);
+                    for (u32 nIdx = 0; nIdx < NumNeurons; ++nIdx)
+                    {
+                        sums[nIdx] += inputWeights[nIdx] * input[iIdx];
+                    }
+                }
+
+                for (u32 nIdx = 0; nIdx < NumNeurons; ++nIdx)
+                {
+                    values[nIdx] = activators::StaticActivator<Type>::Apply(sums[nIdx] + biases[nIdx]);
+                }
+            }
+
+            // Copies the parameters of the supplied layer, returns false if it isn't a Dense layer of the
+            // same dimensions & activator (or its weights have been released).
+            bool Load(layers::Layer const & layer)
+            {
+                Matrix const & layerWeights = layer.GetWeights();
+                Matrix const & layerBiases = layer.GetBiases();
+                if ((layers::LayerClass::Dense != layer.GetClass()) || (Type != layer.GetActivatorType()) ||
+                    (NumInputs != layerWeights.GetWidth()) || (NumNeurons != layerWeights.GetHeight()) ||
+                    (NumNeurons != layerBiases.GetHeight()) || (0 == layerWeights.GetCapacity()))
+                {
+                    return false;
+                }
+
+                for (u32 nIdx = 0; nIdx < NumNeurons; ++nIdx)
+                {
+                    for (u32 iIdx = 0; iIdx < NumInputs; ++iIdx)
+                    {
+                        weights[(iIdx * NumNeurons) + nIdx] = layerWeights.GetElement(nIdx, iIdx);
+                    }
+                }
+                memcpy(biases, layerBiases.GetData(), sizeof(biases));
+                return true;
+            }
+        };
+
+        // An inference-only copy of a trained Sequential model whose layers (FixedDense) are all known at
+        // compile time, e.g. for the XOR gate of the demo:
+        //
+        //     FixedSequential<FixedDense<2, 8, ActivatorType::Sigmoid>, FixedDense<8, 1, ActivatorType::Sigmoid>>
+        //
+        // Predicting a sample runs straight through the layers with every loop bound & activator known to
+        // the compiler, which fully unrolls & inlines small models. There are no allocations, views or
+        // dispatch, so predicting a single sample takes a fraction of the time Sequential::Predict does.
+        // The parameters are held inline, so large models should be heap allocated (or use Sequential).
+        template <class Layer, class... Layers>
+        class FixedSequential
+        {
+        public:
+            static u32 constexpr c_NumInputs = Layer::c_NumInputs;
+            static u32 constexpr c_NumOutputs = FixedSequential<Layers...>::c_NumOutputs;
+
+            static_assert(Layer::c_NumNeurons == FixedSequential<Layers...>::c_NumInputs, "Each layer's inputs must match the previous layer's neurons.");
+
+            // Copies the parameters of the supplied model, whose input layer must be followed by layers
+            // matching the fixed layers. Returns false (leaving the parameters unspecified) otherwise.
+            bool Load(Sequential const & model)
+            {
+                return (model.GetNumLayers() == (1 + c_NumLayers)) && Load(model, 1);
+            }
+
+            // Computes the c_NumOutputs outputs of the model for the c_NumInputs inputs of a single sample.
+            void Predict(f32 const * input, f32 * output) const
+            {
+                f32 values[Layer::c_NumNeurons];
+                m_Layer.Execute(input, values);
+                m_Layers.Predict(values, output);
+            }
+
+        private:
+            template <class, class...>
+            friend class FixedSequential;
+
+            static u32 constexpr c_NumLayers = 1 + FixedSequential<Layers...>::c_NumLayers;
+
+            bool Load(Sequential const & model, u32 layerIndex)
+            {
+                return m_Layer.Load(*model.GetLayer(layerIndex)) && m_Layers.Load(model, layerIndex + 1);
+            }
+
+            Layer m_Layer;
+            FixedSequential<Layers...> m_Layers;
+        };
+
+        template <class Layer>
+        class FixedSequential<Layer>
+        {
+        public:
+            static u32 constexpr c_NumInputs = Layer::c_NumInputs;
+            static u32 constexpr c_NumOutputs = Layer::c_NumNeurons;
+
+            bool Load(Sequential const & model)
+            {
+                return (model.GetNumLayers() == (1 + c_NumLayers)) && Load(model, 1);
+            }
+
+            void Predict(f32 const * input, f32 * output) const
+            {
+                m_Layer.Execute(input, output);
+            }
+
+        private:
+            template <class, class...>
+            friend class FixedSequential;
+
+            static u32 constexpr c_NumLayers = 1;
+
+            bool Load(Sequential const & model, u32 layerIndex)
+            {
+                return m_Layer.Load(*model.GetLayer(layerIndex));
+            }
+
+            Layer m_Layer;
+        };
+    }
+}
@@ -1,7 +1,9 @@
 #pragma once
 
 #include "Common.h"
-#include "Core/NDArrayView.h"
+#include "Maths/Matrix.h"
+#include "Maths/Tensor.h"
+#include "Optimizers/Optimizer.h"
 
 namespace mia
 {
@@ -16,13 +18,29 @@ namespace mia
             virtual ~Model() = default;
 
             // Compiles the current model so that it is ready to be trained or
-            // executed.
-            virtual void Compile(u32 seedValue) = 0;
+            // executed. Every buffer needed to train or execute batches of up to
+            // maxBatchSize samples is allocated up front. The trainable parameters
+            // are updated by the supplied optimizer while training.
+            virtual void Compile(u32 seedValue, u32 maxBatchSize = 1, optimizers::Optimizer const & optimizer = optimizers::Optimizer()) = 0;
 
             // Executes the current state of the model on the supplied inputData and then
             // adjusts the trainable parameters based on how close the output result is to
-            // the supplied expectedOutput.
-            virtual void Train(NDArrayView<f32> const & inputData, std::initializer_list<f32> const & expectedOutput) = 0;
+            // the supplied expectedOutput. The shape of inputData is that expected by the
+            // model's input layer (see layers::InputLayer::SetInputData).
+            virtual void Train(Tensor const & inputData, std::initializer_list<f32> const & expectedOutput) = 0;
+            // Trains the model on a batch of samples. expectedOutput is a (numSamples x numOutputs) tensor
+            // holding one expected output per sample of inputData, the trainable parameters are adjusted once
+            // per batch.
+            virtual void Train(Tensor const & inputData, Tensor const & expectedOutput) = 0;
+
+            // Executes the current state of the model on every sample of the supplied inputData and returns
+            // the output of the model. Each column of the returned matrix holds the output for one sample.
+            virtual Matrix const & Predict(Tensor const & inputData) = 0;
+
+            // Releases the row-major copy of every layer's weights (& everything else only needed for
+            // training), keeping only the copy packed for the matrix multiplication. Roughly halves the
+            // memory an inference-only model takes up. The model can no longer be trained afterwards.
+            virtual void ReleaseUnpackedWeights() = 0;
         };
     }
 }
@@ -0,0 +1,467 @@
+#include "ModelFormat.h"
+
+#include "Layers/Layer.h"
+#include "Layers/Flatten.h"
+#include "Layers/Dense.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <memory>
+#include <string>
+#include <utility>
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#include <io.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace mia
+{
+    namespace models
+    {
+        namespace format
+        {
+            namespace
+            {
+                inline u64 AlignUp(u64 value, u64 alignment)
+                {
+                    return (value + alignment - 1) & ~(alignment - 1);
+                }
+
+                // Returns the number of elements of the supplied packed operand (see gemm::GetPackedSize)
+                u64 GetPackedSize(gemm::PackedOperand const & operand)
+                {
+                    u64 const paddedRows = ((static_cast<u64>(operand.numRows) + operand.mr - 1) / operand.mr) * operand.mr;
+                    return paddedRows * operand.numCols;
+                }
+
+                bool SeekTo(FILE * file, u64 offset)
+                {
+#if defined(_WIN32)
+                    return 0 == _fseeki64(file, static_cast<__int64>(offset), SEEK_SET);
+#else
+                    return 0 == fseeko(file, static_cast<off_t>(offset), SEEK_SET);
+#endif
+                }
+
+                // Writes the header with the supplied step count
+                bool WriteHeader(FILE * file, FileHeader const & header, u64 numSteps)
+                {
+                    FileHeader writtenHeader = header;
+                    writtenHeader.numSteps = numSteps;
+                    return SeekTo(file, 0) && (1 == fwrite(&writtenHeader, sizeof(writtenHeader), 1, file)) && (0 == fflush(file));
+                }
+
+                bool WriteBlob(FILE * file, Blob const & blob)
+                {
+                    return SeekTo(file, blob.offset) && (blob.numElements == fwrite(blob.data, sizeof(f32), static_cast<size_t>(blob.numElements), file));
+                }
+
+                // Writes the blobs of the layers flagged in isLayerChanged (or every blob if it is nullptr). The header
+                // is first marked as incomplete & only completed once every blob has been written, so a file that
+                // was never finished is rejected rather than read half updated.
+                bool WriteBlobs(FILE * file, Layout const & layout, bool const * isLayerChanged)
+                {
+                    bool isWritten = WriteHeader(file, layout.header, c_IncompleteNumSteps);
+                    for (u64 bIdx = 0; isWritten && (bIdx < layout.blobs.size()); ++bIdx)
+                    {
+                        Blob const & blob = layout.blobs[bIdx];
+                        if ((nullptr == isLayerChanged) || isLayerChanged[blob.layerIndex])
+                        {
+                            isWritten = WriteBlob(file, blob);
+                        }
+                    }
+
+                    return isWritten && WriteHeader(file, layout.header, layout.header.numSteps);
+                }
+
+                // Returns the path a file is written to before it replaces the file at path
+                std::string GetTempPath(char const * path)
+                {
+                    return std::string(path) + ".tmp";
+                }
+
+                // Copies the first numBytes bytes of one file to the start of another
+                bool CopyBytes(FILE * from, FILE * to, u64 numBytes)
+                {
+                    static size_t constexpr c_BufferSize = 1 << 20;
+                    std::unique_ptr<u8[]> buffer(new u8[c_BufferSize]);
+
+                    bool isCopied = SeekTo(from, 0) && SeekTo(to, 0);
+                    while (isCopied && (numBytes > 0))
+                    {
+                        size_t const numChunkBytes = static_cast<size_t>((numBytes < c_BufferSize) ? numBytes : c_BufferSize);
+                        isCopied = (numChunkBytes == fread(buffer.get(), 1, numChunkBytes, from)) && (numChunkBytes == fwrite(buffer.get(), 1, numChunkBytes, to));
+                        numBytes -= numChunkBytes;
+                    }
+
+                    return isCopied;
+                }
+
+                // Flushes what has been written to the file all the way to the disk
+                bool SyncFile(FILE * file)
+                {
+                    if (0 != fflush(file))
+                    {
+                        return false;
+                    }
+#if defined(_WIN32)
+                    return 0 == _commit(_fileno(file));
+#else
+                    return 0 == fsync(fileno(file));
+#endif
+                }
+
+                // Flushes the directory entries of the directory holding path, so a file renamed into it survives a
+                // crash. Not needed on Windows, where MoveFileEx writes through.
+                void SyncDirectory(char const * path)
+                {
+#if !defined(_WIN32)
+                    std::string directory(path);
+                    size_t const separator = directory.find_last_of('/');
+                    directory = (std::string::npos == separator) ? std::string(".") : directory.substr(0, separator + 1);
+
+                    int const descriptor = open(directory.c_str(), O_RDONLY);
+                    if (descriptor >= 0)
+                    {
+                        fsync(descriptor);
+                        close(descriptor);
+                    }
+#else
+                    (void)path;
+#endif
+                }
+
+                // Closes the file written at tempPath &, if it was written successfully, replaces the file at path
+                // with it. The file at path is only ever replaced whole by a completely written file, so a crash
+                // while writing leaves the previous file untouched. Returns false (& removes the temporary file)
+                // if anything failed.
+                bool CloseAndReplace(FILE * file, std::string const & tempPath, char const * path, bool isWritten)
+                {
+                    isWritten = isWritten && SyncFile(file);
+                    isWritten = (0 == fclose(file)) && isWritten;
+#if defined(_WIN32)
+                    isWritten = isWritten && (0 != MoveFileExA(tempPath.c_str(), path, MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH));
+#else
+                    isWritten = isWritten && (0 == rename(tempPath.c_str(), path));
+#endif
+                    if (!isWritten)
+                    {
+                        remove(tempPath.c_str());
+                        return false;
+                    }
+
+                    SyncDirectory(path);
+                    return true;
+                }
+            }
+
+            bool DescribeModel(u32 numLayers, layers::Layer const * const * layers, optimizers::OptimizerType optimizerType, u64 numSteps, bool includeTrainingState, Layout & layout)
+            {
+                layout.header.magic = c_Magic;
+                layout.header.version = c_Version;
+                layout.header.numLayers = numLayers;
+                layout.header.optimizerType = static_cast<u64>(optimizerType);
+                layout.header.numSteps = numSteps;
+
+                // The blobs follow the header & the layer records, one aligned blob after another
+                layout.records.resize(numLayers);
+                layout.blobs.clear();
+                u64 fileSize = AlignUp(sizeof(FileHeader) + (numLayers * sizeof(LayerRecord)), c_BlobAlignment);
+
+                auto addBlob = [&](u32 layerIndex, Matrix const & matrix, BlobRecord & record)
+                {
+                    record.width = matrix.GetWidth();
+                    record.height = matrix.GetHeight();
+                    record.offset = 0;
+
+                    u64 const numElements = matrix.GetCapacity();
+                    if (numElements > 0)
+                    {
+                        record.offset = fileSize;
+                        layout.blobs.push_back({ matrix.GetData(), numElements, fileSize, layerIndex });
+                        fileSize = AlignUp(fileSize + (numElements * sizeof(f32)), c_BlobAlignment);
+                    }
+                };
+
+                u32 const numStateBuffers = includeTrainingState ? optimizers::GetNumStateBuffers(optimizerType) : 0;
+                for (u32 layerIndex = 0; layerIndex < numLayers; ++layerIndex)
+                {
+                    layers::Layer const * layer = layers[layerIndex];
+                    LayerRecord & record = layout.records[layerIndex];
+                    memset(&record, 0, sizeof(record));
+
+                    record.layerClass = static_cast<u64>(layer->GetClass());
+                    record.activatorType = static_cast<u64>(layer->GetActivatorType());
+                    record.numNeurons = layer->GetNumNeurons();
+
+                    switch (layer->GetClass())
+                    {
+                        case layers::LayerClass::Flatten:
+                        {
+                            layers::Flatten const * flatten = static_cast<layers::Flatten const *>(layer);
+                            record.numInputDimensions = flatten->GetInputNumDimensions();
+                            for (u32 dIdx = 0; dIdx < flatten->GetInputNumDimensions(); ++dIdx)
+                            {
+                                record.inputDimensionLengths[dIdx] = flatten->GetInputDimensionLengths()[dIdx];
+                            }
+                            break;
+                        }
+
+                        case layers::LayerClass::Dense:
+                        {
+                            // Training can only be resumed from the row-major weights
+                            if (includeTrainingState && (0 == layer->GetWeights().GetCapacity()))
+                            {
+                                return false;
+                            }
+
+                            addBlob(layerIndex, layer->GetWeights(), record.weights);
+                            addBlob(layerIndex, layer->GetBiases(), record.biases);
+
+                            // The packed weights can always be derived from the weights so are left out of checkpoints
+                            gemm::PackedOperand const & packedWeights = layer->GetPackedWeights();
+                            if (!includeTrainingState && (nullptr != packedWeights.data))
+                            {
+                                Matrix const packedView = Matrix::View(1, static_cast<u32>(GetPackedSize(packedWeights)), const_cast<f32 *>(packedWeights.data));
+                                addBlob(layerIndex, packedView, record.packedWeights);
+                                record.packedMr = packedWeights.mr;
+                                record.packedKc = packedWeights.kc;
+                            }
+
+                            for (u32 sIdx = 0; sIdx < numStateBuffers; ++sIdx)
+                            {
+                                addBlob(layerIndex, layer->GetWeightsOptimizerState(sIdx), record.weightsOptimizerState[sIdx]);
+                                addBlob(layerIndex, layer->GetBiasesOptimizerState(sIdx), record.biasesOptimizerState[sIdx]);
+                            }
+                            break;
+                        }
+
+                        default:
+                            return false;
+                    }
+                }
+
+                layout.header.fileSize = fileSize;
+                return true;
+            }
+
+            bool WriteFile(char const * path, Layout const & layout)
+            {
+                std::string const tempPath = GetTempPath(path);
+                FILE * file = fopen(tempPath.c_str(), "wb");
+                if (nullptr == file)
+                {
+                    return false;
+                }
+
+                // The header itself is written by WriteBlobs
+                bool isWritten = SeekTo(file, sizeof(FileHeader));
+                isWritten = isWritten && (layout.records.size() == fwrite(layout.records.data(), sizeof(LayerRecord), layout.records.size(), file));
+
+                // Extend the file to its full size, zero filling the padding between the blobs
+                if (isWritten && (layout.header.fileSize > (sizeof(FileHeader) + (layout.records.size() * sizeof(LayerRecord)))))
+                {
+                    u8 const lastByte = 0;
+                    isWritten = SeekTo(file, layout.header.fileSize - 1) && (1 == fwrite(&lastByte, 1, 1, file));
+                }
+
+                isWritten = isWritten && WriteBlobs(file, layout, nullptr);
+                return CloseAndReplace(file, tempPath, path, isWritten);
+            }
+
+            bool UpdateFile(char const * path, Layout const & layout, bool const * isLayerChanged)
+            {
+                FILE * prevFile = fopen(path, "rb");
+                if (nullptr == prevFile)
+                {
+                    return false;
+                }
+
+                std::string const tempPath = GetTempPath(path);
+                FILE * file = fopen(tempPath.c_str(), "wb");
+                if (nullptr == file)
+                {
+                    fclose(prevFile);
+                    return false;
+                }
+
+                // The unchanged blobs are carried over from the previous file, which keeps its size
+                bool isWritten = CopyBytes(prevFile, file, layout.header.fileSize);
+                fclose(prevFile);
+
+                isWritten = isWritten && WriteBlobs(file, layout, isLayerChanged);
+                return CloseAndReplace(file, tempPath, path, isWritten);
+            }
+
+            FileHeader const * ReadHeader(MappedFile const & file, LayerRecord const ** records)
+            {
+                if (file.GetSize() < sizeof(FileHeader))
+                {
+                    return nullptr;
+                }
+
+                FileHeader const * header = reinterpret_cast<FileHeader const *>(file.GetData());
+                if ((c_Magic != header->magic) || (c_Version != header->version) || (file.GetSize() != header->fileSize) || (c_IncompleteNumSteps == header->numSteps))
+                {
+                    return nullptr;
+                }
+
+                if ((0 == header->numLayers) || ((sizeof(FileHeader) + (header->numLayers * sizeof(LayerRecord))) > file.GetSize()))
+                {
+                    return nullptr;
+                }
+
+                *records = reinterpret_cast<LayerRecord const *>(file.GetData() + sizeof(FileHeader));
+                return header;
+            }
+
+            bool ViewBlob(MappedFile const & file, BlobRecord const & record, u64 width, u64 height, Matrix & matrix)
+            {
+                if ((record.width != width) || (record.height != height) || (static_cast<u32>(width) != width) || (static_cast<u32>(height) != height))
+                {
+                    return false;
+                }
+
+                // Anything allocated later on (e.g. if the matrix grows) lives as long as the other parameters
+                Allocator & allocator = PoolAllocator::GetParameterPool();
+                u64 const numBytes = width * height * sizeof(f32);
+                if (0 == numBytes)
+                {
+                    matrix = Matrix(allocator);
+                    return true;
+                }
+
+                if ((0 != (record.offset % c_BlobAlignment)) || (record.offset > file.GetSize()) || (numBytes > (file.GetSize() - record.offset)))
+                {
+                    return false;
+                }
+
+                f32 * const data = reinterpret_cast<f32 *>(file.GetData() + record.offset);
+                matrix = Matrix::View(static_cast<u32>(width), static_cast<u32>(height), data, allocator);
+                return true;
+            }
+
+            layers::Layer * LoadLayer(MappedFile const & file, LayerRecord const & record, layers::Layer const * prevLayer)
+            {
+                if (record.activatorType >= static_cast<u64>(activators::ActivatorType::Count))
+                {
+                    return nullptr;
+                }
+
+                activators::ActivatorType const activatorType = static_cast<activators::ActivatorType>(record.activatorType);
+                switch (static_cast<layers::LayerClass>(record.layerClass))
+                {
+                    case layers::LayerClass::Flatten:
+                    {
+                        if ((nullptr != prevLayer) || (0 == record.numInputDimensions) || (record.numInputDimensions >= c_MaxTensorDimensions))
+                        {
+                            return nullptr;
+                        }
+
+                        u64 numNeurons = 1;
+                        DimensionLength inputDimensionLengths[c_MaxTensorDimensions];
+                        for (u64 dIdx = 0; dIdx < record.numInputDimensions; ++dIdx)
+                        {
+                            inputDimensionLengths[dIdx] = static_cast<DimensionLength>(record.inputDimensionLengths[dIdx]);
+                            numNeurons *= record.inputDimensionLengths[dIdx];
+                        }
+
+                        if ((0 == numNeurons) || (numNeurons != record.numNeurons))
+                        {
+                            return nullptr;
+                        }
+
+                        layers::Flatten * const layer = new layers::Flatten(static_cast<u32>(record.numInputDimensions), inputDimensionLengths, activatorType);
+                        layer->Compile(0, nullptr);
+                        return layer;
+                    }
+
+                    case layers::LayerClass::Dense:
+                    {
+                        if ((nullptr == prevLayer) || (0 == record.numNeurons))
+                        {
+                            return nullptr;
+                        }
+
+                        u64 const numInputs = prevLayer->GetNumNeurons();
+                        u64 const numNeurons = record.numNeurons;
+
+                        // Either set of weights may be missing (e.g. if the model's unpacked weights were released)
+                        Matrix weights;
+                        Matrix biases;
+                        Matrix packedWeights;
+                        bool const hasWeights = (0 != record.weights.width);
+                        if (!ViewBlob(file, record.weights, hasWeights ? numInputs : 0, hasWeights ? numNeurons : 0, weights) ||
+                            !ViewBlob(file, record.biases, 1, numNeurons, biases))
+                        {
+                            return nullptr;
+                        }
+
+                        gemm::PackedOperand packedOperand;
+                        if (0 != record.packedMr)
+                        {
+                            packedOperand.numRows = static_cast<u32>(numNeurons);
+                            packedOperand.numCols = static_cast<u32>(numInputs);
+                            packedOperand.mr = static_cast<u32>(record.packedMr);
+                            packedOperand.kc = static_cast<u32>(record.packedKc);
+
+                            if ((0 == packedOperand.kc) || !ViewBlob(file, record.packedWeights, 1, GetPackedSize(packedOperand), packedWeights))
+                            {
+                                return nullptr;
+                            }
+                            packedOperand.data = packedWeights.GetData();
+                        }
+
+                        bool const canUsePackedWeights = (nullptr != packedOperand.data) && gemm::IsPackedForCurrentKernel(packedOperand);
+                        if (!hasWeights && !canUsePackedWeights)
+                        {
+                            return nullptr;
+                        }
+
+                        layers::Dense * const layer = new layers::Dense(static_cast<u32>(numNeurons), activatorType);
+                        layer->Restore(std::move(weights), std::move(biases), std::move(packedWeights), packedOperand);
+                        return layer;
+                    }
+
+                    default:
+                        return nullptr;
+                }
+            }
+
+            bool MatchesLayer(LayerRecord const & record, layers::Layer const & layer)
+            {
+                if ((record.layerClass != static_cast<u64>(layer.GetClass())) ||
+                    (record.activatorType != static_cast<u64>(layer.GetActivatorType())) ||
+                    (record.numNeurons != layer.GetNumNeurons()))
+                {
+                    return false;
+                }
+
+                if (layers::LayerClass::Flatten == layer.GetClass())
+                {
+                    layers::Flatten const & flatten = static_cast<layers::Flatten const &>(layer);
+                    if (record.numInputDimensions != flatten.GetInputNumDimensions())
+                    {
+                        return false;
+                    }
+
+                    for (u32 dIdx = 0; dIdx < flatten.GetInputNumDimensions(); ++dIdx)
+                    {
+                        if (record.inputDimensionLengths[dIdx] != flatten.GetInputDimensionLengths()[dIdx])
+                        {
+                            return false;
+                        }
+                    }
+                }
+
+                return true;
+            }
+        }
+    }
+}
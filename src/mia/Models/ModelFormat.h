@@ -0,0 +1,157 @@
+#pragma once
+
+#include "Common.h"
+#include "Core/Allocator.h"
+#include "Core/MappedFile.h"
+#include "Maths/Tensor.h"
+#include "Optimizers/Optimizer.h"
+
+#include <vector>
+
+namespace mia
+{
+    namespace layers
+    {
+        class Layer;
+    }
+
+    namespace models
+    {
+        // Describes the binary model format written by Sequential::Save (& Sequential::Checkpoint) & read by
+        // Sequential::Load (& Sequential::Resume).
+        //
+        // The format is designed to be memory-mapped & used in place:
+        //
+        //  -------------------------
+        //  | FileHeader            |
+        //  | LayerRecord 0         |
+        //  | ...                   |
+        //  | LayerRecord n - 1     |
+        //  -------------------------   <- aligned to c_BlobAlignment
+        //  | blob                  |
+        //  -------------------------   <- aligned to c_BlobAlignment
+        //  | blob                  |
+        //  | ...                   |
+        //  -------------------------
+        //
+        // Every record field is a u64 so the layout is the same whichever compiler wrote the file. Values are
+        // stored in the byte order of the machine that wrote the file, a file written by a machine of the other
+        // byte order fails the magic check. Blobs hold the row-major f32 elements of a matrix & are aligned so
+        // that a mapped blob can be read with aligned SIMD loads, exactly like an allocated matrix.
+        //
+        // Files are written next to their path (with a ".tmp" suffix) & only renamed over it once completely
+        // written & flushed to disk, so a crash while writing never loses the previous file. As the offset of
+        // every blob only depends on the shape of the model, a file can be updated by carrying the previous file
+        // over & rewriting the blobs of the layers that changed (see UpdateFile).
+        namespace format
+        {
+            // "MIAMODEL" read as a little-endian u64.
+            u64 constexpr c_Magic = 0x4C45444F4D41494Dull;
+
+            // Incremented whenever the layout changes. Files of any other version are rejected.
+            // - 1: the layer graph & parameters
+            // - 2: the optimizer's state & step count, for checkpoints
+            u64 constexpr c_Version = 2;
+
+            // The alignment of every blob relative to the start of the file.
+            u64 constexpr c_BlobAlignment = c_AllocationAlignment;
+
+            // The step count of a file that is being written. A file that still holds it was never completed
+            // (e.g. the process crashed while writing it) & is rejected.
+            u64 constexpr c_IncompleteNumSteps = ~0ull;
+
+            struct FileHeader
+            {
+                u64 magic;
+                u64 version;
+                u64 numLayers;
+                // The size of the whole file, which catches truncated files
+                u64 fileSize;
+                // The optimizers::OptimizerType whose state the layers hold (if any) & the number of parameter
+                // updates the model had been trained for
+                u64 optimizerType;
+                u64 numSteps;
+            };
+
+            // A (width x height) matrix stored as a blob. An empty matrix has no blob & an offset of 0.
+            struct BlobRecord
+            {
+                u64 offset;
+                u64 width;
+                u64 height;
+            };
+
+            struct LayerRecord
+            {
+                // The layer's layers::LayerClass
+                u64 layerClass;
+                // The layer's activators::ActivatorType
+                u64 activatorType;
+                u64 numNeurons;
+
+                // The input shape of Flatten layers
+                u64 numInputDimensions;
+                u64 inputDimensionLengths[c_MaxTensorDimensions];
+
+                // The parameters of Dense layers. The packed weights are those of gemm::Pack, which depend on the
+                // micro-kernel they were packed for (packedMr & packedKc). They are only used in place if the
+                // loading machine uses the same micro-kernel, otherwise the weights are packed again on load.
+                BlobRecord weights;
+                BlobRecord biases;
+                BlobRecord packedWeights;
+                u64 packedMr;
+                u64 packedKc;
+
+                // The optimizer's state buffers of the weights & biases, only present in checkpoints
+                BlobRecord weightsOptimizerState[optimizers::c_MaxNumStateBuffers];
+                BlobRecord biasesOptimizerState[optimizers::c_MaxNumStateBuffers];
+            };
+
+            static_assert(48 == sizeof(FileHeader), "FileHeader's layout must not depend on the compiler.");
+            static_assert(((23 + (6 * optimizers::c_MaxNumStateBuffers)) * sizeof(u64)) == sizeof(LayerRecord), "LayerRecord's layout must not depend on the compiler.");
+
+            // The contents of a blob & where it lives in the file.
+            struct Blob
+            {
+                f32 const * data;
+                u64 numElements;
+                u64 offset;
+                // The index of the layer the blob belongs to
+                u32 layerIndex;
+            };
+
+            // Everything written to a file: its header, layer records & blobs (in order of their offsets).
+            struct Layout
+            {
+                FileHeader header;
+                std::vector<LayerRecord> records;
+                std::vector<Blob> blobs;
+            };
+
+            // Lays out a file holding the supplied layers. Models are saved with the packed copy of the weights
+            // so they can be executed in place, checkpoints (includeTrainingState) are saved with the optimizer's
+            // state instead. Returns false if a layer can't be saved.
+            bool DescribeModel(u32 numLayers, layers::Layer const * const * layers, optimizers::OptimizerType optimizerType, u64 numSteps, bool includeTrainingState, Layout & layout);
+
+            // Writes the whole of the supplied layout to path, replacing any existing file. Returns false (leaving
+            // any existing file untouched) if the file couldn't be written.
+            bool WriteFile(char const * path, Layout const & layout);
+            // Replaces the file at path, which must have been written with a layout of the same shape, with a copy
+            // of it in which the header & the blobs of the layers flagged in isLayerChanged are rewritten. Returns
+            // false (leaving the file untouched) if the file couldn't be written.
+            bool UpdateFile(char const * path, Layout const & layout, bool const * isLayerChanged);
+
+            // Returns the header & layer records of the mapped file if it is a complete model file of the current
+            // version, nullptr otherwise.
+            FileHeader const * ReadHeader(MappedFile const & file, LayerRecord const ** records);
+            // Points matrix at the blob described by record, which must be a (width x height) matrix lying
+            // within the file. Returns false if that isn't the case.
+            bool ViewBlob(MappedFile const & file, BlobRecord const & record, u64 width, u64 height, Matrix & matrix);
+            // Creates the layer described by record, with its parameters viewing the file. prevLayer is the layer
+            // that precedes it in the model. Returns nullptr if the record isn't valid.
+            layers::Layer * LoadLayer(MappedFile const & file, LayerRecord const & record, layers::Layer const * prevLayer);
+            // Returns true if the supplied layer has the class, activator & shape described by record.
+            bool MatchesLayer(LayerRecord const & record, layers::Layer const & layer);
+        }
+    }
+}
@@ -0,0 +1,218 @@
+#include "Profiler.h"
+
+#include "Core/Allocator.h"
+
+#include <chrono>
+#include <limits>
+#include <stdio.h>
+
+namespace mia
+{
+    namespace models
+    {
+        namespace
+        {
+            char const * GetLayerClassName(layers::LayerClass layerClass)
+            {
+                switch (layerClass)
+                {
+                    case layers::LayerClass::Flatten:   return "Flatten";
+                    case layers::LayerClass::Dense:     return "Dense";
+
+                    default:
+                        break;
+                }
+
+                return "Layer";
+            }
+
+            char const * GetPassName(ProfiledPass pass)
+            {
+                switch (pass)
+                {
+                    case ProfiledPass::Execute:         return "Execute";
+                    case ProfiledPass::Backpropagate:   return "Backpropagate";
+                    case ProfiledPass::ApplyGradients:  return "ApplyGradients";
+
+                    default:
+                        ASSERTMSG(false, "Unknown ProfiledPass.");
+                        break;
+                }
+
+                return "";
+            }
+        }
+
+        DurationHistogram::DurationHistogram()
+            : m_Count(0)
+            , m_Total(0)
+            , m_Min(std::numeric_limits<u64>::max())
+            , m_Max(0)
+        {
+            for (u32 bIdx = 0; bIdx < c_NumBuckets; ++bIdx)
+            {
+                m_Buckets[bIdx] = 0;
+            }
+        }
+
+        void DurationHistogram::Add(u64 duration)
+        {
+            // The bucket is the index of the highest set bit
+            u32 bucketIndex = 0;
+            for (u64 remaining = duration >> 1; 0 != remaining; remaining >>= 1)
+            {
+                ++bucketIndex;
+            }
+
+            ++m_Buckets[bucketIndex];
+            ++m_Count;
+            m_Total += duration;
+            m_Min = (duration < m_Min) ? duration : m_Min;
+            m_Max = (duration > m_Max) ? duration : m_Max;
+        }
+
+        u64 DurationHistogram::GetPercentile(f64 fraction) const
+        {
+            ASSERTMSG((fraction >= 0.0) && (fraction <= 1.0), "fraction must be between 0 & 1.");
+
+            if (0 == m_Count)
+            {
+                return 0;
+            }
+
+            // The number of durations (rounded up) that must not exceed the percentile
+            u64 const rank = static_cast<u64>((fraction * static_cast<f64>(m_Count)) + 0.999999);
+            u64 numCounted = 0;
+            for (u32 bIdx = 0; bIdx < c_NumBuckets - 1; ++bIdx)
+            {
+                numCounted += m_Buckets[bIdx];
+                if (numCounted >= rank)
+                {
+                    u64 const bucketEnd = (static_cast<u64>(1) << (bIdx + 1)) - 1;
+                    return (bucketEnd < m_Max) ? bucketEnd : m_Max;
+                }
+            }
+
+            return m_Max;
+        }
+
+        Profiler::Profiler(u64 maxNumEvents)
+            : m_MaxNumEvents(maxNumEvents)
+            , m_StartTime(GetTime())
+            , m_NumDroppedEvents(0)
+            , m_Events()
+            , m_Summaries()
+            , m_LayerClasses()
+        {
+        }
+
+        Profiler::Mark Profiler::Begin() const
+        {
+            Mark mark;
+            mark.numAllocations = Allocator::GetNumHeapAllocations();
+            mark.numBytesAllocated = Allocator::GetNumHeapBytesAllocated();
+            mark.time = GetTime();
+            return mark;
+        }
+
+        void Profiler::End(Mark const & start, u32 layerIndex, layers::Layer const & layer, ProfiledPass pass, layers::LayerCost const & cost)
+        {
+            // Read the clock first so that none of the recording is timed
+            u64 const endTime = GetTime();
+
+            ProfileEvent event;
+            event.layerIndex = layerIndex;
+            event.layerClass = layer.GetClass();
+            event.pass = pass;
+            event.startTime = start.time - m_StartTime;
+            event.duration = endTime - start.time;
+            event.cost = cost;
+            event.numAllocations = Allocator::GetNumHeapAllocations() - start.numAllocations;
+            event.numBytesAllocated = Allocator::GetNumHeapBytesAllocated() - start.numBytesAllocated;
+
+            u64 const numSummaries = (static_cast<u64>(layerIndex) + 1) * static_cast<u32>(ProfiledPass::Count);
+            if (m_Summaries.size() < numSummaries)
+            {
+                m_Summaries.resize(numSummaries);
+                m_LayerClasses.resize(layerIndex + 1, layers::LayerClass::Unknown);
+            }
+            m_LayerClasses[layerIndex] = event.layerClass;
+
+            ProfileSummary & summary = m_Summaries[(static_cast<u64>(layerIndex) * static_cast<u32>(ProfiledPass::Count)) + static_cast<u32>(pass)];
+            summary.durations.Add(event.duration);
+            summary.cost.numFlops += cost.numFlops;
+            summary.cost.numBytes += cost.numBytes;
+            summary.numAllocations += event.numAllocations;
+            summary.numBytesAllocated += event.numBytesAllocated;
+
+            if (m_Events.size() < m_MaxNumEvents)
+            {
+                m_Events.push_back(event);
+            }
+            else
+            {
+                ++m_NumDroppedEvents;
+            }
+        }
+
+        void Profiler::Reset()
+        {
+            m_StartTime = GetTime();
+            m_NumDroppedEvents = 0;
+            m_Events.clear();
+            m_Summaries.clear();
+            m_LayerClasses.clear();
+        }
+
+        ProfileSummary const & Profiler::GetSummary(u32 layerIndex, ProfiledPass pass) const
+        {
+            ASSERTMSG(layerIndex < GetNumLayers(), "layerIndex is out of bounds.");
+            ASSERTMSG(pass < ProfiledPass::Count, "Unknown ProfiledPass.");
+            return m_Summaries[(static_cast<u64>(layerIndex) * static_cast<u32>(ProfiledPass::Count)) + static_cast<u32>(pass)];
+        }
+
+        bool Profiler::WriteChromeTrace(char const * path) const
+        {
+            FILE * file = fopen(path, "w");
+            if (nullptr == file)
+            {
+                return false;
+            }
+
+            // Timestamps & durations are in microseconds, each layer is a thread (tid) of a single process
+            bool isWritten = 0 < fprintf(file, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[");
+            for (u64 eIdx = 0; isWritten && (eIdx < m_Events.size()); ++eIdx)
+            {
+                ProfileEvent const & event = m_Events[eIdx];
+                isWritten = 0 < fprintf(file,
+                    "%s\n{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f,"
+                    "\"args\":{\"flops\":%.0f,\"bytes\":%.0f,\"allocations\":%llu,\"bytesAllocated\":%llu}}",
+                    (eIdx > 0) ? "," : "",
+                    GetPassName(event.pass),
+                    GetLayerClassName(event.layerClass),
+                    static_cast<unsigned int>(event.layerIndex),
+                    static_cast<f64>(event.startTime) / 1000.0,
+                    static_cast<f64>(event.duration) / 1000.0,
+                    event.cost.numFlops,
+                    event.cost.numBytes,
+                    static_cast<unsigned long long>(event.numAllocations),
+                    static_cast<unsigned long long>(event.numBytesAllocated));
+            }
+
+            // Name each layer's row after its index & class
+            for (u32 layerIndex = 0; isWritten && (layerIndex < GetNumLayers()); ++layerIndex)
+            {
+                isWritten = 0 < fprintf(file, "%s\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":\"%u %s\"}}",
+                    (m_Events.empty() && (0 == layerIndex)) ? "" : ",", static_cast<unsigned int>(layerIndex), static_cast<unsigned int>(layerIndex), GetLayerClassName(m_LayerClasses[layerIndex]));
+            }
+
+            isWritten = isWritten && (0 < fprintf(file, "\n]}\n"));
+            return (0 == fclose(file)) && isWritten;
+        }
+
+        u64 Profiler::GetTime()
+        {
+            return static_cast<u64>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+        }
+    }
+}
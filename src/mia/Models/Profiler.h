@@ -0,0 +1,181 @@
+#pragma once
+
+#include "Layers/Layer.h"
+
+#include <vector>
+
+namespace mia
+{
+    namespace models
+    {
+        // The passes of a layer a Profiler records.
+        enum class ProfiledPass : u8
+        {
+            Execute,
+            Backpropagate,
+            ApplyGradients,
+            Count
+        };
+
+        // A single profiled call of a layer's pass. Times are in nanoseconds since the profiler was
+        // constructed (or last reset).
+        struct ProfileEvent
+        {
+            u32 layerIndex;
+            layers::LayerClass layerClass;
+            ProfiledPass pass;
+            u64 startTime;
+            u64 duration;
+            layers::LayerCost cost;
+            // The blocks (& bytes) taken from the heap during the call (see Allocator::GetNumHeapAllocations).
+            u64 numAllocations;
+            u64 numBytesAllocated;
+        };
+
+        // Counts durations (in nanoseconds) in power of two buckets: bucket b holds the durations in
+        // [2^b, 2^(b + 1)), bucket 0 also holds zero.
+        class DurationHistogram
+        {
+        public:
+            static u32 constexpr c_NumBuckets = 64;
+
+            DurationHistogram();
+
+            void Add(u64 duration);
+
+            // Returns the number of durations added.
+            u64 GetCount() const;
+            // Returns the number of durations added to the supplied bucket.
+            u64 GetBucketCount(u32 bucketIndex) const;
+            // Returns the sum, the smallest & the largest of the durations added (zero if there are none).
+            u64 GetTotal() const;
+            u64 GetMin() const;
+            u64 GetMax() const;
+            // Returns an upper bound of the duration that the supplied fraction (in [0, 1]) of the durations
+            // don't exceed, i.e. the end of the bucket holding that percentile clamped to GetMax. Accurate to
+            // within a factor of two.
+            u64 GetPercentile(f64 fraction) const;
+
+        private:
+            u64 m_Buckets[c_NumBuckets];
+            u64 m_Count;
+            u64 m_Total;
+            u64 m_Min;
+            u64 m_Max;
+        };
+
+        // Every call of a single pass of a single layer, summed.
+        struct ProfileSummary
+        {
+            DurationHistogram durations;
+            layers::LayerCost cost;
+            u64 numAllocations = 0;
+            u64 numBytesAllocated = 0;
+        };
+
+        // Records where the time of a model goes, layer by layer: the wall time, floating point operations,
+        // bytes of memory moved & heap allocations of every pass of every layer (see layers::LayerCost). Each
+        // call is summarised per layer & pass (see GetSummary) & kept as an event that WriteChromeTrace exports
+        // for viewing on a timeline (chrome://tracing or Perfetto).
+        //
+        // A model only profiles while a profiler is attached to it (see Sequential::SetProfiler), otherwise
+        // it costs a single branch per layer. The heap allocations are counted process-wide, so those made
+        // by other threads (e.g. a checkpoint being written) are attributed to the layer running at the time.
+        // Not thread-safe.
+        class Profiler final
+        {
+        public:
+            // The state of the clock & allocation counters at the start of a pass (see Begin).
+            struct Mark
+            {
+                u64 time;
+                u64 numAllocations;
+                u64 numBytesAllocated;
+            };
+
+            Profiler(Profiler const & other) = delete;
+
+            // Constructs a profiler keeping (up to) the first maxNumEvents events for WriteChromeTrace, later
+            // ones are only summarised.
+            explicit Profiler(u64 maxNumEvents = 1024 * 1024);
+
+            // Returns the mark to pass to End once the pass has run.
+            Mark Begin() const;
+            // Records the pass of the layer at layerIndex that started at the supplied mark & did the work
+            // described by cost.
+            void End(Mark const & start, u32 layerIndex, layers::Layer const & layer, ProfiledPass pass, layers::LayerCost const & cost);
+
+            // Discards every event & summary & restarts the clock.
+            void Reset();
+
+            // Returns the number of layers (one more than the largest layerIndex) recorded.
+            u32 GetNumLayers() const;
+            // Returns every call of the supplied pass of the layer at layerIndex, summed.
+            ProfileSummary const & GetSummary(u32 layerIndex, ProfiledPass pass) const;
+            // Returns the events kept, in the order they were recorded.
+            std::vector<ProfileEvent> const & GetEvents() const;
+            // Returns the number of events that were only summarised, as maxNumEvents were already kept.
+            u64 GetNumDroppedEvents() const;
+
+            // Writes the events in the Chrome trace event format (a JSON object of complete, "X", events), each
+            // layer's passes on their own row with the cost & allocations as arguments. Returns false if the
+            // file couldn't be written.
+            bool WriteChromeTrace(char const * path) const;
+
+        private:
+            // Returns the time in nanoseconds of a monotonic clock.
+            static u64 GetTime();
+
+        private:
+            u64 m_MaxNumEvents;
+            u64 m_StartTime;
+            u64 m_NumDroppedEvents;
+            std::vector<ProfileEvent> m_Events;
+            // ProfiledPass::Count summaries per layer.
+            std::vector<ProfileSummary> m_Summaries;
+            // The class of each layer, which names its row of the trace.
+            std::vector<layers::LayerClass> m_LayerClasses;
+        };
+
+        inline u64 DurationHistogram::GetCount() const
+        {
+            return m_Count;
+        }
+
+        inline u64 DurationHistogram::GetBucketCount(u32 bucketIndex) const
+        {
+            ASSERTMSG(bucketIndex < c_NumBuckets, "bucketIndex is out of bounds.");
+            return m_Buckets[bucketIndex];
+        }
+
+        inline u64 DurationHistogram::GetTotal() const
+        {
+            return m_Total;
+        }
+
+        inline u64 DurationHistogram::GetMin() const
+        {
+            return (m_Count > 0) ? m_Min : 0;
+        }
+
+        inline u64 DurationHistogram::GetMax() const
+        {
+            return m_Max;
+        }
+
+        inline u32 Profiler::GetNumLayers() const
+        {
+            return static_cast<u32>(m_Summaries.size() / static_cast<u32>(ProfiledPass::Count));
+        }
+
+        inline std::vector<ProfileEvent> const & Profiler::GetEvents() const
+        {
+            return m_Events;
+        }
+
+        inline u64 Profiler::GetNumDroppedEvents() const
+        {
+            return m_NumDroppedEvents;
+        }
+    }
+}
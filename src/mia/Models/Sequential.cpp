@@ -1,22 +1,37 @@
 #include "Sequential.h"
 
+#include "Models/ModelFormat.h"
+#include "Maths/Random.h"
 #include "Layers/Layer.h"
 #include "Layers/InputLayer.h"
+#include "Layers/Flatten.h"
+#include "Layers/Dense.h"
+
+#include <utility>
 
 namespace mia
 {
     namespace models
     {
         Sequential::Sequential(std::initializer_list<layers::Layer *> const & layers)
-            : m_NumLayers(static_cast<u32>(layers.size()))
+            : Sequential(static_cast<u32>(layers.size()), layers.begin())
+        {
+        }
+
+        Sequential::Sequential(u32 numLayers, layers::Layer * const * layers)
+            : m_Optimizer()
+            , m_NumSteps(0)
+            , m_Loss(0.0f)
+            , m_NumLayers(numLayers)
             , m_Layers()
+            , m_Profiler(nullptr)
         {
             ASSERTMSG(m_NumLayers <= c_MaxNumLayers, "Sequential Model only supports 256 sequential layers.");
 
             u32 layerIndex = 0;
-            for (auto iter = layers.begin(); iter != layers.end(); ++iter)
+            for (; layerIndex < m_NumLayers; ++layerIndex)
             {
-                m_Layers[layerIndex++] = *iter;
+                m_Layers[layerIndex] = layers[layerIndex];
             }
 
             for (; layerIndex < c_MaxNumLayers; ++layerIndex)
@@ -27,6 +42,9 @@ namespace mia
 
         Sequential::~Sequential()
         {
+            // The checkpoint being written (if any) is reading the layers
+            m_Checkpointer.Wait(nullptr);
+
             for (u32 layerIndex = 0; layerIndex < c_MaxNumLayers; ++layerIndex)
             {
                 if (nullptr != m_Layers[layerIndex])
@@ -40,34 +58,211 @@ namespace mia
             }
         }
 
-        void Sequential::Compile(u32 seedValue)
+        void Sequential::Compile(u32 seedValue, u32 maxBatchSize, optimizers::Optimizer const & optimizer)
         {
             ASSERTMSG(m_NumLayers > 0, "Sequential Model cannot have zero layers.");
             ASSERTMSG(layers::LayerType::Input == m_Layers[0]->GetType(), "Sequential Model's first layer isn't an input layer.");
 
+            // Compiling replaces the parameters, so the next checkpoint can't build on the previous one
+            m_Checkpointer.Reset();
+
             u32 layerIndex = 0;
             layers::Layer * layer = m_Layers[layerIndex];
             layers::Layer * prevLayer = nullptr;
             while (nullptr != layer)
             {
-                layer->Compile(seedValue, prevLayer);
+                // Each layer draws from its own generator so layers of the same shape aren't initialised alike
+                layer->Compile(static_cast<u32>(rng::DeriveSeed(seedValue, layerIndex)), prevLayer);
+                layer->Reserve(maxBatchSize);
+                layer->ResetOptimizerState(optimizer.type);
                 prevLayer = layer;
                 layer = m_Layers[++layerIndex];
             }
+
+            m_Optimizer = optimizer;
+            m_NumSteps = 0;
+        }
+
+        std::unique_ptr<Sequential> Sequential::Load(char const * path, u32 maxBatchSize)
+        {
+            MappedFile file;
+            if (!file.Open(path))
+            {
+                return nullptr;
+            }
+
+            format::LayerRecord const * records = nullptr;
+            format::FileHeader const * header = format::ReadHeader(file, &records);
+            if ((nullptr == header) || (header->numLayers > c_MaxNumLayers))
+            {
+                return nullptr;
+            }
+
+            u32 const numLayers = static_cast<u32>(header->numLayers);
+            layers::Layer * loadedLayers[c_MaxNumLayers];
+            for (u32 layerIndex = 0; layerIndex < numLayers; ++layerIndex)
+            {
+                layers::Layer * const prevLayer = (layerIndex > 0) ? loadedLayers[layerIndex - 1] : nullptr;
+                loadedLayers[layerIndex] = format::LoadLayer(file, records[layerIndex], prevLayer);
+
+                if (nullptr == loadedLayers[layerIndex])
+                {
+                    for (u32 lIdx = 0; lIdx < layerIndex; ++lIdx)
+                    {
+                        delete loadedLayers[lIdx];
+                    }
+                    return nullptr;
+                }
+
+                loadedLayers[layerIndex]->Reserve(maxBatchSize, false);
+            }
+
+            std::unique_ptr<Sequential> model(new Sequential(numLayers, loadedLayers));
+            model->m_File = std::move(file);
+            return model;
+        }
+
+        bool Sequential::Save(char const * path) const
+        {
+            ASSERTMSG(m_NumLayers > 0, "Sequential Model cannot have zero layers.");
+
+            format::Layout layout;
+            return format::DescribeModel(m_NumLayers, m_Layers, m_Optimizer.type, m_NumSteps, false, layout) && format::WriteFile(path, layout);
+        }
+
+        void Sequential::Checkpoint(char const * path)
+        {
+            ASSERTMSG(m_NumLayers > 0, "Sequential Model cannot have zero layers.");
+            m_Checkpointer.Begin(path, m_NumLayers, m_Layers, m_Optimizer.type, m_NumSteps);
         }
 
-        void Sequential::Train(NDArrayView<f32> const & inputData, std::initializer_list<f32> const & expectedOutput)
+        bool Sequential::WaitForCheckpoint(u64 * numBytesWritten)
+        {
+            return m_Checkpointer.Wait(numBytesWritten);
+        }
+
+        bool Sequential::Resume(char const * path)
+        {
+            ASSERTMSG(m_NumLayers > 0, "Sequential Model cannot have zero layers.");
+
+            // The checkpoint might be the one still being written
+            m_Checkpointer.Wait(nullptr);
+
+            MappedFile file;
+            if (!file.Open(path))
+            {
+                return false;
+            }
+
+            format::LayerRecord const * records = nullptr;
+            format::FileHeader const * header = format::ReadHeader(file, &records);
+            if ((nullptr == header) || (m_NumLayers != header->numLayers) || (static_cast<u64>(m_Optimizer.type) != header->optimizerType))
+            {
+                return false;
+            }
+
+            // Views the weights, biases & optimizer state of a layer (in that order), returns false if they don't
+            // match the layer
+            u32 const numStateBuffers = optimizers::GetNumStateBuffers(m_Optimizer.type);
+            u32 constexpr c_MaxNumMatrices = 2 + (2 * optimizers::c_MaxNumStateBuffers);
+            auto viewTrainingState = [&](u32 layerIndex, Matrix * matrices) -> bool
+            {
+                layers::Layer const & layer = *m_Layers[layerIndex];
+                format::LayerRecord const & record = records[layerIndex];
+                if (!format::MatchesLayer(record, layer))
+                {
+                    return false;
+                }
+
+                bool isValid = format::ViewBlob(file, record.weights, layer.GetWeights().GetWidth(), layer.GetWeights().GetHeight(), matrices[0]);
+                isValid = isValid && format::ViewBlob(file, record.biases, layer.GetBiases().GetWidth(), layer.GetBiases().GetHeight(), matrices[1]);
+                for (u32 sIdx = 0; isValid && (sIdx < numStateBuffers); ++sIdx)
+                {
+                    Matrix const & weightsState = layer.GetWeightsOptimizerState(sIdx);
+                    Matrix const & biasesState = layer.GetBiasesOptimizerState(sIdx);
+                    isValid = format::ViewBlob(file, record.weightsOptimizerState[sIdx], weightsState.GetWidth(), weightsState.GetHeight(), matrices[2 + (2 * sIdx)]) &&
+                        format::ViewBlob(file, record.biasesOptimizerState[sIdx], biasesState.GetWidth(), biasesState.GetHeight(), matrices[3 + (2 * sIdx)]);
+                }
+
+                return isValid;
+            };
+
+            // Check the whole file matches the model before touching any of the layers
+            Matrix matrices[c_MaxNumMatrices];
+            for (u32 layerIndex = 0; layerIndex < m_NumLayers; ++layerIndex)
+            {
+                if (!viewTrainingState(layerIndex, matrices))
+                {
+                    return false;
+                }
+            }
+
+            for (u32 layerIndex = 0; layerIndex < m_NumLayers; ++layerIndex)
+            {
+                viewTrainingState(layerIndex, matrices);
+
+                f32 const * weightsState[optimizers::c_MaxNumStateBuffers];
+                f32 const * biasesState[optimizers::c_MaxNumStateBuffers];
+                for (u32 sIdx = 0; sIdx < numStateBuffers; ++sIdx)
+                {
+                    weightsState[sIdx] = matrices[2 + (2 * sIdx)].GetData();
+                    biasesState[sIdx] = matrices[3 + (2 * sIdx)].GetData();
+                }
+
+                m_Layers[layerIndex]->LoadTrainingState(matrices[0].GetData(), matrices[1].GetData(), weightsState, biasesState);
+            }
+
+            m_NumSteps = header->numSteps;
+
+            // The layers no longer match any checkpoint that has been written
+            m_Checkpointer.Reset();
+            return true;
+        }
+
+        void Sequential::Train(Tensor const & inputData, std::initializer_list<f32> const & expectedOutput)
+        {
+            TrainBatch(inputData, expectedOutput.begin(), expectedOutput.size());
+        }
+
+        void Sequential::Train(Tensor const & inputData, Tensor const & expectedOutput)
+        {
+            ASSERTMSG((1 == expectedOutput.GetNumDimensions()) || (2 == expectedOutput.GetNumDimensions()), "Sequential Model expects the expectedOutput to hold a single dimension per sample.");
+
+            // The loss is computed from a flat array of the expected outputs, one sample after another
+            Tensor const expectedValues = expectedOutput.Contiguous();
+            TrainBatch(inputData, expectedValues.GetData(), expectedValues.GetNumElements());
+        }
+
+        Matrix const & Sequential::Predict(Tensor const & inputData)
         {
             // Pass the input data into the first layer
             static_cast<layers::InputLayer *>(m_Layers[0])->SetInputData(inputData);
 
-            // Execute the current model based on the new input
-            ForwardPropagation();
+            // Execute the current model on the whole batch at once
+            ForwardPropagation(false);
 
-            // TODO: Backpropagation
+            return m_Layers[m_NumLayers - 1]->GetValues();
         }
 
-        void Sequential::ForwardPropagation()
+        void Sequential::ReleaseUnpackedWeights()
+        {
+            m_Checkpointer.Wait(nullptr);
+
+            for (u32 layerIndex = 0; layerIndex < m_NumLayers; ++layerIndex)
+            {
+                m_Layers[layerIndex]->ReleaseUnpackedWeights();
+            }
+        }
+
+        void Sequential::SetInferencePrecision(kernels::MathPrecision precision)
+        {
+            for (u32 layerIndex = 0; layerIndex < m_NumLayers; ++layerIndex)
+            {
+                m_Layers[layerIndex]->SetInferencePrecision(precision);
+            }
+        }
+
+        void Sequential::ForwardPropagation(bool isTraining)
         {
             // Call execute on each layer sequentially (this propagates foward through the model).
             u32 layerIndex = 0;
@@ -75,10 +270,92 @@ namespace mia
             layers::Layer * prevLayer = nullptr;
             while (nullptr != layer)
             {
-                layer->Execute(prevLayer);
+                layer->SetIsTraining(isTraining);
+                if (nullptr == m_Profiler)
+                {
+                    layer->Execute(prevLayer);
+                }
+                else
+                {
+                    Profiler::Mark const start = m_Profiler->Begin();
+                    layer->Execute(prevLayer);
+                    m_Profiler->End(start, layerIndex, *layer, ProfiledPass::Execute, layer->GetExecuteCost());
+                }
+
                 prevLayer = layer;
                 layer = m_Layers[++layerIndex];
             }
         }
+
+        void Sequential::TrainBatch(Tensor const & inputData, f32 const * expectedOutput, u64 numExpectedValues)
+        {
+            ComputeGradients(inputData, expectedOutput, numExpectedValues);
+            ApplyGradients();
+        }
+
+        void Sequential::ComputeGradients(Tensor const & inputData, f32 const * expectedOutput, u64 numExpectedValues, GradientsReadyFunction onGradientsReady, void * context)
+        {
+            // Pass the input data into the first layer
+            static_cast<layers::InputLayer *>(m_Layers[0])->SetInputData(inputData);
+
+            // Execute the current model based on the new input
+            ForwardPropagation(true);
+
+            // Compute how far the output is from the expected output
+            layers::Layer * outputLayer = m_Layers[m_NumLayers - 1];
+            ASSERTMSG(numExpectedValues == static_cast<u64>(outputLayer->GetNumNeurons()) * outputLayer->GetBatchSize(), "expectedOutput doesn't match the size of the model's output.");
+            (void)numExpectedValues;
+            m_Loss = outputLayer->ComputeLossGradient(expectedOutput);
+
+            // Work out how each parameter contributed to the loss
+            BackPropagation(onGradientsReady, context);
+        }
+
+        void Sequential::ApplyGradients()
+        {
+            // Step each parameter against its gradient
+            ++m_NumSteps;
+            for (u32 layerIndex = 1; layerIndex < m_NumLayers; ++layerIndex)
+            {
+                layers::Layer * layer = m_Layers[layerIndex];
+                m_Checkpointer.BeginUpdate(layerIndex);
+                if (nullptr == m_Profiler)
+                {
+                    layer->ApplyGradients(m_Optimizer, m_NumSteps);
+                }
+                else
+                {
+                    Profiler::Mark const start = m_Profiler->Begin();
+                    layer->ApplyGradients(m_Optimizer, m_NumSteps);
+                    m_Profiler->End(start, layerIndex, *layer, ProfiledPass::ApplyGradients, layer->GetApplyGradientsCost(m_Optimizer.type));
+                }
+            }
+        }
+
+        void Sequential::BackPropagation(GradientsReadyFunction onGradientsReady, void * context)
+        {
+            // Call backpropagate on each layer in reverse order, every layer's parameters are adjusted only once
+            // all of the gradients have been computed so the gradients all refer to the same parameters.
+            for (u32 layerIndex = m_NumLayers - 1; layerIndex > 0; --layerIndex)
+            {
+                layers::Layer * layer = m_Layers[layerIndex];
+                layers::Layer * prevLayer = m_Layers[layerIndex - 1];
+                if (nullptr == m_Profiler)
+                {
+                    layer->Backpropagate(prevLayer);
+                }
+                else
+                {
+                    Profiler::Mark const start = m_Profiler->Begin();
+                    layer->Backpropagate(prevLayer);
+                    m_Profiler->End(start, layerIndex, *layer, ProfiledPass::Backpropagate, layer->GetBackpropagateCost(prevLayer));
+                }
+
+                if (nullptr != onGradientsReady)
+                {
+                    onGradientsReady(context, layerIndex);
+                }
+            }
+        }
     }
 }
@@ -1,6 +1,12 @@
 #pragma once
 
 #include "Models/Model.h"
+#include "Models/Checkpointer.h"
+#include "Models/Profiler.h"
+#include "Core/MappedFile.h"
+#include "Kernels/Kernels.h"
+
+#include <memory>
 
 namespace mia
 {
@@ -11,6 +17,8 @@ namespace mia
 
     namespace models
     {
+        class Trainer;
+
         // A Sequential Model represents an 1 dimensional array of layers where each
         // layer is connected to previous layer with exception of the first layer. The
         // first layer is expected to be an InputLayer.
@@ -22,18 +30,133 @@ namespace mia
 
             // Creates a Sequential Model using the supplied list of heap-allocated layers.
             Sequential(std::initializer_list<layers::Layer *> const & layers);
+            Sequential(u32 numLayers, layers::Layer * const * layers);
+
+            // Loads a model written by Save, ready to execute batches of up to maxBatchSize samples. The file
+            // is memory-mapped & the parameters are read in place rather than copied, so loading takes the same
+            // (few milliseconds) regardless of the size of the model & the parameters' pages are shared by every
+            // process that loads the same file. Only the buffers needed for inference are reserved, training a
+            // loaded model (with the default optimizer) allocates the rest on first use & never modifies the file.
+            // Returns nullptr if the file couldn't be mapped or isn't a valid model file of the current version.
+            static std::unique_ptr<Sequential> Load(char const * path, u32 maxBatchSize = 1);
+
+            // Writes the layer graph & parameters of the model to the supplied path in the binary model format
+            // (see Models/ModelFormat.h). Returns false if the model contains a layer that can't be saved or the
+            // file couldn't be written. Must be called after Compile (or Load). A loaded model must not be saved
+            // over the file it was loaded from, which it is still reading from.
+            bool Save(char const * path) const;
+
+            // Starts writing a checkpoint of the training state of the model (its parameters, optimizer state &
+            // step count) to the supplied path on a background thread & returns straight away, training can carry
+            // on while it is written. Checkpointing again to the same path only rewrites the layers that changed
+            // since the previous checkpoint. Must be called after Compile, waits for the previous checkpoint (if
+            // any) to be written first.
+            void Checkpoint(char const * path);
+            // Waits for the checkpoint being written (if any) & returns true if the last checkpoint was written
+            // successfully. numBytesWritten, if not nullptr, receives the number of bytes of parameters (& optimizer
+            // state) it had to write.
+            bool WaitForCheckpoint(u64 * numBytesWritten = nullptr);
+            // Restores the training state written by Checkpoint into the model, which must have been compiled with
+            // the same layers & optimizer type as the model that was checkpointed. Training then carries on
+            // exactly as it would have from the checkpoint. Returns false (leaving the model untouched) if the
+            // file isn't a complete checkpoint of a model of the same shape.
+            bool Resume(char const * path);
+
+            virtual void Compile(u32 seedValue, u32 maxBatchSize = 1, optimizers::Optimizer const & optimizer = optimizers::Optimizer()) override;
+            virtual void Train(Tensor const & inputData, std::initializer_list<f32> const & expectedOutput) override;
+            virtual void Train(Tensor const & inputData, Tensor const & expectedOutput) override;
+            virtual Matrix const & Predict(Tensor const & inputData) override;
+            virtual void ReleaseUnpackedWeights() override;
+
+            // Returns the number of layers in the model
+            u32 GetNumLayers() const;
+            // Returns the layer at the supplied index
+            layers::Layer const * GetLayer(u32 layerIndex) const;
 
-            virtual void Compile(u32 seedValue) override;
-            virtual void Train(NDArrayView<f32> const & inputData, std::initializer_list<f32> const & expectedOutput) override;
+            // Sets the precision of the layers' activators when predicting (see kernels::MathPrecision), e.g.
+            // MathPrecision::Fast trades a little accuracy for speed. Training is always accurate.
+            void SetInferencePrecision(kernels::MathPrecision precision);
+
+            // Attaches a profiler that records every pass of every layer from then on (see Profiler), or detaches
+            // it if profiler is nullptr. The profiler must outlive the model or be detached first. Models aren't
+            // profiled by default, which costs a single branch per layer.
+            void SetProfiler(Profiler * profiler);
+
+            // Sets the learning rate of the optimizer the model was compiled with (e.g. to follow a schedule).
+            void SetLearningRate(f32 learningRate);
+            // Returns the mean squared error of the model's output over the last training batch (computed
+            // prior to the parameters being adjusted).
+            f32 GetLoss() const;
 
         private:
-            void ForwardPropagation();
+            // Hands the trainers (e.g. DataParallelTrainer) the steps of training they need.
+            friend class Trainer;
+
+            // Called by ComputeGradients with the index of each layer as soon as its gradients have been computed,
+            // while the earlier layers are still being backpropagated (see DistributedTrainer).
+            typedef void (*GradientsReadyFunction)(void * context, u32 layerIndex);
+
+            // Runs a single step of mini-batch gradient descent: ComputeGradients followed by ApplyGradients.
+            // expectedOutput holds numExpectedValues values, one sample after another.
+            void TrainBatch(Tensor const & inputData, f32 const * expectedOutput, u64 numExpectedValues);
+            // Computes the gradients of the loss over the supplied batch with respect to every parameter: forward
+            // propagation, computation of the loss gradient at the output layer & backpropagation. onGradientsReady,
+            // if not nullptr, is called with context for every layer after the input layer, in reverse order.
+            void ComputeGradients(Tensor const & inputData, f32 const * expectedOutput, u64 numExpectedValues, GradientsReadyFunction onGradientsReady = nullptr, void * context = nullptr);
+            // Steps every parameter against the gradients computed by the last call to ComputeGradients.
+            void ApplyGradients();
+
+            // Executes every layer in order. When training, layers also store the values needed
+            // by backpropagation.
+            void ForwardPropagation(bool isTraining);
+            // Propagates the gradient of the loss from the output layer back to the first layer after the
+            // input layer, calling onGradientsReady (if not nullptr) after each layer.
+            void BackPropagation(GradientsReadyFunction onGradientsReady = nullptr, void * context = nullptr);
 
         private:
             static u32 constexpr c_MaxNumLayers = 256;
+            optimizers::Optimizer m_Optimizer;
+            // Number of parameter updates made since the model was compiled.
+            u64 m_NumSteps;
+            f32 m_Loss;
 
             u32 m_NumLayers;
             layers::Layer * m_Layers[c_MaxNumLayers];
+
+            // The model file the layers' parameters are viewing, if the model was loaded (see Load).
+            MappedFile m_File;
+
+            // Writes the checkpoints in the background (see Checkpoint).
+            Checkpointer m_Checkpointer;
+
+            // Records each layer's passes, if attached (see SetProfiler).
+            Profiler * m_Profiler;
         };
+
+        inline u32 Sequential::GetNumLayers() const
+        {
+            return m_NumLayers;
+        }
+
+        inline layers::Layer const * Sequential::GetLayer(u32 layerIndex) const
+        {
+            ASSERTMSG(layerIndex < m_NumLayers, "layerIndex is out of bounds.");
+            return m_Layers[layerIndex];
+        }
+
+        inline void Sequential::SetProfiler(Profiler * profiler)
+        {
+            m_Profiler = profiler;
+        }
+
+        inline void Sequential::SetLearningRate(f32 learningRate)
+        {
+            m_Optimizer.learningRate = learningRate;
+        }
+
+        inline f32 Sequential::GetLoss() const
+        {
+            return m_Loss;
+        }
     }
 }
@@ -0,0 +1,83 @@
+#pragma once
+
+#include "Models/Sequential.h"
+
+namespace mia
+{
+    namespace models
+    {
+        // The base of the classes that train a Sequential model other than through Sequential::Train (see
+        // DataParallelTrainer & DistributedTrainer). It is the model's only friend & hands the trainers just the
+        // steps of training they need, so they never touch the rest of the model's state.
+        class Trainer
+        {
+        protected:
+            Trainer() = default;
+            ~Trainer() = default;
+
+            // Called by ComputeGradients with the index of each layer as soon as its gradients have been computed.
+            typedef Sequential::GradientsReadyFunction GradientsReadyFunction;
+
+            // The most layers a model can hold.
+            static u32 constexpr c_MaxNumLayers = Sequential::c_MaxNumLayers;
+
+            // Returns the layer of the supplied model at the supplied index, whose gradients the trainer may modify.
+            static layers::Layer * GetLayer(Sequential & model, u32 layerIndex);
+            // Returns the optimizer the supplied model was compiled with.
+            static optimizers::Optimizer const & GetOptimizer(Sequential const & model);
+            // Returns the number of parameter updates made since the supplied model was compiled.
+            static u64 GetNumSteps(Sequential const & model);
+
+            // Computes the gradients of the loss over the supplied batch (see Sequential::ComputeGradients).
+            static void ComputeGradients(Sequential & model, Tensor const & inputData, f32 const * expectedOutput, u64 numExpectedValues, GradientsReadyFunction onGradientsReady = nullptr, void * context = nullptr);
+            // Sets the model's loss over the step to the supplied one & steps every parameter against the
+            // gradients of its layers.
+            static void ApplyGradients(Sequential & model, f32 loss);
+
+            // Must be called before the trainer updates the parameters of the supplied layer in place itself,
+            // rather than through ApplyGradients (see Checkpointer::BeginUpdate).
+            static void BeginUpdate(Sequential & model, u32 layerIndex);
+            // Records that the trainer made numSteps updates of the parameters in place, over which the mean loss
+            // was the supplied one.
+            static void EndUpdates(Sequential & model, u64 numSteps, f32 loss);
+        };
+
+        inline layers::Layer * Trainer::GetLayer(Sequential & model, u32 layerIndex)
+        {
+            ASSERTMSG(layerIndex < model.m_NumLayers, "layerIndex is out of bounds.");
+            return model.m_Layers[layerIndex];
+        }
+
+        inline optimizers::Optimizer const & Trainer::GetOptimizer(Sequential const & model)
+        {
+            return model.m_Optimizer;
+        }
+
+        inline u64 Trainer::GetNumSteps(Sequential const & model)
+        {
+            return model.m_NumSteps;
+        }
+
+        inline void Trainer::ComputeGradients(Sequential & model, Tensor const & inputData, f32 const * expectedOutput, u64 numExpectedValues, GradientsReadyFunction onGradientsReady, void * context)
+        {
+            model.ComputeGradients(inputData, expectedOutput, numExpectedValues, onGradientsReady, context);
+        }
+
+        inline void Trainer::ApplyGradients(Sequential & model, f32 loss)
+        {
+            model.m_Loss = loss;
+            model.ApplyGradients();
+        }
+
+        inline void Trainer::BeginUpdate(Sequential & model, u32 layerIndex)
+        {
+            model.m_Checkpointer.BeginUpdate(layerIndex);
+        }
+
+        inline void Trainer::EndUpdates(Sequential & model, u64 numSteps, f32 loss)
+        {
+            model.m_NumSteps += numSteps;
+            model.m_Loss = loss;
+        }
+    }
+}
@@ -0,0 +1,154 @@
+#include "Optimizer.h"
+
+#include "Core/ThreadPool.h"
+#include "Kernels/Kernels.h"
+
+#include <math.h>
+
+namespace mia
+{
+    namespace optimizers
+    {
+        namespace
+        {
+            // The updates are bound by memory bandwidth, only split them across threads when each thread
+            // gets enough parameters to amortise waking it.
+            u64 constexpr c_MinParametersPerThread = 64 * 1024;
+        }
+
+        Optimizer Optimizer::SGD(f32 learningRate, f32 weightDecay)
+        {
+            Optimizer optimizer;
+            optimizer.type = OptimizerType::SGD;
+            optimizer.learningRate = learningRate;
+            optimizer.weightDecay = weightDecay;
+            return optimizer;
+        }
+
+        Optimizer Optimizer::Momentum(f32 learningRate, f32 momentum, f32 weightDecay)
+        {
+            Optimizer optimizer;
+            optimizer.type = OptimizerType::Momentum;
+            optimizer.learningRate = learningRate;
+            optimizer.momentum = momentum;
+            optimizer.weightDecay = weightDecay;
+            return optimizer;
+        }
+
+        Optimizer Optimizer::Adam(f32 learningRate, f32 beta1, f32 beta2, f32 epsilon)
+        {
+            Optimizer optimizer;
+            optimizer.type = OptimizerType::Adam;
+            optimizer.learningRate = learningRate;
+            optimizer.beta1 = beta1;
+            optimizer.beta2 = beta2;
+            optimizer.epsilon = epsilon;
+            return optimizer;
+        }
+
+        Optimizer Optimizer::AdamW(f32 learningRate, f32 weightDecay, f32 beta1, f32 beta2, f32 epsilon)
+        {
+            Optimizer optimizer = Adam(learningRate, beta1, beta2, epsilon);
+            optimizer.type = OptimizerType::AdamW;
+            optimizer.weightDecay = weightDecay;
+            return optimizer;
+        }
+
+        u32 GetNumStateBuffers(OptimizerType type)
+        {
+            switch (type)
+            {
+                case OptimizerType::SGD:        return 0;
+                case OptimizerType::Momentum:   return 1;
+                case OptimizerType::Adam:       return 2;
+                case OptimizerType::AdamW:      return 2;
+
+                default:
+                    ASSERTMSG(false, "Unknown OptimizerType.");
+                    break;
+            }
+
+            return 0;
+        }
+
+        u32 GetNumFlopsPerParameter(OptimizerType type)
+        {
+            // As written by the update kernels (see kernels::SGDUpdate & kernels::AdamUpdate), counting each
+            // fused multiply-add as two operations & the square root as one.
+            switch (type)
+            {
+                case OptimizerType::SGD:        return 4;
+                case OptimizerType::Momentum:   return 6;
+                case OptimizerType::Adam:       return 16;
+                case OptimizerType::AdamW:      return 16;
+
+                default:
+                    ASSERTMSG(false, "Unknown OptimizerType.");
+                    break;
+            }
+
+            return 0;
+        }
+
+        void Update(Optimizer const & optimizer, u64 stepIndex, f32 * parameters, f32 const * gradients, f32 * const * state, u64 numParameters)
+        {
+            ASSERTMSG(stepIndex > 0, "stepIndex starts from 1.");
+
+            if (0 == numParameters)
+            {
+                return;
+            }
+
+            switch (optimizer.type)
+            {
+                case OptimizerType::SGD:
+                case OptimizerType::Momentum:
+                {
+                    kernels::SGDStep step;
+                    step.learningRate = optimizer.learningRate;
+                    step.momentum = optimizer.momentum;
+                    step.weightDecay = optimizer.weightDecay;
+
+                    f32 * velocity = (OptimizerType::Momentum == optimizer.type) ? state[0] : nullptr;
+
+                    ThreadPool::Get().ParallelFor(numParameters, c_MinParametersPerThread, [&](u64 begin, u64 end)
+                    {
+                        kernels::SGDUpdate(parameters + begin, (nullptr != velocity) ? velocity + begin : nullptr, gradients + begin, end - begin, step);
+                    });
+                    break;
+                }
+
+                case OptimizerType::Adam:
+                case OptimizerType::AdamW:
+                {
+                    // Fold the bias corrections of both moments into the step's constants
+                    f64 const firstMomentCorrection = 1.0 - pow(static_cast<f64>(optimizer.beta1), static_cast<f64>(stepIndex));
+                    f64 const secondMomentCorrection = 1.0 - pow(static_cast<f64>(optimizer.beta2), static_cast<f64>(stepIndex));
+                    bool const isDecoupled = (OptimizerType::AdamW == optimizer.type);
+
+                    kernels::AdamStep step;
+                    step.beta1 = optimizer.beta1;
+                    step.beta2 = optimizer.beta2;
+                    step.epsilon = optimizer.epsilon;
+                    step.stepSize = static_cast<f32>(optimizer.learningRate / firstMomentCorrection);
+                    step.rsqrtSecondMomentCorrection = static_cast<f32>(1.0 / sqrt(secondMomentCorrection));
+                    step.gradientDecay = isDecoupled ? 0.0f : optimizer.weightDecay;
+                    step.parameterDecay = isDecoupled ? (optimizer.learningRate * optimizer.weightDecay) : 0.0f;
+
+                    f32 * moment1 = state[0];
+                    f32 * moment2 = state[1];
+
+                    ThreadPool::Get().ParallelFor(numParameters, c_MinParametersPerThread, [&](u64 begin, u64 end)
+                    {
+                        kernels::AdamUpdate(parameters + begin, moment1 + begin, moment2 + begin, gradients + begin, end - begin, step);
+                    });
+                    break;
+                }
+
+                default:
+                    ASSERTMSG(false, "Unknown OptimizerType.");
+                    break;
+            }
+        }
+    }
+}
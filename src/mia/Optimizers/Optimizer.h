@@ -0,0 +1,66 @@
+#pragma once
+
+#include "Common.h"
+
+namespace mia
+{
+    namespace optimizers
+    {
+        enum class OptimizerType : u8
+        {
+            SGD,
+            Momentum,
+            Adam,
+            AdamW
+        };
+
+        // The largest number of state buffers (each the size of the parameters being trained) any
+        // optimizer keeps per parameter matrix.
+        u32 constexpr c_MaxNumStateBuffers = 2;
+
+        // Describes how the trainable parameters of a model are updated from their gradients. Only the
+        // hyperparameters used by the selected type are read.
+        struct Optimizer
+        {
+            OptimizerType type = OptimizerType::SGD;
+            f32 learningRate = 0.01f;
+
+            // Momentum
+            f32 momentum = 0.9f;
+
+            // Adam & AdamW
+            f32 beta1 = 0.9f;
+            f32 beta2 = 0.999f;
+            f32 epsilon = 1e-8f;
+
+            // An L2 penalty added to the gradients for SGD, Momentum & Adam. Decoupled from the gradients
+            // (& scaled by the learning rate) for AdamW.
+            f32 weightDecay = 0.0f;
+
+            // Returns plain stochastic gradient descent.
+            static Optimizer SGD(f32 learningRate, f32 weightDecay = 0.0f);
+            // Returns stochastic gradient descent with (heavy ball) momentum.
+            static Optimizer Momentum(f32 learningRate, f32 momentum = 0.9f, f32 weightDecay = 0.0f);
+            // Returns Adam (Kingma & Ba, 2014).
+            static Optimizer Adam(f32 learningRate = 1e-3f, f32 beta1 = 0.9f, f32 beta2 = 0.999f, f32 epsilon = 1e-8f);
+            // Returns Adam with decoupled weight decay (Loshchilov & Hutter, 2017).
+            static Optimizer AdamW(f32 learningRate = 1e-3f, f32 weightDecay = 1e-2f, f32 beta1 = 0.9f, f32 beta2 = 0.999f, f32 epsilon = 1e-8f);
+        };
+
+        // Returns the number of state buffers the optimizer of the supplied type keeps per parameter
+        // matrix, i.e. the momentum's velocity or Adam's first & second moments.
+        u32 GetNumStateBuffers(OptimizerType type);
+
+        // Returns the number of floating point operations Update performs per parameter for the optimizer of
+        // the supplied type, e.g. to profile a model.
+        u32 GetNumFlopsPerParameter(OptimizerType type);
+
+        // Updates numParameters parameters in place from their gradients. state points at the optimizer's
+        // GetNumStateBuffers state buffers (each holding numParameters elements & zeroed before the first
+        // step) & stepIndex is the number of updates made so far, including this one (starting from 1).
+        //
+        // Every parameter is read & written exactly once by a single SIMD kernel (see Kernels/Kernels.h),
+        // large parameter matrices are split across the threads of the thread pool.
+        void Update(Optimizer const & optimizer, u64 stepIndex, f32 * parameters, f32 const * gradients, f32 * const * state, u64 numParameters);
+    }
+}
@@ -0,0 +1,282 @@
+#include "Benchmark.h"
+
+#include "Core/ThreadPool.h"
+#include "Kernels/KernelTable.h"
+
+#include <algorithm>
+#include <chrono>
+#include <stdarg.h>
+#include <stdio.h>
+
+namespace mia
+{
+    namespace bench
+    {
+        namespace
+        {
+            typedef std::chrono::steady_clock Clock;
+
+            // Batches are sized so that each takes at least this long.
+            f64 constexpr c_MinBatchNs = 10000.0;
+            // Upper bound on the number of batches timed per benchmark.
+            u64 constexpr c_MaxNumBatches = 100000;
+            // Lower bound on the number of batches timed per benchmark (so the percentiles mean something).
+            u64 constexpr c_MinNumBatches = 10;
+
+            struct Benchmark
+            {
+                std::string name;
+                Setup setup;
+            };
+
+            std::vector<Benchmark> & GetBenchmarks()
+            {
+                static std::vector<Benchmark> s_Benchmarks;
+                return s_Benchmarks;
+            }
+
+            // Returns the time taken to run numIterations iterations, in nanoseconds.
+            f64 TimeIterations(Iteration const & iteration, u64 numIterations)
+            {
+                Clock::time_point const start = Clock::now();
+                for (u64 iIdx = 0; iIdx < numIterations; ++iIdx)
+                {
+                    iteration();
+                }
+                return std::chrono::duration<f64, std::nano>(Clock::now() - start).count();
+            }
+
+            // Returns the value below which the supplied fraction of the (sorted) samples fall.
+            f64 GetPercentile(std::vector<f64> const & sortedSamples, f64 fraction)
+            {
+                u64 const index = static_cast<u64>(fraction * static_cast<f64>(sortedSamples.size() - 1) + 0.5);
+                return sortedSamples[std::min<u64>(index, sortedSamples.size() - 1)];
+            }
+
+            // Runs the benchmark into result. Returns false if it failed to be set up.
+            bool Run(Benchmark const & benchmark, Options const & options, Result & result)
+            {
+                result.name = benchmark.name;
+
+                Iteration const iteration = benchmark.setup(result.counters);
+                if (!iteration)
+                {
+                    return false;
+                }
+
+                // Warm up (caches, lazily allocated scratch buffers & the thread pool) & work out how many
+                // iterations to time together.
+                f64 const warmUpNs = std::max(TimeIterations(iteration, 1), 1.0);
+                u64 const batchSize = std::max<u64>(1, static_cast<u64>(c_MinBatchNs / warmUpNs));
+
+                std::vector<f64> samples;
+                f64 totalNs = 0.0;
+                while ((samples.size() < c_MaxNumBatches) && ((totalNs < options.minTime * 1e9) || (samples.size() < c_MinNumBatches)))
+                {
+                    f64 const batchNs = TimeIterations(iteration, batchSize);
+                    samples.push_back(batchNs / static_cast<f64>(batchSize));
+                    totalNs += batchNs;
+                }
+
+                result.numIterations = samples.size() * batchSize;
+                result.meanNs = totalNs / static_cast<f64>(result.numIterations);
+
+                std::sort(samples.begin(), samples.end());
+                result.minNs = samples.front();
+                result.p50Ns = GetPercentile(samples, 0.5);
+                result.p90Ns = GetPercentile(samples, 0.9);
+                result.p99Ns = GetPercentile(samples, 0.99);
+                result.maxNs = samples.back();
+
+                f64 const p50Seconds = result.p50Ns * 1e-9;
+                result.flopsPerSecond = result.counters.flops / p50Seconds;
+                result.bytesPerSecond = result.counters.bytes / p50Seconds;
+                result.itemsPerSecond = result.counters.items / p50Seconds;
+
+                return true;
+            }
+
+            // Prints a latency with a unit that keeps it readable.
+            void PrintLatency(f64 ns)
+            {
+                if (ns < 1e3)
+                {
+                    printf(" %9.1f ns", ns);
+                }
+                else if (ns < 1e6)
+                {
+                    printf(" %9.2f us", ns * 1e-3);
+                }
+                else
+                {
+                    printf(" %9.2f ms", ns * 1e-6);
+                }
+            }
+
+            void PrintHeader()
+            {
+                printf("%-52s %12s %12s %12s %10s %10s %14s\n", "Benchmark", "p50", "p90", "p99", "GFLOP/s", "GB/s", "items/s");
+                printf("%s\n", std::string(128, '-').c_str());
+            }
+
+            void PrintResult(Result const & result)
+            {
+                printf("%-52s", result.name.c_str());
+                PrintLatency(result.p50Ns);
+                PrintLatency(result.p90Ns);
+                PrintLatency(result.p99Ns);
+
+                if (result.counters.flops > 0.0)
+                {
+                    printf(" %10.2f", result.flopsPerSecond * 1e-9);
+                }
+                else
+                {
+                    printf(" %10s", "-");
+                }
+
+                if (result.counters.bytes > 0.0)
+                {
+                    printf(" %10.2f", result.bytesPerSecond * 1e-9);
+                }
+                else
+                {
+                    printf(" %10s", "-");
+                }
+
+                if (result.counters.items > 0.0)
+                {
+                    printf(" %14.0f", result.itemsPerSecond);
+                }
+                else
+                {
+                    printf(" %14s", "-");
+                }
+
+                printf("\n");
+                fflush(stdout);
+            }
+
+            // Writes str as a JSON string (benchmark names only contain printable ASCII).
+            void WriteJsonString(FILE * file, std::string const & str)
+            {
+                fputc('"', file);
+                for (u64 cIdx = 0; cIdx < str.size(); ++cIdx)
+                {
+                    if (('"' == str[cIdx]) || ('\\' == str[cIdx]))
+                    {
+                        fputc('\\', file);
+                    }
+                    fputc(str[cIdx], file);
+                }
+                fputc('"', file);
+            }
+        }
+
+        std::string Format(char const * format, ...)
+        {
+            char buffer[256];
+
+            va_list args;
+            va_start(args, format);
+            vsnprintf(buffer, sizeof(buffer), format, args);
+            va_end(args);
+
+            return buffer;
+        }
+
+        void Register(std::string const & name, Setup const & setup)
+        {
+            Benchmark benchmark;
+            benchmark.name = name;
+            benchmark.setup = setup;
+            GetBenchmarks().push_back(benchmark);
+        }
+
+        std::vector<Result> RunBenchmarks(Options const & options, u32 * numFailed)
+        {
+            ThreadPool::Get().SetNumThreads(options.numThreads);
+
+            printf("mia_bench: %lu thread(s), %s kernels\n\n", static_cast<unsigned long>(ThreadPool::Get().GetNumThreads()), kernels::GetKernelTable().name);
+            PrintHeader();
+
+            std::vector<Result> results;
+            u32 failedCount = 0;
+            std::vector<Benchmark> const & benchmarks = GetBenchmarks();
+            for (u64 bIdx = 0; bIdx < benchmarks.size(); ++bIdx)
+            {
+                if (!options.filter.empty() && (std::string::npos == benchmarks[bIdx].name.find(options.filter)))
+                {
+                    continue;
+                }
+
+                Result result;
+                if (!Run(benchmarks[bIdx], options, result))
+                {
+                    printf("%-52s failed to set up\n", result.name.c_str());
+                    fflush(stdout);
+                    ++failedCount;
+                    continue;
+                }
+
+                results.push_back(result);
+                PrintResult(results.back());
+            }
+
+            if (nullptr != numFailed)
+            {
+                *numFailed = failedCount;
+            }
+
+            return results;
+        }
+
+        bool WriteJson(std::string const & path, Options const & options, std::vector<Result> const & results)
+        {
+            FILE * file = fopen(path.c_str(), "w");
+            if (nullptr == file)
+            {
+                return false;
+            }
+
+            fprintf(file, "{\n");
+            fprintf(file, "  \"context\": {\n");
+            fprintf(file, "    \"library\": \"mia\",\n");
+            fprintf(file, "    \"num_threads\": %lu,\n", static_cast<unsigned long>(ThreadPool::Get().GetNumThreads()));
+            fprintf(file, "    \"kernels\": \"%s\",\n", kernels::GetKernelTable().name);
+            fprintf(file, "    \"benchmark_min_time\": %g\n", options.minTime);
+            fprintf(file, "  },\n");
+            fprintf(file, "  \"benchmarks\": [\n");
+
+            for (u64 rIdx = 0; rIdx < results.size(); ++rIdx)
+            {
+                Result const & result = results[rIdx];
+
+                fprintf(file, "    {\n");
+                fprintf(file, "      \"name\": ");
+                WriteJsonString(file, result.name);
+                fprintf(file, ",\n");
+                fprintf(file, "      \"iterations\": %llu,\n", static_cast<unsigned long long>(result.numIterations));
+                fprintf(file, "      \"time_unit\": \"ns\",\n");
+                fprintf(file, "      \"real_time\": %.3f,\n", result.meanNs);
+                fprintf(file, "      \"min_time\": %.3f,\n", result.minNs);
+                fprintf(file, "      \"p50_time\": %.3f,\n", result.p50Ns);
+                fprintf(file, "      \"p90_time\": %.3f,\n", result.p90Ns);
+                fprintf(file, "      \"p99_time\": %.3f,\n", result.p99Ns);
+                fprintf(file, "      \"max_time\": %.3f,\n", result.maxNs);
+                fprintf(file, "      \"flops_per_iteration\": %.0f,\n", result.counters.flops);
+                fprintf(file, "      \"bytes_per_iteration\": %.0f,\n", result.counters.bytes);
+                fprintf(file, "      \"items_per_iteration\": %.0f,\n", result.counters.items);
+                fprintf(file, "      \"flops_per_second\": %.6e,\n", result.flopsPerSecond);
+                fprintf(file, "      \"bytes_per_second\": %.6e,\n", result.bytesPerSecond);
+                fprintf(file, "      \"items_per_second\": %.6e\n", result.itemsPerSecond);
+                fprintf(file, "    }%s\n", (rIdx + 1 < results.size()) ? "," : "");
+            }
+
+            fprintf(file, "  ]\n");
+            fprintf(file, "}\n");
+
+            return 0 == fclose(file);
+        }
+    }
+}
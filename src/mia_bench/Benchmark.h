@@ -0,0 +1,90 @@
+#pragma once
+
+#include "Common.h"
+
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace mia
+{
+    namespace bench
+    {
+        // The work performed by a single iteration of a benchmark. Throughputs are only reported for
+        // the counters that are set.
+        struct Counters
+        {
+            // Floating point operations (a multiply-add counts as two).
+            f64 flops = 0.0;
+            // Bytes read & written from/to memory, assuming nothing is cached between iterations.
+            f64 bytes = 0.0;
+            // Application level items, e.g. the samples of a training batch.
+            f64 items = 0.0;
+        };
+
+        // A single timed iteration of a benchmark.
+        typedef std::function<void()> Iteration;
+
+        // Prepares the inputs of a benchmark (outside of the timed region), fills in the work done per
+        // iteration & returns the iteration to be timed. Everything the iteration needs must be owned by
+        // (i.e. captured into) the returned function. Returns an empty function if the benchmark can't be
+        // set up, it is then reported as failed instead of being run.
+        typedef std::function<Iteration(Counters & counters)> Setup;
+
+        // Registers a benchmark to be run by RunBenchmarks. Names are expected to be unique & are
+        // structured as "group/case", e.g. "Multiply/256x256x256".
+        void Register(std::string const & name, Setup const & setup);
+
+        struct Options
+        {
+            // Only benchmarks whose name contains this string are run (all of them if empty).
+            std::string filter;
+            // Minimum time, in seconds, to spend measuring each benchmark.
+            f64 minTime = 0.5;
+            // Number of threads the thread pool runs with (0 uses every hardware thread).
+            u32 numThreads = 0;
+        };
+
+        struct Result
+        {
+            std::string name;
+            Counters counters;
+
+            // Total number of timed iterations.
+            u64 numIterations = 0;
+
+            // Latency of a single iteration, in nanoseconds. Fast iterations are timed in batches (see
+            // RunBenchmarks) so the percentiles are over the mean latency of each batch.
+            f64 minNs = 0.0;
+            f64 meanNs = 0.0;
+            f64 p50Ns = 0.0;
+            f64 p90Ns = 0.0;
+            f64 p99Ns = 0.0;
+            f64 maxNs = 0.0;
+
+            // Throughputs derived from the median latency (zero if the matching counter isn't set).
+            f64 flopsPerSecond = 0.0;
+            f64 bytesPerSecond = 0.0;
+            f64 itemsPerSecond = 0.0;
+        };
+
+        // Returns a printf style formatted string, for building benchmark names.
+        std::string Format(char const * format, ...);
+
+        // Runs every registered benchmark that matches options.filter, in the order they were registered,
+        // printing a line per benchmark as it completes.
+        //
+        // Each benchmark is warmed up with one iteration & then timed in batches of iterations sized so
+        // each batch takes at least a few microseconds (which keeps the cost of reading the clock out of
+        // the measurement). Batches are timed until options.minTime has elapsed.
+        //
+        // Benchmarks that fail to be set up are left out of the results, numFailed (if not nullptr) receives
+        // how many did.
+        std::vector<Result> RunBenchmarks(Options const & options, u32 * numFailed);
+
+        // Writes the results (along with a description of the machine & build) as JSON. The layout follows
+        // the one used by Google Benchmark so existing tooling can compare two runs. Returns false if the
+        // file couldn't be written.
+        bool WriteJson(std::string const & path, Options const & options, std::vector<Result> const & results);
+    }
+}
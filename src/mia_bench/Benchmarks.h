@@ -0,0 +1,15 @@
+#pragma once
+
+namespace mia
+{
+    namespace bench
+    {
+        // Registers benchmarks of the individual maths operations (Multiply, Transpose, Add & the activators)
+        // over a sweep of shapes.
+        void RegisterMicroBenchmarks();
+
+        // Registers benchmarks of whole Sequential models (inference & training steps) over several MLP sizes
+        // & batch sizes.
+        void RegisterMacroBenchmarks();
+    }
+}
@@ -0,0 +1,564 @@
+#include "Benchmarks.h"
+#include "Benchmark.h"
+
+#include "Data/DatasetReader.h"
+#include "Data/SampleStore.h"
+#include "Maths/Random.h"
+#include "Models/Sequential.h"
+#include "Models/DataParallelTrainer.h"
+#include "Models/FixedSequential.h"
+#include "Layers/Flatten.h"
+#include "Layers/Dense.h"
+
+#include <memory>
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+namespace mia
+{
+    namespace bench
+    {
+        namespace
+        {
+            // Describes a multilayer perceptron: ReLU hidden layers followed by a Sigmoid output layer.
+            struct MLP
+            {
+                char const * name;
+                u32 numInputs;
+                u32 numHiddenLayers;
+                u32 numHiddenNeurons[2];
+                u32 numOutputs;
+            };
+
+            // Owns the model & the data of a macro benchmark.
+            struct ModelState
+            {
+                std::unique_ptr<models::Sequential> model;
+                std::vector<f32> inputData;
+                std::vector<f32> expectedOutputData;
+                Tensor input;
+                Tensor expectedOutput;
+            };
+
+            models::Sequential * CreateModel(MLP const & mlp)
+            {
+                activators::ActivatorType const hidden = activators::ActivatorType::ReLU;
+                activators::ActivatorType const output = activators::ActivatorType::Sigmoid;
+
+                switch (mlp.numHiddenLayers)
+                {
+                    case 1:
+                        return new models::Sequential({
+                            new layers::Flatten({ mlp.numInputs }, activators::ActivatorType::None),
+                            new layers::Dense(mlp.numHiddenNeurons[0], hidden),
+                            new layers::Dense(mlp.numOutputs, output)
+                        });
+
+                    case 2:
+                        return new models::Sequential({
+                            new layers::Flatten({ mlp.numInputs }, activators::ActivatorType::None),
+                            new layers::Dense(mlp.numHiddenNeurons[0], hidden),
+                            new layers::Dense(mlp.numHiddenNeurons[1], hidden),
+                            new layers::Dense(mlp.numOutputs, output)
+                        });
+
+                    default:
+                        ASSERTMSG(false, "Unsupported number of hidden layers.");
+                        break;
+                }
+
+                return nullptr;
+            }
+
+            // Fills data with deterministic values in the range [0, 1).
+            void FillData(std::vector<f32> & data, u32 seed)
+            {
+                u32 state = seed;
+                for (u64 eIdx = 0; eIdx < data.size(); ++eIdx)
+                {
+                    state = (state * 1664525u) + 1013904223u;
+                    data[eIdx] = static_cast<f32>(state >> 8) / static_cast<f32>(1 << 24);
+                }
+            }
+
+            std::shared_ptr<ModelState> CreateModelState(MLP const & mlp, u32 batchSize, optimizers::Optimizer const & optimizer)
+            {
+                std::shared_ptr<ModelState> state = std::make_shared<ModelState>();
+                state->model.reset(CreateModel(mlp));
+                state->model->Compile(0, batchSize, optimizer);
+
+                state->inputData.resize(static_cast<u64>(mlp.numInputs) * batchSize);
+                state->expectedOutputData.resize(static_cast<u64>(mlp.numOutputs) * batchSize);
+                FillData(state->inputData, 1);
+                FillData(state->expectedOutputData, 2);
+
+                state->input = Tensor::Borrow(state->inputData.data(), { batchSize, mlp.numInputs });
+                state->expectedOutput = Tensor::Borrow(state->expectedOutputData.data(), { batchSize, mlp.numOutputs });
+
+                return state;
+            }
+
+            // Returns the number of multiply-adds of the weights of every Dense layer for a single sample,
+            // i.e. the number of weights in the model.
+            f64 GetNumWeights(MLP const & mlp)
+            {
+                f64 numWeights = 0.0;
+                u32 numPrevNeurons = mlp.numInputs;
+                for (u32 lIdx = 0; lIdx < mlp.numHiddenLayers; ++lIdx)
+                {
+                    numWeights += static_cast<f64>(numPrevNeurons) * mlp.numHiddenNeurons[lIdx];
+                    numPrevNeurons = mlp.numHiddenNeurons[lIdx];
+                }
+                return numWeights + (static_cast<f64>(numPrevNeurons) * mlp.numOutputs);
+            }
+
+            void RegisterPredict(MLP const & mlp, u32 batchSize)
+            {
+                Register(Format("Sequential/Predict/%s/batch:%lu", mlp.name, batchSize), [=](Counters & counters) -> Iteration
+                {
+                    std::shared_ptr<ModelState> state = CreateModelState(mlp, batchSize, optimizers::Optimizer());
+
+                    // One multiply-add per weight per sample
+                    counters.flops = 2.0 * GetNumWeights(mlp) * batchSize;
+                    counters.bytes = sizeof(f32) * GetNumWeights(mlp);
+                    counters.items = batchSize;
+
+                    return [state]()
+                    {
+                        state->model->Predict(state->input);
+                    };
+                });
+            }
+
+            // The compile-time counterparts of the MLPs (see CreateModel) that are small enough for FixedSequential
+            typedef models::FixedSequential<
+                models::FixedDense<2, 8, activators::ActivatorType::ReLU>,
+                models::FixedDense<8, 1, activators::ActivatorType::Sigmoid>> FixedXOR;
+            typedef models::FixedSequential<
+                models::FixedDense<64, 32, activators::ActivatorType::ReLU>,
+                models::FixedDense<32, 10, activators::ActivatorType::Sigmoid>> FixedMLP64;
+
+            // Predicts a single sample through a FixedSequential copy of the MLP, Fixed must match its layers.
+            template <class Fixed>
+            void RegisterFixedPredict(MLP const & mlp)
+            {
+                Register(Format("FixedSequential/Predict/%s/batch:1", mlp.name), [=](Counters & counters) -> Iteration
+                {
+                    std::shared_ptr<ModelState> state = CreateModelState(mlp, 1, optimizers::Optimizer());
+                    std::shared_ptr<Fixed> fixed = std::make_shared<Fixed>();
+                    std::shared_ptr<std::vector<f32>> output = std::make_shared<std::vector<f32>>(mlp.numOutputs);
+
+                    if (!fixed->Load(*state->model))
+                    {
+                        return nullptr;
+                    }
+
+                    counters.flops = 2.0 * GetNumWeights(mlp);
+                    counters.bytes = sizeof(f32) * GetNumWeights(mlp);
+                    counters.items = 1;
+
+                    return [state, fixed, output]()
+                    {
+                        fixed->Predict(state->inputData.data(), output->data());
+                    };
+                });
+            }
+
+            // A model file that is deleted along with the benchmark that uses it.
+            struct ModelFile
+            {
+                std::string path;
+
+                ~ModelFile()
+                {
+                    remove(path.c_str());
+                }
+            };
+
+            void RegisterLoad(MLP const & mlp)
+            {
+                Register(Format("Sequential/Load/%s", mlp.name), [=](Counters & counters) -> Iteration
+                {
+                    std::shared_ptr<ModelFile> file = std::make_shared<ModelFile>();
+                    file->path = Format("mia_bench.%s.miamodel", mlp.name);
+
+                    {
+                        std::unique_ptr<models::Sequential> model(CreateModel(mlp));
+                        model->Compile(0);
+                        model->Save(file->path.c_str());
+                    }
+
+                    // The weights are saved twice, row-major & packed for the matrix multiplication
+                    counters.bytes = 2.0 * sizeof(f32) * GetNumWeights(mlp);
+                    counters.items = 1;
+
+                    return [file]()
+                    {
+                        std::unique_ptr<models::Sequential> model = models::Sequential::Load(file->path.c_str());
+                        ASSERTMSG(nullptr != model, "Failed to load the model.");
+                    };
+                });
+            }
+
+            void RegisterTrain(MLP const & mlp, u32 batchSize, char const * optimizerName, optimizers::Optimizer const & optimizer)
+            {
+                Register(Format("Sequential/Train/%s/%s/batch:%lu", mlp.name, optimizerName, batchSize), [=](Counters & counters) -> Iteration
+                {
+                    std::shared_ptr<ModelState> state = CreateModelState(mlp, batchSize, optimizer);
+
+                    // The forward pass & the weight gradients each take one multiply-add per weight per sample,
+                    // as does propagating the gradient back to every layer but the first Dense layer.
+                    f64 const numFirstLayerWeights = static_cast<f64>(mlp.numInputs) * mlp.numHiddenNeurons[0];
+                    counters.flops = 2.0 * ((3.0 * GetNumWeights(mlp)) - numFirstLayerWeights) * batchSize;
+                    // The weights are read by the forward & backward passes, their gradients are written &
+                    // then both are read & the weights written by the update.
+                    counters.bytes = 5.0 * sizeof(f32) * GetNumWeights(mlp);
+                    counters.items = batchSize;
+
+                    return [state]()
+                    {
+                        state->model->Train(state->input, state->expectedOutput);
+                    };
+                });
+            }
+
+            // Trains like RegisterTrain while checkpointing the model every checkpointInterval steps, the
+            // difference between the two is the overhead of checkpointing.
+            void RegisterTrainWithCheckpoints(MLP const & mlp, u32 batchSize, u32 checkpointInterval)
+            {
+                Register(Format("Sequential/TrainWithCheckpoints/%s/Adam/batch:%lu/every:%lu", mlp.name, batchSize, checkpointInterval), [=](Counters & counters) -> Iteration
+                {
+                    // The model is destroyed (which waits for its checkpoint) before the file is deleted
+                    struct CheckpointState
+                    {
+                        ModelFile file;
+                        std::shared_ptr<ModelState> state;
+                        u64 numSteps;
+                    };
+
+                    std::shared_ptr<CheckpointState> checkpointState = std::make_shared<CheckpointState>();
+                    checkpointState->file.path = Format("mia_bench.%s.miackpt", mlp.name);
+                    checkpointState->state = CreateModelState(mlp, batchSize, optimizers::Optimizer::Adam());
+                    checkpointState->numSteps = 0;
+
+                    f64 const numFirstLayerWeights = static_cast<f64>(mlp.numInputs) * mlp.numHiddenNeurons[0];
+                    counters.flops = 2.0 * ((3.0 * GetNumWeights(mlp)) - numFirstLayerWeights) * batchSize;
+                    counters.bytes = 5.0 * sizeof(f32) * GetNumWeights(mlp);
+                    counters.items = batchSize;
+
+                    return [checkpointState, checkpointInterval]()
+                    {
+                        ModelState & state = *checkpointState->state;
+                        state.model->Train(state.input, state.expectedOutput);
+
+                        if (0 == (++checkpointState->numSteps % checkpointInterval))
+                        {
+                            state.model->Checkpoint(checkpointState->file.path.c_str());
+                        }
+                    };
+                });
+            }
+
+            // Trains like RegisterTrain with a profiler attached to the model, the difference between the two is
+            // the overhead of profiling (which is largest for the smallest models).
+            void RegisterTrainWithProfiler(MLP const & mlp, u32 batchSize)
+            {
+                Register(Format("Sequential/TrainWithProfiler/%s/SGD/batch:%lu", mlp.name, batchSize), [=](Counters & counters) -> Iteration
+                {
+                    // The profiler is destroyed after the model it is attached to
+                    struct ProfilerState
+                    {
+                        models::Profiler profiler;
+                        std::shared_ptr<ModelState> state;
+                    };
+
+                    std::shared_ptr<ProfilerState> profilerState = std::make_shared<ProfilerState>();
+                    profilerState->state = CreateModelState(mlp, batchSize, optimizers::Optimizer::SGD(0.01f));
+                    profilerState->state->model->SetProfiler(&profilerState->profiler);
+
+                    f64 const numFirstLayerWeights = static_cast<f64>(mlp.numInputs) * mlp.numHiddenNeurons[0];
+                    counters.flops = 2.0 * ((3.0 * GetNumWeights(mlp)) - numFirstLayerWeights) * batchSize;
+                    counters.bytes = 5.0 * sizeof(f32) * GetNumWeights(mlp);
+                    counters.items = batchSize;
+
+                    return [profilerState]()
+                    {
+                        ModelState & state = *profilerState->state;
+                        state.model->Train(state.input, state.expectedOutput);
+                    };
+                });
+            }
+
+            // Trains like RegisterTrain with the batch split across numWorkers workers (see DataParallelTrainer), a
+            // single worker measures the overhead of the trainer itself.
+            void RegisterTrainDataParallel(MLP const & mlp, u32 batchSize, u32 numWorkers)
+            {
+                Register(Format("Sequential/TrainDataParallel/%s/SGD/batch:%lu/workers:%lu", mlp.name, batchSize, numWorkers), [=](Counters & counters) -> Iteration
+                {
+                    // The trainer is destroyed before the model it trains
+                    struct TrainerState
+                    {
+                        std::shared_ptr<ModelState> state;
+                        std::unique_ptr<models::DataParallelTrainer> trainer;
+                    };
+
+                    std::shared_ptr<TrainerState> trainerState = std::make_shared<TrainerState>();
+                    trainerState->state = CreateModelState(mlp, batchSize, optimizers::Optimizer::SGD(0.01f));
+                    trainerState->trainer.reset(new models::DataParallelTrainer(*trainerState->state->model, batchSize, numWorkers));
+
+                    // The all-reduce reads every worker's gradients on top of RegisterTrain's traffic
+                    f64 const numFirstLayerWeights = static_cast<f64>(mlp.numInputs) * mlp.numHiddenNeurons[0];
+                    counters.flops = 2.0 * ((3.0 * GetNumWeights(mlp)) - numFirstLayerWeights) * batchSize;
+                    counters.bytes = (5.0 + numWorkers) * sizeof(f32) * GetNumWeights(mlp);
+                    counters.items = batchSize;
+
+                    return [trainerState]()
+                    {
+                        ModelState & state = *trainerState->state;
+                        trainerState->trainer->Train(state.input, state.expectedOutput);
+                    };
+                });
+            }
+
+            // Trains with Hogwild! (see TrainingMode::Hogwild) on epochs of numSamples samples split into
+            // mini-batches of batchSize samples across numWorkers workers, which never wait for each other.
+            void RegisterTrainHogwild(MLP const & mlp, u32 batchSize, u32 numSamples, u32 numWorkers)
+            {
+                Register(Format("Sequential/TrainHogwild/%s/SGD/batch:%lu/workers:%lu", mlp.name, batchSize, numWorkers), [=](Counters & counters) -> Iteration
+                {
+                    struct TrainerState
+                    {
+                        std::shared_ptr<ModelState> state;
+                        std::unique_ptr<models::DataParallelTrainer> trainer;
+                    };
+
+                    // The model's data holds a whole epoch
+                    std::shared_ptr<TrainerState> trainerState = std::make_shared<TrainerState>();
+                    trainerState->state = CreateModelState(mlp, numSamples, optimizers::Optimizer::SGD(0.01f));
+                    trainerState->trainer.reset(new models::DataParallelTrainer(*trainerState->state->model, batchSize, numWorkers, models::TrainingMode::Hogwild));
+
+                    // Every mini-batch costs a step of RegisterTrain
+                    f64 const numFirstLayerWeights = static_cast<f64>(mlp.numInputs) * mlp.numHiddenNeurons[0];
+                    f64 const numBatches = static_cast<f64>((numSamples + batchSize - 1) / batchSize);
+                    counters.flops = 2.0 * ((3.0 * GetNumWeights(mlp)) - numFirstLayerWeights) * numSamples;
+                    counters.bytes = 5.0 * sizeof(f32) * GetNumWeights(mlp) * numBatches;
+                    counters.items = numSamples;
+
+                    return [trainerState]()
+                    {
+                        ModelState & state = *trainerState->state;
+                        trainerState->trainer->Train(state.input, state.expectedOutput);
+                    };
+                });
+            }
+
+            // Writes a dataset of raw f32 records (see data::OpenBinary) of the supplied number of samples for the
+            // supplied MLP, every sample differs from the next.
+            void WriteDataset(char const * path, MLP const & mlp, u32 numSamples)
+            {
+                u32 const sampleSize = mlp.numInputs + mlp.numOutputs;
+                std::vector<f32> sample(sampleSize);
+                FILE * file = fopen(path, "wb");
+                ASSERTMSG(nullptr != file, "Failed to create the dataset.");
+                for (u32 sIdx = 0; sIdx < numSamples; ++sIdx)
+                {
+                    for (u32 eIdx = 0; eIdx < sampleSize; ++eIdx)
+                    {
+                        sample[eIdx] = static_cast<f32>((sIdx + eIdx) % 256) / 255.0f;
+                    }
+                    fwrite(sample.data(), sizeof(f32), sampleSize, file);
+                }
+                fclose(file);
+            }
+
+            // Trains like RegisterTrain on batches streamed from a dataset file, the difference between the two
+            // is the time training waits for the file (the reader decodes the next batch in the background).
+            void RegisterTrainFromDataset(MLP const & mlp, u32 batchSize, u32 shuffleWindow)
+            {
+                Register(Format("Sequential/TrainFromDataset/%s/SGD/batch:%lu/window:%lu", mlp.name, batchSize, shuffleWindow), [=](Counters & counters) -> Iteration
+                {
+                    // The reader is destroyed before the file is deleted
+                    struct DatasetState
+                    {
+                        ModelFile file;
+                        std::unique_ptr<data::DatasetReader> reader;
+                        std::shared_ptr<ModelState> state;
+                        Tensor input;
+                        Tensor expectedOutput;
+                    };
+
+                    std::shared_ptr<DatasetState> datasetState = std::make_shared<DatasetState>();
+                    datasetState->file.path = Format("mia_bench.%s.dataset", mlp.name);
+                    datasetState->state = CreateModelState(mlp, batchSize, optimizers::Optimizer::SGD(0.01f));
+
+                    WriteDataset(datasetState->file.path.c_str(), mlp, batchSize * 32);
+
+                    data::DatasetOptions options;
+                    options.batchSize = batchSize;
+                    options.shuffleWindow = shuffleWindow;
+                    datasetState->reader.reset(new data::DatasetReader(data::OpenBinary(datasetState->file.path.c_str(), { mlp.numInputs }, mlp.numOutputs), options));
+
+                    f64 const numFirstLayerWeights = static_cast<f64>(mlp.numInputs) * mlp.numHiddenNeurons[0];
+                    counters.flops = 2.0 * ((3.0 * GetNumWeights(mlp)) - numFirstLayerWeights) * batchSize;
+                    counters.bytes = (5.0 * sizeof(f32) * GetNumWeights(mlp)) + (static_cast<f64>(sizeof(f32)) * (mlp.numInputs + mlp.numOutputs) * batchSize);
+                    counters.items = batchSize;
+
+                    return [datasetState]()
+                    {
+                        // Next returns false once at the end of each epoch
+                        DatasetState & state = *datasetState;
+                        if (!state.reader->Next(state.input, state.expectedOutput))
+                        {
+                            state.reader->Next(state.input, state.expectedOutput);
+                        }
+                        state.state->model->Train(state.input, state.expectedOutput);
+                    };
+                });
+            }
+
+            // Trains like RegisterTrain on batches of a memory-mapped sample store: contiguous batches are viewed
+            // in place, shuffled ones are gathered from the mapping, the next batch being prefetched.
+            void RegisterTrainFromSampleStore(MLP const & mlp, u32 batchSize, bool isShuffled)
+            {
+                Register(Format("Sequential/TrainFromSampleStore/%s/SGD/batch:%lu/%s", mlp.name, batchSize, isShuffled ? "shuffled" : "sequential"), [=](Counters & counters) -> Iteration
+                {
+                    // The store is closed before the file is deleted
+                    struct StoreState
+                    {
+                        ModelFile file;
+                        data::SampleStore store;
+                        std::shared_ptr<ModelState> state;
+                        std::vector<u64> order;
+                        u64 numBatches;
+                        u64 batchIndex;
+                        Tensor input;
+                        Tensor expectedOutput;
+                    };
+
+                    std::shared_ptr<StoreState> storeState = std::make_shared<StoreState>();
+                    storeState->file.path = Format("mia_bench.%s.miastore", mlp.name);
+                    storeState->state = CreateModelState(mlp, batchSize, optimizers::Optimizer::SGD(0.01f));
+
+                    {
+                        ModelFile dataset;
+                        dataset.path = Format("mia_bench.%s.dataset", mlp.name);
+                        WriteDataset(dataset.path.c_str(), mlp, batchSize * 32);
+
+                        std::unique_ptr<data::SampleReader> reader = data::OpenBinary(dataset.path.c_str(), { mlp.numInputs }, mlp.numOutputs);
+                        bool const isWritten = data::WriteSampleStore(storeState->file.path.c_str(), *reader);
+                        ASSERTMSG(isWritten, "Failed to create the sample store.");
+                        (void)isWritten;
+                    }
+
+                    StoreState & state = *storeState;
+                    bool const isOpen = state.store.Open(state.file.path.c_str(), isShuffled ? AccessPattern::Random : AccessPattern::Sequential);
+                    ASSERTMSG(isOpen, "Failed to open the sample store.");
+                    (void)isOpen;
+                    state.numBatches = state.store.GetNumSamples() / batchSize;
+                    state.batchIndex = 0;
+
+                    if (isShuffled)
+                    {
+                        state.order.resize(static_cast<size_t>(state.store.GetNumSamples()));
+                        for (u64 sIdx = 0; sIdx < state.order.size(); ++sIdx)
+                        {
+                            state.order[sIdx] = sIdx;
+                        }
+                        for (u64 sIdx = state.order.size() - 1; sIdx > 0; --sIdx)
+                        {
+                            std::swap(state.order[sIdx], state.order[rng::DeriveSeed(c_SeedValue, sIdx) % (sIdx + 1)]);
+                        }
+
+                        state.input = Tensor({ batchSize, mlp.numInputs });
+                        state.expectedOutput = Tensor({ batchSize, mlp.numOutputs });
+                    }
+
+                    f64 const numFirstLayerWeights = static_cast<f64>(mlp.numInputs) * mlp.numHiddenNeurons[0];
+                    counters.flops = 2.0 * ((3.0 * GetNumWeights(mlp)) - numFirstLayerWeights) * batchSize;
+                    counters.bytes = (5.0 * sizeof(f32) * GetNumWeights(mlp)) + (static_cast<f64>(sizeof(f32)) * (mlp.numInputs + mlp.numOutputs) * batchSize);
+                    counters.items = batchSize;
+
+                    return [storeState, batchSize, isShuffled]()
+                    {
+                        StoreState & state = *storeState;
+                        u64 const begin = state.batchIndex * batchSize;
+                        if (isShuffled)
+                        {
+                            u64 const nextBegin = ((state.batchIndex + 1) % state.numBatches) * batchSize;
+                            state.store.Prefetch(state.order.data() + nextBegin, batchSize);
+                            state.store.Gather(state.order.data() + begin, batchSize, state.input, state.expectedOutput);
+                        }
+                        else
+                        {
+                            state.store.GetBatch(begin, begin + batchSize, state.input, state.expectedOutput);
+                        }
+
+                        state.state->model->Train(state.input, state.expectedOutput);
+                        state.batchIndex = (state.batchIndex + 1) % state.numBatches;
+                    };
+                });
+            }
+        }
+
+        void RegisterMacroBenchmarks()
+        {
+            MLP const mlps[] = {
+                { "xor-2-8-1",              2,      1,  { 8, 0 },       1 },
+                { "mlp-64-32-10",           64,     1,  { 32, 0 },      10 },
+                { "mlp-784-128-10",         784,    1,  { 128, 0 },     10 },
+                { "mlp-784-512-256-10",     784,    2,  { 512, 256 },   10 }
+            };
+
+            u32 const batchSizes[] = { 1, 32, 256 };
+
+            for (u32 mIdx = 0; mIdx < LENGTHOF(mlps); ++mIdx)
+            {
+                for (u32 bIdx = 0; bIdx < LENGTHOF(batchSizes); ++bIdx)
+                {
+                    RegisterPredict(mlps[mIdx], batchSizes[bIdx]);
+                }
+            }
+
+            RegisterFixedPredict<FixedXOR>(mlps[0]);
+            RegisterFixedPredict<FixedMLP64>(mlps[1]);
+
+            // Loading maps the model rather than reading it, so takes the same time whatever the size of the model
+            MLP const largeMlp = { "mlp-4096-4096-4096-10", 4096, 2, { 4096, 4096 }, 10 };
+            RegisterLoad(mlps[LENGTHOF(mlps) - 1]);
+            RegisterLoad(largeMlp);
+
+            for (u32 mIdx = 0; mIdx < LENGTHOF(mlps); ++mIdx)
+            {
+                for (u32 bIdx = 0; bIdx < LENGTHOF(batchSizes); ++bIdx)
+                {
+                    RegisterTrain(mlps[mIdx], batchSizes[bIdx], "SGD", optimizers::Optimizer::SGD(0.01f));
+                    RegisterTrain(mlps[mIdx], batchSizes[bIdx], "Adam", optimizers::Optimizer::Adam());
+                }
+            }
+
+            // Checkpoints are written in the background, so only cost the copies of the layers that training
+            // updates before they have been written
+            RegisterTrainWithCheckpoints(mlps[LENGTHOF(mlps) - 1], 256, 100);
+            RegisterTrainWithCheckpoints(mlps[LENGTHOF(mlps) - 1], 256, 10);
+
+            RegisterTrainWithProfiler(mlps[0], 1);
+            RegisterTrainWithProfiler(mlps[LENGTHOF(mlps) - 1], 256);
+
+            // Scales with the number of cores, as long as every worker's shard keeps its thread busy
+            RegisterTrainDataParallel(mlps[LENGTHOF(mlps) - 1], 256, 1);
+            RegisterTrainDataParallel(mlps[LENGTHOF(mlps) - 1], 256, 2);
+            RegisterTrainDataParallel(mlps[LENGTHOF(mlps) - 1], 256, 4);
+
+            // Hogwild! takes more, smaller steps than synchronous training over the same samples
+            RegisterTrainHogwild(mlps[2], 32, 1024, 1);
+            RegisterTrainHogwild(mlps[2], 32, 1024, 4);
+
+            RegisterTrainFromDataset(mlps[2], 256, 0);
+            RegisterTrainFromDataset(mlps[2], 256, 4096);
+
+            RegisterTrainFromSampleStore(mlps[2], 256, false);
+            RegisterTrainFromSampleStore(mlps[2], 256, true);
+        }
+    }
+}
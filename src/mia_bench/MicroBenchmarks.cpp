@@ -0,0 +1,274 @@
+#include "Benchmarks.h"
+#include "Benchmark.h"
+
+#include "Maths/Matrix.h"
+#include "Maths/Tensor.h"
+#include "Layers/Flatten.h"
+#include "Activators/Activators.h"
+#include "Initializers/Initializer.h"
+
+#include <memory>
+
+namespace mia
+{
+    namespace bench
+    {
+        namespace
+        {
+            // Returns a width x height matrix filled with deterministic values in the range [-1, 1).
+            Matrix MakeMatrix(u32 width, u32 height, u32 seed)
+            {
+                Matrix matrix(width, height);
+
+                u32 state = seed;
+                f32 * data = matrix.GetData();
+                for (u64 eIdx = 0; eIdx < matrix.GetCapacity(); ++eIdx)
+                {
+                    state = (state * 1664525u) + 1013904223u;
+                    data[eIdx] = (static_cast<f32>(state >> 8) / static_cast<f32>(1 << 23)) - 1.0f;
+                }
+
+                return matrix;
+            }
+
+            struct Operands
+            {
+                Matrix a;
+                Matrix b;
+                Matrix result;
+            };
+
+            // c (m x n) = a (m x k) * b (k x n)
+            void RegisterMultiply(u32 m, u32 n, u32 k)
+            {
+                Register(Format("Multiply/%lux%lux%lu", m, n, k), [=](Counters & counters) -> Iteration
+                {
+                    std::shared_ptr<Operands> operands = std::make_shared<Operands>();
+                    operands->a = MakeMatrix(k, m, 1);
+                    operands->b = MakeMatrix(n, k, 2);
+                    operands->result = Matrix(n, m);
+
+                    counters.flops = 2.0 * m * n * k;
+                    counters.bytes = sizeof(f32) * ((static_cast<f64>(m) * k) + (static_cast<f64>(k) * n) + (static_cast<f64>(m) * n));
+
+                    return [operands]()
+                    {
+                        Matrix::MultiplyInto(operands->a, operands->b, operands->result);
+                    };
+                });
+            }
+
+            // Transposes a width x height matrix
+            void RegisterTranspose(u32 width, u32 height)
+            {
+                Register(Format("Transpose/%lux%lu", width, height), [=](Counters & counters) -> Iteration
+                {
+                    std::shared_ptr<Operands> operands = std::make_shared<Operands>();
+                    operands->a = MakeMatrix(width, height, 1);
+                    operands->result = Matrix(height, width);
+
+                    counters.bytes = 2.0 * sizeof(f32) * width * height;
+                    counters.items = static_cast<f64>(width) * height;
+
+                    return [operands]()
+                    {
+                        Matrix::TransposeInto(operands->a, operands->result);
+                    };
+                });
+            }
+
+            // Transposes a size x size matrix in place
+            void RegisterTransposeInPlace(u32 size)
+            {
+                Register(Format("TransposeInPlace/%lux%lu", size, size), [=](Counters & counters) -> Iteration
+                {
+                    std::shared_ptr<Operands> operands = std::make_shared<Operands>();
+                    operands->a = MakeMatrix(size, size, 1);
+
+                    counters.bytes = 2.0 * sizeof(f32) * size * size;
+                    counters.items = static_cast<f64>(size) * size;
+
+                    return [operands]()
+                    {
+                        Matrix::TransposeInPlace(operands->a);
+                    };
+                });
+            }
+
+            // Copies a matrix of numElements elements, the bandwidth the transposes are measured against
+            void RegisterCopy(u32 numElements)
+            {
+                Register(Format("Copy/%lu", numElements), [=](Counters & counters) -> Iteration
+                {
+                    std::shared_ptr<Operands> operands = std::make_shared<Operands>();
+                    operands->a = MakeMatrix(numElements, 1, 1);
+                    operands->result = Matrix(numElements, 1);
+
+                    counters.bytes = 2.0 * sizeof(f32) * numElements;
+                    counters.items = numElements;
+
+                    return [operands]()
+                    {
+                        operands->result = operands->a;
+                    };
+                });
+            }
+
+            // Adds two matrices of numElements elements
+            void RegisterAdd(u32 numElements)
+            {
+                Register(Format("Add/%lu", numElements), [=](Counters & counters) -> Iteration
+                {
+                    std::shared_ptr<Operands> operands = std::make_shared<Operands>();
+                    operands->a = MakeMatrix(numElements, 1, 1);
+                    operands->b = MakeMatrix(numElements, 1, 2);
+
+                    counters.flops = numElements;
+                    counters.bytes = 3.0 * sizeof(f32) * numElements;
+                    counters.items = numElements;
+
+                    return [operands]()
+                    {
+                        Matrix::AddInPlace(operands->a, operands->b);
+                    };
+                });
+            }
+
+            // Initialises a width x height matrix of parameters
+            void RegisterInitialize(char const * name, initializers::Initializer const & initializer, u32 width, u32 height)
+            {
+                Register(Format("Initialize/%s/%lux%lu", name, width, height), [=](Counters & counters) -> Iteration
+                {
+                    std::shared_ptr<Matrix> parameters = std::make_shared<Matrix>(width, height);
+
+                    counters.bytes = sizeof(f32) * parameters->GetCapacity();
+                    counters.items = parameters->GetCapacity();
+
+                    return [=]()
+                    {
+                        initializers::Initialize(initializer, activators::ActivatorType::ReLU, width, height, 0, 0, *parameters);
+                    };
+                });
+            }
+
+            // Applies an activator to numElements elements
+            void RegisterActivator(char const * name, activators::ActivatorType type, u32 numElements, kernels::MathPrecision precision = kernels::MathPrecision::Accurate)
+            {
+                char const * precisionName = (kernels::MathPrecision::Fast == precision) ? "/fast" : "";
+                Register(Format("Activate/%s%s/%lu", name, precisionName, numElements), [=](Counters & counters) -> Iteration
+                {
+                    std::shared_ptr<Operands> operands = std::make_shared<Operands>();
+                    operands->a = MakeMatrix(numElements, 1, 1);
+                    operands->result = Matrix(numElements, 1);
+
+                    counters.bytes = 2.0 * sizeof(f32) * numElements;
+                    counters.items = numElements;
+
+                    return [operands, type, precision]()
+                    {
+                        activators::Activate(type, operands->a.GetData(), operands->result.GetData(), operands->a.GetCapacity(), precision);
+                    };
+                });
+            }
+
+            struct FlattenInput
+            {
+                std::unique_ptr<layers::Flatten> layer;
+                Matrix data;
+                Tensor samples;
+            };
+
+            // Supplies a batch of numSamples (channels x height x width) images to a Flatten layer. Padded
+            // images have a gap after every row, so have to be copied rather than viewed in place.
+            void RegisterFlatten(u32 numSamples, u32 channels, u32 height, u32 width, bool padded)
+            {
+                Register(Format("Flatten/SetInputData/%s/%lux%lux%lux%lu", padded ? "padded" : "contiguous", numSamples, channels, height, width), [=](Counters & counters) -> Iteration
+                {
+                    u32 const rowLength = padded ? (width + 1) : width;
+
+                    std::shared_ptr<FlattenInput> input = std::make_shared<FlattenInput>();
+                    input->layer.reset(new layers::Flatten({ channels, height, width }, activators::ActivatorType::None));
+                    input->layer->Compile(0, nullptr);
+                    input->layer->Reserve(numSamples);
+                    input->data = MakeMatrix(rowLength, numSamples * channels * height, 1);
+                    input->samples = Tensor::Borrow(input->data.GetData(), { numSamples, channels, height, rowLength }).Slice(3, 0, width);
+
+                    counters.bytes = sizeof(f32) * static_cast<f64>(numSamples) * channels * height * width;
+                    counters.items = numSamples;
+
+                    return [input]()
+                    {
+                        input->layer->SetInputData(input->samples);
+                    };
+                });
+            }
+        }
+
+        void RegisterMicroBenchmarks()
+        {
+            // Square problems from L1 resident up to well beyond the last level cache
+            u32 const squareSizes[] = { 32, 64, 128, 256, 512, 1024 };
+            for (u32 sIdx = 0; sIdx < LENGTHOF(squareSizes); ++sIdx)
+            {
+                RegisterMultiply(squareSizes[sIdx], squareSizes[sIdx], squareSizes[sIdx]);
+            }
+
+            // The shapes a Dense layer produces: weights (neurons x inputs) * values (inputs x batch)
+            RegisterMultiply(128, 1, 784);
+            RegisterMultiply(128, 32, 784);
+            RegisterMultiply(128, 256, 784);
+            RegisterMultiply(10, 256, 128);
+            RegisterMultiply(1024, 1, 1024);
+
+            u32 const transposeSizes[][2] = {
+                { 64, 64 },
+                { 256, 256 },
+                { 1024, 1024 },
+                { 2048, 2048 },
+                { 8192, 8192 },
+                { 784, 128 },
+                { 128, 784 }
+            };
+            for (u32 sIdx = 0; sIdx < LENGTHOF(transposeSizes); ++sIdx)
+            {
+                RegisterTranspose(transposeSizes[sIdx][0], transposeSizes[sIdx][1]);
+            }
+
+            u32 const transposeInPlaceSizes[] = { 256, 2048, 8192 };
+            for (u32 sIdx = 0; sIdx < LENGTHOF(transposeInPlaceSizes); ++sIdx)
+            {
+                RegisterTransposeInPlace(transposeInPlaceSizes[sIdx]);
+            }
+
+            RegisterCopy(2048 * 2048);
+            RegisterCopy(8192 * 8192);
+
+            RegisterFlatten(256, 3, 64, 64, false);
+            RegisterFlatten(256, 3, 64, 64, true);
+
+            u32 const elementCounts[] = { 1024, 64 * 1024, 1024 * 1024, 16 * 1024 * 1024 };
+            for (u32 eIdx = 0; eIdx < LENGTHOF(elementCounts); ++eIdx)
+            {
+                RegisterAdd(elementCounts[eIdx]);
+            }
+
+            RegisterInitialize("Uniform", initializers::Initializer::Uniform(0.0f, 1.0f), 4096, 4096);
+            RegisterInitialize("HeNormal", initializers::Initializer::HeNormal(), 4096, 4096);
+
+            u32 const activatorElementCounts[] = { 4 * 1024, 1024 * 1024 };
+            for (u32 eIdx = 0; eIdx < LENGTHOF(activatorElementCounts); ++eIdx)
+            {
+                RegisterActivator("ReLU", activators::ActivatorType::ReLU, activatorElementCounts[eIdx]);
+                RegisterActivator("LeakyReLU", activators::ActivatorType::LeakyReLU, activatorElementCounts[eIdx]);
+                RegisterActivator("Sigmoid", activators::ActivatorType::Sigmoid, activatorElementCounts[eIdx]);
+                RegisterActivator("Sigmoid", activators::ActivatorType::Sigmoid, activatorElementCounts[eIdx], kernels::MathPrecision::Fast);
+                RegisterActivator("Tanh", activators::ActivatorType::Tanh, activatorElementCounts[eIdx]);
+                RegisterActivator("Tanh", activators::ActivatorType::Tanh, activatorElementCounts[eIdx], kernels::MathPrecision::Fast);
+                RegisterActivator("GELU", activators::ActivatorType::GELU, activatorElementCounts[eIdx]);
+                RegisterActivator("GELU", activators::ActivatorType::GELU, activatorElementCounts[eIdx], kernels::MathPrecision::Fast);
+                RegisterActivator("SiLU", activators::ActivatorType::SiLU, activatorElementCounts[eIdx]);
+                RegisterActivator("SiLU", activators::ActivatorType::SiLU, activatorElementCounts[eIdx], kernels::MathPrecision::Fast);
+            }
+        }
+    }
+}
@@ -0,0 +1,79 @@
+#include "Benchmark.h"
+#include "Benchmarks.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+using namespace mia;
+
+namespace
+{
+    void PrintUsage()
+    {
+        printf("usage: mia_bench [options]\n");
+        printf("  --filter=<text>     only run benchmarks whose name contains text\n");
+        printf("  --min-time=<secs>   minimum time spent measuring each benchmark (default 0.5)\n");
+        printf("  --threads=<n>       number of threads to run with (default: every hardware thread)\n");
+        printf("  --json=<path>       also write the results to path as JSON\n");
+    }
+
+    // Returns the value of argument if it starts with name, otherwise nullptr.
+    char const * GetValue(char const * argument, char const * name)
+    {
+        u64 const length = strlen(name);
+        return (0 == strncmp(argument, name, length)) ? argument + length : nullptr;
+    }
+}
+
+int main(int argc, char ** argv)
+{
+    bench::Options options;
+    std::string jsonPath;
+
+    for (int aIdx = 1; aIdx < argc; ++aIdx)
+    {
+        char const * value = nullptr;
+        if (nullptr != (value = GetValue(argv[aIdx], "--filter=")))
+        {
+            options.filter = value;
+        }
+        else if (nullptr != (value = GetValue(argv[aIdx], "--min-time=")))
+        {
+            options.minTime = atof(value);
+        }
+        else if (nullptr != (value = GetValue(argv[aIdx], "--threads=")))
+        {
+            options.numThreads = static_cast<u32>(atoi(value));
+        }
+        else if (nullptr != (value = GetValue(argv[aIdx], "--json=")))
+        {
+            jsonPath = value;
+        }
+        else
+        {
+            PrintUsage();
+            return 1;
+        }
+    }
+
+    bench::RegisterMicroBenchmarks();
+    bench::RegisterMacroBenchmarks();
+
+    u32 numFailed = 0;
+    std::vector<bench::Result> const results = bench::RunBenchmarks(options, &numFailed);
+
+    if (!jsonPath.empty() && !bench::WriteJson(jsonPath, options, results))
+    {
+        printf("Failed to write %s\n", jsonPath.c_str());
+        return 1;
+    }
+
+    if (numFailed > 0)
+    {
+        printf("%lu benchmark(s) failed to set up\n", static_cast<unsigned long>(numFailed));
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,78 @@
+#include <CppUnitTest.h>
+
+#include <Activators/Activators.h>
+
+#include <math.h>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace mia
+{
+    namespace tests
+    {
+        TEST_CLASS(GELUTests)
+        {
+            static f32 constexpr c_Precision = 1e-3f;
+
+        public:
+            TEST_METHOD(ReturnsZero_ForZero)
+            {
+                Assert::AreEqual(0.0f, activators::GELU(0.0f));
+            }
+
+            TEST_METHOD(ApproachesReLU_ForLargeValues)
+            {
+                Assert::IsTrue(fabsf(activators::GELU(10.0f) - 10.0f) < c_Precision);
+                Assert::IsTrue(fabsf(activators::GELU(-10.0f)) < c_Precision);
+            }
+
+            TEST_METHOD(MatchesTheTanhApproximation)
+            {
+                f32 const x = 0.8f;
+                f32 const expected = 0.5f * x * (1.0f + tanhf(0.7978845608f * (x + (0.044715f * x * x * x))));
+                Assert::IsTrue(fabsf(activators::GELU(x) - expected) < 1e-6f);
+            }
+
+            TEST_METHOD(Derivative_MatchesCentralDifference)
+            {
+                f32 const step = 1e-2f;
+                f32 const values[] = { -3.0f, -0.5f, 1.0f, 4.0f };
+                for (u32 eIdx = 0; eIdx < LENGTHOF(values); ++eIdx)
+                {
+                    f32 const estimate = (activators::GELU(values[eIdx] + step) - activators::GELU(values[eIdx] - step)) / (2.0f * step);
+                    Assert::IsTrue(fabsf(activators::GELUDerivative(values[eIdx]) - estimate) < c_Precision);
+                }
+            }
+
+            TEST_METHOD(Activate_MatchesTheActivator)
+            {
+                f32 values[] = { -6.0f, -1.5f, -0.25f, 0.0f, 0.125f, 0.75f, 2.0f, 9.0f };
+                f32 activated[LENGTHOF(values)];
+                activators::Activate(activators::ActivatorType::GELU, values, activated, LENGTHOF(values));
+
+                for (u32 eIdx = 0; eIdx < LENGTHOF(values); ++eIdx)
+                {
+                    Assert::AreEqual(activators::GELU(values[eIdx]), activated[eIdx], 1e-6f);
+                }
+            }
+
+            TEST_METHOD(MultiplyByDerivative_MatchesTheDerivative)
+            {
+                f32 values[] = { -6.0f, -1.5f, -0.25f, 0.125f, 0.75f, 2.0f, 9.0f };
+                f32 activated[LENGTHOF(values)];
+                f32 gradient[LENGTHOF(values)];
+                activators::Activate(activators::ActivatorType::GELU, values, activated, LENGTHOF(values));
+                for (u32 eIdx = 0; eIdx < LENGTHOF(values); ++eIdx)
+                {
+                    gradient[eIdx] = 0.5f;
+                }
+
+                activators::MultiplyByDerivative(activators::ActivatorType::GELU, values, activated, gradient, LENGTHOF(values));
+                for (u32 eIdx = 0; eIdx < LENGTHOF(values); ++eIdx)
+                {
+                    Assert::AreEqual(0.5f * activators::GELUDerivative(values[eIdx]), gradient[eIdx], 1e-6f);
+                }
+            }
+        };
+    }
+}
@@ -0,0 +1,79 @@
+#include <CppUnitTest.h>
+
+#include <Activators/Activators.h>
+
+#include <math.h>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace mia
+{
+    namespace tests
+    {
+        TEST_CLASS(LeakyReLUTests)
+        {
+            static f32 constexpr c_Precision = 1e-3f;
+
+        public:
+            TEST_METHOD(ScalesNegativeValues_ByTheSlope)
+            {
+                Assert::AreEqual(-12.0f * activators::c_LeakyReLUSlope, activators::LeakyReLU(-12.0f));
+                Assert::AreEqual(0.0f, activators::LeakyReLU(0.0f));
+            }
+
+            TEST_METHOD(ReturnsX_ForAllPositiveValues)
+            {
+                Assert::AreEqual(1.0f, activators::LeakyReLU(1.0f));
+                Assert::AreEqual(123.0f, activators::LeakyReLU(123.0f));
+            }
+
+            TEST_METHOD(Derivative_ReturnsTheSlope_ForNonPositiveValues)
+            {
+                Assert::AreEqual(activators::c_LeakyReLUSlope, activators::LeakyReLUDerivative(-12.0f));
+                Assert::AreEqual(activators::c_LeakyReLUSlope, activators::LeakyReLUDerivative(0.0f));
+                Assert::AreEqual(1.0f, activators::LeakyReLUDerivative(0.5f));
+            }
+
+            TEST_METHOD(Derivative_MatchesCentralDifference)
+            {
+                f32 const step = 1e-2f;
+                f32 const values[] = { -3.0f, -0.5f, 1.0f, 4.0f };
+                for (u32 eIdx = 0; eIdx < LENGTHOF(values); ++eIdx)
+                {
+                    f32 const estimate = (activators::LeakyReLU(values[eIdx] + step) - activators::LeakyReLU(values[eIdx] - step)) / (2.0f * step);
+                    Assert::IsTrue(fabsf(activators::LeakyReLUDerivative(values[eIdx]) - estimate) < c_Precision);
+                }
+            }
+
+            TEST_METHOD(Activate_MatchesTheActivator)
+            {
+                f32 values[] = { -6.0f, -1.5f, -0.25f, 0.0f, 0.125f, 0.75f, 2.0f, 9.0f };
+                f32 activated[LENGTHOF(values)];
+                activators::Activate(activators::ActivatorType::LeakyReLU, values, activated, LENGTHOF(values));
+
+                for (u32 eIdx = 0; eIdx < LENGTHOF(values); ++eIdx)
+                {
+                    Assert::AreEqual(activators::LeakyReLU(values[eIdx]), activated[eIdx], 1e-6f);
+                }
+            }
+
+            TEST_METHOD(MultiplyByDerivative_MatchesTheDerivative)
+            {
+                f32 values[] = { -6.0f, -1.5f, -0.25f, 0.125f, 0.75f, 2.0f, 9.0f };
+                f32 activated[LENGTHOF(values)];
+                f32 gradient[LENGTHOF(values)];
+                activators::Activate(activators::ActivatorType::LeakyReLU, values, activated, LENGTHOF(values));
+                for (u32 eIdx = 0; eIdx < LENGTHOF(values); ++eIdx)
+                {
+                    gradient[eIdx] = 0.5f;
+                }
+
+                activators::MultiplyByDerivative(activators::ActivatorType::LeakyReLU, values, activated, gradient, LENGTHOF(values));
+                for (u32 eIdx = 0; eIdx < LENGTHOF(values); ++eIdx)
+                {
+                    Assert::AreEqual(0.5f * activators::LeakyReLUDerivative(values[eIdx]), gradient[eIdx], 1e-6f);
+                }
+            }
+        };
+    }
+}
@@ -35,6 +35,18 @@ namespace mia
                 Assert::AreEqual(1234.0f, activators::ReLU(1234.0f));
                 Assert::AreEqual(12345.0f, activators::ReLU(12345.0f));
             }
+
+            TEST_METHOD(Derivative_ReturnsZero_ForNonPositiveValues)
+            {
+                Assert::AreEqual(0.0f, activators::ReLUDerivative(-12.0f));
+                Assert::AreEqual(0.0f, activators::ReLUDerivative(0.0f));
+            }
+
+            TEST_METHOD(Derivative_ReturnsOne_ForPositiveValues)
+            {
+                Assert::AreEqual(1.0f, activators::ReLUDerivative(0.5f));
+                Assert::AreEqual(1.0f, activators::ReLUDerivative(12.0f));
+            }
         };
     }
 }
@@ -0,0 +1,76 @@
+#include <CppUnitTest.h>
+
+#include <Activators/Activators.h>
+
+#include <math.h>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace mia
+{
+    namespace tests
+    {
+        TEST_CLASS(SiLUTests)
+        {
+            static f32 constexpr c_Precision = 1e-3f;
+
+        public:
+            TEST_METHOD(ReturnsZero_ForZero)
+            {
+                Assert::AreEqual(0.0f, activators::SiLU(0.0f));
+            }
+
+            TEST_METHOD(ApproachesReLU_ForLargeValues)
+            {
+                Assert::IsTrue(fabsf(activators::SiLU(20.0f) - 20.0f) < c_Precision);
+                Assert::IsTrue(fabsf(activators::SiLU(-20.0f)) < c_Precision);
+            }
+
+            TEST_METHOD(Derivative_ReturnsAHalf_ForZero)
+            {
+                Assert::AreEqual(0.5f, activators::SiLUDerivative(0.0f));
+            }
+
+            TEST_METHOD(Derivative_MatchesCentralDifference)
+            {
+                f32 const step = 1e-2f;
+                f32 const values[] = { -3.0f, -0.5f, 1.0f, 4.0f };
+                for (u32 eIdx = 0; eIdx < LENGTHOF(values); ++eIdx)
+                {
+                    f32 const estimate = (activators::SiLU(values[eIdx] + step) - activators::SiLU(values[eIdx] - step)) / (2.0f * step);
+                    Assert::IsTrue(fabsf(activators::SiLUDerivative(values[eIdx]) - estimate) < c_Precision);
+                }
+            }
+
+            TEST_METHOD(Activate_MatchesTheActivator)
+            {
+                f32 values[] = { -6.0f, -1.5f, -0.25f, 0.0f, 0.125f, 0.75f, 2.0f, 9.0f };
+                f32 activated[LENGTHOF(values)];
+                activators::Activate(activators::ActivatorType::SiLU, values, activated, LENGTHOF(values));
+
+                for (u32 eIdx = 0; eIdx < LENGTHOF(values); ++eIdx)
+                {
+                    Assert::AreEqual(activators::SiLU(values[eIdx]), activated[eIdx], 1e-6f);
+                }
+            }
+
+            TEST_METHOD(MultiplyByDerivative_MatchesTheDerivative)
+            {
+                f32 values[] = { -6.0f, -1.5f, -0.25f, 0.125f, 0.75f, 2.0f, 9.0f };
+                f32 activated[LENGTHOF(values)];
+                f32 gradient[LENGTHOF(values)];
+                activators::Activate(activators::ActivatorType::SiLU, values, activated, LENGTHOF(values));
+                for (u32 eIdx = 0; eIdx < LENGTHOF(values); ++eIdx)
+                {
+                    gradient[eIdx] = 0.5f;
+                }
+
+                activators::MultiplyByDerivative(activators::ActivatorType::SiLU, values, activated, gradient, LENGTHOF(values));
+                for (u32 eIdx = 0; eIdx < LENGTHOF(values); ++eIdx)
+                {
+                    Assert::AreEqual(0.5f * activators::SiLUDerivative(values[eIdx]), gradient[eIdx], 1e-6f);
+                }
+            }
+        };
+    }
+}
@@ -2,6 +2,8 @@
 
 #include <Activators/Sigmoid.h>
 
+#include <math.h>
+
 using namespace Microsoft::VisualStudio::CppUnitTestFramework;
 
 namespace mia
@@ -34,6 +36,22 @@ namespace mia
             {
                 Assert::AreEqual(0.0f, activators::Sigmoid(-100.0f));
             }
+
+            TEST_METHOD(Derivative_ReturnsAQuarter_ForZero)
+            {
+                Assert::IsTrue(fabsf(activators::SigmoidDerivative(0.0f) - 0.25f) < c_Precision);
+            }
+
+            TEST_METHOD(Derivative_MatchesCentralDifference)
+            {
+                f32 const step = 1e-2f;
+                f32 const values[] = { -3.0f, -0.5f, 1.0f, 4.0f };
+                for (u32 eIdx = 0; eIdx < LENGTHOF(values); ++eIdx)
+                {
+                    f32 const estimate = (activators::Sigmoid(values[eIdx] + step) - activators::Sigmoid(values[eIdx] - step)) / (2.0f * step);
+                    Assert::IsTrue(fabsf(activators::SigmoidDerivative(values[eIdx]) - estimate) < c_Precision);
+                }
+            }
         };
     }
 }
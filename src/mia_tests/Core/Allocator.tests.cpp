@@ -0,0 +1,142 @@
+#include <CppUnitTest.h>
+
+#include <Core/Allocator.h>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace mia
+{
+    namespace tests
+    {
+        TEST_CLASS(AllocatorTests)
+        {
+            static bool IsAligned(void const * ptr)
+            {
+                return 0 == (reinterpret_cast<size_t>(ptr) % c_AllocationAlignment);
+            }
+
+        public:
+            TEST_METHOD(HeapAllocator_ReturnsAlignedBlocks)
+            {
+                Allocator & allocator = Allocator::GetDefault();
+
+                u64 const sizes[] = { 1, 4, 63, 64, 65, 1000, 1 << 20 };
+                for (u32 sIdx = 0; sIdx < LENGTHOF(sizes); ++sIdx)
+                {
+                    void * ptr = allocator.Allocate(sizes[sIdx]);
+                    Assert::IsNotNull(ptr);
+                    Assert::IsTrue(IsAligned(ptr));
+                    allocator.Free(ptr, sizes[sIdx]);
+                }
+
+                Assert::IsNull(allocator.Allocate(0));
+            }
+
+            TEST_METHOD(ArenaAllocator_BumpsAlignedBlocks)
+            {
+                ArenaAllocator arena(1024);
+
+                void * a = arena.Allocate(4);
+                void * b = arena.Allocate(100);
+                void * c = arena.Allocate(64);
+
+                Assert::IsTrue(IsAligned(a));
+                Assert::IsTrue(IsAligned(b));
+                Assert::IsTrue(IsAligned(c));
+
+                Assert::AreEqual(static_cast<u64>(64), static_cast<u64>(static_cast<u8 *>(b) - static_cast<u8 *>(a)));
+                Assert::AreEqual(static_cast<u64>(128), static_cast<u64>(static_cast<u8 *>(c) - static_cast<u8 *>(b)));
+                Assert::AreEqual(static_cast<u64>(256), arena.GetNumBytesUsed());
+            }
+
+            TEST_METHOD(ArenaAllocator_Reset_ReusesTheSameMemory)
+            {
+                ArenaAllocator arena(1024);
+
+                void * first = arena.Allocate(512);
+                arena.Reset();
+
+                Assert::AreEqual(static_cast<u64>(0), arena.GetNumBytesUsed());
+                Assert::IsTrue(first == arena.Allocate(512));
+            }
+
+            TEST_METHOD(ArenaAllocator_GrowsWhenFull_AndMergesBlocksOnReset)
+            {
+                ArenaAllocator arena(256);
+
+                void * a = arena.Allocate(200);
+                void * b = arena.Allocate(1000);
+
+                Assert::IsTrue(IsAligned(b));
+                Assert::AreEqual(static_cast<u64>(256 + 1024), arena.GetNumBytesUsed());
+
+                // Write to both blocks to make sure they don't overlap
+                memset(a, 1, 200);
+                memset(b, 2, 1000);
+                Assert::AreEqual(static_cast<u8>(1), static_cast<u8 *>(a)[199]);
+
+                // After a reset the whole previous request fits within the arena
+                arena.Reset();
+                Assert::IsTrue(arena.GetNumBytesReserved() >= 256 + 1024);
+
+                u64 const numBytesReserved = arena.GetNumBytesReserved();
+                arena.Allocate(200);
+                arena.Allocate(1000);
+                Assert::AreEqual(numBytesReserved, arena.GetNumBytesReserved());
+            }
+
+            TEST_METHOD(PoolAllocator_ReusesFreedBlocksOfTheSameSizeClass)
+            {
+                PoolAllocator pool;
+
+                void * a = pool.Allocate(1000);
+                Assert::IsTrue(IsAligned(a));
+                pool.Free(a, 1000);
+
+                // 1000 & 900 bytes share the 1024 byte size class
+                void * b = pool.Allocate(900);
+                Assert::IsTrue(a == b);
+
+                // A different size class doesn't reuse the block
+                void * c = pool.Allocate(4000);
+                Assert::IsTrue(IsAligned(c));
+                Assert::IsTrue(b != c);
+
+                pool.Free(b, 900);
+                pool.Free(c, 4000);
+            }
+
+            TEST_METHOD(PoolAllocator_AllocatesLargeBlocksFromTheHeap)
+            {
+                PoolAllocator pool;
+
+                u64 const numBytes = PoolAllocator::c_MaxPooledBytes + 1;
+                void * ptr = pool.Allocate(numBytes);
+                Assert::IsNotNull(ptr);
+                Assert::IsTrue(IsAligned(ptr));
+                pool.Free(ptr, numBytes);
+            }
+
+            TEST_METHOD(GetNumHeapAllocations_OnlyCountsBlocksTakenFromTheHeap)
+            {
+                PoolAllocator pool;
+                ArenaAllocator arena(1024);
+
+                u64 const numAllocations = Allocator::GetNumHeapAllocations();
+                u64 const numBytesAllocated = Allocator::GetNumHeapBytesAllocated();
+
+                // The first block of its size class comes from the heap, the next one from the free list
+                void * a = pool.Allocate(1000);
+                pool.Free(a, 1000);
+                void * b = pool.Allocate(1000);
+                pool.Free(b, 1000);
+
+                // The arena's first block is already reserved
+                arena.Allocate(512);
+
+                Assert::AreEqual(numAllocations + 1, Allocator::GetNumHeapAllocations());
+                Assert::AreEqual(numBytesAllocated + 1024, Allocator::GetNumHeapBytesAllocated());
+            }
+        };
+    }
+}
@@ -0,0 +1,113 @@
+#include <CppUnitTest.h>
+
+#include <Core/ThreadPool.h>
+
+#include <vector>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace mia
+{
+    namespace tests
+    {
+        TEST_CLASS(ThreadPoolTests)
+        {
+        public:
+            TEST_METHOD(SetNumThreads_ChangesNumberOfThreads)
+            {
+                ThreadPool & pool = ThreadPool::Get();
+
+                pool.SetNumThreads(3);
+                Assert::AreEqual(static_cast<u32>(3), pool.GetNumThreads());
+
+                pool.SetNumThreads(1);
+                Assert::AreEqual(static_cast<u32>(1), pool.GetNumThreads());
+
+                pool.SetNumThreads(0);
+                Assert::IsTrue(pool.GetNumThreads() >= 1);
+            }
+
+            TEST_METHOD(ParallelFor_VisitsEveryIndexExactlyOnce)
+            {
+                ThreadPool & pool = ThreadPool::Get();
+                pool.SetNumThreads(4);
+
+                u64 const count = 10007;
+                std::vector<std::atomic<u32>> visits(count);
+                for (u64 eIdx = 0; eIdx < count; ++eIdx)
+                {
+                    visits[eIdx] = 0;
+                }
+
+                pool.ParallelFor(count, 1, [&](u64 begin, u64 end)
+                {
+                    for (u64 eIdx = begin; eIdx < end; ++eIdx)
+                    {
+                        ++visits[eIdx];
+                    }
+                });
+
+                for (u64 eIdx = 0; eIdx < count; ++eIdx)
+                {
+                    Assert::AreEqual(static_cast<u32>(1), static_cast<u32>(visits[eIdx]));
+                }
+
+                pool.SetNumThreads(0);
+            }
+
+            TEST_METHOD(ParallelFor_RunsInline_WhenRangeIsSmallerThanMinChunkSize)
+            {
+                ThreadPool & pool = ThreadPool::Get();
+                pool.SetNumThreads(4);
+
+                u32 numCalls = 0;
+                pool.ParallelFor(100, 1000, [&](u64 begin, u64 end)
+                {
+                    Assert::AreEqual(static_cast<u64>(0), begin);
+                    Assert::AreEqual(static_cast<u64>(100), end);
+                    ++numCalls;
+                });
+
+                Assert::AreEqual(static_cast<u32>(1), numCalls);
+
+                pool.SetNumThreads(0);
+            }
+
+            TEST_METHOD(ParallelFor_SupportsNestedCalls)
+            {
+                ThreadPool & pool = ThreadPool::Get();
+                pool.SetNumThreads(4);
+
+                u64 const numOuter = 16;
+                u64 const numInner = 64;
+                std::atomic<u64> total(0);
+
+                pool.ParallelFor(numOuter, 1, [&](u64 begin, u64 end)
+                {
+                    for (u64 oIdx = begin; oIdx < end; ++oIdx)
+                    {
+                        pool.ParallelFor(numInner, 1, [&](u64 innerBegin, u64 innerEnd)
+                        {
+                            total += innerEnd - innerBegin;
+                        });
+                    }
+                });
+
+                Assert::AreEqual(numOuter * numInner, static_cast<u64>(total));
+
+                pool.SetNumThreads(0);
+            }
+
+            TEST_METHOD(ParallelFor_DoesNothing_ForAnEmptyRange)
+            {
+                bool called = false;
+                ThreadPool::Get().ParallelFor(0, 1, [&](u64 begin, u64 end)
+                {
+                    called = true;
+                });
+
+                Assert::IsFalse(called);
+            }
+        };
+    }
+}
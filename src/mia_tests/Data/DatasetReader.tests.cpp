@@ -0,0 +1,178 @@
+#include <CppUnitTest.h>
+
+#include <Data/DatasetReader.h>
+#include <Models/Sequential.h>
+#include <Layers/Flatten.h>
+#include <Layers/Dense.h>
+
+#include <stdio.h>
+#include <vector>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace mia
+{
+    namespace tests
+    {
+        TEST_CLASS(DatasetReaderTests)
+        {
+            static char constexpr const * c_Path = "DatasetReader.tests.bin";
+
+            // Writes a binary dataset of numSamples samples of 2 inputs & 1 expected output: sample n holds the
+            // inputs n & -n & the expected output 2n.
+            static void WriteDataset(u32 numSamples)
+            {
+                std::vector<f32> values;
+                for (u32 sIdx = 0; sIdx < numSamples; ++sIdx)
+                {
+                    values.push_back(static_cast<f32>(sIdx));
+                    values.push_back(-static_cast<f32>(sIdx));
+                    values.push_back(static_cast<f32>(sIdx * 2));
+                }
+
+                FILE * file = fopen(c_Path, "wb");
+                Assert::IsNotNull(file);
+                Assert::AreEqual(values.size(), fwrite(values.data(), sizeof(f32), values.size(), file));
+                fclose(file);
+            }
+
+            // Reads an epoch of the dataset written by WriteDataset, checking each sample is whole, & returns the
+            // index of each sample in the order they were read
+            static std::vector<u32> ReadEpoch(data::DatasetReader & reader, u32 batchSize)
+            {
+                std::vector<u32> order;
+                Tensor input, expectedOutput;
+                while (reader.Next(input, expectedOutput))
+                {
+                    u32 const numSamples = input.GetLength(0);
+                    Assert::IsTrue((numSamples > 0) && (numSamples <= batchSize));
+                    Assert::AreEqual(static_cast<u32>(2), input.GetNumDimensions());
+                    Assert::AreEqual(static_cast<u32>(2), input.GetLength(1));
+                    Assert::AreEqual(numSamples, expectedOutput.GetLength(0));
+                    Assert::AreEqual(static_cast<u32>(1), expectedOutput.GetLength(1));
+
+                    for (u64 sIdx = 0; sIdx < numSamples; ++sIdx)
+                    {
+                        f32 const sampleIndex = input.GetElement({ sIdx, 0 });
+                        Assert::AreEqual(-sampleIndex, input.GetElement({ sIdx, 1 }));
+                        Assert::AreEqual(2.0f * sampleIndex, expectedOutput.GetElement({ sIdx, 0 }));
+                        order.push_back(static_cast<u32>(sampleIndex));
+                    }
+                }
+                return order;
+            }
+
+        public:
+            TEST_METHOD(Next_ReturnsEverySampleInOrder_WithoutShuffling)
+            {
+                WriteDataset(10);
+
+                data::DatasetOptions options;
+                options.batchSize = 4;
+                {
+                    data::DatasetReader reader(data::OpenBinary(c_Path, { 2 }, 1), options);
+
+                    // Every epoch holds two full batches & a partial one
+                    for (u32 eIdx = 0; eIdx < 3; ++eIdx)
+                    {
+                        std::vector<u32> const order = ReadEpoch(reader, options.batchSize);
+                        Assert::AreEqual(static_cast<size_t>(10), order.size());
+                        for (u32 sIdx = 0; sIdx < order.size(); ++sIdx)
+                        {
+                            Assert::AreEqual(sIdx, order[sIdx]);
+                        }
+                        Assert::AreEqual(static_cast<u64>(eIdx + 1), reader.GetNumEpochs());
+                    }
+                }
+
+                remove(c_Path);
+            }
+
+            TEST_METHOD(Next_ShufflesEverySampleOncePerEpoch)
+            {
+                u32 const numSamples = 1000;
+                WriteDataset(numSamples);
+
+                data::DatasetOptions options;
+                options.batchSize = 32;
+                options.shuffleWindow = 100;
+                options.seed = 3;
+                {
+                    data::DatasetReader reader(data::OpenBinary(c_Path, { 2 }, 1), options);
+                    data::DatasetReader sameSeedReader(data::OpenBinary(c_Path, { 2 }, 1), options);
+
+                    std::vector<u32> previousOrder;
+                    for (u32 eIdx = 0; eIdx < 2; ++eIdx)
+                    {
+                        std::vector<u32> const order = ReadEpoch(reader, options.batchSize);
+                        Assert::IsTrue(order == ReadEpoch(sameSeedReader, options.batchSize));
+
+                        // Every sample is read once, though not in the order of the file, & no sample moves further
+                        // forward than the window allows
+                        std::vector<bool> isRead(numSamples, false);
+                        u32 numInPlace = 0;
+                        for (u32 sIdx = 0; sIdx < order.size(); ++sIdx)
+                        {
+                            Assert::IsFalse(isRead[order[sIdx]]);
+                            isRead[order[sIdx]] = true;
+                            numInPlace += (order[sIdx] == sIdx) ? 1 : 0;
+                            Assert::IsTrue(order[sIdx] < sIdx + options.shuffleWindow);
+                        }
+                        Assert::AreEqual(static_cast<size_t>(numSamples), order.size());
+                        Assert::IsTrue(numInPlace < numSamples / 10);
+
+                        // Each epoch is shuffled differently
+                        Assert::IsTrue(order != previousOrder);
+                        previousOrder = order;
+                    }
+                }
+
+                remove(c_Path);
+            }
+
+            TEST_METHOD(Next_FeedsSequentialTrain)
+            {
+                static char const * c_CSVPath = "DatasetReader.tests.csv";
+
+                // XOR, repeated so that each epoch holds a few batches
+                FILE * file = fopen(c_CSVPath, "w");
+                Assert::IsNotNull(file);
+                fprintf(file, "a,b,xor\n");
+                for (u32 rIdx = 0; rIdx < 8; ++rIdx)
+                {
+                    fprintf(file, "0,0,0\n1,0,1\n0,1,1\n1,1,0\n");
+                }
+                fclose(file);
+
+                data::DatasetOptions options;
+                options.batchSize = 8;
+                options.shuffleWindow = 16;
+                options.seed = 1;
+
+                {
+                    data::DatasetReader reader(data::OpenCSV(c_CSVPath, { 2 }, 1), options);
+
+                    models::Sequential model({
+                        new layers::Flatten({ 2 }, activators::ActivatorType::None),
+                        new layers::Dense(8, activators::ActivatorType::Sigmoid),
+                        new layers::Dense(1, activators::ActivatorType::Sigmoid)
+                    });
+                    model.Compile(7, options.batchSize, optimizers::Optimizer::Adam(0.05f));
+
+                    Tensor input, expectedOutput;
+                    while (reader.GetNumEpochs() < 100)
+                    {
+                        while (reader.Next(input, expectedOutput))
+                        {
+                            model.Train(input, expectedOutput);
+                        }
+                    }
+
+                    Assert::IsTrue(model.GetLoss() < 0.01f);
+                }
+
+                remove(c_CSVPath);
+            }
+        };
+    }
+}
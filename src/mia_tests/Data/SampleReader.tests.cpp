@@ -0,0 +1,231 @@
+#include <CppUnitTest.h>
+
+#include <Data/SampleReader.h>
+
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace mia
+{
+    namespace tests
+    {
+        TEST_CLASS(SampleReaderTests)
+        {
+            // Writes numBytes bytes of data to the file at path
+            static void WriteFile(char const * path, void const * data, u64 numBytes)
+            {
+                FILE * file = fopen(path, "wb");
+                Assert::IsNotNull(file);
+                Assert::AreEqual(static_cast<size_t>(numBytes), fwrite(data, 1, static_cast<size_t>(numBytes), file));
+                fclose(file);
+            }
+
+            // Returns the header of an IDX file of the supplied element type & shape
+            static std::vector<u8> MakeIDXHeader(u8 type, std::initializer_list<unsigned int> const & shape)
+            {
+                std::vector<u8> header = { 0, 0, type, static_cast<u8>(shape.size()) };
+                for (unsigned int length : shape)
+                {
+                    header.push_back(static_cast<u8>(length >> 24));
+                    header.push_back(static_cast<u8>(length >> 16));
+                    header.push_back(static_cast<u8>(length >> 8));
+                    header.push_back(static_cast<u8>(length));
+                }
+                return header;
+            }
+
+        public:
+            TEST_METHOD(OpenBinary_ReadsEachRecord_AcrossBufferBoundaries)
+            {
+                static char const * c_Path = "SampleReader.tests.bin";
+
+                // Records of 7 values, spanning a few of the reader's chunks, followed by a partial record
+                u32 const numSamples = 50000;
+                std::vector<f32> values((static_cast<size_t>(numSamples) * 7) + 3);
+                for (u64 eIdx = 0; eIdx < values.size(); ++eIdx)
+                {
+                    values[eIdx] = static_cast<f32>(eIdx);
+                }
+                WriteFile(c_Path, values.data(), values.size() * sizeof(f32));
+
+                std::unique_ptr<data::SampleReader> reader = data::OpenBinary(c_Path, { 3, 2 }, 1);
+                Assert::IsNotNull(reader.get());
+                Assert::AreEqual(static_cast<u32>(2), reader->GetInputNumDimensions());
+                Assert::AreEqual(static_cast<u64>(6), reader->GetNumInputs());
+                Assert::AreEqual(static_cast<u32>(1), reader->GetNumOutputs());
+
+                for (u32 pass = 0; pass < 2; ++pass)
+                {
+                    f32 input[6];
+                    f32 expectedOutput;
+                    for (u32 sIdx = 0; sIdx < numSamples; ++sIdx)
+                    {
+                        Assert::IsTrue(reader->Read(input, &expectedOutput));
+                        Assert::AreEqual(static_cast<f32>(sIdx * 7), input[0]);
+                        Assert::AreEqual(static_cast<f32>((sIdx * 7) + 5), input[5]);
+                        Assert::AreEqual(static_cast<f32>((sIdx * 7) + 6), expectedOutput);
+                    }
+
+                    Assert::IsFalse(reader->Read(input, &expectedOutput));
+                    Assert::IsTrue(reader->Rewind());
+                }
+
+                reader.reset();
+                remove(c_Path);
+
+                Assert::IsTrue(nullptr == data::OpenBinary(c_Path, { 6 }, 1));
+            }
+
+            TEST_METHOD(OpenCSV_SkipsTheHeader_AndStopsAtTheFirstInvalidLine)
+            {
+                static char const * c_Path = "SampleReader.tests.csv";
+
+                char const text[] =
+                    "a,b,label\r\n"
+                    "0.5, -1 ,1\r\n"
+                    "\n"
+                    "2,3e2,0\n"
+                    "1,2\n"
+                    "4,5,6\n";
+                WriteFile(c_Path, text, strlen(text));
+
+                std::unique_ptr<data::SampleReader> reader = data::OpenCSV(c_Path, { 2 }, 1);
+                Assert::IsNotNull(reader.get());
+
+                for (u32 pass = 0; pass < 2; ++pass)
+                {
+                    f32 input[2];
+                    f32 expectedOutput;
+                    Assert::IsTrue(reader->Read(input, &expectedOutput));
+                    Assert::AreEqual(0.5f, input[0]);
+                    Assert::AreEqual(-1.0f, input[1]);
+                    Assert::AreEqual(1.0f, expectedOutput);
+
+                    Assert::IsTrue(reader->Read(input, &expectedOutput));
+                    Assert::AreEqual(2.0f, input[0]);
+                    Assert::AreEqual(300.0f, input[1]);
+                    Assert::AreEqual(0.0f, expectedOutput);
+
+                    // The line holding too few values ends the file
+                    Assert::IsFalse(reader->Read(input, &expectedOutput));
+                    Assert::IsTrue(reader->Rewind());
+                }
+
+                reader.reset();
+                remove(c_Path);
+            }
+
+            TEST_METHOD(OpenIDX_DecodesTheInputs_AndOneHotEncodesTheLabels)
+            {
+                static char const * c_InputsPath = "SampleReader.tests.images.idx";
+                static char const * c_LabelsPath = "SampleReader.tests.labels.idx";
+
+                // Three 2 x 2 images of bytes & their class indices
+                std::vector<u8> images = MakeIDXHeader(0x08, { 3, 2, 2 });
+                for (u8 eIdx = 0; eIdx < 12; ++eIdx)
+                {
+                    images.push_back(static_cast<u8>(eIdx * 20));
+                }
+                WriteFile(c_InputsPath, images.data(), images.size());
+
+                std::vector<u8> labels = MakeIDXHeader(0x08, { 3 });
+                labels.push_back(2);
+                labels.push_back(0);
+                labels.push_back(1);
+                WriteFile(c_LabelsPath, labels.data(), labels.size());
+
+                std::unique_ptr<data::SampleReader> reader = data::OpenIDX(c_InputsPath, c_LabelsPath, 3, 0.5f);
+                Assert::IsNotNull(reader.get());
+                Assert::AreEqual(static_cast<u32>(2), reader->GetInputNumDimensions());
+                Assert::AreEqual(static_cast<u32>(2), reader->GetInputDimensionLengths()[0]);
+                Assert::AreEqual(static_cast<u32>(2), reader->GetInputDimensionLengths()[1]);
+                Assert::AreEqual(static_cast<u32>(3), reader->GetNumOutputs());
+
+                u32 const expectedClasses[] = { 2, 0, 1 };
+                for (u32 pass = 0; pass < 2; ++pass)
+                {
+                    f32 input[4];
+                    f32 expectedOutput[3];
+                    for (u32 sIdx = 0; sIdx < 3; ++sIdx)
+                    {
+                        Assert::IsTrue(reader->Read(input, expectedOutput));
+                        for (u32 eIdx = 0; eIdx < 4; ++eIdx)
+                        {
+                            Assert::AreEqual(static_cast<f32>(((sIdx * 4) + eIdx) * 10), input[eIdx]);
+                        }
+                        for (u32 cIdx = 0; cIdx < 3; ++cIdx)
+                        {
+                            Assert::AreEqual((cIdx == expectedClasses[sIdx]) ? 1.0f : 0.0f, expectedOutput[cIdx]);
+                        }
+                    }
+
+                    Assert::IsFalse(reader->Read(input, expectedOutput));
+                    Assert::IsTrue(reader->Rewind());
+                }
+
+                reader.reset();
+                remove(c_InputsPath);
+                remove(c_LabelsPath);
+            }
+
+            TEST_METHOD(OpenIDX_DecodesBigEndianElements)
+            {
+                static char const * c_Path = "SampleReader.tests.floats.idx";
+
+                // Two samples of two big-endian floats (1.5 & -2, then 0.25 & 8)
+                std::vector<u8> file = MakeIDXHeader(0x0D, { 2, 2 });
+                u8 const elements[] = {
+                    0x3F, 0xC0, 0x00, 0x00,     0xC0, 0x00, 0x00, 0x00,
+                    0x3E, 0x80, 0x00, 0x00,     0x41, 0x00, 0x00, 0x00
+                };
+                file.insert(file.end(), elements, elements + sizeof(elements));
+                WriteFile(c_Path, file.data(), file.size());
+
+                std::unique_ptr<data::SampleReader> reader = data::OpenIDX(c_Path);
+                Assert::IsNotNull(reader.get());
+                Assert::AreEqual(static_cast<u32>(0), reader->GetNumOutputs());
+
+                f32 input[2];
+                Assert::IsTrue(reader->Read(input, nullptr));
+                Assert::AreEqual(1.5f, input[0]);
+                Assert::AreEqual(-2.0f, input[1]);
+                Assert::IsTrue(reader->Read(input, nullptr));
+                Assert::AreEqual(0.25f, input[0]);
+                Assert::AreEqual(8.0f, input[1]);
+                Assert::IsFalse(reader->Read(input, nullptr));
+
+                reader.reset();
+                remove(c_Path);
+            }
+
+            TEST_METHOD(OpenIDX_RejectsInvalidFiles)
+            {
+                static char const * c_InputsPath = "SampleReader.tests.invalid.idx";
+                static char const * c_LabelsPath = "SampleReader.tests.invalid.labels.idx";
+
+                // Not an IDX file
+                char const text[] = "1,2,3\n";
+                WriteFile(c_InputsPath, text, strlen(text));
+                Assert::IsTrue(nullptr == data::OpenIDX(c_InputsPath));
+
+                // Labels for a different number of samples
+                std::vector<u8> images = MakeIDXHeader(0x08, { 2, 1 });
+                images.push_back(1);
+                images.push_back(2);
+                WriteFile(c_InputsPath, images.data(), images.size());
+                std::vector<u8> labels = MakeIDXHeader(0x08, { 3 });
+                labels.insert(labels.end(), 3, 0);
+                WriteFile(c_LabelsPath, labels.data(), labels.size());
+
+                Assert::IsNotNull(data::OpenIDX(c_InputsPath).get());
+                Assert::IsTrue(nullptr == data::OpenIDX(c_InputsPath, c_LabelsPath, 2));
+
+                remove(c_InputsPath);
+                remove(c_LabelsPath);
+            }
+        };
+    }
+}
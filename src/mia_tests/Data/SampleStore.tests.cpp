@@ -0,0 +1,206 @@
+#include <CppUnitTest.h>
+
+#include <Data/SampleStore.h>
+#include <Models/Sequential.h>
+#include <Layers/Flatten.h>
+#include <Layers/Dense.h>
+
+#include <stdio.h>
+#include <vector>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace mia
+{
+    namespace tests
+    {
+        TEST_CLASS(SampleStoreTests)
+        {
+            static char constexpr const * c_DatasetPath = "SampleStore.tests.bin";
+            static char constexpr const * c_StorePath = "SampleStore.tests.miastore";
+
+            // Writes a sample store of numSamples samples of (3 x 2) inputs & 2 expected outputs: element e of
+            // sample n holds (n * 8) + e.
+            static void WriteStore(u32 numSamples)
+            {
+                std::vector<f32> values(static_cast<size_t>(numSamples) * 8);
+                for (u64 eIdx = 0; eIdx < values.size(); ++eIdx)
+                {
+                    values[eIdx] = static_cast<f32>(eIdx);
+                }
+
+                FILE * file = fopen(c_DatasetPath, "wb");
+                Assert::IsNotNull(file);
+                Assert::AreEqual(values.size(), fwrite(values.data(), sizeof(f32), values.size(), file));
+                fclose(file);
+
+                std::unique_ptr<data::SampleReader> reader = data::OpenBinary(c_DatasetPath, { 3, 2 }, 2);
+                Assert::IsNotNull(reader.get());
+                Assert::IsTrue(data::WriteSampleStore(c_StorePath, *reader));
+
+                reader.reset();
+                remove(c_DatasetPath);
+            }
+
+        public:
+            TEST_METHOD(GetBatch_ViewsTheSamples_WithoutCopying)
+            {
+                WriteStore(100);
+
+                {
+                    data::SampleStore store;
+                    Assert::IsTrue(store.Open(c_StorePath));
+                    Assert::AreEqual(static_cast<u64>(100), store.GetNumSamples());
+                    Assert::AreEqual(static_cast<u32>(2), store.GetInputNumDimensions());
+                    Assert::AreEqual(static_cast<u32>(3), store.GetInputDimensionLengths()[0]);
+                    Assert::AreEqual(static_cast<u32>(2), store.GetInputDimensionLengths()[1]);
+                    Assert::AreEqual(static_cast<u64>(6), store.GetNumInputs());
+                    Assert::AreEqual(static_cast<u32>(2), store.GetNumOutputs());
+
+                    Tensor input, expectedOutput;
+                    store.GetBatch(10, 42, input, expectedOutput);
+                    Assert::IsTrue(input.IsBorrowed());
+                    Assert::AreEqual(static_cast<u32>(3), input.GetNumDimensions());
+                    Assert::AreEqual(static_cast<u32>(32), input.GetLength(0));
+                    Assert::AreEqual(static_cast<u32>(32), expectedOutput.GetLength(0));
+                    Assert::AreEqual(static_cast<u32>(2), expectedOutput.GetLength(1));
+
+                    for (u64 sIdx = 0; sIdx < 32; ++sIdx)
+                    {
+                        // Every sample starts on an aligned record
+                        Assert::AreEqual(static_cast<u64>(0), reinterpret_cast<u64>(&input.GetElement({ sIdx, 0, 0 })) % data::format::c_RecordAlignment);
+
+                        f32 const first = static_cast<f32>((sIdx + 10) * 8);
+                        Assert::AreEqual(first, input.GetElement({ sIdx, 0, 0 }));
+                        Assert::AreEqual(first + 3.0f, input.GetElement({ sIdx, 1, 1 }));
+                        Assert::AreEqual(first + 5.0f, input.GetElement({ sIdx, 2, 1 }));
+                        Assert::AreEqual(first + 6.0f, expectedOutput.GetElement({ sIdx, 0 }));
+                        Assert::AreEqual(first + 7.0f, expectedOutput.GetElement({ sIdx, 1 }));
+                    }
+                }
+
+                remove(c_StorePath);
+            }
+
+            TEST_METHOD(Gather_CopiesTheSamplesAtTheSuppliedIndices)
+            {
+                WriteStore(50);
+
+                {
+                    data::SampleStore store;
+                    Assert::IsTrue(store.Open(c_StorePath, AccessPattern::Random));
+
+                    u64 const indices[] = { 49, 0, 17, 17, 3 };
+                    store.Prefetch(indices, LENGTHOF(indices));
+
+                    Tensor input({ LENGTHOF(indices), 3, 2 });
+                    Tensor expectedOutput({ LENGTHOF(indices), 2 });
+                    store.Gather(indices, LENGTHOF(indices), input, expectedOutput);
+
+                    for (u64 iIdx = 0; iIdx < LENGTHOF(indices); ++iIdx)
+                    {
+                        f32 const first = static_cast<f32>(indices[iIdx] * 8);
+                        for (u64 eIdx = 0; eIdx < 6; ++eIdx)
+                        {
+                            Assert::AreEqual(first + eIdx, input.GetData()[(iIdx * 6) + eIdx]);
+                        }
+                        Assert::AreEqual(first + 6.0f, expectedOutput.GetElement({ iIdx, 0 }));
+                        Assert::AreEqual(first + 7.0f, expectedOutput.GetElement({ iIdx, 1 }));
+                    }
+
+                    // The expected outputs are optional
+                    store.SetAccessPattern(AccessPattern::Sequential);
+                    store.Gather(indices, 1, input.Slice(0, 0, 1), Tensor());
+                    Assert::AreEqual(static_cast<f32>(49 * 8), input.GetData()[0]);
+                }
+
+                remove(c_StorePath);
+            }
+
+            TEST_METHOD(GetBatch_TrainsLikeTheSameSamplesInMemory)
+            {
+                WriteStore(16);
+
+                {
+                    data::SampleStore store;
+                    Assert::IsTrue(store.Open(c_StorePath));
+
+                    models::Sequential * sequentials[2];
+                    for (u32 mIdx = 0; mIdx < 2; ++mIdx)
+                    {
+                        sequentials[mIdx] = new models::Sequential({
+                            new layers::Flatten({ 3, 2 }, activators::ActivatorType::None),
+                            new layers::Dense(4, activators::ActivatorType::Sigmoid),
+                            new layers::Dense(2, activators::ActivatorType::None)
+                        });
+                        sequentials[mIdx]->Compile(c_SeedValue, 8, optimizers::Optimizer::SGD(0.0001f));
+                    }
+
+                    // One model trains on the views of the mapping, the other on contiguous copies
+                    for (u32 bIdx = 0; bIdx < 2; ++bIdx)
+                    {
+                        Tensor input, expectedOutput;
+                        store.GetBatch(bIdx * 8, (bIdx + 1) * 8, input, expectedOutput);
+                        sequentials[0]->Train(input, expectedOutput);
+                        sequentials[1]->Train(input.Contiguous(), expectedOutput.Contiguous());
+                    }
+
+                    Tensor input, expectedOutput;
+                    store.GetBatch(0, 8, input, expectedOutput);
+                    Matrix const predicted = sequentials[0]->Predict(input);
+                    Matrix const expected = sequentials[1]->Predict(input.Contiguous());
+                    Assert::AreEqual(expected.GetWidth(), predicted.GetWidth());
+                    Assert::AreEqual(expected.GetHeight(), predicted.GetHeight());
+                    for (u32 yIdx = 0; yIdx < expected.GetHeight(); ++yIdx)
+                    {
+                        for (u32 xIdx = 0; xIdx < expected.GetWidth(); ++xIdx)
+                        {
+                            Assert::AreEqual(expected.GetElement(yIdx, xIdx), predicted.GetElement(yIdx, xIdx));
+                        }
+                    }
+
+                    delete sequentials[0];
+                    delete sequentials[1];
+                }
+
+                remove(c_StorePath);
+            }
+
+            TEST_METHOD(Open_RejectsInvalidFiles)
+            {
+                data::SampleStore store;
+                Assert::IsFalse(store.Open(c_StorePath));
+
+                // Not a sample store
+                FILE * file = fopen(c_StorePath, "wb");
+                Assert::IsNotNull(file);
+                fprintf(file, "1,2,3\n");
+                fclose(file);
+                Assert::IsFalse(store.Open(c_StorePath));
+
+                // A truncated store
+                WriteStore(10);
+                std::vector<u8> bytes;
+                file = fopen(c_StorePath, "rb");
+                Assert::IsNotNull(file);
+                for (int c = fgetc(file); EOF != c; c = fgetc(file))
+                {
+                    bytes.push_back(static_cast<u8>(c));
+                }
+                fclose(file);
+
+                Assert::IsTrue(store.Open(c_StorePath));
+                store.Close();
+                Assert::IsFalse(store.IsOpen());
+
+                file = fopen(c_StorePath, "wb");
+                Assert::IsNotNull(file);
+                fwrite(bytes.data(), 1, bytes.size() - 1, file);
+                fclose(file);
+                Assert::IsFalse(store.Open(c_StorePath));
+
+                remove(c_StorePath);
+            }
+        };
+    }
+}
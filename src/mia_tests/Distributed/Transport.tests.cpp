@@ -0,0 +1,129 @@
+#include <CppUnitTest.h>
+
+#include <Distributed/Transport.h>
+
+#include "../Helpers/LocalRanks.h"
+
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#if !defined(_WIN32)
+#include <unistd.h>
+#endif
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace mia
+{
+    namespace tests
+    {
+        // The transports are only implemented for POSIX hosts
+#if !defined(_WIN32)
+        TEST_CLASS(TransportTests)
+        {
+            static u32 constexpr c_NumRanks = 4;
+
+            // Creates the transport of the supplied rank, of the kind under test.
+            typedef std::function<std::unique_ptr<distributed::Transport>(u32 rank)> ConnectFunction;
+
+            // All-reduces values of each of the supplied counts across c_NumRanks ranks: element e of rank r holds
+            // (r * 1000) + e, so every sum is exact. Checks every rank receives the sums.
+            static bool AllReduceOnEveryRank(ConnectFunction const & connect, std::initializer_list<u64> const & counts)
+            {
+                return RunLocalRanks(c_NumRanks, [&](u32 rank) -> bool
+                {
+                    std::unique_ptr<distributed::Transport> transport = connect(rank);
+                    if ((nullptr == transport) || (rank != transport->GetRank()) || (c_NumRanks != transport->GetNumRanks()))
+                    {
+                        return false;
+                    }
+
+                    for (u64 count : counts)
+                    {
+                        std::vector<f32> values(count);
+                        for (u64 eIdx = 0; eIdx < count; ++eIdx)
+                        {
+                            values[eIdx] = static_cast<f32>((rank * 1000) + eIdx);
+                        }
+
+                        if (!transport->AllReduce(values.data(), count))
+                        {
+                            return false;
+                        }
+
+                        // 1000 * (0 + 1 + 2 + 3)
+                        for (u64 eIdx = 0; eIdx < count; ++eIdx)
+                        {
+                            if (values[eIdx] != static_cast<f32>(6000 + (c_NumRanks * eIdx)))
+                            {
+                                return false;
+                            }
+                        }
+                    }
+
+                    return true;
+                });
+            }
+
+        public:
+            TEST_METHOD(SharedMemoryAllReduce_SumsTheValuesOfEveryRank)
+            {
+                // Chunks of 64 values split 1000 values unevenly, counts smaller than the number of ranks leave some
+                // ranks nothing to sum
+                u64 const session = CreateSession();
+                Assert::IsTrue(AllReduceOnEveryRank([=](u32 rank)
+                {
+                    return distributed::ConnectSharedMemory("mia_tests.Transport", session, rank, c_NumRanks, 64);
+                }, { 1, 3, 64, 1000, 0, 7 }));
+            }
+
+            TEST_METHOD(SocketAllReduce_SumsTheValuesOfEveryRank)
+            {
+                Assert::IsTrue(AllReduceOnEveryRank([](u32 rank)
+                {
+                    return distributed::ConnectSocket("Transport.tests.sock", rank, c_NumRanks);
+                }, { 1, 3, 64, 1000, 0, 7, 300000 }));
+            }
+
+            TEST_METHOD(SharedMemoryConnect_IgnoresTheBlocksOfEarlierSessions)
+            {
+                // A rank 0 that crashes while waiting for the other ranks leaves its block behind, ready
+                Assert::IsFalse(RunLocalRanks(1, [](u32) -> bool
+                {
+                    alarm(1);
+                    return nullptr != distributed::ConnectSharedMemory("mia_tests.Transport", CreateSession(), 0, 2, 64);
+                }));
+
+                // Rank 1 finds the block before rank 0 of its own session replaces it
+                u64 const session = CreateSession();
+                Assert::IsTrue(RunLocalRanks(2, [=](u32 rank) -> bool
+                {
+                    if (0 == rank)
+                    {
+                        std::this_thread::sleep_for(std::chrono::milliseconds(200));
+                    }
+
+                    std::unique_ptr<distributed::Transport> transport = distributed::ConnectSharedMemory("mia_tests.Transport", session, rank, 2, 64, 2);
+                    f32 value = 1.0f;
+                    return (nullptr != transport) && transport->AllReduce(&value, 1) && (2.0f == value);
+                }));
+            }
+
+            TEST_METHOD(Connect_Fails_WhenTheOtherRanksNeverConnect)
+            {
+                Assert::IsNull(distributed::ConnectSharedMemory("mia_tests.Transport", CreateSession(), 0, 2, 64, 1).get());
+                Assert::IsNull(distributed::ConnectSharedMemory("mia_tests.Transport", CreateSession(), 1, 2, 64, 1).get());
+                Assert::IsNull(distributed::ConnectSocket("Transport.tests.sock", 0, 2, 1).get());
+
+                // A single rank has no one to wait for
+                std::unique_ptr<distributed::Transport> transport = distributed::ConnectSocket("Transport.tests.sock", 0, 1, 1);
+                Assert::IsNotNull(transport.get());
+                f32 value = 2.0f;
+                Assert::IsTrue(transport->AllReduce(&value, 1));
+                Assert::AreEqual(2.0f, value);
+            }
+        };
+#endif
+    }
+}
@@ -0,0 +1,87 @@
+#include "AllocationCounter.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace mia
+{
+    namespace tests
+    {
+        namespace
+        {
+            std::atomic<u64> s_NumAllocations(0);
+            std::atomic<u32> s_NumActiveCounters(0);
+        }
+
+        void * CountedAllocate(std::size_t size)
+        {
+            if (s_NumActiveCounters.load(std::memory_order_relaxed) > 0)
+            {
+                s_NumAllocations.fetch_add(1, std::memory_order_relaxed);
+            }
+
+            void * ptr = malloc((size > 0) ? size : 1);
+            if (nullptr == ptr)
+            {
+                throw std::bad_alloc();
+            }
+
+            return ptr;
+        }
+    }
+}
+
+// Replace the global allocation functions so that every allocation can be counted
+void * operator new(std::size_t size)
+{
+    return mia::tests::CountedAllocate(size);
+}
+
+void * operator new[](std::size_t size)
+{
+    return mia::tests::CountedAllocate(size);
+}
+
+void operator delete(void * ptr) noexcept
+{
+    free(ptr);
+}
+
+void operator delete[](void * ptr) noexcept
+{
+    free(ptr);
+}
+
+void operator delete(void * ptr, std::size_t size) noexcept
+{
+    free(ptr);
+}
+
+void operator delete[](void * ptr, std::size_t size) noexcept
+{
+    free(ptr);
+}
+
+namespace mia
+{
+    namespace tests
+    {
+        AllocationCounter::AllocationCounter()
+            : m_StartNumAllocations(0)
+        {
+            ++s_NumActiveCounters;
+            m_StartNumAllocations = s_NumAllocations.load();
+        }
+
+        AllocationCounter::~AllocationCounter()
+        {
+            --s_NumActiveCounters;
+        }
+
+        u64 AllocationCounter::GetNumAllocations() const
+        {
+            return s_NumAllocations.load() - m_StartNumAllocations;
+        }
+    }
+}
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <Common.h>
+
+namespace mia
+{
+    namespace tests
+    {
+        // Counts the heap allocations made (by any thread) through the global operator new while
+        // the counter is alive. Used to check code paths that are expected not to allocate.
+        class AllocationCounter final
+        {
+        public:
+            AllocationCounter();
+            AllocationCounter(AllocationCounter const & other) = delete;
+            ~AllocationCounter();
+
+            // Returns the number of allocations made since the counter was constructed.
+            u64 GetNumAllocations() const;
+
+        private:
+            u64 m_StartNumAllocations;
+        };
+    }
+}
@@ -0,0 +1,74 @@
+#include "LocalRanks.h"
+#include "ThreadCountScope.h"
+
+#include <atomic>
+#include <chrono>
+#include <stdio.h>
+#include <vector>
+
+#if !defined(_WIN32)
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+namespace mia
+{
+    namespace tests
+    {
+        bool RunLocalRanks(u32 numRanks, std::function<bool(u32 rank)> const & rankFunction)
+        {
+#if defined(_WIN32)
+            return false;
+#else
+            // A forked process only inherits the thread that forked it, so the pool mustn't have any workers
+            // for the ranks to inherit
+            ThreadCountScope const threadCount(1);
+            fflush(stdout);
+            fflush(stderr);
+
+            std::vector<pid_t> processes;
+            for (u32 rank = 0; rank < numRanks; ++rank)
+            {
+                pid_t const process = fork();
+                if (0 == process)
+                {
+                    // The rank must never return into the test framework
+                    bool isSuccessful = false;
+                    try
+                    {
+                        isSuccessful = rankFunction(rank);
+                    }
+                    catch (...)
+                    {
+                    }
+                    _exit(isSuccessful ? 0 : 1);
+                }
+
+                if (process > 0)
+                {
+                    processes.push_back(process);
+                }
+            }
+
+            bool isSuccessful = (numRanks == processes.size());
+            for (u32 pIdx = 0; pIdx < processes.size(); ++pIdx)
+            {
+                int status = 0;
+                bool const hasExited = (processes[pIdx] == waitpid(processes[pIdx], &status, 0));
+                isSuccessful = isSuccessful && hasExited && WIFEXITED(status) && (0 == WEXITSTATUS(status));
+            }
+
+            return isSuccessful;
+#endif
+        }
+
+        u64 CreateSession()
+        {
+            // The counter tells apart the sessions created within the resolution of the clock
+            static std::atomic<u64> s_NumSessions(0);
+            u64 const time = static_cast<u64>(std::chrono::system_clock::now().time_since_epoch().count());
+            return time + s_NumSessions.fetch_add(1);
+        }
+    }
+}
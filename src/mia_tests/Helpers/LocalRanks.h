@@ -0,0 +1,20 @@
+#pragma once
+
+#include <Common.h>
+
+#include <functional>
+
+namespace mia
+{
+    namespace tests
+    {
+        // Runs numRanks ranks of a distributed test as child processes of the test, each calling rankFunction
+        // with its own rank. Returns true once every rank has returned true, false if any rank returned false or
+        // didn't exit cleanly (e.g. threw an exception). Only supported where processes can be forked.
+        bool RunLocalRanks(u32 numRanks, std::function<bool(u32 rank)> const & rankFunction);
+
+        // Returns a session for the ranks of a test to connect with (see distributed::ConnectSharedMemory), which
+        // differs from the session of any earlier test.
+        u64 CreateSession();
+    }
+}
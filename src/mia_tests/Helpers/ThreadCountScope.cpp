@@ -0,0 +1,20 @@
+#include "ThreadCountScope.h"
+
+#include <Core/ThreadPool.h>
+
+namespace mia
+{
+    namespace tests
+    {
+        ThreadCountScope::ThreadCountScope(u32 numThreads)
+            : m_PreviousNumThreads(ThreadPool::Get().GetNumThreads())
+        {
+            ThreadPool::Get().SetNumThreads(numThreads);
+        }
+
+        ThreadCountScope::~ThreadCountScope()
+        {
+            ThreadPool::Get().SetNumThreads(m_PreviousNumThreads);
+        }
+    }
+}
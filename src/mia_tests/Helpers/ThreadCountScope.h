@@ -0,0 +1,22 @@
+#pragma once
+
+#include <Common.h>
+
+namespace mia
+{
+    namespace tests
+    {
+        // Sets the number of threads of the process-wide ThreadPool while the scope is alive & restores the
+        // previous number when it ends, including when a failed assertion throws out of the test.
+        class ThreadCountScope final
+        {
+        public:
+            explicit ThreadCountScope(u32 numThreads);
+            ThreadCountScope(ThreadCountScope const & other) = delete;
+            ~ThreadCountScope();
+
+        private:
+            u32 m_PreviousNumThreads;
+        };
+    }
+}
@@ -0,0 +1,82 @@
+#include "TrainingFixture.h"
+
+#include <Layers/Layer.h>
+#include <Layers/Flatten.h>
+#include <Layers/Dense.h>
+
+#include <math.h>
+
+namespace mia
+{
+    namespace tests
+    {
+        namespace
+        {
+            u32 constexpr c_SeedValue = 11;
+        }
+
+        models::Sequential * CreateRegressionModel(u32 maxBatchSize, optimizers::Optimizer const & optimizer)
+        {
+            models::Sequential * model = new models::Sequential({
+                new layers::Flatten({ 3 }, activators::ActivatorType::None),
+                new layers::Dense(16, activators::ActivatorType::Tanh),
+                new layers::Dense(8, activators::ActivatorType::ReLU),
+                new layers::Dense(2, activators::ActivatorType::None)
+            });
+            model->Compile(c_SeedValue, maxBatchSize, optimizer);
+            return model;
+        }
+
+        void CreateRegressionBatch(u32 numSamples, u32 batchIndex, Tensor & input, Tensor & expectedOutput)
+        {
+            input = Tensor({ numSamples, 3 });
+            expectedOutput = Tensor({ numSamples, 2 });
+            for (u64 sIdx = 0; sIdx < numSamples; ++sIdx)
+            {
+                f32 const x = static_cast<f32>((sIdx * 7) + batchIndex) * 0.1f;
+                input.GetElement({ sIdx, 0 }) = sinf(x);
+                input.GetElement({ sIdx, 1 }) = cosf(x * 0.5f);
+                input.GetElement({ sIdx, 2 }) = x - floorf(x);
+                expectedOutput.GetElement({ sIdx, 0 }) = sinf(x) * cosf(x * 0.5f);
+                expectedOutput.GetElement({ sIdx, 1 }) = 0.5f - (x - floorf(x));
+            }
+        }
+
+        bool AreClose(Matrix const & expected, Matrix const & actual, f32 precision)
+        {
+            if (expected.GetCapacity() != actual.GetCapacity())
+            {
+                return false;
+            }
+
+            for (u64 eIdx = 0; eIdx < expected.GetCapacity(); ++eIdx)
+            {
+                if (!(fabsf(expected.GetData()[eIdx] - actual.GetData()[eIdx]) <= precision))
+                {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        bool HaveCloseParameters(models::Sequential const & expected, models::Sequential const & actual, f32 precision)
+        {
+            if (expected.GetNumLayers() != actual.GetNumLayers())
+            {
+                return false;
+            }
+
+            for (u32 layerIndex = 1; layerIndex < expected.GetNumLayers(); ++layerIndex)
+            {
+                layers::Layer const * expectedLayer = expected.GetLayer(layerIndex);
+                layers::Layer const * actualLayer = actual.GetLayer(layerIndex);
+                if (!AreClose(expectedLayer->GetWeights(), actualLayer->GetWeights(), precision) ||
+                    !AreClose(expectedLayer->GetBiases(), actualLayer->GetBiases(), precision))
+                {
+                    return false;
+                }
+            }
+            return true;
+        }
+    }
+}
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <Models/Sequential.h>
+
+namespace mia
+{
+    namespace tests
+    {
+        // The precision to which trainers that sum the gradients of a batch in another order than
+        // Sequential::Train (e.g. per worker or per rank) match it.
+        f32 constexpr c_TrainingPrecision = 1e-5f;
+
+        // Returns a model with 3 inputs & 2 outputs compiled for batches of up to maxBatchSize samples. Every
+        // model returned is initialised with the same parameters.
+        models::Sequential * CreateRegressionModel(u32 maxBatchSize, optimizers::Optimizer const & optimizer);
+
+        // Fills a batch of numSamples samples for CreateRegressionModel's models, whose expected outputs are
+        // functions of their inputs. Batches with other indices hold other samples.
+        void CreateRegressionBatch(u32 numSamples, u32 batchIndex, Tensor & input, Tensor & expectedOutput);
+
+        // Returns true if the supplied matrices hold as many values, each within precision of the other's.
+        bool AreClose(Matrix const & expected, Matrix const & actual, f32 precision);
+
+        // Returns true if the weights & biases of every layer of the supplied models are within precision of
+        // each other's.
+        bool HaveCloseParameters(models::Sequential const & expected, models::Sequential const & actual, f32 precision);
+    }
+}
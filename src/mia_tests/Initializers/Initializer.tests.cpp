@@ -0,0 +1,148 @@
+#include <CppUnitTest.h>
+
+#include <Initializers/Initializer.h>
+#include <Core/ThreadPool.h>
+
+#include <math.h>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace mia
+{
+    namespace tests
+    {
+        TEST_CLASS(InitializerTests)
+        {
+            static u64 constexpr c_TestSeedValue = 7;
+
+            // Large enough for the fills to be split across threads & for the statistics to be close to
+            // those of the distributions
+            static u32 constexpr c_FanIn = 300;
+            static u32 constexpr c_FanOut = 700;
+
+            static Matrix Initialize(initializers::Initializer const & initializer, activators::ActivatorType activatorType, u64 stream = 0)
+            {
+                Matrix parameters(c_FanIn, c_FanOut);
+                initializers::Initialize(initializer, activatorType, c_FanIn, c_FanOut, c_TestSeedValue, stream, parameters);
+                return parameters;
+            }
+
+            // Returns the mean & standard deviation of the parameters
+            static void GetStatistics(Matrix const & parameters, f64 & mean, f64 & standardDeviation)
+            {
+                f64 sum = 0.0;
+                f64 sumOfSquares = 0.0;
+                for (u64 eIdx = 0; eIdx < parameters.GetCapacity(); ++eIdx)
+                {
+                    f64 const value = parameters.GetData()[eIdx];
+                    sum += value;
+                    sumOfSquares += value * value;
+                }
+
+                f64 const numParameters = static_cast<f64>(parameters.GetCapacity());
+                mean = sum / numParameters;
+                standardDeviation = sqrt((sumOfSquares / numParameters) - (mean * mean));
+            }
+
+            // Checks every parameter lies within [low, high] & the parameters have the mean & standard deviation
+            // of a uniform distribution over that range
+            static void CheckIsUniform(Matrix const & parameters, f64 low, f64 high)
+            {
+                for (u64 eIdx = 0; eIdx < parameters.GetCapacity(); ++eIdx)
+                {
+                    Assert::IsTrue((parameters.GetData()[eIdx] >= low) && (parameters.GetData()[eIdx] <= high));
+                }
+
+                f64 mean, standardDeviation;
+                GetStatistics(parameters, mean, standardDeviation);
+                Assert::IsTrue(fabs(mean - ((low + high) / 2.0)) < (0.01 * (high - low)));
+                Assert::IsTrue(fabs(standardDeviation - ((high - low) / sqrt(12.0))) < (0.01 * (high - low)));
+            }
+
+            // Checks the parameters have the mean & standard deviation of the normal distribution
+            static void CheckIsNormal(Matrix const & parameters, f64 expectedMean, f64 expectedStandardDeviation)
+            {
+                f64 mean, standardDeviation;
+                GetStatistics(parameters, mean, standardDeviation);
+                Assert::IsTrue(fabs(mean - expectedMean) < (0.01 * expectedStandardDeviation));
+                Assert::IsTrue(fabs(standardDeviation - expectedStandardDeviation) < (0.01 * expectedStandardDeviation));
+            }
+
+        public:
+            TEST_METHOD(Initialize_Constant_FillsEveryParameter)
+            {
+                Matrix const parameters = Initialize(initializers::Initializer::Constant(0.25f), activators::ActivatorType::ReLU);
+                for (u64 eIdx = 0; eIdx < parameters.GetCapacity(); ++eIdx)
+                {
+                    Assert::AreEqual(0.25f, parameters.GetData()[eIdx]);
+                }
+            }
+
+            TEST_METHOD(Initialize_Uniform_DrawsFromTheRange)
+            {
+                CheckIsUniform(Initialize(initializers::Initializer::Uniform(-3.0f, 5.0f), activators::ActivatorType::ReLU), -3.0, 5.0);
+            }
+
+            TEST_METHOD(Initialize_Normal_DrawsFromTheDistribution)
+            {
+                CheckIsNormal(Initialize(initializers::Initializer::Normal(1.5f, 0.5f), activators::ActivatorType::ReLU), 1.5, 0.5);
+            }
+
+            TEST_METHOD(Initialize_Xavier_ScalesByTheInputsAndOutputs)
+            {
+                f64 const limit = sqrt(6.0 / (c_FanIn + c_FanOut));
+                CheckIsUniform(Initialize(initializers::Initializer::XavierUniform(), activators::ActivatorType::ReLU), -limit, limit);
+                CheckIsNormal(Initialize(initializers::Initializer::XavierNormal(), activators::ActivatorType::ReLU), 0.0, sqrt(2.0 / (c_FanIn + c_FanOut)));
+            }
+
+            TEST_METHOD(Initialize_He_ScalesByTheInputs)
+            {
+                f64 const limit = sqrt(6.0 / c_FanIn);
+                CheckIsUniform(Initialize(initializers::Initializer::HeUniform(), activators::ActivatorType::Sigmoid), -limit, limit);
+                CheckIsNormal(Initialize(initializers::Initializer::HeNormal(), activators::ActivatorType::Sigmoid), 0.0, sqrt(2.0 / c_FanIn));
+            }
+
+            TEST_METHOD(Initialize_Default_DependsOnTheActivator)
+            {
+                f64 const limit = sqrt(6.0 / (c_FanIn + c_FanOut));
+                CheckIsNormal(Initialize(initializers::Initializer::Default(), activators::ActivatorType::ReLU), 0.0, sqrt(2.0 / c_FanIn));
+                CheckIsUniform(Initialize(initializers::Initializer::Default(), activators::ActivatorType::Sigmoid), -limit, limit);
+            }
+
+            TEST_METHOD(Initialize_IsTheSame_WhateverTheNumberOfThreads)
+            {
+                initializers::Initializer const initializerList[] = {
+                    initializers::Initializer::Uniform(-1.0f, 1.0f),
+                    initializers::Initializer::Normal(0.0f, 1.0f)
+                };
+
+                for (u32 iIdx = 0; iIdx < LENGTHOF(initializerList); ++iIdx)
+                {
+                    ThreadPool::Get().SetNumThreads(1);
+                    Matrix const expected = Initialize(initializerList[iIdx], activators::ActivatorType::ReLU);
+
+                    ThreadPool::Get().SetNumThreads(7);
+                    Matrix const parameters = Initialize(initializerList[iIdx], activators::ActivatorType::ReLU);
+                    ThreadPool::Get().SetNumThreads(0);
+
+                    Assert::IsTrue(expected.Equals(parameters, 0.0f));
+                }
+            }
+
+            TEST_METHOD(Initialize_DrawsDifferentValues_FromEachStream)
+            {
+                Matrix const stream0 = Initialize(initializers::Initializer::Uniform(0.0f, 1.0f), activators::ActivatorType::ReLU, 0);
+                Matrix const stream1 = Initialize(initializers::Initializer::Uniform(0.0f, 1.0f), activators::ActivatorType::ReLU, 1);
+
+                u64 numEqual = 0;
+                for (u64 eIdx = 0; eIdx < stream0.GetCapacity(); ++eIdx)
+                {
+                    numEqual += (stream0.GetData()[eIdx] == stream1.GetData()[eIdx]) ? 1 : 0;
+                }
+
+                // A handful of values can coincide by chance
+                Assert::IsTrue(numEqual < 100);
+            }
+        };
+    }
+}
@@ -0,0 +1,592 @@
+#include <CppUnitTest.h>
+
+#include <Kernels/Kernels.h>
+#include <Kernels/KernelTable.h>
+#include <Core/CpuFeatures.h>
+
+#include <math.h>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace mia
+{
+    namespace tests
+    {
+        TEST_CLASS(KernelsTests)
+        {
+            static f32 constexpr c_Precision = 1e-3f;
+
+            // Lengths chosen to exercise empty arrays, partial vectors & full vectors with tails for
+            // every vector width.
+            static u64 constexpr c_Lengths[] = { 0, 1, 3, 4, 7, 8, 15, 16, 17, 31, 32, 33, 100, 1027 };
+
+            static cpu::SimdLevel constexpr c_Levels[] = {
+                cpu::SimdLevel::Scalar,
+                cpu::SimdLevel::NEON,
+                cpu::SimdLevel::AVX2,
+                cpu::SimdLevel::AVX512
+            };
+
+            static void Fill(f32 * data, u64 length, u32 seed)
+            {
+                u32 state = seed;
+                for (u64 eIdx = 0; eIdx < length; ++eIdx)
+                {
+                    state = (state * 1103515245 + 12345) & 0x7FFFFFFF;
+                    data[eIdx] = (static_cast<f32>(state % 2001) / 100.0f) - 10.0f;
+                }
+            }
+
+            // Runs the supplied test once for every SIMD level the machine supports.
+            template <class Test>
+            static void ForEachSimdLevel(Test const & test)
+            {
+                for (u32 lIdx = 0; lIdx < LENGTHOF(c_Levels); ++lIdx)
+                {
+                    if (c_Levels[lIdx] > cpu::GetDetectedSimdLevel())
+                    {
+                        continue;
+                    }
+
+                    cpu::SetMaxSimdLevel(c_Levels[lIdx]);
+                    test();
+                }
+
+                cpu::SetMaxSimdLevel(cpu::SimdLevel::AVX512);
+            }
+
+            template <class Test>
+            static void ForEachLength(Test const & test)
+            {
+                f32 a[1027];
+                f32 b[1027];
+                f32 dst[1027];
+
+                for (u32 lIdx = 0; lIdx < LENGTHOF(c_Lengths); ++lIdx)
+                {
+                    u64 const length = c_Lengths[lIdx];
+                    Fill(a, length, 1);
+                    Fill(b, length, 2);
+                    test(a, b, dst, length);
+                }
+            }
+
+        public:
+            TEST_METHOD(GetKernelTable_NeverReturnsATableAboveTheDetectedLevel)
+            {
+                ForEachSimdLevel([]()
+                {
+                    kernels::KernelTable const & table = kernels::GetKernelTable();
+                    Assert::IsNotNull(table.name);
+                    Assert::IsTrue(nullptr != table.gemm.kernel);
+                });
+            }
+
+            TEST_METHOD(Add_MatchesScalarResult)
+            {
+                ForEachSimdLevel([]()
+                {
+                    ForEachLength([](f32 * a, f32 * b, f32 * dst, u64 length)
+                    {
+                        kernels::Add(a, b, dst, length);
+                        for (u64 eIdx = 0; eIdx < length; ++eIdx)
+                        {
+                            Assert::AreEqual(a[eIdx] + b[eIdx], dst[eIdx]);
+                        }
+                    });
+                });
+            }
+
+            TEST_METHOD(Scale_MatchesScalarResult)
+            {
+                ForEachSimdLevel([]()
+                {
+                    ForEachLength([](f32 * a, f32 * b, f32 * dst, u64 length)
+                    {
+                        kernels::Scale(a, 0.25f, dst, length);
+                        for (u64 eIdx = 0; eIdx < length; ++eIdx)
+                        {
+                            Assert::AreEqual(a[eIdx] * 0.25f, dst[eIdx]);
+                        }
+                    });
+                });
+            }
+
+            TEST_METHOD(MultiplyAdd_MatchesScalarResult)
+            {
+                ForEachSimdLevel([]()
+                {
+                    ForEachLength([](f32 * a, f32 * b, f32 * dst, u64 length)
+                    {
+                        kernels::MultiplyAdd(a, 1.5f, b, dst, length);
+                        for (u64 eIdx = 0; eIdx < length; ++eIdx)
+                        {
+                            Assert::IsTrue(fabsf(((a[eIdx] * 1.5f) + b[eIdx]) - dst[eIdx]) < c_Precision);
+                        }
+                    });
+                });
+            }
+
+            TEST_METHOD(ReLU_ClampsNegativeValuesToZero)
+            {
+                ForEachSimdLevel([]()
+                {
+                    ForEachLength([](f32 * a, f32 * b, f32 * dst, u64 length)
+                    {
+                        kernels::ReLU(a, dst, length);
+                        for (u64 eIdx = 0; eIdx < length; ++eIdx)
+                        {
+                            Assert::AreEqual(std::max(a[eIdx], 0.0f), dst[eIdx]);
+                        }
+                    });
+                });
+            }
+
+            TEST_METHOD(LeakyReLU_ScalesNegativeValuesBySlope)
+            {
+                ForEachSimdLevel([]()
+                {
+                    ForEachLength([](f32 * a, f32 * b, f32 * dst, u64 length)
+                    {
+                        kernels::LeakyReLU(a, 0.125f, dst, length);
+                        for (u64 eIdx = 0; eIdx < length; ++eIdx)
+                        {
+                            Assert::AreEqual((a[eIdx] > 0.0f) ? a[eIdx] : (a[eIdx] * 0.125f), dst[eIdx]);
+                        }
+                    });
+                });
+            }
+
+            TEST_METHOD(AllClose_ReturnsTrue_WithinTolerance)
+            {
+                ForEachSimdLevel([]()
+                {
+                    ForEachLength([](f32 * a, f32 * b, f32 * dst, u64 length)
+                    {
+                        for (u64 eIdx = 0; eIdx < length; ++eIdx)
+                        {
+                            dst[eIdx] = a[eIdx] + (((eIdx % 2) == 0) ? 0.001f : -0.001f);
+                        }
+
+                        Assert::IsTrue(kernels::AllClose(a, dst, length, 0.01f));
+                        Assert::IsTrue(kernels::AllClose(a, a, length, 0.0f));
+                    });
+                });
+            }
+
+            TEST_METHOD(AllClose_ReturnsFalse_WhenLastElementDiffers)
+            {
+                ForEachSimdLevel([]()
+                {
+                    ForEachLength([](f32 * a, f32 * b, f32 * dst, u64 length)
+                    {
+                        if (0 == length)
+                        {
+                            return;
+                        }
+
+                        memcpy(dst, a, length * sizeof(f32));
+                        dst[length - 1] += 1.0f;
+
+                        Assert::IsFalse(kernels::AllClose(a, dst, length, 0.5f));
+                    });
+                });
+            }
+
+            TEST_METHOD(Sum_MatchesScalarResult)
+            {
+                ForEachSimdLevel([]()
+                {
+                    ForEachLength([](f32 * a, f32 * b, f32 * dst, u64 length)
+                    {
+                        f64 expected = 0.0;
+                        for (u64 eIdx = 0; eIdx < length; ++eIdx)
+                        {
+                            expected += a[eIdx];
+                        }
+
+                        Assert::IsTrue(fabsf(static_cast<f32>(expected) - kernels::Sum(a, length)) < 1e-2f);
+                    });
+                });
+            }
+
+            TEST_METHOD(Dot_MatchesScalarResult)
+            {
+                ForEachSimdLevel([]()
+                {
+                    ForEachLength([](f32 * a, f32 * b, f32 * dst, u64 length)
+                    {
+                        f64 expected = 0.0;
+                        for (u64 eIdx = 0; eIdx < length; ++eIdx)
+                        {
+                            expected += static_cast<f64>(a[eIdx]) * b[eIdx];
+                        }
+
+                        Assert::IsTrue(fabsf(static_cast<f32>(expected) - kernels::Dot(a, b, length)) < 1e-1f);
+                    });
+                });
+            }
+
+            TEST_METHOD(Max_MatchesScalarResult)
+            {
+                ForEachSimdLevel([]()
+                {
+                    ForEachLength([](f32 * a, f32 * b, f32 * dst, u64 length)
+                    {
+                        if (0 == length)
+                        {
+                            return;
+                        }
+
+                        f32 expected = a[0];
+                        for (u64 eIdx = 1; eIdx < length; ++eIdx)
+                        {
+                            expected = std::max(expected, a[eIdx]);
+                        }
+
+                        Assert::AreEqual(expected, kernels::Max(a, length));
+                    });
+                });
+            }
+
+            TEST_METHOD(SGDUpdate_MatchesScalarResult)
+            {
+                ForEachSimdLevel([]()
+                {
+                    ForEachLength([](f32 * a, f32 * b, f32 * dst, u64 length)
+                    {
+                        kernels::SGDStep step;
+                        step.learningRate = 0.1f;
+                        step.momentum = 0.5f;
+                        step.weightDecay = 0.01f;
+
+                        // Momentum, with dst holding the velocity
+                        f32 params[1027];
+                        Fill(params, length, 3);
+                        Fill(dst, length, 4);
+
+                        f32 expectedParams[1027];
+                        f32 expectedVelocity[1027];
+                        for (u64 eIdx = 0; eIdx < length; ++eIdx)
+                        {
+                            expectedVelocity[eIdx] = (0.5f * dst[eIdx]) + b[eIdx] + (0.01f * params[eIdx]);
+                            expectedParams[eIdx] = params[eIdx] - (0.1f * expectedVelocity[eIdx]);
+                        }
+
+                        kernels::SGDUpdate(params, dst, b, length, step);
+                        for (u64 eIdx = 0; eIdx < length; ++eIdx)
+                        {
+                            Assert::IsTrue(fabsf(expectedVelocity[eIdx] - dst[eIdx]) < c_Precision);
+                            Assert::IsTrue(fabsf(expectedParams[eIdx] - params[eIdx]) < c_Precision);
+                        }
+
+                        // Without momentum
+                        for (u64 eIdx = 0; eIdx < length; ++eIdx)
+                        {
+                            expectedParams[eIdx] = a[eIdx] - (0.1f * (b[eIdx] + (0.01f * a[eIdx])));
+                        }
+
+                        kernels::SGDUpdate(a, nullptr, b, length, step);
+                        for (u64 eIdx = 0; eIdx < length; ++eIdx)
+                        {
+                            Assert::IsTrue(fabsf(expectedParams[eIdx] - a[eIdx]) < c_Precision);
+                        }
+                    });
+                });
+            }
+
+            TEST_METHOD(AdamUpdate_MatchesScalarResult)
+            {
+                ForEachSimdLevel([]()
+                {
+                    ForEachLength([](f32 * a, f32 * b, f32 * dst, u64 length)
+                    {
+                        kernels::AdamStep step;
+                        step.beta1 = 0.9f;
+                        step.beta2 = 0.99f;
+                        step.epsilon = 1e-3f;
+                        step.stepSize = 0.5f;
+                        step.rsqrtSecondMomentCorrection = 2.0f;
+                        step.gradientDecay = 0.01f;
+                        step.parameterDecay = 0.02f;
+
+                        // dst holds the first moment
+                        f32 moment2[1027];
+                        Fill(dst, length, 3);
+                        Fill(moment2, length, 4);
+                        for (u64 eIdx = 0; eIdx < length; ++eIdx)
+                        {
+                            moment2[eIdx] = fabsf(moment2[eIdx]);
+                        }
+
+                        f32 expectedParams[1027];
+                        f32 expectedMoment1[1027];
+                        f32 expectedMoment2[1027];
+                        for (u64 eIdx = 0; eIdx < length; ++eIdx)
+                        {
+                            f32 const gradient = b[eIdx] + (0.01f * a[eIdx]);
+                            expectedMoment1[eIdx] = (0.9f * dst[eIdx]) + (0.1f * gradient);
+                            expectedMoment2[eIdx] = (0.99f * moment2[eIdx]) + (0.01f * gradient * gradient);
+                            expectedParams[eIdx] = (a[eIdx] * 0.98f) - ((0.5f * expectedMoment1[eIdx]) / ((sqrt(expectedMoment2[eIdx]) * 2.0f) + 1e-3f));
+                        }
+
+                        kernels::AdamUpdate(a, dst, moment2, b, length, step);
+                        for (u64 eIdx = 0; eIdx < length; ++eIdx)
+                        {
+                            Assert::IsTrue(fabsf(expectedMoment1[eIdx] - dst[eIdx]) < c_Precision);
+                            Assert::IsTrue(fabsf(expectedMoment2[eIdx] - moment2[eIdx]) < c_Precision);
+                            Assert::IsTrue(fabsf(expectedParams[eIdx] - a[eIdx]) < c_Precision);
+                        }
+                    });
+                });
+            }
+
+            TEST_METHOD(Transpose_MatchesScalarResult)
+            {
+                ForEachSimdLevel([]()
+                {
+                    // Block sizes with & without partial 8 x 8 (and 4 x 4) sub-blocks, read from & written
+                    // to rows that are wider than the block.
+                    u32 const sizes[][2] = { { 1, 1 }, { 3, 5 }, { 8, 8 }, { 9, 17 }, { 16, 12 }, { 31, 33 } };
+                    u64 const rowStride = 40;
+                    u64 const dstRowStride = 35;
+
+                    f32 a[40 * 40];
+                    f32 dst[40 * 35];
+                    Fill(a, LENGTHOF(a), 1);
+
+                    for (u32 sIdx = 0; sIdx < LENGTHOF(sizes); ++sIdx)
+                    {
+                        u32 const numRows = sizes[sIdx][0];
+                        u32 const numCols = sizes[sIdx][1];
+
+                        Fill(dst, LENGTHOF(dst), 2);
+                        kernels::Transpose(a, rowStride, numRows, numCols, dst, dstRowStride);
+
+                        for (u32 rIdx = 0; rIdx < numRows; ++rIdx)
+                        {
+                            for (u32 cIdx = 0; cIdx < numCols; ++cIdx)
+                            {
+                                Assert::AreEqual(a[(rIdx * rowStride) + cIdx], dst[(cIdx * dstRowStride) + rIdx]);
+                            }
+                        }
+                    }
+                });
+            }
+
+            TEST_METHOD(RandomUniform_MatchesThePhiloxKnownAnswer)
+            {
+                // Philox4x32-10 of a zero counter & key (Salmon et al., 2011). Scaling to [0, 2^24) leaves
+                // the top 24 bits of each word.
+                f32 const expected[] = {
+                    static_cast<f32>(0x6627E8D5u >> 8),
+                    static_cast<f32>(0xE169C58Du >> 8),
+                    static_cast<f32>(0xBC57AC4Cu >> 8),
+                    static_cast<f32>(0x9B00DBD8u >> 8)
+                };
+
+                ForEachSimdLevel([&]()
+                {
+                    f32 dst[4];
+                    kernels::RandomUniform(0, 0, 0, 0.0f, 16777216.0f, dst, LENGTHOF(dst));
+                    for (u64 eIdx = 0; eIdx < LENGTHOF(dst); ++eIdx)
+                    {
+                        Assert::AreEqual(expected[eIdx], dst[eIdx]);
+                    }
+                });
+            }
+
+            TEST_METHOD(RandomUniform_IsIdenticalAtEverySimdLevel_WhicheverRangeIsGenerated)
+            {
+                // Ranges starting part way through a block, whose block indices wrap their low 32 bits & of
+                // every length
+                u64 const firstIndices[] = { 0, 5, (0x100000000ull - 5) * 4 };
+                u64 const key = 0x0123456789ABCDEFull;
+                u64 const stream = 3;
+
+                for (u32 iIdx = 0; iIdx < LENGTHOF(firstIndices); ++iIdx)
+                {
+                    f32 expected[1027];
+                    cpu::SetMaxSimdLevel(cpu::SimdLevel::Scalar);
+                    kernels::RandomUniform(key, stream, firstIndices[iIdx], -2.0f, 3.0f, expected, LENGTHOF(expected));
+                    cpu::SetMaxSimdLevel(cpu::SimdLevel::AVX512);
+
+                    ForEachSimdLevel([&]()
+                    {
+                        for (u32 lIdx = 0; lIdx < LENGTHOF(c_Lengths); ++lIdx)
+                        {
+                            // Generate the sequence in two pieces, split at the supplied length
+                            f32 dst[1027];
+                            u64 const length = c_Lengths[lIdx];
+                            kernels::RandomUniform(key, stream, firstIndices[iIdx], -2.0f, 3.0f, dst, length);
+                            kernels::RandomUniform(key, stream, firstIndices[iIdx] + length, -2.0f, 3.0f, dst + length, LENGTHOF(dst) - length);
+
+                            for (u64 eIdx = 0; eIdx < LENGTHOF(dst); ++eIdx)
+                            {
+                                Assert::AreEqual(expected[eIdx], dst[eIdx]);
+                                Assert::IsTrue((dst[eIdx] >= -2.0f) && (dst[eIdx] < 3.0f));
+                            }
+                        }
+                    });
+                }
+            }
+
+            TEST_METHOD(RandomNormal_IsTheBoxMullerTransformOfTheUniformValues)
+            {
+                u64 const key = 0x0123456789ABCDEFull;
+                u64 const stream = 3;
+
+                f32 uniforms[1028];
+                f32 normals[1028];
+                kernels::RandomUniform(key, stream, 0, 0.0f, 1.0f, uniforms, LENGTHOF(uniforms));
+
+                ForEachSimdLevel([&]()
+                {
+                    kernels::RandomNormal(key, stream, 0, 1.0f, 2.0f, normals, LENGTHOF(normals));
+
+                    for (u64 eIdx = 0; eIdx < LENGTHOF(normals); eIdx += 2)
+                    {
+                        f64 const radius = sqrt(-2.0 * log(1.0 - uniforms[eIdx]));
+                        f64 const angle = 6.28318530717958647692 * uniforms[eIdx + 1];
+                        Assert::AreEqual(1.0 + (2.0 * radius * cos(angle)), static_cast<f64>(normals[eIdx]), 1e-5 * (1.0 + radius));
+                        Assert::AreEqual(1.0 + (2.0 * radius * sin(angle)), static_cast<f64>(normals[eIdx + 1]), 1e-5 * (1.0 + radius));
+                    }
+                });
+            }
+
+            TEST_METHOD(RandomNormal_IsIdenticalAtEverySimdLevel_WhicheverRangeIsGenerated)
+            {
+                u64 const firstIndices[] = { 0, 5, (0x100000000ull - 5) * 4 };
+                u64 const key = 0x0123456789ABCDEFull;
+                u64 const stream = 3;
+
+                for (u32 iIdx = 0; iIdx < LENGTHOF(firstIndices); ++iIdx)
+                {
+                    f32 expected[1027];
+                    cpu::SetMaxSimdLevel(cpu::SimdLevel::Scalar);
+                    kernels::RandomNormal(key, stream, firstIndices[iIdx], 0.5f, 1.5f, expected, LENGTHOF(expected));
+                    cpu::SetMaxSimdLevel(cpu::SimdLevel::AVX512);
+
+                    ForEachSimdLevel([&]()
+                    {
+                        for (u32 lIdx = 0; lIdx < LENGTHOF(c_Lengths); ++lIdx)
+                        {
+                            f32 dst[1027];
+                            u64 const length = c_Lengths[lIdx];
+                            kernels::RandomNormal(key, stream, firstIndices[iIdx], 0.5f, 1.5f, dst, length);
+                            kernels::RandomNormal(key, stream, firstIndices[iIdx] + length, 0.5f, 1.5f, dst + length, LENGTHOF(dst) - length);
+
+                            for (u64 eIdx = 0; eIdx < LENGTHOF(dst); ++eIdx)
+                            {
+                                Assert::AreEqual(expected[eIdx], dst[eIdx]);
+                            }
+                        }
+                    });
+                }
+            }
+            // An activation kernel along with its exact function & the error it documents for each precision
+            struct ActivationKernel
+            {
+                void (*kernel)(f32 const * a, f32 * dst, u64 length, kernels::MathPrecision precision);
+                f64 (*function)(f64 x);
+                f64 maxUlps;
+            };
+
+            static ActivationKernel const * GetActivationKernels(u32 & numKernels)
+            {
+                static ActivationKernel const c_Kernels[] = {
+                    { kernels::Sigmoid, [](f64 x) { return 1.0 / (1.0 + exp(-x)); }, 3.0 },
+                    { kernels::Tanh, [](f64 x) { return tanh(x); }, 2.0 },
+                    { kernels::GELU, [](f64 x) { return x / (1.0 + exp(-1.5957691216057308 * (x + (0.044715 * x * x * x)))); }, 32.0 },
+                    { kernels::SiLU, [](f64 x) { return x / (1.0 + exp(-x)); }, 4.0 }
+                };
+
+                numKernels = LENGTHOF(c_Kernels);
+                return c_Kernels;
+            }
+
+            // Inputs over which the documented errors hold (GELU's only holds down to -5), including values
+            // near zero where the relative error of tanh, GELU & SiLU is hardest to keep small.
+            static u64 FillActivationInputs(f32 * inputs)
+            {
+                u64 numInputs = 0;
+                for (s32 step = -5 * 256; step <= 20 * 256; ++step)
+                {
+                    inputs[numInputs++] = static_cast<f32>(step) / 256.0f;
+                }
+                for (f32 value = 1e-30f; value < 1.0f; value *= 3.7f)
+                {
+                    inputs[numInputs++] = value;
+                    inputs[numInputs++] = -value;
+                }
+                return numInputs;
+            }
+
+            TEST_METHOD(ActivationKernels_AreWithinTheirDocumentedError)
+            {
+                static f32 inputs[8192];
+                static f32 outputs[8192];
+                u64 const numInputs = FillActivationInputs(inputs);
+
+                u32 numKernels = 0;
+                ActivationKernel const * activationKernels = GetActivationKernels(numKernels);
+
+                ForEachSimdLevel([&]()
+                {
+                    for (u32 kIdx = 0; kIdx < numKernels; ++kIdx)
+                    {
+                        activationKernels[kIdx].kernel(inputs, outputs, numInputs, kernels::MathPrecision::Accurate);
+                        for (u64 eIdx = 0; eIdx < numInputs; ++eIdx)
+                        {
+                            // The distance between the expected value & the next float of greater magnitude
+                            f32 const expected = static_cast<f32>(activationKernels[kIdx].function(inputs[eIdx]));
+                            f64 const ulp = nextafterf(fabsf(expected), INFINITY) - fabsf(expected);
+                            f64 const error = fabs(outputs[eIdx] - activationKernels[kIdx].function(inputs[eIdx]));
+                            Assert::IsTrue(error <= activationKernels[kIdx].maxUlps * ulp);
+                        }
+
+                        activationKernels[kIdx].kernel(inputs, outputs, numInputs, kernels::MathPrecision::Fast);
+                        for (u64 eIdx = 0; eIdx < numInputs; ++eIdx)
+                        {
+                            f64 const expected = activationKernels[kIdx].function(inputs[eIdx]);
+                            Assert::IsTrue(fabs(outputs[eIdx] - expected) <= 4e-4 * fabs(expected));
+                        }
+                    }
+                });
+            }
+
+            TEST_METHOD(ActivationKernels_AreIdenticalAtEverySimdLevel_WhenAccurate)
+            {
+                u32 numKernels = 0;
+                ActivationKernel const * activationKernels = GetActivationKernels(numKernels);
+
+                for (u32 kIdx = 0; kIdx < numKernels; ++kIdx)
+                {
+                    f32 a[1027];
+                    f32 expected[1027];
+                    Fill(a, LENGTHOF(a), 17);
+
+                    cpu::SetMaxSimdLevel(cpu::SimdLevel::Scalar);
+                    activationKernels[kIdx].kernel(a, expected, LENGTHOF(a), kernels::MathPrecision::Accurate);
+                    cpu::SetMaxSimdLevel(cpu::SimdLevel::AVX512);
+
+                    ForEachSimdLevel([&]()
+                    {
+                        for (u32 lIdx = 0; lIdx < LENGTHOF(c_Lengths); ++lIdx)
+                        {
+                            f32 dst[1027];
+                            activationKernels[kIdx].kernel(a, dst, c_Lengths[lIdx], kernels::MathPrecision::Accurate);
+                            for (u64 eIdx = 0; eIdx < c_Lengths[lIdx]; ++eIdx)
+                            {
+                                Assert::AreEqual(expected[eIdx], dst[eIdx]);
+                            }
+                        }
+                    });
+                }
+            }
+        };
+
+        u64 constexpr KernelsTests::c_Lengths[];
+        cpu::SimdLevel constexpr KernelsTests::c_Levels[];
+    }
+}
@@ -122,6 +122,22 @@ namespace mia
                     }
                 }
             }
+
+            TEST_METHOD(Compile_DrawsWeightsAndBiasesFromDifferentStreams)
+            {
+                // A single input gives weights of the same shape as the biases
+                TestInputLayer prevLayer(1);
+                prevLayer.Compile(c_TestSeedValue, nullptr);
+
+                initializers::Initializer const initializer = initializers::Initializer::Uniform(0.0f, 1.0f);
+                layers::Dense layer(128, activators::ActivatorType::ReLU, initializer, initializer);
+                layer.Compile(c_TestSeedValue, &prevLayer);
+
+                Matrix const & weightsMatrix = layer.GetWeights();
+                Matrix const & biasesMatrix = layer.GetBiases();
+                Assert::AreEqual(weightsMatrix.GetCapacity(), biasesMatrix.GetCapacity());
+                Assert::IsFalse(kernels::AllClose(weightsMatrix.GetData(), biasesMatrix.GetData(), weightsMatrix.GetCapacity(), 0.0f));
+            }
         };
     }
 }
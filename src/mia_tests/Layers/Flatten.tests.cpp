@@ -31,43 +31,182 @@ namespace mia
                 Assert::AreEqual(static_cast<u32>(1), valuesMatrix.GetWidth());
             }
 
-            TEST_METHOD(SetInputData_PopulatesValuesMatrixCorrectly)
+            TEST_METHOD(SetInputData_FlattensASampleInRowMajorOrder)
             {
                 // Create layer
-                u32 const numDimensions = 3;
                 layers::Flatten layer({3, 3, 2});
 
                 Assert::AreEqual(static_cast<u32>(0), layer.GetNumNeurons());
 
                 layer.Compile(c_TestSeedValue, nullptr);
 
-                // Create input data
-                f32 xData[] = { 2.0f, 3.0f, 4.0f };
-                f32 yData[] = { 3.0f, 4.0f, 5.0f };
-                f32 zData[] = { 5.0f, 6.0f };
-                
-                NDArrayViewElement<f32> viewElements[] = {
-                    { 3, xData },
-                    { 3, yData },
-                    { 2, zData }
-                };
+                // Create input data for a single sample (the leading sample dimension is omitted)
+                f32 inputData[3 * 3 * 2];
+                for (u32 eIdx = 0; eIdx < LENGTHOF(inputData); ++eIdx)
+                {
+                    inputData[eIdx] = static_cast<f32>(eIdx) * 0.5f;
+                }
+
+                // Populate layer with input data
+                layer.SetInputData(Tensor::Borrow(inputData, { 3, 3, 2 }));
+
+                // Check the values hold the sample in row-major order
+                Tensor const values = layer.GetValuesView();
+                Assert::AreEqual(static_cast<u32>(1), layer.GetBatchSize());
+                Assert::AreEqual(layer.GetNumNeurons(), values.GetLength(0));
+                Assert::AreEqual(static_cast<u32>(1), values.GetLength(1));
+
+                for (u64 eIdx = 0; eIdx < LENGTHOF(inputData); ++eIdx)
+                {
+                    Assert::AreEqual(inputData[eIdx], values.GetElement({ eIdx, 0 }));
+                }
+            }
+
+            TEST_METHOD(SetInputData_PopulatesOneColumnPerSample)
+            {
+                // Create layer
+                u32 const numSamples = 3;
+                layers::Flatten layer({2, 2});
+
+                layer.Compile(c_TestSeedValue, nullptr);
+
+                // Create input data for three samples
+                f32 inputData[] = {
+                    1.0f, 2.0f,
+                    3.0f, 4.0f,
+
+                    5.0f, 6.0f,
+                    7.0f, 8.0f,
 
-                NDArrayView<f32> arrayView(numDimensions, viewElements);
+                    9.0f, 10.0f,
+                    11.0f, 12.0f
+                };
 
                 // Populate layer with input data
-                layer.SetInputData(arrayView);
+                layer.SetInputData(Tensor::Borrow(inputData, { numSamples, 2, 2 }));
 
-                // Check values matrix is populated correctly
-                Matrix const & valuesMatrix = layer.GetValues();
-                u32 matrixOffset = 0;
-                for (u32 dIdx = 0; dIdx < numDimensions; ++dIdx)
+                // Check every sample has been flattened into its own column
+                Tensor const values = layer.GetValuesView();
+                Assert::AreEqual(numSamples, values.GetLength(1));
+                Assert::AreEqual(numSamples, layer.GetBatchSize());
+                Assert::AreEqual(static_cast<u32>(4), layer.GetNumNeurons());
+
+                for (u64 sIdx = 0; sIdx < numSamples; ++sIdx)
                 {
-                    NDArrayViewElement<f32> viewElement = viewElements[dIdx];
+                    for (u64 nIdx = 0; nIdx < 4; ++nIdx)
+                    {
+                        Assert::AreEqual(inputData[(sIdx * 4) + nIdx], values.GetElement({ nIdx, sIdx }));
+                    }
+                }
+            }
+
+            TEST_METHOD(SetInputData_ViewsContiguousInputDataInPlace)
+            {
+                layers::Flatten layer({4, 8});
+                layer.Compile(c_TestSeedValue, nullptr);
+
+                f32 inputData[16 * 4 * 8] = {};
+                layer.SetInputData(Tensor::Borrow(inputData, { 16, 4, 8 }));
+
+                // The values are read straight from the caller's data
+                Assert::IsTrue(layer.IsViewingInputData());
+                Tensor const values = layer.GetValuesView();
+                Assert::IsTrue(inputData == values.GetData());
+                Assert::AreEqual(static_cast<u32>(16), layer.GetBatchSize());
+
+                inputData[(5 * 32) + 17] = 3.0f;
+                Assert::AreEqual(3.0f, values.GetElement({ 17, 5 }));
+            }
 
-                    for (u32 eIdx = 0; eIdx < viewElement.length; ++eIdx)
+            TEST_METHOD(SetInputData_ViewsSlicesOfALargerBatchInPlace)
+            {
+                u32 const numSamples = 4;
+                layers::Flatten layer({2, 2});
+                layer.Compile(c_TestSeedValue, nullptr);
+
+                // Each sample occupies 4 of every 6 elements
+                f32 inputData[numSamples * 6];
+                for (u32 eIdx = 0; eIdx < LENGTHOF(inputData); ++eIdx)
+                {
+                    inputData[eIdx] = static_cast<f32>(eIdx);
+                }
+
+                Tensor const samples = Tensor::Borrow(inputData, { numSamples, 6 }).Slice(1, 1, 5);
+                layer.SetInputData(samples.Reshape({ numSamples, 2, 2 }));
+
+                Assert::IsTrue(layer.IsViewingInputData());
+
+                Tensor const values = layer.GetValuesView();
+                Assert::IsTrue(&inputData[1] == values.GetData());
+                Assert::AreEqual(numSamples, layer.GetBatchSize());
+
+                for (u64 sIdx = 0; sIdx < numSamples; ++sIdx)
+                {
+                    for (u64 nIdx = 0; nIdx < 4; ++nIdx)
+                    {
+                        Assert::AreEqual(samples.GetElement({ sIdx, nIdx }), values.GetElement({ nIdx, sIdx }));
+                    }
+                }
+            }
+
+            TEST_METHOD(SetInputData_ViewsFeatureMajorInputDataInPlace)
+            {
+                u32 const numSamples = 3;
+                layers::Flatten layer({4});
+                layer.Compile(c_TestSeedValue, nullptr);
+
+                // Stored one feature after another, i.e. already one column per sample
+                f32 inputData[4 * numSamples];
+                for (u32 eIdx = 0; eIdx < LENGTHOF(inputData); ++eIdx)
+                {
+                    inputData[eIdx] = static_cast<f32>(eIdx);
+                }
+
+                layer.SetInputData(Tensor::Borrow(inputData, { 4, numSamples }).Transpose(0, 1));
+
+                Assert::IsTrue(layer.IsViewingInputData());
+
+                Tensor const values = layer.GetValuesView();
+                for (u64 nIdx = 0; nIdx < 4; ++nIdx)
+                {
+                    for (u64 sIdx = 0; sIdx < numSamples; ++sIdx)
+                    {
+                        Assert::AreEqual(inputData[(nIdx * numSamples) + sIdx], values.GetElement({ nIdx, sIdx }));
+                    }
+                }
+            }
+
+            TEST_METHOD(SetInputData_CopiesNonContiguousSamples)
+            {
+                u32 const numSamples = 4;
+                layers::Flatten layer({2, 2});
+                layer.Compile(c_TestSeedValue, nullptr);
+
+                // Each row of each sample occupies 2 of every 3 elements, so a sample can't be flattened in place
+                f32 inputData[numSamples * 2 * 3];
+                for (u32 eIdx = 0; eIdx < LENGTHOF(inputData); ++eIdx)
+                {
+                    inputData[eIdx] = static_cast<f32>(eIdx);
+                }
+
+                Tensor const samples = Tensor::Borrow(inputData, { numSamples, 2, 3 }).Slice(2, 0, 2);
+                layer.SetInputData(samples);
+
+                Assert::IsFalse(layer.IsViewingInputData());
+
+                Tensor const values = layer.GetValuesView();
+                Assert::IsTrue(layer.GetValues().GetData() == values.GetData());
+                Assert::AreEqual(numSamples, layer.GetValues().GetWidth());
+                Assert::AreEqual(numSamples, layer.GetBatchSize());
+
+                for (u64 sIdx = 0; sIdx < numSamples; ++sIdx)
+                {
+                    for (u64 rIdx = 0; rIdx < 2; ++rIdx)
                     {
-                        Assert::AreEqual(valuesMatrix.GetElement(matrixOffset, 0), viewElement.data[eIdx]);
-                        matrixOffset++;
+                        for (u64 cIdx = 0; cIdx < 2; ++cIdx)
+                        {
+                            Assert::AreEqual(samples.GetElement({ sIdx, rIdx, cIdx }), layer.GetValues().GetElement((rIdx * 2) + cIdx, sIdx));
+                        }
                     }
                 }
             }
@@ -0,0 +1,117 @@
+#include <CppUnitTest.h>
+
+#include <Layers/Gradients.h>
+
+#include "Helpers/LayerManipulator.h"
+
+#include <math.h>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace mia
+{
+    namespace tests
+    {
+        namespace
+        {
+            class TestGradientsLayer : public layers::Layer
+            {
+            public:
+                TestGradientsLayer()
+                    : Layer(activators::ActivatorType::None)
+                {
+                }
+
+                virtual void Compile(u32 seedValue, layers::Layer const * prevLayer) {}
+            };
+        }
+
+        TEST_CLASS(GradientsTests)
+        {
+            static f32 constexpr c_Precision = 1e-3f;
+
+            // Sets up layer with a single neuron of two weights reading prevLayer's values, then computes its
+            // gradients towards expectedOutput.
+            static void ComputeGradients(layers::Layer & layer, layers::Layer & prevLayer, f32 expectedOutput)
+            {
+                f32 weights[] = {
+                    1.0f, 0.5f
+                };
+                LayerManipulator::GetWeightsMatrix(layer) = Matrix(2, 1, weights);
+                LayerManipulator::GetBiasesMatrix(layer) = Matrix(1, 1);
+                LayerManipulator::GetValuesMatrix(layer) = Matrix(1, 1);
+
+                layer.SetIsTraining(true);
+                layer.Execute(&prevLayer);
+                layer.ComputeLossGradient(&expectedOutput);
+                layer.Backpropagate(&prevLayer);
+            }
+
+        public:
+            TEST_METHOD(ReduceGradients_SumsTheScaledGradientsOfEveryLayer_OverTheSuppliedRange)
+            {
+                TestGradientsLayer prevLayer;
+                TestGradientsLayer replicas[2];
+
+                f32 values[] = {
+                    1.0f,
+                    2.0f
+                };
+                LayerManipulator::GetValuesMatrix(prevLayer) = Matrix(1, 2, values);
+
+                // Both layers are alike but for the output they're trained towards, so their gradients differ
+                f32 const expectedOutputs[] = { 1.0f, -2.0f };
+                Matrix weightGradients[2];
+                Matrix biasGradients[2];
+                for (u32 lIdx = 0; lIdx < 2; ++lIdx)
+                {
+                    ComputeGradients(replicas[lIdx], prevLayer, expectedOutputs[lIdx]);
+                    weightGradients[lIdx] = replicas[lIdx].GetWeightGradients();
+                    biasGradients[lIdx] = replicas[lIdx].GetBiasGradients();
+                }
+
+                // The range is split between two calls, the second spanning the weights & the biases
+                Assert::AreEqual(static_cast<u64>(3), replicas[0].GetNumParameters());
+                layers::Layer const * reducedLayers[] = { &replicas[0], &replicas[1] };
+                f32 const scales[] = { 0.25f, 0.75f };
+                layers::ReduceGradients(replicas[0], 2, reducedLayers, scales, 0, 1);
+                layers::ReduceGradients(replicas[0], 2, reducedLayers, scales, 1, 3);
+
+                for (u32 eIdx = 0; eIdx < 2; ++eIdx)
+                {
+                    f32 const expected = (0.25f * weightGradients[0].GetData()[eIdx]) + (0.75f * weightGradients[1].GetData()[eIdx]);
+                    Assert::IsTrue(fabsf(replicas[0].GetWeightGradients().GetData()[eIdx] - expected) < c_Precision);
+                }
+
+                f32 const expectedBiasGradient = (0.25f * biasGradients[0].GetData()[0]) + (0.75f * biasGradients[1].GetData()[0]);
+                Assert::IsTrue(fabsf(replicas[0].GetBiasGradients().GetData()[0] - expectedBiasGradient) < c_Precision);
+
+                // The other layer's gradients are left untouched
+                Assert::AreEqual(weightGradients[1].GetData()[0], replicas[1].GetWeightGradients().GetData()[0]);
+            }
+
+            TEST_METHOD(SetGradients_ReplacesTheGradientsOfTheLayer)
+            {
+                TestGradientsLayer prevLayer;
+                TestGradientsLayer layer;
+
+                f32 values[] = {
+                    1.0f,
+                    2.0f
+                };
+                LayerManipulator::GetValuesMatrix(prevLayer) = Matrix(1, 2, values);
+                ComputeGradients(layer, prevLayer, 1.0f);
+
+                f32 const weightGradients[] = { 4.0f, -1.0f };
+                f32 const biasGradients[] = { 2.0f };
+                layers::SetGradients(layer, weightGradients, biasGradients);
+
+                // 1 - (0.5 * 4), 0.5 - (0.5 * -1) & 0 - (0.5 * 2)
+                layer.ApplyGradients(optimizers::Optimizer::SGD(0.5f), 1);
+                Assert::IsTrue(fabsf(layer.GetWeights().GetElement(0, 0) - -1.0f) < c_Precision);
+                Assert::IsTrue(fabsf(layer.GetWeights().GetElement(0, 1) - 1.0f) < c_Precision);
+                Assert::IsTrue(fabsf(layer.GetBiases().GetElement(0, 0) - -1.0f) < c_Precision);
+            }
+        };
+    }
+}
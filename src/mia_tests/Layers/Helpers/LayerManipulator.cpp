@@ -18,5 +18,15 @@ namespace mia
         {
             return layer.m_Values;
         }
+
+        Matrix & LayerManipulator::GetValuesPriorActivatorMatrix(layers::Layer & layer)
+        {
+            return layer.m_ValuesPriorActivator;
+        }
+
+        Matrix & LayerManipulator::GetGradientsMatrix(layers::Layer & layer)
+        {
+            return layer.m_Gradients;
+        }
     }
 }
@@ -12,6 +12,8 @@ namespace mia
             static Matrix & GetWeightsMatrix(layers::Layer & layer);
             static Matrix & GetBiasesMatrix(layers::Layer & layer);
             static Matrix & GetValuesMatrix(layers::Layer & layer);
+            static Matrix & GetValuesPriorActivatorMatrix(layers::Layer & layer);
+            static Matrix & GetGradientsMatrix(layers::Layer & layer);
         };
     }
 }
@@ -15,13 +15,12 @@ namespace mia
             m_Values = Matrix(1, m_NumNeurons);
         }
 
-        void TestInputLayer::SetInputData(NDArrayView<f32> const & inputData)
+        void TestInputLayer::SetInputData(Tensor const & inputData)
         {
             ASSERTMSG(1 == inputData.GetNumDimensions(), "TestInputLayer expects a 1D input array.");
-            ASSERTMSG(m_NumNeurons == inputData.GetDimension(0).length, "TestInputLayer's number of neurons differs to the supplied data.");
+            ASSERTMSG(m_NumNeurons == inputData.GetLength(0), "TestInputLayer's number of neurons differs to the supplied data.");
 
-            f32 const * src = inputData.GetDimension(0).data;
-            m_Values.Copy(0, 0, src, m_NumNeurons);
+            SetSamples(inputData.Reshape({ 1, m_NumNeurons }));
         }
     }
 }
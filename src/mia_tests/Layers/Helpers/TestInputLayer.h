@@ -14,7 +14,7 @@ namespace mia
             virtual ~TestInputLayer() = default;
 
             virtual void Compile(u32 seedValue, Layer const * prevLayer) override;
-            virtual void SetInputData(NDArrayView<f32> const & inputData) override;
+            virtual void SetInputData(Tensor const & inputData) override;
 
         private:
             u32 m_NumNeurons;
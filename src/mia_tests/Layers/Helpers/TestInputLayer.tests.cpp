@@ -24,7 +24,7 @@ namespace mia
                 Assert::AreEqual(static_cast<u32>(1), valuesMatrix.GetWidth());
             }
 
-            TEST_METHOD(SetInputData_CorrectlyPopulatesTheValuesMatrix)
+            TEST_METHOD(SetInputData_CorrectlyPopulatesTheValues)
             {
                 u32 const numNeurons = 5;
                 TestInputLayer layer(numNeurons);
@@ -32,12 +32,14 @@ namespace mia
                 f32 inputData[] = { 5.0f, 4.0f, 3.0f, 2.0f, 1.0f };
 
                 layer.Compile(0, nullptr);
-                layer.SetInputData({{ numNeurons, inputData }});
+                layer.SetInputData(Tensor::Borrow(inputData, { numNeurons }));
 
-                Matrix const & valuesMatrix = layer.GetValues();
-                for (u32 rIdx = 0; rIdx < valuesMatrix.GetHeight(); ++rIdx)
+                Tensor const values = layer.GetValuesView();
+                Assert::AreEqual(numNeurons, values.GetLength(0));
+                Assert::AreEqual(static_cast<u32>(1), values.GetLength(1));
+                for (u64 rIdx = 0; rIdx < numNeurons; ++rIdx)
                 {
-                    Assert::AreEqual(inputData[rIdx], valuesMatrix.GetElement(rIdx, 0));
+                    Assert::AreEqual(inputData[rIdx], values.GetElement({ rIdx, 0 }));
                 }
             }
         };
@@ -2,6 +2,8 @@
 
 #include "Helpers/LayerManipulator.h"
 
+#include <math.h>
+
 using namespace Microsoft::VisualStudio::CppUnitTestFramework;
 
 namespace mia
@@ -34,6 +36,29 @@ namespace mia
         {
             static f32 constexpr c_Precision = 1e-3f;
 
+            // Executes the layer on prevLayer while training & returns the loss against expectedOutput.
+            static f32 ComputeLoss(layers::Layer & layer, layers::Layer & prevLayer, f32 const * expectedOutput)
+            {
+                layer.SetIsTraining(true);
+                layer.Execute(&prevLayer);
+                return layer.ComputeLossGradient(expectedOutput);
+            }
+
+            // Returns the derivative of the loss with respect to value, estimated with central differences.
+            static f32 EstimateGradient(layers::Layer & layer, layers::Layer & prevLayer, f32 const * expectedOutput, f32 & value)
+            {
+                f32 const step = 1e-2f;
+                f32 const originalValue = value;
+
+                value = originalValue + step;
+                f32 const lossAbove = ComputeLoss(layer, prevLayer, expectedOutput);
+                value = originalValue - step;
+                f32 const lossBelow = ComputeLoss(layer, prevLayer, expectedOutput);
+                value = originalValue;
+
+                return (lossAbove - lossBelow) / (2.0f * step);
+            }
+
         public:
             TEST_METHOD(BaseExecute_CalculatesTheCorrectSummationOfDotProducts_ForEachNeuron)
             {
@@ -81,7 +106,7 @@ namespace mia
                 Matrix const & calculatedValues = layer.GetValues();
                 for (u64 rIdx = 0; rIdx < calculatedValues.GetHeight(); ++rIdx)
                 {
-                    Assert::IsTrue(abs(calculatedValues.GetElement(rIdx, 0) - expectedValues[rIdx]) < c_Precision);
+                    Assert::IsTrue(fabsf(calculatedValues.GetElement(rIdx, 0) - expectedValues[rIdx]) < c_Precision);
                 }
             }
 
@@ -131,7 +156,7 @@ namespace mia
                 Matrix const & calculatedValues = layer.GetValues();
                 for (u64 rIdx = 0; rIdx < calculatedValues.GetHeight(); ++rIdx)
                 {
-                    Assert::IsTrue(abs(calculatedValues.GetElement(rIdx, 0) - expectedValues[rIdx]) < c_Precision);
+                    Assert::IsTrue(fabsf(calculatedValues.GetElement(rIdx, 0) - expectedValues[rIdx]) < c_Precision);
                 }
             }
 
@@ -181,8 +206,352 @@ namespace mia
                 Matrix const & calculatedValues = layer.GetValues();
                 for (u64 rIdx = 0; rIdx < calculatedValues.GetHeight(); ++rIdx)
                 {
-                    Assert::IsTrue(abs(calculatedValues.GetElement(rIdx, 0) - expectedValues[rIdx]) < c_Precision);
+                    Assert::IsTrue(fabsf(calculatedValues.GetElement(rIdx, 0) - expectedValues[rIdx]) < c_Precision);
+                }
+            }
+
+            TEST_METHOD(BaseExecute_CalculatesTheCorrectValues_ForEverySampleInABatch)
+            {
+                TestNoActivatorLayer prevLayer;
+                TestReLUActivatorLayer layer;
+
+                // Initialise the previous layer's neuron values matrix with two samples (one per column)
+                Matrix & prevLayerValues = LayerManipulator::GetValuesMatrix(prevLayer);
+                f32 values[] = {
+                    5.0f, 1.0f,
+                    6.0f, 2.0f,
+                    7.0f, 3.0f
+                };
+                prevLayerValues = Matrix(2, 3, values);
+
+                // Initialise the layer's neuron weights matrix.
+                Matrix & layerWeights = LayerManipulator::GetWeightsMatrix(layer);
+                f32 weights[] = {
+                    -1.5f, -0.5f, -2.0f,
+                    2.5f, 1.0f, 3.0f
+                };
+                layerWeights = Matrix(3, 2, weights);
+
+                // Initialise the layer's neuron biases matrix.
+                Matrix & layerBiases = LayerManipulator::GetBiasesMatrix(layer);
+                f32 biases[] = {
+                    20.0f,
+                    10.0f
+                };
+                layerBiases = Matrix(1, 2, biases);
+
+                // Initialise the layer's neuron values matrix for a single sample, executing
+                // the layer has to resize it to match the batch.
+                Matrix & layerValues = LayerManipulator::GetValuesMatrix(layer);
+                layerValues = Matrix(1, 2);
+
+                // Execute the layer
+                layer.Execute(&prevLayer);
+
+                // Check the resulting values are as expected
+                f32 const expectedValues[] = {
+                    0.0f, 11.5f,  /* ReLU[(-1.5 * 5.0) + (-0.5 * 6.0) + (-2.0 * 7.0) + 20.0f], ReLU[(-1.5 * 1.0) + (-0.5 * 2.0) + (-2.0 * 3.0) + 20.0f] */
+                    49.5f, 23.5f  /* ReLU[(2.5 * 5.0) + (1.0 * 6.0) + (3.0 * 7.0) + 10.0f], ReLU[(2.5 * 1.0) + (1.0 * 2.0) + (3.0 * 3.0) + 10.0f] */
+                };
+
+                Matrix const & calculatedValues = layer.GetValues();
+                Assert::AreEqual(static_cast<u32>(2), calculatedValues.GetWidth());
+                Assert::AreEqual(static_cast<u32>(2), calculatedValues.GetHeight());
+                Assert::AreEqual(static_cast<u32>(2), layer.GetBatchSize());
+
+                for (u64 rIdx = 0; rIdx < calculatedValues.GetHeight(); ++rIdx)
+                {
+                    for (u64 cIdx = 0; cIdx < calculatedValues.GetWidth(); ++cIdx)
+                    {
+                        Assert::IsTrue(fabsf(calculatedValues.GetElement(rIdx, cIdx) - expectedValues[(rIdx * 2) + cIdx]) < c_Precision);
+                    }
+                }
+            }
+
+            TEST_METHOD(BaseExecute_CalculatesTheCorrectValues_FromPackedWeights_OnceUnpackedWeightsAreReleased)
+            {
+                TestNoActivatorLayer prevLayer;
+                TestReLUActivatorLayer layer;
+
+                f32 values[] = {
+                    5.0f, 1.0f,
+                    6.0f, 2.0f,
+                    7.0f, 3.0f
+                };
+                LayerManipulator::GetValuesMatrix(prevLayer) = Matrix(2, 3, values);
+
+                f32 weights[] = {
+                    -1.5f, -0.5f, -2.0f,
+                    2.5f, 1.0f, 3.0f
+                };
+                LayerManipulator::GetWeightsMatrix(layer) = Matrix(3, 2, weights);
+
+                f32 biases[] = {
+                    20.0f,
+                    10.0f
+                };
+                LayerManipulator::GetBiasesMatrix(layer) = Matrix(1, 2, biases);
+                LayerManipulator::GetValuesMatrix(layer) = Matrix(1, 2);
+
+                // Pack the weights & drop the row-major copy, Execute has to use the packed copy
+                layer.PackWeights();
+                layer.ReleaseUnpackedWeights();
+                Assert::AreEqual(static_cast<u64>(0), layer.GetWeights().GetCapacity());
+
+                layer.Execute(&prevLayer);
+
+                f32 const expectedValues[] = {
+                    0.0f, 11.5f,
+                    49.5f, 23.5f
+                };
+
+                Matrix const & calculatedValues = layer.GetValues();
+                Assert::AreEqual(static_cast<u32>(2), calculatedValues.GetWidth());
+                Assert::AreEqual(static_cast<u32>(2), calculatedValues.GetHeight());
+
+                for (u64 rIdx = 0; rIdx < calculatedValues.GetHeight(); ++rIdx)
+                {
+                    for (u64 cIdx = 0; cIdx < calculatedValues.GetWidth(); ++cIdx)
+                    {
+                        Assert::IsTrue(fabsf(calculatedValues.GetElement(rIdx, cIdx) - expectedValues[(rIdx * 2) + cIdx]) < c_Precision);
+                    }
+                }
+            }
+
+            TEST_METHOD(BaseExecute_StoresValuesPriorActivator_OnlyWhenTraining)
+            {
+                TestNoActivatorLayer prevLayer;
+                TestReLUActivatorLayer layer;
+
+                // Initialise the previous layer's neuron values matrix
+                Matrix & prevLayerValues = LayerManipulator::GetValuesMatrix(prevLayer);
+                f32 values[] = {
+                    5.0f,
+                    6.0f,
+                    7.0f
+                };
+                prevLayerValues = Matrix(1, 3, values);
+
+                // Initialise the layer's neuron weights & biases matrices.
+                f32 weights[] = {
+                    -1.5f, -0.5f, -2.0f,
+                    2.5f, 1.0f, 3.0f
+                };
+                LayerManipulator::GetWeightsMatrix(layer) = Matrix(3, 2, weights);
+
+                f32 biases[] = {
+                    1.0f,
+                    2.0f
+                };
+                LayerManipulator::GetBiasesMatrix(layer) = Matrix(1, 2, biases);
+                LayerManipulator::GetValuesMatrix(layer) = Matrix(1, 2);
+
+                // Inference doesn't need the values prior to the activator
+                layer.Execute(&prevLayer);
+                Assert::AreEqual(static_cast<u64>(0), LayerManipulator::GetValuesPriorActivatorMatrix(layer).GetCapacity());
+
+                // Training does
+                layer.SetIsTraining(true);
+                layer.Execute(&prevLayer);
+
+                f32 const expectedValuesPriorActivator[] = {
+                    -23.5f, /* (-1.5 * 5.0) + (-0.5 * 6.0) + (-2.0 * 7.0) + 1.0f */
+                    41.5f   /* (2.5 * 5.0) + (1.0 * 6.0) + (3.0 * 7.0) + 2.0f */
+                };
+
+                Matrix const & valuesPriorActivator = LayerManipulator::GetValuesPriorActivatorMatrix(layer);
+                Assert::AreEqual(static_cast<u32>(1), valuesPriorActivator.GetWidth());
+                Assert::AreEqual(static_cast<u32>(2), valuesPriorActivator.GetHeight());
+
+                for (u64 rIdx = 0; rIdx < valuesPriorActivator.GetHeight(); ++rIdx)
+                {
+                    Assert::IsTrue(fabsf(valuesPriorActivator.GetElement(rIdx, 0) - expectedValuesPriorActivator[rIdx]) < c_Precision);
+                }
+
+                Assert::IsTrue(fabsf(layer.GetValues().GetElement(0, 0) - 0.0f) < c_Precision);
+                Assert::IsTrue(fabsf(layer.GetValues().GetElement(1, 0) - 41.5f) < c_Precision);
+            }
+
+            TEST_METHOD(ComputeLossGradient_ReturnsMeanSquaredError_AndItsGradient)
+            {
+                TestNoActivatorLayer layer;
+
+                // Two neurons, two samples (one per column)
+                f32 values[] = {
+                    1.0f, 2.0f,
+                    3.0f, 4.0f
+                };
+                LayerManipulator::GetValuesMatrix(layer) = Matrix(2, 2, values);
+
+                // One sample after another
+                f32 const expectedOutput[] = {
+                    0.0f, 3.0f, /* sample 0 */
+                    4.0f, 2.0f  /* sample 1 */
+                };
+
+                f32 const loss = layer.ComputeLossGradient(expectedOutput);
+                Assert::IsTrue(fabsf(loss - 2.25f) < c_Precision); /* (1 + 0 + 4 + 4) / 4 */
+
+                f32 const expectedGradients[] = {
+                    0.5f, -1.0f,    /* 2 * (1 - 0) / 4, 2 * (2 - 4) / 4 */
+                    0.0f, 1.0f      /* 2 * (3 - 3) / 4, 2 * (4 - 2) / 4 */
+                };
+
+                Matrix const & gradients = LayerManipulator::GetGradientsMatrix(layer);
+                for (u32 rIdx = 0; rIdx < 2; ++rIdx)
+                {
+                    for (u32 cIdx = 0; cIdx < 2; ++cIdx)
+                    {
+                        Assert::IsTrue(fabsf(gradients.GetElement(rIdx, cIdx) - expectedGradients[(rIdx * 2) + cIdx]) < c_Precision);
+                    }
+                }
+            }
+
+            TEST_METHOD(Backpropagate_ComputesTheGradientOfEveryParameter_AndOfThePreviousLayer)
+            {
+                TestNoActivatorLayer prevLayer;
+                TestReLUActivatorLayer layer;
+
+                // Three neurons, two samples (one per column)
+                f32 values[] = {
+                    0.5f, -1.0f,
+                    1.5f, 0.25f,
+                    -0.5f, 2.0f
+                };
+                Matrix & prevLayerValues = LayerManipulator::GetValuesMatrix(prevLayer);
+                prevLayerValues = Matrix(2, 3, values);
+
+                f32 weights[] = {
+                    0.5f, -0.25f, 1.0f,
+                    -1.0f, 0.75f, 0.5f
+                };
+                Matrix & layerWeights = LayerManipulator::GetWeightsMatrix(layer);
+                layerWeights = Matrix(3, 2, weights);
+
+                f32 biases[] = {
+                    1.0f,
+                    0.5f
+                };
+                Matrix & layerBiases = LayerManipulator::GetBiasesMatrix(layer);
+                layerBiases = Matrix(1, 2, biases);
+                LayerManipulator::GetValuesMatrix(layer) = Matrix(2, 2);
+
+                f32 const expectedOutput[] = {
+                    0.25f, 1.0f,
+                    2.0f, -0.5f
+                };
+
+                ComputeLoss(layer, prevLayer, expectedOutput);
+                layer.Backpropagate(&prevLayer);
+
+                // Take copies as estimating the gradients below overwrites the layer's buffers
+                Matrix const weightGradients = layer.GetWeightGradients();
+                Matrix const biasGradients = layer.GetBiasGradients();
+                Matrix const prevLayerGradients = LayerManipulator::GetGradientsMatrix(prevLayer);
+
+                Assert::AreEqual(layerWeights.GetWidth(), weightGradients.GetWidth());
+                Assert::AreEqual(layerWeights.GetHeight(), weightGradients.GetHeight());
+                Assert::AreEqual(layerBiases.GetHeight(), biasGradients.GetHeight());
+                Assert::AreEqual(prevLayerValues.GetWidth(), prevLayerGradients.GetWidth());
+                Assert::AreEqual(prevLayerValues.GetHeight(), prevLayerGradients.GetHeight());
+
+                for (u32 eIdx = 0; eIdx < layerWeights.GetCapacity(); ++eIdx)
+                {
+                    f32 const estimate = EstimateGradient(layer, prevLayer, expectedOutput, layerWeights.GetData()[eIdx]);
+                    Assert::IsTrue(fabsf(weightGradients.GetData()[eIdx] - estimate) < c_Precision);
+                }
+
+                for (u32 eIdx = 0; eIdx < layerBiases.GetCapacity(); ++eIdx)
+                {
+                    f32 const estimate = EstimateGradient(layer, prevLayer, expectedOutput, layerBiases.GetData()[eIdx]);
+                    Assert::IsTrue(fabsf(biasGradients.GetData()[eIdx] - estimate) < c_Precision);
                 }
+
+                for (u32 eIdx = 0; eIdx < prevLayerValues.GetCapacity(); ++eIdx)
+                {
+                    f32 const estimate = EstimateGradient(layer, prevLayer, expectedOutput, prevLayerValues.GetData()[eIdx]);
+                    Assert::IsTrue(fabsf(prevLayerGradients.GetData()[eIdx] - estimate) < c_Precision);
+                }
+            }
+
+            TEST_METHOD(ApplyGradients_StepsEveryParameterAgainstItsGradient)
+            {
+                TestNoActivatorLayer prevLayer;
+                TestNoActivatorLayer layer;
+
+                f32 values[] = {
+                    1.0f,
+                    2.0f
+                };
+                LayerManipulator::GetValuesMatrix(prevLayer) = Matrix(1, 2, values);
+
+                f32 weights[] = {
+                    1.0f, 1.0f
+                };
+                LayerManipulator::GetWeightsMatrix(layer) = Matrix(2, 1, weights);
+
+                f32 biases[] = {
+                    0.0f
+                };
+                LayerManipulator::GetBiasesMatrix(layer) = Matrix(1, 1, biases);
+                LayerManipulator::GetValuesMatrix(layer) = Matrix(1, 1);
+
+                // value = 3, expected = 1 => dLoss/dValue = 2 * (3 - 1) = 4
+                f32 const expectedOutput[] = { 1.0f };
+                ComputeLoss(layer, prevLayer, expectedOutput);
+                layer.Backpropagate(&prevLayer);
+                layer.ApplyGradients(optimizers::Optimizer::SGD(0.1f), 1);
+
+                Matrix const & updatedWeights = layer.GetWeights();
+                Assert::IsTrue(fabsf(updatedWeights.GetElement(0, 0) - 0.6f) < c_Precision); /* 1 - (0.1 * 4 * 1) */
+                Assert::IsTrue(fabsf(updatedWeights.GetElement(0, 1) - 0.2f) < c_Precision); /* 1 - (0.1 * 4 * 2) */
+                Assert::IsTrue(fabsf(layer.GetBiases().GetElement(0, 0) - -0.4f) < c_Precision); /* 0 - (0.1 * 4) */
+            }
+
+            TEST_METHOD(SwapTrainingState_SwapsTheParametersWithTheSuppliedMatrices)
+            {
+                TestNoActivatorLayer prevLayer;
+                TestNoActivatorLayer layer;
+
+                f32 values[] = {
+                    1.0f,
+                    2.0f
+                };
+                LayerManipulator::GetValuesMatrix(prevLayer) = Matrix(1, 2, values);
+
+                f32 weights[] = {
+                    1.0f, 1.0f
+                };
+                LayerManipulator::GetWeightsMatrix(layer) = Matrix(2, 1, weights);
+                LayerManipulator::GetBiasesMatrix(layer) = Matrix(1, 1);
+                LayerManipulator::GetValuesMatrix(layer) = Matrix(1, 1);
+                layer.ResetOptimizerState(optimizers::OptimizerType::Momentum);
+                layer.PackWeights();
+
+                // The weights, biases & momentum are swapped, the unused state buffers are swapped for empty ones
+                f32 swappedWeights[] = {
+                    3.0f, 1.0f
+                };
+                f32 swappedBiases[] = {
+                    0.5f
+                };
+                Matrix matrices[layers::Layer::c_NumTrainingStateMatrices];
+                matrices[0] = Matrix(2, 1, swappedWeights);
+                matrices[1] = Matrix(1, 1, swappedBiases);
+                matrices[2] = Matrix(2, 1);
+                matrices[3] = Matrix(1, 1);
+                f32 const * momentum = layer.GetWeightsOptimizerState(0).GetData();
+
+                layer.SwapTrainingState(matrices);
+                layer.PackWeights();
+                Assert::AreEqual(3.0f, layer.GetWeights().GetElement(0, 0));
+                Assert::AreEqual(0.5f, layer.GetBiases().GetElement(0, 0));
+                Assert::IsTrue(momentum == matrices[2].GetData());
+                Assert::AreEqual(1.0f, matrices[0].GetElement(0, 0));
+
+                // (3 * 1) + (1 * 2) + 0.5
+                layer.Execute(&prevLayer);
+                Assert::AreEqual(5.5f, layer.GetValues().GetElement(0, 0));
             }
         };
     }
@@ -0,0 +1,356 @@
+#include <CppUnitTest.h>
+
+#include <Maths/Gemm.h>
+#include <Core/CpuFeatures.h>
+#include <Core/ThreadPool.h>
+
+#include <math.h>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace mia
+{
+    namespace tests
+    {
+        TEST_CLASS(GemmTests)
+        {
+            static f32 constexpr c_Precision = 1e-3f;
+
+            // Fills the supplied array with deterministic values in the range [-1, 1]
+            static void Fill(f32 * data, u64 length, u32 seed)
+            {
+                u32 state = seed;
+                for (u64 eIdx = 0; eIdx < length; ++eIdx)
+                {
+                    state = (state * 1103515245 + 12345) & 0x7FFFFFFF;
+                    data[eIdx] = (static_cast<f32>(state % 2001) / 1000.0f) - 1.0f;
+                }
+            }
+
+            // Computes c = a * b with a naive triple loop (all row-major)
+            static void ReferenceMultiply(f32 const * a, f32 const * b, f32 * c, u32 m, u32 n, u32 k)
+            {
+                for (u32 rIdx = 0; rIdx < m; ++rIdx)
+                {
+                    for (u32 cIdx = 0; cIdx < n; ++cIdx)
+                    {
+                        f32 sum = 0.0f;
+                        for (u32 pIdx = 0; pIdx < k; ++pIdx)
+                        {
+                            sum += a[(rIdx * k) + pIdx] * b[(pIdx * n) + cIdx];
+                        }
+                        c[(rIdx * n) + cIdx] = sum;
+                    }
+                }
+            }
+
+            static void CheckMultiply(u32 m, u32 n, u32 k)
+            {
+                f32 * a = new f32[m * k];
+                f32 * b = new f32[k * n];
+                f32 * c = new f32[m * n];
+                f32 * expected = new f32[m * n];
+
+                Fill(a, m * k, 1);
+                Fill(b, k * n, 2);
+                ReferenceMultiply(a, b, expected, m, n, k);
+
+                gemm::Multiply(gemm::MakeOperand(a, m, k), gemm::MakeOperand(b, k, n), gemm::MakeOutput(c, m, n));
+
+                for (u32 eIdx = 0; eIdx < m * n; ++eIdx)
+                {
+                    Assert::IsTrue(fabsf(expected[eIdx] - c[eIdx]) < c_Precision);
+                }
+
+                delete[] a;
+                delete[] b;
+                delete[] c;
+                delete[] expected;
+            }
+
+            // Computes c = activator((a * b) + bias) through the epilogue & checks it (& the values prior
+            // to the activator) against the reference multiplication. If packed is set, a is packed up
+            // front & multiplied through its packed copy.
+            static void CheckMultiplyWithEpilogue(u32 m, u32 n, u32 k, activators::ActivatorType activator, bool packed = false)
+            {
+                f32 * a = new f32[m * k];
+                f32 * b = new f32[k * n];
+                f32 * bias = new f32[m];
+                f32 * c = new f32[m * n];
+                f32 * preActivation = new f32[m * n];
+                f32 * expected = new f32[m * n];
+
+                Fill(a, m * k, 5);
+                Fill(b, k * n, 6);
+                Fill(bias, m, 7);
+                ReferenceMultiply(a, b, expected, m, n, k);
+
+                gemm::Epilogue epilogue;
+                epilogue.rowBias = bias;
+                epilogue.preActivation = preActivation;
+                epilogue.activator = activator;
+
+                if (packed)
+                {
+                    f32 * packedA = new f32[gemm::GetPackedSize(m, k)];
+                    gemm::PackedOperand const packedOperand = gemm::Pack(gemm::MakeOperand(a, m, k), packedA);
+                    Assert::IsTrue(gemm::IsPackedForCurrentKernel(packedOperand));
+
+                    gemm::Multiply(packedOperand, gemm::MakeOperand(b, k, n), gemm::MakeOutput(c, m, n), epilogue);
+                    delete[] packedA;
+                }
+                else
+                {
+                    gemm::Multiply(gemm::MakeOperand(a, m, k), gemm::MakeOperand(b, k, n), gemm::MakeOutput(c, m, n), epilogue);
+                }
+
+                activators::Activator const activate = activators::GetActivator(activator);
+                for (u32 rIdx = 0; rIdx < m; ++rIdx)
+                {
+                    for (u32 cIdx = 0; cIdx < n; ++cIdx)
+                    {
+                        u32 const eIdx = (rIdx * n) + cIdx;
+                        f32 const biased = expected[eIdx] + bias[rIdx];
+                        f32 const activated = (nullptr != activate) ? activate(biased) : biased;
+
+                        Assert::IsTrue(fabsf(biased - preActivation[eIdx]) < c_Precision);
+                        Assert::IsTrue(fabsf(activated - c[eIdx]) < c_Precision);
+                    }
+                }
+
+                delete[] a;
+                delete[] b;
+                delete[] bias;
+                delete[] c;
+                delete[] preActivation;
+                delete[] expected;
+            }
+
+        public:
+            TEST_METHOD(Multiply_SmallMatrices_MatchesReference)
+            {
+                CheckMultiply(3, 3, 3);
+                CheckMultiply(5, 7, 2);
+            }
+
+            TEST_METHOD(Multiply_MatrixVector_MatchesReference)
+            {
+                CheckMultiply(64, 1, 300);
+            }
+
+            TEST_METHOD(Multiply_LargeMatrices_MatchesReference)
+            {
+                CheckMultiply(128, 128, 128);
+            }
+
+            TEST_METHOD(Multiply_LargeMatrices_WithPartialTiles_MatchesReference)
+            {
+                // Dimensions are deliberately not multiples of any register tile or cache block size.
+                CheckMultiply(131, 67, 301);
+                CheckMultiply(7, 300, 523);
+            }
+
+            TEST_METHOD(Multiply_LargeMatrices_MatchesReference_ForEverySimdLevel)
+            {
+                cpu::SimdLevel const levels[] = {
+                    cpu::SimdLevel::Scalar,
+                    cpu::SimdLevel::NEON,
+                    cpu::SimdLevel::AVX2,
+                    cpu::SimdLevel::AVX512
+                };
+
+                for (u32 lIdx = 0; lIdx < LENGTHOF(levels); ++lIdx)
+                {
+                    if (levels[lIdx] > cpu::GetDetectedSimdLevel())
+                    {
+                        continue;
+                    }
+
+                    cpu::SetMaxSimdLevel(levels[lIdx]);
+                    CheckMultiply(131, 67, 301);
+                }
+
+                cpu::SetMaxSimdLevel(cpu::SimdLevel::AVX512);
+            }
+
+            TEST_METHOD(Multiply_LargeMatrices_MatchesReference_WhenMultithreaded)
+            {
+                // Thread counts chosen to give 1D & 2D splits of c, including splits with more
+                // threads than there are register tiles along a dimension.
+                u32 const threadCounts[] = { 2, 3, 4, 6, 16 };
+
+                for (u32 tIdx = 0; tIdx < LENGTHOF(threadCounts); ++tIdx)
+                {
+                    ThreadPool::Get().SetNumThreads(threadCounts[tIdx]);
+                    CheckMultiply(131, 67, 301);
+                    CheckMultiply(7, 300, 523);
+                    CheckMultiply(1000, 1, 300);
+                }
+
+                ThreadPool::Get().SetNumThreads(0);
+            }
+
+            TEST_METHOD(Multiply_WithEpilogue_MatchesReference_ForEveryActivatorAndSimdLevel)
+            {
+                cpu::SimdLevel const levels[] = {
+                    cpu::SimdLevel::Scalar,
+                    cpu::SimdLevel::NEON,
+                    cpu::SimdLevel::AVX2,
+                    cpu::SimdLevel::AVX512
+                };
+
+                activators::ActivatorType const activatorTypes[] = {
+                    activators::ActivatorType::None,
+                    activators::ActivatorType::ReLU,
+                    activators::ActivatorType::Sigmoid
+                };
+
+                for (u32 lIdx = 0; lIdx < LENGTHOF(levels); ++lIdx)
+                {
+                    if (levels[lIdx] > cpu::GetDetectedSimdLevel())
+                    {
+                        continue;
+                    }
+
+                    cpu::SetMaxSimdLevel(levels[lIdx]);
+                    for (u32 aIdx = 0; aIdx < LENGTHOF(activatorTypes); ++aIdx)
+                    {
+                        CheckMultiplyWithEpilogue(5, 7, 2, activatorTypes[aIdx]);
+                        CheckMultiplyWithEpilogue(64, 1, 300, activatorTypes[aIdx]);
+                        CheckMultiplyWithEpilogue(131, 67, 301, activatorTypes[aIdx]);
+                        CheckMultiplyWithEpilogue(48, 64, 256, activatorTypes[aIdx]);
+                    }
+                }
+
+                cpu::SetMaxSimdLevel(cpu::SimdLevel::AVX512);
+            }
+
+            TEST_METHOD(Multiply_WithEpilogue_MatchesReference_WhenMultithreaded)
+            {
+                ThreadPool::Get().SetNumThreads(4);
+                CheckMultiplyWithEpilogue(131, 67, 301, activators::ActivatorType::ReLU);
+                CheckMultiplyWithEpilogue(131, 67, 301, activators::ActivatorType::Sigmoid);
+                ThreadPool::Get().SetNumThreads(0);
+            }
+
+            TEST_METHOD(Multiply_PackedOperand_MatchesReference_ForEveryActivatorAndSimdLevel)
+            {
+                cpu::SimdLevel const levels[] = {
+                    cpu::SimdLevel::Scalar,
+                    cpu::SimdLevel::NEON,
+                    cpu::SimdLevel::AVX2,
+                    cpu::SimdLevel::AVX512
+                };
+
+                activators::ActivatorType const activatorTypes[] = {
+                    activators::ActivatorType::None,
+                    activators::ActivatorType::ReLU,
+                    activators::ActivatorType::Sigmoid
+                };
+
+                for (u32 lIdx = 0; lIdx < LENGTHOF(levels); ++lIdx)
+                {
+                    if (levels[lIdx] > cpu::GetDetectedSimdLevel())
+                    {
+                        continue;
+                    }
+
+                    cpu::SetMaxSimdLevel(levels[lIdx]);
+                    for (u32 aIdx = 0; aIdx < LENGTHOF(activatorTypes); ++aIdx)
+                    {
+                        // Includes matrix-vector products & problems spanning several kc blocks
+                        CheckMultiplyWithEpilogue(5, 7, 2, activatorTypes[aIdx], true);
+                        CheckMultiplyWithEpilogue(64, 1, 300, activatorTypes[aIdx], true);
+                        CheckMultiplyWithEpilogue(131, 67, 301, activatorTypes[aIdx], true);
+                        CheckMultiplyWithEpilogue(331, 1, 600, activatorTypes[aIdx], true);
+                    }
+                }
+
+                cpu::SetMaxSimdLevel(cpu::SimdLevel::AVX512);
+            }
+
+            TEST_METHOD(Multiply_PackedOperand_MatchesReference_WhenMultithreaded)
+            {
+                u32 const threadCounts[] = { 2, 3, 4, 16 };
+
+                for (u32 tIdx = 0; tIdx < LENGTHOF(threadCounts); ++tIdx)
+                {
+                    ThreadPool::Get().SetNumThreads(threadCounts[tIdx]);
+                    CheckMultiplyWithEpilogue(131, 67, 301, activators::ActivatorType::ReLU, true);
+                    CheckMultiplyWithEpilogue(7, 300, 523, activators::ActivatorType::None, true);
+                    CheckMultiplyWithEpilogue(1000, 1, 300, activators::ActivatorType::Sigmoid, true);
+                }
+
+                ThreadPool::Get().SetNumThreads(0);
+            }
+
+            TEST_METHOD(IsPackedForCurrentKernel_ReturnsFalse_AfterTheInstructionSetChanges)
+            {
+                if (cpu::GetDetectedSimdLevel() == cpu::SimdLevel::Scalar)
+                {
+                    return;
+                }
+
+                f32 a[6 * 5];
+                Fill(a, LENGTHOF(a), 1);
+
+                f32 * packedA = new f32[gemm::GetPackedSize(6, 5)];
+                gemm::PackedOperand const packedOperand = gemm::Pack(gemm::MakeOperand(a, 6, 5), packedA);
+
+                cpu::SetMaxSimdLevel(cpu::SimdLevel::Scalar);
+                bool const isPackedForScalar = gemm::IsPackedForCurrentKernel(packedOperand);
+                cpu::SetMaxSimdLevel(cpu::SimdLevel::AVX512);
+
+                Assert::IsFalse(isPackedForScalar);
+                Assert::IsTrue(gemm::IsPackedForCurrentKernel(packedOperand));
+
+                delete[] packedA;
+            }
+
+            TEST_METHOD(Multiply_TransposedOperand_MatchesReference)
+            {
+                u32 const m = 45;
+                u32 const n = 70;
+                u32 const k = 90;
+
+                f32 * a = new f32[m * k];
+                f32 * b = new f32[k * n];
+                f32 * bTransposed = new f32[n * k];
+                f32 * c = new f32[m * n];
+                f32 * expected = new f32[m * n];
+
+                Fill(a, m * k, 3);
+                Fill(b, k * n, 4);
+                for (u32 rIdx = 0; rIdx < k; ++rIdx)
+                {
+                    for (u32 cIdx = 0; cIdx < n; ++cIdx)
+                    {
+                        bTransposed[(cIdx * k) + rIdx] = b[(rIdx * n) + cIdx];
+                    }
+                }
+                ReferenceMultiply(a, b, expected, m, n, k);
+
+                // Describe b as a column-major view of bTransposed
+                gemm::Operand bOperand;
+                bOperand.data = bTransposed;
+                bOperand.numRows = k;
+                bOperand.numCols = n;
+                bOperand.rowStride = 1;
+                bOperand.colStride = k;
+
+                gemm::Multiply(gemm::MakeOperand(a, m, k), bOperand, gemm::MakeOutput(c, m, n));
+
+                for (u32 eIdx = 0; eIdx < m * n; ++eIdx)
+                {
+                    Assert::IsTrue(fabsf(expected[eIdx] - c[eIdx]) < c_Precision);
+                }
+
+                delete[] a;
+                delete[] b;
+                delete[] bTransposed;
+                delete[] c;
+                delete[] expected;
+            }
+        };
+    }
+}
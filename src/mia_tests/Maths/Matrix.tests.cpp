@@ -1,6 +1,9 @@
 #include <CppUnitTest.h>
 
 #include <Maths/Matrix.h>
+#include <Core/ThreadPool.h>
+
+#include <math.h>
 
 using namespace Microsoft::VisualStudio::CppUnitTestFramework;
 
@@ -8,6 +11,27 @@ namespace mia
 {
     namespace tests
     {
+        // Wraps the default allocator & keeps track of the number of blocks that haven't been freed.
+        class TrackingAllocator final : public Allocator
+        {
+        public:
+            virtual void * Allocate(u64 numBytes) override
+            {
+                ++m_NumAllocations;
+                ++m_NumLiveBlocks;
+                return Allocator::GetDefault().Allocate(numBytes);
+            }
+
+            virtual void Free(void * ptr, u64 numBytes) override
+            {
+                --m_NumLiveBlocks;
+                Allocator::GetDefault().Free(ptr, numBytes);
+            }
+
+            u32 m_NumAllocations = 0;
+            s32 m_NumLiveBlocks = 0;
+        };
+
         TEST_CLASS(MatrixTests)
         {
             static f32 constexpr c_Precision = 1e-3f;
@@ -218,7 +242,7 @@ namespace mia
                         f32 const & expectedValue = expected[(width * rIdx) + cIdx];
                         f32 const & calculatedValue = result.GetElement(rIdx, cIdx);
 
-                        Assert::IsTrue(abs(expectedValue - calculatedValue) < c_Precision);
+                        Assert::IsTrue(fabsf(expectedValue - calculatedValue) < c_Precision);
                     }
                 }
             }
@@ -266,7 +290,7 @@ namespace mia
                         f32 const & expectedValue = expected[(resultWidth * rIdx) + cIdx];
                         f32 const & calculatedValue = result.GetElement(rIdx, cIdx);
 
-                        Assert::IsTrue(abs(expectedValue - calculatedValue) < c_Precision);
+                        Assert::IsTrue(fabsf(expectedValue - calculatedValue) < c_Precision);
                     }
                 }
             }
@@ -403,6 +427,29 @@ namespace mia
                 Assert::IsTrue(a != b);
             }
 
+            TEST_METHOD(Equals_ReturnsTrueIfMatricesAreWithinTolerance)
+            {
+                u32 const width = 3;
+                u32 const height = 2;
+
+                f32 aValues[] = {
+                    3.0f, 4.0f, 5.0f,
+                    1.0f, 2.0f, 3.0f
+                };
+
+                f32 bValues[] = {
+                    3.0001f, 4.0f, 4.9999f,
+                    1.0f, 2.0f, 3.0001f
+                };
+
+                Matrix a(width, height, aValues);
+                Matrix b(width, height, bValues);
+
+                Assert::IsTrue(a.Equals(b, c_Precision));
+                Assert::IsFalse(a.Equals(b, 0.0f));
+                Assert::IsFalse(a == b);
+            }
+
             TEST_METHOD(CanAdd_SameDimensions)
             {
                 u32 const width = 3;
@@ -434,6 +481,341 @@ namespace mia
                     }
                 }
             }
+
+            TEST_METHOD(CanAddBroadcast_ColumnToEveryColumn)
+            {
+                u32 const width = 3;
+                u32 const height = 2;
+
+                f32 aValues[] = {
+                    1.0f, 2.0f, 3.0f,
+                    4.0f, 5.0f, 6.0f
+                };
+
+                f32 columnValues[] = {
+                    10.0f,
+                    20.0f
+                };
+
+                Matrix a(width, height, aValues);
+                Matrix column(1, height, columnValues);
+
+                Matrix result = Matrix::AddBroadcast(a, column);
+
+                Assert::AreEqual(width, result.GetWidth());
+                Assert::AreEqual(height, result.GetHeight());
+
+                for (u32 rIdx = 0; rIdx < height; ++rIdx)
+                {
+                    for (u32 cIdx = 0; cIdx < width; ++cIdx)
+                    {
+                        Assert::AreEqual(a.GetElement(rIdx, cIdx) + columnValues[rIdx], result.GetElement(rIdx, cIdx));
+                    }
+                }
+            }
+
+            TEST_METHOD(Resize_OnlyReallocates_WhenGrowingBeyondReservedElements)
+            {
+                Matrix matrix(4, 4);
+                f32 const * data = matrix.GetData();
+
+                matrix.Resize(2, 3);
+                Assert::AreEqual(static_cast<u32>(2), matrix.GetWidth());
+                Assert::AreEqual(static_cast<u32>(3), matrix.GetHeight());
+                Assert::IsTrue(data == matrix.GetData());
+
+                matrix.Resize(8, 2);
+                Assert::AreEqual(static_cast<u64>(16), matrix.GetCapacity());
+                Assert::IsTrue(data == matrix.GetData());
+
+                matrix.Resize(5, 5);
+                Assert::AreEqual(static_cast<u64>(25), matrix.GetCapacity());
+            }
+
+            TEST_METHOD(Reserve_KeepsDimensionsAndContents)
+            {
+                f32 values[] = {
+                    1.0f, 2.0f,
+                    3.0f, 4.0f
+                };
+
+                Matrix matrix(2, 2, values);
+                matrix.Reserve(100);
+
+                Assert::AreEqual(static_cast<u32>(2), matrix.GetWidth());
+                Assert::AreEqual(static_cast<u32>(2), matrix.GetHeight());
+                Assert::IsTrue(Matrix(2, 2, values) == matrix);
+
+                // Resizing within the reserved elements doesn't reallocate
+                f32 const * data = matrix.GetData();
+                matrix.Resize(10, 10);
+                Assert::IsTrue(data == matrix.GetData());
+            }
+
+            TEST_METHOD(CanMultiplyInto_ExistingMatrix)
+            {
+                f32 aValues[] = {
+                    1.0f, 2.0f, 3.0f,
+                    4.0f, 5.0f, 6.0f
+                };
+
+                f32 bValues[] = {
+                    7.0f, 8.0f,
+                    9.0f, 10.0f,
+                    11.0f, 12.0f
+                };
+
+                f32 expectedValues[] = {
+                    58.0f, 64.0f,
+                    139.0f, 154.0f
+                };
+
+                Matrix a(3, 2, aValues);
+                Matrix b(2, 3, bValues);
+
+                // The result matrix is larger than needed & gets resized
+                Matrix result(4, 4);
+                f32 const * data = result.GetData();
+                Matrix::MultiplyInto(a, b, result);
+
+                Assert::IsTrue(data == result.GetData());
+                Assert::IsTrue(Matrix(2, 2, expectedValues).Equals(result, 1e-3f));
+            }
+
+            TEST_METHOD(CanTransposeInto_ExistingMatrix)
+            {
+                f32 values[] = {
+                    1.0f, 2.0f, 3.0f,
+                    4.0f, 5.0f, 6.0f
+                };
+
+                f32 expectedValues[] = {
+                    1.0f, 4.0f,
+                    2.0f, 5.0f,
+                    3.0f, 6.0f
+                };
+
+                Matrix result;
+                Matrix::TransposeInto(Matrix(3, 2, values), result);
+
+                Assert::IsTrue(Matrix(2, 3, expectedValues) == result);
+            }
+
+            TEST_METHOD(CanTransposeInto_LargeMatrix_MultipleThreads)
+            {
+                // Large enough to be split into partial blocks & across threads
+                u32 const width = 301;
+                u32 const height = 517;
+
+                Matrix m(width, height);
+                for (u32 rIdx = 0; rIdx < height; ++rIdx)
+                {
+                    for (u32 cIdx = 0; cIdx < width; ++cIdx)
+                    {
+                        m.GetElement(rIdx, cIdx) = static_cast<f32>((rIdx * width) + cIdx);
+                    }
+                }
+
+                ThreadPool::Get().SetNumThreads(4);
+
+                Matrix result;
+                Matrix::TransposeInto(m, result);
+
+                ThreadPool::Get().SetNumThreads(0);
+
+                Assert::AreEqual(height, result.GetWidth());
+                Assert::AreEqual(width, result.GetHeight());
+
+                for (u32 rIdx = 0; rIdx < height; ++rIdx)
+                {
+                    for (u32 cIdx = 0; cIdx < width; ++cIdx)
+                    {
+                        Assert::AreEqual(m.GetElement(rIdx, cIdx), result.GetElement(cIdx, rIdx));
+                    }
+                }
+            }
+
+            TEST_METHOD(CanTransposeInPlace_SquareMatrix)
+            {
+                // Not a multiple of the block size so the blocks along the bottom & right edges are partial
+                u32 const size = 197;
+
+                Matrix m(size, size);
+                for (u32 rIdx = 0; rIdx < size; ++rIdx)
+                {
+                    for (u32 cIdx = 0; cIdx < size; ++cIdx)
+                    {
+                        m.GetElement(rIdx, cIdx) = static_cast<f32>((rIdx * size) + cIdx);
+                    }
+                }
+
+                Matrix const expected = Matrix::Transpose(m);
+                f32 const * data = m.GetData();
+
+                ThreadPool::Get().SetNumThreads(4);
+                Matrix::TransposeInPlace(m);
+                ThreadPool::Get().SetNumThreads(0);
+
+                Assert::IsTrue(data == m.GetData());
+                Assert::IsTrue(expected == m);
+            }
+
+            TEST_METHOD(CanTransposeInPlace_DifferentWidthAndHeight)
+            {
+                f32 values[] = {
+                    1.0f, 2.0f, 3.0f,
+                    4.0f, 5.0f, 6.0f
+                };
+
+                f32 expectedValues[] = {
+                    1.0f, 4.0f,
+                    2.0f, 5.0f,
+                    3.0f, 6.0f
+                };
+
+                Matrix m(3, 2, values);
+                Matrix::TransposeInPlace(m);
+
+                Assert::IsTrue(Matrix(2, 3, expectedValues) == m);
+            }
+
+            TEST_METHOD(CanTransposeInPlace_1DimensionMatrix)
+            {
+                f32 values[] = {
+                    3.0f, 4.0f, 5.0f
+                };
+
+                Matrix m(1, 3, values);
+                Matrix::TransposeInPlace(m);
+
+                Assert::IsTrue(Matrix(3, 1, values) == m);
+            }
+
+            TEST_METHOD(CanAddInPlace_SameDimensions)
+            {
+                f32 aValues[] = {
+                    1.0f, 2.0f, 3.0f,
+                    4.0f, 5.0f, 6.0f
+                };
+
+                f32 bValues[] = {
+                    9.0f, 8.0f, 7.0f,
+                    6.0f, 5.0f, 4.0f
+                };
+
+                Matrix a(3, 2, aValues);
+                Matrix b(3, 2, bValues);
+
+                Matrix::AddInPlace(a, b);
+
+                for (u32 rIdx = 0; rIdx < a.GetHeight(); ++rIdx)
+                {
+                    for (u32 cIdx = 0; cIdx < a.GetWidth(); ++cIdx)
+                    {
+                        Assert::AreEqual(10.0f, a.GetElement(rIdx, cIdx));
+                    }
+                }
+            }
+
+            TEST_METHOD(Storage_IsAllocatedFromTheSuppliedAllocator)
+            {
+                TrackingAllocator allocator;
+                {
+                    Matrix matrix(16, 4, allocator);
+
+                    Assert::IsTrue(&allocator == &matrix.GetAllocator());
+                    Assert::AreEqual(static_cast<u32>(1), allocator.m_NumAllocations);
+                    Assert::AreEqual(static_cast<size_t>(0), reinterpret_cast<size_t>(matrix.GetData()) % c_AllocationAlignment);
+                }
+
+                Assert::AreEqual(static_cast<s32>(0), allocator.m_NumLiveBlocks);
+            }
+
+            TEST_METHOD(CopyAssignment_DoesNotLeak)
+            {
+                TrackingAllocator allocator;
+                {
+                    f32 values[] = { 1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f };
+                    Matrix source(3, 2, values);
+
+                    Matrix matrix(1, 1, allocator);
+                    matrix = source;
+                    matrix = source;
+
+                    // The second assignment reuses the storage from the first
+                    Assert::AreEqual(static_cast<u32>(2), allocator.m_NumAllocations);
+                    Assert::AreEqual(static_cast<s32>(1), allocator.m_NumLiveBlocks);
+                    Assert::IsTrue(source == matrix);
+
+                    // Assigning a larger matrix reallocates & frees the previous storage
+                    matrix = Matrix(10, 10);
+                    Assert::AreEqual(static_cast<s32>(0), allocator.m_NumLiveBlocks);
+                }
+
+                Assert::AreEqual(static_cast<s32>(0), allocator.m_NumLiveBlocks);
+            }
+
+            TEST_METHOD(MoveAssignment_DoesNotLeak)
+            {
+                TrackingAllocator allocator;
+                {
+                    Matrix matrix(4, 4, allocator);
+                    matrix = Matrix(2, 2, allocator);
+                    Assert::AreEqual(static_cast<s32>(1), allocator.m_NumLiveBlocks);
+                }
+
+                Assert::AreEqual(static_cast<s32>(0), allocator.m_NumLiveBlocks);
+            }
+
+            TEST_METHOD(View_ReferencesTheSuppliedDataWithoutOwningIt)
+            {
+                TrackingAllocator allocator;
+                f32 values[] = { 1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f };
+                {
+                    Matrix view = Matrix::View(3, 2, values, allocator);
+
+                    Assert::IsTrue(view.IsView());
+                    Assert::IsTrue(values == view.GetData());
+                    Assert::AreEqual(6.0f, view.GetElement(1, 2));
+
+                    view.GetElement(0, 1) = 10.0f;
+                    Assert::AreEqual(10.0f, values[1]);
+
+                    // Shrinking keeps referencing the data, growing beyond it allocates
+                    view.Resize(2, 2);
+                    Assert::IsTrue(values == view.GetData());
+                    Assert::AreEqual(static_cast<u32>(0), allocator.m_NumAllocations);
+
+                    view.Resize(4, 4);
+                    Assert::IsFalse(view.IsView());
+                    Assert::AreEqual(static_cast<u32>(1), allocator.m_NumAllocations);
+
+                    // Copies own their elements
+                    Matrix const otherView = Matrix::View(3, 2, values);
+                    Matrix const copied = otherView;
+                    Assert::IsFalse(copied.IsView());
+                    Assert::IsTrue(values != copied.GetData());
+                }
+
+                Assert::AreEqual(static_cast<s32>(0), allocator.m_NumLiveBlocks);
+                Assert::AreEqual(10.0f, values[1]);
+            }
+
+            TEST_METHOD(CanAllocateFromAnArena)
+            {
+                ArenaAllocator arena(4096);
+
+                for (u32 iIdx = 0; iIdx < 3; ++iIdx)
+                {
+                    {
+                        Matrix a(8, 8, arena);
+                        Matrix b(8, 8, arena);
+                        Assert::AreEqual(static_cast<u64>(2 * 8 * 8 * sizeof(f32)), arena.GetNumBytesUsed());
+                    }
+
+                    arena.Reset();
+                }
+            }
         };
     }
 }
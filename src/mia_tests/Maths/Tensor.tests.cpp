@@ -0,0 +1,304 @@
+#include <CppUnitTest.h>
+
+#include <Maths/Tensor.h>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace mia
+{
+    namespace tests
+    {
+        TEST_CLASS(TensorTests)
+        {
+            // Wraps the default allocator & keeps track of the number of blocks that haven't been freed.
+            class CountingAllocator final : public Allocator
+            {
+            public:
+                virtual void * Allocate(u64 numBytes) override
+                {
+                    ++m_NumLiveBlocks;
+                    return Allocator::GetDefault().Allocate(numBytes);
+                }
+
+                virtual void Free(void * ptr, u64 numBytes) override
+                {
+                    --m_NumLiveBlocks;
+                    Allocator::GetDefault().Free(ptr, numBytes);
+                }
+
+                s32 m_NumLiveBlocks = 0;
+            };
+
+            // Fills data with 0, 1, 2, ...
+            static void FillSequence(f32 * data, u64 numElements)
+            {
+                for (u64 eIdx = 0; eIdx < numElements; ++eIdx)
+                {
+                    data[eIdx] = static_cast<f32>(eIdx);
+                }
+            }
+
+        public:
+            TEST_METHOD(CanConstruct_AnEmptyTensor)
+            {
+                Tensor tensor;
+
+                Assert::AreEqual(static_cast<u32>(0), tensor.GetNumDimensions());
+                Assert::AreEqual(static_cast<u64>(0), tensor.GetNumElements());
+                Assert::IsTrue(tensor.IsEmpty());
+                Assert::IsNull(tensor.GetData());
+            }
+
+            TEST_METHOD(CanConstruct_AZeroFilledContiguousTensor)
+            {
+                Tensor tensor({ 4, 3, 2 });
+
+                Assert::AreEqual(static_cast<u32>(3), tensor.GetNumDimensions());
+                Assert::AreEqual(static_cast<u64>(24), tensor.GetNumElements());
+                Assert::AreEqual(static_cast<u64>(6), tensor.GetStride(0));
+                Assert::AreEqual(static_cast<u64>(2), tensor.GetStride(1));
+                Assert::AreEqual(static_cast<u64>(1), tensor.GetStride(2));
+                Assert::IsTrue(tensor.IsContiguous());
+                Assert::IsFalse(tensor.IsBorrowed());
+
+                for (u64 eIdx = 0; eIdx < tensor.GetNumElements(); ++eIdx)
+                {
+                    Assert::AreEqual(0.0f, tensor.GetData()[eIdx]);
+                }
+            }
+
+            TEST_METHOD(Storage_IsSharedByCopies_AndReleasedWithTheLastOne)
+            {
+                CountingAllocator allocator;
+                {
+                    Tensor tensor({ 8, 8 }, allocator);
+                    Assert::AreEqual(static_cast<s32>(1), allocator.m_NumLiveBlocks);
+
+                    Tensor view = tensor.Slice(0, 2, 4);
+                    {
+                        Tensor const copy = tensor;
+                        Assert::IsTrue(copy.SharesStorageWith(tensor));
+                        Assert::IsTrue(copy.GetData() == tensor.GetData());
+                    }
+
+                    tensor = Tensor();
+                    Assert::AreEqual(static_cast<s32>(1), allocator.m_NumLiveBlocks);
+
+                    view.GetElement({ 1, 7 }) = 5.0f;
+                    Assert::AreEqual(5.0f, view.GetData()[15]);
+                }
+
+                Assert::AreEqual(static_cast<s32>(0), allocator.m_NumLiveBlocks);
+            }
+
+            TEST_METHOD(Borrow_ViewsTheCallersDataWithoutCopying)
+            {
+                f32 data[6];
+                FillSequence(data, LENGTHOF(data));
+
+                Tensor const tensor = Tensor::Borrow(data, { 2, 3 });
+
+                Assert::IsTrue(tensor.IsBorrowed());
+                Assert::IsTrue(data == tensor.GetData());
+                Assert::AreEqual(4.0f, tensor.GetElement({ 1, 1 }));
+
+                tensor.GetElement({ 0, 2 }) = 10.0f;
+                Assert::AreEqual(10.0f, data[2]);
+            }
+
+            TEST_METHOD(Borrow_ViewsAMatrix)
+            {
+                Matrix matrix(3, 2);
+                matrix.GetElement(1, 2) = 7.0f;
+
+                Tensor const tensor = Tensor::Borrow(matrix);
+
+                Assert::AreEqual(static_cast<u32>(2), tensor.GetLength(0));
+                Assert::AreEqual(static_cast<u32>(3), tensor.GetLength(1));
+                Assert::AreEqual(7.0f, tensor.GetElement({ 1, 2 }));
+            }
+
+            TEST_METHOD(Reshape_OfAContiguousTensor_SharesItsElements)
+            {
+                f32 data[24];
+                FillSequence(data, LENGTHOF(data));
+
+                Tensor const tensor = Tensor::Borrow(data, { 4, 3, 2 });
+                Tensor const reshaped = tensor.Reshape({ 4, 6 });
+
+                Assert::IsTrue(reshaped.GetData() == tensor.GetData());
+                Assert::IsTrue(reshaped.IsContiguous());
+                for (u64 rIdx = 0; rIdx < 4; ++rIdx)
+                {
+                    for (u64 cIdx = 0; cIdx < 6; ++cIdx)
+                    {
+                        Assert::AreEqual(data[(rIdx * 6) + cIdx], reshaped.GetElement({ rIdx, cIdx }));
+                    }
+                }
+            }
+
+            TEST_METHOD(TryReshape_OfAStridedTensor_SucceedsOnlyIfNoCopyIsNeeded)
+            {
+                f32 data[4 * 3 * 2];
+                FillSequence(data, LENGTHOF(data));
+
+                // Every other row of a (4 x 6) matrix, the 6 elements of each row remain contiguous
+                Tensor const rows = Tensor::Borrow(data, { 2, 2, 6 }).Slice(1, 0, 1);
+                Assert::IsFalse(rows.IsContiguous());
+
+                DimensionLength const splitShape[] = { 2, 3, 2 };
+                Tensor splitRows;
+                Assert::IsTrue(rows.TryReshape(LENGTHOF(splitShape), splitShape, splitRows));
+                for (u64 sIdx = 0; sIdx < 2; ++sIdx)
+                {
+                    for (u64 rIdx = 0; rIdx < 3; ++rIdx)
+                    {
+                        for (u64 cIdx = 0; cIdx < 2; ++cIdx)
+                        {
+                            Assert::AreEqual(data[(sIdx * 12) + (rIdx * 2) + cIdx], splitRows.GetElement({ sIdx, rIdx, cIdx }));
+                        }
+                    }
+                }
+
+                // Merging the gap between the rows away would need a copy
+                DimensionLength const mergedShape[] = { 12 };
+                Tensor merged;
+                Assert::IsFalse(rows.TryReshape(LENGTHOF(mergedShape), mergedShape, merged));
+                Assert::AreEqual(static_cast<u32>(0), merged.GetNumDimensions());
+            }
+
+            TEST_METHOD(Slice_ViewsASubsetOfADimension)
+            {
+                f32 data[12];
+                FillSequence(data, LENGTHOF(data));
+
+                Tensor const columns = Tensor::Borrow(data, { 3, 4 }).Slice(1, 1, 3);
+
+                Assert::AreEqual(static_cast<u32>(3), columns.GetLength(0));
+                Assert::AreEqual(static_cast<u32>(2), columns.GetLength(1));
+                Assert::IsFalse(columns.IsContiguous());
+                Assert::AreEqual(data[1], columns.GetElement({ 0, 0 }));
+                Assert::AreEqual(data[(2 * 4) + 2], columns.GetElement({ 2, 1 }));
+            }
+
+            TEST_METHOD(Transpose_SwapsDimensionsWithoutCopying)
+            {
+                f32 data[6];
+                FillSequence(data, LENGTHOF(data));
+
+                Tensor const tensor = Tensor::Borrow(data, { 2, 3 });
+                Tensor const transposed = tensor.Transpose(0, 1);
+
+                Assert::IsTrue(transposed.GetData() == data);
+                Assert::AreEqual(static_cast<u32>(3), transposed.GetLength(0));
+                Assert::AreEqual(static_cast<u32>(2), transposed.GetLength(1));
+                Assert::IsFalse(transposed.IsContiguous());
+
+                for (u64 rIdx = 0; rIdx < 2; ++rIdx)
+                {
+                    for (u64 cIdx = 0; cIdx < 3; ++cIdx)
+                    {
+                        Assert::AreEqual(tensor.GetElement({ rIdx, cIdx }), transposed.GetElement({ cIdx, rIdx }));
+                    }
+                }
+            }
+
+            TEST_METHOD(Permute_ReordersDimensions)
+            {
+                f32 data[24];
+                FillSequence(data, LENGTHOF(data));
+
+                Tensor const tensor = Tensor::Borrow(data, { 4, 3, 2 });
+                u32 const order[] = { 2, 0, 1 };
+                Tensor const permuted = tensor.Permute(order);
+
+                Assert::AreEqual(static_cast<u32>(2), permuted.GetLength(0));
+                Assert::AreEqual(static_cast<u32>(4), permuted.GetLength(1));
+                Assert::AreEqual(static_cast<u32>(3), permuted.GetLength(2));
+                Assert::AreEqual(tensor.GetElement({ 3, 1, 1 }), permuted.GetElement({ 1, 3, 1 }));
+            }
+
+            TEST_METHOD(Broadcast_RepeatsDimensionsOfLengthOne)
+            {
+                f32 data[] = { 1.0f, 2.0f, 3.0f };
+
+                Tensor const column = Tensor::Borrow(data, { 3, 1 });
+                Tensor const broadcast = column.Broadcast({ 2, 3, 4 });
+
+                Assert::AreEqual(static_cast<u64>(0), broadcast.GetStride(0));
+                Assert::AreEqual(static_cast<u64>(0), broadcast.GetStride(2));
+                for (u64 bIdx = 0; bIdx < 2; ++bIdx)
+                {
+                    for (u64 rIdx = 0; rIdx < 3; ++rIdx)
+                    {
+                        for (u64 cIdx = 0; cIdx < 4; ++cIdx)
+                        {
+                            Assert::AreEqual(data[rIdx], broadcast.GetElement({ bIdx, rIdx, cIdx }));
+                        }
+                    }
+                }
+            }
+
+            TEST_METHOD(Contiguous_CopiesOnlyNonContiguousTensors)
+            {
+                f32 data[6];
+                FillSequence(data, LENGTHOF(data));
+
+                Tensor const tensor = Tensor::Borrow(data, { 2, 3 });
+                Assert::IsTrue(tensor.Contiguous().GetData() == data);
+
+                Tensor const transposed = tensor.Transpose(0, 1).Contiguous();
+                Assert::IsTrue(transposed.IsContiguous());
+                Assert::IsFalse(transposed.IsBorrowed());
+
+                f32 const expected[] = { 0.0f, 3.0f, 1.0f, 4.0f, 2.0f, 5.0f };
+                for (u32 eIdx = 0; eIdx < LENGTHOF(expected); ++eIdx)
+                {
+                    Assert::AreEqual(expected[eIdx], transposed.GetData()[eIdx]);
+                }
+            }
+
+            TEST_METHOD(Copy_WritesThroughTheStridesOfTheDestination)
+            {
+                f32 src[2 * 3 * 4];
+                FillSequence(src, LENGTHOF(src));
+
+                Tensor const srcTensor = Tensor::Borrow(src, { 2, 3, 4 });
+                Tensor dst({ 4, 3, 2 });
+                u32 const order[] = { 2, 1, 0 };
+
+                Tensor::Copy(srcTensor, dst.Permute(order));
+
+                for (u64 aIdx = 0; aIdx < 2; ++aIdx)
+                {
+                    for (u64 bIdx = 0; bIdx < 3; ++bIdx)
+                    {
+                        for (u64 cIdx = 0; cIdx < 4; ++cIdx)
+                        {
+                            Assert::AreEqual(srcTensor.GetElement({ aIdx, bIdx, cIdx }), dst.GetElement({ cIdx, bIdx, aIdx }));
+                        }
+                    }
+                }
+            }
+
+            TEST_METHOD(Copy_TransposesLayoutsLargerThanOneBlock)
+            {
+                u32 const numRows = 70;
+                u32 const numCols = 130;
+                Tensor src({ numRows, numCols });
+                FillSequence(src.GetData(), src.GetNumElements());
+
+                Tensor dst({ numCols, numRows });
+                Tensor::Copy(src, dst.Transpose(0, 1));
+
+                for (u64 rIdx = 0; rIdx < numRows; ++rIdx)
+                {
+                    for (u64 cIdx = 0; cIdx < numCols; ++cIdx)
+                    {
+                        Assert::AreEqual(src.GetElement({ rIdx, cIdx }), dst.GetElement({ cIdx, rIdx }));
+                    }
+                }
+            }
+        };
+    }
+}
@@ -0,0 +1,277 @@
+#include <CppUnitTest.h>
+
+#include <Models/DataParallelTrainer.h>
+#include <Layers/Flatten.h>
+#include <Layers/Dense.h>
+
+#include <math.h>
+#include <stdio.h>
+#include <vector>
+
+#include "../Helpers/ThreadCountScope.h"
+#include "../Helpers/TrainingFixture.h"
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace mia
+{
+    namespace tests
+    {
+        TEST_CLASS(DataParallelTrainerTests)
+        {
+            static u32 constexpr c_TestSeedValue = 11;
+
+            // Trains one model with Sequential::Train & another with a DataParallelTrainer of numWorkers workers
+            // on the same batches, then checks both end up with the same parameters.
+            static void TrainAlike(u32 batchSize, u32 numWorkers, optimizers::Optimizer const & optimizer, char const * checkpointPath = nullptr)
+            {
+                ThreadCountScope const threadCount(4);
+
+                std::unique_ptr<models::Sequential> expectedModel(CreateRegressionModel(batchSize, optimizer));
+                std::unique_ptr<models::Sequential> model(CreateRegressionModel(batchSize, optimizer));
+                models::DataParallelTrainer trainer(*model, batchSize, numWorkers);
+                Assert::AreEqual(numWorkers, trainer.GetNumWorkers());
+
+                for (u32 bIdx = 0; bIdx < 20; ++bIdx)
+                {
+                    Tensor input, expectedOutput;
+                    CreateRegressionBatch(batchSize, bIdx, input, expectedOutput);
+
+                    expectedModel->Train(input, expectedOutput);
+                    trainer.Train(input, expectedOutput);
+                    Assert::IsTrue(fabsf(expectedModel->GetLoss() - model->GetLoss()) < c_TrainingPrecision);
+
+                    // The checkpoint is still being written while training carries on
+                    if ((nullptr != checkpointPath) && (0 == (bIdx % 5)))
+                    {
+                        model->Checkpoint(checkpointPath);
+                    }
+                }
+
+                Assert::IsTrue(HaveCloseParameters(*expectedModel, *model, c_TrainingPrecision));
+
+                if (nullptr != checkpointPath)
+                {
+                    Assert::IsTrue(model->WaitForCheckpoint());
+                    remove(checkpointPath);
+                }
+            }
+
+            // Returns the index of the largest of the supplied values.
+            static u32 ArgMax(Matrix const & values, u32 column)
+            {
+                u32 maxIndex = 0;
+                for (u32 rIdx = 1; rIdx < values.GetHeight(); ++rIdx)
+                {
+                    maxIndex = (values.GetElement(rIdx, column) > values.GetElement(maxIndex, column)) ? rIdx : maxIndex;
+                }
+                return maxIndex;
+            }
+
+            // Fills a dataset resembling MNIST: numSamples noisy (8 x 8) images of 10 classes, each with the one-hot
+            // encoding of its class as its expected output. Each class is a random pattern of on & off pixels.
+            static void CreateImages(u32 numSamples, Tensor & input, Tensor & expectedOutput)
+            {
+                input = Tensor({ numSamples, 8, 8 });
+                expectedOutput = Tensor({ numSamples, 10 });
+
+                // Returns the next of a sequence of random values in the range [0, 1)
+                unsigned int state = 1;
+                auto random = [&state]() -> f32
+                {
+                    state = (state * 1664525u) + 1013904223u;
+                    return static_cast<f32>(state >> 8) / static_cast<f32>(1 << 24);
+                };
+
+                f32 patterns[10][64];
+                for (u32 cIdx = 0; cIdx < 10; ++cIdx)
+                {
+                    for (u32 pIdx = 0; pIdx < 64; ++pIdx)
+                    {
+                        patterns[cIdx][pIdx] = (random() < 0.5f) ? 1.0f : 0.0f;
+                    }
+                }
+
+                for (u64 sIdx = 0; sIdx < numSamples; ++sIdx)
+                {
+                    u64 const classIndex = sIdx % 10;
+                    for (u64 pIdx = 0; pIdx < 64; ++pIdx)
+                    {
+                        input.GetData()[(sIdx * 64) + pIdx] = (0.6f * patterns[classIndex][pIdx]) + (0.4f * random());
+                    }
+
+                    for (u64 cIdx = 0; cIdx < 10; ++cIdx)
+                    {
+                        expectedOutput.GetElement({ sIdx, cIdx }) = (cIdx == classIndex) ? 1.0f : 0.0f;
+                    }
+                }
+            }
+
+            // Trains model synchronously & hogwildModel with Hogwild!, each with 4 workers, on the supplied data for
+            // numEpochs epochs of mini-batches of batchSize samples. Checks Hogwild! ends up with a loss close to
+            // that of synchronous training.
+            static void TrainBoth(models::Sequential & model, models::Sequential & hogwildModel, Tensor const & input, Tensor const & expectedOutput, u32 batchSize, u32 numEpochs)
+            {
+                ThreadCountScope const threadCount(4);
+
+                models::DataParallelTrainer trainer(model, batchSize, 4);
+                models::DataParallelTrainer hogwildTrainer(hogwildModel, batchSize, 4, models::TrainingMode::Hogwild);
+                Assert::IsTrue(models::TrainingMode::Hogwild == hogwildTrainer.GetMode());
+
+                u32 const numSamples = input.GetLength(0);
+                f32 loss = 0.0f;
+                for (u32 eIdx = 0; eIdx < numEpochs; ++eIdx)
+                {
+                    // Synchronous training is stepped once per mini-batch, Hogwild! is given the whole epoch at once
+                    loss = 0.0f;
+                    for (u32 firstSample = 0; firstSample < numSamples; firstSample += batchSize)
+                    {
+                        trainer.Train(input.Slice(0, firstSample, firstSample + batchSize), expectedOutput.Slice(0, firstSample, firstSample + batchSize));
+                        loss += model.GetLoss() * static_cast<f32>(batchSize) / static_cast<f32>(numSamples);
+                    }
+
+                    hogwildTrainer.Train(input, expectedOutput);
+                }
+
+                Assert::IsTrue(hogwildModel.GetLoss() < ((2.0f * loss) + 0.01f));
+            }
+
+        public:
+            TEST_METHOD(Train_MatchesSequentialTrain_WithUnevenShards)
+            {
+                // 4 workers share 10 samples as shards of 2, 3, 2 & 3 samples
+                TrainAlike(10, 4, optimizers::Optimizer::SGD(0.05f));
+                TrainAlike(10, 4, optimizers::Optimizer::Adam(0.01f));
+            }
+
+            TEST_METHOD(Train_MatchesSequentialTrain_WithMoreWorkersThanSamples)
+            {
+                TrainAlike(3, 8, optimizers::Optimizer::SGD(0.05f));
+                TrainAlike(1, 2, optimizers::Optimizer::SGD(0.05f));
+            }
+
+            TEST_METHOD(Train_MatchesSequentialTrain_WhileCheckpointing)
+            {
+                // Checkpoints leave the model's parameters to the checkpoint & carry on with copies, which the
+                // replicas must follow
+                TrainAlike(16, 3, optimizers::Optimizer::Momentum(0.05f, 0.9f), "DataParallelTrainer.tests.miackpt");
+            }
+
+            TEST_METHOD(TrainHogwild_LeavesACheckpointBeingWrittenThePreviousParameters)
+            {
+                static char const * c_ModelPath = "DataParallelTrainer.tests.mia";
+                static char const * c_CheckpointPath = "DataParallelTrainer.tests.miackpt";
+                ThreadCountScope const threadCount(4);
+
+                // A layer large enough to still be being written once the workers' first single sample steps update it
+                auto createModel = []()
+                {
+                    models::Sequential * model = new models::Sequential({
+                        new layers::Flatten({ 3 }, activators::ActivatorType::None),
+                        new layers::Dense(64, activators::ActivatorType::Tanh),
+                        new layers::Dense(4096, activators::ActivatorType::Tanh),
+                        new layers::Dense(2, activators::ActivatorType::None)
+                    });
+                    model->Compile(c_TestSeedValue, 1, optimizers::Optimizer::SGD(0.01f));
+                    return model;
+                };
+
+                std::unique_ptr<models::Sequential> model(createModel());
+                models::DataParallelTrainer trainer(*model, 1, 4, models::TrainingMode::Hogwild);
+
+                Tensor input, expectedOutput;
+                CreateRegressionBatch(16, 0, input, expectedOutput);
+                trainer.Train(input, expectedOutput);
+                Assert::IsTrue(model->Save(c_ModelPath));
+
+                // The checkpoint must hold the parameters as they were when it began
+                model->Checkpoint(c_CheckpointPath);
+                trainer.Train(input, expectedOutput);
+                Assert::IsTrue(model->WaitForCheckpoint());
+
+                std::unique_ptr<models::Sequential> expectedModel = models::Sequential::Load(c_ModelPath);
+                std::unique_ptr<models::Sequential> resumed(createModel());
+                Assert::IsNotNull(expectedModel.get());
+                Assert::IsTrue(resumed->Resume(c_CheckpointPath));
+                Assert::IsTrue(HaveCloseParameters(*expectedModel, *resumed, 0.0f));
+                Assert::IsFalse(HaveCloseParameters(*expectedModel, *model, 0.0f));
+
+                expectedModel.reset();
+                remove(c_ModelPath);
+                remove(c_CheckpointPath);
+            }
+
+            TEST_METHOD(TrainHogwild_LearnsXOR_LikeSynchronousTraining)
+            {
+                models::Sequential * sequentials[2];
+                for (u32 mIdx = 0; mIdx < 2; ++mIdx)
+                {
+                    sequentials[mIdx] = new models::Sequential({
+                        new layers::Flatten({ 2 }, activators::ActivatorType::None),
+                        new layers::Dense(8, activators::ActivatorType::Sigmoid),
+                        new layers::Dense(1, activators::ActivatorType::Sigmoid)
+                    });
+                    sequentials[mIdx]->Compile(0, 4, optimizers::Optimizer::SGD(2.0f));
+                }
+
+                // An epoch repeats the gate's truth table 16 times
+                Tensor input({ 64, 2 });
+                Tensor expectedOutput({ 64, 1 });
+                for (u64 sIdx = 0; sIdx < 64; ++sIdx)
+                {
+                    u64 const a = sIdx & 1;
+                    u64 const b = (sIdx >> 1) & 1;
+                    input.GetElement({ sIdx, 0 }) = static_cast<f32>(a);
+                    input.GetElement({ sIdx, 1 }) = static_cast<f32>(b);
+                    expectedOutput.GetElement({ sIdx, 0 }) = static_cast<f32>(a ^ b);
+                }
+
+                TrainBoth(*sequentials[0], *sequentials[1], input, expectedOutput, 4, 400);
+
+                for (u32 mIdx = 0; mIdx < 2; ++mIdx)
+                {
+                    Matrix const & output = sequentials[mIdx]->Predict(input.Slice(0, 0, 4));
+                    for (u64 sIdx = 0; sIdx < 4; ++sIdx)
+                    {
+                        Assert::IsTrue(fabsf(output.GetElement(0, static_cast<u32>(sIdx)) - expectedOutput.GetElement({ sIdx, 0 })) < 0.1f);
+                    }
+
+                    delete sequentials[mIdx];
+                }
+            }
+
+            TEST_METHOD(TrainHogwild_LearnsToClassifyImages_LikeSynchronousTraining)
+            {
+                models::Sequential * sequentials[2];
+                for (u32 mIdx = 0; mIdx < 2; ++mIdx)
+                {
+                    sequentials[mIdx] = new models::Sequential({
+                        new layers::Flatten({ 8, 8 }, activators::ActivatorType::None),
+                        new layers::Dense(32, activators::ActivatorType::ReLU),
+                        new layers::Dense(10, activators::ActivatorType::Sigmoid)
+                    });
+                    sequentials[mIdx]->Compile(c_TestSeedValue, 10, optimizers::Optimizer::SGD(0.5f));
+                }
+
+                Tensor input, expectedOutput;
+                CreateImages(500, input, expectedOutput);
+
+                TrainBoth(*sequentials[0], *sequentials[1], input, expectedOutput, 10, 20);
+
+                // Both models classify at least 90% of the images correctly
+                for (u32 mIdx = 0; mIdx < 2; ++mIdx)
+                {
+                    Matrix const & output = sequentials[mIdx]->Predict(input);
+                    u32 numCorrect = 0;
+                    for (u32 sIdx = 0; sIdx < 500; ++sIdx)
+                    {
+                        numCorrect += (ArgMax(output, sIdx) == (sIdx % 10)) ? 1 : 0;
+                    }
+                    Assert::IsTrue(numCorrect >= 450);
+
+                    delete sequentials[mIdx];
+                }
+            }
+        };
+    }
+}
@@ -0,0 +1,130 @@
+#include <CppUnitTest.h>
+
+#include <Models/DistributedTrainer.h>
+
+#include "../Helpers/LocalRanks.h"
+#include "../Helpers/TrainingFixture.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <string>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace mia
+{
+    namespace tests
+    {
+        // The transports are only implemented for POSIX hosts
+#if !defined(_WIN32)
+        TEST_CLASS(DistributedTrainerTests)
+        {
+            static u32 constexpr c_NumRanks = 4;
+            static u32 constexpr c_NumSteps = 12;
+
+            // Creates the transport of the supplied rank, of the kind under test.
+            typedef std::function<std::unique_ptr<distributed::Transport>(u32 rank)> ConnectFunction;
+
+            // Returns the path each rank saves its model to.
+            static std::string GetModelPath(u32 rank)
+            {
+                char path[64];
+                snprintf(path, sizeof(path), "DistributedTrainer.tests.rank%u.mia", static_cast<unsigned int>(rank));
+                return path;
+            }
+
+            // Trains a model on c_NumRanks local ranks connected by the supplied transport, with batches of
+            // batchSize samples. Each rank checks it trains like a single process training on the whole batches,
+            // then saves its model so the ranks' parameters can be compared with each other.
+            static void CheckTrainsLikeASingleProcess(ConnectFunction const & connect, u32 batchSize)
+            {
+                bool const isSuccessful = RunLocalRanks(c_NumRanks, [&](u32 rank) -> bool
+                {
+                    std::unique_ptr<distributed::Transport> transport = connect(rank);
+                    if (nullptr == transport)
+                    {
+                        return false;
+                    }
+
+                    std::unique_ptr<models::Sequential> expectedModel(CreateRegressionModel(batchSize, optimizers::Optimizer::Adam(0.01f)));
+                    std::unique_ptr<models::Sequential> model(CreateRegressionModel(batchSize, optimizers::Optimizer::Adam(0.01f)));
+                    models::DistributedTrainer trainer(*model, *transport);
+
+                    for (u32 bIdx = 0; bIdx < c_NumSteps; ++bIdx)
+                    {
+                        Tensor input, expectedOutput;
+                        CreateRegressionBatch(batchSize, bIdx, input, expectedOutput);
+
+                        expectedModel->Train(input, expectedOutput);
+                        if (!trainer.Train(input, expectedOutput) || !(fabsf(expectedModel->GetLoss() - model->GetLoss()) <= c_TrainingPrecision))
+                        {
+                            return false;
+                        }
+                    }
+
+                    return HaveCloseParameters(*expectedModel, *model, c_TrainingPrecision) && model->Save(GetModelPath(rank).c_str());
+                });
+                Assert::IsTrue(isSuccessful);
+
+                // The all-reduce hands every rank exactly the same gradients, so the replicas never diverge
+                std::unique_ptr<models::Sequential> firstModel = models::Sequential::Load(GetModelPath(0).c_str());
+                Assert::IsNotNull(firstModel.get());
+                for (u32 rank = 1; rank < c_NumRanks; ++rank)
+                {
+                    std::unique_ptr<models::Sequential> model = models::Sequential::Load(GetModelPath(rank).c_str());
+                    Assert::IsNotNull(model.get());
+                    Assert::IsTrue(HaveCloseParameters(*firstModel, *model, 0.0f));
+                }
+
+                firstModel.reset();
+                for (u32 rank = 0; rank < c_NumRanks; ++rank)
+                {
+                    remove(GetModelPath(rank).c_str());
+                }
+            }
+
+        public:
+            TEST_METHOD(Train_OverSharedMemory_TrainsLikeASingleProcess)
+            {
+                // Chunks smaller than the output layer's bucket split it across several exchanges, 30 samples are
+                // split unevenly across the ranks
+                u64 const session = CreateSession();
+                CheckTrainsLikeASingleProcess([=](u32 rank)
+                {
+                    return distributed::ConnectSharedMemory("mia_tests.DistributedTrainer", session, rank, c_NumRanks, 16);
+                }, 30);
+            }
+
+            TEST_METHOD(Train_OverSockets_TrainsLikeASingleProcess)
+            {
+                CheckTrainsLikeASingleProcess([](u32 rank)
+                {
+                    return distributed::ConnectSocket("DistributedTrainer.tests.sock", rank, c_NumRanks);
+                }, 16);
+            }
+
+            TEST_METHOD(Train_Fails_OnceAnotherRankHasGoneAway)
+            {
+                // Rank 1 leaves after connecting, rank 0 has to notice instead of waiting forever
+                Assert::IsTrue(RunLocalRanks(2, [](u32 rank) -> bool
+                {
+                    std::unique_ptr<distributed::Transport> transport = distributed::ConnectSocket("DistributedTrainer.tests.sock", rank, 2, 2);
+                    if ((nullptr == transport) || (1 == rank))
+                    {
+                        return nullptr != transport;
+                    }
+
+                    std::unique_ptr<models::Sequential> model(CreateRegressionModel(4, optimizers::Optimizer::SGD(0.05f)));
+                    Matrix const weights = model->GetLayer(1)->GetWeights();
+                    models::DistributedTrainer trainer(*model, *transport);
+
+                    Tensor input, expectedOutput;
+                    CreateRegressionBatch(4, 0, input, expectedOutput);
+                    return !trainer.Train(input, expectedOutput) && !trainer.Train(input, expectedOutput) &&
+                        AreClose(weights, model->GetLayer(1)->GetWeights(), 0.0f);
+                }));
+            }
+        };
+#endif
+    }
+}
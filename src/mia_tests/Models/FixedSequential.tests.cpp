@@ -0,0 +1,83 @@
+#include <CppUnitTest.h>
+
+#include <Models/FixedSequential.h>
+#include <Layers/Flatten.h>
+#include <Layers/Dense.h>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace mia
+{
+    namespace tests
+    {
+        TEST_CLASS(FixedSequentialTests)
+        {
+            static u32 constexpr c_TestSeedValue = 11;
+            static f32 constexpr c_Precision = 1e-5f;
+
+            typedef models::FixedSequential<
+                models::FixedDense<3, 16, activators::ActivatorType::ReLU>,
+                models::FixedDense<16, 8, activators::ActivatorType::Tanh>,
+                models::FixedDense<8, 2, activators::ActivatorType::Sigmoid>> FixedModel;
+
+            static models::Sequential * CreateModel(u32 numHiddenNeurons, activators::ActivatorType outputActivatorType)
+            {
+                models::Sequential * model = new models::Sequential({
+                    new layers::Flatten({ 3 }, activators::ActivatorType::None),
+                    new layers::Dense(16, activators::ActivatorType::ReLU),
+                    new layers::Dense(numHiddenNeurons, activators::ActivatorType::Tanh),
+                    new layers::Dense(2, outputActivatorType)
+                });
+
+                model->Compile(c_TestSeedValue, 5);
+                return model;
+            }
+
+        public:
+            TEST_METHOD(Predict_MatchesTheSequentialModel)
+            {
+                std::unique_ptr<models::Sequential> model(CreateModel(8, activators::ActivatorType::Sigmoid));
+
+                FixedModel fixedModel;
+                Assert::IsTrue(fixedModel.Load(*model));
+
+                u32 const numSamples = 5;
+                f32 inputData[numSamples * 3];
+                for (u32 eIdx = 0; eIdx < LENGTHOF(inputData); ++eIdx)
+                {
+                    inputData[eIdx] = (static_cast<f32>(eIdx % 7) * 0.5f) - 1.5f;
+                }
+
+                Matrix const & expectedOutput = model->Predict(Tensor::Borrow(inputData, { numSamples, 3 }));
+                for (u32 sIdx = 0; sIdx < numSamples; ++sIdx)
+                {
+                    f32 output[2];
+                    fixedModel.Predict(&inputData[sIdx * 3], output);
+
+                    for (u32 rIdx = 0; rIdx < LENGTHOF(output); ++rIdx)
+                    {
+                        Assert::AreEqual(expectedOutput.GetElement(rIdx, sIdx), output[rIdx], c_Precision);
+                    }
+                }
+            }
+
+            TEST_METHOD(Load_RejectsModelsWithOtherLayers)
+            {
+                FixedModel fixedModel;
+
+                std::unique_ptr<models::Sequential> otherDimensions(CreateModel(9, activators::ActivatorType::Sigmoid));
+                Assert::IsFalse(fixedModel.Load(*otherDimensions));
+
+                std::unique_ptr<models::Sequential> otherActivator(CreateModel(8, activators::ActivatorType::ReLU));
+                Assert::IsFalse(fixedModel.Load(*otherActivator));
+
+                models::Sequential fewerLayers({
+                    new layers::Flatten({ 3 }, activators::ActivatorType::None),
+                    new layers::Dense(16, activators::ActivatorType::ReLU)
+                });
+                fewerLayers.Compile(c_TestSeedValue);
+                Assert::IsFalse(fixedModel.Load(fewerLayers));
+            }
+        };
+    }
+}
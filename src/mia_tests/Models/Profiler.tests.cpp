@@ -0,0 +1,233 @@
+#include <CppUnitTest.h>
+
+#include <Models/Profiler.h>
+#include <Models/Sequential.h>
+#include <Layers/Flatten.h>
+#include <Layers/Dense.h>
+
+#include <stdio.h>
+#include <string>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace mia
+{
+    namespace tests
+    {
+        TEST_CLASS(ProfilerTests)
+        {
+            static u32 constexpr c_TestSeedValue = 5;
+            static u32 constexpr c_NumInputs = 6;
+            static u32 constexpr c_NumHiddenNeurons = 16;
+            static u32 constexpr c_NumOutputs = 2;
+
+            static models::Sequential * CreateModel(u32 maxBatchSize)
+            {
+                models::Sequential * model = new models::Sequential({
+                    new layers::Flatten({ c_NumInputs }, activators::ActivatorType::None),
+                    new layers::Dense(c_NumHiddenNeurons, activators::ActivatorType::ReLU),
+                    new layers::Dense(c_NumOutputs, activators::ActivatorType::Sigmoid)
+                });
+
+                model->Compile(c_TestSeedValue, maxBatchSize);
+                return model;
+            }
+
+            // Holds a batch of data for the model made by CreateModel
+            struct Batch
+            {
+                f32 inputData[8 * c_NumInputs];
+                f32 expectedOutputData[8 * c_NumOutputs];
+                Tensor input;
+                Tensor expectedOutput;
+
+                explicit Batch(u32 batchSize)
+                {
+                    for (u32 eIdx = 0; eIdx < LENGTHOF(inputData); ++eIdx)
+                    {
+                        inputData[eIdx] = static_cast<f32>(eIdx % 7) * 0.1f;
+                    }
+                    for (u32 eIdx = 0; eIdx < LENGTHOF(expectedOutputData); ++eIdx)
+                    {
+                        expectedOutputData[eIdx] = static_cast<f32>(eIdx % 2);
+                    }
+
+                    input = Tensor::Borrow(inputData, { batchSize, c_NumInputs });
+                    expectedOutput = Tensor::Borrow(expectedOutputData, { batchSize, c_NumOutputs });
+                }
+            };
+
+        public:
+            TEST_METHOD(DurationHistogram_CountsDurationsInPowerOfTwoBuckets)
+            {
+                models::DurationHistogram histogram;
+                Assert::AreEqual(static_cast<u64>(0), histogram.GetPercentile(0.5));
+
+                u64 const durations[] = { 0, 1, 2, 3, 4, 7, 8, 1000 };
+                for (u32 dIdx = 0; dIdx < LENGTHOF(durations); ++dIdx)
+                {
+                    histogram.Add(durations[dIdx]);
+                }
+
+                Assert::AreEqual(static_cast<u64>(8), histogram.GetCount());
+                Assert::AreEqual(static_cast<u64>(1025), histogram.GetTotal());
+                Assert::AreEqual(static_cast<u64>(0), histogram.GetMin());
+                Assert::AreEqual(static_cast<u64>(1000), histogram.GetMax());
+
+                Assert::AreEqual(static_cast<u64>(2), histogram.GetBucketCount(0));
+                Assert::AreEqual(static_cast<u64>(2), histogram.GetBucketCount(1));
+                Assert::AreEqual(static_cast<u64>(2), histogram.GetBucketCount(2));
+                Assert::AreEqual(static_cast<u64>(1), histogram.GetBucketCount(3));
+                Assert::AreEqual(static_cast<u64>(1), histogram.GetBucketCount(9));
+
+                // The median lies in [2, 4) & the largest bucket is clamped to the largest duration
+                Assert::AreEqual(static_cast<u64>(3), histogram.GetPercentile(0.5));
+                Assert::AreEqual(static_cast<u64>(15), histogram.GetPercentile(0.875));
+                Assert::AreEqual(static_cast<u64>(1000), histogram.GetPercentile(1.0));
+            }
+
+            TEST_METHOD(Profiler_RecordsEveryPassOfEveryLayer)
+            {
+                u32 const batchSize = 4;
+                std::unique_ptr<models::Sequential> model(CreateModel(batchSize));
+                Batch const batch(batchSize);
+
+                models::Profiler profiler;
+                model->SetProfiler(&profiler);
+                model->Train(batch.input, batch.expectedOutput);
+                model->Predict(batch.input);
+
+                // Training executes each layer, then backpropagates & updates every layer but the input layer
+                models::ProfiledPass const expectedPasses[] = {
+                    models::ProfiledPass::Execute, models::ProfiledPass::Execute, models::ProfiledPass::Execute,
+                    models::ProfiledPass::Backpropagate, models::ProfiledPass::Backpropagate,
+                    models::ProfiledPass::ApplyGradients, models::ProfiledPass::ApplyGradients,
+                    models::ProfiledPass::Execute, models::ProfiledPass::Execute, models::ProfiledPass::Execute
+                };
+                u32 const expectedLayerIndices[] = { 0, 1, 2, 2, 1, 1, 2, 0, 1, 2 };
+
+                std::vector<models::ProfileEvent> const & events = profiler.GetEvents();
+                Assert::AreEqual(static_cast<u64>(LENGTHOF(expectedPasses)), static_cast<u64>(events.size()));
+                for (u32 eIdx = 0; eIdx < LENGTHOF(expectedPasses); ++eIdx)
+                {
+                    Assert::IsTrue(expectedPasses[eIdx] == events[eIdx].pass);
+                    Assert::AreEqual(expectedLayerIndices[eIdx], events[eIdx].layerIndex);
+                    Assert::IsTrue((eIdx == 0) || (events[eIdx].startTime >= events[eIdx - 1].startTime));
+                }
+
+                Assert::AreEqual(static_cast<u32>(3), profiler.GetNumLayers());
+                Assert::IsTrue(layers::LayerClass::Dense == events[1].layerClass);
+                Assert::AreEqual(static_cast<u64>(2), profiler.GetSummary(1, models::ProfiledPass::Execute).durations.GetCount());
+                Assert::AreEqual(static_cast<u64>(1), profiler.GetSummary(1, models::ProfiledPass::Backpropagate).durations.GetCount());
+                Assert::AreEqual(static_cast<u64>(0), profiler.GetSummary(0, models::ProfiledPass::Backpropagate).durations.GetCount());
+
+                // The input layer does no work, the hidden layer's multiplication dominates its execution
+                Assert::AreEqual(0.0, events[0].cost.numFlops);
+                f64 const expectedFlops = (2.0 * c_NumHiddenNeurons * c_NumInputs * batchSize) + (2.0 * c_NumHiddenNeurons * batchSize);
+                Assert::AreEqual(expectedFlops, events[1].cost.numFlops);
+                Assert::AreEqual(2.0 * expectedFlops, profiler.GetSummary(1, models::ProfiledPass::Execute).cost.numFlops);
+                Assert::IsTrue(events[1].cost.numBytes > 0.0);
+
+                // Only the output layer propagates its gradients back to the previous layer, which doubles the
+                // multiplications
+                Assert::AreEqual((3.0 * c_NumOutputs * batchSize) + (4.0 * c_NumOutputs * c_NumHiddenNeurons * batchSize), events[3].cost.numFlops);
+                Assert::AreEqual((3.0 * c_NumHiddenNeurons * batchSize) + (2.0 * c_NumHiddenNeurons * c_NumInputs * batchSize), events[4].cost.numFlops);
+                Assert::AreEqual(static_cast<f64>(((c_NumHiddenNeurons * c_NumInputs) + c_NumHiddenNeurons) * optimizers::GetNumFlopsPerParameter(optimizers::OptimizerType::SGD)), events[5].cost.numFlops);
+
+                // Nothing is recorded once the profiler is detached
+                model->SetProfiler(nullptr);
+                model->Predict(batch.input);
+                Assert::AreEqual(static_cast<u64>(LENGTHOF(expectedPasses)), static_cast<u64>(events.size()));
+
+                profiler.Reset();
+                Assert::AreEqual(static_cast<u64>(0), static_cast<u64>(events.size()));
+                Assert::AreEqual(static_cast<u32>(0), profiler.GetNumLayers());
+            }
+
+            TEST_METHOD(Profiler_AttributesHeapAllocationsToTheLayerThatMadeThem)
+            {
+                std::unique_ptr<models::Sequential> model(CreateModel(2));
+                Batch const largerBatch(8);
+
+                models::Profiler profiler;
+                model->SetProfiler(&profiler);
+
+                // The batch is larger than the one the layers reserved for, so each Dense layer grows its values
+                model->Predict(largerBatch.input);
+                model->Predict(largerBatch.input);
+
+                std::vector<models::ProfileEvent> const & events = profiler.GetEvents();
+                Assert::AreEqual(static_cast<u64>(0), events[0].numAllocations);
+                Assert::AreEqual(static_cast<u64>(1), events[1].numAllocations);
+                Assert::IsTrue(events[1].numBytesAllocated >= (8 * c_NumHiddenNeurons * sizeof(f32)));
+                Assert::AreEqual(static_cast<u64>(1), events[2].numAllocations);
+
+                for (u32 eIdx = 3; eIdx < 6; ++eIdx)
+                {
+                    Assert::AreEqual(static_cast<u64>(0), events[eIdx].numAllocations);
+                }
+                Assert::AreEqual(static_cast<u64>(1), profiler.GetSummary(1, models::ProfiledPass::Execute).numAllocations);
+            }
+
+            TEST_METHOD(Profiler_OnlyKeepsMaxNumEvents_ButSummarisesEveryCall)
+            {
+                std::unique_ptr<models::Sequential> model(CreateModel(1));
+                Batch const batch(1);
+
+                models::Profiler profiler(4);
+                model->SetProfiler(&profiler);
+                model->Predict(batch.input);
+                model->Predict(batch.input);
+
+                Assert::AreEqual(static_cast<u64>(4), static_cast<u64>(profiler.GetEvents().size()));
+                Assert::AreEqual(static_cast<u64>(2), profiler.GetNumDroppedEvents());
+                Assert::AreEqual(static_cast<u64>(2), profiler.GetSummary(2, models::ProfiledPass::Execute).durations.GetCount());
+            }
+
+            TEST_METHOD(WriteChromeTrace_WritesAnEventPerCall)
+            {
+                std::unique_ptr<models::Sequential> model(CreateModel(2));
+                Batch const batch(2);
+
+                models::Profiler profiler;
+                model->SetProfiler(&profiler);
+                model->Train(batch.input, batch.expectedOutput);
+
+                char const * path = "ProfilerTests_Trace.json";
+                Assert::IsTrue(profiler.WriteChromeTrace(path));
+
+                std::string trace;
+                FILE * file = fopen(path, "rb");
+                Assert::IsNotNull(file);
+                char buffer[256];
+                for (size_t numRead = fread(buffer, 1, sizeof(buffer), file); numRead > 0; numRead = fread(buffer, 1, sizeof(buffer), file))
+                {
+                    trace.append(buffer, numRead);
+                }
+                fclose(file);
+                remove(path);
+
+                // Counts the (non-overlapping) occurrences of text within the trace
+                auto count = [&](char const * text) -> u64
+                {
+                    u64 numOccurrences = 0;
+                    for (size_t position = trace.find(text); std::string::npos != position; position = trace.find(text, position + 1))
+                    {
+                        ++numOccurrences;
+                    }
+                    return numOccurrences;
+                };
+
+                Assert::AreEqual(static_cast<size_t>(0), trace.find("{\"displayTimeUnit\":\"ns\",\"traceEvents\":["));
+                Assert::AreEqual(static_cast<u64>(profiler.GetEvents().size()), count("\"ph\":\"X\""));
+                Assert::AreEqual(static_cast<u64>(3), count("\"name\":\"Execute\""));
+                Assert::AreEqual(static_cast<u64>(2), count("\"name\":\"Backpropagate\""));
+                Assert::AreEqual(static_cast<u64>(2), count("\"name\":\"ApplyGradients\""));
+                Assert::AreEqual(static_cast<u64>(1), count("\"args\":{\"name\":\"1 Dense\"}"));
+                Assert::AreEqual(static_cast<u64>(1), count("\"args\":{\"name\":\"0 Flatten\"}"));
+                Assert::AreEqual(count("{"), count("}"));
+                Assert::AreEqual(trace.size() - 3, trace.rfind("]}\n"));
+            }
+        };
+    }
+}
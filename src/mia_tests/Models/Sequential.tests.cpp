@@ -3,6 +3,22 @@
 #include <Models/Sequential.h>
 #include <Layers/Layer.h>
 #include <Layers/InputLayer.h>
+#include <Layers/Flatten.h>
+#include <Layers/Dense.h>
+#include <Core/ThreadPool.h>
+#include <Core/CpuFeatures.h>
+
+#include <math.h>
+#include <stdio.h>
+
+#include "../Helpers/AllocationCounter.h"
+#include "../Helpers/LocalRanks.h"
+
+#if !defined(_WIN32)
+#include <signal.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#endif
 
 using namespace Microsoft::VisualStudio::CppUnitTestFramework;
 
@@ -48,7 +64,7 @@ namespace mia
                 m_ExecuteCalls++;
             }
 
-            virtual void SetInputData(NDArrayView<f32> const& inputData) override
+            virtual void SetInputData(Tensor const & inputData) override
             {
                 m_SetInputDataCalls++;
             }
@@ -185,6 +201,517 @@ namespace mia
                 Assert::AreEqual(static_cast<u32>(1), layer1->m_ExecuteCalls);
                 Assert::AreEqual(static_cast<u32>(1), layer2->m_ExecuteCalls);
             }
+
+            TEST_METHOD(Predict_MatchesPredictingEachSampleIndividually)
+            {
+                static f32 constexpr c_Precision = 1e-3f;
+
+                models::Sequential model({
+                    new layers::Flatten({ 3 }, activators::ActivatorType::None),
+                    new layers::Dense(8, activators::ActivatorType::ReLU),
+                    new layers::Dense(2, activators::ActivatorType::Sigmoid)
+                });
+
+                model.Compile(c_TestSeedValue);
+
+                u32 const numSamples = 5;
+                f32 inputData[numSamples * 3];
+                for (u32 eIdx = 0; eIdx < LENGTHOF(inputData); ++eIdx)
+                {
+                    inputData[eIdx] = static_cast<f32>(eIdx % 7) * 0.25f;
+                }
+
+                // Predict the whole batch at once
+                Matrix const batchOutput = model.Predict(Tensor::Borrow(inputData, { numSamples, 3 }));
+
+                Assert::AreEqual(numSamples, batchOutput.GetWidth());
+                Assert::AreEqual(static_cast<u32>(2), batchOutput.GetHeight());
+
+                // Compare against predicting each sample on its own
+                for (u32 sIdx = 0; sIdx < numSamples; ++sIdx)
+                {
+                    Matrix const & sampleOutput = model.Predict(Tensor::Borrow(&inputData[sIdx * 3], { 3 }));
+                    Assert::AreEqual(static_cast<u32>(1), sampleOutput.GetWidth());
+
+                    for (u32 rIdx = 0; rIdx < sampleOutput.GetHeight(); ++rIdx)
+                    {
+                        Assert::IsTrue(fabsf(batchOutput.GetElement(rIdx, sIdx) - sampleOutput.GetElement(rIdx, 0)) < c_Precision);
+                    }
+                }
+            }
+
+            TEST_METHOD(Predict_WithFastInferencePrecision_IsCloseToAccurate)
+            {
+                models::Sequential model({
+                    new layers::Flatten({ 3 }, activators::ActivatorType::None),
+                    new layers::Dense(16, activators::ActivatorType::GELU),
+                    new layers::Dense(8, activators::ActivatorType::Tanh),
+                    new layers::Dense(2, activators::ActivatorType::Sigmoid)
+                });
+
+                model.Compile(c_TestSeedValue, 6);
+
+                f32 inputData[6 * 3];
+                for (u32 eIdx = 0; eIdx < LENGTHOF(inputData); ++eIdx)
+                {
+                    inputData[eIdx] = (static_cast<f32>(eIdx % 7) * 0.5f) - 1.5f;
+                }
+
+                Tensor const input = Tensor::Borrow(inputData, { 6, 3 });
+                Matrix const accurateOutput = model.Predict(input);
+
+                model.SetInferencePrecision(kernels::MathPrecision::Fast);
+                Matrix const & fastOutput = model.Predict(input);
+
+                Assert::IsTrue(accurateOutput.Equals(fastOutput, 1e-3f));
+            }
+
+            TEST_METHOD(Predict_IsUnchanged_AfterReleasingUnpackedWeights)
+            {
+                static f32 constexpr c_Precision = 1e-3f;
+
+                models::Sequential model({
+                    new layers::Flatten({ 3 }, activators::ActivatorType::None),
+                    new layers::Dense(8, activators::ActivatorType::ReLU),
+                    new layers::Dense(2, activators::ActivatorType::Sigmoid)
+                });
+
+                model.Compile(c_TestSeedValue, 4, optimizers::Optimizer::Adam(0.05f));
+
+                u32 const numSamples = 4;
+                f32 inputData[numSamples * 3];
+                f32 expectedOutput[numSamples * 2];
+                for (u32 eIdx = 0; eIdx < LENGTHOF(inputData); ++eIdx)
+                {
+                    inputData[eIdx] = static_cast<f32>(eIdx % 5) * 0.25f;
+                }
+                for (u32 eIdx = 0; eIdx < LENGTHOF(expectedOutput); ++eIdx)
+                {
+                    expectedOutput[eIdx] = static_cast<f32>(eIdx % 2);
+                }
+
+                Tensor const input = Tensor::Borrow(inputData, { numSamples, 3 });
+                Tensor const expected = Tensor::Borrow(expectedOutput, { numSamples, 2 });
+
+                // Train for a few steps so the packed weights have to follow the updates
+                for (u32 iIdx = 0; iIdx < 10; ++iIdx)
+                {
+                    model.Train(input, expected);
+                }
+
+                Matrix const outputBeforeRelease = model.Predict(input);
+                model.ReleaseUnpackedWeights();
+                Matrix const & outputAfterRelease = model.Predict(input);
+
+                Assert::IsTrue(outputBeforeRelease.Equals(outputAfterRelease, c_Precision));
+            }
+
+            // Compiles & trains a small model, saves it, loads it back (with the supplied SIMD level in use) &
+            // checks the loaded model predicts the same output as the original.
+            static void CheckSaveAndLoadRoundTrip(cpu::SimdLevel loadSimdLevel)
+            {
+                static f32 constexpr c_Precision = 1e-4f;
+                static char const * c_Path = "Sequential.tests.miamodel";
+
+                models::Sequential model({
+                    new layers::Flatten({ 2, 3 }, activators::ActivatorType::None),
+                    new layers::Dense(37, activators::ActivatorType::ReLU),
+                    new layers::Dense(3, activators::ActivatorType::Sigmoid)
+                });
+
+                model.Compile(c_TestSeedValue, 4, optimizers::Optimizer::SGD(0.1f));
+
+                f32 inputData[4 * 2 * 3];
+                f32 expectedOutput[4 * 3];
+                for (u32 eIdx = 0; eIdx < LENGTHOF(inputData); ++eIdx)
+                {
+                    inputData[eIdx] = static_cast<f32>(eIdx % 5) * 0.2f;
+                }
+                for (u32 eIdx = 0; eIdx < LENGTHOF(expectedOutput); ++eIdx)
+                {
+                    expectedOutput[eIdx] = static_cast<f32>(eIdx % 2);
+                }
+
+                Tensor const input = Tensor::Borrow(inputData, { 4, 2, 3 });
+                model.Train(input, Tensor::Borrow(expectedOutput, { 4, 3 }));
+
+                Matrix const expected = model.Predict(input);
+                Assert::IsTrue(model.Save(c_Path));
+
+                cpu::SetMaxSimdLevel(loadSimdLevel);
+                {
+                    std::unique_ptr<models::Sequential> loaded = models::Sequential::Load(c_Path, 4);
+                    Assert::IsTrue(nullptr != loaded);
+
+                    Assert::AreEqual(static_cast<u32>(3), loaded->GetNumLayers());
+                    Assert::IsTrue(expected.Equals(loaded->Predict(input), c_Precision));
+
+                    // The parameters are read straight from the file, other than weights packed for another
+                    // micro-kernel which have to be packed again
+                    for (u32 layerIndex = 1; layerIndex < loaded->GetNumLayers(); ++layerIndex)
+                    {
+                        layers::Layer const * layer = loaded->GetLayer(layerIndex);
+                        Assert::IsTrue(layer->GetWeights().IsView());
+                        Assert::IsTrue(layer->GetBiases().IsView());
+                        Assert::IsTrue(gemm::IsPackedForCurrentKernel(layer->GetPackedWeights()));
+                    }
+                }
+                cpu::SetMaxSimdLevel(cpu::SimdLevel::AVX512);
+
+                remove(c_Path);
+            }
+
+            TEST_METHOD(SaveAndLoad_RoundTripsTheModel)
+            {
+                CheckSaveAndLoadRoundTrip(cpu::SimdLevel::AVX512);
+            }
+
+            TEST_METHOD(SaveAndLoad_RepacksWeightsPackedForAnotherKernel)
+            {
+                CheckSaveAndLoadRoundTrip(cpu::SimdLevel::Scalar);
+            }
+
+            TEST_METHOD(Load_RejectsFilesThatAreNotModels)
+            {
+                static char const * c_Path = "Sequential.tests.notamodel";
+
+                Assert::IsTrue(nullptr == models::Sequential::Load("Sequential.tests.doesnotexist"));
+
+                FILE * file = fopen(c_Path, "wb");
+                char const contents[] = "This isn't a model file, it's just some text padded out past the size of a header.";
+                fwrite(contents, 1, sizeof(contents), file);
+                fclose(file);
+
+                Assert::IsTrue(nullptr == models::Sequential::Load(c_Path));
+                remove(c_Path);
+            }
+
+            // Creates the model used by the checkpoint tests, compiled with Adam (which keeps the most state of
+            // any optimizer).
+            static std::unique_ptr<models::Sequential> CreateCheckpointModel(u32 seedValue, u32 numHiddenNeurons = 37)
+            {
+                std::unique_ptr<models::Sequential> model(new models::Sequential({
+                    new layers::Flatten({ 2, 3 }, activators::ActivatorType::None),
+                    new layers::Dense(numHiddenNeurons, activators::ActivatorType::ReLU),
+                    new layers::Dense(3, activators::ActivatorType::Sigmoid)
+                }));
+
+                model->Compile(seedValue, 4, optimizers::Optimizer::Adam(0.05f));
+                return model;
+            }
+
+            // Holds a batch of training data for the checkpoint tests
+            struct CheckpointData
+            {
+                f32 inputData[4 * 2 * 3];
+                f32 expectedOutputData[4 * 3];
+                Tensor input;
+                Tensor expectedOutput;
+
+                CheckpointData()
+                {
+                    for (u32 eIdx = 0; eIdx < LENGTHOF(inputData); ++eIdx)
+                    {
+                        inputData[eIdx] = static_cast<f32>(eIdx % 5) * 0.2f;
+                    }
+                    for (u32 eIdx = 0; eIdx < LENGTHOF(expectedOutputData); ++eIdx)
+                    {
+                        expectedOutputData[eIdx] = static_cast<f32>(eIdx % 2);
+                    }
+
+                    input = Tensor::Borrow(inputData, { 4, 2, 3 });
+                    expectedOutput = Tensor::Borrow(expectedOutputData, { 4, 3 });
+                }
+            };
+
+            TEST_METHOD(CheckpointAndResume_CarriesOnTrainingFromTheCheckpoint)
+            {
+                static f32 constexpr c_Precision = 1e-5f;
+                static char const * c_Path = "Sequential.tests.miackpt";
+
+                CheckpointData const data;
+                std::unique_ptr<models::Sequential> model = CreateCheckpointModel(c_TestSeedValue);
+                for (u32 sIdx = 0; sIdx < 3; ++sIdx)
+                {
+                    model->Train(data.input, data.expectedOutput);
+                }
+
+                // Training straight away must not change what is written
+                model->Checkpoint(c_Path);
+                model->Train(data.input, data.expectedOutput);
+                Assert::IsTrue(model->WaitForCheckpoint());
+
+                model->Train(data.input, data.expectedOutput);
+                Matrix const expected = model->Predict(data.input);
+
+                // A model compiled from another seed ends up with the same parameters once resumed
+                std::unique_ptr<models::Sequential> resumed = CreateCheckpointModel(c_TestSeedValue + 1);
+                Assert::IsTrue(resumed->Resume(c_Path));
+                resumed->Train(data.input, data.expectedOutput);
+                resumed->Train(data.input, data.expectedOutput);
+                Assert::IsTrue(expected.Equals(resumed->Predict(data.input), c_Precision));
+
+                remove(c_Path);
+            }
+
+            TEST_METHOD(Checkpoint_OnlyRewritesLayersThatChanged)
+            {
+                static f32 constexpr c_Precision = 1e-5f;
+                static char const * c_Path = "Sequential.tests.miackpt";
+
+                CheckpointData const data;
+                std::unique_ptr<models::Sequential> model = CreateCheckpointModel(c_TestSeedValue);
+                model->Train(data.input, data.expectedOutput);
+
+                // The first checkpoint writes the parameters & both of Adam's moments of every layer
+                u64 const expectedNumBytes = 3 * (((6 * 37) + 37) + ((37 * 3) + 3)) * sizeof(f32);
+                u64 numBytesWritten = 0;
+                model->Checkpoint(c_Path);
+                Assert::IsTrue(model->WaitForCheckpoint(&numBytesWritten));
+                Assert::AreEqual(expectedNumBytes, numBytesWritten);
+
+                model->Checkpoint(c_Path);
+                Assert::IsTrue(model->WaitForCheckpoint(&numBytesWritten));
+                Assert::AreEqual(static_cast<u64>(0), numBytesWritten);
+
+                model->Train(data.input, data.expectedOutput);
+                model->Checkpoint(c_Path);
+                Assert::IsTrue(model->WaitForCheckpoint(&numBytesWritten));
+                Assert::AreEqual(expectedNumBytes, numBytesWritten);
+
+                // The updated file holds the latest state
+                Matrix const expected = model->Predict(data.input);
+                std::unique_ptr<models::Sequential> resumed = CreateCheckpointModel(c_TestSeedValue + 1);
+                Assert::IsTrue(resumed->Resume(c_Path));
+                Assert::IsTrue(expected.Equals(resumed->Predict(data.input), c_Precision));
+
+                remove(c_Path);
+            }
+
+            // Crashing mid-write is simulated by limiting the size of the files a forked process can write
+#if !defined(_WIN32)
+            TEST_METHOD(Resume_RestoresThePreviousCheckpoint_WhenACheckpointFailsMidWrite)
+            {
+                static f32 constexpr c_Precision = 1e-5f;
+                static char const * c_Path = "Sequential.tests.miackpt";
+
+                CheckpointData const data;
+                std::unique_ptr<models::Sequential> model = CreateCheckpointModel(c_TestSeedValue);
+                model->Train(data.input, data.expectedOutput);
+                model->Checkpoint(c_Path);
+                Assert::IsTrue(model->WaitForCheckpoint());
+                Matrix const expected = model->Predict(data.input);
+
+                struct stat fileStatus;
+                Assert::AreEqual(0, stat(c_Path, &fileStatus));
+                rlimit const fileSizeLimit = { static_cast<rlim_t>(fileStatus.st_size / 2), static_cast<rlim_t>(fileStatus.st_size / 2) };
+
+                // Only half of the next checkpoint (which only rewrites the layers that changed) can be written
+                Assert::IsTrue(RunLocalRanks(1, [&](u32) -> bool
+                {
+                    signal(SIGXFSZ, SIG_IGN);
+                    model->Train(data.input, data.expectedOutput);
+                    if (0 != setrlimit(RLIMIT_FSIZE, &fileSizeLimit))
+                    {
+                        return false;
+                    }
+
+                    model->Checkpoint(c_Path);
+                    return !model->WaitForCheckpoint();
+                }));
+
+                std::unique_ptr<models::Sequential> resumed = CreateCheckpointModel(c_TestSeedValue + 1);
+                Assert::IsTrue(resumed->Resume(c_Path));
+                Assert::IsTrue(expected.Equals(resumed->Predict(data.input), c_Precision));
+
+                // The next checkpoint isn't affected by the failed one
+                model->Train(data.input, data.expectedOutput);
+                model->Checkpoint(c_Path);
+                Assert::IsTrue(model->WaitForCheckpoint());
+                Assert::IsTrue(resumed->Resume(c_Path));
+                Assert::IsTrue(model->Predict(data.input).Equals(resumed->Predict(data.input), c_Precision));
+
+                remove(c_Path);
+            }
+#endif
+
+            TEST_METHOD(Resume_RejectsCheckpointsOfOtherModels)
+            {
+                static char const * c_Path = "Sequential.tests.miackpt";
+
+                std::unique_ptr<models::Sequential> model = CreateCheckpointModel(c_TestSeedValue);
+                model->Checkpoint(c_Path);
+                Assert::IsTrue(model->WaitForCheckpoint());
+
+                Assert::IsFalse(model->Resume("Sequential.tests.doesnotexist"));
+                Assert::IsFalse(CreateCheckpointModel(c_TestSeedValue, 38)->Resume(c_Path));
+
+                models::Sequential sgdModel({
+                    new layers::Flatten({ 2, 3 }, activators::ActivatorType::None),
+                    new layers::Dense(37, activators::ActivatorType::ReLU),
+                    new layers::Dense(3, activators::ActivatorType::Sigmoid)
+                });
+                sgdModel.Compile(c_TestSeedValue, 4, optimizers::Optimizer::SGD(0.1f));
+                Assert::IsFalse(sgdModel.Resume(c_Path));
+
+                // Saved models hold no training state
+                Assert::IsTrue(model->Save(c_Path));
+                Assert::IsFalse(CreateCheckpointModel(c_TestSeedValue)->Resume(c_Path));
+
+                remove(c_Path);
+            }
+
+            // Trains a model on the four inputs of an XOR gate with the supplied optimizer & checks it
+            // learns to reproduce the gate.
+            static void CheckLearnsXOR(optimizers::Optimizer const & optimizer, u32 numIterations)
+            {
+                models::Sequential model({
+                    new layers::Flatten({ 2 }, activators::ActivatorType::None),
+                    new layers::Dense(8, activators::ActivatorType::Sigmoid),
+                    new layers::Dense(1, activators::ActivatorType::Sigmoid)
+                });
+
+                model.Compile(c_TestSeedValue, 4, optimizer);
+
+                f32 inputData[] = {
+                    0.0f, 0.0f,
+                    0.0f, 1.0f,
+                    1.0f, 0.0f,
+                    1.0f, 1.0f
+                };
+                f32 expectedOutputData[] = {
+                    0.0f,
+                    1.0f,
+                    1.0f,
+                    0.0f
+                };
+
+                Tensor const input = Tensor::Borrow(inputData, { 4, 2 });
+                Tensor const expectedOutput = Tensor::Borrow(expectedOutputData, { 4, 1 });
+
+                model.Train(input, expectedOutput);
+                f32 const initialLoss = model.GetLoss();
+
+                for (u32 iIdx = 0; iIdx < numIterations; ++iIdx)
+                {
+                    model.Train(input, expectedOutput);
+                }
+
+                Assert::IsTrue(model.GetLoss() < initialLoss);
+
+                Matrix const & output = model.Predict(input);
+                for (u32 sIdx = 0; sIdx < LENGTHOF(expectedOutputData); ++sIdx)
+                {
+                    Assert::IsTrue(fabsf(output.GetElement(0, sIdx) - expectedOutputData[sIdx]) < 0.1f);
+                }
+            }
+
+            TEST_METHOD(Train_LearnsXOR_WithSGD)
+            {
+                CheckLearnsXOR(optimizers::Optimizer::SGD(2.0f), 5000);
+            }
+
+            TEST_METHOD(Train_LearnsXOR_WithMomentum)
+            {
+                CheckLearnsXOR(optimizers::Optimizer::Momentum(0.5f, 0.9f), 2000);
+            }
+
+            TEST_METHOD(Train_LearnsXOR_WithAdam)
+            {
+                CheckLearnsXOR(optimizers::Optimizer::Adam(0.05f), 1000);
+            }
+
+            TEST_METHOD(Train_LearnsXOR_WithAdamW)
+            {
+                CheckLearnsXOR(optimizers::Optimizer::AdamW(0.05f, 1e-4f), 1000);
+            }
+
+            TEST_METHOD(Train_OnASingleSample_MatchesTrainingOnABatchOfOne)
+            {
+                static f32 constexpr c_Precision = 1e-3f;
+
+                f32 inputData[] = { 0.5f, -1.0f, 2.0f };
+                f32 expectedOutputData[] = { 1.0f, 0.0f };
+
+                models::Sequential singleModel({
+                    new layers::Flatten({ 3 }, activators::ActivatorType::None),
+                    new layers::Dense(4, activators::ActivatorType::ReLU),
+                    new layers::Dense(2, activators::ActivatorType::Sigmoid)
+                });
+                models::Sequential batchModel({
+                    new layers::Flatten({ 3 }, activators::ActivatorType::None),
+                    new layers::Dense(4, activators::ActivatorType::ReLU),
+                    new layers::Dense(2, activators::ActivatorType::Sigmoid)
+                });
+
+                singleModel.Compile(c_TestSeedValue);
+                batchModel.Compile(c_TestSeedValue);
+
+                Tensor const input = Tensor::Borrow(inputData, { 3 });
+
+                singleModel.Train(input, { 1.0f, 0.0f });
+                batchModel.Train(input, Tensor::Borrow(expectedOutputData, { 2 }));
+
+                Assert::IsTrue(fabsf(singleModel.GetLoss() - batchModel.GetLoss()) < c_Precision);
+
+                Matrix const singleOutput = singleModel.Predict(input);
+                Matrix const & batchOutput = batchModel.Predict(input);
+                for (u32 rIdx = 0; rIdx < singleOutput.GetHeight(); ++rIdx)
+                {
+                    Assert::IsTrue(fabsf(singleOutput.GetElement(rIdx, 0) - batchOutput.GetElement(rIdx, 0)) < c_Precision);
+                }
+            }
+
+            TEST_METHOD(PredictAndTrain_DoNotAllocate_AfterWarmUp)
+            {
+                // Worker threads lazily allocate their GEMM scratch buffers on first use, keep to
+                // the calling thread so that the warm up below covers every thread.
+                ThreadPool::Get().SetNumThreads(1);
+
+                u32 const maxBatchSize = 16;
+                models::Sequential model({
+                    new layers::Flatten({ 20 }, activators::ActivatorType::None),
+                    new layers::Dense(64, activators::ActivatorType::ReLU),
+                    new layers::Dense(48, activators::ActivatorType::ReLU),
+                    new layers::Dense(4, activators::ActivatorType::Sigmoid)
+                });
+
+                // Adam keeps the most state of any optimizer
+                model.Compile(c_TestSeedValue, maxBatchSize, optimizers::Optimizer::Adam());
+
+                f32 inputData[maxBatchSize * 20];
+                for (u32 eIdx = 0; eIdx < LENGTHOF(inputData); ++eIdx)
+                {
+                    inputData[eIdx] = static_cast<f32>(eIdx % 11) * 0.1f;
+                }
+
+                Tensor const fullBatch = Tensor::Borrow(inputData, { maxBatchSize, 20 });
+                Tensor const partialBatch = Tensor::Borrow(inputData, { 5, 20 });
+
+                f32 expectedOutputData[maxBatchSize * 4];
+                for (u32 eIdx = 0; eIdx < LENGTHOF(expectedOutputData); ++eIdx)
+                {
+                    expectedOutputData[eIdx] = static_cast<f32>(eIdx % 2);
+                }
+
+                Tensor const fullBatchExpectedOutput = Tensor::Borrow(expectedOutputData, { maxBatchSize, 4 });
+                Tensor const partialBatchExpectedOutput = Tensor::Borrow(expectedOutputData, { 5, 4 });
+
+                // Warm up
+                model.Predict(fullBatch);
+                model.Train(fullBatch, fullBatchExpectedOutput);
+
+                AllocationCounter allocationCounter;
+
+                model.Predict(fullBatch);
+                model.Predict(partialBatch);
+                model.Train(fullBatch, fullBatchExpectedOutput);
+                model.Train(partialBatch, partialBatchExpectedOutput);
+
+                Assert::AreEqual(static_cast<u64>(0), allocationCounter.GetNumAllocations());
+
+                ThreadPool::Get().SetNumThreads(0);
+            }
         };
     }
 }
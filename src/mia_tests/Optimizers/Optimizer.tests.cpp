@@ -0,0 +1,154 @@
+#include <CppUnitTest.h>
+
+#include <Optimizers/Optimizer.h>
+#include <Core/ThreadPool.h>
+
+#include <math.h>
+#include <vector>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace mia
+{
+    namespace tests
+    {
+        TEST_CLASS(OptimizerTests)
+        {
+            static f32 constexpr c_Precision = 1e-3f;
+
+            static void Fill(f32 * data, u64 length, u32 seed)
+            {
+                u32 state = seed;
+                for (u64 eIdx = 0; eIdx < length; ++eIdx)
+                {
+                    state = (state * 1103515245 + 12345) & 0x7FFFFFFF;
+                    data[eIdx] = (static_cast<f32>(state % 2001) / 1000.0f) - 1.0f;
+                }
+            }
+
+        public:
+            TEST_METHOD(GetNumStateBuffers_ReturnsTheStateKeptByEachOptimizer)
+            {
+                Assert::AreEqual(static_cast<u32>(0), optimizers::GetNumStateBuffers(optimizers::OptimizerType::SGD));
+                Assert::AreEqual(static_cast<u32>(1), optimizers::GetNumStateBuffers(optimizers::OptimizerType::Momentum));
+                Assert::AreEqual(static_cast<u32>(2), optimizers::GetNumStateBuffers(optimizers::OptimizerType::Adam));
+                Assert::AreEqual(static_cast<u32>(2), optimizers::GetNumStateBuffers(optimizers::OptimizerType::AdamW));
+            }
+
+            TEST_METHOD(Update_SGD_StepsAgainstTheGradient)
+            {
+                f32 parameters[] = { 1.0f, -2.0f, 0.5f };
+                f32 const gradients[] = { 0.5f, 1.0f, -2.0f };
+
+                optimizers::Update(optimizers::Optimizer::SGD(0.1f), 1, parameters, gradients, nullptr, LENGTHOF(parameters));
+
+                Assert::IsTrue(fabsf(parameters[0] - 0.95f) < c_Precision);
+                Assert::IsTrue(fabsf(parameters[1] - -2.1f) < c_Precision);
+                Assert::IsTrue(fabsf(parameters[2] - 0.7f) < c_Precision);
+            }
+
+            TEST_METHOD(Update_Momentum_AccumulatesVelocity)
+            {
+                f32 parameters[] = { 1.0f };
+                f32 const gradients[] = { 1.0f };
+                f32 velocity[] = { 0.0f };
+                f32 * state[] = { velocity };
+
+                optimizers::Optimizer const optimizer = optimizers::Optimizer::Momentum(0.1f, 0.5f);
+
+                // v = 1, p = 1 - 0.1
+                optimizers::Update(optimizer, 1, parameters, gradients, state, LENGTHOF(parameters));
+                Assert::IsTrue(fabsf(velocity[0] - 1.0f) < c_Precision);
+                Assert::IsTrue(fabsf(parameters[0] - 0.9f) < c_Precision);
+
+                // v = (0.5 * 1) + 1, p = 0.9 - 0.15
+                optimizers::Update(optimizer, 2, parameters, gradients, state, LENGTHOF(parameters));
+                Assert::IsTrue(fabsf(velocity[0] - 1.5f) < c_Precision);
+                Assert::IsTrue(fabsf(parameters[0] - 0.75f) < c_Precision);
+            }
+
+            TEST_METHOD(Update_Adam_TakesStepsOfTheLearningRate_ForAConsistentGradient)
+            {
+                // With bias correction, every step of Adam moves each parameter by (almost exactly) the
+                // learning rate when the gradient doesn't change.
+                f32 parameters[] = { 1.0f, -1.0f };
+                f32 const gradients[] = { 0.25f, -4.0f };
+                f32 moment1[] = { 0.0f, 0.0f };
+                f32 moment2[] = { 0.0f, 0.0f };
+                f32 * state[] = { moment1, moment2 };
+
+                optimizers::Optimizer const optimizer = optimizers::Optimizer::Adam(0.01f);
+                for (u64 stepIndex = 1; stepIndex <= 10; ++stepIndex)
+                {
+                    optimizers::Update(optimizer, stepIndex, parameters, gradients, state, LENGTHOF(parameters));
+
+                    Assert::IsTrue(fabsf(parameters[0] - (1.0f - (0.01f * stepIndex))) < c_Precision);
+                    Assert::IsTrue(fabsf(parameters[1] - (-1.0f + (0.01f * stepIndex))) < c_Precision);
+                }
+            }
+
+            TEST_METHOD(Update_AdamW_DecaysParametersIndependentlyOfTheGradient)
+            {
+                f32 parameters[] = { 2.0f };
+                f32 const gradients[] = { 0.0f };
+                f32 moment1[] = { 0.0f };
+                f32 moment2[] = { 0.0f };
+                f32 * state[] = { moment1, moment2 };
+
+                // A zero gradient leaves the moments at zero, only the decay applies: p = 2 * (1 - (0.1 * 0.5))
+                optimizers::Update(optimizers::Optimizer::AdamW(0.1f, 0.5f), 1, parameters, gradients, state, LENGTHOF(parameters));
+                Assert::IsTrue(fabsf(parameters[0] - 1.9f) < c_Precision);
+                Assert::AreEqual(0.0f, moment1[0]);
+                Assert::AreEqual(0.0f, moment2[0]);
+            }
+
+            TEST_METHOD(Update_Multithreaded_MatchesSingleThreaded)
+            {
+                u64 const numParameters = 300007;
+
+                std::vector<f32> gradients(numParameters);
+                Fill(gradients.data(), numParameters, 1);
+
+                optimizers::OptimizerType const types[] = {
+                    optimizers::OptimizerType::SGD,
+                    optimizers::OptimizerType::Momentum,
+                    optimizers::OptimizerType::Adam,
+                    optimizers::OptimizerType::AdamW
+                };
+
+                for (u32 tIdx = 0; tIdx < LENGTHOF(types); ++tIdx)
+                {
+                    optimizers::Optimizer optimizer;
+                    optimizer.type = types[tIdx];
+                    optimizer.weightDecay = 0.01f;
+
+                    std::vector<f32> results[2];
+                    for (u32 rIdx = 0; rIdx < 2; ++rIdx)
+                    {
+                        ThreadPool::Get().SetNumThreads((0 == rIdx) ? 1 : 4);
+
+                        std::vector<f32> & parameters = results[rIdx];
+                        parameters.resize(numParameters);
+                        Fill(parameters.data(), numParameters, 2);
+
+                        std::vector<f32> state0(numParameters, 0.0f);
+                        std::vector<f32> state1(numParameters, 0.0f);
+                        f32 * state[] = { state0.data(), state1.data() };
+
+                        for (u64 stepIndex = 1; stepIndex <= 3; ++stepIndex)
+                        {
+                            optimizers::Update(optimizer, stepIndex, parameters.data(), gradients.data(), state, numParameters);
+                        }
+                    }
+
+                    for (u64 eIdx = 0; eIdx < numParameters; ++eIdx)
+                    {
+                        Assert::IsTrue(fabsf(results[0][eIdx] - results[1][eIdx]) < c_Precision);
+                    }
+                }
+
+                ThreadPool::Get().SetNumThreads(0);
+            }
+        };
+    }
+}